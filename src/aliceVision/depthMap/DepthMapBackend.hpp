@@ -0,0 +1,75 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2020 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#pragma once
+
+#include <string>
+#include <iostream>
+#include <algorithm>
+#include <stdexcept>
+
+namespace aliceVision {
+namespace depthMap {
+
+/**
+ * @brief Implementation of the plane sweeping used by the depth map estimation
+ */
+enum class EDepthMapBackend
+{
+  AUTO = 0, //< CUDA if a compatible device is available, CPU otherwise
+  CUDA,     //< CUDA devices
+  CPU       //< CPU threads
+};
+
+/**
+ * @brief convert an enum EDepthMapBackend to its corresponding string
+ * @param EDepthMapBackend
+ * @return String
+ */
+inline std::string EDepthMapBackend_enumToString(EDepthMapBackend backend)
+{
+  switch(backend)
+  {
+    case EDepthMapBackend::AUTO: return "auto";
+    case EDepthMapBackend::CUDA: return "cuda";
+    case EDepthMapBackend::CPU:  return "cpu";
+  }
+  throw std::out_of_range("Invalid depth map backend enum: " + std::to_string(int(backend)));
+}
+
+/**
+ * @brief convert a string depth map backend to its corresponding enum EDepthMapBackend
+ * @param String
+ * @return EDepthMapBackend
+ */
+inline EDepthMapBackend EDepthMapBackend_stringToEnum(const std::string& backend)
+{
+  std::string type = backend;
+  std::transform(type.begin(), type.end(), type.begin(), ::tolower); //tolower
+
+  if(type == "auto") return EDepthMapBackend::AUTO;
+  if(type == "cuda") return EDepthMapBackend::CUDA;
+  if(type == "cpu")  return EDepthMapBackend::CPU;
+
+  throw std::out_of_range("Invalid depth map backend: " + backend);
+}
+
+inline std::ostream& operator<<(std::ostream& os, const EDepthMapBackend backend)
+{
+  os << EDepthMapBackend_enumToString(backend);
+  return os;
+}
+
+inline std::istream& operator>>(std::istream& in, EDepthMapBackend& backend)
+{
+  std::string token;
+  in >> token;
+  backend = EDepthMapBackend_stringToEnum(token);
+  return in;
+}
+
+} // namespace depthMap
+} // namespace aliceVision
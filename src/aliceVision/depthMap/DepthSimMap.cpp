@@ -421,9 +421,9 @@ void DepthSimMap::save(int rc, const StaticVector<int>& tcams)
     }
 
     using namespace imageIO;
-    OutputFileColorSpace colorspace(EImageColorSpace::NO_CONVERSION);
-    writeImage(getFileNameFromIndex(mp, rc, mvsUtils::EFileType::depthMap, scale), width, height, depthMap->getDataWritable(), EImageQuality::LOSSLESS, colorspace,  metadata);
-    writeImage(getFileNameFromIndex(mp, rc, mvsUtils::EFileType::simMap, scale), width, height, simMap->getDataWritable(), EImageQuality::OPTIMIZED,  colorspace, metadata);
+    const EMapStorage mapStorage = EMapStorage_stringToEnum(mp->userParams.get<std::string>("depthMap.mapStorage", "scanline"));
+    writeMap(getFileNameFromIndex(mp, rc, mvsUtils::EFileType::depthMap, scale), width, height, depthMap->getDataWritable(), EImageQuality::LOSSLESS, mapStorage, metadata);
+    writeMap(getFileNameFromIndex(mp, rc, mvsUtils::EFileType::simMap, scale), width, height, simMap->getDataWritable(), EImageQuality::OPTIMIZED, mapStorage, metadata);
 }
 
 void DepthSimMap::load(int rc, int fromScale)
@@ -471,9 +471,9 @@ void DepthSimMap::saveRefine(int rc, std::string depthMapFileName, std::string s
     }
 
     using namespace imageIO;
-    OutputFileColorSpace colorspace(EImageColorSpace::NO_CONVERSION);
-    writeImage(depthMapFileName, width, height, depthMap, EImageQuality::LOSSLESS,  colorspace, metadata);
-    writeImage(simMapFileName, width, height, simMap, EImageQuality::OPTIMIZED,  colorspace, metadata);
+    const EMapStorage mapStorage = EMapStorage_stringToEnum(mp->userParams.get<std::string>("depthMap.mapStorage", "scanline"));
+    writeMap(depthMapFileName, width, height, depthMap, EImageQuality::LOSSLESS, mapStorage, metadata);
+    writeMap(simMapFileName, width, height, simMap, EImageQuality::OPTIMIZED, mapStorage, metadata);
 }
 
 float DepthSimMap::getCellSmoothStep(int rc, const int cellId)
@@ -12,7 +12,7 @@
 namespace aliceVision {
 namespace depthMap {
 
-RcTc::RcTc(mvsUtils::MultiViewParams* _mp, PlaneSweepingCuda& _cps)
+RcTc::RcTc(mvsUtils::MultiViewParams* _mp, PlaneSweeping& _cps)
     : cps( _cps )
 {
     mp = _mp;
@@ -5,8 +5,13 @@
 // You can obtain one at https://mozilla.org/MPL/2.0/.
 
 #include "RefineRc.hpp"
+#include <aliceVision/config.hpp>
 #include <aliceVision/system/Logger.hpp>
 #include <aliceVision/gpu/gpu.hpp>
+#include <aliceVision/depthMap/cpu/PlaneSweepingCpu.hpp>
+#if ALICEVISION_IS_DEFINED(ALICEVISION_HAVE_CUDA)
+#include <aliceVision/depthMap/cuda/PlaneSweepingCuda.hpp>
+#endif
 
 #include <aliceVision/mvsData/Point2d.hpp>
 #include <aliceVision/mvsData/Point3d.hpp>
@@ -17,6 +22,8 @@
 
 #include <boost/filesystem.hpp>
 
+#include <stdexcept>
+
 namespace aliceVision {
 namespace depthMap {
 
@@ -286,55 +293,34 @@ void RefineRc::writeDepthMap()
   _depthSimMapOpt->save(_rc, _refineTCams);
 }
 
-void estimateAndRefineDepthMaps(mvsUtils::MultiViewParams* mp, const std::vector<int>& cams, int nbGPUs)
-{
-  const int numGpus = listCUDADevices(true);
-  const int numCpuThreads = omp_get_num_procs();
-  int numThreads = std::min(numGpus, numCpuThreads);
+namespace {
 
-  ALICEVISION_LOG_INFO("# GPU devices: " << numGpus << ", # CPU threads: " << numCpuThreads);
-
-  if(nbGPUs > 0)
-      numThreads = nbGPUs;
-
-  if(numThreads == 1)
-  {
-      // the GPU sorting is determined by an environment variable named CUDA_DEVICE_ORDER
-      // possible values: FASTEST_FIRST (default) or PCI_BUS_ID
-      const int cudaDeviceNo = 0;
-      estimateAndRefineDepthMaps(cudaDeviceNo, mp, cams);
-  }
-  else
-  {
-      omp_set_num_threads(numThreads); // create as many CPU threads as there are CUDA devices
-#pragma omp parallel
-      {
-          const int cpuThreadId = omp_get_thread_num();
-          const int cudaDeviceNo = cpuThreadId % numThreads;
-          const int rcFrom = cudaDeviceNo * (cams.size() / numThreads);
-          int rcTo = (cudaDeviceNo + 1) * (cams.size() / numThreads);
-
-          ALICEVISION_LOG_INFO("CPU thread " << cpuThreadId << " / " << numThreads << " uses CUDA device: " << cudaDeviceNo);
-
-          if(cudaDeviceNo == numThreads - 1)
-              rcTo = cams.size();
-
-          std::vector<int> subcams;
-          subcams.reserve(cams.size());
-
-          for(int rc = rcFrom; rc < rcTo; rc++)
-              subcams.push_back(cams[rc]);
-
-          estimateAndRefineDepthMaps(cpuThreadId, mp, subcams);
-      }
-  }
+/**
+ * @brief Resolve the AUTO backend: CUDA if available, CPU otherwise
+ */
+EDepthMapBackend getActiveBackend(EDepthMapBackend backend)
+{
+#if ALICEVISION_IS_DEFINED(ALICEVISION_HAVE_CUDA)
+  if(backend == EDepthMapBackend::AUTO)
+    backend = gpu::gpuSupportCUDA(2, 0) ? EDepthMapBackend::CUDA : EDepthMapBackend::CPU;
+#else
+  if(backend == EDepthMapBackend::CUDA)
+    throw std::runtime_error("Cannot use the CUDA depth map backend: AliceVision is built without CUDA support.");
+  backend = EDepthMapBackend::CPU;
+#endif
+  ALICEVISION_LOG_INFO("Depth map backend: " << backend);
+  return backend;
 }
 
-void estimateAndRefineDepthMaps(int cudaDeviceNo, mvsUtils::MultiViewParams* mp, const std::vector<int>& cams)
+/**
+ * @brief Compute the scale and the step of the plane sweeping if they are not set in the user parameters.
+ *        The highest scale should have a minimum resolution of 700x550.
+ */
+void getSgmScaleStep(mvsUtils::MultiViewParams* mp, int& sgmScale, int& sgmStep)
 {
   const int fileScale = 1; // input images scale (should be one)
-  int sgmScale = mp->userParams.get<int>("semiGlobalMatching.scale", -1);
-  int sgmStep = mp->userParams.get<int>("semiGlobalMatching.step", -1);
+  sgmScale = mp->userParams.get<int>("semiGlobalMatching.scale", -1);
+  sgmStep = mp->userParams.get<int>("semiGlobalMatching.step", -1);
 
   if(sgmScale == -1)
   {
@@ -351,11 +337,12 @@ void estimateAndRefineDepthMaps(int cudaDeviceNo, mvsUtils::MultiViewParams* mp,
                            "\t- scale: " << sgmScale << "\n"
                            "\t- step: " << sgmStep);
   }
+}
+
+void estimateAndRefineDepthMaps(PlaneSweeping& cps, const std::vector<int>& cams, int sgmScale, int sgmStep)
+{
+  mvsUtils::MultiViewParams* mp = cps.mp;
 
-  // load images from files into RAM
-  mvsUtils::ImagesCache ic(mp, imageIO::EImageColorSpace::LINEAR);
-  // load stuff on GPU memory and creates multi-level images and computes gradients
-  PlaneSweepingCuda cps(cudaDeviceNo, ic, mp, sgmScale);
   // init plane sweeping parameters
   SemiGlobalMatchingParams sp(mp, cps);
 
@@ -376,17 +363,13 @@ void estimateAndRefineDepthMaps(int cudaDeviceNo, mvsUtils::MultiViewParams* mp,
   }
 }
 
-
-
-
-void computeNormalMaps(int CUDADeviceNo, mvsUtils::MultiViewParams* mp, const StaticVector<int>& cams)
+void computeNormalMaps(PlaneSweeping& cps, const StaticVector<int>& cams)
 {
   const float igammaC = 1.0f;
   const float igammaP = 1.0f;
   const int wsh = 3;
 
-  mvsUtils::ImagesCache ic(mp, imageIO::EImageColorSpace::LINEAR);
-  PlaneSweepingCuda cps(CUDADeviceNo, ic, mp, 1);
+  mvsUtils::MultiViewParams* mp = cps.mp;
 
   for(const int rc : cams)
   {
@@ -411,8 +394,110 @@ void computeNormalMaps(int CUDADeviceNo, mvsUtils::MultiViewParams* mp, const St
   }
 }
 
-void computeNormalMaps(mvsUtils::MultiViewParams* mp, const StaticVector<int>& cams)
+} // namespace
+
+void estimateAndRefineDepthMaps(mvsUtils::MultiViewParams* mp, const std::vector<int>& cams, int nbGPUs,
+                                EDepthMapBackend backend)
+{
+  if(getActiveBackend(backend) == EDepthMapBackend::CPU)
+  {
+      int sgmScale, sgmStep;
+      getSgmScaleStep(mp, sgmScale, sgmStep);
+
+      // load images from files into RAM
+      mvsUtils::ImagesCache ic(mp, imageIO::EImageColorSpace::LINEAR);
+      // multi-level Lab images and gradients computed on demand, the kernels use all the CPU threads
+      PlaneSweepingCpu cps(ic, mp, sgmScale);
+
+      estimateAndRefineDepthMaps(cps, cams, sgmScale, sgmStep);
+      return;
+  }
+
+#if ALICEVISION_IS_DEFINED(ALICEVISION_HAVE_CUDA)
+  const int numGpus = listCUDADevices(true);
+  const int numCpuThreads = omp_get_num_procs();
+  int numThreads = std::min(numGpus, numCpuThreads);
+
+  ALICEVISION_LOG_INFO("# GPU devices: " << numGpus << ", # CPU threads: " << numCpuThreads);
+
+  if(nbGPUs > 0)
+      numThreads = nbGPUs;
+
+  if(numThreads == 1)
+  {
+      // the GPU sorting is determined by an environment variable named CUDA_DEVICE_ORDER
+      // possible values: FASTEST_FIRST (default) or PCI_BUS_ID
+      const int cudaDeviceNo = 0;
+      estimateAndRefineDepthMaps(cudaDeviceNo, mp, cams);
+  }
+  else
+  {
+      omp_set_num_threads(numThreads); // create as many CPU threads as there are CUDA devices
+#pragma omp parallel
+      {
+          const int cpuThreadId = omp_get_thread_num();
+          const int cudaDeviceNo = cpuThreadId % numThreads;
+          const int rcFrom = cudaDeviceNo * (cams.size() / numThreads);
+          int rcTo = (cudaDeviceNo + 1) * (cams.size() / numThreads);
+
+          ALICEVISION_LOG_INFO("CPU thread " << cpuThreadId << " / " << numThreads << " uses CUDA device: " << cudaDeviceNo);
+
+          if(cudaDeviceNo == numThreads - 1)
+              rcTo = cams.size();
+
+          std::vector<int> subcams;
+          subcams.reserve(cams.size());
+
+          for(int rc = rcFrom; rc < rcTo; rc++)
+              subcams.push_back(cams[rc]);
+
+          estimateAndRefineDepthMaps(cpuThreadId, mp, subcams);
+      }
+  }
+#endif
+}
+
+void estimateAndRefineDepthMaps(int cudaDeviceNo, mvsUtils::MultiViewParams* mp, const std::vector<int>& cams)
+{
+#if ALICEVISION_IS_DEFINED(ALICEVISION_HAVE_CUDA)
+  int sgmScale, sgmStep;
+  getSgmScaleStep(mp, sgmScale, sgmStep);
+
+  // load images from files into RAM
+  mvsUtils::ImagesCache ic(mp, imageIO::EImageColorSpace::LINEAR);
+  // load stuff on GPU memory and creates multi-level images and computes gradients
+  PlaneSweepingCuda cps(cudaDeviceNo, ic, mp, sgmScale);
+
+  estimateAndRefineDepthMaps(cps, cams, sgmScale, sgmStep);
+#else
+  throw std::runtime_error("Cannot use the CUDA device " + std::to_string(cudaDeviceNo) + ": AliceVision is built without CUDA support.");
+#endif
+}
+
+void computeNormalMaps(int CUDADeviceNo, mvsUtils::MultiViewParams* mp, const StaticVector<int>& cams)
+{
+#if ALICEVISION_IS_DEFINED(ALICEVISION_HAVE_CUDA)
+  mvsUtils::ImagesCache ic(mp, imageIO::EImageColorSpace::LINEAR);
+  PlaneSweepingCuda cps(CUDADeviceNo, ic, mp, 1);
+
+  computeNormalMaps(cps, cams);
+#else
+  throw std::runtime_error("Cannot use the CUDA device " + std::to_string(CUDADeviceNo) + ": AliceVision is built without CUDA support.");
+#endif
+}
+
+void computeNormalMaps(mvsUtils::MultiViewParams* mp, const StaticVector<int>& cams, EDepthMapBackend backend)
 {
+  if(getActiveBackend(backend) == EDepthMapBackend::CPU)
+  {
+    mvsUtils::ImagesCache ic(mp, imageIO::EImageColorSpace::LINEAR);
+    PlaneSweepingCpu cps(ic, mp, 1);
+
+    computeNormalMaps(cps, cams);
+    return;
+  }
+
+#if ALICEVISION_IS_DEFINED(ALICEVISION_HAVE_CUDA)
   const int nbGPUs = listCUDADevices(true);
   const int nbCPUThreads = omp_get_num_procs();
 
@@ -461,11 +546,8 @@ void computeNormalMaps(mvsUtils::MultiViewParams* mp, const StaticVector<int>& c
       computeNormalMaps(CUDADeviceNo, mp, subcams);
     }
   }
+#endif
 }
 
-
-
-
-
 } // namespace depthMap
 } // namespace aliceVision
@@ -7,6 +7,7 @@
 #pragma once
 
 #include <aliceVision/mvsData/StaticVector.hpp>
+#include <aliceVision/depthMap/DepthMapBackend.hpp>
 #include <aliceVision/depthMap/SemiGlobalMatchingRc.hpp>
 
 namespace aliceVision {
@@ -42,11 +43,18 @@ private:
     DepthSimMap* optimizeDepthSimMapCUDA(DepthSimMap* depthPixSizeMapVis, DepthSimMap* depthSimMapPhoto);
 };
 
-void estimateAndRefineDepthMaps(mvsUtils::MultiViewParams* mp, const std::vector<int>& cams, int nbGPUs);
+/**
+ * @brief Estimate and refine the depth maps of the cameras.
+ * @param[in] nbGPUs number of CUDA devices to use (0 to use all the devices)
+ * @param[in] backend plane sweeping implementation, AUTO uses CUDA if a compatible device is available
+ */
+void estimateAndRefineDepthMaps(mvsUtils::MultiViewParams* mp, const std::vector<int>& cams, int nbGPUs,
+                                EDepthMapBackend backend = EDepthMapBackend::AUTO);
 void estimateAndRefineDepthMaps(int cudaDeviceNo, mvsUtils::MultiViewParams* mp, const std::vector<int>& cams);
 
 void computeNormalMaps(int CUDADeviceNo, mvsUtils::MultiViewParams* mp, const StaticVector<int>& cams);
-void computeNormalMaps(mvsUtils::MultiViewParams* mp, const StaticVector<int>& cams);
+void computeNormalMaps(mvsUtils::MultiViewParams* mp, const StaticVector<int>& cams,
+                       EDepthMapBackend backend = EDepthMapBackend::AUTO);
 
 } // namespace depthMap
 } // namespace aliceVision
@@ -11,7 +11,7 @@
 #include <aliceVision/mvsUtils/ImagesCache.hpp>
 #include <aliceVision/depthMap/DepthSimMap.hpp>
 #include <aliceVision/depthMap/RcTc.hpp>
-#include <aliceVision/depthMap/cuda/PlaneSweepingCuda.hpp>
+#include <aliceVision/depthMap/PlaneSweeping.hpp>
 
 namespace aliceVision {
 namespace depthMap {
@@ -21,7 +21,7 @@ class SemiGlobalMatchingParams
 public:
     mvsUtils::MultiViewParams* mp;
     RcTc* prt;
-    PlaneSweepingCuda& cps;
+    PlaneSweeping& cps;
     bool exportIntermediateResults;
     bool doSmooth;
     // int   s_wsh;
@@ -55,7 +55,7 @@ public:
     bool useSilhouetteMaskCodedByColor;
     rgb silhouetteMaskColor;
 
-    SemiGlobalMatchingParams(mvsUtils::MultiViewParams* _mp, PlaneSweepingCuda& _cps);
+    SemiGlobalMatchingParams(mvsUtils::MultiViewParams* _mp, PlaneSweeping& _cps);
     ~SemiGlobalMatchingParams(void);
 
     DepthSimMap* getDepthSimMapFromBestIdVal(int w, int h, StaticVector<IdValue>* volumeBestIdVal, int scale,
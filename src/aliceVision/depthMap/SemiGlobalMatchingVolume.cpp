@@ -6,6 +6,7 @@
 
 #include "SemiGlobalMatchingVolume.hpp"
 #include <aliceVision/system/Logger.hpp>
+#include <aliceVision/mvsData/geometry.hpp>
 #include <aliceVision/mvsData/Point3d.hpp>
 #include <aliceVision/mvsData/jetColorMap.hpp>
 #include <aliceVision/mvsUtils/common.hpp>
@@ -0,0 +1,258 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2020 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include "PlaneSweepingCpu.hpp"
+#include "sgm_aggregation_cpu.hpp"
+#include <aliceVision/system/Logger.hpp>
+#include <aliceVision/system/MemoryInfo.hpp>
+#include <aliceVision/mvsUtils/common.hpp>
+
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+
+namespace aliceVision {
+namespace depthMap {
+
+PlaneSweepingCpu::PlaneSweepingCpu(mvsUtils::ImagesCache& ic, mvsUtils::MultiViewParams* _mp, int scales)
+    : PlaneSweeping(ic, _mp, scales)
+{
+    varianceWSH = mp->userParams.get<int>("global.varianceWSH", 4);
+    sgmNbPaths = mp->userParams.get<int>("semiGlobalMatching.nbPaths", 4);
+    // checked here, the SGM aggregation runs in parallel loops
+    if(sgmNbPaths != 4 && sgmNbPaths != 8)
+        throw std::invalid_argument("Invalid number of SGM paths (semiGlobalMatching.nbPaths): " +
+                                    std::to_string(sgmNbPaths) + ", it should be 4 or 8.");
+    _maxPyramidsSize = std::size_t(mp->userParams.get<int>("images_cache.maxmbCPUPyramids", 1000)) * 1024 * 1024;
+
+    ALICEVISION_LOG_INFO("PlaneSweepingCpu:" << std::endl
+                         << "\t- scales: " << _scales << std::endl
+                         << "\t- varianceWSH: " << varianceWSH << std::endl
+                         << "\t- SGM paths: " << sgmNbPaths << " (" << sgm_cpu_getBestKernel() << ")" << std::endl
+                         << "\t- max pyramids cache size: " << _maxPyramidsSize / (1024 * 1024) << " MB");
+}
+
+PlaneSweepingCpu::LabPyramidPtr PlaneSweepingCpu::getPyramid(int camId)
+{
+    std::lock_guard<std::mutex> lock(_pyramidsMutex);
+
+    const auto it = _pyramids.find(camId);
+    if(it != _pyramids.end())
+    {
+        _pyramidsLRU.remove(camId);
+        _pyramidsLRU.push_front(camId);
+        return it->second;
+    }
+
+    long t1 = clock();
+
+    std::shared_ptr<LabPyramid> pyramid = std::make_shared<LabPyramid>();
+    {
+        mvsUtils::ImagesCache::ImgSharedPtr img = _ic.getImg_sync(camId);
+        ps_cpu_computeLabPyramid(*img, _scales, varianceWSH, *pyramid);
+    }
+
+    if(_verbose)
+        mvsUtils::printfElapsedTime(t1, "compute Lab pyramid ");
+
+    std::size_t pyramidSize = 0;
+    for(const LabImage& level : *pyramid)
+        pyramidSize += level.data.size() * sizeof(LabPixel);
+
+    // remove the least recently used pyramids, the ones in use are kept alive by their shared pointers
+    while(!_pyramidsLRU.empty() && _pyramidsSize + pyramidSize > _maxPyramidsSize)
+    {
+        const int oldestCamId = _pyramidsLRU.back();
+        _pyramidsLRU.pop_back();
+        for(const LabImage& level : *_pyramids.at(oldestCamId))
+            _pyramidsSize -= level.data.size() * sizeof(LabPixel);
+        _pyramids.erase(oldestCamId);
+    }
+
+    _pyramids[camId] = pyramid;
+    _pyramidsLRU.push_front(camId);
+    _pyramidsSize += pyramidSize;
+    return pyramid;
+}
+
+CameraCpu PlaneSweepingCpu::getCamera(int camId, int scale) const
+{
+    return ps_cpu_createCamera(mp->KArr[camId], mp->RArr[camId], mp->iRArr[camId], mp->CArr[camId], scale);
+}
+
+// (avail, total, used)
+Point3d PlaneSweepingCpu::getDeviceMemoryInfo()
+{
+    const system::MemoryInfo memInfo = system::getMemoryInfo();
+    const double toMB = 1.0 / (1024.0 * 1024.0);
+    return Point3d(memInfo.freeRam * toMB, memInfo.totalRam * toMB, (memInfo.totalRam - memInfo.freeRam) * toMB);
+}
+
+float PlaneSweepingCpu::sweepPixelsToVolume(int nDepthsToSearch, StaticVector<unsigned char>* volume, int volDimX,
+                                            int volDimY, int volDimZ, int volStepXY, int volLUX, int volLUY,
+                                            int volLUZ, const std::vector<float>* depths, int rc, int wsh, float gammaC,
+                                            float gammaP, StaticVector<Voxel>* pixels, int scale, int step,
+                                            StaticVector<int>* tcams, float epipShift)
+{
+    if(_verbose)
+        ALICEVISION_LOG_DEBUG("sweepPixelsVolume:" << std::endl
+                              << "\t- scale: " << scale << std::endl
+                              << "\t- step: " << step << std::endl
+                              << "\t- npixels: " << pixels->size() << std::endl
+                              << "\t- volStepXY: " << volStepXY << std::endl
+                              << "\t- volDimX: " << volDimX << std::endl
+                              << "\t- volDimY: " << volDimY << std::endl
+                              << "\t- volDimZ: " << volDimZ);
+
+    if((tcams->size() == 0) || (pixels->size() == 0))
+        return -1.0f;
+
+    long t1 = clock();
+
+    // as the CUDA backend, the volume is computed with the first target camera
+    const int tc = (*tcams)[0];
+    const LabPyramidPtr rPyramid = getPyramid(rc);
+    const LabPyramidPtr tPyramid = getPyramid(tc);
+
+    std::fill(volume->getDataWritable().begin(), volume->getDataWritable().end(), 255);
+
+    ps_cpu_sweepPixelsToVolume(*volume, volDimX, volDimY, volDimZ, volStepXY, volLUX, volLUY, volLUZ, *depths,
+                               *pixels, nDepthsToSearch, getCamera(rc, scale), (*rPyramid)[scale - 1],
+                               getCamera(tc, scale), (*tPyramid)[scale - 1], wsh, gammaC, gammaP, epipShift);
+
+    if(_verbose)
+        mvsUtils::printfElapsedTime(t1);
+
+    return float(volDimX) * float(volDimY) * float(volDimZ) / (1024.0f * 1024.0f);
+}
+
+/**
+ * @param[inout] volume input similarity volume (after Z reduction)
+ */
+bool PlaneSweepingCpu::SGMoptimizeSimVolume(int rc, StaticVector<unsigned char>* volume,
+                                            int volDimX, int volDimY, int volDimZ,
+                                            int volStepXY, int volLUX, int volLUY, int scale,
+                                            unsigned char P1, unsigned char P2)
+{
+    if(_verbose)
+        ALICEVISION_LOG_DEBUG("SGM optimizing volume:" << std::endl
+                              << "\t- volDimX: " << volDimX << std::endl
+                              << "\t- volDimY: " << volDimY << std::endl
+                              << "\t- volDimZ: " << volDimZ);
+
+    long t1 = clock();
+
+    // as the CUDA backend, P2 is adapted to the color gradient of the image
+    const LabPyramidPtr rPyramid = getPyramid(rc);
+    ps_cpu_SGMoptimizeSimVolume(*volume, volDimX, volDimY, volDimZ, volStepXY, volLUX, volLUY,
+                                (*rPyramid)[scale - 1], P1, sgmNbPaths);
+
+    if(_verbose)
+        mvsUtils::printfElapsedTime(t1);
+
+    return true;
+}
+
+bool PlaneSweepingCpu::refineRcTcDepthMap(bool useTcOrRcPixSize, int nStepsToRefine, StaticVector<float>* simMap,
+                                          StaticVector<float>* rcDepthMap, int rc, int tc, int scale, int wsh,
+                                          float gammaC, float gammaP, float epipShift, int xFrom, int wPart)
+{
+    const int h = mp->getHeight(rc) / scale;
+
+    long t1 = clock();
+
+    if(_verbose)
+        ALICEVISION_LOG_DEBUG("\t- rc: " << rc << std::endl << "\t- tcams: " << tc);
+
+    const LabPyramidPtr rPyramid = getPyramid(rc);
+    const LabPyramidPtr tPyramid = getPyramid(tc);
+
+    ps_cpu_refineRcDepthMap(*simMap, *rcDepthMap, nStepsToRefine, getCamera(rc, scale), (*rPyramid)[scale - 1],
+                            getCamera(tc, scale), (*tPyramid)[scale - 1], wPart, h, xFrom, wsh, gammaC, gammaP,
+                            epipShift, useTcOrRcPixSize);
+
+    if(_verbose)
+        mvsUtils::printfElapsedTime(t1);
+
+    return true;
+}
+
+bool PlaneSweepingCpu::fuseDepthSimMapsGaussianKernelVoting(int w, int h, StaticVector<DepthSim>* oDepthSimMap,
+                                                            const StaticVector<StaticVector<DepthSim>*>* dataMaps,
+                                                            int nSamplesHalf, int nDepthsToRefine, float sigma)
+{
+    long t1 = clock();
+
+    ps_cpu_fuseDepthSimMapsGaussianKernelVoting(*oDepthSimMap, *dataMaps, w, h, nSamplesHalf, nDepthsToRefine, sigma);
+
+    if(_verbose)
+        mvsUtils::printfElapsedTime(t1);
+
+    return true;
+}
+
+bool PlaneSweepingCpu::optimizeDepthSimMapGradientDescent(StaticVector<DepthSim>* oDepthSimMap,
+                                                          StaticVector<StaticVector<DepthSim>*>* dataMaps, int rc,
+                                                          int nSamplesHalf, int nDepthsToRefine, float sigma,
+                                                          int nIters, int yFrom, int hPart)
+{
+    if(_verbose)
+        ALICEVISION_LOG_DEBUG("optimizeDepthSimMapGradientDescent.");
+
+    const int scale = 1;
+    const int w = mp->getWidth(rc);
+
+    long t1 = clock();
+
+    const LabPyramidPtr rPyramid = getPyramid(rc);
+    ps_cpu_optimizeDepthSimMapGradientDescent(*oDepthSimMap, *(*dataMaps)[0], *(*dataMaps)[1], getCamera(rc, scale),
+                                              (*rPyramid)[scale - 1], w, yFrom, hPart, nIters);
+
+    if(_verbose)
+        mvsUtils::printfElapsedTime(t1);
+
+    return true;
+}
+
+bool PlaneSweepingCpu::computeNormalMap(StaticVector<float>* depthMap, StaticVector<Color>* normalMap, int rc,
+                                        int scale, float igammaC, float igammaP, int wsh)
+{
+    const int w = mp->getWidth(rc) / scale;
+    const int h = mp->getHeight(rc) / scale;
+
+    const long t1 = clock();
+
+    ALICEVISION_LOG_DEBUG("computeNormalMap rc: " << rc);
+
+    ps_cpu_computeNormalMap(*normalMap, *depthMap, getCamera(rc, scale), w, h, wsh);
+
+    if(_verbose)
+        mvsUtils::printfElapsedTime(t1);
+
+    return true;
+}
+
+bool PlaneSweepingCpu::getSilhoueteMap(StaticVectorBool* oMap, int scale, int step, const rgb maskColor, int rc)
+{
+    if(_verbose)
+        ALICEVISION_LOG_DEBUG("getSilhoueteeMap: rc: " << rc);
+
+    const int w = mp->getWidth(rc) / scale;
+    const int h = mp->getHeight(rc) / scale;
+
+    long t1 = clock();
+
+    const LabPyramidPtr rPyramid = getPyramid(rc);
+    ps_cpu_getSilhoueteMap(*oMap, (*rPyramid)[scale - 1], w / step, h / step, step, maskColor);
+
+    if(_verbose)
+        mvsUtils::printfElapsedTime(t1);
+
+    return true;
+}
+
+} // namespace depthMap
+} // namespace aliceVision
@@ -0,0 +1,77 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2020 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#pragma once
+
+#include <aliceVision/depthMap/PlaneSweeping.hpp>
+#include <aliceVision/depthMap/cpu/plane_sweeping_cpu.hpp>
+
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+
+namespace aliceVision {
+namespace depthMap {
+
+/**
+ * @brief CPU implementation of the plane sweeping operations, multithreaded with OpenMP.
+ *
+ * The Lab pyramids of the cameras are kept in a cache bounded by "images_cache.maxmbCPUPyramids" (MB),
+ * as the images uploaded to the GPU by the CUDA backend.
+ */
+class PlaneSweepingCpu : public PlaneSweeping
+{
+public:
+    int varianceWSH;
+    /// number of SGM aggregation paths: 4 (as the CUDA backend) or 8
+    int sgmNbPaths;
+
+    PlaneSweepingCpu(mvsUtils::ImagesCache& ic, mvsUtils::MultiViewParams* _mp, int scales);
+    ~PlaneSweepingCpu() override = default;
+
+    Point3d getDeviceMemoryInfo() override;
+
+    float sweepPixelsToVolume(int nDepthsToSearch, StaticVector<unsigned char>* volume, int volDimX, int volDimY,
+                              int volDimZ, int volStepXY, int volLUX, int volLUY, int volLUZ,
+                              const std::vector<float>* depths, int rc, int wsh, float gammaC, float gammaP,
+                              StaticVector<Voxel>* pixels, int scale, int step, StaticVector<int>* tcams,
+                              float epipShift) override;
+    bool SGMoptimizeSimVolume(int rc, StaticVector<unsigned char>* volume, int volDimX, int volDimY, int volDimZ,
+                              int volStepXY, int volLUX, int volLUY, int scale, unsigned char P1,
+                              unsigned char P2) override;
+    bool refineRcTcDepthMap(bool useTcOrRcPixSize, int nStepsToRefine, StaticVector<float>* simMap,
+                            StaticVector<float>* rcDepthMap, int rc, int tc, int scale, int wsh, float gammaC,
+                            float gammaP, float epipShift, int xFrom, int wPart) override;
+    bool fuseDepthSimMapsGaussianKernelVoting(int w, int h, StaticVector<DepthSim>* oDepthSimMap,
+                                              const StaticVector<StaticVector<DepthSim>*>* dataMaps,
+                                              int nSamplesHalf, int nDepthsToRefine, float sigma) override;
+    bool optimizeDepthSimMapGradientDescent(StaticVector<DepthSim>* oDepthSimMap,
+                                            StaticVector<StaticVector<DepthSim>*>* dataMaps, int rc,
+                                            int nSamplesHalf, int nDepthsToRefine, float sigma, int nIters,
+                                            int yFrom, int hPart) override;
+    bool computeNormalMap(StaticVector<float>* depthMap, StaticVector<Color>* normalMap, int rc, int scale,
+                          float igammaC, float igammaP, int wsh) override;
+    bool getSilhoueteMap(StaticVectorBool* oMap, int scale, int step, const rgb maskColor, int rc) override;
+
+private:
+    using LabPyramidPtr = std::shared_ptr<const LabPyramid>;
+
+    /// get the Lab pyramid of the camera, computed from the images cache if needed
+    LabPyramidPtr getPyramid(int camId);
+
+    CameraCpu getCamera(int camId, int scale) const;
+
+    std::mutex _pyramidsMutex;
+    std::map<int, LabPyramidPtr> _pyramids;
+    /// cameras of the pyramids, the most recently used first
+    std::list<int> _pyramidsLRU;
+    std::size_t _pyramidsSize = 0;
+    std::size_t _maxPyramidsSize;
+};
+
+} // namespace depthMap
+} // namespace aliceVision
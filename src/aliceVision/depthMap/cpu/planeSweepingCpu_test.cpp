@@ -0,0 +1,409 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2020 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include <aliceVision/depthMap/cpu/plane_sweeping_cpu.hpp>
+#include <aliceVision/depthMap/cpu/sgm_aggregation_cpu.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <vector>
+
+#define BOOST_TEST_MODULE depthMapPlaneSweepingCpu
+
+#include <boost/test/unit_test.hpp>
+#include <boost/test/floating_point_comparison.hpp>
+
+using namespace aliceVision;
+using namespace aliceVision::depthMap;
+
+namespace {
+
+// synthetic scene: a textured plane z = planeZ seen by two cameras looking at +z
+const int width = 160;
+const int height = 120;
+const double focal = 200.0;
+const double baseline = 1.0;
+const double planeZ = 10.0;
+
+Matrix3x3 getK()
+{
+    Matrix3x3 K = diag3x3(focal, focal, 1.0);
+    K.m13 = width / 2.0;
+    K.m23 = height / 2.0;
+    return K;
+}
+
+CameraCpu getCamera(const Point3d& C, int scale = 1)
+{
+    const Matrix3x3 I = diag3x3(1.0, 1.0, 1.0);
+    return ps_cpu_createCamera(getK(), I, I, C, scale);
+}
+
+float texture(double u, double v)
+{
+    return static_cast<float>(0.5 + 0.2 * std::sin(2.3 * u + 0.7 * v) + 0.15 * std::sin(1.1 * u - 3.1 * v) +
+                              0.1 * std::sin(5.3 * u * v));
+}
+
+/// render the plane by ray casting
+Image renderImage(const Point3d& C)
+{
+    Image img(width, height);
+    for(int y = 0; y < height; ++y)
+    {
+        for(int x = 0; x < width; ++x)
+        {
+            const double t = (planeZ - C.z);
+            const double u = C.x + t * (x - width / 2.0) / focal;
+            const double v = C.y + t * (y - height / 2.0) / focal;
+            const float g = texture(u, v);
+            img.at(x, y) = Color(g, g, g);
+        }
+    }
+    return img;
+}
+
+/// distance to the camera center of the plane point seen by the pixel
+float planeDepthFromRC(int x, int y)
+{
+    const double dx = (x - width / 2.0) / focal;
+    const double dy = (y - height / 2.0) / focal;
+    return static_cast<float>(planeZ * std::sqrt(dx * dx + dy * dy + 1.0));
+}
+
+struct Scene
+{
+    CameraCpu rCam = getCamera(Point3d(0.0, 0.0, 0.0));
+    CameraCpu tCam = getCamera(Point3d(baseline, 0.0, 0.0));
+    LabPyramid rPyramid;
+    LabPyramid tPyramid;
+
+    Scene()
+    {
+        ps_cpu_computeLabPyramid(renderImage(Point3d(0.0, 0.0, 0.0)), 2, 4, rPyramid);
+        ps_cpu_computeLabPyramid(renderImage(Point3d(baseline, 0.0, 0.0)), 2, 4, tPyramid);
+    }
+};
+
+} // namespace
+
+BOOST_AUTO_TEST_CASE(planeSweepingCpu_labPyramid)
+{
+    const Scene scene;
+
+    BOOST_CHECK_EQUAL(2, scene.rPyramid.size());
+    BOOST_CHECK_EQUAL(width, scene.rPyramid[0].width);
+    BOOST_CHECK_EQUAL(height, scene.rPyramid[0].height);
+    BOOST_CHECK_EQUAL(width / 2, scene.rPyramid[1].width);
+    BOOST_CHECK_EQUAL(height / 2, scene.rPyramid[1].height);
+
+    // gray texture: neutral a and b channels
+    for(const LabPixel& p : scene.rPyramid[0].data)
+    {
+        BOOST_CHECK(std::abs(int(p.y)) <= 1);
+        BOOST_CHECK(std::abs(int(p.z)) <= 1);
+    }
+
+    // the downscaled level is a smoothed version of the level 0
+    const LabImage& level0 = scene.rPyramid[0];
+    const LabImage& level1 = scene.rPyramid[1];
+    double meanL0 = 0.0;
+    double meanL1 = 0.0;
+    for(const LabPixel& p : level0.data)
+        meanL0 += p.x;
+    for(const LabPixel& p : level1.data)
+        meanL1 += p.x;
+    meanL0 /= level0.data.size();
+    meanL1 /= level1.data.size();
+    BOOST_CHECK_SMALL(meanL0 - meanL1, 2.0);
+}
+
+BOOST_AUTO_TEST_CASE(planeSweepingCpu_sweepAndSGM)
+{
+    const Scene scene;
+
+    // fronto-parallel planes around the plane of the scene
+    std::vector<float> depths;
+    for(float d = 8.0f; d <= 12.0f; d += 0.05f)
+        depths.push_back(d);
+
+    const int volStepXY = 2;
+    const int volDimX = width / volStepXY;
+    const int volDimY = height / volStepXY;
+    const int volDimZ = static_cast<int>(depths.size());
+
+    StaticVector<Voxel> pixels;
+    for(int y = 0; y < volDimY; ++y)
+        for(int x = 0; x < volDimX; ++x)
+            pixels.push_back(Voxel(x * volStepXY, y * volStepXY, 0));
+
+    StaticVector<unsigned char> volume;
+    volume.resize(volDimX * volDimY * volDimZ, 255);
+
+    ps_cpu_sweepPixelsToVolume(volume, volDimX, volDimY, volDimZ, volStepXY, 0, 0, 0, depths, pixels, volDimZ,
+                               scene.rCam, scene.rPyramid[0], scene.tCam, scene.tPyramid[0], 4, 5.5f, 8.0f, 0.0f);
+
+    for(const int nbPaths : {4, 8})
+    {
+        StaticVector<unsigned char> optimizedVolume = volume;
+        ps_cpu_SGMoptimizeSimVolume(optimizedVolume, volDimX, volDimY, volDimZ, volStepXY, 0, 0, scene.rPyramid[0],
+                                    10, nbPaths);
+
+        // the best depth of the pixels seen by both cameras is the depth of the plane
+        int nbPixels = 0;
+        int nbInliers = 0;
+        for(int vy = 5; vy < volDimY - 5; ++vy)
+        {
+            // the target camera sees the plane shifted by 20 pixels
+            for(int vx = 20; vx < volDimX - 5; ++vx)
+            {
+                int bestZ = 0;
+                for(int vz = 1; vz < volDimZ; ++vz)
+                    if(optimizedVolume[(vz * volDimY + vy) * volDimX + vx] <
+                       optimizedVolume[(bestZ * volDimY + vy) * volDimX + vx])
+                        bestZ = vz;
+                ++nbPixels;
+                if(std::abs(depths[bestZ] - planeZ) <= 0.1)
+                    ++nbInliers;
+            }
+        }
+        BOOST_CHECK(nbInliers > 0.95 * nbPixels);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(planeSweepingCpu_sgmAggregation)
+{
+    // small volume with a number of depths which is not a multiple of the SIMD width
+    const int w = 23;
+    const int h = 17;
+    const int nbDepths = 37;
+    const unsigned char P1 = 10;
+
+    std::mt19937 gen(42);
+    std::uniform_int_distribution<int> distByte(0, 255);
+
+    std::vector<unsigned char> costs(w * h * nbDepths);
+    for(auto& c : costs)
+        c = static_cast<unsigned char>(distByte(gen));
+
+    for(const int nbPaths : {4, 8})
+    {
+        std::vector<unsigned char> P2(w * h * nbPaths);
+        for(auto& p : P2)
+            p = static_cast<unsigned char>(std::max(distByte(gen), int(P1)));
+
+        // straightforward SGM recursion on each path
+        std::vector<int> expected(costs.size(), 0);
+        for(int path = 0; path < nbPaths; ++path)
+        {
+            int dx, dy;
+            sgm_cpu_getPathDirection(path, dx, dy);
+            std::vector<int> L(costs.size(), 0);
+            for(int i = 0; i < h; ++i)
+            {
+                const int y = (dy < 0) ? h - 1 - i : i;
+                for(int j = 0; j < w; ++j)
+                {
+                    const int x = (dx < 0) ? w - 1 - j : j;
+                    const int px = x - dx;
+                    const int py = y - dy;
+                    const int pixel = y * w + x;
+                    const bool hasPrev = (px >= 0 && px < w && py >= 0 && py < h);
+                    const int* prev = hasPrev ? &L[(py * w + px) * nbDepths] : nullptr;
+                    const int prevMin = hasPrev ? *std::min_element(prev, prev + nbDepths) : 0;
+                    for(int d = 0; d < nbDepths; ++d)
+                    {
+                        int m = 0;
+                        if(hasPrev)
+                        {
+                            m = std::min(prev[d], prevMin + P2[pixel * nbPaths + path]);
+                            if(d > 0)
+                                m = std::min(m, prev[d - 1] + P1);
+                            if(d < nbDepths - 1)
+                                m = std::min(m, prev[d + 1] + P1);
+                        }
+                        L[pixel * nbDepths + d] = costs[pixel * nbDepths + d] + m - prevMin;
+                        expected[pixel * nbDepths + d] += L[pixel * nbDepths + d];
+                    }
+                }
+            }
+        }
+
+        for(const ESgmKernel kernel : {ESgmKernel::SCALAR, ESgmKernel::AVX2})
+        {
+            if(!sgm_cpu_isKernelSupported(kernel))
+                continue;
+            std::vector<unsigned short> aggregated(costs.size());
+            sgm_cpu_aggregateCosts(costs.data(), P2.data(), w, h, nbDepths, nbPaths, P1, aggregated.data(), kernel);
+
+            int nbDifferences = 0;
+            for(std::size_t i = 0; i < costs.size(); ++i)
+                if(int(aggregated[i]) != expected[i])
+                    ++nbDifferences;
+            BOOST_CHECK_MESSAGE(nbDifferences == 0, "kernel " << kernel << ", " << nbPaths << " paths: "
+                                                              << nbDifferences << " differences");
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE(planeSweepingCpu_refine)
+{
+    const Scene scene;
+
+    // refine the depths of a part of the columns, starting from a wrong depth
+    const int xFrom = 40;
+    const int wPart = 80;
+    const float depthOffset = 0.3f;
+
+    for(const bool moveByTcOrRc : {true, false})
+    {
+        StaticVector<float> depthMap;
+        StaticVector<float> simMap;
+        depthMap.resize(wPart * height);
+        simMap.resize(wPart * height);
+        for(int y = 0; y < height; ++y)
+            for(int x = 0; x < wPart; ++x)
+                depthMap[y * wPart + x] = planeDepthFromRC(x + xFrom, y) + depthOffset;
+
+        ps_cpu_refineRcDepthMap(simMap, depthMap, 31, scene.rCam, scene.rPyramid[0], scene.tCam, scene.tPyramid[0],
+                                wPart, height, xFrom, 3, 15.5f, 8.0f, 0.0f, moveByTcOrRc);
+
+        // the depths are refined up to a fraction of the step: a reference pixel size
+        // or the depth difference of one pixel along the epipolar line in the target image
+        double errorSum = 0.0;
+        double stepSum = 0.0;
+        int nbPixels = 0;
+        for(int y = 10; y < height - 10; ++y)
+        {
+            for(int x = 0; x < wPart; ++x)
+            {
+                const double depth = planeDepthFromRC(x + xFrom, y);
+                errorSum += std::abs(depthMap[y * wPart + x] - depth);
+                stepSum += moveByTcOrRc ? depth * depth / (focal * baseline) : depth / focal;
+                BOOST_CHECK(simMap[y * wPart + x] < 0.0f);
+                ++nbPixels;
+            }
+        }
+        BOOST_CHECK_LT(errorSum / nbPixels, 0.5 * stepSum / nbPixels);
+        BOOST_CHECK_LT(errorSum / nbPixels, depthOffset);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(planeSweepingCpu_fuseAndOptimize)
+{
+    const Scene scene;
+    const int nbPixels = width * height;
+
+    // mid depth map with an offset, target depth maps on the plane
+    StaticVector<DepthSim> midDepthPixSizeMap;
+    StaticVector<DepthSim> tcDepthSimMap;
+    midDepthPixSizeMap.resize(nbPixels);
+    tcDepthSimMap.resize(nbPixels);
+    for(int y = 0; y < height; ++y)
+    {
+        for(int x = 0; x < width; ++x)
+        {
+            const float depth = planeDepthFromRC(x, y);
+            const float pixSize = depth / focal;
+            midDepthPixSizeMap[y * width + x] = DepthSim(depth + 2.0f * pixSize, pixSize);
+            tcDepthSimMap[y * width + x] = DepthSim(depth, -0.9f);
+        }
+    }
+
+    StaticVector<StaticVector<DepthSim>*> dataMaps;
+    dataMaps.push_back(&midDepthPixSizeMap);
+    dataMaps.push_back(&tcDepthSimMap);
+    dataMaps.push_back(&tcDepthSimMap);
+
+    StaticVector<DepthSim> fusedMap;
+    fusedMap.resize(nbPixels);
+    ps_cpu_fuseDepthSimMapsGaussianKernelVoting(fusedMap, dataMaps, width, height, 150, 31, 15.0f);
+
+    for(int y = 0; y < height; ++y)
+    {
+        for(int x = 0; x < width; ++x)
+        {
+            const DepthSim& fused = fusedMap[y * width + x];
+            const float pixSize = midDepthPixSizeMap[y * width + x].sim;
+            BOOST_CHECK_SMALL(fused.depth - planeDepthFromRC(x, y), 0.1f * pixSize);
+            BOOST_CHECK(fused.sim < 0.0f);
+        }
+    }
+
+    // the optimization moves the depths to the fused depths, which are on a smooth surface
+    StaticVector<DepthSim> optimizedMap;
+    optimizedMap.resize(nbPixels);
+    ps_cpu_optimizeDepthSimMapGradientDescent(optimizedMap, midDepthPixSizeMap, fusedMap, scene.rCam,
+                                              scene.rPyramid[0], width, 0, height / 2, 100);
+    ps_cpu_optimizeDepthSimMapGradientDescent(optimizedMap, midDepthPixSizeMap, fusedMap, scene.rCam,
+                                              scene.rPyramid[0], width, height / 2, height - height / 2, 100);
+
+    double midError = 0.0;
+    double optError = 0.0;
+    for(int y = 0; y < height; ++y)
+    {
+        for(int x = 0; x < width; ++x)
+        {
+            const float depth = planeDepthFromRC(x, y);
+            midError += std::abs(midDepthPixSizeMap[y * width + x].depth - depth);
+            optError += std::abs(optimizedMap[y * width + x].depth - depth);
+        }
+    }
+    BOOST_CHECK(optError < 0.5 * midError);
+}
+
+BOOST_AUTO_TEST_CASE(planeSweepingCpu_normalMap)
+{
+    const CameraCpu rCam = getCamera(Point3d(0.0, 0.0, 0.0));
+
+    StaticVector<float> depthMap;
+    depthMap.resize(width * height);
+    for(int y = 0; y < height; ++y)
+        for(int x = 0; x < width; ++x)
+            depthMap[y * width + x] = (x < 10) ? -1.0f : planeDepthFromRC(x, y);
+
+    StaticVector<Color> normalMap;
+    normalMap.resize(width * height);
+    ps_cpu_computeNormalMap(normalMap, depthMap, rCam, width, height, 3);
+
+    for(int y = 0; y < height; ++y)
+    {
+        for(int x = 0; x < width; ++x)
+        {
+            const Color& n = normalMap[y * width + x];
+            if(x < 10)
+            {
+                BOOST_CHECK_EQUAL(-1.0f, n.r);
+                continue;
+            }
+            // the normal of the plane oriented to the camera
+            BOOST_CHECK_SMALL(n.r, 1e-3f);
+            BOOST_CHECK_SMALL(n.g, 1e-3f);
+            BOOST_CHECK_CLOSE(n.b, -1.0f, 1e-3f);
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE(planeSweepingCpu_silhouetteMap)
+{
+    Image img(width, height);
+    for(int y = 0; y < height; ++y)
+        for(int x = 0; x < width; ++x)
+            img.at(x, y) = (x < width / 2) ? Color(0.0f, 1.0f, 0.0f) : Color(0.5f, 0.2f, 0.1f);
+
+    LabPyramid pyramid;
+    ps_cpu_computeLabPyramid(img, 1, 0, pyramid);
+
+    const int step = 4;
+    StaticVectorBool silhouetteMap;
+    silhouetteMap.resize((width / step) * (height / step));
+    ps_cpu_getSilhoueteMap(silhouetteMap, pyramid[0], width / step, height / step, step, rgb(0, 255, 0));
+
+    for(int y = 0; y < height / step; ++y)
+        for(int x = 0; x < width / step; ++x)
+            BOOST_CHECK_EQUAL(x * step < width / 2, bool(silhouetteMap[y * (width / step) + x]));
+}
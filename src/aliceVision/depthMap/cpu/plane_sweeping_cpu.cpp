@@ -0,0 +1,778 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2020 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include "plane_sweeping_cpu.hpp"
+#include "sgm_aggregation_cpu.hpp"
+
+#include <aliceVision/mvsData/geometry.hpp>
+#include <aliceVision/mvsData/Point2d.hpp>
+#include <aliceVision/mvsData/Stat3d.hpp>
+
+#include <cmath>
+
+namespace aliceVision {
+namespace depthMap {
+
+namespace {
+
+inline float sigmoid(float zeroVal, float endVal, float sigwidth, float sigMid, float xval)
+{
+    return zeroVal + (endVal - zeroVal) * (1.0f / (1.0f + std::exp(10.0f * ((xval - sigMid) / sigwidth))));
+}
+
+inline float sigmoid2(float zeroVal, float endVal, float sigwidth, float sigMid, float xval)
+{
+    return zeroVal + (endVal - zeroVal) * (1.0f / (1.0f + std::exp(10.0f * ((sigMid - xval) / sigwidth))));
+}
+
+inline float labDistance(const Point4d& a, const Point4d& b)
+{
+    const float dx = a.x - b.x;
+    const float dy = a.y - b.y;
+    const float dz = a.z - b.z;
+    return std::sqrt(dx * dx + dy * dy + dz * dz);
+}
+
+inline float labDistance(const LabPixel& a, const LabPixel& b)
+{
+    const float dx = float(a.x) - float(b.x);
+    const float dy = float(a.y) - float(b.y);
+    const float dz = float(a.z) - float(b.z);
+    return std::sqrt(dx * dx + dy * dy + dz * dz);
+}
+
+inline unsigned char toUChar(float v)
+{
+    return static_cast<unsigned char>(std::min(std::max(v, 0.0f), 255.0f));
+}
+
+inline Point2d project(const CameraCpu& cam, const Point3d& p)
+{
+    const Point3d hp = cam.P * p;
+    return Point2d(hp.x / hp.z, hp.y / hp.z);
+}
+
+/// 3D point of the pixel on the fronto-parallel plane at the given depth
+inline Point3d get3DPointForPixelAndFrontoParellePlane(const CameraCpu& cam, const Point2d& pix, float fpPlaneDepth)
+{
+    const Point3d planep = cam.C + cam.ZVect * fpPlaneDepth;
+    const Point3d v = (cam.iP * pix).normalize();
+    return linePlaneIntersect(cam.C, v, planep, cam.ZVect);
+}
+
+/// 3D point of the pixel at the given depth (distance to the camera center)
+inline Point3d get3DPointForPixelAndDepthFromRC(const CameraCpu& cam, const Point2d& pix, float depth)
+{
+    const Point3d rpv = (cam.iP * pix).normalize();
+    return cam.C + rpv * depth;
+}
+
+/// size of a pixel of the camera at the 3D point
+inline float computePixSize(const CameraCpu& cam, const Point3d& p)
+{
+    const Point2d rp = project(cam, p);
+    const Point2d rp1(rp.x + 1.0, rp.y);
+    const Point3d refvect = (cam.iP * rp1).normalize();
+    return static_cast<float>(pointLineDistance3D(p, cam.C, refvect));
+}
+
+/**
+ * @brief Patch of the reference camera, as the patch of the CUDA backend:
+ *        the x axis is in the epipolar plane and d is the size of a reference pixel.
+ */
+struct Patch
+{
+    Point3d p;
+    Point3d n;
+    Point3d x;
+    Point3d y;
+    float d;
+};
+
+inline void computeRotCSEpip(Patch& ptch, const CameraCpu& rCam, const CameraCpu& tCam)
+{
+    const Point3d v1 = (rCam.C - ptch.p).normalize();
+    const Point3d v2 = (tCam.C - ptch.p).normalize();
+    ptch.y = cross(v1, v2).normalize();
+    ptch.n = ((v1 + v2) / 2.0).normalize();
+    ptch.x = cross(ptch.y, ptch.n);
+}
+
+inline void createPatch(Patch& ptch, const CameraCpu& rCam, const CameraCpu& tCam, const Point3d& p)
+{
+    ptch.p = p;
+    ptch.d = computePixSize(rCam, p);
+    computeRotCSEpip(ptch, rCam, tCam);
+}
+
+/**
+ * @brief Weighted NCC of the patch in the reference and the target images (Yoon & Kweon weights).
+ *        The projections are linear in homogeneous coordinates, so the patch samples
+ *        are projected incrementally.
+ * @return similarity in [-1, 1], -1 is the best similarity
+ */
+float compNCCby3DptsYK(const Patch& ptch, const CameraCpu& rCam, const LabImage& rImg,
+                       const CameraCpu& tCam, const LabImage& tImg,
+                       int wsh, float gammaC, float gammaP, float epipShift)
+{
+    const Point2d rp = project(rCam, ptch.p);
+    Point2d tp = project(tCam, ptch.p);
+
+    Point2d vEpipShift(0.0, 0.0);
+    if(epipShift != 0.0f)
+    {
+        const Point2d tvUp = project(tCam, ptch.p + ptch.y * (ptch.d * 10.0f)) - tp;
+        const double len = std::sqrt(tvUp.x * tvUp.x + tvUp.y * tvUp.y);
+        if(len > 0.0)
+            vEpipShift = tvUp * (epipShift / len);
+        tp = tp + vEpipShift;
+    }
+
+    const float dd = wsh + 2.0f;
+    if((rp.x < dd) || (rp.x > float(rImg.width - 1) - dd) ||
+       (rp.y < dd) || (rp.y > float(rImg.height - 1) - dd) ||
+       (tp.x < dd) || (tp.x > float(tImg.width - 1) - dd) ||
+       (tp.y < dd) || (tp.y > float(tImg.height - 1) - dd))
+    {
+        return 1.0f;
+    }
+
+    const Point4d gcr = rImg.sample(rp.x, rp.y);
+    const Point4d gct = tImg.sample(tp.x, tp.y);
+
+    // homogeneous projections of the first sample of the patch and of the steps along the patch axes
+    const Matrix3x3 rM = rCam.P.sub3x3();
+    const Matrix3x3 tM = tCam.P.sub3x3();
+    const Point3d stepX = ptch.x * ptch.d;
+    const Point3d stepY = ptch.y * ptch.d;
+    const Point3d rStepX = rM * stepX;
+    const Point3d rStepY = rM * stepY;
+    const Point3d tStepX = tM * stepX;
+    const Point3d tStepY = tM * stepY;
+    const Point3d p0 = ptch.p - stepX * double(wsh) - stepY * double(wsh);
+    Point3d rRow = rCam.P * p0;
+    Point3d tRow = tCam.P * p0;
+
+    double wsum = 0.0;
+    double xsum = 0.0;
+    double ysum = 0.0;
+    double xxsum = 0.0;
+    double yysum = 0.0;
+    double xysum = 0.0;
+
+    for(int yp = -wsh; yp <= wsh; ++yp)
+    {
+        Point3d rh = rRow;
+        Point3d th = tRow;
+        for(int xp = -wsh; xp <= wsh; ++xp)
+        {
+            const Point4d gcr1 = rImg.sample(rh.x / rh.z, rh.y / rh.z);
+            const Point4d gct1 = tImg.sample(th.x / th.z + vEpipShift.x, th.y / th.z + vEpipShift.y);
+
+            // weights on the color difference to the center of the patch and on the distance to the center
+            const float deltaP = std::sqrt(float(xp * xp + yp * yp));
+            const float w = std::exp(-(labDistance(gcr, gcr1) / gammaC + deltaP / gammaP)) *
+                            std::exp(-(labDistance(gct, gct1) / gammaC + deltaP / gammaP));
+
+            wsum += w;
+            xsum += w * gcr1.x;
+            ysum += w * gct1.x;
+            xxsum += w * gcr1.x * gcr1.x;
+            yysum += w * gct1.x * gct1.x;
+            xysum += w * gcr1.x * gct1.x;
+
+            rh = rh + rStepX;
+            th = th + tStepX;
+        }
+        rRow = rRow + rStepY;
+        tRow = tRow + tStepY;
+    }
+
+    const double varX = (xxsum - xsum * xsum / wsum) / wsum;
+    const double varY = (yysum - ysum * ysum / wsum) / wsum;
+    const double covXY = (xysum - xsum * ysum / wsum) / wsum;
+    float sim = static_cast<float>(covXY / std::sqrt(varX * varY));
+    sim = std::isinf(sim) ? 1.0f : -sim;
+    // fmax/fmin return the number if sim is NaN
+    return std::fmax(std::fmin(sim, 1.0f), -1.0f);
+}
+
+/// intersection of the rays of the reference pixel and of the target pixel
+inline bool triangulateMatchRef(const CameraCpu& rCam, const CameraCpu& tCam, const Point2d& refpix,
+                                const Point2d& tarpix, Point3d& out)
+{
+    const Point3d refvect = rCam.iP * refpix;
+    const Point3d tarvect = tCam.iP * tarpix;
+    float k, l;
+    Point3d llis, lli1, lli2;
+    if(!lineLineIntersect(&k, &l, &llis, &lli1, &lli2, rCam.C, rCam.C + refvect, tCam.C, tCam.C + tarvect))
+        return false;
+    out = rCam.C + refvect * k;
+    return true;
+}
+
+/// move the 3D point by step pixels along the epipolar line in the target image
+inline Point3d move3DPointByTcPixStep(const CameraCpu& rCam, const CameraCpu& tCam, const Point3d& p, float step)
+{
+    const Point2d rpd = project(rCam, p);
+    const Point2d tpo = project(tCam, p);
+    const Point3d prp1 = p + (rCam.C - p) / 2.0;
+    Point2d tpv = project(tCam, prp1) - tpo;
+    tpv = tpv / std::sqrt(tpv.x * tpv.x + tpv.y * tpv.y);
+    const Point2d tpd = tpo + tpv * step;
+    Point3d moved = p;
+    triangulateMatchRef(rCam, tCam, rpd, tpd, moved);
+    return moved;
+}
+
+/// move the 3D point by step reference pixels along the ray of the reference camera
+inline Point3d move3DPointByRcPixSize(const CameraCpu& rCam, const Point3d& p, float step)
+{
+    const Point3d rpv = (p - rCam.C).normalize();
+    return p + rpv * (step * computePixSize(rCam, p));
+}
+
+inline Point3d move3DPoint(const CameraCpu& rCam, const CameraCpu& tCam, const Point3d& p, float step,
+                           bool moveByTcOrRc)
+{
+    return moveByTcOrRc ? move3DPointByTcPixStep(rCam, tCam, p, step) : move3DPointByRcPixSize(rCam, p, step);
+}
+
+/// similarity and depth of the 3D point at depth moved by step pixels
+inline float refineSim(const CameraCpu& rCam, const LabImage& rImg, const CameraCpu& tCam, const LabImage& tImg,
+                       const Point2d& pix, float depth, float step, bool moveByTcOrRc,
+                       int wsh, float gammaC, float gammaP, float epipShift, float& movedDepth)
+{
+    if(depth <= 0.0f)
+    {
+        movedDepth = depth;
+        return 1.0f;
+    }
+    const Point3d p = move3DPoint(rCam, tCam, get3DPointForPixelAndDepthFromRC(rCam, pix, depth), step, moveByTcOrRc);
+    movedDepth = static_cast<float>((p - rCam.C).size());
+    Patch ptch;
+    createPatch(ptch, rCam, tCam, p);
+    return compNCCby3DptsYK(ptch, rCam, rImg, tCam, tImg, wsh, gammaC, gammaP, epipShift);
+}
+
+/// convert a linear RGB color (0..1) to the Lab values of the textures
+inline LabPixel rgb2lab(float r, float g, float b)
+{
+    // rgb to xyz
+    const float X = r * 0.4124564f + g * 0.3575761f + b * 0.1804375f;
+    const float Y = r * 0.2126729f + g * 0.7151522f + b * 0.0721750f;
+    const float Z = r * 0.0193339f + g * 0.1191920f + b * 0.9503041f;
+
+    // xyz to lab, D65 reference white
+    const auto f = [](float t)
+    {
+        return (t > 216.0f / 24389.0f) ? std::cbrt(t) : ((24389.0f / 27.0f) * t + 16.0f) / 116.0f;
+    };
+    const float fx = f(X / 0.95047f);
+    const float fy = f(Y / 1.0f);
+    const float fz = f(Z / 1.08883f);
+
+    LabPixel lab;
+    lab.x = toUChar((116.0f * fy - 16.0f) * 2.55f);
+    lab.y = toUChar(500.0f * (fx - fy) * 2.55f);
+    lab.z = toUChar(200.0f * (fy - fz) * 2.55f);
+    lab.w = 0;
+    return lab;
+}
+
+/// store the gradient magnitude of the L channel in the w channel
+void computeGradient(LabImage& img)
+{
+    std::vector<LabPixel> out(img.data);
+#pragma omp parallel for
+    for(int y = 0; y < img.height; ++y)
+    {
+        const int ym = std::max(y - 1, 0);
+        const int yp = std::min(y + 1, img.height - 1);
+        for(int x = 0; x < img.width; ++x)
+        {
+            const int xm = std::max(x - 1, 0);
+            const int xp = std::min(x + 1, img.width - 1);
+            const float gx = float(img.at(xm, y).x) - float(img.at(xp, y).x);
+            const float gy = float(img.at(x, ym).x) - float(img.at(x, yp).x);
+            out[y * img.width + x].w = toUChar(std::sqrt(gx * gx + gy * gy));
+        }
+    }
+    img.data.swap(out);
+}
+
+} // namespace
+
+CameraCpu ps_cpu_createCamera(const Matrix3x3& K, const Matrix3x3& R, const Matrix3x3& iR, const Point3d& C,
+                              int scale)
+{
+    const Matrix3x3 scaledK = diag3x3(1.0 / double(scale), 1.0 / double(scale), 1.0) * K;
+
+    CameraCpu cam;
+    cam.P = scaledK * (R | (Point3d(0.0, 0.0, 0.0) - R * C));
+    cam.iP = iR * scaledK.inverse();
+    cam.C = C;
+    cam.ZVect = (iR * Point3d(0.0, 0.0, 1.0)).normalize();
+    return cam;
+}
+
+void ps_cpu_computeLabPyramid(const Image& img, int nbScales, int varianceWSH, LabPyramid& pyramid)
+{
+    pyramid.resize(nbScales);
+
+    LabImage& level0 = pyramid[0];
+    level0.width = img.width();
+    level0.height = img.height();
+    level0.data.resize(level0.width * level0.height);
+
+#pragma omp parallel for
+    for(int y = 0; y < level0.height; ++y)
+    {
+        for(int x = 0; x < level0.width; ++x)
+        {
+            // same 8 bits quantization of the RGB values as the images uploaded to the GPU
+            const Color c = img.at(x, y) * 255.0f;
+            level0.data[y * level0.width + x] = rgb2lab(float(static_cast<unsigned char>(c.r)) / 255.0f,
+                                                         float(static_cast<unsigned char>(c.g)) / 255.0f,
+                                                         float(static_cast<unsigned char>(c.b)) / 255.0f);
+        }
+    }
+    if(varianceWSH > 0)
+        computeGradient(level0);
+
+    for(int s = 1; s < nbScales; ++s)
+    {
+        // gaussian downscale of the level 0 by (s + 1), as the CUDA pyramid
+        const int scale = s + 1;
+        const int radius = scale;
+        std::vector<float> gauss(2 * radius + 1);
+        for(int i = -radius; i <= radius; ++i)
+            gauss[i + radius] = std::exp(-float(i * i) / 2.0f);
+
+        LabImage& level = pyramid[s];
+        level.width = level0.width / scale;
+        level.height = level0.height / scale;
+        level.data.resize(level.width * level.height);
+
+#pragma omp parallel for
+        for(int y = 0; y < level.height; ++y)
+        {
+            for(int x = 0; x < level.width; ++x)
+            {
+                const float cx = float(x * scale) + float(scale) / 2.0f - 0.5f;
+                const float cy = float(y * scale) + float(scale) / 2.0f - 0.5f;
+                Point4d sum;
+                float wsum = 0.0f;
+                for(int i = -radius; i <= radius; ++i)
+                {
+                    for(int j = -radius; j <= radius; ++j)
+                    {
+                        const float w = gauss[i + radius] * gauss[j + radius];
+                        sum = sum + level0.sample(cx + float(j), cy + float(i)) * w;
+                        wsum += w;
+                    }
+                }
+                sum = sum / wsum;
+                LabPixel& out = level.data[y * level.width + x];
+                out.x = toUChar(sum.x);
+                out.y = toUChar(sum.y);
+                out.z = toUChar(sum.z);
+                out.w = toUChar(sum.w);
+            }
+        }
+        if(varianceWSH > 0)
+            computeGradient(level);
+    }
+}
+
+void ps_cpu_sweepPixelsToVolume(StaticVector<unsigned char>& volume, int volDimX, int volDimY, int volDimZ,
+                                int volStepXY, int volLUX, int volLUY, int volLUZ, const std::vector<float>& depths,
+                                const StaticVector<Voxel>& pixels, int nDepthsToSearch,
+                                const CameraCpu& rCam, const LabImage& rImg,
+                                const CameraCpu& tCam, const LabImage& tImg,
+                                int wsh, float gammaC, float gammaP, float epipShift)
+{
+    const int ndepths = static_cast<int>(depths.size());
+    const std::size_t sliceSize = std::size_t(volDimX) * std::size_t(volDimY);
+    unsigned char* volumeData = volume.getDataWritable().data();
+
+    // each pixel writes in its own column of the volume
+#pragma omp parallel for schedule(dynamic, 64)
+    for(int i = 0; i < pixels.size(); ++i)
+    {
+        const Voxel& pix = pixels[i];
+        const int vx = (pix.x - volLUX) / volStepXY;
+        const int vy = (pix.y - volLUY) / volStepXY;
+        if(vx < 0 || vx >= volDimX || vy < 0 || vy >= volDimY)
+            continue;
+
+        for(int sdpt = 0; sdpt < nDepthsToSearch; ++sdpt)
+        {
+            const int depthid = sdpt + pix.z;
+            if(depthid >= ndepths)
+                break;
+            const int vz = depthid - volLUZ;
+            if(vz < 0 || vz >= volDimZ)
+                continue;
+
+            Patch ptch;
+            createPatch(ptch, rCam, tCam,
+                        get3DPointForPixelAndFrontoParellePlane(rCam, Point2d(pix.x, pix.y), depths[depthid]));
+            const float sim = compNCCby3DptsYK(ptch, rCam, rImg, tCam, tImg, wsh, gammaC, gammaP, epipShift);
+
+            // sim in [-1, 1] to cost in [0, 255]
+            const float fsim = std::min(std::max((sim + 1.0f) / 2.0f, 0.0f), 1.0f);
+            const unsigned char cost = static_cast<unsigned char>(fsim * 255.0f);
+
+            unsigned char& vol = volumeData[vz * sliceSize + vy * volDimX + vx];
+            vol = std::min(vol, cost);
+        }
+    }
+}
+
+void ps_cpu_SGMoptimizeSimVolume(StaticVector<unsigned char>& volume, int volDimX, int volDimY, int volDimZ,
+                                 int volStepXY, int volLUX, int volLUY, const LabImage& rImg, unsigned char P1,
+                                 int nbPaths)
+{
+    const std::size_t sliceSize = std::size_t(volDimX) * std::size_t(volDimY);
+    const auto imgPix = [&](int vx, int vy) -> const LabPixel&
+    {
+        const int x = std::min(std::max(volLUX + vx * volStepXY, 0), rImg.width - 1);
+        const int y = std::min(std::max(volLUY + vy * volStepXY, 0), rImg.height - 1);
+        return rImg.at(x, y);
+    };
+
+    // the aggregation works on the depth-innermost layout, the volume is converted once in each direction
+    std::vector<unsigned char> costs(volume.size());
+    std::vector<unsigned char> P2(sliceSize * nbPaths);
+    const unsigned char* volumeData = volume.getData().data();
+
+#pragma omp parallel for
+    for(int vy = 0; vy < volDimY; ++vy)
+    {
+        for(int d = 0; d < volDimZ; ++d)
+        {
+            const unsigned char* slice = volumeData + d * sliceSize + std::size_t(vy) * volDimX;
+            for(int vx = 0; vx < volDimX; ++vx)
+                costs[(std::size_t(vy) * volDimX + vx) * volDimZ + d] = slice[vx];
+        }
+
+        // P2 is adapted to the color difference with the previous pixel of each path
+        for(int vx = 0; vx < volDimX; ++vx)
+        {
+            const LabPixel& c = imgPix(vx, vy);
+            for(int path = 0; path < nbPaths; ++path)
+            {
+                int dx, dy;
+                sgm_cpu_getPathDirection(path, dx, dy);
+                P2[(std::size_t(vy) * volDimX + vx) * nbPaths + path] =
+                    static_cast<unsigned char>(sigmoid(15.0f, 255.0f, 80.0f, 20.0f,
+                                                       labDistance(c, imgPix(vx - dx, vy - dy))));
+            }
+        }
+    }
+
+    std::vector<unsigned short> aggregated(costs.size());
+    sgm_cpu_aggregateCosts(costs.data(), P2.data(), volDimX, volDimY, volDimZ, nbPaths, P1, aggregated.data());
+
+    // average of the path costs
+    unsigned char* volumeDataWritable = volume.getDataWritable().data();
+#pragma omp parallel for
+    for(int vy = 0; vy < volDimY; ++vy)
+    {
+        for(int d = 0; d < volDimZ; ++d)
+        {
+            unsigned char* slice = volumeDataWritable + d * sliceSize + std::size_t(vy) * volDimX;
+            for(int vx = 0; vx < volDimX; ++vx)
+            {
+                const int sum = aggregated[(std::size_t(vy) * volDimX + vx) * volDimZ + d];
+                slice[vx] = static_cast<unsigned char>(std::min((sum + nbPaths / 2) / nbPaths, 255));
+            }
+        }
+    }
+}
+
+void ps_cpu_refineRcDepthMap(StaticVector<float>& simMap, StaticVector<float>& rcDepthMap, int nStepsToRefine,
+                             const CameraCpu& rCam, const LabImage& rImg,
+                             const CameraCpu& tCam, const LabImage& tImg,
+                             int width, int height, int xFrom, int wsh, float gammaC, float gammaP, float epipShift,
+                             bool moveByTcOrRc)
+{
+    const int halfSteps = (nStepsToRefine - 1) / 2;
+
+#pragma omp parallel for schedule(dynamic)
+    for(int y = 0; y < height; ++y)
+    {
+        for(int x = 0; x < width; ++x)
+        {
+            const Point2d pix(x + xFrom, y);
+            const float depth = rcDepthMap[y * width + x];
+
+            // best depth along the epipolar line
+            float bestSim = 1.0f;
+            float bestDepth = depth;
+            for(int i = 0; i < nStepsToRefine; ++i)
+            {
+                float movedDepth;
+                const float sim = refineSim(rCam, rImg, tCam, tImg, pix, depth, float(i - halfSteps), moveByTcOrRc,
+                                            wsh, gammaC, gammaP, epipShift, movedDepth);
+                if(i == 0 || sim < bestSim)
+                {
+                    bestSim = sim;
+                    bestDepth = movedDepth;
+                }
+            }
+
+            // sub-pixel refinement with a parabola through the neighbor steps
+            float dM1, dP1;
+            float simM1 = refineSim(rCam, rImg, tCam, tImg, pix, bestDepth, -1.0f, moveByTcOrRc,
+                                    wsh, gammaC, gammaP, epipShift, dM1);
+            float simP1 = refineSim(rCam, rImg, tCam, tImg, pix, bestDepth, +1.0f, moveByTcOrRc,
+                                    wsh, gammaC, gammaP, epipShift, dP1);
+            if(bestDepth <= 0.0f)
+            {
+                simM1 = 1.1f;
+                simP1 = 1.1f;
+            }
+            const float sim1 = (bestSim + 1.0f) / 2.0f;
+            simM1 = (simM1 + 1.0f) / 2.0f;
+            simP1 = (simP1 + 1.0f) / 2.0f;
+
+            float outDepth = bestDepth;
+            if((simM1 > sim1) && (simP1 > sim1))
+            {
+                const float dispStep = -((simP1 - simM1) / (2.0f * (simP1 + simM1 - 2.0f * sim1)));
+                const float floatDepthB = (dP1 + dM1) / 2.0f;
+                const float floatDepthA = floatDepthB - dM1;
+                const float floatDepth = floatDepthA * dispStep + floatDepthB;
+                if(floatDepth > 0.0f)
+                    outDepth = floatDepth;
+            }
+
+            rcDepthMap[y * width + x] = outDepth;
+            simMap[y * width + x] = bestSim;
+        }
+    }
+}
+
+void ps_cpu_fuseDepthSimMapsGaussianKernelVoting(StaticVector<DepthSim>& oDepthSimMap,
+                                                 const StaticVector<StaticVector<DepthSim>*>& dataMaps,
+                                                 int width, int height, int nSamplesHalf, int nDepthsToRefine,
+                                                 float sigma)
+{
+    const float samplesPerPixSize = float(nSamplesHalf / ((nDepthsToRefine - 1) / 2));
+    const float twoSigmaSq = 2.0f * sigma * sigma;
+
+#pragma omp parallel for
+    for(int y = 0; y < height; ++y)
+    {
+        for(int x = 0; x < width; ++x)
+        {
+            const int idx = y * width + x;
+            const DepthSim& midDepthPixSize = (*dataMaps[0])[idx];
+            const float midDepth = midDepthPixSize.depth;
+            const float step = midDepthPixSize.sim / samplesPerPixSize;
+
+            DepthSim out(-1.0f, 1.0f);
+            if(midDepth > 0.0f)
+            {
+                float bestVal = 0.0f;
+                int bestSample = 0;
+                for(int s = -nSamplesHalf; s <= nSamplesHalf; ++s)
+                {
+                    float val = 0.0f;
+                    for(int c = 1; c < dataMaps.size(); ++c)
+                    {
+                        const DepthSim& depthSim = (*dataMaps[c])[idx];
+                        if(depthSim.depth > 0.0f)
+                        {
+                            const float i = (midDepth - depthSim.depth) / step;
+                            const float simWeight = -sigmoid(0.0f, 1.0f, 0.7f, -0.7f, depthSim.sim);
+                            val += simWeight * std::exp(-((i - float(s)) * (i - float(s))) / twoSigmaSq);
+                        }
+                    }
+                    if(s == -nSamplesHalf || val < bestVal)
+                    {
+                        bestVal = val;
+                        bestSample = s;
+                    }
+                }
+                out = DepthSim(midDepth - float(bestSample) * step, bestVal);
+            }
+            oDepthSimMap[idx] = out;
+        }
+    }
+}
+
+void ps_cpu_optimizeDepthSimMapGradientDescent(StaticVector<DepthSim>& oDepthSimMap,
+                                               const StaticVector<DepthSim>& midDepthPixSizeMap,
+                                               const StaticVector<DepthSim>& fusedDepthSimMap,
+                                               const CameraCpu& rCam, const LabImage& rImg,
+                                               int width, int yFrom, int hPart, int nIters)
+{
+    const std::size_t offset = std::size_t(yFrom) * width;
+
+    std::vector<DepthSim> curr(width * hPart);
+    for(int i = 0; i < width * hPart; ++i)
+        curr[i] = DepthSim(midDepthPixSizeMap[offset + i].depth, fusedDepthSimMap[offset + i].sim);
+    std::vector<DepthSim> next(curr);
+
+    // 3D point of a pixel of the part at the current depth
+    const auto getPoint = [&](int x, int y, bool& valid) -> Point3d
+    {
+        const float depth = curr[y * width + x].depth;
+        valid = (depth > 0.0f);
+        return get3DPointForPixelAndDepthFromRC(rCam, Point2d(x, y + yFrom), depth);
+    };
+
+    for(int iter = 0; iter < nIters; ++iter)
+    {
+#pragma omp parallel for
+        for(int y = 0; y < hPart; ++y)
+        {
+            for(int x = 0; x < width; ++x)
+            {
+                const int idx = y * width + x;
+                const float midDepth = midDepthPixSizeMap[offset + idx].depth;
+                const float pixSize = midDepthPixSizeMap[offset + idx].sim;
+                const DepthSim& fused = fusedDepthSimMap[offset + idx];
+                const float depth = curr[idx].depth;
+
+                next[idx] = curr[idx];
+                if(depth <= 0.0f)
+                    continue;
+
+                bool valid0;
+                const Point3d p0 = getPoint(x, y, valid0);
+
+                // neighbors: up, bottom, left, right
+                bool validU, validB, validL, validR;
+                const Point3d pU = getPoint(x, std::max(y - 1, 0), validU);
+                const Point3d pB = getPoint(x, std::min(y + 1, hPart - 1), validB);
+                const Point3d pL = getPoint(std::max(x - 1, 0), y, validL);
+                const Point3d pR = getPoint(std::min(x + 1, width - 1), y, validR);
+
+                // smoothness step: to the plane of the neighbors
+                float smoothStep = 0.0f;
+                float energy = 180.0f;
+                const int nValid = int(validU) + int(validB) + int(validL) + int(validR);
+                if(nValid > 1)
+                {
+                    Point3d cg(0.0, 0.0, 0.0);
+                    if(validU) cg = cg + pU;
+                    if(validB) cg = cg + pB;
+                    if(validL) cg = cg + pL;
+                    if(validR) cg = cg + pR;
+                    cg = cg / double(nValid);
+
+                    const Point3d vcn = (rCam.C - p0).normalize();
+                    const Point3d pS = closestPointToLine3D(&cg, &p0, &vcn);
+                    smoothStep = static_cast<float>((rCam.C - pS).size()) - depth;
+
+                    float e = 0.0f;
+                    if(validL && validR)
+                        e = std::max(e, 180.0f - float(angleBetwABandAC(p0, pL, pR)));
+                    if(validU && validB)
+                        e = std::max(e, 180.0f - float(angleBetwABandAC(p0, pU, pB)));
+                    if((validL && validR) || (validU && validB))
+                        energy = e;
+                }
+
+                const float maxStep = pixSize / 10.0f;
+                smoothStep = std::min(std::max(smoothStep, -maxStep), maxStep);
+                float photoStep = fused.depth - depth;
+                photoStep = std::min(std::max(photoStep, -maxStep), maxStep);
+                const float visStep = midDepth - depth;
+
+                const float varianceGray = float(rImg.at(x, y + yFrom).w);
+                const float varianceWeight = sigmoid2(5.0f, 30.0f, 40.0f, 20.0f, varianceGray);
+                const float simWeight = sigmoid(0.0f, 1.0f, 0.7f, -0.7f, fused.sim);
+                const float photoWeight = sigmoid(0.0f, 1.0f, 30.0f, varianceWeight, energy);
+                const float smoothWeight = 1.0f - photoWeight;
+                const float visWeight = 1.0f - sigmoid(0.0f, 1.0f, 10.0f, 17.0f, std::fabs(visStep / pixSize));
+
+                const float depthOpt = depth + visWeight * visStep +
+                                       (1.0f - visWeight) * (photoWeight * simWeight * photoStep +
+                                                             smoothWeight * smoothStep);
+                const float simOpt = (1.0f - visWeight) * photoWeight * simWeight * fused.sim +
+                                     (1.0f - visWeight) * smoothWeight * (energy / 20.0f);
+                if(depthOpt > 0.0f)
+                    next[idx] = DepthSim(depthOpt, simOpt);
+            }
+        }
+        curr.swap(next);
+    }
+
+    for(int i = 0; i < width * hPart; ++i)
+        oDepthSimMap[offset + i] = curr[i];
+}
+
+void ps_cpu_computeNormalMap(StaticVector<Color>& normalMap, const StaticVector<float>& depthMap,
+                             const CameraCpu& rCam, int width, int height, int wsh)
+{
+#pragma omp parallel for schedule(dynamic)
+    for(int y = 0; y < height; ++y)
+    {
+        for(int x = 0; x < width; ++x)
+        {
+            const float depth = depthMap[y * width + x];
+            Color& out = normalMap[y * width + x];
+            out = Color(-1.0f, -1.0f, -1.0f);
+            if(depth <= 0.0f)
+                continue;
+
+            const Point3d p = get3DPointForPixelAndDepthFromRC(rCam, Point2d(x, y), depth);
+            const float pixSize = static_cast<float>(
+                (p - get3DPointForPixelAndDepthFromRC(rCam, Point2d(x + 1, y), depth)).size());
+
+            Stat3d s3d;
+            for(int yp = -wsh; yp <= wsh; ++yp)
+            {
+                const int yn = std::min(std::max(y + yp, 0), height - 1);
+                for(int xp = -wsh; xp <= wsh; ++xp)
+                {
+                    const int xn = std::min(std::max(x + xp, 0), width - 1);
+                    const float depthN = depthMap[yn * width + xn];
+                    if(depthN > 0.0f && std::fabs(depthN - depth) < 30.0f * pixSize)
+                    {
+                        Point3d pn = get3DPointForPixelAndDepthFromRC(rCam, Point2d(xn, yn), depthN);
+                        s3d.update(&pn);
+                    }
+                }
+            }
+            if(s3d.count < 3)
+                continue;
+
+            Point3d pp, nn, v2, v3;
+            float d1, d2, d3;
+            s3d.getEigenVectorsDesc(pp, v2, v3, nn, d1, d2, d3);
+            nn = nn.normalize();
+            if(orientedPointPlaneDistance(pp + nn, pp, (rCam.C - p).normalize()) < 0.0)
+                nn = nn * -1.0;
+            out = Color(nn.x, nn.y, nn.z);
+        }
+    }
+}
+
+void ps_cpu_getSilhoueteMap(StaticVectorBool& oMap, const LabImage& rImg, int width, int height, int step,
+                            const rgb& maskColor)
+{
+    const LabPixel maskLab = rgb2lab(float(maskColor.r) / 255.0f, float(maskColor.g) / 255.0f,
+                                     float(maskColor.b) / 255.0f);
+
+#pragma omp parallel for
+    for(int y = 0; y < height; ++y)
+    {
+        for(int x = 0; x < width; ++x)
+        {
+            const LabPixel& col = rImg.at(x * step, y * step);
+            oMap[y * width + x] = (col.x == maskLab.x) && (col.y == maskLab.y) && (col.z == maskLab.z);
+        }
+    }
+}
+
+} // namespace depthMap
+} // namespace aliceVision
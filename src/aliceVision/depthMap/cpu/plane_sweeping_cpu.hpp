@@ -0,0 +1,182 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2020 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#pragma once
+
+#include <aliceVision/mvsData/Color.hpp>
+#include <aliceVision/mvsData/Image.hpp>
+#include <aliceVision/mvsData/Matrix3x3.hpp>
+#include <aliceVision/mvsData/Matrix3x4.hpp>
+#include <aliceVision/mvsData/Point3d.hpp>
+#include <aliceVision/mvsData/Point4d.hpp>
+#include <aliceVision/mvsData/Rgb.hpp>
+#include <aliceVision/mvsData/StaticVector.hpp>
+#include <aliceVision/mvsData/Voxel.hpp>
+#include <aliceVision/depthMap/DepthSimMap.hpp>
+
+#include <algorithm>
+#include <vector>
+
+namespace aliceVision {
+namespace depthMap {
+
+/**
+ * @brief Pixel of the Lab images of the CPU backend, as the uchar4 textures of the CUDA backend.
+ *        x, y, z: CIELAB color scaled to (0..255), w: gradient magnitude of the L channel
+ */
+struct LabPixel
+{
+    unsigned char x = 0;
+    unsigned char y = 0;
+    unsigned char z = 0;
+    unsigned char w = 0;
+};
+
+/**
+ * @brief Lab image of one level of the pyramid of a camera.
+ */
+struct LabImage
+{
+    int width = 0;
+    int height = 0;
+    std::vector<LabPixel> data;
+
+    inline const LabPixel& at(int x, int y) const { return data[y * width + x]; }
+
+    /**
+     * @brief Bilinear interpolation at the pixel coordinates (x, y), clamped to the image borders.
+     *        Same values as tex2D(x + 0.5, y + 0.5) on the CUDA textures.
+     */
+    inline Point4d sample(float x, float y) const
+    {
+        const float fx = std::floor(x);
+        const float fy = std::floor(y);
+        const float ax = x - fx;
+        const float ay = y - fy;
+        const int x0 = std::min(std::max(static_cast<int>(fx), 0), width - 1);
+        const int y0 = std::min(std::max(static_cast<int>(fy), 0), height - 1);
+        const int x1 = std::min(std::max(static_cast<int>(fx) + 1, 0), width - 1);
+        const int y1 = std::min(std::max(static_cast<int>(fy) + 1, 0), height - 1);
+
+        const LabPixel& p00 = at(x0, y0);
+        const LabPixel& p10 = at(x1, y0);
+        const LabPixel& p01 = at(x0, y1);
+        const LabPixel& p11 = at(x1, y1);
+
+        const float w00 = (1.0f - ax) * (1.0f - ay);
+        const float w10 = ax * (1.0f - ay);
+        const float w01 = (1.0f - ax) * ay;
+        const float w11 = ax * ay;
+
+        return Point4d(w00 * p00.x + w10 * p10.x + w01 * p01.x + w11 * p11.x,
+                       w00 * p00.y + w10 * p10.y + w01 * p01.y + w11 * p11.y,
+                       w00 * p00.z + w10 * p10.z + w01 * p01.z + w11 * p11.z,
+                       w00 * p00.w + w10 * p10.w + w01 * p01.w + w11 * p11.w);
+    }
+};
+
+/// Levels of the pyramid of a camera, the level s is downscaled by (s + 1)
+using LabPyramid = std::vector<LabImage>;
+
+/**
+ * @brief Camera of the CPU backend at a given scale, as the cameraStruct of the CUDA backend.
+ */
+struct CameraCpu
+{
+    /// projection matrix (K scaled by 1/scale)
+    Matrix3x4 P;
+    /// inverse of the 3x3 part of the projection matrix: pixel to ray
+    Matrix3x3 iP;
+    /// camera center
+    Point3d C;
+    /// optical axis
+    Point3d ZVect;
+};
+
+/**
+ * @brief Create the camera matrices for the images downscaled by scale.
+ */
+CameraCpu ps_cpu_createCamera(const Matrix3x3& K, const Matrix3x3& R, const Matrix3x3& iR, const Point3d& C,
+                              int scale);
+
+/**
+ * @brief Compute the Lab pyramid of an image, as the textures of the CUDA backend.
+ * @param[in] img RGB image (0..1)
+ * @param[in] nbScales number of levels, the level s is downscaled by (s + 1)
+ * @param[in] varianceWSH if positive, store the gradient magnitude of L in the w channel
+ * @param[out] pyramid the levels of the pyramid
+ */
+void ps_cpu_computeLabPyramid(const Image& img, int nbScales, int varianceWSH, LabPyramid& pyramid);
+
+/**
+ * @brief Compute the similarity volume of the reference camera with a target camera.
+ *        The volume is indexed by z * volDimX * volDimY + y * volDimX + x.
+ */
+void ps_cpu_sweepPixelsToVolume(StaticVector<unsigned char>& volume, int volDimX, int volDimY, int volDimZ,
+                                int volStepXY, int volLUX, int volLUY, int volLUZ, const std::vector<float>& depths,
+                                const StaticVector<Voxel>& pixels, int nDepthsToSearch,
+                                const CameraCpu& rCam, const LabImage& rImg,
+                                const CameraCpu& tCam, const LabImage& tImg,
+                                int wsh, float gammaC, float gammaP, float epipShift);
+
+/**
+ * @brief Aggregate the similarity volume along 4 or 8 paths (Semi-Global Matching), see sgm_cpu_aggregateCosts.
+ *        The penalty P2 is adapted to the color gradient of the reference image.
+ * @param[inout] volume similarity volume indexed by z * volDimX * volDimY + y * volDimX + x,
+ *               replaced by the average of the path costs
+ */
+void ps_cpu_SGMoptimizeSimVolume(StaticVector<unsigned char>& volume, int volDimX, int volDimY, int volDimZ,
+                                 int volStepXY, int volLUX, int volLUY, const LabImage& rImg, unsigned char P1,
+                                 int nbPaths = 4);
+
+/**
+ * @brief Refine the depths of the columns [xFrom, xFrom + width) of the reference depth map
+ *        by moving each 3D point along the epipolar line.
+ * @param[out] simMap similarity map of the part (width x height)
+ * @param[inout] rcDepthMap depth map of the part (width x height)
+ */
+void ps_cpu_refineRcDepthMap(StaticVector<float>& simMap, StaticVector<float>& rcDepthMap, int nStepsToRefine,
+                             const CameraCpu& rCam, const LabImage& rImg,
+                             const CameraCpu& tCam, const LabImage& tImg,
+                             int width, int height, int xFrom, int wsh, float gammaC, float gammaP, float epipShift,
+                             bool moveByTcOrRc);
+
+/**
+ * @brief Fuse the depth/sim maps of the target cameras by gaussian kernel voting around the mid depth map.
+ * @param[in] dataMaps (mid depth, pixel size) map followed by the depth/sim maps of the target cameras
+ */
+void ps_cpu_fuseDepthSimMapsGaussianKernelVoting(StaticVector<DepthSim>& oDepthSimMap,
+                                                 const StaticVector<StaticVector<DepthSim>*>& dataMaps,
+                                                 int width, int height, int nSamplesHalf, int nDepthsToRefine,
+                                                 float sigma);
+
+/**
+ * @brief Optimize the rows [yFrom, yFrom + hPart) of the fused depth map by balancing
+ *        the photometric and the smoothness constraints.
+ * @param[in] midDepthPixSizeMap (mid depth, pixel size) map
+ * @param[in] fusedDepthSimMap fused depth/sim map
+ */
+void ps_cpu_optimizeDepthSimMapGradientDescent(StaticVector<DepthSim>& oDepthSimMap,
+                                               const StaticVector<DepthSim>& midDepthPixSizeMap,
+                                               const StaticVector<DepthSim>& fusedDepthSimMap,
+                                               const CameraCpu& rCam, const LabImage& rImg,
+                                               int width, int yFrom, int hPart, int nIters);
+
+/**
+ * @brief Compute the normal of each pixel of the depth map from the 3D points of its neighborhood.
+ *        The normals of the invalid pixels are (-1, -1, -1).
+ */
+void ps_cpu_computeNormalMap(StaticVector<Color>& normalMap, const StaticVector<float>& depthMap,
+                             const CameraCpu& rCam, int width, int height, int wsh);
+
+/**
+ * @brief Get the pixels (with a step) of the image with the mask color.
+ */
+void ps_cpu_getSilhoueteMap(StaticVectorBool& oMap, const LabImage& rImg, int width, int height, int step,
+                            const rgb& maskColor);
+
+} // namespace depthMap
+} // namespace aliceVision
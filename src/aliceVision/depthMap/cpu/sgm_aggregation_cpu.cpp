@@ -0,0 +1,299 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2020 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include "sgm_aggregation_cpu.hpp"
+
+#include <aliceVision/system/cpu.hpp>
+
+#include <limits>
+#include <vector>
+
+#if (defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)) && \
+    (defined(__clang__) || (defined(__GNUC__) && __GNUC__ >= 8) || (defined(_MSC_VER) && _MSC_VER >= 1920))
+#define ALICEVISION_SGM_KERNELS_X86
+#include <immintrin.h>
+#if defined(_MSC_VER) && !defined(__clang__)
+#define ALICEVISION_SGM_KERNEL_TARGET(isa)
+#else
+// allow the use of the instruction set in this function only, the caller is responsible for the CPU check
+#define ALICEVISION_SGM_KERNEL_TARGET(isa) __attribute__((target(isa)))
+#endif
+#endif
+
+namespace aliceVision {
+namespace depthMap {
+
+namespace {
+
+const unsigned short infiniteCost = std::numeric_limits<unsigned short>::max();
+
+inline unsigned short addSaturate(unsigned short a, unsigned short b)
+{
+    return static_cast<unsigned short>(std::min(int(a) + int(b), int(infiniteCost)));
+}
+
+/**
+ * @brief Compute the path costs of one pixel from the path costs of the previous pixel of the path
+ *        and add them to the aggregated costs.
+ * @param[in] cost matching costs of the pixel
+ * @param[in] prevL path costs of the previous pixel, padded with an infinite cost before and after the depths
+ * @param[in] prevMin minimum of the path costs of the previous pixel
+ * @param[out] L path costs of the pixel, padded as prevL
+ * @param[inout] aggregated aggregated costs of the pixel
+ * @return minimum of the path costs of the pixel
+ */
+typedef unsigned short (*PathKernel)(const unsigned char* cost, const unsigned short* prevL, unsigned short prevMin,
+                                     unsigned short P1, unsigned short P2, unsigned short* L,
+                                     unsigned short* aggregated, int nbDepths);
+
+/// path costs of the depths [dFrom, nbDepths), see PathKernel
+inline unsigned short pathCostsScalar(int dFrom, const unsigned char* cost, const unsigned short* prevL,
+                                      unsigned short prevMin, unsigned short P1, unsigned short P2,
+                                      unsigned short* L, unsigned short* aggregated, int nbDepths)
+{
+    const unsigned short prevMinP2 = addSaturate(prevMin, P2);
+    unsigned short minL = infiniteCost;
+    for(int d = dFrom; d < nbDepths; ++d)
+    {
+        // prevL[d + 1] is the cost of the depth d, prevL[d] and prevL[d + 2] the costs of its neighbors
+        const unsigned short neighbors = addSaturate(std::min(prevL[d], prevL[d + 2]), P1);
+        const unsigned short m = std::min(std::min(prevL[d + 1], neighbors), prevMinP2);
+        const unsigned short l = addSaturate(cost[d], static_cast<unsigned short>(m - prevMin));
+        L[d + 1] = l;
+        aggregated[d] = addSaturate(aggregated[d], l);
+        minL = std::min(minL, l);
+    }
+    return minL;
+}
+
+unsigned short pathCostsScalar(const unsigned char* cost, const unsigned short* prevL, unsigned short prevMin,
+                               unsigned short P1, unsigned short P2, unsigned short* L,
+                               unsigned short* aggregated, int nbDepths)
+{
+    return pathCostsScalar(0, cost, prevL, prevMin, P1, P2, L, aggregated, nbDepths);
+}
+
+#ifdef ALICEVISION_SGM_KERNELS_X86
+
+ALICEVISION_SGM_KERNEL_TARGET("avx2")
+unsigned short pathCostsAvx2(const unsigned char* cost, const unsigned short* prevL, unsigned short prevMin,
+                             unsigned short P1, unsigned short P2, unsigned short* L,
+                             unsigned short* aggregated, int nbDepths)
+{
+    const __m256i vP1 = _mm256_set1_epi16(static_cast<short>(P1));
+    const __m256i vPrevMin = _mm256_set1_epi16(static_cast<short>(prevMin));
+    const __m256i vPrevMinP2 = _mm256_set1_epi16(static_cast<short>(addSaturate(prevMin, P2)));
+    __m256i vMinL = _mm256_set1_epi16(static_cast<short>(infiniteCost));
+
+    // 16 depths per iteration, the neighbor depths are read with unaligned loads in the padded buffer
+    int d = 0;
+    for(; d + 16 <= nbDepths; d += 16)
+    {
+        const __m256i lPrev = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(prevL + d + 1));
+        const __m256i lPrevM1 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(prevL + d));
+        const __m256i lPrevP1 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(prevL + d + 2));
+        const __m256i neighbors = _mm256_adds_epu16(_mm256_min_epu16(lPrevM1, lPrevP1), vP1);
+        const __m256i m = _mm256_min_epu16(_mm256_min_epu16(lPrev, neighbors), vPrevMinP2);
+        const __m256i c = _mm256_cvtepu8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(cost + d)));
+        // m >= prevMin, the subtraction does not wrap
+        const __m256i l = _mm256_adds_epu16(c, _mm256_sub_epi16(m, vPrevMin));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(L + d + 1), l);
+        __m256i* agg = reinterpret_cast<__m256i*>(aggregated + d);
+        _mm256_storeu_si256(agg, _mm256_adds_epu16(_mm256_loadu_si256(agg), l));
+        vMinL = _mm256_min_epu16(vMinL, l);
+    }
+
+    // horizontal minimum of the 16 lanes
+    const __m128i minL128 = _mm_min_epu16(_mm256_castsi256_si128(vMinL), _mm256_extracti128_si256(vMinL, 1));
+    const unsigned short minL = static_cast<unsigned short>(_mm_cvtsi128_si32(_mm_minpos_epu16(minL128)) & 0xffff);
+
+    if(d == nbDepths)
+        return minL;
+    return std::min(minL, pathCostsScalar(d, cost, prevL, prevMin, P1, P2, L, aggregated, nbDepths));
+}
+
+#endif // ALICEVISION_SGM_KERNELS_X86
+
+PathKernel getPathKernel(ESgmKernel kernel)
+{
+    if(!sgm_cpu_isKernelSupported(kernel))
+        throw std::invalid_argument("SGM kernel not supported by the CPU: " + ESgmKernel_enumToString(kernel));
+#ifdef ALICEVISION_SGM_KERNELS_X86
+    if(kernel == ESgmKernel::AVX2)
+        return &pathCostsAvx2;
+#endif
+    return &pathCostsScalar;
+}
+
+/// buffer of path costs for nbPixels pixels, each one padded with an infinite cost before and after the depths
+std::vector<unsigned short> createPathBuffer(int nbPixels, int stride)
+{
+    std::vector<unsigned short> buffer(std::size_t(nbPixels) * stride, 0);
+    for(int i = 0; i < nbPixels; ++i)
+    {
+        buffer[std::size_t(i) * stride] = infiniteCost;
+        buffer[std::size_t(i) * stride + stride - 1] = infiniteCost;
+    }
+    return buffer;
+}
+
+/// number of pixels of the strips of the vertical and diagonal paths, so that the data of a strip fits in the L2 cache
+int getStripWidth(int nbDepths, int nbRowPaths)
+{
+    long cacheSize = system::get_cache_size(2);
+    if(cacheSize <= 0)
+        cacheSize = 256 * 1024;
+    // costs, aggregated costs and previous/current path costs of each pixel
+    const long bytesPerPixel = long(nbDepths) * (sizeof(unsigned char) + sizeof(unsigned short)) +
+                               2L * nbRowPaths * (nbDepths + 2) * sizeof(unsigned short);
+    // keep half of the cache for the other data
+    return static_cast<int>(std::max(1L, cacheSize / (2 * bytesPerPixel)));
+}
+
+} // namespace
+
+bool sgm_cpu_isKernelSupported(ESgmKernel kernel)
+{
+    switch(kernel)
+    {
+        case ESgmKernel::SCALAR:
+            return true;
+        case ESgmKernel::AVX2:
+#ifdef ALICEVISION_SGM_KERNELS_X86
+            return system::get_cpu_features().avx2;
+#else
+            return false;
+#endif
+    }
+    return false;
+}
+
+ESgmKernel sgm_cpu_getBestKernel()
+{
+    return sgm_cpu_isKernelSupported(ESgmKernel::AVX2) ? ESgmKernel::AVX2 : ESgmKernel::SCALAR;
+}
+
+void sgm_cpu_getPathDirection(int path, int& dx, int& dy)
+{
+    static const int directions[8][2] = {{1, 0}, {-1, 0}, {0, 1}, {0, -1}, {1, 1}, {-1, 1}, {-1, -1}, {1, -1}};
+    if(path < 0 || path >= 8)
+        throw std::out_of_range("Invalid SGM path: " + std::to_string(path));
+    dx = directions[path][0];
+    dy = directions[path][1];
+}
+
+void sgm_cpu_aggregateCosts(const unsigned char* costs, const unsigned char* P2, int width, int height, int nbDepths,
+                            int nbPaths, unsigned char P1, unsigned short* aggregated, ESgmKernel kernel)
+{
+    if(nbPaths != 4 && nbPaths != 8)
+        throw std::invalid_argument("Invalid number of SGM paths: " + std::to_string(nbPaths));
+
+    const PathKernel pathCosts = getPathKernel(kernel);
+    const std::size_t nbVoxels = std::size_t(width) * std::size_t(height) * std::size_t(nbDepths);
+    const int stride = nbDepths + 2;
+
+    // the first pixel of a path has no previous pixel: null path costs give L = C
+    const std::vector<unsigned short> startL = createPathBuffer(1, stride);
+
+#pragma omp parallel for
+    for(long long i = 0; i < static_cast<long long>(nbVoxels); ++i)
+        aggregated[i] = 0;
+
+    // horizontal paths, the rows are independent
+#pragma omp parallel
+    {
+        std::vector<unsigned short> prevL = createPathBuffer(1, stride);
+        std::vector<unsigned short> currL = createPathBuffer(1, stride);
+
+#pragma omp for
+        for(int y = 0; y < height; ++y)
+        {
+            for(int path = 0; path < 2; ++path)
+            {
+                const bool forward = (path == 0);
+                const unsigned short* prev = startL.data();
+                unsigned short prevMin = 0;
+                for(int i = 0; i < width; ++i)
+                {
+                    const std::size_t pixel = std::size_t(y) * width + (forward ? i : width - 1 - i);
+                    prevMin = pathCosts(costs + pixel * nbDepths, prev, prevMin, P1, P2[pixel * nbPaths + path],
+                                        currL.data(), aggregated + pixel * nbDepths, nbDepths);
+                    prevL.swap(currL);
+                    prev = prevL.data();
+                }
+            }
+        }
+    }
+
+    // vertical and diagonal paths: top to bottom, then bottom to top
+    for(const bool downward : {true, false})
+    {
+        std::vector<int> rowPaths;
+        for(int path = 2; path < nbPaths; ++path)
+        {
+            int dx, dy;
+            sgm_cpu_getPathDirection(path, dx, dy);
+            if((dy > 0) == downward)
+                rowPaths.push_back(path);
+        }
+        const int nbRowPaths = static_cast<int>(rowPaths.size());
+
+        // path costs and their minimum for the previous and the current rows
+        std::vector<std::vector<unsigned short>> prevRowL(nbRowPaths), currRowL(nbRowPaths);
+        std::vector<std::vector<unsigned short>> prevRowMin(nbRowPaths), currRowMin(nbRowPaths);
+        for(int k = 0; k < nbRowPaths; ++k)
+        {
+            prevRowL[k] = createPathBuffer(width, stride);
+            currRowL[k] = createPathBuffer(width, stride);
+            prevRowMin[k].resize(width);
+            currRowMin[k].resize(width);
+        }
+
+        const int stripWidth = getStripWidth(nbDepths, nbRowPaths);
+        const int nbStrips = (width + stripWidth - 1) / stripWidth;
+
+#pragma omp parallel
+        for(int i = 0; i < height; ++i)
+        {
+            const int y = downward ? i : height - 1 - i;
+
+            // static schedule: a thread processes the same strips on all the rows, so its previous row stays in cache
+#pragma omp for schedule(static)
+            for(int strip = 0; strip < nbStrips; ++strip)
+            {
+                const int xEnd = std::min(width, (strip + 1) * stripWidth);
+                for(int x = strip * stripWidth; x < xEnd; ++x)
+                {
+                    const std::size_t pixel = std::size_t(y) * width + x;
+                    for(int k = 0; k < nbRowPaths; ++k)
+                    {
+                        int dx, dy;
+                        sgm_cpu_getPathDirection(rowPaths[k], dx, dy);
+                        const int prevX = x - dx;
+                        const bool hasPrev = (i > 0) && (prevX >= 0) && (prevX < width);
+                        const unsigned short* prev = hasPrev ? &prevRowL[k][std::size_t(prevX) * stride] : startL.data();
+                        const unsigned short prevMin = hasPrev ? prevRowMin[k][prevX] : 0;
+                        currRowMin[k][x] = pathCosts(costs + pixel * nbDepths, prev, prevMin, P1,
+                                                     P2[pixel * nbPaths + rowPaths[k]],
+                                                     &currRowL[k][std::size_t(x) * stride],
+                                                     aggregated + pixel * nbDepths, nbDepths);
+                    }
+                }
+            }
+            // implicit barrier: the current row is complete
+
+#pragma omp single
+            {
+                prevRowL.swap(currRowL);
+                prevRowMin.swap(currRowMin);
+            }
+            // implicit barrier: the buffers are swapped for all the threads
+        }
+    }
+}
+
+} // namespace depthMap
+} // namespace aliceVision
@@ -0,0 +1,102 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2020 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#pragma once
+
+#include <algorithm>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+
+namespace aliceVision {
+namespace depthMap {
+
+/**
+ * @brief Instruction set used by the SGM aggregation
+ */
+enum class ESgmKernel
+{
+    SCALAR = 0,
+    AVX2
+};
+
+inline std::string ESgmKernel_enumToString(ESgmKernel kernel)
+{
+    switch(kernel)
+    {
+        case ESgmKernel::SCALAR: return "scalar";
+        case ESgmKernel::AVX2:   return "avx2";
+    }
+    throw std::out_of_range("Invalid ESgmKernel enum");
+}
+
+inline ESgmKernel ESgmKernel_stringToEnum(const std::string& kernel)
+{
+    std::string type = kernel;
+    std::transform(type.begin(), type.end(), type.begin(), ::tolower); //tolower
+
+    if(type == "scalar") return ESgmKernel::SCALAR;
+    if(type == "avx2")   return ESgmKernel::AVX2;
+    throw std::out_of_range("Invalid SGM kernel: " + kernel);
+}
+
+inline std::ostream& operator<<(std::ostream& os, const ESgmKernel kernel)
+{
+    os << ESgmKernel_enumToString(kernel);
+    return os;
+}
+
+inline std::istream& operator>>(std::istream& in, ESgmKernel& kernel)
+{
+    std::string token;
+    in >> token;
+    kernel = ESgmKernel_stringToEnum(token);
+    return in;
+}
+
+/**
+ * @brief Check if the instruction set of the kernel is available at runtime.
+ */
+bool sgm_cpu_isKernelSupported(ESgmKernel kernel);
+
+/**
+ * @brief Get the fastest kernel supported by the CPU.
+ */
+ESgmKernel sgm_cpu_getBestKernel();
+
+/**
+ * @brief Direction of the i-th SGM path, as the offset (dx, dy) from the previous pixel of the path.
+ *        The 4 first paths are horizontal and vertical, the 4 last ones are diagonal.
+ */
+void sgm_cpu_getPathDirection(int path, int& dx, int& dy);
+
+/**
+ * @brief Semi-Global Matching aggregation of a cost volume along 4 or 8 paths.
+ *
+ * For each path r, L_r(p, d) = C(p, d) + min(L_r(p-r, d), L_r(p-r, d±1) + P1, min_k L_r(p-r, k) + P2) - min_k L_r(p-r, k)
+ * and the aggregated cost is the sum of the L_r. The costs are processed on 16 bits with saturating additions.
+ *
+ * The volumes are stored depth-innermost, so all the paths read contiguous depths and no transposition is needed.
+ * The vertical and diagonal paths are processed row by row, each row being split in cache-sized strips
+ * along the scanline shared by the threads. The horizontal paths are processed one row per thread.
+ *
+ * @param[in] costs matching costs (0..255) indexed by (y * width + x) * nbDepths + d
+ * @param[in] P2 penalty of the depth jumps, indexed by (y * width + x) * nbPaths + path,
+ *            for the transition from the previous pixel of the path to (x, y)
+ * @param[in] width width of the volume
+ * @param[in] height height of the volume
+ * @param[in] nbDepths number of depths of the volume
+ * @param[in] nbPaths 4 or 8, see sgm_cpu_getPathDirection
+ * @param[in] P1 penalty of the depth changes of one step
+ * @param[out] aggregated sum of the path costs, indexed as the costs
+ * @param[in] kernel instruction set, it must be supported by the CPU
+ */
+void sgm_cpu_aggregateCosts(const unsigned char* costs, const unsigned char* P2, int width, int height, int nbDepths,
+                            int nbPaths, unsigned char P1, unsigned short* aggregated,
+                            ESgmKernel kernel = sgm_cpu_getBestKernel());
+
+} // namespace depthMap
+} // namespace aliceVision
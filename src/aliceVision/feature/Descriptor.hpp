@@ -15,6 +15,7 @@
 #include <string>
 #include <vector>
 #include <exception>
+#include <type_traits>
 
 namespace aliceVision {
 namespace feature {
@@ -282,12 +283,24 @@ inline void loadDescsFromBinFile(
   // Compute the memory size of one descriptor
   constexpr std::size_t oneDescSize = FileDescriptorT::static_size * sizeof(typename FileDescriptorT::bin_type);
 
-  FileDescriptorT fileDescriptor;
-  for (typename std::vector<DescriptorT>::iterator iter = begin;
-    iter != vec_desc.end(); ++iter)
+  if(std::is_same<DescriptorT, FileDescriptorT>::value)
   {
-    fileIn.read((char*)fileDescriptor.getData(), oneDescSize);
-    convertDesc<FileDescriptorT, DescriptorT>(fileDescriptor, *iter);
+    static_assert(sizeof(FileDescriptorT) == oneDescSize, "Descriptor storage must be contiguous");
+
+    // same representation in memory and in file: read the whole descriptor block at once
+    const std::size_t nbDescs = std::distance(begin, vec_desc.end());
+    if(nbDescs > 0)
+      fileIn.read((char*) begin->getData(), nbDescs * oneDescSize);
+  }
+  else
+  {
+    FileDescriptorT fileDescriptor;
+    for (typename std::vector<DescriptorT>::iterator iter = begin;
+      iter != vec_desc.end(); ++iter)
+    {
+      fileIn.read((char*)fileDescriptor.getData(), oneDescSize);
+      convertDesc<FileDescriptorT, DescriptorT>(fileDescriptor, *iter);
+    }
   }
 
   if(fileIn.bad())
@@ -78,7 +78,15 @@ void ImageDescriber::Save(const Regions* regions, const std::string& sfileNameFe
   const std::string tmpFeatsPath = (bFeatsPath.parent_path() / bFeatsPath.stem()).string() + "." + fs::unique_path().string() + bFeatsPath.extension().string();
   const std::string tmpDescsPath = (bDescsPath.parent_path() / bDescsPath.stem()).string() + "." + fs::unique_path().string() + bDescsPath.extension().string();
 
-  regions->Save(tmpFeatsPath, tmpDescsPath);
+  if(_featureFileType == EFeatureFileType::BINARY)
+  {
+    saveFeatsToBinFile(tmpFeatsPath, regions->Features());
+    regions->SaveDesc(tmpDescsPath);
+  }
+  else
+  {
+    regions->Save(tmpFeatsPath, tmpDescsPath);
+  }
 
   // rename temporay filenames
   fs::rename(tmpFeatsPath, sfileNameFeats);
@@ -130,6 +130,24 @@ public:
   {
     setConfigurationPreset(EImageDescriberPreset_stringToEnum(preset));
   }
+
+  /**
+   * @brief Set the storage type used to save the features files (.feat)
+   * @param[in] featureFileType The features file type
+   */
+  void setFeatureFileType(EFeatureFileType featureFileType)
+  {
+    _featureFileType = featureFileType;
+  }
+
+  /**
+   * @brief Get the storage type used to save the features files (.feat)
+   * @return The features file type
+   */
+  EFeatureFileType getFeatureFileType() const
+  {
+    return _featureFileType;
+  }
   
   /**
    * @brief Detect regions on the 8-bit image and compute their attributes (description)
@@ -185,6 +203,9 @@ public:
   {
     regions->LoadFeatures(sfileNameFeats);
   }
+
+private:
+  EFeatureFileType _featureFileType = EFeatureFileType::TEXT;
 };
 
 /**
@@ -8,9 +8,13 @@
 #pragma once
 
 #include "aliceVision/numeric/numeric.hpp"
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
 #include <iostream>
 #include <iterator>
 #include <fstream>
+#include <stdexcept>
 #include <string>
 #include <vector>
 
@@ -94,7 +98,144 @@ inline std::istream& operator>>(std::istream& in, PointFeature& obj)
   return in >> obj._coords(0) >> obj._coords(1) >> obj._scale >> obj._orientation;
 }
 
-/// Read feats from file
+/**
+ * @brief Features file storage type
+ */
+enum class EFeatureFileType
+{
+  /// whitespace-separated "x y scale orientation" lines
+  TEXT = 0,
+  /// versioned header followed by a contiguous array of SIO points
+  BINARY
+};
+
+inline std::string EFeatureFileType_enumToString(EFeatureFileType featureFileType)
+{
+  switch(featureFileType)
+  {
+    case EFeatureFileType::TEXT:   return "text";
+    case EFeatureFileType::BINARY: return "binary";
+  }
+  throw std::out_of_range("Invalid EFeatureFileType enum");
+}
+
+inline EFeatureFileType EFeatureFileType_stringToEnum(const std::string& featureFileType)
+{
+  std::string type = featureFileType;
+  std::transform(type.begin(), type.end(), type.begin(), ::tolower); //tolower
+
+  if(type == "text")   return EFeatureFileType::TEXT;
+  if(type == "binary") return EFeatureFileType::BINARY;
+
+  throw std::out_of_range("Invalid feature file type: " + featureFileType);
+}
+
+inline std::ostream& operator<<(std::ostream& os, EFeatureFileType featureFileType)
+{
+  return os << EFeatureFileType_enumToString(featureFileType);
+}
+
+inline std::istream& operator>>(std::istream& in, EFeatureFileType& featureFileType)
+{
+  std::string token;
+  in >> token;
+  featureFileType = EFeatureFileType_stringToEnum(token);
+  return in;
+}
+
+/**
+ * @brief Header of a binary features file.
+ *
+ * Layout: [header][count x (x, y, scale, orientation) float32]
+ * The point array starts right after the header and is contiguous,
+ * so it can be read with a single call (or mapped) without any parsing.
+ */
+struct BinaryFeatsHeader
+{
+  char magic[8];
+  std::uint32_t version;
+  std::uint32_t pointSize;   // size in bytes of one stored point
+  std::uint64_t count;       // number of stored points
+};
+
+static_assert(sizeof(BinaryFeatsHeader) == 24, "Unexpected BinaryFeatsHeader padding");
+
+constexpr char BINARY_FEATS_MAGIC[8] = {'A', 'V', 'F', 'E', 'A', 'T', 'B', '\0'};
+constexpr std::uint32_t BINARY_FEATS_VERSION = 1;
+constexpr std::uint32_t BINARY_FEATS_POINT_SIZE = 4 * sizeof(float);
+
+/**
+ * @brief Check if the given stream starts with a binary features header.
+ *        The stream position is restored.
+ * @param[in,out] stream an input stream opened in binary mode
+ * @return true if the stream contains binary features
+ */
+inline bool isBinaryFeatsStream(std::istream& stream)
+{
+  char magic[sizeof(BINARY_FEATS_MAGIC)];
+  const std::streampos start = stream.tellg();
+  stream.read(magic, sizeof(magic));
+  const bool isBinary = (stream.gcount() == sizeof(magic)) &&
+                        (std::memcmp(magic, BINARY_FEATS_MAGIC, sizeof(magic)) == 0);
+  stream.clear();
+  stream.seekg(start);
+  return isBinary;
+}
+
+/**
+ * @brief Check if the given file is a binary features file.
+ * @param[in] sfileNameFeats the features file path
+ * @return true if the file contains binary features
+ */
+inline bool isBinaryFeatsFile(const std::string& sfileNameFeats)
+{
+  std::ifstream fileIn(sfileNameFeats, std::ios::in | std::ios::binary);
+  return fileIn.is_open() && isBinaryFeatsStream(fileIn);
+}
+
+/// Read feats from a binary stream (header included)
+template<typename FeaturesT >
+inline void loadFeatsFromBinStream(
+  std::istream & fileIn,
+  const std::string & sfileNameFeats,
+  FeaturesT & vec_feat)
+{
+  vec_feat.clear();
+
+  BinaryFeatsHeader header;
+  fileIn.read(reinterpret_cast<char*>(&header), sizeof(header));
+
+  if(!fileIn || std::memcmp(header.magic, BINARY_FEATS_MAGIC, sizeof(BINARY_FEATS_MAGIC)) != 0)
+    throw std::runtime_error("Can't load features file, '" + sfileNameFeats + "' is not a binary features file !");
+
+  if(header.version > BINARY_FEATS_VERSION)
+    throw std::runtime_error("Can't load features file, '" + sfileNameFeats + "' has an unsupported version (" + std::to_string(header.version) + ") !");
+
+  if(header.pointSize != BINARY_FEATS_POINT_SIZE)
+    throw std::runtime_error("Can't load features file, '" + sfileNameFeats + "' has an invalid point size !");
+
+  // the count comes from the file: check it against the stream size before any allocation
+  const std::streampos dataBegin = fileIn.tellg();
+  fileIn.seekg(0, std::ios::end);
+  const std::streamoff dataSize = fileIn.tellg() - dataBegin;
+  fileIn.seekg(dataBegin);
+
+  if(!fileIn || dataSize < 0 || header.count > static_cast<std::uint64_t>(dataSize) / BINARY_FEATS_POINT_SIZE)
+    throw std::runtime_error("Can't load features file, '" + sfileNameFeats + "' is truncated or corrupted !");
+
+  // read the whole point array at once
+  std::vector<float> buffer(static_cast<std::size_t>(header.count) * 4);
+  fileIn.read(reinterpret_cast<char*>(buffer.data()), buffer.size() * sizeof(float));
+
+  if(fileIn.gcount() != static_cast<std::streamsize>(buffer.size() * sizeof(float)))
+    throw std::runtime_error("Can't load features file, '" + sfileNameFeats + "' is truncated !");
+
+  std::back_insert_iterator<FeaturesT> inserter(vec_feat);
+  for(std::size_t i = 0; i < buffer.size(); i += 4)
+    *inserter++ = typename FeaturesT::value_type(buffer[i], buffer[i + 1], buffer[i + 2], buffer[i + 3]);
+}
+
+/// Read feats from file (text or binary, detected from the file header)
 template<typename FeaturesT >
 inline void loadFeatsFromFile(
   const std::string & sfileNameFeats,
@@ -102,11 +243,17 @@ inline void loadFeatsFromFile(
 {
   vec_feat.clear();
 
-  std::ifstream fileIn(sfileNameFeats);
+  std::ifstream fileIn(sfileNameFeats, std::ios::in | std::ios::binary);
 
   if(!fileIn.is_open())
     throw std::runtime_error("Can't load features file, can't open '" + sfileNameFeats + "' !");
-  
+
+  if(isBinaryFeatsStream(fileIn))
+  {
+    loadFeatsFromBinStream(fileIn, sfileNameFeats, vec_feat);
+    return;
+  }
+
   std::copy(
     std::istream_iterator<typename FeaturesT::value_type >(fileIn),
     std::istream_iterator<typename FeaturesT::value_type >(),
@@ -116,6 +263,20 @@ inline void loadFeatsFromFile(
   fileIn.close();
 }
 
+/// Read feats from a binary file
+template<typename FeaturesT >
+inline void loadFeatsFromBinFile(
+  const std::string & sfileNameFeats,
+  FeaturesT & vec_feat)
+{
+  std::ifstream fileIn(sfileNameFeats, std::ios::in | std::ios::binary);
+
+  if(!fileIn.is_open())
+    throw std::runtime_error("Can't load features file, can't open '" + sfileNameFeats + "' !");
+
+  loadFeatsFromBinStream(fileIn, sfileNameFeats, vec_feat);
+}
+
 /// Write feats to file
 template<typename FeaturesT >
 inline void saveFeatsToFile(
@@ -135,6 +296,55 @@ inline void saveFeatsToFile(
   file.close();
 }
 
+/// Write feats to file (in binary mode)
+template<typename FeaturesT >
+inline void saveFeatsToBinFile(
+  const std::string & sfileNameFeats,
+  FeaturesT & vec_feat)
+{
+  std::ofstream file(sfileNameFeats.c_str(), std::ios::out | std::ios::binary);
+
+  if (!file.is_open())
+    throw std::runtime_error("Can't save features file, can't open '" + sfileNameFeats + "' !");
+
+  BinaryFeatsHeader header;
+  std::memcpy(header.magic, BINARY_FEATS_MAGIC, sizeof(BINARY_FEATS_MAGIC));
+  header.version = BINARY_FEATS_VERSION;
+  header.pointSize = BINARY_FEATS_POINT_SIZE;
+  header.count = static_cast<std::uint64_t>(vec_feat.size());
+
+  std::vector<float> buffer;
+  buffer.reserve(vec_feat.size() * 4);
+  for(const auto& feat : vec_feat)
+  {
+    buffer.push_back(feat.x());
+    buffer.push_back(feat.y());
+    buffer.push_back(feat.scale());
+    buffer.push_back(feat.orientation());
+  }
+
+  file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+  file.write(reinterpret_cast<const char*>(buffer.data()), buffer.size() * sizeof(float));
+
+  if(!file.good())
+    throw std::runtime_error("Can't save features file, '" + sfileNameFeats + "' is incorrect !");
+
+  file.close();
+}
+
+/// Write feats to file using the given storage type
+template<typename FeaturesT >
+inline void saveFeatsToFile(
+  const std::string & sfileNameFeats,
+  FeaturesT & vec_feat,
+  EFeatureFileType featureFileType)
+{
+  if(featureFileType == EFeatureFileType::BINARY)
+    saveFeatsToBinFile(sfileNameFeats, vec_feat);
+  else
+    saveFeatsToFile(sfileNameFeats, vec_feat);
+}
+
 /// Export point feature based vector to a matrix [(x,y)'T, (x,y)'T]
 template< typename FeaturesT, typename MatT >
 void PointsToMat(
@@ -93,6 +93,9 @@ public:
 
   virtual void SaveDesc(const std::string& sfileNameDescs) const = 0;
 
+  /// Read from file the descriptors only, the features are not loaded
+  virtual void LoadDesc(const std::string& sfileNameDescs) = 0;
+
   //--
   //- Basic description of a descriptor [Type, Length]
   //--
@@ -103,6 +106,9 @@ public:
   virtual std::string Type_id() const = 0;
   virtual std::size_t DescriptorLength() const = 0;
 
+  /// Return the number of descriptors, equal to RegionCount() unless only the descriptors are loaded
+  virtual std::size_t DescriptorCount() const = 0;
+
   /**
    * @brief Return a blind pointer to the container of the descriptors array.
    *
@@ -119,6 +125,9 @@ public:
 
   virtual void clearDescriptors() = 0;
 
+  /// Return the memory used by the features and descriptors (in bytes)
+  virtual std::size_t MemorySize() const = 0;
+
   /// Return the squared distance between two descriptors
   // A default metric is used according the descriptor type:
   // - Scalar: L2,
@@ -178,6 +187,7 @@ protected:
 public:
   std::string Type_id() const override {return typeid(T).name();}
   std::size_t DescriptorLength() const override {return static_cast<std::size_t>(L);}
+  std::size_t DescriptorCount() const override {return _vec_descs.size();}
 
   bool IsScalar() const override { return regionType == ERegionType::Scalar; }
   bool IsBinary() const override { return regionType == ERegionType::Binary; }
@@ -210,6 +220,11 @@ public:
     saveDescsToBinFile(sfileNameDescs, _vec_descs);
   }
 
+  void LoadDesc(const std::string& sfileNameDescs) override
+  {
+    loadDescsFromBinFile(sfileNameDescs, _vec_descs);
+  }
+
   /// Mutable and non-mutable DescriptorT getters.
   inline std::vector<DescriptorT> & Descriptors() { return _vec_descs; }
   inline const std::vector<DescriptorT> & Descriptors() const { return _vec_descs; }
@@ -220,6 +235,11 @@ public:
 
   inline void clearDescriptors() override { _vec_descs.clear(); }
 
+  inline std::size_t MemorySize() const override
+  {
+    return this->_vec_feats.capacity() * sizeof(PointFeature) + _vec_descs.capacity() * sizeof(DescriptorT);
+  }
+
   inline void swap(This& other)
   {
     this->_vec_feats.swap(other._vec_feats);
@@ -0,0 +1,236 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2020 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include "RegionsProvider.hpp"
+
+#include <aliceVision/system/Logger.hpp>
+
+#include <algorithm>
+#include <exception>
+#include <stdexcept>
+
+namespace aliceVision {
+namespace feature {
+
+RegionsProvider::RegionsProvider(const RegionsLoader& loader, std::size_t maxMemorySize)
+  : _loader(loader)
+  , _maxMemorySize(maxMemorySize)
+{}
+
+std::shared_ptr<const Regions> RegionsProvider::getRegions(IndexT viewId, EImageDescriberType descType)
+{
+  assert(descType != EImageDescriberType::UNINITIALIZED);
+  const Key key(viewId, descType);
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    auto it = _entries.find(key);
+    if(it != _entries.end())
+    {
+      // move the entry in front of the LRU list
+      _lru.splice(_lru.begin(), _lru, it->second.lruIt);
+      ++_nbHits;
+      return it->second.regions;
+    }
+  }
+
+  // load outside of the lock to allow concurrent loading
+  std::unique_ptr<Regions> regions = load(key);
+
+  std::lock_guard<std::mutex> lock(_mutex);
+  return insert(key, std::move(regions));
+}
+
+void RegionsProvider::prefetch(const std::vector<IndexT>& viewIds, EImageDescriberType descType)
+{
+  std::vector<IndexT> toLoad;
+  // memory of the requested views in cache, loaded or being loaded: they must fit in the budget all together
+  std::size_t prefetchedMemorySize = 0;
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    // the requested views in cache become the most recently used (in the order of priority),
+    // so the prefetch evicts the other regions first
+    for(auto viewIt = viewIds.rbegin(); viewIt != viewIds.rend(); ++viewIt)
+    {
+      auto it = _entries.find(Key(*viewIt, descType));
+      if(it == _entries.end())
+        continue;
+      _lru.splice(_lru.begin(), _lru, it->second.lruIt);
+      prefetchedMemorySize += it->second.memorySize;
+    }
+    for(IndexT viewId : viewIds)
+    {
+      if(_entries.count(Key(viewId, descType)) == 0)
+        toLoad.push_back(viewId);
+    }
+  }
+
+  // the loading errors can't leave the parallel loop, the first one is rethrown after it
+  std::exception_ptr exception;
+  bool budgetReached = false;
+
+  const auto prefetchView = [&](IndexT viewId)
+  {
+    const Key key(viewId, descType);
+    std::size_t reservedSize = 0;
+    {
+      std::lock_guard<std::mutex> lock(_mutex);
+      if(exception || budgetReached || _entries.count(key) > 0)
+        return;
+      if(_maxMemorySize > 0)
+      {
+        // reserve the expected size of the regions before loading them,
+        // so the concurrent loads can't exceed the budget all together
+        reservedSize = _loadedMemorySize / std::max<std::size_t>(1, _nbLoads);
+        if(prefetchedMemorySize + reservedSize > _maxMemorySize)
+        {
+          // the remaining views have a lower priority, they will be loaded on demand
+          budgetReached = true;
+          return;
+        }
+        prefetchedMemorySize += reservedSize;
+      }
+    }
+
+    std::unique_ptr<Regions> regions;
+    try
+    {
+      regions = load(key);
+    }
+    catch(...)
+    {
+      std::lock_guard<std::mutex> lock(_mutex);
+      if(!exception)
+        exception = std::current_exception();
+    }
+
+    std::lock_guard<std::mutex> lock(_mutex);
+    prefetchedMemorySize -= reservedSize;
+    if(!regions)
+      return;
+    if(_maxMemorySize > 0)
+    {
+      // the expected size is only an estimation: don't evict the regions prefetched by this call
+      const std::size_t memorySize = regions->MemorySize();
+      if(prefetchedMemorySize + memorySize > _maxMemorySize)
+      {
+        budgetReached = true;
+        return;
+      }
+      prefetchedMemorySize += memorySize;
+    }
+    // evict the least recently used regions which are not requested
+    insert(key, std::move(regions));
+  };
+
+  std::size_t first = 0;
+  if(_maxMemorySize > 0 && !toLoad.empty() && getNbLoads() == 0)
+  {
+    // no size known to reserve: load the first view alone to get one
+    prefetchView(toLoad.front());
+    first = 1;
+  }
+
+  #pragma omp parallel for schedule(dynamic)
+  for(int i = static_cast<int>(first); i < static_cast<int>(toLoad.size()); ++i)
+    prefetchView(toLoad.at(i));
+
+  if(exception)
+    std::rethrow_exception(exception);
+}
+
+void RegionsProvider::clear()
+{
+  std::lock_guard<std::mutex> lock(_mutex);
+  _entries.clear();
+  _lru.clear();
+  _memorySize = 0;
+  _peakMemorySize = 0;
+  _loadedMemorySize = 0;
+  _nbLoads = 0;
+  _nbHits = 0;
+}
+
+std::size_t RegionsProvider::getMemorySize() const
+{
+  std::lock_guard<std::mutex> lock(_mutex);
+  return _memorySize;
+}
+
+std::size_t RegionsProvider::getNbLoads() const
+{
+  std::lock_guard<std::mutex> lock(_mutex);
+  return _nbLoads;
+}
+
+std::size_t RegionsProvider::getPeakMemorySize() const
+{
+  std::lock_guard<std::mutex> lock(_mutex);
+  return _peakMemorySize;
+}
+
+std::size_t RegionsProvider::getNbHits() const
+{
+  std::lock_guard<std::mutex> lock(_mutex);
+  return _nbHits;
+}
+
+std::unique_ptr<Regions> RegionsProvider::load(const Key& key) const
+{
+  std::unique_ptr<Regions> regions = _loader(key.first, key.second);
+  if(!regions)
+    throw std::runtime_error("Can't load regions of the view " + std::to_string(key.first));
+  return regions;
+}
+
+std::shared_ptr<const Regions> RegionsProvider::insert(const Key& key, std::unique_ptr<Regions> regions)
+{
+  // another thread may have loaded the same regions in the meantime
+  auto it = _entries.find(key);
+  if(it != _entries.end())
+  {
+    _lru.splice(_lru.begin(), _lru, it->second.lruIt);
+    return it->second.regions;
+  }
+
+  ++_nbLoads;
+
+  Entry& entry = _entries[key];
+  entry.memorySize = regions->MemorySize();
+  entry.regions.reset(regions.release());
+  _lru.push_front(key);
+  entry.lruIt = _lru.begin();
+  _memorySize += entry.memorySize;
+  _loadedMemorySize += entry.memorySize;
+
+  // keep a reference on the new entry, it may be evicted if it is larger than the budget
+  std::shared_ptr<const Regions> result = entry.regions;
+  evict();
+  _peakMemorySize = std::max(_peakMemorySize, _memorySize);
+  return result;
+}
+
+void RegionsProvider::evict()
+{
+  if(_maxMemorySize == 0)
+    return;
+
+  // never evict the most recently used entry
+  while(_memorySize > _maxMemorySize && _lru.size() > 1)
+  {
+    const Key& key = _lru.back();
+    auto it = _entries.find(key);
+    assert(it != _entries.end());
+
+    ALICEVISION_LOG_TRACE("Release regions of the view " << key.first << " (" << it->second.memorySize << " bytes).");
+
+    _memorySize -= it->second.memorySize;
+    _entries.erase(it);
+    _lru.pop_back();
+  }
+}
+
+} // namespace feature
+} // namespace aliceVision
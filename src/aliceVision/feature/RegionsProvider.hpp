@@ -0,0 +1,122 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2020 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#pragma once
+
+#include <aliceVision/types.hpp>
+#include <aliceVision/feature/Regions.hpp>
+#include <aliceVision/feature/imageDescriberCommon.hpp>
+
+#include <functional>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace aliceVision {
+namespace feature {
+
+/**
+ * @brief Give access to the Regions (Features and Descriptors) of each View,
+ *        loading them on demand within a bounded memory budget.
+ *
+ * Loaded regions are kept in a cache and the least recently used ones are released
+ * when the memory budget is exceeded. Regions are returned as shared pointers, so an
+ * evicted entry stays valid until its last user releases it.
+ *
+ * @note All methods are thread-safe. Loading is performed outside of the lock.
+ */
+class RegionsProvider
+{
+public:
+  /// Functor used to load the regions of a view for a given describer type
+  using RegionsLoader = std::function<std::unique_ptr<Regions>(IndexT viewId, EImageDescriberType descType)>;
+
+  /**
+   * @brief RegionsProvider constructor
+   * @param[in] loader The functor used to load the regions of a view
+   * @param[in] maxMemorySize The memory budget of the cache (in bytes), 0 means unbounded
+   */
+  RegionsProvider(const RegionsLoader& loader, std::size_t maxMemorySize);
+
+  /**
+   * @brief Get the regions of a view, load them if needed.
+   * @param[in] viewId The view id
+   * @param[in] descType The describer type
+   * @return the regions of the view
+   */
+  std::shared_ptr<const Regions> getRegions(IndexT viewId, EImageDescriberType descType);
+
+  /**
+   * @brief Load in parallel the regions of the given views that are not in cache yet.
+   *        The least recently used regions are evicted to make room for them, but never
+   *        the regions of the given views: the prefetch stops as soon as they reach the memory budget.
+   *        The expected size of each load (average size of the regions loaded so far) is reserved
+   *        before loading it, the first load is done alone if no size is known yet,
+   *        and the regions which don't fit in the budget once loaded are not kept.
+   *        The first loading error is rethrown once all the loads are done.
+   * @param[in] viewIds The views that will be requested soon, by order of priority
+   * @param[in] descType The describer type
+   */
+  void prefetch(const std::vector<IndexT>& viewIds, EImageDescriberType descType);
+
+  /**
+   * @brief Release all cached regions and reset the statistics.
+   */
+  void clear();
+
+  /// Return the memory used by the cached regions (in bytes)
+  std::size_t getMemorySize() const;
+
+  /// Return the maximum memory used by the cached regions since the creation or the last clear (in bytes)
+  std::size_t getPeakMemorySize() const;
+
+  /// Return the memory budget (in bytes)
+  std::size_t getMaxMemorySize() const { return _maxMemorySize; }
+
+  /// Return the number of regions loaded from disk since the creation or the last clear
+  std::size_t getNbLoads() const;
+
+  /// Return the number of requests served from the cache since the creation or the last clear
+  std::size_t getNbHits() const;
+
+private:
+  using Key = std::pair<IndexT, EImageDescriberType>;
+
+  struct Entry
+  {
+    std::shared_ptr<const Regions> regions;
+    std::size_t memorySize = 0;
+    std::list<Key>::iterator lruIt;
+  };
+
+  /// Load the regions with the loader, throw if they can't be loaded
+  std::unique_ptr<Regions> load(const Key& key) const;
+
+  /// Insert loaded regions in the cache, must be called with the lock held
+  std::shared_ptr<const Regions> insert(const Key& key, std::unique_ptr<Regions> regions);
+
+  /// Release the least recently used regions until the memory budget is respected,
+  /// must be called with the lock held
+  void evict();
+
+  RegionsLoader _loader;
+  std::size_t _maxMemorySize;
+  std::size_t _memorySize = 0;
+  std::size_t _peakMemorySize = 0;
+  /// size of all the regions loaded since the creation or the last clear
+  std::size_t _loadedMemorySize = 0;
+  std::size_t _nbLoads = 0;
+  std::size_t _nbHits = 0;
+  std::map<Key, Entry> _entries;
+  /// most recently used first
+  std::list<Key> _lru;
+  mutable std::mutex _mutex;
+};
+
+} // namespace feature
+} // namespace aliceVision
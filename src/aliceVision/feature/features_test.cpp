@@ -6,7 +6,11 @@
 // You can obtain one at https://mozilla.org/MPL/2.0/.
 
 #include "aliceVision/feature/feature.hpp"
+#include "aliceVision/feature/RegionsProvider.hpp"
 
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
 #include <iostream>
 #include <fstream>
 #include <iterator>
@@ -71,6 +75,67 @@ BOOST_AUTO_TEST_CASE(featureIO_ASCII) {
   }
 }
 
+BOOST_AUTO_TEST_CASE(featureIO_BINARY) {
+  Feats_T vec_feats;
+  for(int i = 0; i < CARD; ++i)  {
+    vec_feats.push_back(Feature_T(i, i*2, i*3, i*4));
+  }
+
+  //Save them to a binary file
+  BOOST_CHECK_NO_THROW(saveFeatsToBinFile("tempFeatsBin.feat", vec_feats));
+  BOOST_CHECK(isBinaryFeatsFile("tempFeatsBin.feat"));
+
+  //Read the saved data with the explicit binary reader
+  Feats_T vec_feats_read;
+  BOOST_CHECK_NO_THROW(loadFeatsFromBinFile("tempFeatsBin.feat", vec_feats_read));
+  BOOST_CHECK_EQUAL(CARD, vec_feats_read.size());
+
+  for(int i = 0; i < CARD; ++i) {
+    BOOST_CHECK_EQUAL(vec_feats[i], vec_feats_read[i]);
+  }
+
+  //Read the saved data with the auto-detecting reader
+  vec_feats_read.clear();
+  BOOST_CHECK_NO_THROW(loadFeatsFromFile("tempFeatsBin.feat", vec_feats_read));
+  BOOST_CHECK_EQUAL(CARD, vec_feats_read.size());
+
+  for(int i = 0; i < CARD; ++i) {
+    BOOST_CHECK_EQUAL(vec_feats[i], vec_feats_read[i]);
+  }
+
+  //A text file is not detected as binary and is rejected by the binary reader
+  BOOST_CHECK_NO_THROW(saveFeatsToFile("tempFeatsText.feat", vec_feats, EFeatureFileType::TEXT));
+  BOOST_CHECK(!isBinaryFeatsFile("tempFeatsText.feat"));
+  BOOST_CHECK_THROW(loadFeatsFromBinFile("tempFeatsText.feat", vec_feats_read), std::exception);
+}
+
+BOOST_AUTO_TEST_CASE(featureIO_BINARY_corrupted) {
+  Feats_T vec_feats;
+  for(int i = 0; i < CARD; ++i)  {
+    vec_feats.push_back(Feature_T(i, i*2, i*3, i*4));
+  }
+  BOOST_CHECK_NO_THROW(saveFeatsToBinFile("tempFeatsCorrupted.feat", vec_feats));
+
+  //Overwrite the point count with a huge value: it must be rejected before any allocation
+  {
+    std::fstream file("tempFeatsCorrupted.feat", std::ios::in | std::ios::out | std::ios::binary);
+    const std::uint64_t count = std::uint64_t(1) << 60;
+    file.seekp(offsetof(BinaryFeatsHeader, count));
+    file.write(reinterpret_cast<const char*>(&count), sizeof(count));
+  }
+  Feats_T vec_feats_read;
+  BOOST_CHECK_THROW(loadFeatsFromBinFile("tempFeatsCorrupted.feat", vec_feats_read), std::runtime_error);
+
+  //A count larger than the stored points by one is rejected too
+  {
+    std::fstream file("tempFeatsCorrupted.feat", std::ios::in | std::ios::out | std::ios::binary);
+    const std::uint64_t count = CARD + 1;
+    file.seekp(offsetof(BinaryFeatsHeader, count));
+    file.write(reinterpret_cast<const char*>(&count), sizeof(count));
+  }
+  BOOST_CHECK_THROW(loadFeatsFromFile("tempFeatsCorrupted.feat", vec_feats_read), std::runtime_error);
+}
+
 //--
 //-- Descriptors interface test
 //--
@@ -123,3 +188,121 @@ BOOST_AUTO_TEST_CASE(descriptorIO_BINARY) {
       BOOST_CHECK_EQUAL(vec_descs[i][j], vec_descs_read[i][j]);
   }
 }
+
+//Test the loading of the descriptors only
+BOOST_AUTO_TEST_CASE(regionsIO_LoadDesc) {
+  SIFT_Regions regions;
+  for(int i = 0; i < CARD; ++i)
+  {
+    regions.Features().push_back(PointFeature(i, i, 1.f, 0.f));
+    regions.Descriptors().push_back(SIFT_Regions::DescriptorT(static_cast<unsigned char>(i)));
+  }
+  BOOST_CHECK_NO_THROW(regions.Save("tempRegions.feat", "tempRegions.desc"));
+
+  SIFT_Regions regionsRead;
+  BOOST_CHECK_NO_THROW(regionsRead.LoadDesc("tempRegions.desc"));
+  BOOST_CHECK_EQUAL(0, regionsRead.RegionCount());
+  BOOST_CHECK_EQUAL(CARD, regionsRead.DescriptorCount());
+  for(int i = 0; i < CARD; ++i)
+    BOOST_CHECK_EQUAL(i, regionsRead.Descriptors()[i][0]);
+}
+
+//--
+//-- Regions provider test
+//--
+BOOST_AUTO_TEST_CASE(regionsProvider_LRU) {
+  // each view has CARD SIFT regions
+  std::atomic<std::size_t> nbLoaderCalls(0);
+  const RegionsProvider::RegionsLoader loader = [&nbLoaderCalls](IndexT viewId, EImageDescriberType descType)
+  {
+    ++nbLoaderCalls;
+    std::unique_ptr<SIFT_Regions> regions(new SIFT_Regions);
+    for(int i = 0; i < CARD; ++i)
+    {
+      regions->Features().push_back(PointFeature(viewId, i, 1.f, 0.f));
+      regions->Descriptors().push_back(SIFT_Regions::DescriptorT(static_cast<unsigned char>(viewId)));
+    }
+    return std::unique_ptr<Regions>(regions.release());
+  };
+
+  const std::size_t regionsSize = loader(0, EImageDescriberType::SIFT)->MemorySize();
+  nbLoaderCalls = 0;
+
+  // only two views fit in the budget
+  RegionsProvider provider(loader, 2 * regionsSize);
+
+  BOOST_CHECK_EQUAL(provider.getRegions(0, EImageDescriberType::SIFT)->GetRegionPosition(0)(0), 0.0);
+  BOOST_CHECK_EQUAL(provider.getRegions(1, EImageDescriberType::SIFT)->GetRegionPosition(0)(0), 1.0);
+  BOOST_CHECK_EQUAL(nbLoaderCalls, 2);
+
+  // view 0 is still in cache and becomes the most recently used
+  provider.getRegions(0, EImageDescriberType::SIFT);
+  BOOST_CHECK_EQUAL(nbLoaderCalls, 2);
+  BOOST_CHECK_EQUAL(provider.getNbHits(), 1);
+
+  // loading view 2 evicts view 1 (least recently used)
+  std::shared_ptr<const Regions> regions2 = provider.getRegions(2, EImageDescriberType::SIFT);
+  BOOST_CHECK_EQUAL(nbLoaderCalls, 3);
+  BOOST_CHECK_EQUAL(provider.getMemorySize(), 2 * regionsSize);
+
+  provider.getRegions(0, EImageDescriberType::SIFT);
+  BOOST_CHECK_EQUAL(nbLoaderCalls, 3);
+  provider.getRegions(1, EImageDescriberType::SIFT);
+  BOOST_CHECK_EQUAL(nbLoaderCalls, 4);
+
+  // view 2 has been evicted but is still valid for its user
+  BOOST_CHECK_EQUAL(regions2->RegionCount(), CARD);
+  BOOST_CHECK_EQUAL(regions2->GetRegionPosition(0)(0), 2.0);
+
+  // clear resets the statistics
+  provider.clear();
+  BOOST_CHECK_EQUAL(provider.getNbLoads(), 0);
+  BOOST_CHECK_EQUAL(provider.getNbHits(), 0);
+  BOOST_CHECK_EQUAL(provider.getMemorySize(), 0);
+
+  // prefetch stops at the budget: the first view is loaded alone to know the regions size, then one of the others
+  provider.prefetch({3, 4, 5, 6}, EImageDescriberType::SIFT);
+  BOOST_CHECK_EQUAL(nbLoaderCalls, 6);
+  BOOST_CHECK_EQUAL(provider.getNbLoads(), 2);
+  BOOST_CHECK_EQUAL(provider.getMemorySize(), 2 * regionsSize);
+  BOOST_CHECK_EQUAL(provider.getPeakMemorySize(), 2 * regionsSize);
+
+  // the prefetched views are not evicted by a prefetch of the same views
+  provider.prefetch({3, 4, 5, 6}, EImageDescriberType::SIFT);
+  BOOST_CHECK_EQUAL(nbLoaderCalls, 6);
+
+  provider.getRegions(3, EImageDescriberType::SIFT);
+  BOOST_CHECK_EQUAL(nbLoaderCalls, 6);
+  BOOST_CHECK_EQUAL(provider.getNbHits(), 1);
+
+  // the regions which are not requested are evicted to prefetch new ones
+  provider.prefetch({7, 8}, EImageDescriberType::SIFT);
+  BOOST_CHECK_EQUAL(nbLoaderCalls, 8);
+  BOOST_CHECK_EQUAL(provider.getNbLoads(), 4);
+  BOOST_CHECK_EQUAL(provider.getMemorySize(), 2 * regionsSize);
+
+  // prefetched views are served from the cache
+  provider.getRegions(7, EImageDescriberType::SIFT);
+  provider.getRegions(8, EImageDescriberType::SIFT);
+  BOOST_CHECK_EQUAL(nbLoaderCalls, 8);
+  BOOST_CHECK_EQUAL(provider.getNbHits(), 3);
+}
+
+BOOST_AUTO_TEST_CASE(regionsProvider_prefetchError) {
+  const RegionsProvider::RegionsLoader loader = [](IndexT viewId, EImageDescriberType descType)
+  {
+    if(viewId == 2)
+      throw std::runtime_error("Can't read the regions of the view 2");
+    std::unique_ptr<SIFT_Regions> regions(new SIFT_Regions);
+    regions->Features().push_back(PointFeature(viewId, 0, 1.f, 0.f));
+    regions->Descriptors().push_back(SIFT_Regions::DescriptorT(static_cast<unsigned char>(viewId)));
+    // view 3 has no regions file
+    return viewId == 3 ? std::unique_ptr<Regions>() : std::unique_ptr<Regions>(regions.release());
+  };
+
+  // the errors are reported once all the loads are done
+  RegionsProvider provider(loader, 0);
+  BOOST_CHECK_THROW(provider.prefetch({0, 1, 2}, EImageDescriberType::SIFT), std::runtime_error);
+  BOOST_CHECK_THROW(provider.prefetch({3}, EImageDescriberType::SIFT), std::runtime_error);
+  BOOST_CHECK_EQUAL(provider.getRegions(1, EImageDescriberType::SIFT)->RegionCount(), 1);
+}
@@ -7,6 +7,7 @@
 #include "DelaunayGraphCut.hpp"
 // #include <aliceVision/fuseCut/MaxFlow_CSR.hpp>
 #include <aliceVision/fuseCut/MaxFlow_AdjList.hpp>
+#include <aliceVision/fuseCut/PixSizeOctree.hpp>
 #include <aliceVision/sfmData/SfMData.hpp>
 #include <aliceVision/mvsData/geometry.hpp>
 #include <aliceVision/mvsData/jetColorMap.hpp>
@@ -16,6 +17,8 @@
 #include <aliceVision/mvsUtils/fileIO.hpp>
 #include <aliceVision/mvsData/imageIO.hpp>
 #include <aliceVision/mvsData/imageAlgo.hpp>
+#include <aliceVision/system/MemoryInfo.hpp>
+#include <aliceVision/system/Timer.hpp>
 #include <aliceVision/alicevision_omp.hpp>
 
 #include "nanoflann.hpp"
@@ -25,6 +28,10 @@
 #include <boost/filesystem.hpp>
 #include <boost/filesystem/operations.hpp>
 
+#include <algorithm>
+#include <atomic>
+#include <memory>
+
 namespace aliceVision {
 namespace fuseCut {
 
@@ -77,129 +84,103 @@ typedef nanoflann::KDTreeSingleIndexAdaptor<
     PointVectorAdaptator,
     3 /* dim */
     > KdTree;
+#endif
 
-/**
- * A result-set class used when performing a radius based search.
- */
-template <typename DistanceType, typename IndexType = size_t>
-class SmallerPixSizeInRadius
-{
-public:
-    const DistanceType radius;
 
-    const std::vector<double>& m_pixSizePrepare;
-    const std::vector<float>& m_simScorePrepare;
-    size_t m_result = 0;
-    const int m_i;
-    bool found = false;
+/// Initial number of octree cells per point in filterByPixSize
+static const std::size_t pixSizeOctreeNbCellsPerPoint = 4;
 
-    inline SmallerPixSizeInRadius(DistanceType radius_,
-                                  const std::vector<double>& pixSizePrepare,
-                                  const std::vector<float>& simScorePrepare,
-                                  int i)
-        : radius(radius_)
-        , m_pixSizePrepare(pixSizePrepare)
-        , m_simScorePrepare(simScorePrepare)
-        , m_i(i)
-    {
-        init();
-    }
+/// Filter by pixSize
+void filterByPixSize(const std::vector<Point3d>& verticesCoordsPrepare, std::vector<double>& pixSizePrepare, double pixSizeMarginCoef, std::vector<float>& simScorePrepare)
+{
+    const int nbPoints = verticesCoordsPrepare.size();
 
-    inline void init() { clear(); }
-    inline void clear() { m_result = 0; }
+    // squared radius of the volume of each point (defined by marginCoef*pixSize), -1 for the invalid points
+    std::vector<double> pixSizeScores(nbPoints, -1.0);
+    Point3d bboxMin(std::numeric_limits<double>::max(), std::numeric_limits<double>::max(), std::numeric_limits<double>::max());
+    Point3d bboxMax(std::numeric_limits<double>::lowest(), std::numeric_limits<double>::lowest(), std::numeric_limits<double>::lowest());
+    double minPixSizeScore = std::numeric_limits<double>::max();
+    double maxPixSizeScore = 0.0;
+    std::size_t nbValidPoints = 0;
 
-    inline size_t size() const { return m_result; }
+    #pragma omp parallel
+    {
+        Point3d threadBboxMin = bboxMin;
+        Point3d threadBboxMax = bboxMax;
+        double threadMinPixSizeScore = minPixSizeScore;
+        double threadMaxPixSizeScore = maxPixSizeScore;
+        std::size_t threadNbValidPoints = 0;
 
-    inline bool full() const { return found; }
+        #pragma omp for nowait
+        for(int vIndex = 0; vIndex < nbPoints; ++vIndex)
+        {
+            if(pixSizePrepare[vIndex] == -1.0)
+            {
+                continue;
+            }
+            const double pixSizeScore = pixSizeMarginCoef * simScorePrepare[vIndex] * pixSizePrepare[vIndex] * pixSizePrepare[vIndex];
+            if(pixSizeScore < std::numeric_limits<double>::epsilon())
+            {
+                pixSizePrepare[vIndex] = -1.0;
+                continue;
+            }
+            pixSizeScores[vIndex] = pixSizeScore;
+            const Point3d& p = verticesCoordsPrepare[vIndex];
+            for(int axis = 0; axis < 3; ++axis)
+            {
+                threadBboxMin.m[axis] = std::min(threadBboxMin.m[axis], p.m[axis]);
+                threadBboxMax.m[axis] = std::max(threadBboxMax.m[axis], p.m[axis]);
+            }
+            threadMinPixSizeScore = std::min(threadMinPixSizeScore, pixSizeScore);
+            threadMaxPixSizeScore = std::max(threadMaxPixSizeScore, pixSizeScore);
+            ++threadNbValidPoints;
+        }
 
-    /**
-     * Called during search to add an element matching the criteria.
-     * @return true if the search should be continued, false if the results are sufficient
-     */
-    inline bool addPoint(DistanceType dist, IndexType index)
-    {
-        if(dist < radius)
+        #pragma omp critical
         {
-            ++m_result;
-            if(m_simScorePrepare[index] * m_pixSizePrepare[index] * m_pixSizePrepare[index] < m_simScorePrepare[m_i] * m_pixSizePrepare[m_i] * m_pixSizePrepare[m_i])
+            for(int axis = 0; axis < 3; ++axis)
             {
-                found = true;
-                return false;
+                bboxMin.m[axis] = std::min(bboxMin.m[axis], threadBboxMin.m[axis]);
+                bboxMax.m[axis] = std::max(bboxMax.m[axis], threadBboxMax.m[axis]);
             }
+            minPixSizeScore = std::min(minPixSizeScore, threadMinPixSizeScore);
+            maxPixSizeScore = std::max(maxPixSizeScore, threadMaxPixSizeScore);
+            nbValidPoints += threadNbValidPoints;
         }
-        return true;
     }
 
-    inline DistanceType worstDist() const { return radius; }
-};
-#endif
-
-
-/// Filter by pixSize
-void filterByPixSize(const std::vector<Point3d>& verticesCoordsPrepare, std::vector<double>& pixSizePrepare, double pixSizeMarginCoef, std::vector<float>& simScorePrepare)
-{
-#ifdef USE_GEOGRAM_KDTREE
-    ALICEVISION_LOG_INFO("Build geogram KdTree index.");
-    GEO::AdaptiveKdTree kdTree(3);
-    kdTree.set_exact(false);
-    kdTree.set_points(verticesCoordsPrepare.size(), verticesCoordsPrepare[0].m);
-#else
-    ALICEVISION_LOG_INFO("Build nanoflann KdTree index.");
-    PointVectorAdaptator pointCloudRef(verticesCoordsPrepare);
-    KdTree kdTree(3 /*dim*/, pointCloudRef, nanoflann::KDTreeSingleIndexAdaptorParams(MAX_LEAF_ELEMENTS));
-    kdTree.buildIndex();
-#endif
-    ALICEVISION_LOG_INFO("KdTree created for " << verticesCoordsPrepare.size() << " points.");
+    if(nbValidPoints == 0)
+        return;
 
-    #pragma omp parallel for
-    for(int vIndex = 0; vIndex < verticesCoordsPrepare.size(); ++vIndex)
+    // the number of cells is unknown before the insertion, restart with more cells if needed
+    std::size_t maxNbCells = pixSizeOctreeNbCellsPerPoint * nbValidPoints;
+    std::unique_ptr<PixSizeOctree> octree;
+    while(!octree)
     {
-        if(pixSizePrepare[vIndex] == -1.0)
+        octree.reset(new PixSizeOctree(verticesCoordsPrepare, bboxMin, bboxMax, minPixSizeScore, maxPixSizeScore, maxNbCells));
+        std::atomic<bool> full{false};
+
+        #pragma omp parallel for
+        for(int vIndex = 0; vIndex < nbPoints; ++vIndex)
         {
-            continue;
+            if(pixSizeScores[vIndex] > 0.0 && !full.load(std::memory_order_relaxed) && !octree->insert(vIndex, pixSizeScores[vIndex]))
+                full.store(true, std::memory_order_relaxed);
         }
-        const double pixSizeScore = pixSizeMarginCoef * simScorePrepare[vIndex] * pixSizePrepare[vIndex] * pixSizePrepare[vIndex];
-        if(pixSizeScore < std::numeric_limits<double>::epsilon())
+        if(full)
         {
-            pixSizePrepare[vIndex] = -1.0;
-            continue;
-        }
-#ifdef USE_GEOGRAM_KDTREE
-        static const std::size_t nbNeighbors = 20;
-        static const double nbNeighborsInv = 1.0 / (double)nbNeighbors;
-        std::array<GEO::index_t, nbNeighbors> nnIndex;
-        std::array<double, nbNeighbors> sqDist;
-        // kdTree.get_nearest_neighbors(nbNeighbors, verticesCoordsPrepare[i].m, &nnIndex.front(), &sqDist.front());
-        kdTree.get_nearest_neighbors(nbNeighbors, vIndex, &nnIndex.front(), &sqDist.front());
-
-        for(std::size_t n = 0; n < nbNeighbors; ++n)
-        {
-            // NOTE: we don't need to test the distance regarding pixSizePrepare[nnIndex[vIndex]]
-            //       as we kill ourself only if our pixSize is bigger
-            if(sqDist[n] < pixSizeScore)
-            {
-                if(pixSizePrepare[nnIndex[n]] < pixSizePrepare[vIndex] ||
-                   (pixSizePrepare[nnIndex[n]] == pixSizePrepare[vIndex] && nnIndex[n] < vIndex)
-                   )
-                {
-                    // Kill itself if inside our volume (defined by marginCoef*pixSize) there is another point with a smaller pixSize
-                    pixSizePrepare[vIndex] = -1.0;
-                    break;
-                }
-            }
-            // else
-            // {
-            //     break;
-            // }
+            octree.reset();
+            maxNbCells *= 2;
         }
-#else
+    }
+    ALICEVISION_LOG_INFO("Octree created for " << nbValidPoints << " points (" << octree->getNbLevels() << " levels, " << octree->getNbCells() << " cells).");
 
-        static const nanoflann::SearchParams searchParams(32, 0, false); // false: dont need to sort
-        SmallerPixSizeInRadius<double, std::size_t> resultSet(pixSizeScore, pixSizePrepare, simScorePrepare, vIndex);
-        kdTree.findNeighbors(resultSet, verticesCoordsPrepare[vIndex].m, searchParams);
-        if(resultSet.found)
+    // A point is removed if its volume contains a point with a smaller pixSize,
+    // the queries only read the octree so the points can be updated concurrently.
+    #pragma omp parallel for schedule(dynamic, 1024)
+    for(int vIndex = 0; vIndex < nbPoints; ++vIndex)
+    {
+        if(pixSizeScores[vIndex] > 0.0 && octree->containsSmallerPoint(vIndex))
             pixSizePrepare[vIndex] = -1.0;
-#endif
     }
     ALICEVISION_LOG_INFO("Filtering done.");
 }
@@ -826,7 +807,8 @@ void DelaunayGraphCut::fuseFromDepthMaps(const StaticVector<int>& cams, const Po
 {
     ALICEVISION_LOG_INFO("fuseFromDepthMaps, maxVertices: " << params.maxPoints);
 
-    std::vector<Point3d> verticesCoordsPrepare;
+    system::Timer timer;
+
     // Load depth from depth maps, select points per depth maps (1 value per tile).
     // Filter points inside other points (with a volume defined by the pixelSize)
     // If too much points at the end, increment a coefficient factor on the pixel size
@@ -842,160 +824,274 @@ void DelaunayGraphCut::fuseFromDepthMaps(const StaticVector<int>& cams, const Po
     int step = std::floor(std::sqrt(double(nbPixels) / double(params.maxInputPoints)));
     step = std::max(step, params.minStep);
     std::size_t realMaxVertices = 0;
-    std::vector<int> startIndex(mp->getNbCameras(), 0);
+    std::vector<std::size_t> nbCamVertices(mp->getNbCameras(), 0);
     for(int i = 0; i < mp->getNbCameras(); ++i)
     {
         const auto& imgParams = mp->getImageParams(i);
-        startIndex[i] = realMaxVertices;
-        realMaxVertices += std::ceil(imgParams.width / step) * std::ceil(imgParams.height / step);
+        nbCamVertices[i] = std::ceil(imgParams.width / step) * std::ceil(imgParams.height / step);
+        realMaxVertices += nbCamVertices[i];
+    }
+
+    // The depth maps are loaded by chunks of cameras and the points of each chunk are merged
+    // with the points kept from the previous chunks, so the number of points in memory is bounded.
+    std::size_t maxInputPointsInMemory = params.maxInputPointsInMemory;
+    if(maxInputPointsInMemory == 0)
+    {
+        // memory used per point while merging: the points and their attributes, the pixSize scores and the octree
+        const std::size_t pointMemorySize = sizeof(Point3d) + sizeof(double) + sizeof(float) + sizeof(double) +
+                                            PixSizeOctree::getMaxMemorySize(1, pixSizeOctreeNbCellsPerPoint);
+        maxInputPointsInMemory = system::getMemoryInfo().freeRam / 2 / pointMemorySize;
     }
-    verticesCoordsPrepare.resize(realMaxVertices);
-    std::vector<double> pixSizePrepare(realMaxVertices);
-    std::vector<float> simScorePrepare(realMaxVertices);
 
     ALICEVISION_LOG_INFO("simFactor: " << params.simFactor);
     ALICEVISION_LOG_INFO("nbPixels: " << nbPixels);
     ALICEVISION_LOG_INFO("maxVertices: " << params.maxPoints);
     ALICEVISION_LOG_INFO("step: " << step);
     ALICEVISION_LOG_INFO("realMaxVertices: " << realMaxVertices);
+    ALICEVISION_LOG_INFO("maxInputPointsInMemory: " << maxInputPointsInMemory);
 
-    ALICEVISION_LOG_INFO("Load depth maps and add points.");
+    std::vector<Point3d> verticesCoordsPrepare;
+    std::vector<double> pixSizePrepare;
+    std::vector<float> simScorePrepare;
+    std::vector<int> startIndex(mp->getNbCameras(), 0);
+    double loadTime = 0.0;
+    double mergeTime = 0.0;
+
+    for(int chunkBegin = 0, chunkEnd = 0; chunkBegin < cams.size(); chunkBegin = chunkEnd)
     {
-        omp_set_nested(1);
-        #pragma omp parallel for num_threads(3)
-        for(int c = 0; c < cams.size(); c++)
+        system::Timer stageTimer;
+
+        // The points kept from the previous chunks are filtered again with each chunk, so the new points get
+        // at least half of the limit. Otherwise, once the kept points fill the memory, each chunk would only
+        // load one camera and filter all the kept points again.
+        const std::size_t nbKeptVertices = verticesCoordsPrepare.size();
+        const std::size_t maxNewVertices = std::max(maxInputPointsInMemory - std::min(nbKeptVertices, maxInputPointsInMemory),
+                                                    maxInputPointsInMemory / 2);
+
+        // at least one camera per chunk
+        std::size_t nbChunkVertices = nbKeptVertices;
+        for(chunkEnd = chunkBegin; chunkEnd < cams.size(); ++chunkEnd)
         {
-            std::vector<float> depthMap;
-            std::vector<float> simMap;
-            std::vector<unsigned char> numOfModalsMap;
-            int width, height;
+            if(chunkEnd > chunkBegin && nbChunkVertices - nbKeptVertices + nbCamVertices[chunkEnd] > maxNewVertices)
+                break;
+            startIndex[chunkEnd] = nbChunkVertices;
+            nbChunkVertices += nbCamVertices[chunkEnd];
+        }
+        verticesCoordsPrepare.resize(nbChunkVertices);
+        pixSizePrepare.resize(nbChunkVertices);
+        simScorePrepare.resize(nbChunkVertices);
+
+        ALICEVISION_LOG_INFO("Load depth maps and add points (cameras " << chunkBegin << " to " << chunkEnd - 1 << ").");
+        {
+            // The maps are read by bands of rows (only the tiles of the band with a tiled storage),
+            // so the memory used by each task doesn't depend on the maps size and all the threads can be used.
+            const int scoreKernelSize = 1;
+            const int bandNbBlocks = std::max(1, 512 / step);
+            // rows read around the band for the similarity convolution and the modals count
+            const int bandMargin = int(std::ceil(params.simGaussianSizeInit)) + scoreKernelSize;
+
+            // The band reads rely on the header of the maps, so the missing maps and the maps of unexpected
+            // dimensions are detected before the parallel loop and their cameras are skipped.
+            std::vector<char> isValidCam(chunkEnd - chunkBegin, 0);
+            std::vector<char> hasNmodMap(chunkEnd - chunkBegin, 0);
+            #pragma omp parallel for
+            for(int c = chunkBegin; c < chunkEnd; ++c)
             {
-                const std::string depthMapFilepath = getFileNameFromIndex(mp, c, mvsUtils::EFileType::depthMap, 0);
-                imageIO::readImage(depthMapFilepath, width, height, depthMap, imageIO::EImageColorSpace::NO_CONVERSION);
-                if(depthMap.empty())
+                const int width = mp->getWidth(c);
+                const int height = mp->getHeight(c);
+                const auto hasCamDimensions = [&](const std::string& filepath)
                 {
-                    ALICEVISION_LOG_WARNING("Empty depth map: " << depthMapFilepath);
-                    continue;
-                }
-                int wTmp, hTmp;
-                const std::string simMapFilepath = getFileNameFromIndex(mp, c, mvsUtils::EFileType::simMap, 0);
-                imageIO::readImage(simMapFilepath, wTmp, hTmp, simMap, imageIO::EImageColorSpace::NO_CONVERSION);
-                if(wTmp != width || hTmp != height)
-                    throw std::runtime_error("Wrong sim map dimensions: " + simMapFilepath);
+                    int mapWidth, mapHeight, mapNbChannels;
+                    imageIO::readImageSpec(filepath, mapWidth, mapHeight, mapNbChannels);
+                    if(mapWidth == width && mapHeight == height)
+                        return true;
+                    ALICEVISION_LOG_WARNING("Wrong map dimensions: " << filepath << " (" << mapWidth << "x" << mapHeight
+                                            << ", expected " << width << "x" << height << ").");
+                    return false;
+                };
+                try
                 {
-                    std::vector<float> simMapTmp(simMap.size());
-                    imageAlgo::convolveImage(width, height, simMap, simMapTmp, "gaussian", params.simGaussianSizeInit, params.simGaussianSizeInit);
-                    simMap.swap(simMapTmp);
+                    const std::string depthMapFilepath = getFileNameFromIndex(mp, c, mvsUtils::EFileType::depthMap, 0);
+                    const std::string simMapFilepath = getFileNameFromIndex(mp, c, mvsUtils::EFileType::simMap, 0);
+                    const std::string nmodMapFilepath = getFileNameFromIndex(mp, c, mvsUtils::EFileType::nmodMap, 0);
+                    if(!boost::filesystem::exists(depthMapFilepath))
+                    {
+                        ALICEVISION_LOG_WARNING("Missing depth map: " << depthMapFilepath);
+                        continue;
+                    }
+                    if(!hasCamDimensions(depthMapFilepath) || !hasCamDimensions(simMapFilepath))
+                        continue;
+                    // If we have an nModMap in input (from depthmapfilter) use it,
+                    // else init with a constant value.
+                    hasNmodMap[c - chunkBegin] = boost::filesystem::exists(nmodMapFilepath);
+                    if(!hasNmodMap[c - chunkBegin])
+                        ALICEVISION_LOG_WARNING("nModMap file can't be found.");
+                    else if(!hasCamDimensions(nmodMapFilepath))
+                        continue;
+                    isValidCam[c - chunkBegin] = 1;
                 }
-
-                const std::string nmodMapFilepath = getFileNameFromIndex(mp, c, mvsUtils::EFileType::nmodMap, 0);
-                // If we have an nModMap in input (from depthmapfilter) use it,
-                // else init with a constant value.
-                if(boost::filesystem::exists(nmodMapFilepath))
+                catch(const std::exception& e)
                 {
-                    imageIO::readImage(nmodMapFilepath, wTmp, hTmp, numOfModalsMap,
-                                       imageIO::EImageColorSpace::NO_CONVERSION);
-                    if(wTmp != width || hTmp != height)
-                        throw std::runtime_error("Wrong nmod map dimensions: " + nmodMapFilepath);
+                    ALICEVISION_LOG_WARNING("Skip the depth map of the camera " << c << ": " << e.what());
                 }
-                else
+            }
+
+            std::vector<std::pair<int, int>> bands; // (camera, first row of blocks)
+            for(int c = chunkBegin; c < chunkEnd; ++c)
+            {
+                if(!isValidCam[c - chunkBegin])
                 {
-                    ALICEVISION_LOG_WARNING("nModMap file can't be found.");
-                    numOfModalsMap.resize(width*height, 1);
+                    // discard the points of the camera
+                    std::fill_n(pixSizePrepare.begin() + startIndex[c], nbCamVertices[c], -1.0);
+                    continue;
                 }
+                const int syMax = std::ceil(mp->getHeight(c) / step);
+                for(int syBegin = 0; syBegin < syMax; syBegin += bandNbBlocks)
+                    bands.emplace_back(c, syBegin);
             }
 
-            int syMax = std::ceil(height/step);
-            int sxMax = std::ceil(width/step);
-            #pragma omp parallel for
-            for(int sy = 0; sy < syMax; ++sy)
+            #pragma omp parallel for schedule(dynamic)
+            for(int b = 0; b < bands.size(); ++b)
             {
-                for(int sx = 0; sx < sxMax; ++sx)
+                const int c = bands[b].first;
+                const int width = mp->getWidth(c);
+                const int height = mp->getHeight(c);
+                const int syMax = std::ceil(height/step);
+                const int sxMax = std::ceil(width/step);
+                const int syBegin = bands[b].second;
+                const int syEnd = std::min(syBegin + bandNbBlocks, syMax);
+                const int yBegin = std::max(syBegin * step - bandMargin, 0);
+                const int yEnd = std::min(syEnd * step + bandMargin, height);
+                const int bandHeight = yEnd - yBegin;
+
+                std::vector<float> depthMap;
+                std::vector<float> simMap;
+                std::vector<unsigned char> numOfModalsMap;
+                try
                 {
-                    int index = startIndex[c] + sy * sxMax + sx;
-                    float bestDepth = std::numeric_limits<float>::max();
-                    float bestScore = 0;
-                    float bestSimScore = 0;
-                    int bestX = 0;
-                    int bestY = 0;
-                    for(int y = sy * step, ymax = std::min((sy+1) * step, height);
-                        y < ymax; ++y)
+                    const std::string depthMapFilepath = getFileNameFromIndex(mp, c, mvsUtils::EFileType::depthMap, 0);
+                    imageIO::readImageRegion(depthMapFilepath, 0, yBegin, width, bandHeight, depthMap);
+                    const std::string simMapFilepath = getFileNameFromIndex(mp, c, mvsUtils::EFileType::simMap, 0);
+                    imageIO::readImageRegion(simMapFilepath, 0, yBegin, width, bandHeight, simMap);
+                    {
+                        std::vector<float> simMapTmp(simMap.size());
+                        imageAlgo::convolveImage(width, bandHeight, simMap, simMapTmp, "gaussian", params.simGaussianSizeInit, params.simGaussianSizeInit);
+                        simMap.swap(simMapTmp);
+                    }
+
+                    if(hasNmodMap[c - chunkBegin])
                     {
-                        for(int x = sx * step, xmax = std::min((sx+1) * step, width);
-                            x < xmax; ++x)
+                        const std::string nmodMapFilepath = getFileNameFromIndex(mp, c, mvsUtils::EFileType::nmodMap, 0);
+                        imageIO::readImageRegion(nmodMapFilepath, 0, yBegin, width, bandHeight, numOfModalsMap);
+                    }
+                    else
+                    {
+                        numOfModalsMap.resize(width*bandHeight, 1);
+                    }
+                }
+                catch(const std::exception& e)
+                {
+                    // e.g. a truncated file, the points of the band are discarded
+                    ALICEVISION_LOG_WARNING("Skip rows " << yBegin << " to " << yEnd - 1 << " of the depth map of the camera " << c << ": " << e.what());
+                    std::fill(pixSizePrepare.begin() + startIndex[c] + syBegin * sxMax,
+                              pixSizePrepare.begin() + startIndex[c] + syEnd * sxMax, -1.0);
+                    continue;
+                }
+
+                for(int sy = syBegin; sy < syEnd; ++sy)
+                {
+                    for(int sx = 0; sx < sxMax; ++sx)
+                    {
+                        int index = startIndex[c] + sy * sxMax + sx;
+                        float bestDepth = std::numeric_limits<float>::max();
+                        float bestScore = 0;
+                        float bestSimScore = 0;
+                        int bestX = 0;
+                        int bestY = 0;
+                        for(int y = sy * step, ymax = std::min((sy+1) * step, height);
+                            y < ymax; ++y)
                         {
-                            const std::size_t index = y * width + x;
-                            const float depth = depthMap[index];
-                            if(depth <= 0.0f)
-                                continue;
-
-                            int numOfModals = 0;
-                            const int scoreKernelSize = 1;
-                            for(int ly = std::max(y-scoreKernelSize, 0), lyMax = std::min(y+scoreKernelSize, height-1); ly < lyMax; ++ly)
+                            for(int x = sx * step, xmax = std::min((sx+1) * step, width);
+                                x < xmax; ++x)
                             {
-                                for(int lx = std::max(x-scoreKernelSize, 0), lxMax = std::min(x+scoreKernelSize, width-1); lx < lxMax; ++lx)
+                                const std::size_t index = (y - yBegin) * width + x;
+                                const float depth = depthMap[index];
+                                if(depth <= 0.0f)
+                                    continue;
+
+                                int numOfModals = 0;
+                                for(int ly = std::max(y-scoreKernelSize, 0), lyMax = std::min(y+scoreKernelSize, height-1); ly < lyMax; ++ly)
                                 {
-                                    if(depthMap[ly * width + lx] > 0.0f)
+                                    for(int lx = std::max(x-scoreKernelSize, 0), lxMax = std::min(x+scoreKernelSize, width-1); lx < lxMax; ++lx)
                                     {
-                                        numOfModals += 10 + int(numOfModalsMap[ly * width + lx]);
+                                        if(depthMap[(ly - yBegin) * width + lx] > 0.0f)
+                                        {
+                                            numOfModals += 10 + int(numOfModalsMap[(ly - yBegin) * width + lx]);
+                                        }
                                     }
                                 }
-                            }
-                            float sim = simMap[index];
-                            sim = sim < 0.0f ?  0.0f : sim; // clamp values < 0
-                            // remap similarity values from [-1;+1] to [+1;+simScale]
-                            // interpretation is [goodSimilarity;badSimilarity]
-                            const float simScore = 1.0f + sim * params.simFactor;
-
-                            const float score = numOfModals + (1.0f / simScore);
-                            if(score > bestScore)
-                            {
-                                bestDepth = depth;
-                                bestScore = score;
-                                bestSimScore = simScore;
-                                bestX = x;
-                                bestY = y;
+                                float sim = simMap[index];
+                                sim = sim < 0.0f ?  0.0f : sim; // clamp values < 0
+                                // remap similarity values from [-1;+1] to [+1;+simScale]
+                                // interpretation is [goodSimilarity;badSimilarity]
+                                const float simScore = 1.0f + sim * params.simFactor;
+
+                                const float score = numOfModals + (1.0f / simScore);
+                                if(score > bestScore)
+                                {
+                                    bestDepth = depth;
+                                    bestScore = score;
+                                    bestSimScore = simScore;
+                                    bestX = x;
+                                    bestY = y;
+                                }
                             }
                         }
-                    }
-                    if(bestScore < 3*13)
-                    {
-                        // discard the point
-                        pixSizePrepare[index] = -1.0;
-                    }
-                    else
-                    {
-                        Point3d p = mp->CArr[c] + (mp->iCamArr[c] * Point2d((float)bestX, (float)bestY)).normalize() * bestDepth;
-                        
-                        // TODO: isPointInHexahedron: here or in the previous loop per pixel to not loose point?
-                        if(voxel == nullptr || mvsUtils::isPointInHexahedron(p, voxel)) 
+                        if(bestScore < 3*13)
                         {
-                            verticesCoordsPrepare[index] = p;
-                            simScorePrepare[index] = bestSimScore;
-                            pixSizePrepare[index] = mp->getCamPixelSize(p, c);
+                            // discard the point
+                            pixSizePrepare[index] = -1.0;
                         }
                         else
                         {
-                            // discard the point
-                            // verticesCoordsPrepare[index] = p;
-                            pixSizePrepare[index] = -1.0;
+                            Point3d p = mp->CArr[c] + (mp->iCamArr[c] * Point2d((float)bestX, (float)bestY)).normalize() * bestDepth;
+                        
+                            // TODO: isPointInHexahedron: here or in the previous loop per pixel to not loose point?
+                            if(voxel == nullptr || mvsUtils::isPointInHexahedron(p, voxel)) 
+                            {
+                                verticesCoordsPrepare[index] = p;
+                                simScorePrepare[index] = bestSimScore;
+                                pixSizePrepare[index] = mp->getCamPixelSize(p, c);
+                            }
+                            else
+                            {
+                                // discard the point
+                                // verticesCoordsPrepare[index] = p;
+                                pixSizePrepare[index] = -1.0;
+                            }
                         }
                     }
                 }
             }
         }
-        omp_set_nested(0);
-    }
 
-    ALICEVISION_LOG_INFO("Filter initial 3D points by pixel size to remove duplicates.");
+        loadTime += stageTimer.elapsed();
+        stageTimer.reset();
 
-    filterByPixSize(verticesCoordsPrepare, pixSizePrepare, params.pixSizeMarginInitCoef, simScorePrepare);
-    // remove points if pixSize == -1
-    removeInvalidPoints(verticesCoordsPrepare, pixSizePrepare, simScorePrepare);
+        ALICEVISION_LOG_INFO("Filter 3D points by pixel size to remove duplicates.");
 
-    ALICEVISION_LOG_INFO("3D points loaded and filtered to " << verticesCoordsPrepare.size() << " points.");
+        filterByPixSize(verticesCoordsPrepare, pixSizePrepare, params.pixSizeMarginInitCoef, simScorePrepare);
+        // remove points if pixSize == -1
+        removeInvalidPoints(verticesCoordsPrepare, pixSizePrepare, simScorePrepare);
+
+        mergeTime += stageTimer.elapsed();
+    }
+
+    ALICEVISION_LOG_INFO("3D points loaded and filtered to " << verticesCoordsPrepare.size() << " points "
+                         << "(load: " << loadTime << " s, merge: " << mergeTime << " s).");
 
     ALICEVISION_LOG_INFO("Init visibilities to compute angle scores");
+    system::Timer stageTimer;
     std::vector<GC_vertexInfo> verticesAttrPrepare(verticesCoordsPrepare.size());
 
     // Compute the vertices positions and simScore from all input depthMap/simMap images,
@@ -1003,7 +1099,10 @@ void DelaunayGraphCut::fuseFromDepthMaps(const StaticVector<int>& cams, const Po
     createVerticesWithVisibilities(cams, verticesCoordsPrepare, pixSizePrepare, simScorePrepare,
                                    verticesAttrPrepare, mp, params.simFactor, params.voteMarginFactor, params.contributeMarginFactor, params.simGaussianSize);
 
+    ALICEVISION_LOG_INFO("Visibilities initialized in " << stageTimer.elapsed() << " s.");
+
     ALICEVISION_LOG_INFO("Compute max angle per point");
+    stageTimer.reset();
 
     ALICEVISION_LOG_INFO("angleFactor: " << params.angleFactor);
     // Compute max visibility angle per point
@@ -1067,7 +1166,10 @@ void DelaunayGraphCut::fuseFromDepthMaps(const StaticVector<int>& cams, const Po
 #endif
     removeInvalidPoints(verticesCoordsPrepare, pixSizePrepare, simScorePrepare, verticesAttrPrepare);
 
+    ALICEVISION_LOG_INFO("Angle scores computed in " << stageTimer.elapsed() << " s.");
+
     ALICEVISION_LOG_INFO("Filter by angle score and sim score");
+    stageTimer.reset();
 
     // while more points than the max points (with a limit to 20 iterations).
     double pixSizeMarginFinalCoef = params.pixSizeMarginFinalCoef;
@@ -1088,14 +1190,16 @@ void DelaunayGraphCut::fuseFromDepthMaps(const StaticVector<int>& cams, const Po
             ALICEVISION_LOG_INFO("Increase pixel size margin coef to " << pixSizeMarginFinalCoef << ", nb points: " << verticesCoordsPrepare.size() << ", maxVertices: " << params.maxPoints);
         }
     }
-    ALICEVISION_LOG_INFO("3D points loaded and filtered to " << verticesCoordsPrepare.size() << " points (maxVertices is " << params.maxPoints << ").");
+    ALICEVISION_LOG_INFO("3D points loaded and filtered to " << verticesCoordsPrepare.size() << " points (maxVertices is " << params.maxPoints << ") in " << stageTimer.elapsed() << " s.");
 
     if(params.refineFuse)
     {
         ALICEVISION_LOG_INFO("Create final visibilities");
+        stageTimer.reset();
         // Initialize the vertice attributes and declare the visibility information
         createVerticesWithVisibilities(cams, verticesCoordsPrepare, pixSizePrepare, simScorePrepare,
                                        verticesAttrPrepare, mp, params.simFactor, params.voteMarginFactor, params.contributeMarginFactor, params.simGaussianSize);
+        ALICEVISION_LOG_INFO("Final visibilities created in " << stageTimer.elapsed() << " s.");
     }
     _verticesCoords.swap(verticesCoordsPrepare);
     _verticesAttr.swap(verticesAttrPrepare);
@@ -1103,7 +1207,7 @@ void DelaunayGraphCut::fuseFromDepthMaps(const StaticVector<int>& cams, const Po
     if(_verticesCoords.size() == 0)
         throw std::runtime_error("Depth map fusion gives an empty result.");
 
-    ALICEVISION_LOG_INFO("fuseFromDepthMaps done: " << _verticesCoords.size() << " points created.");
+    ALICEVISION_LOG_INFO("fuseFromDepthMaps done: " << _verticesCoords.size() << " points created in " << timer.elapsed() << " s.");
 }
 
 void DelaunayGraphCut::loadPrecomputedDensePoints(const StaticVector<int>* voxelsIds, const Point3d voxel[8], VoxelsGrid* ls)
@@ -42,6 +42,10 @@ struct FuseParams
     /// The step used to load depth values from depth maps is computed from maxInputPts. Here we define the minimal value for this step,
     /// so on small datasets we will not spend too much time at the beginning loading all depth values.
     int minStep = 2;
+    /// Max input points kept in memory: the depth maps are loaded and merged by chunks of cameras
+    /// below this limit, 0 to deduce it from the free memory. Each chunk can load half of this limit,
+    /// so it is exceeded when the points kept from the previous chunks fill more than the other half.
+    std::size_t maxInputPointsInMemory = 0;
 
     float simFactor = 15.0f;
     float angleFactor = 15.0f;
@@ -0,0 +1,114 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2020 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include "DepthSimMapCache.hpp"
+#include <aliceVision/system/MemoryInfo.hpp>
+#include <aliceVision/mvsUtils/fileIO.hpp>
+#include <aliceVision/mvsData/imageIO.hpp>
+
+#include <sstream>
+#include <stdexcept>
+
+namespace aliceVision {
+namespace fuseCut {
+
+DepthSimMapCache::DepthSimMapCache(const mvsUtils::MultiViewParams* mp, std::size_t maxMemorySize, int scale)
+  : _mp(mp)
+  , _scale(scale)
+  , _maxMemorySize(maxMemorySize)
+{
+    if(_maxMemorySize == 0)
+        _maxMemorySize = system::getMemoryInfo().freeRam / 2;
+}
+
+DepthSimMapCache::DepthSimMapPtr DepthSimMapCache::get(int rc)
+{
+    const int viewId = _mp->getViewId(rc);
+    std::shared_future<DepthSimMapPtr> future;
+    std::promise<DepthSimMapPtr> promise;
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        const auto it = _maps.find(viewId);
+        if(it != _maps.end())
+        {
+            // the maps being read are not in the LRU list yet
+            if(it->second.lruIt != _lru.end())
+                _lru.splice(_lru.begin(), _lru, it->second.lruIt);
+            future = it->second.maps;
+        }
+        else
+        {
+            Entry& entry = _maps[viewId];
+            entry.maps = promise.get_future().share();
+            entry.lruIt = _lru.end();
+        }
+    }
+
+    // wait for the thread reading the maps, rethrow its error if any
+    if(future.valid())
+        return future.get();
+
+    DepthSimMapPtr maps;
+    try
+    {
+        maps = read(rc);
+    }
+    catch(...)
+    {
+        {
+            // the next request will retry
+            std::lock_guard<std::mutex> lock(_mutex);
+            _maps.erase(viewId);
+        }
+        promise.set_exception(std::current_exception());
+        throw;
+    }
+    promise.set_value(maps);
+
+    std::lock_guard<std::mutex> lock(_mutex);
+    ++_nbReads;
+    _memorySize += maps->memorySize();
+    _lru.push_front(viewId);
+    _maps.at(viewId).lruIt = _lru.begin();
+    // remove the least recently used maps, but always keep the last one
+    while(_memorySize > _maxMemorySize && _lru.size() > 1)
+    {
+        const int oldestViewId = _lru.back();
+        _lru.pop_back();
+        const auto it = _maps.find(oldestViewId);
+        _memorySize -= it->second.maps.get()->memorySize();
+        _maps.erase(it);
+    }
+    return maps;
+}
+
+std::size_t DepthSimMapCache::getNbReads() const
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _nbReads;
+}
+
+DepthSimMapCache::DepthSimMapPtr DepthSimMapCache::read(int rc) const
+{
+    std::shared_ptr<DepthSimMap> maps = std::make_shared<DepthSimMap>();
+    int simWidth, simHeight;
+    imageIO::readImage(getFileNameFromIndex(_mp, rc, mvsUtils::EFileType::depthMap, _scale), maps->width, maps->height,
+                       maps->depthMap, imageIO::EImageColorSpace::NO_CONVERSION);
+    imageIO::readImage(getFileNameFromIndex(_mp, rc, mvsUtils::EFileType::simMap, _scale), simWidth, simHeight,
+                       maps->simMap, imageIO::EImageColorSpace::NO_CONVERSION);
+
+    if((simWidth != maps->width) || (simHeight != maps->height))
+    {
+        std::stringstream s;
+        s << "DepthSimMapCache: bad depth/sim map dimensions for camera: " << _mp->getViewId(rc) << "\n";
+        s << "depthMap: " << maps->width << "x" << maps->height << ", simMap: " << simWidth << "x" << simHeight;
+        throw std::runtime_error(s.str());
+    }
+    return maps;
+}
+
+} // namespace fuseCut
+} // namespace aliceVision
@@ -0,0 +1,89 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2020 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#pragma once
+
+#include <aliceVision/mvsUtils/MultiViewParams.hpp>
+
+#include <cstddef>
+#include <future>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace aliceVision {
+namespace fuseCut {
+
+/**
+ * @brief Depth and similarity maps of a view, as read from the depth map estimation results
+ */
+struct DepthSimMap
+{
+    int width = 0;
+    int height = 0;
+    std::vector<float> depthMap;
+    std::vector<float> simMap;
+
+    std::size_t memorySize() const { return (depthMap.size() + simMap.size()) * sizeof(float); }
+};
+
+/**
+ * @brief Thread-safe cache of the depth/sim maps keyed by view id, bounded in memory.
+ *
+ * A map is read from the disk by the first thread which needs it, the other threads wait for it.
+ * The least recently used maps are evicted when the memory limit is reached,
+ * the maps still in use are kept alive by their shared pointers.
+ */
+class DepthSimMapCache
+{
+public:
+    using DepthSimMapPtr = std::shared_ptr<const DepthSimMap>;
+
+    /**
+     * @param[in] mp the multi-view parameters
+     * @param[in] maxMemorySize maximum size of the cached maps (bytes), 0 for half of the free memory
+     * @param[in] scale scale of the depth/sim map files
+     */
+    DepthSimMapCache(const mvsUtils::MultiViewParams* mp, std::size_t maxMemorySize = 0, int scale = 1);
+
+    /**
+     * @brief Get the depth/sim maps of the camera, read from the disk if not in the cache.
+     * @param[in] rc the camera index
+     */
+    DepthSimMapPtr get(int rc);
+
+    /// number of maps read from the disk
+    std::size_t getNbReads() const;
+
+    std::size_t getMaxMemorySize() const { return _maxMemorySize; }
+
+private:
+    DepthSimMapPtr read(int rc) const;
+
+    const mvsUtils::MultiViewParams* _mp;
+    const int _scale;
+    std::size_t _maxMemorySize;
+
+    struct Entry
+    {
+        std::shared_future<DepthSimMapPtr> maps;
+        /// position in the LRU list, end of the list while the maps are being read
+        std::list<int>::iterator lruIt;
+    };
+
+    mutable std::mutex _mutex;
+    /// maps read or being read, by view id
+    std::map<int, Entry> _maps;
+    /// view ids of the maps read, the most recently used first
+    std::list<int> _lru;
+    std::size_t _memorySize = 0;
+    std::size_t _nbReads = 0;
+};
+
+} // namespace fuseCut
+} // namespace aliceVision
@@ -20,7 +20,12 @@
 #include <boost/accumulators/accumulators.hpp>
 #include <boost/accumulators/statistics.hpp>
 
+#include <algorithm>
 #include <iostream>
+#include <queue>
+#include <sstream>
+#include <stdexcept>
+#include <string>
 
 namespace aliceVision {
 namespace fuseCut {
@@ -58,8 +63,58 @@ unsigned long computeNumberOfAllPoints(const mvsUtils::MultiViewParams* mp, int
     return npts;
 }
 
-Fuser::Fuser(const mvsUtils::MultiViewParams* _mp)
+namespace {
+
+/**
+ * @brief Order the cameras by a breadth-first traversal of their neighborhood graph,
+ *        so that the cameras processed at the same time share their neighbors.
+ * @param[in] cams the cameras
+ * @param[in] tcams the neighbor cameras of each camera
+ * @param[in] nbCams the total number of cameras
+ * @return the indexes in cams
+ */
+std::vector<int> getNeighborsFirstOrder(const StaticVector<int>& cams, const std::vector<StaticVector<int>>& tcams,
+                                        int nbCams)
+{
+    std::vector<int> camIndexes(nbCams, -1);
+    for(int c = 0; c < cams.size(); ++c)
+        camIndexes[cams[c]] = c;
+
+    std::vector<int> order;
+    order.reserve(cams.size());
+    std::vector<bool> visited(cams.size(), false);
+    std::queue<int> queue;
+
+    for(int start = 0; start < cams.size(); ++start)
+    {
+        if(visited[start])
+            continue;
+        visited[start] = true;
+        queue.push(start);
+        while(!queue.empty())
+        {
+            const int c = queue.front();
+            queue.pop();
+            order.push_back(c);
+            for(int i = 0; i < tcams[c].size(); ++i)
+            {
+                const int tcIndex = camIndexes[tcams[c][i]];
+                if(tcIndex >= 0 && !visited[tcIndex])
+                {
+                    visited[tcIndex] = true;
+                    queue.push(tcIndex);
+                }
+            }
+        }
+    }
+    return order;
+}
+
+} // namespace
+
+Fuser::Fuser(const mvsUtils::MultiViewParams* _mp, std::size_t depthSimMapsCacheSize)
   : mp(_mp)
+  , _depthSimMapCache(_mp, depthSimMapsCacheSize)
 {}
 
 Fuser::~Fuser()
@@ -81,8 +136,8 @@ Fuser::~Fuser()
  * @param[in] scale
  */
 bool Fuser::updateInSurr(int pixSizeBall, int pixSizeBallWSP, Point3d& p, int rc, int tc,
-                           StaticVector<int>* numOfPtsMap, StaticVector<float>* depthMap, StaticVector<float>* simMap,
-                           int scale)
+                           std::vector<int>& numOfPtsMap, const std::vector<float>& depthMap,
+                           const std::vector<float>& simMap, int scale)
 {
     int w = mp->getWidth(rc) / scale;
     int h = mp->getHeight(rc) / scale;
@@ -102,7 +157,7 @@ bool Fuser::updateInSurr(int pixSizeBall, int pixSizeBallWSP, Point3d& p, int rc
 
     int d = pixSizeBall;
 
-    float sim = (*simMap)[cell.y * w + cell.x];
+    float sim = simMap[cell.y * w + cell.x];
     if(sim >= 1.0f)
     {
         d = pixSizeBallWSP;
@@ -117,13 +172,13 @@ bool Fuser::updateInSurr(int pixSizeBall, int pixSizeBallWSP, Point3d& p, int rc
         for(ncell.y = std::max(0, cell.y - d); ncell.y <= std::min(h - 1, cell.y + d); ncell.y++)
         {
             // printf("%i %i %i %i %i %i %i %i\n",ncell.x,ncell.y,w,h,w*h,depthMap->size(),cam,scale);
-            float depth = (*depthMap)[ncell.y * w + ncell.x];
+            float depth = depthMap[ncell.y * w + ncell.x];
             // Point3d p1 = mp->CArr[rc] +
             // (mp->iCamArr[rc]*Point2d((float)ncell.x*(float)scale,(float)ncell.y*(float)scale)).normalize()*depth;
             // if ( (p1-p).size() < pixSize ) {
             if(fabs(pixDepth - depth) < pixSize)
             {
-                (*numOfPtsMap)[ncell.y * w + ncell.x]++;
+                numOfPtsMap[ncell.y * w + ncell.x]++;
             }
         }
     }
@@ -136,18 +191,50 @@ void Fuser::filterGroups(const StaticVector<int>& cams, int pixSizeBall, int pix
 {
     ALICEVISION_LOG_INFO("Precomputing groups.");
     long t1 = clock();
+
+    std::vector<StaticVector<int>> tcams(cams.size());
 #pragma omp parallel for
     for(int c = 0; c < cams.size(); c++)
+        tcams[c] = mp->findNearestCamsFromLandmarks(cams[c], nNearestCams);
+
+    // neighbor cameras are processed together, so their depth maps are read once while they are in the cache
+    const std::vector<int> order = getNeighborsFirstOrder(cams, tcams, mp->ncams);
+    const std::size_t nbReadsBefore = _depthSimMapCache.getNbReads();
+
+    _filterGroupsOrder.clear();
+    for(const int c : order)
+        _filterGroupsOrder.push_back(cams[c]);
+
+    // the errors cannot leave the parallel loop
+    std::vector<int> failedViewIds;
+
+#pragma omp parallel for schedule(dynamic)
+    for(int i = 0; i < static_cast<int>(order.size()); i++)
     {
-        int rc = cams[c];
-        filterGroupsRC(rc, pixSizeBall, pixSizeBallWSP, nNearestCams);
+        const int c = order[i];
+        try
+        {
+            filterGroupsRC(cams[c], pixSizeBall, pixSizeBallWSP, tcams[c]);
+        }
+        catch(const std::exception& e)
+        {
+            ALICEVISION_LOG_ERROR("Failed to filter the depth map groups of the view " << mp->getViewId(cams[c]) << ": " << e.what());
+#pragma omp critical
+            failedViewIds.push_back(mp->getViewId(cams[c]));
+        }
     }
 
+    if(!failedViewIds.empty())
+        throw std::runtime_error("Failed to filter the depth map groups of " + std::to_string(failedViewIds.size()) + " cameras.");
+
+    ALICEVISION_LOG_INFO("Depth/sim maps read: " << _depthSimMapCache.getNbReads() - nbReadsBefore << " for "
+                         << cams.size() << " cameras (cache size: "
+                         << _depthSimMapCache.getMaxMemorySize() / (1024 * 1024) << " MB).");
     mvsUtils::printfElapsedTime(t1);
 }
 
 // minNumOfModals number of other cams including this cam ... minNumOfModals /in 2,3,...
-bool Fuser::filterGroupsRC(int rc, int pixSizeBall, int pixSizeBallWSP, int nNearestCams)
+bool Fuser::filterGroupsRC(int rc, int pixSizeBall, int pixSizeBallWSP, const StaticVector<int>& tcams)
 {
     if(mvsUtils::FileExists(getFileNameFromIndex(mp, rc, mvsUtils::EFileType::nmodMap)))
     {
@@ -158,15 +245,9 @@ bool Fuser::filterGroupsRC(int rc, int pixSizeBall, int pixSizeBallWSP, int nNea
     int w = mp->getWidth(rc);
     int h = mp->getHeight(rc);
 
-    StaticVector<float> depthMap;
-    StaticVector<float> simMap;
-
-    {
-        int width, height;
-
-        imageIO::readImage(getFileNameFromIndex(mp, rc, mvsUtils::EFileType::depthMap, 1), width, height, depthMap.getDataWritable(), imageIO::EImageColorSpace::NO_CONVERSION);
-        imageIO::readImage(getFileNameFromIndex(mp, rc, mvsUtils::EFileType::simMap, 1), width, height, simMap.getDataWritable(), imageIO::EImageColorSpace::NO_CONVERSION);
-    }
+    const DepthSimMapCache::DepthSimMapPtr rcMaps = _depthSimMapCache.get(rc);
+    const std::vector<float>& depthMap = rcMaps->depthMap;
+    const std::vector<float>& simMap = rcMaps->simMap;
 
     std::vector<unsigned char> numOfModalsMap(w * h, 0);
 
@@ -178,21 +259,27 @@ bool Fuser::filterGroupsRC(int rc, int pixSizeBall, int pixSizeBallWSP, int nNea
        throw std::runtime_error(s.str());
     }
 
-    StaticVector<int>* numOfPtsMap = new StaticVector<int>();
-    numOfPtsMap->reserve(w * h);
-    numOfPtsMap->resize_with(w * h, 0);
-
-    StaticVector<int> tcams = mp->findNearestCamsFromLandmarks(rc, nNearestCams);
+    // the number of points is not reset between the target cameras
+    std::vector<int> numOfPtsMap(w * h, 0);
 
     for(int c = 0; c < tcams.size(); c++)
     {
-        numOfPtsMap->resize_with(w * h, 0);
         int tc = tcams[c];
 
-        StaticVector<float> tcdepthMap;
-
-        int tcWidth, tcHeight;
-        imageIO::readImage(getFileNameFromIndex(mp, tc, mvsUtils::EFileType::depthMap, 1), tcWidth, tcHeight, tcdepthMap.getDataWritable(), imageIO::EImageColorSpace::NO_CONVERSION);
+        DepthSimMapCache::DepthSimMapPtr tcMaps;
+        try
+        {
+            tcMaps = _depthSimMapCache.get(tc);
+        }
+        catch(const std::exception& e)
+        {
+            // a neighbor without depth map does not support any point
+            ALICEVISION_LOG_WARNING("Cannot read the depth map of the neighbor view " << mp->getViewId(tc) << ": " << e.what());
+            continue;
+        }
+        const std::vector<float>& tcdepthMap = tcMaps->depthMap;
+        const int tcWidth = tcMaps->width;
+        const int tcHeight = tcMaps->height;
 
         if(!tcdepthMap.empty())
         {
@@ -204,14 +291,14 @@ bool Fuser::filterGroupsRC(int rc, int pixSizeBall, int pixSizeBallWSP, int nNea
                     if(depth > 0.0f)
                     {
                       Point3d p = mp->CArr[tc] + (mp->iCamArr[tc] * Point2d((float)x, (float)y)).normalize() * depth;
-                      updateInSurr(pixSizeBall, pixSizeBallWSP, p, rc, tc, numOfPtsMap, &depthMap, &simMap, 1);
+                      updateInSurr(pixSizeBall, pixSizeBallWSP, p, rc, tc, numOfPtsMap, depthMap, simMap, 1);
                     }
                 }
             }
 
             for(int i = 0; i < w * h; i++)
             {
-                numOfModalsMap.at(i) += static_cast<int>((*numOfPtsMap)[i] > 0);
+                numOfModalsMap.at(i) += static_cast<int>(numOfPtsMap[i] > 0);
             }
         }
     }
@@ -222,8 +309,6 @@ bool Fuser::filterGroupsRC(int rc, int pixSizeBall, int pixSizeBallWSP, int nNea
       writeImage(getFileNameFromIndex(mp, rc, mvsUtils::EFileType::nmodMap), w, h, numOfModalsMap, EImageQuality::LOSSLESS, colorspace);
     }
 
-    delete numOfPtsMap;
-
     if(mp->verbose)
         ALICEVISION_LOG_DEBUG(rc << " solved.");
     if(mp->verbose)
@@ -238,13 +323,39 @@ void Fuser::filterDepthMaps(const StaticVector<int>& cams, int minNumOfModals, i
     ALICEVISION_LOG_INFO("Filtering depth maps.");
     long t1 = clock();
 
-#pragma omp parallel for
-    for(int c = 0; c < cams.size(); c++)
+    // the last cameras of filterGroups are the most likely to be still in the cache
+    std::vector<int> order(cams.begin(), cams.end());
     {
-        int rc = cams[c];
-        filterDepthMapsRC(rc, minNumOfModals, minNumOfModalsWSP2SSP);
+        std::vector<int> sortedCams = order;
+        std::vector<int> sortedGroupsOrder = _filterGroupsOrder;
+        std::sort(sortedCams.begin(), sortedCams.end());
+        std::sort(sortedGroupsOrder.begin(), sortedGroupsOrder.end());
+        if(sortedCams == sortedGroupsOrder)
+            order.assign(_filterGroupsOrder.rbegin(), _filterGroupsOrder.rend());
+    }
+
+    // the errors cannot leave the parallel loop
+    std::vector<int> failedViewIds;
+
+#pragma omp parallel for schedule(dynamic)
+    for(int c = 0; c < static_cast<int>(order.size()); c++)
+    {
+        int rc = order[c];
+        try
+        {
+            filterDepthMapsRC(rc, minNumOfModals, minNumOfModalsWSP2SSP);
+        }
+        catch(const std::exception& e)
+        {
+            ALICEVISION_LOG_ERROR("Failed to filter the depth map of the view " << mp->getViewId(rc) << ": " << e.what());
+#pragma omp critical
+            failedViewIds.push_back(mp->getViewId(rc));
+        }
     }
 
+    if(!failedViewIds.empty())
+        throw std::runtime_error("Failed to filter the depth maps of " + std::to_string(failedViewIds.size()) + " cameras.");
+
     mvsUtils::printfElapsedTime(t1);
 }
 
@@ -255,18 +366,22 @@ bool Fuser::filterDepthMapsRC(int rc, int minNumOfModals, int minNumOfModalsWSP2
     int w = mp->getWidth(rc);
     int h = mp->getHeight(rc);
 
-    std::vector<float> depthMap;
-    std::vector<float> simMap;
     std::vector<unsigned char> numOfModalsMap;
 
     {
         int width, height;
-
-        imageIO::readImage(getFileNameFromIndex(mp, rc, mvsUtils::EFileType::depthMap, 1), width, height, depthMap, imageIO::EImageColorSpace::NO_CONVERSION);
-        imageIO::readImage(getFileNameFromIndex(mp, rc, mvsUtils::EFileType::simMap, 1), width, height, simMap, imageIO::EImageColorSpace::NO_CONVERSION);
         imageIO::readImage(getFileNameFromIndex(mp, rc, mvsUtils::EFileType::nmodMap), width, height, numOfModalsMap, imageIO::EImageColorSpace::NO_CONVERSION);
     }
 
+    // copy of the cached maps, they are modified by the filtering
+    std::vector<float> depthMap;
+    std::vector<float> simMap;
+    {
+        const DepthSimMapCache::DepthSimMapPtr rcMaps = _depthSimMapCache.get(rc);
+        depthMap = rcMaps->depthMap;
+        simMap = rcMaps->simMap;
+    }
+
     int nbDepthValues = 0;
 
     for(int i = 0; i < w * h; i++)
@@ -315,9 +430,9 @@ bool Fuser::filterDepthMapsRC(int rc, int minNumOfModals, int minNumOfModalsWSP2
     }
 
     using namespace imageIO;
-    OutputFileColorSpace colorspace(EImageColorSpace::NO_CONVERSION);
-    writeImage(getFileNameFromIndex(mp, rc, mvsUtils::EFileType::depthMap, 0), w, h, depthMap, EImageQuality::LOSSLESS,  colorspace, metadata);
-    writeImage(getFileNameFromIndex(mp, rc, mvsUtils::EFileType::simMap, 0), w, h, simMap, EImageQuality::OPTIMIZED,  colorspace, metadata);
+    const EMapStorage mapStorage = EMapStorage_stringToEnum(mp->userParams.get<std::string>("depthMap.mapStorage", "scanline"));
+    writeMap(getFileNameFromIndex(mp, rc, mvsUtils::EFileType::depthMap, 0), w, h, depthMap, EImageQuality::LOSSLESS, mapStorage, metadata);
+    writeMap(getFileNameFromIndex(mp, rc, mvsUtils::EFileType::simMap, 0), w, h, simMap, EImageQuality::OPTIMIZED, mapStorage, metadata);
 
     if(mp->verbose)
         ALICEVISION_LOG_DEBUG(rc << " solved.");
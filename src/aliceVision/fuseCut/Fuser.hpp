@@ -6,6 +6,7 @@
 
 #pragma once
 
+#include <aliceVision/fuseCut/DepthSimMapCache.hpp>
 #include <aliceVision/mvsUtils/MultiViewParams.hpp>
 #include <aliceVision/mvsData/Point3d.hpp>
 #include <aliceVision/mvsData/StaticVector.hpp>
@@ -25,13 +26,18 @@ class Fuser
 public:
     const mvsUtils::MultiViewParams* mp;
 
-    Fuser(const mvsUtils::MultiViewParams* _mp);
+    /**
+     * @param[in] _mp the multi-view parameters
+     * @param[in] depthSimMapsCacheSize maximum size (bytes) of the depth/sim maps cache shared by the cameras
+     *            filtered in parallel, 0 for half of the free memory
+     */
+    Fuser(const mvsUtils::MultiViewParams* _mp, std::size_t depthSimMapsCacheSize = 0);
     ~Fuser(void);
 
     // minNumOfModals number of other cams including this cam ... minNumOfModals /in 2,3,... default 3
     // pixSizeBall = default 2
     void filterGroups(const StaticVector<int>& cams, int pixSizeBall, int pixSizeBallWSP, int nNearestCams);
-    bool filterGroupsRC(int rc, int pixSizeBall, int pixSizeBallWSP, int nNearestCams);
+    bool filterGroupsRC(int rc, int pixSizeBall, int pixSizeBallWSP, const StaticVector<int>& tcams);
     void filterDepthMaps(const StaticVector<int>& cams, int minNumOfModals, int minNumOfModalsWSP2SSP);
     bool filterDepthMapsRC(int rc, int minNumOfModals, int minNumOfModalsWSP2SSP);
 
@@ -45,8 +51,12 @@ public:
     Voxel estimateDimensions(Point3d* vox, Point3d* newSpace, int scale, int maxOcTreeDim, const sfmData::SfMData* sfmData = nullptr);
 
 private:
-    bool updateInSurr(int pixSizeBall, int pixSizeBallWSP, Point3d& p, int rc, int tc, StaticVector<int>* numOfPtsMap,
-                      StaticVector<float>* depthMap, StaticVector<float>* simMap, int scale);
+    bool updateInSurr(int pixSizeBall, int pixSizeBallWSP, Point3d& p, int rc, int tc, std::vector<int>& numOfPtsMap,
+                      const std::vector<float>& depthMap, const std::vector<float>& simMap, int scale);
+
+    DepthSimMapCache _depthSimMapCache;
+    /// cameras in the order of the last filterGroups
+    std::vector<int> _filterGroupsOrder;
 };
 
 unsigned long computeNumberOfAllPoints(const mvsUtils::MultiViewParams* mp, int scale);
@@ -0,0 +1,276 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2020 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include "PixSizeOctree.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+
+namespace aliceVision {
+namespace fuseCut {
+
+namespace {
+
+/// the bits of the positive doubles are ordered as their values
+std::uint64_t getBits(double value)
+{
+    std::uint64_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    return bits;
+}
+
+} // namespace
+
+PixSizeOctree::PixSizeOctree(const std::vector<Point3d>& points, const Point3d& bboxMin, const Point3d& bboxMax,
+                             double minSqRadius, double maxSqRadius, std::size_t maxNbCells)
+  : _points(points)
+  , _bboxMin(bboxMin)
+  , _maxNbCells(maxNbCells)
+  , _next(points.size(), -1)
+  , _sqRadius(points.size(), 0.0)
+{
+    // the cell coordinates of the first level must fit in their bits of the key
+    const double maxExtent = std::max({bboxMax.x - bboxMin.x, bboxMax.y - bboxMin.y, bboxMax.z - bboxMin.z});
+    _cellSize0 = std::max(2.0 * std::sqrt(minSqRadius), maxExtent / double((std::int64_t(1) << _nbCellBits) - 2));
+    if(!(_cellSize0 > 0.0))
+        _cellSize0 = 1.0;
+    _nbLevels = 1;
+    while(getCellSize(_nbLevels - 1) < 2.0 * std::sqrt(maxSqRadius))
+        ++_nbLevels;
+    if(_nbLevels > 32)
+        throw std::runtime_error("PixSizeOctree: the range of the pixel sizes is too large.");
+
+    // the hash table is kept at most half full
+    std::size_t capacity = 16;
+    while(capacity < 2 * _maxNbCells)
+        capacity *= 2;
+    if(capacity > std::size_t(std::numeric_limits<int>::max()))
+        throw std::runtime_error("PixSizeOctree: too many points.");
+    _mask = capacity - 1;
+
+    _keys.reset(new std::atomic<std::uint64_t>[capacity]);
+    _heads.reset(new std::atomic<int>[capacity]);
+    _minSqRadius.reset(new std::atomic<std::uint64_t>[capacity]);
+
+    const std::uint64_t maxBits = getBits(std::numeric_limits<double>::max());
+
+    #pragma omp parallel for
+    for(std::int64_t i = 0; i < std::int64_t(capacity); ++i)
+    {
+        _keys[i].store(_emptyKey, std::memory_order_relaxed);
+        _heads[i].store(-1, std::memory_order_relaxed);
+        _minSqRadius[i].store(maxBits, std::memory_order_relaxed);
+    }
+}
+
+std::size_t PixSizeOctree::getMaxMemorySize(std::size_t nbPoints, std::size_t maxNbCells)
+{
+    // the capacity of the hash table is the power of two following 2 * maxNbCells
+    const std::size_t maxCapacity = std::max(std::size_t(16), 4 * maxNbCells);
+    const std::size_t slotSize = sizeof(std::atomic<std::uint64_t>) + sizeof(std::atomic<int>) + sizeof(std::atomic<std::uint64_t>);
+    return nbPoints * (sizeof(int) + sizeof(double)) + maxCapacity * slotSize;
+}
+
+bool PixSizeOctree::insert(int index, double sqRadius)
+{
+    _sqRadius[index] = sqRadius;
+    const Point3d& p = _points[index];
+    const std::uint64_t sqRadiusBits = getBits(sqRadius);
+    const int pointLevel = getLevel(sqRadius);
+
+    for(int level = pointLevel; level < _nbLevels; ++level)
+    {
+        std::int64_t cell[3];
+        getCell(p, level, cell);
+        const int slot = findOrCreateCell(level, cell);
+        if(slot < 0)
+            return false;
+
+        if(level == pointLevel)
+            _next[index] = _heads[slot].exchange(index, std::memory_order_relaxed);
+
+        std::uint64_t minBits = _minSqRadius[slot].load(std::memory_order_relaxed);
+        if(minBits <= sqRadiusBits)
+        {
+            // the thread which has set this minimum (or a smaller one) also sets it in the parent cells
+            break;
+        }
+        while(sqRadiusBits < minBits &&
+              !_minSqRadius[slot].compare_exchange_weak(minBits, sqRadiusBits, std::memory_order_relaxed))
+        {
+        }
+    }
+    return true;
+}
+
+bool PixSizeOctree::containsSmallerPoint(int index) const
+{
+    const Point3d& p = _points[index];
+    const double sqRadius = _sqRadius[index];
+    const std::uint64_t sqRadiusBits = getBits(sqRadius);
+
+    struct Node
+    {
+        int level;
+        std::int64_t cell[3];
+    };
+    // depth-first traversal, each level adds at most 7 nodes
+    std::array<Node, 8 + 7 * 32> stack;
+    int stackSize = 0;
+
+    {
+        // the volume of the point is inside the 8 cells of its level around it
+        const int level = getLevel(sqRadius);
+        const double cellSize = getCellSize(level);
+        std::int64_t cell[3];
+        std::int64_t neighbor[3];
+        getCell(p, level, cell);
+        for(int axis = 0; axis < 3; ++axis)
+        {
+            const double c = (p.m[axis] - _bboxMin.m[axis]) / cellSize;
+            neighbor[axis] = (c - double(cell[axis]) < 0.5) ? cell[axis] - 1 : cell[axis] + 1;
+        }
+        for(int n = 0; n < 8; ++n)
+        {
+            Node& node = stack[stackSize++];
+            node.level = level;
+            for(int axis = 0; axis < 3; ++axis)
+                node.cell[axis] = (n & (1 << axis)) ? neighbor[axis] : cell[axis];
+        }
+    }
+
+    while(stackSize > 0)
+    {
+        const Node node = stack[--stackSize];
+        const int slot = findCell(node.level, node.cell);
+        if(slot < 0)
+            continue;
+
+        // no smaller point in the subtree
+        if(_minSqRadius[slot].load(std::memory_order_relaxed) > sqRadiusBits)
+            continue;
+
+        // the cell must intersect the volume of the point
+        const double cellSize = getCellSize(node.level);
+        double sqDist = 0.0;
+        for(int axis = 0; axis < 3; ++axis)
+        {
+            const double cellMin = _bboxMin.m[axis] + double(node.cell[axis]) * cellSize;
+            const double d = std::max({cellMin - p.m[axis], p.m[axis] - cellMin - cellSize, 0.0});
+            sqDist += d * d;
+        }
+        if(sqDist >= sqRadius)
+            continue;
+
+        for(int i = _heads[slot].load(std::memory_order_relaxed); i != -1; i = _next[i])
+        {
+            if(i == index)
+                continue;
+            if((_sqRadius[i] < sqRadius || (_sqRadius[i] == sqRadius && i < index)) &&
+               (_points[i] - p).size2() < sqRadius)
+                return true;
+        }
+
+        if(node.level > 0)
+        {
+            for(int n = 0; n < 8; ++n)
+            {
+                Node& child = stack[stackSize++];
+                child.level = node.level - 1;
+                for(int axis = 0; axis < 3; ++axis)
+                    child.cell[axis] = 2 * node.cell[axis] + ((n >> axis) & 1);
+            }
+        }
+    }
+    return false;
+}
+
+int PixSizeOctree::getLevel(double sqRadius) const
+{
+    int level = 0;
+    while(level < _nbLevels - 1 && getCellSize(level) * getCellSize(level) < 4.0 * sqRadius)
+        ++level;
+    return level;
+}
+
+void PixSizeOctree::getCell(const Point3d& p, int level, std::int64_t cell[3]) const
+{
+    const double cellSize = getCellSize(level);
+    for(int axis = 0; axis < 3; ++axis)
+        cell[axis] = std::int64_t(std::floor((p.m[axis] - _bboxMin.m[axis]) / cellSize));
+}
+
+int PixSizeOctree::findCell(int level, const std::int64_t cell[3]) const
+{
+    for(int axis = 0; axis < 3; ++axis)
+    {
+        if(cell[axis] < 0 || cell[axis] >= (std::int64_t(1) << _nbCellBits))
+            return -1;
+    }
+
+    const std::uint64_t key = getKey(level, cell);
+    std::size_t slot = hashKey(key) & _mask;
+    for(std::size_t probe = 0; probe <= _mask; ++probe)
+    {
+        const std::uint64_t slotKey = _keys[slot].load(std::memory_order_relaxed);
+        if(slotKey == key)
+            return int(slot);
+        if(slotKey == _emptyKey)
+            return -1;
+        slot = (slot + 1) & _mask;
+    }
+    return -1;
+}
+
+int PixSizeOctree::findOrCreateCell(int level, const std::int64_t cell[3])
+{
+    const std::uint64_t key = getKey(level, cell);
+    std::size_t slot = hashKey(key) & _mask;
+    // the table can only be full if the insertions go on after a failure
+    for(std::size_t probe = 0; probe <= _mask; ++probe)
+    {
+        std::uint64_t slotKey = _keys[slot].load(std::memory_order_relaxed);
+        if(slotKey == _emptyKey)
+        {
+            // on failure, slotKey is updated with the key set by another thread
+            if(_keys[slot].compare_exchange_strong(slotKey, key, std::memory_order_relaxed))
+            {
+                if(_nbCells.fetch_add(1, std::memory_order_relaxed) >= _maxNbCells)
+                    return -1;
+                slotKey = key;
+            }
+        }
+        if(slotKey == key)
+            return int(slot);
+        slot = (slot + 1) & _mask;
+    }
+    return -1;
+}
+
+std::uint64_t PixSizeOctree::getKey(int level, const std::int64_t cell[3])
+{
+    const std::uint64_t cellMask = (std::uint64_t(1) << _nbCellBits) - 1;
+    return (std::uint64_t(level) << (3 * _nbCellBits)) | ((std::uint64_t(cell[0]) & cellMask) << (2 * _nbCellBits)) |
+           ((std::uint64_t(cell[1]) & cellMask) << _nbCellBits) | (std::uint64_t(cell[2]) & cellMask);
+}
+
+std::uint64_t PixSizeOctree::hashKey(std::uint64_t key)
+{
+    // splitmix64 finalizer
+    key ^= key >> 30;
+    key *= 0xbf58476d1ce4e5b9ull;
+    key ^= key >> 27;
+    key *= 0x94d049bb133111ebull;
+    key ^= key >> 31;
+    return key;
+}
+
+} // namespace fuseCut
+} // namespace aliceVision
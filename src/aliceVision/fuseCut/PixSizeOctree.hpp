@@ -0,0 +1,107 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2020 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#pragma once
+
+#include <aliceVision/mvsData/Point3d.hpp>
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace aliceVision {
+namespace fuseCut {
+
+/**
+ * @brief Octree of 3D points having their own volume (a ball defined by a margin on their pixel size),
+ *        to find the points containing another point with a smaller volume.
+ *
+ * A point is stored in the first level whose cell size is at least the diameter of its volume,
+ * so the points whose volume contains a position are in the 8 cells of their level around it.
+ * Each cell also keeps the smallest volume of its subtree to prune the queries.
+ *
+ * The cells are stored in a hash table by (level, x, y, z) and the points are inserted concurrently
+ * without locks: the cells are found by open addressing with an atomic compare-and-swap on their key,
+ * the points are pushed to the lists of the cells with an atomic exchange.
+ * The queries must not be mixed with the insertions.
+ */
+class PixSizeOctree
+{
+public:
+    /**
+     * @param[in] points the points, indexed in [0, points.size())
+     * @param[in] bboxMin minimum corner of the bounding box of the points inserted
+     * @param[in] bboxMax maximum corner of the bounding box of the points inserted
+     * @param[in] minSqRadius minimum squared radius of the points inserted
+     * @param[in] maxSqRadius maximum squared radius of the points inserted
+     * @param[in] maxNbCells maximum number of cells, see insert
+     */
+    PixSizeOctree(const std::vector<Point3d>& points, const Point3d& bboxMin, const Point3d& bboxMax,
+                  double minSqRadius, double maxSqRadius, std::size_t maxNbCells);
+
+    /**
+     * @brief Insert a point, thread-safe.
+     * @param[in] index the point index
+     * @param[in] sqRadius the squared radius of the point volume, in [minSqRadius, maxSqRadius]
+     * @return false if the maximum number of cells is reached, the octree can't be used anymore
+     */
+    bool insert(int index, double sqRadius);
+
+    /**
+     * @brief Check if the volume of an inserted point contains another point with a smaller volume,
+     *        or with the same volume and a smaller index.
+     * @param[in] index the point index
+     */
+    bool containsSmallerPoint(int index) const;
+
+    int getNbLevels() const { return _nbLevels; }
+    std::size_t getNbCells() const { return _nbCells.load(); }
+
+    /**
+     * @brief Upper bound of the memory used by an octree (bytes), without the points themselves.
+     * @param[in] nbPoints the number of points
+     * @param[in] maxNbCells the maximum number of cells
+     */
+    static std::size_t getMaxMemorySize(std::size_t nbPoints, std::size_t maxNbCells);
+
+private:
+    int getLevel(double sqRadius) const;
+    double getCellSize(int level) const { return _cellSize0 * double(std::int64_t(1) << level); }
+    void getCell(const Point3d& p, int level, std::int64_t cell[3]) const;
+    /// slot of the cell in the hash table, -1 if the cell is empty
+    int findCell(int level, const std::int64_t cell[3]) const;
+    /// slot of the cell in the hash table, created if needed, -1 if the maximum number of cells is reached
+    int findOrCreateCell(int level, const std::int64_t cell[3]);
+
+    static std::uint64_t getKey(int level, const std::int64_t cell[3]);
+    static std::uint64_t hashKey(std::uint64_t key);
+
+    static const int _nbCellBits = 19;
+    static const std::uint64_t _emptyKey = ~std::uint64_t(0);
+
+    const std::vector<Point3d>& _points;
+    Point3d _bboxMin;
+    double _cellSize0;
+    int _nbLevels;
+    std::size_t _mask;
+    std::size_t _maxNbCells;
+    std::atomic<std::size_t> _nbCells{0};
+
+    std::unique_ptr<std::atomic<std::uint64_t>[]> _keys;
+    /// first point of the level of the cell
+    std::unique_ptr<std::atomic<int>[]> _heads;
+    /// smallest squared radius in the subtree of the cell, stored as the bits of a positive double
+    std::unique_ptr<std::atomic<std::uint64_t>[]> _minSqRadius;
+    /// next point of the same cell, by point index
+    std::vector<int> _next;
+    /// squared radius, by point index
+    std::vector<double> _sqRadius;
+};
+
+} // namespace fuseCut
+} // namespace aliceVision
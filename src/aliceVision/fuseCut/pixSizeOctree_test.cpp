@@ -0,0 +1,178 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2020 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include <aliceVision/fuseCut/PixSizeOctree.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <limits>
+#include <memory>
+#include <random>
+#include <vector>
+
+#define BOOST_TEST_MODULE fuseCutPixSizeOctree
+
+#include <boost/test/unit_test.hpp>
+
+using namespace aliceVision;
+using namespace aliceVision::fuseCut;
+
+namespace {
+
+/**
+ * @brief Insert all the points in parallel, with twice the cells while the octree is full.
+ * @return the number of rebuilds
+ */
+int buildOctree(std::unique_ptr<PixSizeOctree>& octree, const std::vector<Point3d>& points,
+                const std::vector<double>& sqRadius, std::size_t maxNbCells)
+{
+    Point3d bboxMin(std::numeric_limits<double>::max(), std::numeric_limits<double>::max(), std::numeric_limits<double>::max());
+    Point3d bboxMax(std::numeric_limits<double>::lowest(), std::numeric_limits<double>::lowest(), std::numeric_limits<double>::lowest());
+    for(const Point3d& p : points)
+    {
+        for(int axis = 0; axis < 3; ++axis)
+        {
+            bboxMin.m[axis] = std::min(bboxMin.m[axis], p.m[axis]);
+            bboxMax.m[axis] = std::max(bboxMax.m[axis], p.m[axis]);
+        }
+    }
+    const auto minMaxSqRadius = std::minmax_element(sqRadius.begin(), sqRadius.end());
+
+    int nbRebuilds = 0;
+    octree.reset();
+    while(!octree)
+    {
+        octree.reset(new PixSizeOctree(points, bboxMin, bboxMax, *minMaxSqRadius.first, *minMaxSqRadius.second, maxNbCells));
+        std::atomic<bool> full{false};
+
+        #pragma omp parallel for
+        for(int i = 0; i < static_cast<int>(points.size()); ++i)
+        {
+            if(!octree->insert(i, sqRadius[i]))
+                full = true;
+        }
+        if(full)
+        {
+            BOOST_CHECK_GE(octree->getNbCells(), maxNbCells);
+            octree.reset();
+            maxNbCells *= 2;
+            ++nbRebuilds;
+        }
+    }
+    return nbRebuilds;
+}
+
+/// Compare the octree queries with an exhaustive search
+void checkOctree(const std::vector<Point3d>& points, const std::vector<double>& sqRadius, std::size_t maxNbCells)
+{
+    std::unique_ptr<PixSizeOctree> octree;
+    buildOctree(octree, points, sqRadius, maxNbCells);
+
+    std::size_t nbContained = 0;
+    for(int i = 0; i < static_cast<int>(points.size()); ++i)
+    {
+        bool expected = false;
+        for(int j = 0; j < static_cast<int>(points.size()) && !expected; ++j)
+        {
+            expected = (j != i) && (sqRadius[j] < sqRadius[i] || (sqRadius[j] == sqRadius[i] && j < i)) &&
+                       (points[j] - points[i]).size2() < sqRadius[i];
+        }
+        BOOST_CHECK_EQUAL(expected, octree->containsSmallerPoint(i));
+        nbContained += expected;
+    }
+    // the data contain both cases
+    BOOST_CHECK_GT(nbContained, 0);
+    BOOST_CHECK_LT(nbContained, points.size());
+}
+
+} // namespace
+
+BOOST_AUTO_TEST_CASE(PixSizeOctree_containsSmallerPoint)
+{
+    std::mt19937 generator(42);
+    std::uniform_real_distribution<double> coordDistribution(-10.0, 10.0);
+    std::uniform_real_distribution<double> radiusDistribution(0.01, 2.0);
+
+    std::vector<Point3d> points(2000);
+    std::vector<double> sqRadius(points.size());
+    for(std::size_t i = 0; i < points.size(); ++i)
+    {
+        points[i] = Point3d(coordDistribution(generator), coordDistribution(generator), coordDistribution(generator));
+        const double radius = radiusDistribution(generator);
+        sqRadius[i] = radius * radius;
+    }
+    checkOctree(points, sqRadius, 4 * points.size());
+}
+
+BOOST_AUTO_TEST_CASE(PixSizeOctree_ties)
+{
+    std::mt19937 generator(42);
+    std::uniform_real_distribution<double> coordDistribution(0.0, 5.0);
+    std::uniform_int_distribution<int> radiusDistribution(1, 3);
+
+    // a few radii shared by many points, and duplicated points
+    std::vector<Point3d> points;
+    std::vector<double> sqRadius;
+    for(int i = 0; i < 1000; ++i)
+    {
+        const Point3d p(coordDistribution(generator), coordDistribution(generator), coordDistribution(generator));
+        const double radius = 0.2 * radiusDistribution(generator);
+        points.push_back(p);
+        sqRadius.push_back(radius * radius);
+        if(i % 10 == 0)
+        {
+            points.push_back(p);
+            sqRadius.push_back(radius * radius);
+        }
+    }
+    checkOctree(points, sqRadius, 4 * points.size());
+}
+
+BOOST_AUTO_TEST_CASE(PixSizeOctree_flatBoundingBox)
+{
+    std::mt19937 generator(42);
+    std::uniform_real_distribution<double> coordDistribution(-3.0, 3.0);
+    std::uniform_real_distribution<double> radiusDistribution(0.05, 0.5);
+
+    // all the points in the plane z = 1
+    std::vector<Point3d> points(1000);
+    std::vector<double> sqRadius(points.size());
+    for(std::size_t i = 0; i < points.size(); ++i)
+    {
+        points[i] = Point3d(coordDistribution(generator), coordDistribution(generator), 1.0);
+        const double radius = radiusDistribution(generator);
+        sqRadius[i] = radius * radius;
+    }
+    checkOctree(points, sqRadius, 4 * points.size());
+
+    // all the points on a line
+    for(Point3d& p : points)
+        p.y = -2.0;
+    checkOctree(points, sqRadius, 4 * points.size());
+}
+
+BOOST_AUTO_TEST_CASE(PixSizeOctree_rebuild)
+{
+    std::mt19937 generator(42);
+    std::uniform_real_distribution<double> coordDistribution(-10.0, 10.0);
+    std::uniform_real_distribution<double> radiusDistribution(0.01, 1.0);
+
+    std::vector<Point3d> points(1000);
+    std::vector<double> sqRadius(points.size());
+    for(std::size_t i = 0; i < points.size(); ++i)
+    {
+        points[i] = Point3d(coordDistribution(generator), coordDistribution(generator), coordDistribution(generator));
+        const double radius = radiusDistribution(generator);
+        sqRadius[i] = radius * radius;
+    }
+
+    // insert returns false once the cells exceed the limit
+    {
+        std::unique_ptr<PixSizeOctree> octree;
+        BOOST_CHECK_GT(buildOctree(octree, points, sqRadius, 8), 0);
+    }
+    checkOctree(points, sqRadius, 8);
+}
@@ -12,8 +12,12 @@
 #include "aliceVision/matching/metric.hpp"
 #include "aliceVision/stl/indexedSort.hpp"
 #include <aliceVision/config.hpp>
+#include <algorithm>
+#include <limits>
 #include <memory>
 #include <iostream>
+#include <type_traits>
+#include <utility>
 
 namespace aliceVision {
 namespace matching {
@@ -45,6 +49,8 @@ class ArrayMatcher_bruteForce  : public ArrayMatcher<Scalar, Metric>
       return false;
     }
     memMapping.reset(new Eigen::Map<BaseMat>( (Scalar*)dataset, nbRows, dimension) );
+    if (useMatrixProduct)
+      datasetSquaredNorms = memMapping->rowwise().squaredNorm();
     return true;
   }
 
@@ -114,13 +120,20 @@ class ArrayMatcher_bruteForce  : public ArrayMatcher<Scalar, Metric>
       return false;
     }
 
+    pvec_distances->resize(nbQuery * NN);
+    pvec_indices->resize(nbQuery * NN);
+
+    if (useMatrixProduct)
+    {
+      searchNeighboursMatrixProduct(query, nbQuery, pvec_indices, pvec_distances, NN,
+                                    std::integral_constant<bool, useMatrixProduct>());
+      return true;
+    }
+
     //matrix representation of the input data;
     Eigen::Map<BaseMat> mat_query((Scalar*)query, nbQuery, (*memMapping).cols());
     Metric metric;
 
-    pvec_distances->resize(nbQuery * NN);
-    pvec_indices->resize(nbQuery * NN);
-
     #pragma omp parallel for schedule(dynamic)
     for (int queryIndex=0; queryIndex < nbQuery; ++queryIndex) 
     {
@@ -151,8 +164,93 @@ class ArrayMatcher_bruteForce  : public ArrayMatcher<Scalar, Metric>
 
 private:
   typedef Eigen::Matrix<Scalar, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor> BaseMat;
+  typedef Eigen::Matrix<Scalar, Eigen::Dynamic, 1> BaseVec;
+
+  /// Squared L2 distances between floating point descriptors are computed by tiles
+  /// with a matrix product (||a||^2 + ||b||^2 - 2 a.b) instead of query by query
+  static constexpr bool useMatrixProduct = std::is_floating_point<Scalar>::value && isSquaredL2Metric<Metric>::value;
+
+  /// Number of queries and dataset rows of a tile of distances,
+  /// a tile of 256x1024 float distances (1MB) stays in the L2/L3 cache of each core
+  enum : int { queryBlockSize = 256, datasetBlockSize = 1024 };
+
+  void searchNeighboursMatrixProduct(const Scalar*, int, IndMatches*, std::vector<DistanceType>*, size_t, std::false_type)
+  {
+    // not used, matrix product is only enabled for floating point squared L2 metrics
+  }
+
+  void searchNeighboursMatrixProduct(const Scalar * query, int nbQuery,
+                                     IndMatches * pvec_indices,
+                                     std::vector<DistanceType> * pvec_distances,
+                                     size_t NN, std::true_type)
+  {
+    const Eigen::Map<BaseMat>& dataset = *memMapping;
+    const int nbRows = static_cast<int>(dataset.rows());
+    const int dimension = static_cast<int>(dataset.cols());
+    const Eigen::Map<const BaseMat> mat_query(query, nbQuery, dimension);
+    const int nbQueryBlocks = (nbQuery + queryBlockSize - 1) / queryBlockSize;
+
+    #pragma omp parallel for schedule(dynamic)
+    for (int queryBlock = 0; queryBlock < nbQueryBlocks; ++queryBlock)
+    {
+      const int queryBegin = queryBlock * queryBlockSize;
+      const int querySize = std::min<int>(queryBlockSize, nbQuery - queryBegin);
+      const auto queries = mat_query.middleRows(queryBegin, querySize);
+      const BaseVec queriesSquaredNorms = queries.rowwise().squaredNorm();
+
+      // N best candidates of each query of the block, sorted by ascending distance
+      std::vector<std::pair<Scalar, int> > bestCandidates(querySize * NN,
+        std::make_pair(std::numeric_limits<Scalar>::max(), -1));
+
+      BaseMat dotProducts;
+      for (int datasetBegin = 0; datasetBegin < nbRows; datasetBegin += datasetBlockSize)
+      {
+        const int datasetSize = std::min<int>(datasetBlockSize, nbRows - datasetBegin);
+        // Eigen GEMM runs single-threaded inside the OpenMP loop
+        dotProducts.noalias() = queries * dataset.middleRows(datasetBegin, datasetSize).transpose();
+
+        for (int i = 0; i < querySize; ++i)
+        {
+          std::pair<Scalar, int>* best = &bestCandidates[i * NN];
+          const Scalar* dotRow = dotProducts.row(i).data();
+          for (int j = 0; j < datasetSize; ++j)
+          {
+            const Scalar distance = queriesSquaredNorms(i) + datasetSquaredNorms(datasetBegin + j) - Scalar(2) * dotRow[j];
+            if (distance >= best[NN - 1].first)
+              continue;
+            // insertion in the sorted list of candidates
+            std::size_t k = NN - 1;
+            for (; k > 0 && best[k - 1].first > distance; --k)
+              best[k] = best[k - 1];
+            best[k] = std::make_pair(distance, datasetBegin + j);
+          }
+        }
+      }
+
+      // recompute the exact distances of the selected candidates,
+      // the matrix product formulation suffers from cancellation on close descriptors
+      Metric metric;
+      for (int i = 0; i < querySize; ++i)
+      {
+        const int queryIndex = queryBegin + i;
+        std::pair<Scalar, int>* best = &bestCandidates[i * NN];
+        for (std::size_t k = 0; k < NN; ++k)
+          best[k].first = metric(mat_query.row(queryIndex).data(), dataset.row(best[k].second).data(), dimension);
+        std::sort(best, best + NN);
+
+        for (std::size_t k = 0; k < NN; ++k)
+        {
+          (*pvec_distances)[queryIndex * NN + k] = best[k].first;
+          (*pvec_indices)[queryIndex * NN + k] = IndMatch(queryIndex, best[k].second);
+        }
+      }
+    }
+  }
+
   /// Use a memory mapping in order to avoid memory re-allocation
   std::unique_ptr< Eigen::Map<BaseMat> > memMapping;
+  /// Squared norms of the dataset rows, only used with the matrix product
+  BaseVec datasetSquaredNorms;
 };
 
 }  // namespace matching
@@ -0,0 +1,163 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2020 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include "CascadeHasher.hpp"
+#include <aliceVision/system/Logger.hpp>
+
+#include <boost/filesystem.hpp>
+
+#include <cstring>
+#include <fstream>
+
+namespace fs = boost::filesystem;
+
+namespace aliceVision {
+namespace matching {
+
+namespace {
+
+/// Magic number of the hashed descriptions files
+const char HASHED_DESC_MAGIC[8] = {'A', 'V', 'C', 'H', 'A', 'S', 'H', '\0'};
+/// Version of the hashed descriptions file format
+const uint32_t HASHED_DESC_VERSION = 1;
+
+struct HashedDescriptionsHeader
+{
+  char magic[8];
+  uint32_t version;
+  uint32_t nbHashCode;
+  uint32_t nbBucketGroups;
+  uint32_t nbBitsPerBucket;
+  uint32_t randomSeed;
+  uint32_t dimension;
+  uint64_t nbDescriptions;
+};
+
+} // namespace
+
+bool CascadeHasher::SaveHashedDescriptions(const std::string& filepath,
+                                           const HashedDescriptions& hashed_descriptions,
+                                           const Eigen::VectorXf& zero_mean_descriptor) const
+{
+  const uint32_t dimension = static_cast<uint32_t>(zero_mean_descriptor.size());
+  const std::size_t nbBlocks = stl::dynamic_bitset(dimension).num_blocks();
+
+  HashedDescriptionsHeader header;
+  std::memcpy(header.magic, HASHED_DESC_MAGIC, sizeof(header.magic));
+  header.version = HASHED_DESC_VERSION;
+  header.nbHashCode = static_cast<uint32_t>(nb_hash_code_);
+  header.nbBucketGroups = static_cast<uint32_t>(nb_bucket_groups_);
+  header.nbBitsPerBucket = static_cast<uint32_t>(nb_bits_per_bucket_);
+  header.randomSeed = random_seed_;
+  header.dimension = dimension;
+  header.nbDescriptions = hashed_descriptions.hashed_desc.size();
+
+  // write in a temporary file and rename it, so concurrent processes never read a partial file
+  const fs::path tmpPath = fs::path(filepath).parent_path() / fs::unique_path("%%%%%%%%.chash.tmp");
+  {
+    std::ofstream stream(tmpPath.string(), std::ios::out | std::ios::binary);
+    if(!stream.is_open())
+      return false;
+
+    stream.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    stream.write(reinterpret_cast<const char*>(zero_mean_descriptor.data()), dimension * sizeof(float));
+
+    for(const HashedDescription& hashed_desc : hashed_descriptions.hashed_desc)
+    {
+      if(hashed_desc.hash_code.num_blocks() != nbBlocks ||
+         hashed_desc.bucket_ids.size() != static_cast<std::size_t>(nb_bucket_groups_))
+      {
+        stream.close();
+        fs::remove(tmpPath);
+        return false;
+      }
+      stream.write(reinterpret_cast<const char*>(hashed_desc.hash_code.data()), nbBlocks * sizeof(stl::dynamic_bitset::BlockType));
+      stream.write(reinterpret_cast<const char*>(hashed_desc.bucket_ids.data()), nb_bucket_groups_ * sizeof(uint16_t));
+    }
+
+    if(!stream.good())
+    {
+      stream.close();
+      fs::remove(tmpPath);
+      return false;
+    }
+  }
+
+  boost::system::error_code ec;
+  fs::rename(tmpPath, filepath, ec);
+  if(ec)
+  {
+    fs::remove(tmpPath, ec);
+    return false;
+  }
+  return true;
+}
+
+bool CascadeHasher::LoadHashedDescriptions(const std::string& filepath,
+                                           const Eigen::VectorXf& zero_mean_descriptor,
+                                           std::size_t nb_descriptions,
+                                           HashedDescriptions& hashed_descriptions) const
+{
+  std::ifstream stream(filepath, std::ios::in | std::ios::binary);
+  if(!stream.is_open())
+    return false;
+
+  HashedDescriptionsHeader header;
+  stream.read(reinterpret_cast<char*>(&header), sizeof(header));
+  if(!stream.good() || std::memcmp(header.magic, HASHED_DESC_MAGIC, sizeof(header.magic)) != 0)
+    return false;
+
+  const uint32_t dimension = static_cast<uint32_t>(zero_mean_descriptor.size());
+
+  if(header.version != HASHED_DESC_VERSION ||
+     header.nbHashCode != static_cast<uint32_t>(nb_hash_code_) ||
+     header.nbBucketGroups != static_cast<uint32_t>(nb_bucket_groups_) ||
+     header.nbBitsPerBucket != static_cast<uint32_t>(nb_bits_per_bucket_) ||
+     header.randomSeed != random_seed_ ||
+     header.dimension != dimension ||
+     header.nbDescriptions != nb_descriptions)
+  {
+    ALICEVISION_LOG_TRACE("Hashed descriptions file '" << filepath << "' computed with other parameters.");
+    return false;
+  }
+
+  Eigen::VectorXf fileZeroMean(dimension);
+  stream.read(reinterpret_cast<char*>(fileZeroMean.data()), dimension * sizeof(float));
+  if(!stream.good() || std::memcmp(fileZeroMean.data(), zero_mean_descriptor.data(), dimension * sizeof(float)) != 0)
+  {
+    ALICEVISION_LOG_TRACE("Hashed descriptions file '" << filepath << "' computed with another zero mean descriptor.");
+    return false;
+  }
+
+  HashedDescriptions loaded;
+  loaded.hashed_desc.resize(nb_descriptions);
+  for(HashedDescription& hashed_desc : loaded.hashed_desc)
+  {
+    hashed_desc.hash_code = stl::dynamic_bitset(dimension);
+    hashed_desc.bucket_ids.resize(nb_bucket_groups_);
+    stream.read(reinterpret_cast<char*>(hashed_desc.hash_code.data()), hashed_desc.hash_code.num_blocks() * sizeof(stl::dynamic_bitset::BlockType));
+    stream.read(reinterpret_cast<char*>(hashed_desc.bucket_ids.data()), nb_bucket_groups_ * sizeof(uint16_t));
+  }
+
+  if(!stream.good())
+    return false;
+
+  for(const HashedDescription& hashed_desc : loaded.hashed_desc)
+  {
+    for(const uint16_t bucket_id : hashed_desc.bucket_ids)
+    {
+      if(bucket_id >= nb_buckets_per_group_)
+        return false;
+    }
+  }
+
+  BuildBuckets(loaded);
+  hashed_descriptions = std::move(loaded);
+  return true;
+}
+
+} // namespace matching
+} // namespace aliceVision
@@ -14,6 +14,7 @@
 #include <iostream>
 #include <random>
 #include <cmath>
+#include <string>
 
 namespace aliceVision {
 namespace matching {
@@ -69,28 +70,33 @@ private:
   int nb_bucket_groups_;
   // The number of buckets in each group.
   int nb_buckets_per_group_;
+  // The seed of the random hashing projections.
+  uint32_t random_seed_;
 
 public:
   CascadeHasher() {}
 
   // Creates the hashing projections (cascade of two level of hash codes)
+  // A negative random_seed means a non-deterministic initialization,
+  // a fixed seed is required to reuse hashed descriptions between runs.
   bool Init
   (
     const uint8_t nb_hash_code = 128,
     const uint8_t nb_bucket_groups = 6,
-    const uint8_t nb_bits_per_bucket = 10)
+    const uint8_t nb_bits_per_bucket = 10,
+    const int random_seed = -1)
   {
     nb_bucket_groups_= nb_bucket_groups;
     nb_hash_code_ = nb_hash_code;
     nb_bits_per_bucket_ = nb_bits_per_bucket;
     nb_buckets_per_group_= 1 << nb_bits_per_bucket;
+    random_seed_ = (random_seed < 0) ? std::random_device()() : static_cast<uint32_t>(random_seed);
 
     //
     // Box Muller transform is used in the original paper to get fast random number
     // from a normal distribution with <mean = 0> and <variance = 1>.
     // Here we use C++11 normal distribution random number generator
-    std::random_device rd;
-    std::mt19937 gen(rd());
+    std::mt19937 gen(random_seed_);
     std::normal_distribution<> d(0,1);
 
     primary_hash_projection_.resize(nb_hash_code, nb_hash_code);
@@ -198,23 +204,61 @@ public:
       }
     }
     // Build the Buckets
+    BuildBuckets(hashed_descriptions);
+    return hashed_descriptions;
+  }
+
+  // Fill the buckets from the bucket ids of each hashed description.
+  void BuildBuckets(HashedDescriptions& hashed_descriptions) const
+  {
+    hashed_descriptions.buckets.clear();
+    hashed_descriptions.buckets.resize(nb_bucket_groups_);
+    for (int i = 0; i < nb_bucket_groups_; ++i)
     {
-      hashed_descriptions.buckets.resize(nb_bucket_groups_);
-      for (int i = 0; i < nb_bucket_groups_; ++i)
-      {
-        hashed_descriptions.buckets[i].resize(nb_buckets_per_group_);
+      hashed_descriptions.buckets[i].resize(nb_buckets_per_group_);
 
-        // Add the descriptor ID to the proper bucket group and id.
-        for (int j = 0; j < hashed_descriptions.hashed_desc.size(); ++j)
-        {
-          const uint16_t bucket_id = hashed_descriptions.hashed_desc[j].bucket_ids[i];
-          hashed_descriptions.buckets[i][bucket_id].push_back(j);
-        }
+      // Add the descriptor ID to the proper bucket group and id.
+      for (int j = 0; j < hashed_descriptions.hashed_desc.size(); ++j)
+      {
+        const uint16_t bucket_id = hashed_descriptions.hashed_desc[j].bucket_ids[i];
+        hashed_descriptions.buckets[i][bucket_id].push_back(j);
       }
     }
-    return hashed_descriptions;
   }
 
+  /**
+   * @brief Save hashed descriptions in a binary file, with the hasher parameters
+   *        and the zero mean descriptor used to compute them.
+   * @param[in] filepath The output file path
+   * @param[in] hashed_descriptions The hashed descriptions to save
+   * @param[in] zero_mean_descriptor The zero mean descriptor used for hashing
+   * @return true if the file has been written
+   */
+  bool SaveHashedDescriptions
+  (
+    const std::string& filepath,
+    const HashedDescriptions& hashed_descriptions,
+    const Eigen::VectorXf& zero_mean_descriptor
+  ) const;
+
+  /**
+   * @brief Load hashed descriptions from a binary file.
+   *        The file is rejected if it has been computed with other hasher parameters,
+   *        another zero mean descriptor or another number of descriptions.
+   * @param[in] filepath The input file path
+   * @param[in] zero_mean_descriptor The zero mean descriptor that will be used for hashing
+   * @param[in] nb_descriptions The expected number of descriptions
+   * @param[out] hashed_descriptions The loaded hashed descriptions (with their buckets)
+   * @return true if the file is valid and has been loaded
+   */
+  bool LoadHashedDescriptions
+  (
+    const std::string& filepath,
+    const Eigen::VectorXf& zero_mean_descriptor,
+    std::size_t nb_descriptions,
+    HashedDescriptions& hashed_descriptions
+  ) const;
+
   // Matches two collection of hashed descriptions with a fast matching scheme
   // based on the hash codes previously generated.
   template <typename MatrixT, typename DistanceType>
@@ -8,6 +8,7 @@
 #pragma once
 
 #include <aliceVision/matching/metric.hpp>
+#include <aliceVision/matching/metricKernels.hpp>
 
 #include <bitset>
 
@@ -27,6 +28,7 @@ typedef unsigned __int64 uint64_t;
 // Hamming distance count the number of bits in common between descriptors
 //  by using a XOR operation + a count.
 // For maximal performance SSE4 must be enable for builtin popcount activation.
+// On unsigned char descriptors, AVX2/AVX-512 kernels are selected at runtime (see metricKernels.hpp).
 
 namespace aliceVision {
 namespace matching {
@@ -111,6 +113,12 @@ struct Hamming
   template <typename Iterator1, typename Iterator2>
   inline ResultType operator()(Iterator1 a, Iterator2 b, size_t size) const
   {
+    if(sizeof(ElementType) == sizeof(unsigned char))
+    {
+      return kernels::hamming(reinterpret_cast<const unsigned char*>(&(*a)),
+                              reinterpret_cast<const unsigned char*>(&(*b)), size);
+    }
+
     ResultType result = 0;
 // Windows & generic platforms:
 
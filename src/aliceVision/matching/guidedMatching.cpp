@@ -7,9 +7,69 @@
 
 #include "guidedMatching.hpp"
 
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
 namespace aliceVision {
 namespace matching {
 
+PointsGrid::PointsGrid(const std::vector<Vec2>& points, double minCellSize)
+{
+  // non finite points cannot satisfy any error threshold
+  Vec2 pMin = Vec2::Constant(std::numeric_limits<double>::max());
+  Vec2 pMax = Vec2::Constant(std::numeric_limits<double>::lowest());
+  std::size_t nbPoints = 0;
+  for(const Vec2& p : points)
+  {
+    if(!p.allFinite())
+      continue;
+    pMin = pMin.cwiseMin(p);
+    pMax = pMax.cwiseMax(p);
+    ++nbPoints;
+  }
+
+  if(nbPoints == 0)
+    return;
+
+  // about one point per cell
+  const Vec2 extent = (pMax - pMin).cwiseMax(Vec2(1.0, 1.0));
+  _cellSize = std::max({minCellSize, std::sqrt(extent(0) * extent(1) / nbPoints), 1e-6});
+  _origin = pMin;
+
+  // limit the number of cells for the degenerated distributions
+  do
+  {
+    _width = static_cast<int>(std::min(std::floor(extent(0) / _cellSize) + 1, double(std::numeric_limits<int>::max() / 2)));
+    _height = static_cast<int>(std::min(std::floor(extent(1) / _cellSize) + 1, double(std::numeric_limits<int>::max() / 2)));
+    _cellSize *= 2.0;
+  }
+  while(double(_width) * _height > 4.0 * nbPoints + 16.0);
+  _cellSize /= 2.0;
+
+  // counting sort of the points by cell
+  const std::size_t invalidCell = std::numeric_limits<std::size_t>::max();
+  std::vector<std::size_t> pointCells(points.size(), invalidCell);
+  _cellOffsets.assign(static_cast<std::size_t>(_width) * _height + 1, 0);
+  for(std::size_t i = 0; i < points.size(); ++i)
+  {
+    if(!points[i].allFinite())
+      continue;
+    pointCells[i] = static_cast<std::size_t>(cellY(points[i](1))) * _width + cellX(points[i](0));
+    ++_cellOffsets[pointCells[i] + 1];
+  }
+  for(std::size_t c = 1; c < _cellOffsets.size(); ++c)
+    _cellOffsets[c] += _cellOffsets[c - 1];
+
+  _points.resize(nbPoints);
+  std::vector<std::size_t> cellPositions(_cellOffsets.begin(), _cellOffsets.end() - 1);
+  for(std::size_t i = 0; i < points.size(); ++i)
+  {
+    if(pointCells[i] != invalidCell)
+      _points[cellPositions[pointCells[i]]++] = i;
+  }
+}
+
 unsigned int pix_to_bucket(const Vec2i& x, int W, int H)
 {
     if(x(1) == 0)
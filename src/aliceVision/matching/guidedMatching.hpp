@@ -13,11 +13,241 @@
 #include <aliceVision/feature/Regions.hpp>
 #include <aliceVision/camera/IntrinsicBase.hpp>
 
+#include <algorithm>
+#include <cmath>
+#include <memory>
 #include <vector>
 
 namespace aliceVision {
+
+namespace multiview {
+namespace relativePose {
+struct FundamentalEpipolarDistanceError;
+struct HomographyAsymmetricError;
+} // namespace relativePose
+} // namespace multiview
+
 namespace matching {
 
+/**
+ * @brief Uniform grid of 2D points, used to retrieve the points near a location or a line
+ *        without testing all of them.
+ */
+class PointsGrid
+{
+public:
+  /**
+   * @brief Build the grid
+   * @param[in] points The points
+   * @param[in] minCellSize The minimum size of a cell, the cell size is also adapted
+   *            to get about one point per cell
+   */
+  PointsGrid(const std::vector<Vec2>& points, double minCellSize);
+
+  /**
+   * @brief Call f(index) for the points of the cells intersecting the disk (a superset of the points in the disk)
+   * @param[in] center The center of the disk
+   * @param[in] radius The radius of the disk
+   * @param[in] f The function to call
+   */
+  template<typename FuncT>
+  void forEachInDisk(const Vec2& center, double radius, FuncT f) const
+  {
+    if(_points.empty() || !center.allFinite())
+      return;
+
+    // skip the disks outside of the grid
+    if(center(0) + radius < _origin(0) || center(0) - radius > _origin(0) + _width * _cellSize ||
+       center(1) + radius < _origin(1) || center(1) - radius > _origin(1) + _height * _cellSize)
+      return;
+
+    const int xBegin = cellX(center(0) - radius);
+    const int xEnd = cellX(center(0) + radius);
+    const int yBegin = cellY(center(1) - radius);
+    const int yEnd = cellY(center(1) + radius);
+
+    for(int y = yBegin; y <= yEnd; ++y)
+      for(int x = xBegin; x <= xEnd; ++x)
+        forEachInCell(x, y, f);
+  }
+
+  /**
+   * @brief Call f(index) for the points of the cells intersecting the band around the line
+   *        (a superset of the points at a distance to the line lower than the given distance)
+   * @param[in] line The line (a, b, c): ax + by + c = 0
+   * @param[in] distance The half width of the band
+   * @param[in] f The function to call
+   */
+  template<typename FuncT>
+  void forEachNearLine(const Vec3& line, double distance, FuncT f) const
+  {
+    const double norm = line.head<2>().norm();
+    if(_points.empty() || !line.allFinite() || norm == 0.0)
+      return;
+
+    const Vec3 l = line / norm;
+    const bool alongX = std::abs(l(1)) >= std::abs(l(0));
+
+    // iterate on the cells columns (or rows) and compute the range of rows (or columns) in the band:
+    // u in the cell range, v in [(-c - a*u - d) / b, (-c - a*u + d) / b]
+    const double a = alongX ? l(0) : l(1);
+    const double b = alongX ? l(1) : l(0);
+    const double c = l(2);
+    const double uOrigin = alongX ? _origin(0) : _origin(1);
+    const int uSize = alongX ? _width : _height;
+
+    for(int u = 0; u < uSize; ++u)
+    {
+      const double u0 = uOrigin + u * _cellSize;
+      const double u1 = u0 + _cellSize;
+      const double v0 = (-c - a * u0) / b;
+      const double v1 = (-c - a * u1) / b;
+      const double margin = distance / std::abs(b);
+      const double vMin = std::min(v0, v1) - margin;
+      const double vMax = std::max(v0, v1) + margin;
+
+      // skip the band parts outside of the grid
+      const double vOrigin = alongX ? _origin(1) : _origin(0);
+      const double vLength = (alongX ? _height : _width) * _cellSize;
+      if(vMax < vOrigin || vMin > vOrigin + vLength)
+        continue;
+
+      const int vBegin = alongX ? cellY(vMin) : cellX(vMin);
+      const int vEnd = alongX ? cellY(vMax) : cellX(vMax);
+
+      for(int v = vBegin; v <= vEnd; ++v)
+      {
+        if(alongX)
+          forEachInCell(u, v, f);
+        else
+          forEachInCell(v, u, f);
+      }
+    }
+  }
+
+private:
+  int cellX(double x) const
+  {
+    return static_cast<int>(std::max(0.0, std::min(std::floor((x - _origin(0)) / _cellSize), double(_width - 1))));
+  }
+
+  int cellY(double y) const
+  {
+    return static_cast<int>(std::max(0.0, std::min(std::floor((y - _origin(1)) / _cellSize), double(_height - 1))));
+  }
+
+  template<typename FuncT>
+  void forEachInCell(int x, int y, FuncT& f) const
+  {
+    const std::size_t cell = y * _width + x;
+    for(std::size_t i = _cellOffsets[cell]; i < _cellOffsets[cell + 1]; ++i)
+      f(_points[i]);
+  }
+
+  Vec2 _origin;
+  double _cellSize = 1.0;
+  int _width = 0;
+  int _height = 0;
+  /// point indexes sorted by cell, the points of the cell i are in [offsets[i], offsets[i+1])
+  std::vector<std::size_t> _cellOffsets;
+  std::vector<std::size_t> _points;
+};
+
+/**
+ * @brief Area of the right image containing the points that can satisfy the error threshold of a model
+ *        for a left point, to retrieve the candidates from a PointsGrid.
+ *        Not defined by default: all the right points are tested.
+ * @tparam ErrorT The metric to compute distance to the model
+ */
+template<typename ErrorT>
+struct GuidedMatchingSearchArea
+{
+  static constexpr bool isDefined = false;
+
+  /// not used: no grid is built for an undefined search area
+  template<typename ModelT, typename FuncT>
+  static void forEachCandidate(const ModelT&, const Vec2&, double, const PointsGrid&, FuncT) {}
+};
+
+/**
+ * @brief Band around the epipolar line F * xLeft
+ */
+template<>
+struct GuidedMatchingSearchArea<multiview::relativePose::FundamentalEpipolarDistanceError>
+{
+  static constexpr bool isDefined = true;
+
+  template<typename ModelT, typename FuncT>
+  static void forEachCandidate(const ModelT& mod, const Vec2& xLeft, double errorTh, const PointsGrid& grid, FuncT f)
+  {
+    const Vec3 line = mod.getMatrix() * Vec3(xLeft(0), xLeft(1), 1.0);
+    grid.forEachNearLine(line, std::sqrt(errorTh), f);
+  }
+};
+
+/**
+ * @brief Disk around the position H * xLeft
+ */
+template<>
+struct GuidedMatchingSearchArea<multiview::relativePose::HomographyAsymmetricError>
+{
+  static constexpr bool isDefined = true;
+
+  template<typename ModelT, typename FuncT>
+  static void forEachCandidate(const ModelT& mod, const Vec2& xLeft, double errorTh, const PointsGrid& grid, FuncT f)
+  {
+    const Vec3 x = mod.getMatrix() * Vec3(xLeft(0), xLeft(1), 1.0);
+    grid.forEachInDisk(x.head<2>() / x(2), std::sqrt(errorTh), f);
+  }
+};
+
+/**
+ * @brief Call f(j) for the right points to test against a left point, by increasing index:
+ *        the points of the search area of the error if defined, all the right points otherwise.
+ * @param[in] grid The grid of the right points (can be nullptr if the search area is not defined)
+ * @param[in] nbRight The number of right points
+ * @param[in,out] candidates A buffer for the candidate indexes
+ */
+template<typename ModelT, typename ErrorT, typename FuncT>
+void forEachGuidedMatchingCandidate(const ModelT& mod,
+                                    const Vec2& xLeft,
+                                    double errorTh,
+                                    const PointsGrid* grid,
+                                    std::size_t nbRight,
+                                    std::vector<std::size_t>& candidates,
+                                    FuncT f)
+{
+  if(grid == nullptr)
+  {
+    for(std::size_t j = 0; j < nbRight; ++j)
+      f(j);
+    return;
+  }
+
+  candidates.clear();
+  GuidedMatchingSearchArea<ErrorT>::forEachCandidate(mod, xLeft, errorTh, *grid,
+                                                     [&candidates](std::size_t j) { candidates.push_back(j); });
+
+  // same order as the exhaustive search: same choice between equal distances
+  std::sort(candidates.begin(), candidates.end());
+  for(const std::size_t j : candidates)
+    f(j);
+}
+
+/**
+ * @brief Build the grid of the right points if the search area of the error is defined
+ * @param[in] xRight The right points
+ * @param[in] errorTh The error threshold (squared distance)
+ * @return the grid or nullptr
+ */
+template<typename ErrorT>
+std::unique_ptr<PointsGrid> createGuidedMatchingGrid(const std::vector<Vec2>& xRight, double errorTh)
+{
+  if(!GuidedMatchingSearchArea<ErrorT>::isDefined)
+    return nullptr;
+  return std::unique_ptr<PointsGrid>(new PointsGrid(xRight, std::sqrt(errorTh)));
+}
+
 /**
  * @brief Guided Matching (features only):
  *        Use a model to find valid correspondences:
@@ -40,16 +270,24 @@ void guidedMatching(const ModelT& mod, const Mat& xLeft, const Mat& xRight, doub
 
   const ErrorT errorEstimator = ErrorT();
 
+  // index the right points to only test the candidates near the model prediction
+  std::vector<Vec2> rightPoints(xRight.cols());
+  for(Mat::Index j = 0; j < xRight.cols(); ++j)
+    rightPoints[j] = xRight.col(j);
+  const std::unique_ptr<PointsGrid> grid = createGuidedMatchingGrid<ErrorT>(rightPoints, errorTh);
+  std::vector<std::size_t> candidates;
+
   // looking for the corresponding points that have
   // the smallest distance (smaller than the provided Threshold)
   for(Mat::Index i = 0; i < xLeft.cols(); ++i)
   {
     double min = std::numeric_limits<double>::max();
     matching::IndMatch match;
-    for(Mat::Index j = 0; j < xRight.cols(); ++j)
+    const Vec2 xL = xLeft.col(i);
+    forEachGuidedMatchingCandidate<ModelT, ErrorT>(mod, xL, errorTh, grid.get(), rightPoints.size(), candidates, [&](std::size_t j)
     {
       // compute the geometric error: error to the model
-      const double err = errorEstimator.error(mod, xLeft.col(i), xRight.col(j));
+      const double err = errorEstimator.error(mod, xL, rightPoints[j]);
 
       // if smaller error update corresponding index
       if(err < errorTh && err < min)
@@ -57,7 +295,7 @@ void guidedMatching(const ModelT& mod, const Mat& xLeft, const Mat& xRight, doub
         min = err;
         match = matching::IndMatch(i, j);
       }
-    }
+    });
     if(min < errorTh)
     {
       // save the best corresponding index
@@ -251,10 +489,14 @@ void guidedMatching(const ModelT& mod,
       rRegionsPos[i] = rRegions.GetRegionPosition(i);
   }
 
+  // index the right points to only test the candidates near the model prediction
+  const std::unique_ptr<PointsGrid> grid = createGuidedMatchingGrid<ErrorT>(rRegionsPos, errorTh);
+  std::vector<std::size_t> candidates;
+
   for(std::size_t i = 0; i < lRegions.RegionCount(); ++i)
   {
     distanceRatio<double> dR;
-    for(std::size_t j = 0; j < rRegions.RegionCount(); ++j)
+    forEachGuidedMatchingCandidate<ModelT, ErrorT>(mod, lRegionsPos[i], errorTh, grid.get(), rRegionsPos.size(), candidates, [&](std::size_t j)
     {
       // compute the geometric error: error to the model
       const double geomErr = errorEstimator.error(mod, lRegionsPos[i], rRegionsPos[j]);
@@ -264,7 +506,7 @@ void guidedMatching(const ModelT& mod,
         // update the corresponding points & distance (if required)
         dR.update(j, lRegions.SquaredDescriptorDistance(i, &rRegions, j));
       }
-    }
+    });
     // add correspondence only iff the distance ratio is valid
     if(dR.isValid(distRatio))
     {
@@ -0,0 +1,117 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2020 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include <aliceVision/matching/guidedMatching.hpp>
+#include <aliceVision/multiview/relativePose/FundamentalError.hpp>
+#include <aliceVision/multiview/relativePose/HomographyError.hpp>
+
+#define BOOST_TEST_MODULE guidedMatching
+
+#include <boost/test/unit_test.hpp>
+
+#include <random>
+
+using namespace aliceVision;
+using namespace aliceVision::matching;
+
+// same errors without search area: exhaustive search
+struct ExhaustiveFundamentalError : public multiview::relativePose::FundamentalEpipolarDistanceError {};
+struct ExhaustiveHomographyError : public multiview::relativePose::HomographyAsymmetricError {};
+
+/**
+ * @brief Generate left points and right points, half of the right points are the transfer
+ *        of the left points with a noise, the others are uniformly distributed.
+ */
+template<typename TransferFunc>
+void generatePoints(std::size_t nbPoints, const TransferFunc& transfer, Mat& xLeft, Mat& xRight)
+{
+  std::mt19937 gen(0);
+  std::uniform_real_distribution<double> uniformX(0.0, 4000.0);
+  std::uniform_real_distribution<double> uniformY(0.0, 3000.0);
+  std::normal_distribution<double> noise(0.0, 1.0);
+
+  xLeft.resize(2, nbPoints);
+  xRight.resize(2, 2 * nbPoints);
+
+  for(std::size_t i = 0; i < nbPoints; ++i)
+  {
+    xLeft.col(i) = Vec2(uniformX(gen), uniformY(gen));
+    xRight.col(2 * i) = transfer(Vec2(xLeft.col(i)), gen) + Vec2(noise(gen), noise(gen));
+    xRight.col(2 * i + 1) = Vec2(uniformX(gen), uniformY(gen));
+  }
+}
+
+BOOST_AUTO_TEST_CASE(guidedMatching_fundamental_sameAsExhaustive)
+{
+  // horizontal translation: epipolar lines are horizontal lines
+  const Mat3 F = CrossProductMatrix(Vec3(1.0, 0.05, 0.0));
+  const robustEstimation::Mat3Model model(F);
+
+  Mat xLeft, xRight;
+  generatePoints(2000, [&F](const Vec2& x, std::mt19937& gen)
+  {
+    // random position on the epipolar line
+    const Vec3 line = F * Vec3(x(0), x(1), 1.0);
+    const double u = std::uniform_real_distribution<double>(0.0, 4000.0)(gen);
+    return Vec2(u, -(line(0) * u + line(2)) / line(1));
+  }, xLeft, xRight);
+
+  for(const double errorTh : {0.5, 4.0, 100.0})
+  {
+    IndMatches matches, matchesExhaustive;
+    guidedMatching<robustEstimation::Mat3Model, multiview::relativePose::FundamentalEpipolarDistanceError>(model, xLeft, xRight, errorTh, matches);
+    guidedMatching<robustEstimation::Mat3Model, ExhaustiveFundamentalError>(model, xLeft, xRight, errorTh, matchesExhaustive);
+
+    BOOST_CHECK(!matches.empty());
+    BOOST_CHECK(matches == matchesExhaustive);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(guidedMatching_homography_sameAsExhaustive)
+{
+  Mat3 H;
+  H << 0.9, 0.1, 30.0,
+      -0.05, 1.1, -20.0,
+       1e-5, 2e-5, 1.0;
+  const robustEstimation::Mat3Model model(H);
+
+  Mat xLeft, xRight;
+  generatePoints(2000, [&H](const Vec2& x, std::mt19937&)
+  {
+    const Vec3 xH = H * Vec3(x(0), x(1), 1.0);
+    return Vec2(xH.head<2>() / xH(2));
+  }, xLeft, xRight);
+
+  for(const double errorTh : {0.5, 4.0, 100.0})
+  {
+    IndMatches matches, matchesExhaustive;
+    guidedMatching<robustEstimation::Mat3Model, multiview::relativePose::HomographyAsymmetricError>(model, xLeft, xRight, errorTh, matches);
+    guidedMatching<robustEstimation::Mat3Model, ExhaustiveHomographyError>(model, xLeft, xRight, errorTh, matchesExhaustive);
+
+    BOOST_CHECK(!matches.empty());
+    BOOST_CHECK(matches == matchesExhaustive);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(guidedMatching_pointsGrid)
+{
+  std::vector<Vec2> points = {{0.0, 0.0}, {10.0, 0.0}, {10.0, 10.0}, {5.0, 5.0},
+                              {std::numeric_limits<double>::quiet_NaN(), 0.0}};
+  const PointsGrid grid(points, 1.0);
+
+  std::vector<std::size_t> inDisk;
+  grid.forEachInDisk(Vec2(9.5, 9.5), 1.0, [&inDisk](std::size_t i) { inDisk.push_back(i); });
+  BOOST_CHECK(std::find(inDisk.begin(), inDisk.end(), 2) != inDisk.end());
+  BOOST_CHECK(std::find(inDisk.begin(), inDisk.end(), 0) == inDisk.end());
+  BOOST_CHECK(std::find(inDisk.begin(), inDisk.end(), 4) == inDisk.end());
+
+  // diagonal y = x
+  std::vector<std::size_t> nearLine;
+  grid.forEachNearLine(Vec3(1.0, -1.0, 0.0), 0.5, [&nearLine](std::size_t i) { nearLine.push_back(i); });
+  for(const std::size_t i : {0, 2, 3})
+    BOOST_CHECK(std::find(nearLine.begin(), nearLine.end(), i) != nearLine.end());
+  BOOST_CHECK(std::find(nearLine.begin(), nearLine.end(), 1) == nearLine.end());
+}
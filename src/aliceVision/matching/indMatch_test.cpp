@@ -15,6 +15,10 @@
 #include <boost/test/unit_test.hpp>
 #include <boost/test/tools/floating_point_comparison.hpp>
 #include <boost/filesystem.hpp>
+#include <boost/range/iterator_range.hpp>
+
+#include <fstream>
+#include <iterator>
 
 using namespace aliceVision;
 using namespace aliceVision::matching;
@@ -108,6 +112,114 @@ BOOST_AUTO_TEST_CASE(IndMatch_IO)
   boost::filesystem::remove_all(testFolder);
 }
 
+BOOST_AUTO_TEST_CASE(IndMatch_IO_Binary)
+{
+  const std::string testFolder = "matchingBinaryTest";
+  boost::filesystem::create_directory(testFolder);
+  {
+    std::set<IndexT> viewsKeys;
+    PairwiseMatches matches;
+
+    // Test save + load of empty data
+    BOOST_CHECK(Save(matches, testFolder, "bin", false));
+    BOOST_CHECK(Load(matches, viewsKeys, {testFolder}, {}));
+    BOOST_CHECK_EQUAL(0, matches.size());
+  }
+  boost::filesystem::remove_all(testFolder);
+  boost::filesystem::create_directory(testFolder);
+  {
+    std::set<IndexT> viewsKeys = {0, 1, 2, 3};
+    PairwiseMatches matches;
+    // unsorted indices, large gaps and several describer types
+    matches[std::make_pair(0,1)][EImageDescriberType::UNKNOWN] = {{0,0},{1,1}};
+    matches[std::make_pair(0,1)][EImageDescriberType::SIFT] = {{100000,7},{5,4000000},{6,3}};
+    matches[std::make_pair(1,2)][EImageDescriberType::UNKNOWN] = {{10,2},{1,1},{2,20}};
+    matches[std::make_pair(2,3)][EImageDescriberType::UNKNOWN] = {};
+
+    for(bool matchFilePerImage : {false, true})
+    {
+      boost::filesystem::remove_all(testFolder);
+      boost::filesystem::create_directory(testFolder);
+      BOOST_CHECK(Save(matches, testFolder, "bin", matchFilePerImage));
+
+      PairwiseMatches loadedMatches;
+      BOOST_CHECK(Load(loadedMatches, viewsKeys, {testFolder}, {EImageDescriberType::UNKNOWN, EImageDescriberType::SIFT}));
+      BOOST_CHECK_EQUAL(3, loadedMatches.size());
+      for(const auto& pairMatches : matches)
+      {
+        for(const auto& descMatches : pairMatches.second)
+        {
+          const IndMatches& loaded = loadedMatches.at(pairMatches.first).at(descMatches.first);
+          BOOST_CHECK_EQUAL(descMatches.second.size(), loaded.size());
+          BOOST_CHECK(descMatches.second == loaded);
+        }
+      }
+
+      // only load the pairs of the filtered views
+      loadedMatches.clear();
+      BOOST_CHECK(Load(loadedMatches, {0, 1}, {testFolder}, {EImageDescriberType::UNKNOWN, EImageDescriberType::SIFT}));
+      BOOST_CHECK_EQUAL(1, loadedMatches.size());
+      BOOST_CHECK_EQUAL(1, loadedMatches.count(std::make_pair(0,1)));
+    }
+
+    // streaming reader
+    {
+      boost::filesystem::remove_all(testFolder);
+      boost::filesystem::create_directory(testFolder);
+      BOOST_CHECK(Save(matches, testFolder, "bin", false));
+
+      BinaryMatchesReader reader((fs::path(testFolder) / "matches.bin").string());
+      BOOST_CHECK_EQUAL(matches.size(), reader.getNbPairs());
+      for(std::size_t i = 0; i < reader.getNbPairs(); ++i)
+      {
+        MatchesPerDescType pairMatches;
+        reader.readMatches(i, pairMatches);
+        BOOST_CHECK(matches.at(reader.getPair(i)) == pairMatches);
+      }
+    }
+
+    // invalid file
+    {
+      std::ofstream stream((fs::path(testFolder) / "invalid.bin").string());
+      stream << "not a binary match file";
+    }
+    BOOST_CHECK_THROW(BinaryMatchesReader((fs::path(testFolder) / "invalid.bin").string()), std::runtime_error);
+    PairwiseMatches invalidMatches;
+    BOOST_CHECK(!LoadMatchFile(invalidMatches, (fs::path(testFolder) / "invalid.bin").string()));
+
+    // corrupted files: header is 24 bytes (nbPairs at 16), each index table entry is 24 bytes (size at 16)
+    const auto corrupt = [&](std::streamoff position, uint64_t value)
+    {
+      boost::filesystem::remove_all(testFolder);
+      boost::filesystem::create_directory(testFolder);
+      BOOST_CHECK(Save(matches, testFolder, "bin", false));
+      const std::string filepath = (fs::path(testFolder) / "matches.bin").string();
+      std::fstream stream(filepath, std::ios::in | std::ios::out | std::ios::binary);
+      stream.seekp(position);
+      stream.write(reinterpret_cast<const char*>(&value), sizeof(value));
+      return filepath;
+    };
+
+    // the number of pairs is checked against the file size before any allocation
+    {
+      const std::string filepath = corrupt(16, uint64_t(1) << 60);
+      BOOST_CHECK_THROW(BinaryMatchesReader{filepath}, std::runtime_error);
+      BOOST_CHECK(!LoadMatchFile(invalidMatches, filepath));
+    }
+    // the data of a pair can't be outside of the file
+    {
+      const std::string filepath = corrupt(24 + 16, uint64_t(1) << 60);
+      BOOST_CHECK_THROW(BinaryMatchesReader{filepath}, std::runtime_error);
+    }
+    // an error while reading the pairs in parallel is reported
+    {
+      const std::string filepath = corrupt(24 + 16, 0);
+      BOOST_CHECK(!LoadMatchFile(invalidMatches, filepath));
+    }
+  }
+  boost::filesystem::remove_all(testFolder);
+}
+
 BOOST_AUTO_TEST_CASE(IndMatch_DuplicateRemoval_NoRemoval)
 {
   std::vector<IndMatch> vec_indMatch;
@@ -162,3 +274,80 @@ BOOST_AUTO_TEST_CASE(IndMatch_DuplicateRemoval)
   BOOST_CHECK_EQUAL(IndMatch(2,3), vec_indMatch[3]);
   BOOST_CHECK_EQUAL(IndMatch(3,3), vec_indMatch[4]);
 }
+
+BOOST_AUTO_TEST_CASE(IndMatch_IO_Writer)
+{
+  const std::string testFolder = "matchingWriterTest";
+  const std::string saveFolder = (fs::path(testFolder) / "save").string();
+  const std::string writerFolder = (fs::path(testFolder) / "writer").string();
+
+  PairwiseMatches matches;
+  matches[std::make_pair(0,1)][EImageDescriberType::UNKNOWN] = {{0,0},{1,1}};
+  matches[std::make_pair(0,1)][EImageDescriberType::SIFT] = {{100000,7},{5,4000000},{6,3}};
+  matches[std::make_pair(0,3)][EImageDescriberType::SIFT] = {{8,9}};
+  matches[std::make_pair(1,2)][EImageDescriberType::UNKNOWN] = {{10,2},{1,1},{2,20}};
+  matches[std::make_pair(2,3)][EImageDescriberType::UNKNOWN] = {};
+
+  const auto readFile = [](const fs::path& filepath)
+  {
+    std::ifstream stream(filepath.string(), std::ios::in | std::ios::binary);
+    return std::string(std::istreambuf_iterator<char>(stream), std::istreambuf_iterator<char>());
+  };
+
+  for(const std::string extension : {"txt", "bin"})
+  {
+    for(bool matchFilePerImage : {false, true})
+    {
+      boost::filesystem::remove_all(testFolder);
+      boost::filesystem::create_directories(saveFolder);
+      boost::filesystem::create_directories(writerFolder);
+
+      BOOST_CHECK(Save(matches, saveFolder, extension, matchFilePerImage, "0."));
+
+      // write the pairs one by one
+      {
+        MatchesWriter writer(writerFolder, extension, matchFilePerImage, "0.");
+        for(const auto& pairMatches : matches)
+          writer.write(pairMatches.first, pairMatches.second);
+        writer.close();
+      }
+
+      // the written files are identical to the saved ones
+      std::size_t nbFiles = 0;
+      for(const auto& entry : boost::make_iterator_range(fs::directory_iterator(saveFolder), {}))
+      {
+        const fs::path writtenPath = fs::path(writerFolder) / entry.path().filename();
+        BOOST_CHECK(fs::exists(writtenPath));
+        BOOST_CHECK(readFile(entry.path()) == readFile(writtenPath));
+        ++nbFiles;
+      }
+      BOOST_CHECK_EQUAL(matchFilePerImage ? 3 : 1, nbFiles);
+      BOOST_CHECK_EQUAL(nbFiles, std::distance(fs::directory_iterator(writerFolder), fs::directory_iterator()));
+    }
+  }
+
+  // the pairs of a view must be contiguous with one file per image
+  {
+    boost::filesystem::remove_all(testFolder);
+    boost::filesystem::create_directories(writerFolder);
+
+    MatchesWriter writer(writerFolder, "bin", true);
+    writer.write(std::make_pair(0,1), matches.at(std::make_pair(0,1)));
+    writer.write(std::make_pair(1,2), matches.at(std::make_pair(1,2)));
+    BOOST_CHECK_THROW(writer.write(std::make_pair(0,3), matches.at(std::make_pair(0,3))), std::logic_error);
+  }
+
+  // a writer that is not closed does not leave any file
+  for(const bool matchFilePerImage : {false, true})
+  {
+    boost::filesystem::remove_all(testFolder);
+    boost::filesystem::create_directories(writerFolder);
+    {
+      // with one file per image, the files of the first views are already complete
+      MatchesWriter writer(writerFolder, "bin", matchFilePerImage);
+      writer.write(matches);
+    }
+    BOOST_CHECK(fs::is_empty(writerFolder));
+  }
+  boost::filesystem::remove_all(testFolder);
+}
@@ -13,9 +13,13 @@
 #include <boost/filesystem.hpp>
 #include <boost/range/iterator_range.hpp>
 
+#include <atomic>
+#include <cstring>
 #include <map>
 #include <fstream>
 #include <iterator>
+#include <memory>
+#include <stdexcept>
 #include <string>
 #include <vector>
 
@@ -24,13 +28,318 @@ namespace fs = boost::filesystem;
 namespace aliceVision {
 namespace matching {
 
-bool LoadMatchFile(PairwiseMatches& matches, const std::string& filepath)
+namespace {
+
+/// Magic number of the binary match files
+const char BINARY_MATCHES_MAGIC[8] = {'A', 'V', 'M', 'A', 'T', 'C', 'H', '\0'};
+/// Version of the binary match file format
+const uint32_t BINARY_MATCHES_VERSION = 1;
+
+struct BinaryMatchesHeader
+{
+  char magic[8];
+  uint32_t version;
+  uint32_t reserved;
+  uint64_t nbPairs;
+};
+
+static_assert(sizeof(BinaryMatchesHeader) == 24, "Unexpected binary matches header size");
+static_assert(sizeof(BinaryMatchesReader::PairEntry) == 24, "Unexpected binary matches pair entry size");
+
+inline uint64_t zigzagEncode(int64_t value)
+{
+  return (static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63);
+}
+
+inline int64_t zigzagDecode(uint64_t value)
+{
+  return static_cast<int64_t>(value >> 1) ^ -static_cast<int64_t>(value & 1);
+}
+
+inline void writeVarint(std::string& buffer, uint64_t value)
+{
+  while(value >= 0x80)
+  {
+    buffer.push_back(static_cast<char>((value & 0x7f) | 0x80));
+    value >>= 7;
+  }
+  buffer.push_back(static_cast<char>(value));
+}
+
+inline uint64_t readVarint(const char*& ptr, const char* end)
+{
+  uint64_t value = 0;
+  for(int shift = 0; shift < 64; shift += 7)
+  {
+    if(ptr == end)
+      throw std::runtime_error("Unexpected end of binary matches data");
+    const uint8_t byte = static_cast<uint8_t>(*ptr++);
+    value |= static_cast<uint64_t>(byte & 0x7f) << shift;
+    if((byte & 0x80) == 0)
+      return value;
+  }
+  throw std::runtime_error("Invalid variable length integer in binary matches data");
+}
+
+/**
+ * @brief Encode the matches of an image pair:
+ *        nbDescTypes, then for each describer type: name, nbMatches and the delta-encoded indices.
+ */
+void encodePairMatches(const MatchesPerDescType& matchesPerDesc, std::string& buffer)
+{
+  writeVarint(buffer, matchesPerDesc.size());
+  for(const auto& matchesIt : matchesPerDesc)
+  {
+    const std::string descTypeName = feature::EImageDescriberType_enumToString(matchesIt.first);
+    writeVarint(buffer, descTypeName.size());
+    buffer.append(descTypeName);
+
+    const IndMatches& indMatches = matchesIt.second;
+    writeVarint(buffer, indMatches.size());
+
+    // matches order is kept (they may be sorted by quality), so deltas are signed
+    int64_t prevI = 0;
+    int64_t prevJ = 0;
+    for(const IndMatch& m : indMatches)
+    {
+      writeVarint(buffer, zigzagEncode(static_cast<int64_t>(m._i) - prevI));
+      writeVarint(buffer, zigzagEncode(static_cast<int64_t>(m._j) - prevJ));
+      prevI = m._i;
+      prevJ = m._j;
+    }
+  }
+}
+
+void decodePairMatches(const char* ptr, const char* end, MatchesPerDescType& matchesPerDesc)
+{
+  const uint64_t nbDescTypes = readVarint(ptr, end);
+  for(uint64_t d = 0; d < nbDescTypes; ++d)
+  {
+    const uint64_t nameSize = readVarint(ptr, end);
+    if(nameSize > static_cast<uint64_t>(end - ptr))
+      throw std::runtime_error("Unexpected end of binary matches data");
+    const std::string descTypeName(ptr, nameSize);
+    ptr += nameSize;
+
+    const uint64_t nbMatches = readVarint(ptr, end);
+    // each match uses at least 2 bytes
+    if(nbMatches > static_cast<uint64_t>(end - ptr) / 2)
+      throw std::runtime_error("Invalid number of matches in binary matches data");
+
+    IndMatches& indMatches = matchesPerDesc[feature::EImageDescriberType_stringToEnum(descTypeName)];
+    indMatches.resize(nbMatches);
+
+    int64_t prevI = 0;
+    int64_t prevJ = 0;
+    for(IndMatch& m : indMatches)
+    {
+      prevI += zigzagDecode(readVarint(ptr, end));
+      prevJ += zigzagDecode(readVarint(ptr, end));
+      m._i = static_cast<IndexT>(prevI);
+      m._j = static_cast<IndexT>(prevJ);
+    }
+  }
+}
+
+/**
+ * @brief Move the matches of an image pair at the end of the existing matches of this pair.
+ */
+void appendPairMatches(PairwiseMatches& matches, const Pair& pair, MatchesPerDescType&& pairMatches)
+{
+  MatchesPerDescType& outPairMatches = matches[pair];
+  for(auto& matchesIt : pairMatches)
+  {
+    IndMatches& outMatches = outPairMatches[matchesIt.first];
+    if(outMatches.empty())
+    {
+      outMatches = std::move(matchesIt.second);
+    }
+    else
+    {
+      outMatches.insert(outMatches.end(),
+                        std::make_move_iterator(matchesIt.second.begin()),
+                        std::make_move_iterator(matchesIt.second.end()));
+    }
+  }
+}
+
+/**
+ * @brief Write the matches of an image pair in the text format.
+ */
+void writeTxtPairMatches(std::ostream& stream, const Pair& pair, const MatchesPerDescType& matchesPerDesc)
+{
+  stream << pair.first << " " << pair.second << '\n'
+         << matchesPerDesc.size() << '\n';
+  for(const auto& m: matchesPerDesc)
+  {
+    stream << feature::EImageDescriberType_enumToString(m.first) << " " << m.second.size() << '\n';
+    copy(m.second.begin(), m.second.end(), std::ostream_iterator<IndMatch>(stream, "\n"));
+  }
+}
+
+/**
+ * @brief Get a unique temporary path next to the given file, with the same extension.
+ */
+std::string getTemporaryPath(const std::string& filepath)
+{
+  const fs::path bPath = fs::path(filepath);
+  return (bPath.parent_path() / bPath.stem()).string() + "." + fs::unique_path().string() + bPath.extension().string();
+}
+
+inline bool isPairInFilter(const std::set<IndexT>& viewsKeysFilter, IndexT I, IndexT J)
+{
+  return viewsKeysFilter.empty() || (viewsKeysFilter.count(I) && viewsKeysFilter.count(J));
+}
+
+bool loadBinaryMatchFile(PairwiseMatches& matches, const std::string& filepath, const std::set<IndexT>& viewsKeysFilter)
+{
+  std::unique_ptr<BinaryMatchesReader> reader;
+  try
+  {
+    reader.reset(new BinaryMatchesReader(filepath));
+  }
+  catch(const std::exception& e)
+  {
+    ALICEVISION_LOG_WARNING(e.what());
+    return false;
+  }
+
+  // pairs are selected with the index table, the other ones are never read
+  std::vector<std::size_t> pairIndices;
+  pairIndices.reserve(reader->getNbPairs());
+  for(std::size_t i = 0; i < reader->getNbPairs(); ++i)
+  {
+    const Pair pair = reader->getPair(i);
+    if(isPairInFilter(viewsKeysFilter, pair.first, pair.second))
+      pairIndices.push_back(i);
+  }
+
+  std::vector<MatchesPerDescType> pairsMatches(pairIndices.size());
+  std::atomic<bool> valid(true);
+
+  const auto reportError = [&](const std::exception& e)
+  {
+    #pragma omp critical
+    ALICEVISION_LOG_WARNING("Invalid binary match file '" << filepath << "': " << e.what());
+    valid = false;
+  };
+
+  #pragma omp parallel
+  {
+    // one stream per thread
+    std::unique_ptr<BinaryMatchesReader> threadReader;
+    try
+    {
+      threadReader.reset(new BinaryMatchesReader(*reader));
+    }
+    catch(const std::exception& e)
+    {
+      reportError(e);
+    }
+
+    // the exceptions must not leave the worksharing loop, all the threads have to reach its barrier
+    #pragma omp for schedule(dynamic, 64)
+    for(int i = 0; i < static_cast<int>(pairIndices.size()); ++i)
+    {
+      if(!threadReader || !valid)
+        continue;
+      try
+      {
+        threadReader->readMatches(pairIndices[i], pairsMatches[i]);
+      }
+      catch(const std::exception& e)
+      {
+        reportError(e);
+      }
+    }
+  }
+
+  if(!valid)
+    return false;
+
+  for(std::size_t i = 0; i < pairIndices.size(); ++i)
+    appendPairMatches(matches, reader->getPair(pairIndices[i]), std::move(pairsMatches[i]));
+
+  return true;
+}
+
+} // namespace
+
+BinaryMatchesReader::BinaryMatchesReader(const std::string& filepath)
+  : _filepath(filepath)
+  , _stream(filepath, std::ios::in | std::ios::binary)
+{
+  if(!_stream.is_open())
+    throw std::runtime_error("Unable to open binary match file: " + filepath);
+
+  BinaryMatchesHeader header;
+  _stream.read(reinterpret_cast<char*>(&header), sizeof(header));
+  if(!_stream.good() || std::memcmp(header.magic, BINARY_MATCHES_MAGIC, sizeof(header.magic)) != 0)
+    throw std::runtime_error("Invalid binary match file: " + filepath);
+  if(header.version != BINARY_MATCHES_VERSION)
+    throw std::runtime_error("Unsupported binary match file version " + std::to_string(header.version) + ": " + filepath);
+
+  // the counts and offsets come from the file: check them against its size before any allocation
+  _stream.seekg(0, std::ios::end);
+  const uint64_t fileSize = static_cast<uint64_t>(_stream.tellg());
+  _stream.seekg(sizeof(header));
+  const uint64_t dataBegin = sizeof(header) + header.nbPairs * sizeof(PairEntry);
+  if(!_stream.good() || header.nbPairs > (fileSize - sizeof(header)) / sizeof(PairEntry))
+    throw std::runtime_error("Invalid binary match file index table: " + filepath);
+
+  std::shared_ptr<std::vector<PairEntry>> entries = std::make_shared<std::vector<PairEntry>>(header.nbPairs);
+  if(header.nbPairs > 0)
+    _stream.read(reinterpret_cast<char*>(entries->data()), header.nbPairs * sizeof(PairEntry));
+  if(!_stream.good())
+    throw std::runtime_error("Invalid binary match file index table: " + filepath);
+
+  for(const PairEntry& entry : *entries)
+  {
+    if(entry.offset < dataBegin || entry.offset > fileSize || entry.size > fileSize - entry.offset)
+      throw std::runtime_error("Invalid binary match file index table: " + filepath);
+  }
+  _entries = entries;
+}
+
+BinaryMatchesReader::BinaryMatchesReader(const BinaryMatchesReader& other)
+  : _filepath(other._filepath)
+  , _stream(other._filepath, std::ios::in | std::ios::binary)
+  , _entries(other._entries)
+{
+  if(!_stream.is_open())
+    throw std::runtime_error("Unable to open binary match file: " + _filepath);
+}
+
+Pair BinaryMatchesReader::getPair(std::size_t index) const
+{
+  const PairEntry& entry = _entries->at(index);
+  return std::make_pair(static_cast<IndexT>(entry.I), static_cast<IndexT>(entry.J));
+}
+
+void BinaryMatchesReader::readMatches(std::size_t index, MatchesPerDescType& matches)
+{
+  const PairEntry& entry = _entries->at(index);
+  _buffer.resize(entry.size);
+  _stream.seekg(entry.offset);
+  if(entry.size > 0)
+    _stream.read(_buffer.data(), entry.size);
+  if(!_stream.good())
+    throw std::runtime_error("Unable to read the matches of the pair " + std::to_string(entry.I) + "-" + std::to_string(entry.J));
+  decodePairMatches(_buffer.data(), _buffer.data() + _buffer.size(), matches);
+}
+
+bool LoadMatchFile(PairwiseMatches& matches, const std::string& filepath, const std::set<IndexT>& viewsKeysFilter)
 {
   const std::string ext = fs::extension(filepath);
 
   if(!fs::exists(filepath))
     return false;
 
+  if(ext == ".bin")
+  {
+    return loadBinaryMatchFile(matches, filepath, viewsKeysFilter);
+  }
+
   if(ext == ".txt")
   {
     std::ifstream stream(filepath.c_str());
@@ -65,7 +374,8 @@ bool LoadMatchFile(PairwiseMatches& matches, const std::string& filepath)
         {
           stream >> matchesPerDesc[i];
         }
-        matches[std::make_pair(I,J)][descType] = std::move(matchesPerDesc);
+        if(isPairInFilter(viewsKeysFilter, I, J))
+          matches[std::make_pair(I,J)][descType] = std::move(matchesPerDesc);
       }
     }
     stream.close();
@@ -136,87 +446,95 @@ std::size_t LoadMatchFilePerImage(PairwiseMatches& matches,
                                   const std::string& extension)
 {
   int nbLoadedMatchFiles = 0;
+  const std::vector<IndexT> views(viewsKeys.begin(), viewsKeys.end());
+  // each file is loaded in its own container, they are merged afterwards
+  std::vector<PairwiseMatches> filesMatches(views.size());
+  std::vector<char> loaded(views.size(), 0);
+
   // Load one match file per image
-  #pragma omp parallel for num_threads(3)
-  for(ptrdiff_t i = 0; i < static_cast<ptrdiff_t>(viewsKeys.size()); ++i)
-  {
-    std::set<IndexT>::const_iterator it = viewsKeys.begin();
-    std::advance(it, i);
-    const IndexT idView = *it;
-    const std::string matchFilename = std::to_string(idView) + "." + extension;
-    PairwiseMatches fileMatches;
-    if(!LoadMatchFile(fileMatches, (fs::path(folder) / matchFilename).string() ))
+  #pragma omp parallel for schedule(dynamic)
+  for(ptrdiff_t i = 0; i < static_cast<ptrdiff_t>(views.size()); ++i)
+  {
+    const std::string matchFilename = std::to_string(views[i]) + "." + extension;
+    if(!LoadMatchFile(filesMatches[i], (fs::path(folder) / matchFilename).string()))
     {
-      #pragma omp critical
-      {
-        ALICEVISION_LOG_DEBUG("Unable to load match file: " << matchFilename << " in: " << folder);
-      }
+      ALICEVISION_LOG_DEBUG("Unable to load match file: " << matchFilename << " in: " << folder);
       continue;
     }
-    #pragma omp critical
+    loaded[i] = 1;
+  }
+
+  // merge the loaded matches into the output
+  for(std::size_t i = 0; i < views.size(); ++i)
+  {
+    if(!loaded[i])
+      continue;
+    ++nbLoadedMatchFiles;
+    for(auto& v: filesMatches[i])
     {
-      ++nbLoadedMatchFiles;
-      // merge the loaded matches into the output
-      for(const auto& v: fileMatches)
-      {
-        matches[v.first] = v.second;
-      }
+      matches[v.first] = std::move(v.second);
     }
+    PairwiseMatches().swap(filesMatches[i]);
   }
   return nbLoadedMatchFiles;
 }
 
 /**
- * Load and add pair-wise matches to \p matches from all files in \p folder matching \p pattern.
+ * Load and add pair-wise matches to \p matches from all files in \p folder matching one of the \p patterns.
  * @param[out] matches PairwiseMatches to add loaded matches to
  * @param[in] folder Folder to load matches files from
- * @param[in] pattern Pattern that files must respect to be loaded
+ * @param[in] patterns Patterns that files must respect to be loaded (end of the filename)
+ * @param[in] viewsKeysFilter if not empty, only load the pairs of these views
  */
-std::size_t loadMatchesFromFolder(PairwiseMatches& matches, const std::string& folder, const std::string& pattern)
+std::size_t loadMatchesFromFolder(PairwiseMatches& matches,
+                                  const std::string& folder,
+                                  const std::vector<std::string>& patterns,
+                                  const std::set<IndexT>& viewsKeysFilter)
 {
   std::size_t nbLoadedMatchFiles = 0;
   std::vector<std::string> matchFiles;
-  // list all matches files in 'folder' matching (i.e containing) 'pattern'
+  // list all matches files in 'folder' matching (i.e ending with) one of the 'patterns'
   for(const auto& entry : boost::make_iterator_range(fs::directory_iterator(folder), {}))
   {
-    if(entry.path().string().find(pattern) != std::string::npos)
+    const std::string filename = entry.path().filename().string();
+    for(const std::string& pattern : patterns)
     {
-      matchFiles.push_back(entry.path().string());
+      if(filename.size() >= pattern.size() && filename.compare(filename.size() - pattern.size(), pattern.size(), pattern) == 0)
+      {
+        matchFiles.push_back(entry.path().string());
+        break;
+      }
     }
   }
 
-  #pragma omp parallel for num_threads(3)
+  // each file is loaded in its own container, no lock is needed
+  std::vector<PairwiseMatches> filesMatches(matchFiles.size());
+  std::vector<char> loaded(matchFiles.size(), 0);
+
+  #pragma omp parallel for schedule(dynamic)
   for(int i = 0; i < matchFiles.size(); ++i)
   {
     const std::string& matchFile = matchFiles[i];
-    PairwiseMatches fileMatches;
     ALICEVISION_LOG_DEBUG("Loading match file: " << matchFile);
-    if(!LoadMatchFile(fileMatches, matchFile))
+    if(!LoadMatchFile(filesMatches[i], matchFile, viewsKeysFilter))
     {
       ALICEVISION_LOG_WARNING("Unable to load match file: " << matchFile);
       continue;
     }
-    #pragma omp critical
-    {
-    for(const auto& matchesPerView: fileMatches)
-    {
-      const Pair& pair = matchesPerView.first;
-      const MatchesPerDescType& pairMatches = matchesPerView.second;
-      for(const auto& matchesPerDescType : pairMatches)
-      {
-        const feature::EImageDescriberType& descType = matchesPerDescType.first;
-        const auto& pairMatches = matchesPerDescType.second;
-        // merge in global map
-        std::copy(
-          std::make_move_iterator(pairMatches.begin()), 
-          std::make_move_iterator(pairMatches.end()), 
-          std::back_inserter(matches[pair][descType])
-        );
-      }
-    }
+    loaded[i] = 1;
+  }
+
+  // merge in global map, matches are moved and each file container is released once merged
+  for(std::size_t i = 0; i < matchFiles.size(); ++i)
+  {
+    if(!loaded[i])
+      continue;
+    for(auto& matchesPerView: filesMatches[i])
+      appendPairMatches(matches, matchesPerView.first, std::move(matchesPerView.second));
+    PairwiseMatches().swap(filesMatches[i]);
     ++nbLoadedMatchFiles;
-    }   
   }
+
   if(!nbLoadedMatchFiles)
     ALICEVISION_LOG_WARNING("No matches file loaded in: " << folder);
   return nbLoadedMatchFiles;
@@ -230,7 +548,7 @@ bool Load(PairwiseMatches& matches,
           int minNbMatches)
 {
   std::size_t nbLoadedMatchFiles = 0;
-  const std::string pattern = "matches.txt";
+  const std::vector<std::string> patterns = {"matches.txt", "matches.bin"};
 
   // build up a set with normalized paths to remove duplicates
   std::set<std::string> foldersSet;
@@ -239,7 +557,7 @@ bool Load(PairwiseMatches& matches,
 
   for(const auto& folder : foldersSet)
   {
-    nbLoadedMatchFiles += loadMatchesFromFolder(matches, folder, pattern);
+    nbLoadedMatchFiles += loadMatchesFromFolder(matches, folder, patterns, viewsKeysFilter);
   }
 
   if(!nbLoadedMatchFiles)
@@ -283,8 +601,7 @@ private:
     const PairwiseMatches::const_iterator& matchBegin,
     const PairwiseMatches::const_iterator& matchEnd)
   {
-    const fs::path bPath = fs::path(filepath);
-    const std::string tmpPath = (bPath.parent_path() / bPath.stem()).string() + "." + fs::unique_path().string() + bPath.extension().string();
+    const std::string tmpPath = getTemporaryPath(filepath);
 
     // write temporary file
     {
@@ -293,16 +610,7 @@ private:
         match != matchEnd;
         ++match)
       {
-        const std::size_t I = match->first.first;
-        const std::size_t J = match->first.second;
-        const MatchesPerDescType & matchesPerDesc = match->second;
-        stream << I << " " << J << '\n'
-               << matchesPerDesc.size() << '\n';
-        for(const auto& m: matchesPerDesc)
-        {
-          stream << feature::EImageDescriberType_enumToString(m.first) << " " << m.second.size() << '\n';
-          copy(m.second.begin(), m.second.end(), std::ostream_iterator<IndMatch>(stream, "\n"));
-        }
+        writeTxtPairMatches(stream, match->first, match->second);
       }
     }
 
@@ -310,6 +618,75 @@ private:
     fs::rename(tmpPath, filepath);
   }
 
+  void saveBin(
+    const std::string& filepath,
+    const PairwiseMatches::const_iterator& matchBegin,
+    const PairwiseMatches::const_iterator& matchEnd)
+  {
+    const std::string tmpPath = getTemporaryPath(filepath);
+
+    // write temporary file
+    {
+      std::ofstream stream(tmpPath.c_str(), std::ios::out | std::ios::binary);
+      if(!stream.is_open())
+        throw std::runtime_error("Unable to create the match file: " + tmpPath);
+
+      BinaryMatchesHeader header;
+      std::memcpy(header.magic, BINARY_MATCHES_MAGIC, sizeof(header.magic));
+      header.version = BINARY_MATCHES_VERSION;
+      header.reserved = 0;
+      header.nbPairs = std::distance(matchBegin, matchEnd);
+
+      // the index table is written at the beginning of the file once the offsets are known
+      std::vector<BinaryMatchesReader::PairEntry> entries;
+      entries.reserve(header.nbPairs);
+      uint64_t offset = sizeof(header) + header.nbPairs * sizeof(BinaryMatchesReader::PairEntry);
+      stream.seekp(offset);
+
+      std::string buffer;
+      for(PairwiseMatches::const_iterator match = matchBegin;
+        match != matchEnd;
+        ++match)
+      {
+        buffer.clear();
+        encodePairMatches(match->second, buffer);
+        stream.write(buffer.data(), buffer.size());
+
+        BinaryMatchesReader::PairEntry entry;
+        entry.I = static_cast<uint32_t>(match->first.first);
+        entry.J = static_cast<uint32_t>(match->first.second);
+        entry.offset = offset;
+        entry.size = buffer.size();
+        entries.push_back(entry);
+        offset += buffer.size();
+      }
+
+      stream.seekp(0);
+      stream.write(reinterpret_cast<const char*>(&header), sizeof(header));
+      if(!entries.empty())
+        stream.write(reinterpret_cast<const char*>(entries.data()), entries.size() * sizeof(BinaryMatchesReader::PairEntry));
+
+      if(!stream.good())
+        throw std::runtime_error("Unable to write the match file: " + tmpPath);
+    }
+
+    // rename temporary file
+    fs::rename(tmpPath, filepath);
+  }
+
+  void save(
+    const std::string& filepath,
+    const PairwiseMatches::const_iterator& matchBegin,
+    const PairwiseMatches::const_iterator& matchEnd)
+  {
+    if(m_ext == ".txt")
+      saveTxt(filepath, matchBegin, matchEnd);
+    else if(m_ext == ".bin")
+      saveBin(filepath, matchBegin, matchEnd);
+    else
+      throw std::runtime_error(std::string("Unknown matching file format: ") + m_ext);
+  }
+
 public:
   MatchExporter(
     const PairwiseMatches& matches,
@@ -326,11 +703,7 @@ public:
   void saveGlobalFile()
   {
     const std::string filepath = (fs::path(m_directory) / m_filename).string();
-
-    if(m_ext == ".txt")
-      saveTxt(filepath, m_matches.begin(), m_matches.end());
-    else
-      throw std::runtime_error(std::string("Unknown matching file format: ") + m_ext);
+    save(filepath, m_matches.begin(), m_matches.end());
   }
 
   /// Export matches into separate files, one for each image.
@@ -351,11 +724,7 @@ public:
         ++match;
       const std::string filepath = (fs::path(m_directory) / (std::to_string(key) + "." + m_filename)).string();
       ALICEVISION_LOG_DEBUG("Export Matches in: " << filepath);
-      
-      if(m_ext == ".txt")
-        saveTxt(filepath, matchBegin, match);
-      else
-        throw std::runtime_error(std::string("Unknown matching file format: ") + m_ext);
+      save(filepath, matchBegin, match);
 
       matchBegin = match;
     }
@@ -385,5 +754,186 @@ bool Save(const PairwiseMatches& matches,
   return true;
 }
 
+/**
+ * @brief Write a single match file pair by pair.
+ *
+ * The matches are written in a temporary file, completed by finish and renamed by commit.
+ * The binary index table is only known once all the pairs are written,
+ * so the binary pair data is written in a separate temporary file and appended after the table on finish.
+ */
+class MatchFileWriter
+{
+public:
+  explicit MatchFileWriter(const std::string& filepath)
+    : _filepath(filepath)
+    , _tmpPath(getTemporaryPath(filepath))
+  {
+    const std::string ext = fs::path(filepath).extension().string();
+    if(ext != ".txt" && ext != ".bin")
+      throw std::runtime_error(std::string("Unknown matching file format: ") + ext);
+
+    _binary = (ext == ".bin");
+    _dataPath = _binary ? _tmpPath + ".data" : _tmpPath;
+    _stream.open(_dataPath, std::ios::out | (_binary ? std::ios::binary : std::ios::openmode()));
+    if(!_stream.is_open())
+      throw std::runtime_error("Unable to create the match file: " + _dataPath);
+  }
+
+  ~MatchFileWriter()
+  {
+    // the file has not been committed, remove the temporary files
+    if(!_committed)
+    {
+      _stream.close();
+      boost::system::error_code ec;
+      fs::remove(_dataPath, ec);
+      fs::remove(_tmpPath, ec);
+    }
+  }
+
+  void write(const Pair& pair, const MatchesPerDescType& matchesPerDesc)
+  {
+    if(!_binary)
+    {
+      writeTxtPairMatches(_stream, pair, matchesPerDesc);
+      return;
+    }
+
+    _buffer.clear();
+    encodePairMatches(matchesPerDesc, _buffer);
+    _stream.write(_buffer.data(), _buffer.size());
+
+    // offsets are relative to the pair data until the table size is known
+    BinaryMatchesReader::PairEntry entry;
+    entry.I = static_cast<uint32_t>(pair.first);
+    entry.J = static_cast<uint32_t>(pair.second);
+    entry.offset = _dataSize;
+    entry.size = _buffer.size();
+    _entries.push_back(entry);
+    _dataSize += _buffer.size();
+  }
+
+  /// Complete the temporary file, the pairs cannot be written anymore
+  void finish()
+  {
+    _stream.close();
+    if(_stream.fail())
+      throw std::runtime_error("Unable to write the match file: " + _dataPath);
+
+    if(_binary)
+    {
+      {
+        std::ofstream stream(_tmpPath.c_str(), std::ios::out | std::ios::binary);
+        if(!stream.is_open())
+          throw std::runtime_error("Unable to create the match file: " + _tmpPath);
+
+        BinaryMatchesHeader header;
+        std::memcpy(header.magic, BINARY_MATCHES_MAGIC, sizeof(header.magic));
+        header.version = BINARY_MATCHES_VERSION;
+        header.reserved = 0;
+        header.nbPairs = _entries.size();
+
+        const uint64_t dataOffset = sizeof(header) + header.nbPairs * sizeof(BinaryMatchesReader::PairEntry);
+        for(BinaryMatchesReader::PairEntry& entry : _entries)
+          entry.offset += dataOffset;
+
+        stream.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        if(!_entries.empty())
+        {
+          stream.write(reinterpret_cast<const char*>(_entries.data()), _entries.size() * sizeof(BinaryMatchesReader::PairEntry));
+
+          std::ifstream dataStream(_dataPath.c_str(), std::ios::in | std::ios::binary);
+          stream << dataStream.rdbuf();
+        }
+
+        if(!stream.good())
+          throw std::runtime_error("Unable to write the match file: " + _tmpPath);
+      }
+      fs::remove(_dataPath);
+      _entries.clear();
+      _entries.shrink_to_fit();
+    }
+  }
+
+  /// Rename the temporary file
+  void commit()
+  {
+    fs::rename(_tmpPath, _filepath);
+    _committed = true;
+  }
+
+private:
+  std::string _filepath;
+  std::string _tmpPath;
+  std::string _dataPath;
+  bool _binary = false;
+  bool _committed = false;
+  std::ofstream _stream;
+  std::vector<BinaryMatchesReader::PairEntry> _entries;
+  uint64_t _dataSize = 0;
+  std::string _buffer;
+};
+
+MatchesWriter::MatchesWriter(const std::string& folder,
+                             const std::string& extension,
+                             bool matchFilePerImage,
+                             const std::string& prefix)
+  : _folder(folder)
+  , _filename(prefix + "matches." + extension)
+  , _matchFilePerImage(matchFilePerImage)
+{
+  if(!_matchFilePerImage)
+    _file.reset(new MatchFileWriter((fs::path(_folder) / _filename).string()));
+}
+
+MatchesWriter::~MatchesWriter() = default;
+
+void MatchesWriter::write(const Pair& pair, const MatchesPerDescType& matchesPerDesc)
+{
+  if(_closed)
+    throw std::logic_error("The match files are already closed.");
+
+  if(_matchFilePerImage && (!_file || pair.first != _currentViewId))
+  {
+    if(_file)
+    {
+      // renamed with the others on close, so that no match file is left if the matching fails
+      _file->finish();
+      _finishedFiles.push_back(std::move(_file));
+    }
+    if(!_writtenViewIds.insert(pair.first).second)
+      throw std::logic_error("The matches of the view " + std::to_string(pair.first) + " are not contiguous, its match file is already written.");
+
+    _currentViewId = pair.first;
+    const std::string filepath = (fs::path(_folder) / (std::to_string(pair.first) + "." + _filename)).string();
+    ALICEVISION_LOG_DEBUG("Export Matches in: " << filepath);
+    _file.reset(new MatchFileWriter(filepath));
+  }
+
+  _file->write(pair, matchesPerDesc);
+}
+
+void MatchesWriter::write(const PairwiseMatches& matches)
+{
+  for(const auto& pairMatches : matches)
+    write(pairMatches.first, pairMatches.second);
+}
+
+void MatchesWriter::close()
+{
+  if(_closed)
+    return;
+  _closed = true;
+
+  if(_file)
+  {
+    _file->finish();
+    _finishedFiles.push_back(std::move(_file));
+  }
+  for(std::unique_ptr<MatchFileWriter>& file : _finishedFiles)
+    file->commit();
+  _finishedFiles.clear();
+}
+
 }  // namespace matching
 }  // namespace aliceVision
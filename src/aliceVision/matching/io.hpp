@@ -9,19 +9,76 @@
 
 #include <aliceVision/matching/IndMatch.hpp>
 
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <set>
 #include <string>
+#include <vector>
 
 namespace aliceVision {
 namespace matching {
 
 
 /**
- * @brief Load a match file.
+ * @brief Streaming reader of a binary match file (*.bin).
+ *
+ * The file starts with an index table of the image pairs, so the matches of each pair
+ * can be read independently without loading the whole file.
+ * Feature indices are delta-encoded with variable length integers.
+ * A copy of a reader shares the index table and opens its own stream,
+ * so each thread can read different pairs of the same file.
+ */
+class BinaryMatchesReader
+{
+public:
+  /**
+   * @brief Open a binary match file and read its index table.
+   * @param[in] filepath the match file to read
+   * @throws std::runtime_error if the file cannot be opened or is not a valid binary match file
+   */
+  explicit BinaryMatchesReader(const std::string& filepath);
+
+  BinaryMatchesReader(const BinaryMatchesReader& other);
+
+  /// Return the number of image pairs in the file
+  std::size_t getNbPairs() const { return _entries->size(); }
+
+  /// Return the image pair at the given index of the table
+  Pair getPair(std::size_t index) const;
+
+  /**
+   * @brief Read the matches of the image pair at the given index of the table.
+   * @param[in] index the index of the pair in the table
+   * @param[out] matches the matches of the pair for each describer type
+   * @throws std::runtime_error if the data is corrupted
+   */
+  void readMatches(std::size_t index, MatchesPerDescType& matches);
+
+  /// Entry of the index table, stored as is in the file
+  struct PairEntry
+  {
+    uint32_t I;
+    uint32_t J;
+    uint64_t offset;
+    uint64_t size;
+  };
+
+private:
+  std::string _filepath;
+  std::ifstream _stream;
+  std::shared_ptr<const std::vector<PairEntry>> _entries;
+  std::vector<char> _buffer;
+};
+
+/**
+ * @brief Load a match file (text *.txt or binary *.bin).
  *
  * @param[out] matches container for the output matches
  * @param[in] filepath the match file to load
+ * @param[in] viewsKeysFilter if not empty, only load the pairs of these views
  */
-bool LoadMatchFile(PairwiseMatches& matches, const std::string& filepath);
+bool LoadMatchFile(PairwiseMatches& matches, const std::string& filepath, const std::set<IndexT>& viewsKeysFilter = std::set<IndexT>());
 
 /**
  * @brief Load the match file for each image.
@@ -88,5 +145,61 @@ bool Save(const PairwiseMatches& matches,
           bool matchFilePerImage,
           const std::string& prefix = "");
 
+class MatchFileWriter;
+
+/**
+ * @brief Streaming writer of match files (text *.txt or binary *.bin).
+ *
+ * The matches are written pair by pair as they are computed, so they do not need to be kept in memory.
+ * The files are identical to the ones written by Save and are only visible once closed.
+ * With one match file per image, the pairs of a view must be written contiguously
+ * (e.g. in increasing order, as in PairwiseMatches).
+ */
+class MatchesWriter
+{
+public:
+  /**
+   * @brief Create the global match file or prepare the match files per image.
+   * @param[in] folder folder containing the match files
+   * @param[in] extension txt or bin file format
+   * @param[in] matchFilePerImage do we store a global match file or one match file per image
+   * @param[in] prefix optional prefix for the output file(s)
+   * @throws std::runtime_error if the match file cannot be created
+   */
+  MatchesWriter(const std::string& folder,
+                const std::string& extension,
+                bool matchFilePerImage,
+                const std::string& prefix = "");
+
+  /// Remove the temporary files if the writer is not closed
+  ~MatchesWriter();
+
+  /**
+   * @brief Write the matches of an image pair.
+   * @throws std::logic_error if the matches of a view are not contiguous with one match file per image
+   */
+  void write(const Pair& pair, const MatchesPerDescType& matchesPerDesc);
+
+  /// Write the matches of all the image pairs
+  void write(const PairwiseMatches& matches);
+
+  /**
+   * @brief Finalize and rename all the match files, none of them is visible before.
+   * @throws std::runtime_error if a match file cannot be written
+   */
+  void close();
+
+private:
+  std::string _folder;
+  std::string _filename;
+  bool _matchFilePerImage;
+  bool _closed = false;
+  IndexT _currentViewId = UndefinedIndexT;
+  std::set<IndexT> _writtenViewIds;
+  std::unique_ptr<MatchFileWriter> _file;
+  /// match files per image already written, renamed on close
+  std::vector<std::unique_ptr<MatchFileWriter>> _finishedFiles;
+};
+
 }  // namespace matching
 }  // namespace aliceVision
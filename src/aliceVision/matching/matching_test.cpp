@@ -9,7 +9,11 @@
 #include "aliceVision/matching/ArrayMatcher_bruteForce.hpp"
 #include "aliceVision/matching/ArrayMatcher_kdtreeFlann.hpp"
 #include "aliceVision/matching/ArrayMatcher_cascadeHashing.hpp"
+#include <boost/filesystem.hpp>
+
+#include <algorithm>
 #include <iostream>
+#include <random>
 
 #define BOOST_TEST_MODULE matching
 
@@ -83,6 +87,46 @@ BOOST_AUTO_TEST_CASE(Matching_ArrayMatcher_bruteForce_Simple_Dim4)
   BOOST_CHECK_SMALL(static_cast<double>(fDistance), 1e-8); //distance
 }
 
+BOOST_AUTO_TEST_CASE(Matching_ArrayMatcher_bruteForce_MatrixProduct)
+{
+  // several tiles of queries and dataset rows
+  const int nbRows = 2500;
+  const int nbQuery = 600;
+  const int dimension = 128;
+  const size_t NN = 2;
+
+  std::mt19937 gen(42);
+  std::uniform_real_distribution<float> dist(0.f, 1.f);
+  std::vector<float> array(nbRows * dimension);
+  std::vector<float> query(nbQuery * dimension);
+  for(float& v : array) v = dist(gen);
+  for(float& v : query) v = dist(gen);
+
+  ArrayMatcher_bruteForce<float, L2_Vectorized<float> > matcher;
+  BOOST_CHECK( matcher.Build(&array[0], nbRows, dimension) );
+
+  IndMatches vec_nIndice;
+  vector<float> vec_fDistance;
+  BOOST_CHECK( matcher.SearchNeighbours(&query[0], nbQuery, &vec_nIndice, &vec_fDistance, NN) );
+  BOOST_CHECK_EQUAL( nbQuery * NN, vec_nIndice.size());
+
+  // compare with an exhaustive search
+  L2_Simple<float> metric;
+  for(int q = 0; q < nbQuery; ++q)
+  {
+    std::vector<std::pair<float, int> > distances(nbRows);
+    for(int i = 0; i < nbRows; ++i)
+      distances[i] = std::make_pair(metric(&query[q * dimension], &array[i * dimension], dimension), i);
+    std::partial_sort(distances.begin(), distances.begin() + NN, distances.end());
+
+    for(size_t k = 0; k < NN; ++k)
+    {
+      BOOST_CHECK_EQUAL(IndMatch(q, distances[k].second), vec_nIndice[q * NN + k]);
+      BOOST_CHECK_CLOSE(distances[k].first, vec_fDistance[q * NN + k], 1e-3);
+    }
+  }
+}
+
 BOOST_AUTO_TEST_CASE(Matching_ArrayMatcher_kdtreeFlann_Simple__NN)
 {
   const float array[] = {0, 1, 2, 5, 6};
@@ -149,3 +193,52 @@ BOOST_AUTO_TEST_CASE(Matching_Cascade_Hashing_Simple_EmptyArrays)
   float fDistance = -1.0f;
   BOOST_CHECK(! matcher.SearchNeighbour( &array[0], &nIndice, &fDistance) );
 }
+
+BOOST_AUTO_TEST_CASE(Matching_Cascade_Hashing_SaveLoad)
+{
+  const int nbDescriptions = 200;
+  const int dimension = 128;
+
+  std::mt19937 gen(42);
+  std::uniform_real_distribution<float> dist(0.f, 255.f);
+  Eigen::MatrixXf descriptions(nbDescriptions, dimension);
+  for(int i = 0; i < nbDescriptions; ++i)
+    for(int j = 0; j < dimension; ++j)
+      descriptions(i, j) = dist(gen);
+
+  CascadeHasher hasher;
+  hasher.Init(dimension, 6, 10, 0);
+  const Eigen::VectorXf zeroMean = CascadeHasher::GetZeroMeanDescriptor(descriptions);
+  const HashedDescriptions hashed = hasher.CreateHashedDescriptions(descriptions, zeroMean);
+
+  const std::string filepath = (boost::filesystem::temp_directory_path() / boost::filesystem::unique_path("%%%%%%%%.chash")).string();
+  BOOST_CHECK(hasher.SaveHashedDescriptions(filepath, hashed, zeroMean));
+
+  // same seed: the hashed descriptions can be reused
+  {
+    CascadeHasher otherHasher;
+    otherHasher.Init(dimension, 6, 10, 0);
+    HashedDescriptions loaded;
+    BOOST_CHECK(otherHasher.LoadHashedDescriptions(filepath, zeroMean, nbDescriptions, loaded));
+    BOOST_CHECK(loaded.buckets == hashed.buckets);
+    BOOST_REQUIRE_EQUAL(hashed.hashed_desc.size(), loaded.hashed_desc.size());
+    for(int i = 0; i < nbDescriptions; ++i)
+    {
+      BOOST_CHECK(hashed.hashed_desc[i].bucket_ids == loaded.hashed_desc[i].bucket_ids);
+      for(int j = 0; j < dimension; ++j)
+        BOOST_CHECK_EQUAL(hashed.hashed_desc[i].hash_code[j], loaded.hashed_desc[i].hash_code[j]);
+    }
+  }
+
+  // other seed, zero mean or number of descriptions: the file is rejected
+  {
+    CascadeHasher otherHasher;
+    otherHasher.Init(dimension, 6, 10, 1);
+    HashedDescriptions loaded;
+    BOOST_CHECK(!otherHasher.LoadHashedDescriptions(filepath, zeroMean, nbDescriptions, loaded));
+    BOOST_CHECK(!hasher.LoadHashedDescriptions(filepath, zeroMean * 2.f, nbDescriptions, loaded));
+    BOOST_CHECK(!hasher.LoadHashedDescriptions(filepath, zeroMean, nbDescriptions + 1, loaded));
+  }
+
+  boost::filesystem::remove(filepath);
+}
@@ -0,0 +1,444 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2020 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#pragma once
+
+#include <aliceVision/system/cpu.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+// Brief:
+// SIMD kernels for the distances between descriptors (squared L2 on unsigned char and float,
+// Hamming on raw memory). The best kernel supported by the CPU is selected at runtime, so
+// the binaries do not need to be compiled with -mavx2 / -mavx512f.
+// Kernels are header-only as the metrics are used by both the feature and matching modules.
+
+#if (defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)) && \
+    (defined(__clang__) || (defined(__GNUC__) && __GNUC__ >= 8) || (defined(_MSC_VER) && _MSC_VER >= 1920))
+#define ALICEVISION_METRIC_KERNELS_X86
+#include <immintrin.h>
+#endif
+
+#ifdef ALICEVISION_METRIC_KERNELS_X86
+#if defined(_MSC_VER) && !defined(__clang__)
+#define ALICEVISION_KERNEL_TARGET(isa)
+#else
+// allow the use of the instruction set in this function only, the caller is responsible for the CPU check
+#define ALICEVISION_KERNEL_TARGET(isa) __attribute__((target(isa)))
+#endif
+#endif
+
+namespace aliceVision {
+namespace matching {
+namespace kernels {
+
+/**
+ * @brief Instruction set used by a distance kernel
+ */
+enum class EMetricKernel
+{
+  SCALAR = 0,
+  AVX2,
+  AVX512
+};
+
+inline std::string EMetricKernel_enumToString(EMetricKernel kernel)
+{
+  switch(kernel)
+  {
+    case EMetricKernel::SCALAR: return "scalar";
+    case EMetricKernel::AVX2:   return "avx2";
+    case EMetricKernel::AVX512: return "avx512";
+  }
+  throw std::out_of_range("Invalid EMetricKernel enum");
+}
+
+inline EMetricKernel EMetricKernel_stringToEnum(const std::string& kernel)
+{
+  std::string type = kernel;
+  std::transform(type.begin(), type.end(), type.begin(), ::tolower); //tolower
+
+  if(type == "scalar") return EMetricKernel::SCALAR;
+  if(type == "avx2")   return EMetricKernel::AVX2;
+  if(type == "avx512") return EMetricKernel::AVX512;
+  throw std::out_of_range("Invalid metric kernel: " + kernel);
+}
+
+inline std::ostream& operator<<(std::ostream& os, const EMetricKernel kernel)
+{
+  os << EMetricKernel_enumToString(kernel);
+  return os;
+}
+
+inline std::istream& operator>>(std::istream& in, EMetricKernel& kernel)
+{
+  std::string token;
+  in >> token;
+  kernel = EMetricKernel_stringToEnum(token);
+  return in;
+}
+
+/// Squared L2 distance between unsigned char descriptors
+typedef float (*L2Uint8Kernel)(const unsigned char* a, const unsigned char* b, std::size_t size);
+/// Squared L2 distance between float descriptors
+typedef float (*L2FloatKernel)(const float* a, const float* b, std::size_t size);
+/// Hamming distance between binary descriptors, size in bytes
+typedef unsigned int (*HammingKernel)(const unsigned char* a, const unsigned char* b, std::size_t size);
+
+// Scalar kernels
+
+inline float l2Uint8Scalar(const unsigned char* a, const unsigned char* b, std::size_t size)
+{
+  int result = 0;
+  for(std::size_t i = 0; i < size; ++i)
+  {
+    const int diff = int(a[i]) - int(b[i]);
+    result += diff * diff;
+  }
+  return static_cast<float>(result);
+}
+
+inline float l2FloatScalar(const float* a, const float* b, std::size_t size)
+{
+  float result = 0.f;
+  std::size_t i = 0;
+  // process 4 items with each loop for efficiency
+  for(; i + 4 <= size; i += 4)
+  {
+    const float diff0 = a[i] - b[i];
+    const float diff1 = a[i+1] - b[i+1];
+    const float diff2 = a[i+2] - b[i+2];
+    const float diff3 = a[i+3] - b[i+3];
+    result += diff0 * diff0 + diff1 * diff1 + diff2 * diff2 + diff3 * diff3;
+  }
+  for(; i < size; ++i)
+  {
+    const float diff = a[i] - b[i];
+    result += diff * diff;
+  }
+  return result;
+}
+
+inline unsigned int popcount64(std::uint64_t n)
+{
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_ARM64))
+  return static_cast<unsigned int>(__popcnt64(n));
+#elif defined(__GNUC__) || defined(__clang__)
+  return static_cast<unsigned int>(__builtin_popcountll(n));
+#else
+  n -= ((n >> 1) & 0x5555555555555555ULL);
+  n = (n & 0x3333333333333333ULL) + ((n >> 2) & 0x3333333333333333ULL);
+  return static_cast<unsigned int>((((n + (n >> 4)) & 0x0f0f0f0f0f0f0f0fULL) * 0x0101010101010101ULL) >> 56);
+#endif
+}
+
+/// Popcount of the last (size % 8) bytes, starting at the given index
+inline unsigned int hammingTail(const unsigned char* a, const unsigned char* b, std::size_t i, std::size_t size)
+{
+  unsigned int result = 0;
+  for(; i < size; ++i)
+    result += popcount64(a[i] ^ b[i]);
+  return result;
+}
+
+inline unsigned int hammingScalar(const unsigned char* a, const unsigned char* b, std::size_t size)
+{
+  unsigned int result = 0;
+  std::size_t i = 0;
+  for(; i + sizeof(std::uint64_t) <= size; i += sizeof(std::uint64_t))
+  {
+    // memcpy avoids unaligned accesses, it is optimized out by the compiler
+    std::uint64_t va, vb;
+    std::memcpy(&va, a + i, sizeof(va));
+    std::memcpy(&vb, b + i, sizeof(vb));
+    result += popcount64(va ^ vb);
+  }
+  return result + hammingTail(a, b, i, size);
+}
+
+#ifdef ALICEVISION_METRIC_KERNELS_X86
+
+// AVX2 kernels
+
+ALICEVISION_KERNEL_TARGET("avx2")
+inline int hsumEpi32Avx2(__m256i v)
+{
+  __m128i sum = _mm_add_epi32(_mm256_castsi256_si128(v), _mm256_extracti128_si256(v, 1));
+  sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, _MM_SHUFFLE(1, 0, 3, 2)));
+  sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, _MM_SHUFFLE(2, 3, 0, 1)));
+  return _mm_cvtsi128_si32(sum);
+}
+
+ALICEVISION_KERNEL_TARGET("avx2")
+inline float l2Uint8Avx2(const unsigned char* a, const unsigned char* b, std::size_t size)
+{
+  __m256i acc = _mm256_setzero_si256();
+  std::size_t i = 0;
+  for(; i + 16 <= size; i += 16)
+  {
+    // widen to 16 bits, the squared differences are summed by pairs in 32 bits
+    const __m256i va = _mm256_cvtepu8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(a + i)));
+    const __m256i vb = _mm256_cvtepu8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(b + i)));
+    const __m256i diff = _mm256_sub_epi16(va, vb);
+    acc = _mm256_add_epi32(acc, _mm256_madd_epi16(diff, diff));
+  }
+  int result = hsumEpi32Avx2(acc);
+  for(; i < size; ++i)
+  {
+    const int diff = int(a[i]) - int(b[i]);
+    result += diff * diff;
+  }
+  return static_cast<float>(result);
+}
+
+ALICEVISION_KERNEL_TARGET("avx2,fma")
+inline float l2FloatAvx2(const float* a, const float* b, std::size_t size)
+{
+  // two accumulators to hide the latency of the fused multiply-add
+  __m256 acc0 = _mm256_setzero_ps();
+  __m256 acc1 = _mm256_setzero_ps();
+  std::size_t i = 0;
+  for(; i + 16 <= size; i += 16)
+  {
+    const __m256 diff0 = _mm256_sub_ps(_mm256_loadu_ps(a + i), _mm256_loadu_ps(b + i));
+    const __m256 diff1 = _mm256_sub_ps(_mm256_loadu_ps(a + i + 8), _mm256_loadu_ps(b + i + 8));
+    acc0 = _mm256_fmadd_ps(diff0, diff0, acc0);
+    acc1 = _mm256_fmadd_ps(diff1, diff1, acc1);
+  }
+  if(i + 8 <= size)
+  {
+    const __m256 diff = _mm256_sub_ps(_mm256_loadu_ps(a + i), _mm256_loadu_ps(b + i));
+    acc0 = _mm256_fmadd_ps(diff, diff, acc0);
+    i += 8;
+  }
+  acc0 = _mm256_add_ps(acc0, acc1);
+  __m128 sum = _mm_add_ps(_mm256_castps256_ps128(acc0), _mm256_extractf128_ps(acc0, 1));
+  sum = _mm_add_ps(sum, _mm_movehl_ps(sum, sum));
+  sum = _mm_add_ss(sum, _mm_shuffle_ps(sum, sum, 1));
+  float result = _mm_cvtss_f32(sum);
+  for(; i < size; ++i)
+  {
+    const float diff = a[i] - b[i];
+    result += diff * diff;
+  }
+  return result;
+}
+
+ALICEVISION_KERNEL_TARGET("avx2")
+inline unsigned int hammingAvx2(const unsigned char* a, const unsigned char* b, std::size_t size)
+{
+  // popcount of each nibble with a shuffle lookup table, bytes are summed with sad
+  const __m256i lut = _mm256_setr_epi8(0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4,
+                                       0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4);
+  const __m256i lowMask = _mm256_set1_epi8(0x0f);
+  const __m256i zero = _mm256_setzero_si256();
+  __m256i acc = _mm256_setzero_si256();
+  std::size_t i = 0;
+  for(; i + 32 <= size; i += 32)
+  {
+    const __m256i x = _mm256_xor_si256(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + i)),
+                                       _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + i)));
+    const __m256i lo = _mm256_and_si256(x, lowMask);
+    const __m256i hi = _mm256_and_si256(_mm256_srli_epi16(x, 4), lowMask);
+    const __m256i count = _mm256_add_epi8(_mm256_shuffle_epi8(lut, lo), _mm256_shuffle_epi8(lut, hi));
+    acc = _mm256_add_epi64(acc, _mm256_sad_epu8(count, zero));
+  }
+  std::uint64_t lanes[4];
+  _mm256_storeu_si256(reinterpret_cast<__m256i*>(lanes), acc);
+  const std::uint64_t result = lanes[0] + lanes[1] + lanes[2] + lanes[3];
+  return static_cast<unsigned int>(result) + hammingScalar(a + i, b + i, size - i);
+}
+
+// AVX-512 kernels
+
+ALICEVISION_KERNEL_TARGET("avx512f,avx512bw")
+inline float l2Uint8Avx512(const unsigned char* a, const unsigned char* b, std::size_t size)
+{
+  __m512i acc = _mm512_setzero_si512();
+  std::size_t i = 0;
+  for(; i + 32 <= size; i += 32)
+  {
+    const __m512i va = _mm512_cvtepu8_epi16(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + i)));
+    const __m512i vb = _mm512_cvtepu8_epi16(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + i)));
+    const __m512i diff = _mm512_sub_epi16(va, vb);
+    acc = _mm512_add_epi32(acc, _mm512_madd_epi16(diff, diff));
+  }
+  int result = _mm512_reduce_add_epi32(acc);
+  for(; i < size; ++i)
+  {
+    const int diff = int(a[i]) - int(b[i]);
+    result += diff * diff;
+  }
+  return static_cast<float>(result);
+}
+
+ALICEVISION_KERNEL_TARGET("avx512f,avx512bw,avx512vnni")
+inline float l2Uint8Avx512Vnni(const unsigned char* a, const unsigned char* b, std::size_t size)
+{
+  __m512i acc = _mm512_setzero_si512();
+  std::size_t i = 0;
+  for(; i + 32 <= size; i += 32)
+  {
+    const __m512i va = _mm512_cvtepu8_epi16(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + i)));
+    const __m512i vb = _mm512_cvtepu8_epi16(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + i)));
+    const __m512i diff = _mm512_sub_epi16(va, vb);
+    // fused multiply and accumulate of the pairs of squared differences
+    acc = _mm512_dpwssd_epi32(acc, diff, diff);
+  }
+  int result = _mm512_reduce_add_epi32(acc);
+  for(; i < size; ++i)
+  {
+    const int diff = int(a[i]) - int(b[i]);
+    result += diff * diff;
+  }
+  return static_cast<float>(result);
+}
+
+ALICEVISION_KERNEL_TARGET("avx512f")
+inline float l2FloatAvx512(const float* a, const float* b, std::size_t size)
+{
+  __m512 acc0 = _mm512_setzero_ps();
+  __m512 acc1 = _mm512_setzero_ps();
+  std::size_t i = 0;
+  for(; i + 32 <= size; i += 32)
+  {
+    const __m512 diff0 = _mm512_sub_ps(_mm512_loadu_ps(a + i), _mm512_loadu_ps(b + i));
+    const __m512 diff1 = _mm512_sub_ps(_mm512_loadu_ps(a + i + 16), _mm512_loadu_ps(b + i + 16));
+    acc0 = _mm512_fmadd_ps(diff0, diff0, acc0);
+    acc1 = _mm512_fmadd_ps(diff1, diff1, acc1);
+  }
+  for(; i < size; i += 16)
+  {
+    // masked loads for the last elements
+    const std::size_t remaining = std::min<std::size_t>(size - i, 16);
+    const __mmask16 mask = static_cast<__mmask16>((1u << remaining) - 1u);
+    const __m512 diff = _mm512_sub_ps(_mm512_maskz_loadu_ps(mask, a + i), _mm512_maskz_loadu_ps(mask, b + i));
+    acc0 = _mm512_fmadd_ps(diff, diff, acc0);
+  }
+  return _mm512_reduce_add_ps(_mm512_add_ps(acc0, acc1));
+}
+
+ALICEVISION_KERNEL_TARGET("avx512f,avx512vpopcntdq")
+inline unsigned int hammingAvx512(const unsigned char* a, const unsigned char* b, std::size_t size)
+{
+  __m512i acc = _mm512_setzero_si512();
+  std::size_t i = 0;
+  for(; i + 64 <= size; i += 64)
+  {
+    const __m512i x = _mm512_xor_si512(_mm512_loadu_si512(a + i), _mm512_loadu_si512(b + i));
+    acc = _mm512_add_epi64(acc, _mm512_popcnt_epi64(x));
+  }
+  const std::size_t nbWords = (size - i) / sizeof(std::uint64_t);
+  if(nbWords > 0)
+  {
+    // masked loads of the remaining 64 bits words (e.g. 32 bytes ORB descriptors)
+    const __mmask8 mask = static_cast<__mmask8>((1u << nbWords) - 1u);
+    const __m512i x = _mm512_xor_si512(_mm512_maskz_loadu_epi64(mask, a + i), _mm512_maskz_loadu_epi64(mask, b + i));
+    acc = _mm512_add_epi64(acc, _mm512_popcnt_epi64(x));
+    i += nbWords * sizeof(std::uint64_t);
+  }
+  const unsigned int result = static_cast<unsigned int>(_mm512_reduce_add_epi64(acc));
+  return result + hammingTail(a, b, i, size);
+}
+
+#endif // ALICEVISION_METRIC_KERNELS_X86
+
+// Runtime dispatch
+
+/**
+ * @brief Get the squared L2 kernel for unsigned char descriptors using the given instruction set.
+ * @param[in] kernel The instruction set
+ * @return the kernel or nullptr if not supported by the CPU
+ */
+inline L2Uint8Kernel getL2Uint8Kernel(EMetricKernel kernel)
+{
+#ifdef ALICEVISION_METRIC_KERNELS_X86
+  const system::CpuFeatures& cpu = system::get_cpu_features();
+  if(kernel == EMetricKernel::AVX512 && cpu.avx512bw)
+    return cpu.avx512vnni ? &l2Uint8Avx512Vnni : &l2Uint8Avx512;
+  if(kernel == EMetricKernel::AVX2 && cpu.avx2)
+    return &l2Uint8Avx2;
+#endif
+  return (kernel == EMetricKernel::SCALAR) ? &l2Uint8Scalar : nullptr;
+}
+
+/**
+ * @brief Get the squared L2 kernel for float descriptors using the given instruction set.
+ * @param[in] kernel The instruction set
+ * @return the kernel or nullptr if not supported by the CPU
+ */
+inline L2FloatKernel getL2FloatKernel(EMetricKernel kernel)
+{
+#ifdef ALICEVISION_METRIC_KERNELS_X86
+  const system::CpuFeatures& cpu = system::get_cpu_features();
+  if(kernel == EMetricKernel::AVX512 && cpu.avx512f)
+    return &l2FloatAvx512;
+  if(kernel == EMetricKernel::AVX2 && cpu.avx2 && cpu.fma)
+    return &l2FloatAvx2;
+#endif
+  return (kernel == EMetricKernel::SCALAR) ? &l2FloatScalar : nullptr;
+}
+
+/**
+ * @brief Get the Hamming kernel using the given instruction set.
+ * @param[in] kernel The instruction set
+ * @return the kernel or nullptr if not supported by the CPU
+ */
+inline HammingKernel getHammingKernel(EMetricKernel kernel)
+{
+#ifdef ALICEVISION_METRIC_KERNELS_X86
+  const system::CpuFeatures& cpu = system::get_cpu_features();
+  if(kernel == EMetricKernel::AVX512 && cpu.avx512vpopcntdq)
+    return &hammingAvx512;
+  if(kernel == EMetricKernel::AVX2 && cpu.avx2)
+    return &hammingAvx2;
+#endif
+  return (kernel == EMetricKernel::SCALAR) ? &hammingScalar : nullptr;
+}
+
+/// Return the first kernel supported by the CPU, from the widest instruction set
+template<typename KernelT>
+inline KernelT getBestKernel(KernelT (*getKernel)(EMetricKernel))
+{
+  for(EMetricKernel kernel : {EMetricKernel::AVX512, EMetricKernel::AVX2})
+  {
+    if(KernelT k = getKernel(kernel))
+      return k;
+  }
+  return getKernel(EMetricKernel::SCALAR);
+}
+
+inline float l2Uint8(const unsigned char* a, const unsigned char* b, std::size_t size)
+{
+  static const L2Uint8Kernel kernel = getBestKernel(&getL2Uint8Kernel);
+  return kernel(a, b, size);
+}
+
+inline float l2Float(const float* a, const float* b, std::size_t size)
+{
+  static const L2FloatKernel kernel = getBestKernel(&getL2FloatKernel);
+  return kernel(a, b, size);
+}
+
+inline unsigned int hamming(const unsigned char* a, const unsigned char* b, std::size_t size)
+{
+  static const HammingKernel kernel = getBestKernel(&getHammingKernel);
+  return kernel(a, b, size);
+}
+
+} // namespace kernels
+} // namespace matching
+} // namespace aliceVision
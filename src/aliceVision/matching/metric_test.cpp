@@ -6,8 +6,11 @@
 // You can obtain one at https://mozilla.org/MPL/2.0/.
 
 #include "aliceVision/matching/metric.hpp"
+#include "aliceVision/matching/metricKernels.hpp"
 #include <iostream>
+#include <random>
 #include <string>
+#include <vector>
 
 #define BOOST_TEST_MODULE matchingMetric
 
@@ -134,3 +137,75 @@ BOOST_AUTO_TEST_CASE(Metric_HAMMING_BITSET_RAW_MEMORY_32BITS)
     }
   }
 }
+
+BOOST_AUTO_TEST_CASE(Metric_Kernels)
+{
+  using namespace kernels;
+
+  std::mt19937 gen(42);
+  std::uniform_int_distribution<int> distByte(0, 255);
+  std::uniform_real_distribution<float> distFloat(0.f, 1.f);
+
+  // extra elements to test unaligned accesses
+  const std::size_t maxSize = 300;
+  std::vector<unsigned char> bytesA(maxSize + 1), bytesB(maxSize + 1);
+  std::vector<float> floatsA(maxSize + 1), floatsB(maxSize + 1);
+  for(std::size_t i = 0; i <= maxSize; ++i)
+  {
+    bytesA[i] = static_cast<unsigned char>(distByte(gen));
+    bytesB[i] = static_cast<unsigned char>(distByte(gen));
+    floatsA[i] = distFloat(gen);
+    floatsB[i] = distFloat(gen);
+  }
+
+  // worst case for the integer accumulation
+  std::vector<unsigned char> zeros(maxSize, 0), ones(maxSize, 255);
+
+  for(EMetricKernel kernel : {EMetricKernel::SCALAR, EMetricKernel::AVX2, EMetricKernel::AVX512})
+  {
+    const L2Uint8Kernel l2Uint8Kernel = getL2Uint8Kernel(kernel);
+    const L2FloatKernel l2FloatKernel = getL2FloatKernel(kernel);
+    const HammingKernel hammingKernel = getHammingKernel(kernel);
+
+    BOOST_TEST_MESSAGE("Metric kernel " << kernel << ":"
+                       << " l2 uint8 " << (l2Uint8Kernel != nullptr)
+                       << ", l2 float " << (l2FloatKernel != nullptr)
+                       << ", hamming " << (hammingKernel != nullptr));
+
+    for(std::size_t size : {1, 7, 8, 16, 31, 32, 64, 100, 128, 256, 300})
+    {
+      for(std::size_t offset : {0, 1})
+      {
+        if(size + offset > maxSize + 1)
+          continue;
+
+        const unsigned char* a = bytesA.data() + offset;
+        const unsigned char* b = bytesB.data() + offset;
+        const float* fa = floatsA.data() + offset;
+        const float* fb = floatsB.data() + offset;
+
+        if(l2Uint8Kernel)
+        {
+          BOOST_CHECK_EQUAL(L2_Simple<unsigned char>()(a, b, size), l2Uint8Kernel(a, b, size));
+          BOOST_CHECK_EQUAL(float(size * 255 * 255), l2Uint8Kernel(zeros.data(), ones.data(), size));
+        }
+        if(l2FloatKernel)
+        {
+          BOOST_CHECK_CLOSE(L2_Simple<float>()(fa, fb, size), l2FloatKernel(fa, fb, size), 1e-3);
+        }
+        if(hammingKernel)
+        {
+          unsigned int expected = 0;
+          for(std::size_t i = 0; i < size; ++i)
+            expected += std::bitset<8>(a[i] ^ b[i]).count();
+          BOOST_CHECK_EQUAL(expected, hammingKernel(a, b, size));
+        }
+      }
+    }
+  }
+
+  // the scalar kernels are always available
+  BOOST_CHECK(getL2Uint8Kernel(EMetricKernel::SCALAR) != nullptr);
+  BOOST_CHECK(getL2FloatKernel(EMetricKernel::SCALAR) != nullptr);
+  BOOST_CHECK(getHammingKernel(EMetricKernel::SCALAR) != nullptr);
+}
@@ -10,15 +10,21 @@
 #include "dependencies/vectorGraphics/svgDrawer.hpp"
 #include "aliceVision/matching/IndMatch.hpp"
 
+#include <cstddef>
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <string>
+
 namespace aliceVision  {
 namespace matching {
 
-/// Display pair wises matches as an Adjacency matrix in svg format
+/// Display the number of matches of the image pairs as an Adjacency matrix in svg format
 inline void PairwiseMatchingToAdjacencyMatrixSVG(const size_t NbImages,
-  const matching::PairwiseMatches & map_Matches,
+  const std::map<Pair, std::size_t> & map_NbMatches,
   const std::string & sOutName)
 {
-  if ( !map_Matches.empty())
+  if ( !map_NbMatches.empty())
   {
     float scaleFactor = 5.0f;
     svg::svgDrawer svgStream((NbImages+3)*5, (NbImages+3)*5);
@@ -26,12 +32,12 @@ inline void PairwiseMatchingToAdjacencyMatrixSVG(const size_t NbImages,
     for (size_t I = 0; I < NbImages; ++I) {
       for (size_t J = 0; J < NbImages; ++J) {
         // If the pair have matches display a blue boxes at I,J position.
-        matching::PairwiseMatches::const_iterator iterSearch = map_Matches.find(std::make_pair(I,J));
-        if (iterSearch != map_Matches.end() && !iterSearch->second.empty())
+        std::map<Pair, std::size_t>::const_iterator iterSearch = map_NbMatches.find(std::make_pair(I,J));
+        if (iterSearch != map_NbMatches.end() && iterSearch->second > 0)
         {
           // Display as a tooltip: (IndexI, IndexJ NbMatches)
           std::ostringstream os;
-          os << "(" << J << "," << I << " " << iterSearch->second.getNbAllMatches() <<")";
+          os << "(" << J << "," << I << " " << iterSearch->second <<")";
           svgStream.drawSquare(J*scaleFactor, I*scaleFactor, scaleFactor/2.0f,
             svg::svgStyle().fill("blue").noStroke());
         } // HINT : THINK ABOUT OPACITY [0.4 -> 1.0] TO EXPRESS MATCH COUNT
@@ -59,5 +65,16 @@ inline void PairwiseMatchingToAdjacencyMatrixSVG(const size_t NbImages,
   }
 }
 
+/// Display pair wises matches as an Adjacency matrix in svg format
+inline void PairwiseMatchingToAdjacencyMatrixSVG(const size_t NbImages,
+  const matching::PairwiseMatches & map_Matches,
+  const std::string & sOutName)
+{
+  std::map<Pair, std::size_t> map_NbMatches;
+  for (const auto& matchesPerPair : map_Matches)
+    map_NbMatches.emplace_hint(map_NbMatches.end(), matchesPerPair.first, matchesPerPair.second.getNbAllMatches());
+  PairwiseMatchingToAdjacencyMatrixSVG(NbImages, map_NbMatches, sOutName);
+}
+
 } // namespace matching
 } // namespace aliceVision
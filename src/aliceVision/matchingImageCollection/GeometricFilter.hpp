@@ -12,6 +12,7 @@
 #include <aliceVision/feature/RegionsPerView.hpp>
 #include <aliceVision/matching/IndMatch.hpp>
 #include <aliceVision/matchingImageCollection/GeometricFilterMatrix.hpp>
+#include <aliceVision/stl/hash.hpp>
 
 #include <boost/progress.hpp>
 
@@ -28,6 +29,8 @@ using namespace aliceVision::matching;
  * or all the pairs and regions correspondences contained in the putativeMatches set.
  * Allow to keep only geometrically coherent matches.
  * It discards pairs that do not lead to a valid robust model estimation.
+ * With a fixed ACRANSAC random seed, each pair uses its own seed derived from it and from the view ids,
+ * so the result of a pair does not depend on the other pairs.
  * @param[out] geometricMatches
  * @param[in] sfmData
  * @param[in] regionsPerView
@@ -64,6 +67,14 @@ void robustModelEstimation(
     {
       MatchesPerDescType inliers;
       GeometryFunctor geometricFilter = functor; // use a copy since we are in a multi-thread context
+      robustEstimation::ACRansacOptions& acRansacOptions = geometricFilter.m_acRansacOptions;
+      if(acRansacOptions.randomSeed != -1)
+      {
+        std::size_t pairSeed = static_cast<std::size_t>(acRansacOptions.randomSeed);
+        stl::hash_combine(pairSeed, imagePair.first);
+        stl::hash_combine(pairSeed, imagePair.second);
+        acRansacOptions.randomSeed = static_cast<int>(pairSeed & 0x7fffffff);
+      }
       const EstimationStatus state = geometricFilter.geometricEstimation(sfmData, regionsPerView, imagePair, putativeMatchesPerType, inliers);
       if(state.hasStrongSupport)
       {
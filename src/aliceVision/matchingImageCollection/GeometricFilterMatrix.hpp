@@ -7,6 +7,8 @@
 
 #pragma once
 
+#include <aliceVision/robustEstimation/ACRansac.hpp>
+
 namespace aliceVision {
 
 
@@ -58,6 +60,7 @@ struct GeometricFilterMatrix
   double m_dPrecision;  //upper_bound precision used for robust estimation
   double m_dPrecision_robust;
   std::size_t m_stIteration; //maximal number of iteration for robust estimation
+  robustEstimation::ACRansacOptions m_acRansacOptions; //early rejection and parallel evaluation of the ACRANSAC hypotheses
 };
 
 
@@ -93,7 +93,7 @@ struct GeometricFilterMatrix_E_AC : public GeometricFilterMatrix
 
     std::vector<std::size_t> inliers;
     robustEstimation::Mat3Model model;
-    const std::pair<double,double> ACRansacOut = robustEstimation::ACRANSAC(kernel, inliers, m_stIteration, &model, upperBoundPrecision);
+    const std::pair<double,double> ACRansacOut = robustEstimation::ACRANSAC(kernel, inliers, m_stIteration, &model, upperBoundPrecision, m_acRansacOptions);
     m_E = model.getMatrix();
 
     if (inliers.empty())
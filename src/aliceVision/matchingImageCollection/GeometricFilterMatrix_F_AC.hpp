@@ -182,7 +182,7 @@ struct GeometricFilterMatrix_F_AC : public GeometricFilterMatrix
     const double upperBoundPrecision = Square(m_dPrecision);
 
     ModelT_ model;
-    const std::pair<double,double> ACRansacOut = robustEstimation::ACRANSAC(kernel, out_inliers, m_stIteration, &model, upperBoundPrecision);
+    const std::pair<double,double> ACRansacOut = robustEstimation::ACRANSAC(kernel, out_inliers, m_stIteration, &model, upperBoundPrecision, m_acRansacOptions);
     m_F = model.getMatrix();
 
     if(out_inliers.empty())
@@ -12,7 +12,9 @@
 #include "aliceVision/matching/IndMatch.hpp"
 #include "aliceVision/matchingImageCollection/pairBuilder.hpp"
 #include "aliceVision/feature/RegionsPerView.hpp"
+#include "aliceVision/feature/RegionsProvider.hpp"
 
+#include <stdexcept>
 #include <string>
 #include <vector>
 
@@ -38,6 +40,24 @@ class IImageCollectionMatcher
     feature::EImageDescriberType descType,
     matching::PairwiseMatches & map_putatives_matches // the output pairwise photometric corresponding points
     ) const = 0;
+
+  /// Find corresponding points between some pair of view Ids,
+  /// regions are loaded on demand through the provider
+  virtual void Match(
+    feature::RegionsProvider& regionsProvider,
+    const PairSet & pairs, // list of pair to consider for matching
+    feature::EImageDescriberType descType,
+    matching::PairwiseMatches & map_putatives_matches // the output pairwise photometric corresponding points
+    ) const
+  {
+    throw std::logic_error("This image collection matcher does not support on demand regions loading.");
+  }
+
+  /// Return true if the matcher can load the regions on demand through a RegionsProvider
+  virtual bool supportRegionsProvider() const
+  {
+    return false;
+  }
 };
 
 } // namespace aliceVision
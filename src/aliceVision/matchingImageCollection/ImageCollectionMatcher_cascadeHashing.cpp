@@ -9,9 +9,19 @@
 #include <aliceVision/matching/ArrayMatcher_cascadeHashing.hpp>
 #include <aliceVision/matching/IndMatchDecorator.hpp>
 #include <aliceVision/matching/filters.hpp>
+#include <aliceVision/feature/ImageDescriber.hpp>
 #include <aliceVision/config.hpp>
 
 #include <boost/progress.hpp>
+#include <boost/filesystem.hpp>
+#include <boost/functional/hash.hpp>
+
+#include <atomic>
+#include <cstdint>
+#include <fstream>
+#include <sstream>
+
+namespace fs = boost::filesystem;
 
 namespace aliceVision {
 namespace matchingImageCollection {
@@ -19,6 +29,188 @@ namespace matchingImageCollection {
 using namespace aliceVision::matching;
 using namespace aliceVision::feature;
 
+namespace {
+
+/// Fixed seed of the hashing projections, required to reuse hashed regions between runs
+const int HASHED_REGIONS_SEED = 0;
+
+/**
+ * @brief Find the descriptors file of a view in the features folders.
+ * @return the descriptors file path or an empty path if not found
+ */
+fs::path getDescriptorsPath(const std::vector<std::string>& featuresFolders, IndexT viewId, EImageDescriberType descType)
+{
+  const std::string filename = std::to_string(viewId) + "." + EImageDescriberType_enumToString(descType) + ".desc";
+  for(const std::string& folder : featuresFolders)
+  {
+    const fs::path descPath = fs::path(folder) / filename;
+    if(fs::exists(descPath))
+      return descPath;
+  }
+  return fs::path();
+}
+
+/**
+ * @brief Get the path of the zero mean descriptor shared by the runs of a matching job.
+ *        The file name contains a hash of the descriptors files of all the views of the job,
+ *        so a zero mean descriptor computed from other views or from outdated descriptors is never reused.
+ */
+fs::path getZeroMeanDescriptorPath(const std::vector<std::string>& featuresFolders, const std::set<IndexT>& viewIds, EImageDescriberType descType)
+{
+  std::size_t seed = 0;
+  for(IndexT viewId : viewIds)
+  {
+    const fs::path descPath = getDescriptorsPath(featuresFolders, viewId, descType);
+    boost::hash_combine(seed, viewId);
+    boost::hash_combine(seed, descPath.string());
+    if(!descPath.empty())
+    {
+      boost::system::error_code ec;
+      boost::hash_combine(seed, static_cast<std::uint64_t>(fs::file_size(descPath, ec)));
+      boost::hash_combine(seed, static_cast<std::int64_t>(fs::last_write_time(descPath, ec)));
+    }
+  }
+  std::ostringstream filename;
+  filename << "cascadeHashing." << EImageDescriberType_enumToString(descType) << "." << std::hex << seed << ".zeroMean";
+  return fs::path(featuresFolders.front()) / filename.str();
+}
+
+/**
+ * @brief Set the mean descriptor of the regions of a view in a row of the matrix (left to zero without regions).
+ */
+template <typename ScalarT>
+void setViewMeanDescriptor(const feature::Regions& regions, Eigen::MatrixXf& matForZeroMean, int row)
+{
+  typedef Eigen::Matrix<ScalarT, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor> BaseMat;
+  if(regions.DescriptorCount() == 0)
+    return;
+  const ScalarT * tab = reinterpret_cast<const ScalarT*>(regions.DescriptorRawData());
+  Eigen::Map<BaseMat> mat( (ScalarT*)tab, regions.DescriptorCount(), regions.DescriptorLength());
+  matForZeroMean.row(row) = CascadeHasher::GetZeroMeanDescriptor(mat);
+}
+
+/**
+ * @brief Compute the zero mean descriptor over all the views of a matching job from their descriptors files,
+ *        so all the runs of the job get the same one whatever the pairs they match.
+ */
+template <typename ScalarT>
+Eigen::VectorXf computeJobZeroMeanDescriptor(const std::vector<std::string>& featuresFolders, const std::set<IndexT>& viewIds,
+                                             const ImageDescriber& imageDescriber, std::size_t dimension)
+{
+  const std::vector<IndexT> views(viewIds.begin(), viewIds.end());
+  Eigen::MatrixXf matForZeroMean = Eigen::MatrixXf::Zero(views.size(), dimension);
+
+  #pragma omp parallel for schedule(dynamic)
+  for(int i = 0; i < static_cast<int>(views.size()); ++i)
+  {
+    const fs::path descPath = getDescriptorsPath(featuresFolders, views.at(i), imageDescriber.getDescriberType());
+    if(descPath.empty())
+      continue;
+    // the features are not needed
+    std::unique_ptr<Regions> regions;
+    imageDescriber.allocate(regions);
+    try
+    {
+      regions->LoadDesc(descPath.string());
+    }
+    catch(const std::exception& e)
+    {
+      ALICEVISION_LOG_WARNING("Cascade hashing zero mean descriptor: can't load the descriptors of the view " << views.at(i) << ": " << e.what());
+      continue;
+    }
+    setViewMeanDescriptor<ScalarT>(*regions, matForZeroMean, i);
+  }
+  return CascadeHasher::GetZeroMeanDescriptor(matForZeroMean);
+}
+
+/**
+ * @brief Load the zero mean descriptor shared by the runs of a matching job.
+ */
+bool loadZeroMeanDescriptor(const fs::path& filepath, std::size_t dimension, Eigen::VectorXf& zeroMeanDescriptor)
+{
+  std::ifstream stream(filepath.string(), std::ios::in | std::ios::binary);
+  if(!stream.is_open())
+    return false;
+
+  uint32_t fileDimension = 0;
+  stream.read(reinterpret_cast<char*>(&fileDimension), sizeof(fileDimension));
+  if(!stream.good() || fileDimension != dimension)
+    return false;
+
+  Eigen::VectorXf descriptor(dimension);
+  stream.read(reinterpret_cast<char*>(descriptor.data()), dimension * sizeof(float));
+  if(!stream.good())
+    return false;
+
+  zeroMeanDescriptor = descriptor;
+  return true;
+}
+
+/**
+ * @brief Save the zero mean descriptor, so the next runs use the same one and can reuse the hashed regions.
+ *        The file is written in a temporary file and renamed to be safe with concurrent runs.
+ */
+bool saveZeroMeanDescriptor(const fs::path& filepath, const Eigen::VectorXf& zeroMeanDescriptor)
+{
+  const fs::path tmpPath = filepath.parent_path() / fs::unique_path("%%%%%%%%.zeroMean.tmp");
+  {
+    std::ofstream stream(tmpPath.string(), std::ios::out | std::ios::binary);
+    if(!stream.is_open())
+      return false;
+    const uint32_t dimension = static_cast<uint32_t>(zeroMeanDescriptor.size());
+    stream.write(reinterpret_cast<const char*>(&dimension), sizeof(dimension));
+    stream.write(reinterpret_cast<const char*>(zeroMeanDescriptor.data()), dimension * sizeof(float));
+    if(!stream.good())
+      return false;
+  }
+  boost::system::error_code ec;
+  fs::rename(tmpPath, filepath, ec);
+  if(ec)
+  {
+    fs::remove(tmpPath, ec);
+    return false;
+  }
+  return true;
+}
+
+/**
+ * @brief Load the zero mean descriptor of a matching job, or compute it and save it for the next runs.
+ * @return the zero mean descriptor, empty if the describer type is not supported by the cascade hashing
+ */
+Eigen::VectorXf getJobZeroMeanDescriptor(const std::vector<std::string>& featuresFolders, const std::set<IndexT>& viewIds,
+                                         EImageDescriberType descType)
+{
+  const std::unique_ptr<ImageDescriber> imageDescriber = createImageDescriber(descType);
+  std::unique_ptr<Regions> regions;
+  imageDescriber->allocate(regions);
+  if(regions->IsBinary())
+    return Eigen::VectorXf();
+
+  const std::size_t dimension = regions->DescriptorLength();
+  const fs::path zeroMeanPath = getZeroMeanDescriptorPath(featuresFolders, viewIds, descType);
+
+  Eigen::VectorXf zeroMeanDescriptor;
+  if(loadZeroMeanDescriptor(zeroMeanPath, dimension, zeroMeanDescriptor))
+  {
+    ALICEVISION_LOG_DEBUG("Cascade hashing zero mean descriptor loaded from: " << zeroMeanPath.string());
+    return zeroMeanDescriptor;
+  }
+
+  if(regions->Type_id() == typeid(unsigned char).name())
+    zeroMeanDescriptor = computeJobZeroMeanDescriptor<unsigned char>(featuresFolders, viewIds, *imageDescriber, dimension);
+  else if(regions->Type_id() == typeid(float).name())
+    zeroMeanDescriptor = computeJobZeroMeanDescriptor<float>(featuresFolders, viewIds, *imageDescriber, dimension);
+  else
+    return Eigen::VectorXf();
+
+  // the concurrent runs compute the same descriptor, the file is replaced atomically
+  if(!saveZeroMeanDescriptor(zeroMeanPath, zeroMeanDescriptor))
+    ALICEVISION_LOG_WARNING("Unable to save the cascade hashing zero mean descriptor: " << zeroMeanPath.string());
+  return zeroMeanDescriptor;
+}
+
+} // namespace
+
 ImageCollectionMatcher_cascadeHashing
 ::ImageCollectionMatcher_cascadeHashing
 (
@@ -27,6 +219,23 @@ ImageCollectionMatcher_cascadeHashing
 {
 }
 
+void ImageCollectionMatcher_cascadeHashing::setHashedRegionsFolders(const std::vector<std::string>& featuresFolders,
+                                                                    const std::set<IndexT>& viewIds,
+                                                                    const std::vector<EImageDescriberType>& describerTypes)
+{
+  _featuresFolders = featuresFolders;
+  _zeroMeanDescriptors.clear();
+  if(featuresFolders.empty())
+    return;
+
+  for(EImageDescriberType descType : describerTypes)
+  {
+    const Eigen::VectorXf zeroMeanDescriptor = getJobZeroMeanDescriptor(featuresFolders, viewIds, descType);
+    if(zeroMeanDescriptor.size() > 0)
+      _zeroMeanDescriptors.emplace(descType, zeroMeanDescriptor);
+  }
+}
+
 namespace impl
 {
 template <typename ScalarT>
@@ -36,9 +245,13 @@ void Match
   const PairSet & pairs,
   EImageDescriberType descType,
   float fDistRatio,
+  const std::vector<std::string>& featuresFolders,
+  const Eigen::VectorXf* jobZeroMeanDescriptor,
   PairwiseMatches & map_PutativesMatches // the pairwise photometric corresponding points
 )
 {
+  const bool useHashedRegionsCache = !featuresFolders.empty() && jobZeroMeanDescriptor != nullptr;
+
   boost::progress_display my_progress_bar( pairs.size() );
 
   // Collect used view indexes
@@ -62,13 +275,23 @@ void Match
     const IndexT I = *used_index.begin();
     const feature::Regions &regionsI = regionsPerView.getRegions(I, descType);
     const size_t dimension = regionsI.DescriptorLength();
-    cascade_hasher.Init(dimension);
+    if(useHashedRegionsCache)
+      cascade_hasher.Init(dimension, 6, 10, HASHED_REGIONS_SEED);
+    else
+      cascade_hasher.Init(dimension);
   }
 
   std::map<IndexT, HashedDescriptions> hashed_base_;
 
   // Compute the zero mean descriptor that will be used for hashing (one for all the image regions)
+  // With the hashed regions cache, the one of all the views of the job is used,
+  // so the hashed regions of all the runs are compatible.
   Eigen::VectorXf zero_mean_descriptor;
+  if(useHashedRegionsCache)
+  {
+    zero_mean_descriptor = *jobZeroMeanDescriptor;
+  }
+  else
   {
     Eigen::MatrixXf matForZeroMean;
     for (int i =0; i < used_index.size(); ++i)
@@ -77,24 +300,17 @@ void Match
       std::advance(iter, i);
       const IndexT I = *iter;
       const feature::Regions &regionsI = regionsPerView.getRegions(I, descType);
-      const ScalarT * tabI =
-        reinterpret_cast<const ScalarT*>(regionsI.DescriptorRawData());
-      const size_t dimension = regionsI.DescriptorLength();
       if (i==0)
-      {
-        matForZeroMean.resize(used_index.size(), dimension);
-        matForZeroMean.fill(0.0f);
-      }
-      if (regionsI.RegionCount() > 0)
-      {
-        Eigen::Map<BaseMat> mat_I( (ScalarT*)tabI, regionsI.RegionCount(), dimension);
-        matForZeroMean.row(i) = CascadeHasher::GetZeroMeanDescriptor(mat_I);
-      }
+        matForZeroMean = Eigen::MatrixXf::Zero(used_index.size(), regionsI.DescriptorLength());
+      setViewMeanDescriptor<ScalarT>(regionsI, matForZeroMean, i);
     }
     zero_mean_descriptor = CascadeHasher::GetZeroMeanDescriptor(matForZeroMean);
   }
 
   // Index the input regions
+  std::atomic<int> nbLoadedHashedRegions(0);
+  std::atomic<int> nbSavedHashedRegions(0);
+
   #pragma omp parallel for schedule(dynamic)
   for (int i =0; i < used_index.size(); ++i)
   {
@@ -102,19 +318,62 @@ void Match
     std::advance(iter, i);
     const IndexT I = *iter;
     const feature::Regions &regionsI = regionsPerView.getRegions(I, descType);
-    const ScalarT * tabI =
-      reinterpret_cast<const ScalarT*>(regionsI.DescriptorRawData());
-    const size_t dimension = regionsI.DescriptorLength();
 
-    Eigen::Map<BaseMat> mat_I( (ScalarT*)tabI, regionsI.RegionCount(), dimension);
-    HashedDescriptions hashed_description = cascade_hasher.CreateHashedDescriptions(mat_I,
-      zero_mean_descriptor);
+    // try to reuse the hashed regions of a previous run
+    fs::path hashedRegionsPath;
+    HashedDescriptions hashed_description;
+    bool loaded = false;
+    if(useHashedRegionsCache)
+    {
+      const fs::path descPath = getDescriptorsPath(featuresFolders, I, descType);
+      if(!descPath.empty())
+      {
+        hashedRegionsPath = fs::path(descPath).replace_extension(".chash");
+        boost::system::error_code ec;
+        // hashed regions older than the descriptors are outdated
+        loaded = fs::exists(hashedRegionsPath, ec) &&
+                 fs::last_write_time(hashedRegionsPath, ec) >= fs::last_write_time(descPath, ec) && !ec &&
+                 cascade_hasher.LoadHashedDescriptions(hashedRegionsPath.string(), zero_mean_descriptor,
+                                                       regionsI.RegionCount(), hashed_description);
+      }
+    }
+
+    if(loaded)
+    {
+      ++nbLoadedHashedRegions;
+    }
+    else
+    {
+      const ScalarT * tabI =
+        reinterpret_cast<const ScalarT*>(regionsI.DescriptorRawData());
+      const size_t dimension = regionsI.DescriptorLength();
+
+      Eigen::Map<BaseMat> mat_I( (ScalarT*)tabI, regionsI.RegionCount(), dimension);
+      hashed_description = cascade_hasher.CreateHashedDescriptions(mat_I,
+        zero_mean_descriptor);
+
+      if(!hashedRegionsPath.empty())
+      {
+        if(cascade_hasher.SaveHashedDescriptions(hashedRegionsPath.string(), hashed_description, zero_mean_descriptor))
+          ++nbSavedHashedRegions;
+        else
+          ALICEVISION_LOG_WARNING("Unable to save the hashed regions: " << hashedRegionsPath.string());
+      }
+    }
+
     #pragma omp critical
     {
       hashed_base_[I] = std::move(hashed_description);
     }
   }
 
+  if(useHashedRegionsCache)
+  {
+    ALICEVISION_LOG_INFO("Cascade hashing: " << nbLoadedHashedRegions << " hashed regions reused, "
+                         << (used_index.size() - nbLoadedHashedRegions) << " computed ("
+                         << nbSavedHashedRegions << " saved).");
+  }
+
   // Perform matching between all the pairs
   for (Map_vectorT::const_iterator iter = map_Pairs.begin();
     iter != map_Pairs.end(); ++iter)
@@ -138,10 +397,16 @@ void Match
     for (int j = 0; j < (int)indexToCompare.size(); ++j)
     {
       size_t J = indexToCompare[j];
-      const feature::Regions &regionsJ = regionsPerView.getRegions(I, descType);
+      if (!regionsPerView.viewExist(J))
+      {
+        #pragma omp critical
+        ++my_progress_bar;
+        continue;
+      }
+
+      const feature::Regions &regionsJ = regionsPerView.getRegions(J, descType);
 
-      if (!regionsPerView.viewExist(J)
-          || regionsI.Type_id() != regionsJ.Type_id())
+      if (regionsI.Type_id() != regionsJ.Type_id())
       {
         #pragma omp critical
         ++my_progress_bar;
@@ -227,6 +492,11 @@ void ImageCollectionMatcher_cascadeHashing::Match
   if (regions.IsBinary())
     return;
 
+  const auto zeroMeanIt = _zeroMeanDescriptors.find(descType);
+  const Eigen::VectorXf* jobZeroMeanDescriptor = nullptr;
+  if(zeroMeanIt != _zeroMeanDescriptors.end() && zeroMeanIt->second.size() == static_cast<Eigen::Index>(regions.DescriptorLength()))
+    jobZeroMeanDescriptor = &zeroMeanIt->second;
+
   if(regions.Type_id() == typeid(unsigned char).name())
   {
     impl::Match<unsigned char>(
@@ -234,6 +504,8 @@ void ImageCollectionMatcher_cascadeHashing::Match
       pairs,
       descType,
       f_dist_ratio_,
+      _featuresFolders,
+      jobZeroMeanDescriptor,
       map_PutativesMatches);
   }
   else
@@ -244,6 +516,8 @@ void ImageCollectionMatcher_cascadeHashing::Match
       pairs,
       descType,
       f_dist_ratio_,
+      _featuresFolders,
+      jobZeroMeanDescriptor,
       map_PutativesMatches);
   }
   else
@@ -8,6 +8,12 @@
 #pragma once
 
 #include "aliceVision/matchingImageCollection/IImageCollectionMatcher.hpp"
+#include <aliceVision/numeric/numeric.hpp>
+
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
 
 namespace aliceVision {
 namespace matchingImageCollection {
@@ -19,6 +25,8 @@ namespace matchingImageCollection {
  * a threshold over the distance ratio of the 2 nearest neighbours.
  *
  * @note: Cascade hashing tables are computed once and used for all the regions.
+ *        If enabled, the hashed regions of each view are saved next to its descriptors file
+ *        and reused by the next runs (e.g. the other chunks of the same matching job).
  * @warning: all descriptors are loaded in memory. You need to ensure that it can fit in RAM.
  */
 class ImageCollectionMatcher_cascadeHashing : public IImageCollectionMatcher
@@ -29,6 +37,8 @@ class ImageCollectionMatcher_cascadeHashing : public IImageCollectionMatcher
     float dist_ratio
   );
 
+  using IImageCollectionMatcher::Match;
+
   /// Find corresponding points between some pair of view Ids
   void Match(
     const feature::RegionsPerView& regionsPerView,
@@ -37,9 +47,28 @@ class ImageCollectionMatcher_cascadeHashing : public IImageCollectionMatcher
     matching::PairwiseMatches & map_PutativesMatches // the pairwise photometric corresponding points
   ) const;
 
+  /**
+   * @brief Save and reuse the hashed regions of each view.
+   *        They are stored next to the descriptors files (<viewId>.<describerType>.chash)
+   *        and reloaded if the hasher parameters, the zero mean descriptor and the descriptors match.
+   *        The zero mean descriptor is computed over all the views of the job, so all the runs
+   *        (e.g. the chunks of the matching) hash their regions with the same one.
+   *        It is loaded, or computed from the descriptors only and saved, once here before any pair is matched.
+   * @param[in] featuresFolders The folders containing the descriptors files, empty to disable
+   * @param[in] viewIds All the views of the matching job, whatever the pairs matched by this run
+   * @param[in] describerTypes The describer types that will be matched
+   */
+  void setHashedRegionsFolders(const std::vector<std::string>& featuresFolders,
+                               const std::set<IndexT>& viewIds,
+                               const std::vector<feature::EImageDescriberType>& describerTypes);
+
   private:
   // Distance ratio used to discard spurious correspondence
   float f_dist_ratio_;
+  // Folders of the descriptors files, used to persist the hashed regions
+  std::vector<std::string> _featuresFolders;
+  // Zero mean descriptor of all the views of the matching job, per describer type
+  std::map<feature::EImageDescriberType, Eigen::VectorXf> _zeroMeanDescriptors;
 };
 
 } // namespace aliceVision
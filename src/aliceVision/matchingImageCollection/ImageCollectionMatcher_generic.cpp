@@ -11,70 +11,121 @@
 #include <aliceVision/matching/ArrayMatcher_cascadeHashing.hpp>
 #include <aliceVision/matching/RegionsMatcher.hpp>
 #include <aliceVision/matchingImageCollection/IImageCollectionMatcher.hpp>
+#include <aliceVision/matchingImageCollection/pairBuilder.hpp>
+#include <aliceVision/system/cpu.hpp>
+#include <aliceVision/system/Timer.hpp>
 #include <aliceVision/config.hpp>
 
 #include <boost/progress.hpp>
 
+#include <functional>
+#include <map>
+#include <memory>
+
 namespace aliceVision {
 namespace matchingImageCollection {
 
 using namespace aliceVision::matching;
 using namespace aliceVision::feature;
 
-ImageCollectionMatcher_generic::ImageCollectionMatcher_generic(
-  float distRatio, EMatcherType matcherType)
-  : IImageCollectionMatcher()
-  , _f_dist_ratio(distRatio)
-  , _matcherType(matcherType)
+namespace {
+
+using RegionsGetter = std::function<std::shared_ptr<const feature::Regions>(IndexT viewId)>;
+
+/**
+ * @brief Get the memory size used to tile the pairs in blocks that fit in the CPU cache.
+ */
+std::size_t getMatchingBlockMemorySize()
 {
+  // the last level cache is shared by the threads matching the same pair
+  long cacheSize = system::get_cache_size(3);
+  if(cacheSize <= 0)
+    cacheSize = system::get_cache_size(2);
+  if(cacheSize <= 0)
+    cacheSize = 8 * 1024 * 1024;
+  return static_cast<std::size_t>(cacheSize);
 }
 
-void ImageCollectionMatcher_generic::Match(
-  const feature::RegionsPerView& regionsPerView,
-  const PairSet & pairs,
-  feature::EImageDescriberType descType,
-  matching::PairwiseMatches & map_PutativesMatches)const // the pairwise photometric corresponding points
+/**
+ * @brief Match all the pairs block by block.
+ *        The database matchers of the views I are built once per I-set and reused by all the blocks of this I-set,
+ *        each view J is matched against all its views I of the block while its descriptors are in cache.
+ */
+void matchPairBlocks(const std::vector<PairBlock>& blocks,
+                     const RegionsGetter& getRegions,
+                     const std::function<void(const PairBlock&)>& prepareBlock,
+                     matching::EMatcherType matcherType,
+                     float distRatio,
+                     feature::EImageDescriberType descType,
+                     std::size_t nbPairs,
+                     matching::PairwiseMatches & map_PutativesMatches)
 {
-#if ALICEVISION_IS_DEFINED(ALICEVISION_HAVE_OPENMP)
-  ALICEVISION_LOG_DEBUG("Using the OPENMP thread interface");
-#endif
-  const bool b_multithreaded_pair_search = (_matcherType == CASCADE_HASHING_L2);
+  const bool b_multithreaded_pair_search = (matcherType == CASCADE_HASHING_L2);
   // -> set to true for CASCADE_HASHING_L2, since OpenMP instructions are not used in this matcher
 
-  boost::progress_display my_progress_bar( pairs.size() );
+  boost::progress_display my_progress_bar( nbPairs );
 
-  // Sort pairs according the first index to minimize the MatcherT build operations
-  typedef std::map<size_t, std::vector<size_t> > Map_vectorT;
-  Map_vectorT map_Pairs;
-  for (PairSet::const_iterator iter = pairs.begin(); iter != pairs.end(); ++iter)
-  {
-    map_Pairs[iter->first].push_back(iter->second);
-  }
+  // regions and database matchers of the current I-set (no matcher for empty regions)
+  std::map<IndexT, std::shared_ptr<const feature::Regions>> regionsPerI;
+  std::map<IndexT, std::unique_ptr<matching::RegionsDatabaseMatcher>> matcherPerI;
 
-  // Perform matching between all the pairs
-  for (Map_vectorT::const_iterator iter = map_Pairs.begin();
-    iter != map_Pairs.end(); ++iter)
+  system::Timer timer;
+
+  for(std::size_t b = 0; b < blocks.size(); ++b)
   {
-    const size_t I = iter->first;
-    const std::vector<size_t> & indexToCompare = iter->second;
+    const PairBlock& block = blocks.at(b);
+    system::Timer blockTimer;
+
+    if(prepareBlock)
+      prepareBlock(block);
 
-    const feature::Regions & regionsI = regionsPerView.getRegions(I, descType);
-    if (regionsI.RegionCount() == 0)
+    // release the views I that are not used anymore
+    if(b == 0 || blocks.at(b - 1).viewsI != block.viewsI)
     {
-      my_progress_bar += indexToCompare.size();
-      continue;
+      matcherPerI.clear();
+      regionsPerI.clear();
+
+      std::vector<std::shared_ptr<const feature::Regions>> regionsI(block.viewsI.size());
+      std::vector<std::unique_ptr<matching::RegionsDatabaseMatcher>> matchersI(block.viewsI.size());
+
+      // Initialize the matching interfaces
+      #pragma omp parallel for schedule(dynamic)
+      for(int i = 0; i < (int)block.viewsI.size(); ++i)
+      {
+        regionsI.at(i) = getRegions(block.viewsI.at(i));
+        if(regionsI.at(i)->RegionCount() > 0)
+          matchersI.at(i).reset(new matching::RegionsDatabaseMatcher(matcherType, *regionsI.at(i)));
+      }
+
+      for(std::size_t i = 0; i < block.viewsI.size(); ++i)
+      {
+        regionsPerI[block.viewsI.at(i)] = regionsI.at(i);
+        matcherPerI[block.viewsI.at(i)] = std::move(matchersI.at(i));
+      }
     }
 
-    // Initialize the matching interface
-    matching::RegionsDatabaseMatcher matcher(_matcherType, regionsI);
+    std::map<IndexT, std::shared_ptr<const feature::Regions>> regionsPerJ;
+    std::size_t blockMemorySize = 0;
+    for(IndexT J : block.viewsJ)
+    {
+      regionsPerJ[J] = getRegions(J);
+      blockMemorySize += regionsPerJ[J]->MemorySize();
+    }
+    for(const auto& regionsI : regionsPerI)
+      blockMemorySize += regionsI.second->MemorySize();
 
+    // Perform matching between all the pairs of the block
     #pragma omp parallel for schedule(dynamic) if(b_multithreaded_pair_search)
-    for (int j = 0; j < (int)indexToCompare.size(); ++j)
+    for (int p = 0; p < (int)block.pairs.size(); ++p)
     {
-      const size_t J = indexToCompare[j];
+      const IndexT I = block.pairs.at(p).first;
+      const IndexT J = block.pairs.at(p).second;
 
-      const feature::Regions &regionsJ = regionsPerView.getRegions(J, descType);
-      if (regionsJ.RegionCount() == 0
+      const std::unique_ptr<matching::RegionsDatabaseMatcher>& matcher = matcherPerI.at(I);
+      const feature::Regions &regionsI = *regionsPerI.at(I);
+      const feature::Regions &regionsJ = *regionsPerJ.at(J);
+      if (!matcher
+          || regionsJ.RegionCount() == 0
           || regionsI.Type_id() != regionsJ.Type_id())
       {
         #pragma omp critical
@@ -83,7 +134,7 @@ void ImageCollectionMatcher_generic::Match(
       }
 
       IndMatches vec_putatives_matches;
-      matcher.Match(_f_dist_ratio, regionsJ, vec_putatives_matches);
+      matcher->Match(distRatio, regionsJ, vec_putatives_matches);
       #pragma omp critical
       {
         ++my_progress_bar;
@@ -93,7 +144,89 @@ void ImageCollectionMatcher_generic::Match(
         }
       }
     }
+
+    const double blockElapsed = blockTimer.elapsed();
+    ALICEVISION_LOG_DEBUG("Matching block " << (b + 1) << "/" << blocks.size() << ": "
+                          << block.viewsI.size() << "x" << block.viewsJ.size() << " views, "
+                          << block.pairs.size() << " pairs, "
+                          << blockMemorySize / (1024 * 1024) << " MB of regions, done in " << blockElapsed << " s ("
+                          << ((blockElapsed > 0.0) ? block.pairs.size() / blockElapsed : 0.0) << " pairs/s).");
   }
+
+  const double elapsed = timer.elapsed();
+  ALICEVISION_LOG_INFO(nbPairs << " pairs matched in " << blocks.size() << " blocks in " << elapsed << " s ("
+                       << ((elapsed > 0.0) ? nbPairs / elapsed : 0.0) << " pairs/s).");
+}
+
+} // namespace
+
+ImageCollectionMatcher_generic::ImageCollectionMatcher_generic(
+  float distRatio, EMatcherType matcherType)
+  : IImageCollectionMatcher()
+  , _f_dist_ratio(distRatio)
+  , _matcherType(matcherType)
+{
+}
+
+void ImageCollectionMatcher_generic::Match(
+  const feature::RegionsPerView& regionsPerView,
+  const PairSet & pairs,
+  feature::EImageDescriberType descType,
+  matching::PairwiseMatches & map_PutativesMatches)const // the pairwise photometric corresponding points
+{
+#if ALICEVISION_IS_DEFINED(ALICEVISION_HAVE_OPENMP)
+  ALICEVISION_LOG_DEBUG("Using the OPENMP thread interface");
+#endif
+
+  // Sort pairs in blocks that fit in the CPU cache
+  const std::vector<PairBlock> blocks = computePairBlocks(pairs,
+    [&](IndexT viewId) { return regionsPerView.getRegions(viewId, descType).MemorySize(); },
+    getMatchingBlockMemorySize());
+
+  // regions are owned by the RegionsPerView
+  const RegionsGetter getRegions = [&](IndexT viewId)
+  {
+    return std::shared_ptr<const feature::Regions>(&regionsPerView.getRegions(viewId, descType), [](const feature::Regions*){});
+  };
+
+  matchPairBlocks(blocks, getRegions, nullptr, _matcherType, _f_dist_ratio, descType, pairs.size(), map_PutativesMatches);
+}
+
+void ImageCollectionMatcher_generic::Match(
+  feature::RegionsProvider& regionsProvider,
+  const PairSet & pairs,
+  feature::EImageDescriberType descType,
+  matching::PairwiseMatches & map_PutativesMatches)const // the pairwise photometric corresponding points
+{
+  if(pairs.empty())
+    return;
+
+  // the memory size of the regions is unknown before loading, use the first view as an estimate
+  const std::size_t viewMemorySize = std::max<std::size_t>(1, regionsProvider.getRegions(pairs.begin()->first, descType)->MemorySize());
+
+  // Sort pairs in blocks that fit in the CPU cache
+  const std::vector<PairBlock> blocks = computePairBlocks(pairs,
+    [viewMemorySize](IndexT) { return viewMemorySize; },
+    getMatchingBlockMemorySize());
+
+  const RegionsGetter getRegions = [&](IndexT viewId)
+  {
+    return regionsProvider.getRegions(viewId, descType);
+  };
+
+  // load the regions needed by the block in parallel
+  const auto prefetchBlock = [&](const PairBlock& block)
+  {
+    std::vector<IndexT> viewIds = block.viewsI;
+    viewIds.insert(viewIds.end(), block.viewsJ.begin(), block.viewsJ.end());
+    regionsProvider.prefetch(viewIds, descType);
+  };
+
+  matchPairBlocks(blocks, getRegions, prefetchBlock, _matcherType, _f_dist_ratio, descType, pairs.size(), map_PutativesMatches);
+
+  ALICEVISION_LOG_DEBUG("Regions provider: " << regionsProvider.getNbLoads() << " loads, "
+                        << regionsProvider.getNbHits() << " cache hits, "
+                        << regionsProvider.getMemorySize() / (1024 * 1024) << " MB in cache.");
 }
 
 } // namespace aliceVision
@@ -18,7 +18,9 @@ namespace matchingImageCollection {
  * Spurious correspondences are discarded by using the
  * a threshold over the distance ratio of the 2 nearest neighbours.
  *
- * @warning: all descriptors are loaded in memory. You need to ensure that it can fit in RAM.
+ * @note: Pairs are matched by blocks of views (I-set x J-set) whose descriptors fit in the CPU cache.
+ * @warning: with a RegionsPerView, all descriptors are loaded in memory. You need to ensure that it can fit in RAM.
+ *           Use a RegionsProvider to load the descriptors on demand within a memory budget.
  */
 class ImageCollectionMatcher_generic : public IImageCollectionMatcher
 {
@@ -36,6 +38,20 @@ class ImageCollectionMatcher_generic : public IImageCollectionMatcher
     matching::PairwiseMatches & map_PutativesMatches // the pairwise photometric corresponding points
     ) const;
 
+  /// Find corresponding points between some pair of view Ids,
+  /// regions are loaded on demand through the provider
+  void Match(
+    feature::RegionsProvider& regionsProvider,
+    const PairSet & pairs,
+    feature::EImageDescriberType descType,
+    matching::PairwiseMatches & map_PutativesMatches // the pairwise photometric corresponding points
+    ) const override;
+
+  bool supportRegionsProvider() const override
+  {
+    return true;
+  }
+
   private:
   // Distance ratio used to discard spurious correspondence
   float _f_dist_ratio;
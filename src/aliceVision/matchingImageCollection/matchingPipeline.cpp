@@ -0,0 +1,145 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2020 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include "matchingPipeline.hpp"
+
+#include <aliceVision/system/Logger.hpp>
+#include <aliceVision/system/Timer.hpp>
+#include <aliceVision/alicevision_omp.hpp>
+
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <mutex>
+#include <thread>
+
+namespace aliceVision {
+namespace matchingImageCollection {
+
+std::vector<PairSet> splitPairsInChunks(const PairSet& pairs, std::size_t chunkSize)
+{
+  std::vector<PairSet> chunks;
+  if(chunkSize == 0)
+    chunkSize = std::max<std::size_t>(1, pairs.size());
+
+  for(const Pair& pair : pairs)
+  {
+    if(chunks.empty() || chunks.back().size() == chunkSize)
+      chunks.emplace_back();
+    // pairs are visited in order, insert at the end
+    chunks.back().emplace_hint(chunks.back().end(), pair);
+  }
+  return chunks;
+}
+
+void pipelineMatching(const std::vector<PairSet>& chunks,
+                      std::size_t queueSize,
+                      const PutativeMatchingFunction& computePutativeMatches,
+                      const PutativeMatchesConsumer& processPutativeMatches)
+{
+  queueSize = std::max<std::size_t>(1, queueSize);
+
+  std::mutex mutex;
+  std::condition_variable queueChanged;
+  std::deque<matching::PairwiseMatches> queue;
+  bool matchingDone = false;
+  bool aborted = false;
+  std::exception_ptr matchingError;
+
+  double matchingTime = 0.0;
+  double waitingTime = 0.0;
+
+  // both stages run their OpenMP loops at the same time, share the threads between them
+  const int nbThreads = omp_get_max_threads();
+  const int nbMatchingThreads = std::max(1, nbThreads / 2);
+  const int nbProcessingThreads = std::max(1, nbThreads - nbMatchingThreads);
+
+  // putative matching stage
+  std::thread matchingThread([&]()
+  {
+    omp_set_nested(0);
+    omp_set_num_threads(nbMatchingThreads);
+
+    system::Timer timer;
+    try
+    {
+      for(const PairSet& chunk : chunks)
+      {
+        matching::PairwiseMatches putativeMatches;
+        computePutativeMatches(chunk, putativeMatches);
+
+        std::unique_lock<std::mutex> lock(mutex);
+        queueChanged.wait(lock, [&]() { return aborted || queue.size() < queueSize; });
+        if(aborted)
+          break;
+        queue.push_back(std::move(putativeMatches));
+        queueChanged.notify_all();
+      }
+    }
+    catch(...)
+    {
+      matchingError = std::current_exception();
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+    matchingTime = timer.elapsed();
+    matchingDone = true;
+    queueChanged.notify_all();
+  });
+
+  // processing stage
+  omp_set_num_threads(nbProcessingThreads);
+
+  system::Timer timer;
+  std::exception_ptr processingError;
+  std::size_t chunkIndex = 0;
+  try
+  {
+    while(true)
+    {
+      matching::PairwiseMatches putativeMatches;
+      {
+        system::Timer waitTimer;
+        std::unique_lock<std::mutex> lock(mutex);
+        queueChanged.wait(lock, [&]() { return !queue.empty() || matchingDone; });
+        waitingTime += waitTimer.elapsed();
+        if(queue.empty())
+          break;
+        putativeMatches = std::move(queue.front());
+        queue.pop_front();
+        queueChanged.notify_all();
+      }
+
+      ++chunkIndex;
+      ALICEVISION_LOG_INFO("Process the putative matches of the chunk " << chunkIndex << "/" << chunks.size()
+                           << " (" << putativeMatches.size() << " image pairs).");
+      processPutativeMatches(std::move(putativeMatches));
+    }
+  }
+  catch(...)
+  {
+    processingError = std::current_exception();
+    std::lock_guard<std::mutex> lock(mutex);
+    aborted = true;
+    queueChanged.notify_all();
+  }
+
+  matchingThread.join();
+  omp_set_num_threads(nbThreads);
+
+  ALICEVISION_LOG_INFO("Matching pipeline: putative matching done in " << matchingTime << " s, "
+                       << "processing done in " << timer.elapsed() - waitingTime << " s "
+                       << "(waited " << waitingTime << " s for the putative matches).");
+
+  if(matchingError)
+    std::rethrow_exception(matchingError);
+  if(processingError)
+    std::rethrow_exception(processingError);
+}
+
+} // namespace matchingImageCollection
+} // namespace aliceVision
@@ -0,0 +1,54 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2020 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#pragma once
+
+#include <aliceVision/types.hpp>
+#include <aliceVision/matching/IndMatch.hpp>
+
+#include <functional>
+#include <vector>
+
+namespace aliceVision {
+namespace matchingImageCollection {
+
+/**
+ * @brief Split a set of pairs into chunks of consecutive pairs.
+ *        The pairs of a view I are contiguous in a PairSet, so they stay contiguous in the chunks.
+ * @param[in] pairs The pairs to split
+ * @param[in] chunkSize The maximum number of pairs per chunk. If 0, a single chunk with all the pairs.
+ * @return the list of chunks, in the order of the pairs
+ */
+std::vector<PairSet> splitPairsInChunks(const PairSet& pairs, std::size_t chunkSize);
+
+/// Compute the putative matches of a chunk of pairs
+using PutativeMatchingFunction = std::function<void(const PairSet& pairs, matching::PairwiseMatches& putativeMatches)>;
+
+/// Process (filter, export) the putative matches of a chunk of pairs
+using PutativeMatchesConsumer = std::function<void(matching::PairwiseMatches&& putativeMatches)>;
+
+/**
+ * @brief Pipeline the putative matching and the processing of the putative matches chunk by chunk.
+ *
+ * The putative matching runs in a dedicated thread and the chunks are processed in the calling thread
+ * while the next chunks are matched. At most \p queueSize chunks of putative matches wait to be processed,
+ * so the memory used by the putative matches is bounded by the queue size and not by the number of pairs.
+ * The chunks are processed in the order of \p chunks.
+ * The OpenMP threads are shared between the two stages, and the matching thread does not use nested parallelism.
+ *
+ * @param[in] chunks The chunks of pairs to match
+ * @param[in] queueSize The maximum number of matched chunks waiting to be processed (at least 1)
+ * @param[in] computePutativeMatches Compute the putative matches of a chunk (called in the matching thread)
+ * @param[in] processPutativeMatches Process the putative matches of a chunk (called in the calling thread)
+ * @throws the exception thrown by one of the stages, once both stages are stopped
+ */
+void pipelineMatching(const std::vector<PairSet>& chunks,
+                      std::size_t queueSize,
+                      const PutativeMatchingFunction& computePutativeMatches,
+                      const PutativeMatchesConsumer& processPutativeMatches);
+
+} // namespace matchingImageCollection
+} // namespace aliceVision
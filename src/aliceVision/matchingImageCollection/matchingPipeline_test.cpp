@@ -0,0 +1,156 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2020 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include <aliceVision/matchingImageCollection/matchingPipeline.hpp>
+#include <aliceVision/alicevision_omp.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <stdexcept>
+
+#define BOOST_TEST_MODULE matchingImageCollectionMatchingPipeline
+
+#include <boost/test/unit_test.hpp>
+
+using namespace aliceVision;
+using namespace aliceVision::matching;
+using namespace aliceVision::matchingImageCollection;
+
+namespace {
+
+PairSet makePairs(IndexT nbViews)
+{
+  PairSet pairs;
+  for(IndexT i = 0; i < nbViews; ++i)
+    for(IndexT j = i + 1; j < nbViews; ++j)
+      pairs.insert(std::make_pair(i, j));
+  return pairs;
+}
+
+void matchChunk(const PairSet& pairs, PairwiseMatches& putativeMatches)
+{
+  for(const Pair& pair : pairs)
+    putativeMatches[pair][feature::EImageDescriberType::UNKNOWN] = {{pair.first, pair.second}};
+}
+
+} // namespace
+
+BOOST_AUTO_TEST_CASE(matchingPipeline_splitPairsInChunks)
+{
+  const PairSet pairs = makePairs(10);
+
+  BOOST_CHECK(splitPairsInChunks(PairSet(), 4).empty());
+  BOOST_CHECK_EQUAL(1, splitPairsInChunks(pairs, 0).size());
+
+  const std::vector<PairSet> chunks = splitPairsInChunks(pairs, 4);
+  BOOST_CHECK_EQUAL((pairs.size() + 3) / 4, chunks.size());
+
+  // chunks are consecutive ranges of the pairs
+  PairSet::const_iterator pairIt = pairs.begin();
+  for(const PairSet& chunk : chunks)
+  {
+    BOOST_CHECK(chunk.size() <= 4);
+    for(const Pair& pair : chunk)
+    {
+      BOOST_CHECK(pair == *pairIt);
+      ++pairIt;
+    }
+  }
+  BOOST_CHECK(pairIt == pairs.end());
+}
+
+BOOST_AUTO_TEST_CASE(matchingPipeline_orderAndQueueSize)
+{
+  const PairSet pairs = makePairs(20);
+  const std::vector<PairSet> chunks = splitPairsInChunks(pairs, 7);
+  const std::size_t queueSize = 2;
+
+  std::atomic<int> nbMatchedChunks(0);
+  std::atomic<int> nbProcessedChunks(0);
+  std::atomic<int> maxPendingChunks(0);
+
+  PairwiseMatches allMatches;
+  std::vector<Pair> processedPairs;
+
+  pipelineMatching(chunks, queueSize,
+    [&](const PairSet& chunk, PairwiseMatches& putativeMatches)
+    {
+      matchChunk(chunk, putativeMatches);
+      ++nbMatchedChunks;
+    },
+    [&](PairwiseMatches&& putativeMatches)
+    {
+      ++nbProcessedChunks;
+      // chunks matched and not processed yet: the queue and the one being matched
+      maxPendingChunks = std::max<int>(maxPendingChunks, nbMatchedChunks - nbProcessedChunks);
+      for(const auto& pairMatches : putativeMatches)
+        processedPairs.push_back(pairMatches.first);
+      allMatches.insert(putativeMatches.begin(), putativeMatches.end());
+    });
+
+  BOOST_CHECK_EQUAL(chunks.size(), nbMatchedChunks);
+  BOOST_CHECK_EQUAL(chunks.size(), nbProcessedChunks);
+  BOOST_CHECK(maxPendingChunks <= static_cast<int>(queueSize) + 1);
+
+  // all the pairs are processed in order
+  BOOST_CHECK_EQUAL(pairs.size(), processedPairs.size());
+  BOOST_CHECK(std::equal(pairs.begin(), pairs.end(), processedPairs.begin()));
+  BOOST_CHECK_EQUAL(pairs.size(), allMatches.size());
+}
+
+BOOST_AUTO_TEST_CASE(matchingPipeline_errors)
+{
+  const std::vector<PairSet> chunks = splitPairsInChunks(makePairs(20), 5);
+
+  // error in the putative matching: the matched chunks are processed
+  int nbProcessedChunks = 0;
+  int nbMatchedChunks = 0;
+  BOOST_CHECK_THROW(pipelineMatching(chunks, 1,
+    [&](const PairSet& chunk, PairwiseMatches& putativeMatches)
+    {
+      if(nbMatchedChunks == 3)
+        throw std::runtime_error("matching error");
+      matchChunk(chunk, putativeMatches);
+      ++nbMatchedChunks;
+    },
+    [&](PairwiseMatches&&)
+    {
+      ++nbProcessedChunks;
+    }), std::runtime_error);
+  BOOST_CHECK_EQUAL(3, nbProcessedChunks);
+
+  // error in the processing: the putative matching is stopped
+  BOOST_CHECK_THROW(pipelineMatching(chunks, 1,
+    matchChunk,
+    [&](PairwiseMatches&&)
+    {
+      throw std::logic_error("processing error");
+    }), std::logic_error);
+}
+
+BOOST_AUTO_TEST_CASE(matchingPipeline_threads)
+{
+  const int nbThreads = omp_get_max_threads();
+  std::atomic<int> nbMatchingThreads(0);
+  std::atomic<int> nbProcessingThreads(0);
+
+  pipelineMatching(splitPairsInChunks(makePairs(5), 2), 1,
+    [&](const PairSet& pairs, PairwiseMatches& putativeMatches)
+    {
+      nbMatchingThreads = omp_get_max_threads();
+      matchChunk(pairs, putativeMatches);
+    },
+    [&](PairwiseMatches&&)
+    {
+      nbProcessingThreads = omp_get_max_threads();
+    });
+
+  // the stages share the threads, and the calling thread gets all of them back
+  BOOST_CHECK_GE(nbMatchingThreads, 1);
+  BOOST_CHECK_GE(nbProcessingThreads, 1);
+  BOOST_CHECK_LE(nbMatchingThreads + nbProcessingThreads, std::max(2, nbThreads));
+  BOOST_CHECK_EQUAL(nbThreads, omp_get_max_threads());
+}
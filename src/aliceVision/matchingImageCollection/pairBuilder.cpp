@@ -11,6 +11,7 @@
 
 #include <boost/algorithm/string.hpp>
 
+#include <map>
 #include <set>
 #include <iostream>
 #include <fstream>
@@ -123,4 +124,57 @@ bool savePairs(const std::string &sFileName, const PairSet & pairs)
   return bOk;
 }
 
+std::vector<PairBlock> computePairBlocks(const PairSet& pairs,
+                                         const std::function<std::size_t(IndexT)>& getMemorySize,
+                                         std::size_t blockMemorySize)
+{
+  std::vector<PairBlock> blocks;
+
+  // half of the memory for the I views, half for the J views
+  const std::size_t halfMemorySize = blockMemorySize / 2;
+
+  std::map<IndexT, std::vector<IndexT>> pairsPerI;
+  for(const Pair& pair : pairs)
+    pairsPerI[pair.first].push_back(pair.second);
+
+  auto itI = pairsPerI.begin();
+  while(itI != pairsPerI.end())
+  {
+    // accumulate consecutive views I while they fit in memory (at least one)
+    std::vector<IndexT> viewsI;
+    std::map<IndexT, std::vector<IndexT>> pairsPerJ;
+    std::size_t memorySizeI = 0;
+    do
+    {
+      viewsI.push_back(itI->first);
+      memorySizeI += getMemorySize(itI->first);
+      for(IndexT J : itI->second)
+        pairsPerJ[J].push_back(itI->first);
+      ++itI;
+    }
+    while(itI != pairsPerI.end() && blockMemorySize > 0 && memorySizeI + getMemorySize(itI->first) <= halfMemorySize);
+
+    // split the views J connected to this I-set into tiles that fit in memory (at least one view per tile)
+    auto itJ = pairsPerJ.begin();
+    while(itJ != pairsPerJ.end())
+    {
+      PairBlock block;
+      block.viewsI = viewsI;
+      std::size_t memorySizeJ = 0;
+      do
+      {
+        block.viewsJ.push_back(itJ->first);
+        memorySizeJ += getMemorySize(itJ->first);
+        for(IndexT I : itJ->second)
+          block.pairs.emplace_back(I, itJ->first);
+        ++itJ;
+      }
+      while(itJ != pairsPerJ.end() && (blockMemorySize == 0 || memorySizeJ + getMemorySize(itJ->first) <= halfMemorySize));
+
+      blocks.push_back(std::move(block));
+    }
+  }
+  return blocks;
+}
+
 }; // namespace aliceVision
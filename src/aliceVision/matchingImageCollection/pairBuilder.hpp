@@ -11,6 +11,8 @@
 #include <aliceVision/sfmData/SfMData.hpp>
 
 #include <algorithm>
+#include <functional>
+#include <vector>
 
 namespace aliceVision {
 
@@ -30,4 +32,29 @@ bool loadPairs(
 /// I K
 bool savePairs(const std::string &sFileName, const PairSet & pairs);
 
+/**
+ * @brief A block of pairs between a set of views I and a set of views J.
+ *        Pairs are sorted by J, so the data of a view J is reused by all the pairs of the block.
+ */
+struct PairBlock
+{
+  std::vector<IndexT> viewsI;
+  std::vector<IndexT> viewsJ;
+  std::vector<Pair> pairs;
+};
+
+/**
+ * @brief Split a set of pairs into blocks (I-set x J-set) whose data fit in the given memory size.
+ *        Consecutive blocks share the same I-set until all its pairs are scheduled,
+ *        so the data of the I views can be kept from one block to the next.
+ * @param[in] pairs The pairs to schedule
+ * @param[in] getMemorySize Return the memory size of the data of a view (in bytes)
+ * @param[in] blockMemorySize The maximum memory size of the data of a block (in bytes),
+ *            half for the I-set and half for the J-set. If 0, one block per view I with all its views J.
+ * @return the list of blocks, each pair belongs to exactly one block
+ */
+std::vector<PairBlock> computePairBlocks(const PairSet& pairs,
+                                         const std::function<std::size_t(IndexT)>& getMemorySize,
+                                         std::size_t blockMemorySize);
+
 }; // namespace aliceVision
@@ -80,3 +80,48 @@ BOOST_AUTO_TEST_CASE(matchingImageCollection_IO)
   BOOST_CHECK( loadPairs("pairsT_IO.txt", loaded_Pairs));
   BOOST_CHECK( std::equal(loaded_Pairs.begin(), loaded_Pairs.end(), pairSetGTsorted.begin()) );
 }
+
+BOOST_AUTO_TEST_CASE(matchingImageCollection_pairBlocks)
+{
+  sfmData::Views views;
+  for(IndexT i = 0; i < 7; ++i)
+    views[i] = std::make_shared<sfmData::View>("filepath", i);
+
+  const PairSet pairSet = exhaustivePairs(views);
+  const auto getMemorySize = [](IndexT) { return std::size_t(10); };
+
+  {
+    // at most 2 views I and 2 views J per block
+    const std::vector<PairBlock> blocks = computePairBlocks(pairSet, getMemorySize, 40);
+
+    PairSet scheduledPairs;
+    for(const PairBlock& block : blocks)
+    {
+      BOOST_CHECK(!block.pairs.empty());
+      BOOST_CHECK(block.viewsI.size() <= 2);
+      BOOST_CHECK(block.viewsJ.size() <= 2);
+      for(std::size_t i = 0; i < block.pairs.size(); ++i)
+      {
+        const Pair& pair = block.pairs.at(i);
+        BOOST_CHECK(std::find(block.viewsI.begin(), block.viewsI.end(), pair.first) != block.viewsI.end());
+        BOOST_CHECK(std::find(block.viewsJ.begin(), block.viewsJ.end(), pair.second) != block.viewsJ.end());
+        // pairs are sorted by view J
+        if(i > 0)
+          BOOST_CHECK(block.pairs.at(i - 1).second <= pair.second);
+        // each pair is scheduled once
+        BOOST_CHECK(scheduledPairs.insert(pair).second);
+      }
+    }
+    BOOST_CHECK(scheduledPairs == pairSet);
+  }
+  {
+    // no memory limit: one block per view I
+    const std::vector<PairBlock> blocks = computePairBlocks(pairSet, getMemorySize, 0);
+    BOOST_CHECK_EQUAL(blocks.size(), 6);
+    for(const PairBlock& block : blocks)
+    {
+      BOOST_CHECK_EQUAL(block.viewsI.size(), 1);
+      BOOST_CHECK_EQUAL(block.viewsJ.size(), 6 - block.viewsI.front());
+    }
+  }
+}
@@ -86,63 +86,11 @@ double Triangulation::error(const Vec3 &X) const
 
 Vec3 Triangulation::compute(int iter) const
 {
-  const auto nviews = views.size();
-  assert(nviews >= 2);
-
-  // Iterative weighted linear least squares
-  Mat3 AtA;
-  Vec3 Atb, X;
-  std::vector<double> weights(nviews, double(1.0));
-  for(int it = 0; it < iter; ++it)
-  {
-    AtA.fill(0.0);
-    Atb.fill(0.0);
-    for(std::size_t i = 0; i < nviews; ++i)
-    {
-      const Mat34& PMat = views[i].first;
-      const Vec2 & p = views[i].second;
-      const double w = weights[i];
-
-      Vec3 v1, v2;
-      for(Mat::Index j = 0; j < 3; ++j)
-      {
-        v1[j] = w * (PMat(0, j) - p(0) * PMat(2, j));
-        v2[j] = w * (PMat(1, j) - p(1) * PMat(2, j));
-        Atb[j] += w * (v1[j] * (p(0) * PMat(2, 3) - PMat(0, 3))
-                + v2[j] * (p(1) * PMat(2, 3) - PMat(1, 3)));
-      }
-
-      for(Mat::Index k = 0; k < 3; ++k)
-      {
-        for(Mat::Index j = 0; j <= k; ++j)
-        {
-          const double v = v1[j] * v1[k] + v2[j] * v2[k];
-          AtA(j, k) += v;
-          if(j < k) AtA(k, j) += v;
-        }
-      }
-    }
-
-    X = AtA.inverse() * Atb;
-
-    // Compute reprojection error, min and max depth, and update weights
-    zmin = std::numeric_limits<double>::max();
-    zmax = -std::numeric_limits<double>::max();
-    err = 0;
-    for(std::size_t i = 0; i < nviews; ++i)
-    {
-      const Mat34& PMat = views[i].first;
-      const Vec2 & p = views[i].second;
-      const Vec3 xProj = PMat * Vec4(X(0), X(1), X(2), 1.0);
-      const double z = xProj(2);
-      const Vec2 x = xProj.head<2>() / z;
-      if(z < zmin) zmin = z;
-      if(z > zmax) zmax = z;
-      err += (p - x).norm();
-      weights[i] = 1.0 / z;
-    }
-  }
-  return X;
+  std::vector<double> weights(views.size(), double(1.0));
+  return triangulateIterative(views.size(),
+                              [this](std::size_t i) -> const Mat34& { return views[i].first; },
+                              [this](std::size_t i) -> const Vec2& { return views[i].second; },
+                              iter, weights.data(), zmin, zmax, err);
 }
 
 void TriangulateNViewsSolver::solve(const Mat2X& x, const std::vector<Mat34>& Ps, std::vector<robustEstimation::MatrixModel<Vec4>> &X) const
@@ -11,6 +11,9 @@
 #include <aliceVision/numeric/numeric.hpp>
 #include <aliceVision/robustEstimation/ISolver.hpp>
 
+#include <array>
+#include <cassert>
+#include <limits>
 #include <vector>
 
 namespace aliceVision {
@@ -68,6 +71,80 @@ void TriangulateNViewLORANSAC(const Mat2X &x,
                               std::vector<std::size_t> *inliersIndex = NULL,
                               const double & thresholdError = 4.0);                               
 
+/**
+ * @brief Iterated weighted linear triangulation of a point seen by several views.
+ *        Each iteration solves the 3x3 normal equations of the linear system,
+ *        weighted by the inverse of the depths of the previous estimate.
+ * @param[in] nbViews the number of views (>= 2)
+ * @param[in] projMatrix a function returning the projection matrix of the view i
+ * @param[in] point a function returning the image point in the view i
+ * @param[in] iter the number of iterations
+ * @param[in,out] weights an array of nbViews weights, initialized to 1
+ * @param[out] zmin the minimum depth of the point
+ * @param[out] zmax the maximum depth of the point
+ * @param[out] err the sum of the reprojection errors
+ * @return the 3D point
+ */
+template<typename ProjMatrixFunc, typename PointFunc>
+Vec3 triangulateIterative(std::size_t nbViews, const ProjMatrixFunc& projMatrix, const PointFunc& point, int iter,
+                          double* weights, double& zmin, double& zmax, double& err)
+{
+  assert(nbViews >= 2);
+
+  Mat3 AtA;
+  Vec3 Atb, X;
+  for(int it = 0; it < iter; ++it)
+  {
+    AtA.fill(0.0);
+    Atb.fill(0.0);
+    for(std::size_t i = 0; i < nbViews; ++i)
+    {
+      const Mat34& PMat = projMatrix(i);
+      const Vec2& p = point(i);
+      const double w = weights[i];
+
+      Vec3 v1, v2;
+      for(Mat::Index j = 0; j < 3; ++j)
+      {
+        v1[j] = w * (PMat(0, j) - p(0) * PMat(2, j));
+        v2[j] = w * (PMat(1, j) - p(1) * PMat(2, j));
+        Atb[j] += w * (v1[j] * (p(0) * PMat(2, 3) - PMat(0, 3))
+                + v2[j] * (p(1) * PMat(2, 3) - PMat(1, 3)));
+      }
+
+      for(Mat::Index k = 0; k < 3; ++k)
+      {
+        for(Mat::Index j = 0; j <= k; ++j)
+        {
+          const double v = v1[j] * v1[k] + v2[j] * v2[k];
+          AtA(j, k) += v;
+          if(j < k) AtA(k, j) += v;
+        }
+      }
+    }
+
+    X = AtA.inverse() * Atb;
+
+    // Compute reprojection error, min and max depth, and update weights
+    zmin = std::numeric_limits<double>::max();
+    zmax = -std::numeric_limits<double>::max();
+    err = 0;
+    for(std::size_t i = 0; i < nbViews; ++i)
+    {
+      const Mat34& PMat = projMatrix(i);
+      const Vec2& p = point(i);
+      const Vec3 xProj = PMat * Vec4(X(0), X(1), X(2), 1.0);
+      const double z = xProj(2);
+      const Vec2 x = xProj.head<2>() / z;
+      if(z < zmin) zmin = z;
+      if(z > zmax) zmax = z;
+      err += (p - x).norm();
+      weights[i] = 1.0 / z;
+    }
+  }
+  return X;
+}
+
 //Iterated linear method
 
 class Triangulation
@@ -106,6 +183,56 @@ protected:
   std::vector< std::pair<Mat34, Vec2> > views; // Proj matrix and associated image point
 };
 
+/**
+ * @brief Iterated linear method ( same as Triangulation ) for a small number of views,
+ *        without dynamic allocation, to triangulate a large number of short tracks.
+ *        The projection matrices are not copied, they must outlive the computation.
+ * @tparam MaxViews the maximum number of views
+ */
+template<std::size_t MaxViews>
+class TriangulationFixed
+{
+public:
+  EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+
+  std::size_t size() const { return _size; }
+
+  bool full() const { return _size == MaxViews; }
+
+  void clear() { _size = 0; }
+
+  void add(const Mat34& projMatrix, const Vec2& p)
+  {
+    assert(_size < MaxViews);
+    _projMatrices[_size] = &projMatrix;
+    _points[_size] = p;
+    ++_size;
+  }
+
+  Vec3 compute(int iter = 3) const
+  {
+    std::array<double, MaxViews> weights;
+    weights.fill(1.0);
+    return triangulateIterative(_size,
+                                [this](std::size_t i) -> const Mat34& { return *_projMatrices[i]; },
+                                [this](std::size_t i) -> const Vec2& { return _points[i]; },
+                                iter, weights.data(), _zmin, _zmax, _err);
+  }
+
+  // These values are defined after a successful call to compute
+  double minDepth() const { return _zmin; }
+  double maxDepth() const { return _zmax; }
+  double error() const { return _err; }
+
+private:
+  std::size_t _size = 0;
+  std::array<const Mat34*, MaxViews> _projMatrices;
+  std::array<Vec2, MaxViews> _points;
+  mutable double _zmin = 0.0;
+  mutable double _zmax = 0.0;
+  mutable double _err = 0.0;
+};
+
 struct TriangulateNViewsSolver 
 {
 
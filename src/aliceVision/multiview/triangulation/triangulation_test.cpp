@@ -166,6 +166,47 @@ BOOST_AUTO_TEST_CASE(Triangulate_NViewIterative_FiveViews)
   }
 }
 
+BOOST_AUTO_TEST_CASE(Triangulate_NViewIterativeFixed_FiveViews)
+{
+  const int nviews = 5;
+  const int npoints = 6;
+  const NViewDataSet d = NRealisticCamerasRing(nviews, npoints);
+
+  // the projection matrices are referenced by the triangulation object
+  std::vector<Mat34> Ps(nviews);
+  for (int j = 0; j < nviews; ++j)
+    Ps[j] = d.P(j);
+
+  for(int i = 0; i < npoints; ++i)
+  {
+    multiview::Triangulation triangulationObj;
+    multiview::TriangulationFixed<nviews> triangulationFixedObj;
+    for (int j = 0; j < nviews; ++j)
+    {
+      triangulationObj.add(Ps[j], d._x[j].col(i));
+      triangulationFixedObj.add(Ps[j], d._x[j].col(i));
+    }
+    BOOST_CHECK(triangulationFixedObj.full());
+
+    // same iterated linear method: same result as Triangulation
+    const Vec3 X = triangulationObj.compute();
+    const Vec3 XFixed = triangulationFixedObj.compute();
+    BOOST_CHECK_SMALL((X - XFixed).norm(), 1e-12);
+    BOOST_CHECK_CLOSE(triangulationObj.minDepth(), triangulationFixedObj.minDepth(), 1e-9);
+    BOOST_CHECK_CLOSE(triangulationObj.maxDepth(), triangulationFixedObj.maxDepth(), 1e-9);
+    BOOST_CHECK_SMALL(triangulationFixedObj.error(), 1e-9);
+
+    // two views
+    triangulationFixedObj.clear();
+    triangulationFixedObj.add(Ps[0], d._x[0].col(i));
+    triangulationFixedObj.add(Ps[2], d._x[2].col(i));
+    BOOST_CHECK_EQUAL(triangulationFixedObj.size(), 2);
+    const Vec3 XTwoViews = triangulationFixedObj.compute();
+    BOOST_CHECK_SMALL((XTwoViews - d._X.col(i)).norm(), 1e-9);
+    BOOST_CHECK(triangulationFixedObj.minDepth() > 0);
+  }
+}
+
 //// Test triangulation as algebric problem, it generates some random projection
 //// matrices, a random 3D points and its corresponding 2d image points. Some of these
 //// points are considered as outliers. Inliers are assigned a max weight, outliers
@@ -102,6 +102,50 @@ std::istream& operator>>(std::istream& in, EImageQuality& imageQuality)
   return in;
 }
 
+std::string EMapStorage_informations()
+{
+  return "Map storage :\n"
+         "* scanline \n"
+         "* tiled (lossless) \n"
+         "* tiledHalf (half float depths)";
+}
+
+EMapStorage EMapStorage_stringToEnum(const std::string& mapStorage)
+{
+  std::string type = mapStorage;
+  std::transform(type.begin(), type.end(), type.begin(), ::tolower); //tolower
+
+  if(type == "scanline")  return EMapStorage::SCANLINE;
+  if(type == "tiled")     return EMapStorage::TILED;
+  if(type == "tiledhalf") return EMapStorage::TILED_HALF;
+
+  throw std::out_of_range("Invalid map storage : " + mapStorage);
+}
+
+std::string EMapStorage_enumToString(const EMapStorage mapStorage)
+{
+  switch(mapStorage)
+  {
+    case EMapStorage::SCANLINE:    return "scanline";
+    case EMapStorage::TILED:       return "tiled";
+    case EMapStorage::TILED_HALF:  return "tiledHalf";
+  }
+  throw std::out_of_range("Invalid EMapStorage enum");
+}
+
+std::ostream& operator<<(std::ostream& os, EMapStorage mapStorage)
+{
+  return os << EMapStorage_enumToString(mapStorage);
+}
+
+std::istream& operator>>(std::istream& in, EMapStorage& mapStorage)
+{
+  std::string token;
+  in >> token;
+  mapStorage = EMapStorage_stringToEnum(token);
+  return in;
+}
+
 std::string EImageFileType_informations()
 {
   return "Image file type :\n"
@@ -347,6 +391,77 @@ void readImage(const std::string& path, Image& image, EImageColorSpace toColorSp
     image.setHeight(height);
 }
 
+template<typename T>
+void readImageRegion(const std::string& path,
+                     oiio::TypeDesc typeDesc,
+                     int xBegin,
+                     int yBegin,
+                     int regionWidth,
+                     int regionHeight,
+                     std::vector<T>& buffer)
+{
+    ALICEVISION_LOG_DEBUG("[IO] Read Image Region: " << path << " (" << xBegin << ", " << yBegin << ", "
+                          << regionWidth << "x" << regionHeight << ")");
+
+    std::unique_ptr<oiio::ImageInput> in(oiio::ImageInput::open(path));
+
+    if(!in)
+      throw std::runtime_error("Can't find/open image file '" + path + "'.");
+
+    const oiio::ImageSpec& spec = in->spec();
+
+    if(xBegin < 0 || yBegin < 0 || regionWidth <= 0 || regionHeight <= 0 ||
+       xBegin + regionWidth > spec.width || yBegin + regionHeight > spec.height)
+      throw std::runtime_error("Invalid region of image file '" + path + "'.");
+
+    // the region is read in a bigger buffer aligned on the tiles (or on the full scanlines), then cropped
+    int readXBegin = 0;
+    int readXEnd = spec.width;
+    int readYBegin = yBegin;
+    int readYEnd = yBegin + regionHeight;
+    const bool isTiled = (spec.tile_width > 0 && spec.tile_height > 0);
+
+    if(isTiled)
+    {
+      readXBegin = (xBegin / spec.tile_width) * spec.tile_width;
+      readXEnd = std::min(((xBegin + regionWidth + spec.tile_width - 1) / spec.tile_width) * spec.tile_width, spec.width);
+      readYBegin = (yBegin / spec.tile_height) * spec.tile_height;
+      readYEnd = std::min(((yBegin + regionHeight + spec.tile_height - 1) / spec.tile_height) * spec.tile_height, spec.height);
+    }
+
+    const int readWidth = readXEnd - readXBegin;
+    std::vector<T> readBuffer(std::size_t(readWidth) * std::size_t(readYEnd - readYBegin));
+
+    // only the first channel is read
+    const bool success = isTiled ?
+          in->read_tiles(spec.x + readXBegin, spec.x + readXEnd, spec.y + readYBegin, spec.y + readYEnd,
+                         spec.z, spec.z + std::max(spec.tile_depth, 1), 0, 1, typeDesc, readBuffer.data()) :
+          in->read_scanlines(spec.y + readYBegin, spec.y + readYEnd, spec.z, 0, 1, typeDesc, readBuffer.data());
+
+    if(!success)
+      throw std::runtime_error("Can't read region of image file '" + path + "': " + in->geterror());
+
+    in->close();
+
+    buffer.resize(std::size_t(regionWidth) * std::size_t(regionHeight));
+
+    for(int y = 0; y < regionHeight; ++y)
+    {
+      const T* readRow = readBuffer.data() + std::size_t(y + yBegin - readYBegin) * readWidth + (xBegin - readXBegin);
+      std::copy(readRow, readRow + regionWidth, buffer.data() + std::size_t(y) * regionWidth);
+    }
+}
+
+void readImageRegion(const std::string& path, int xBegin, int yBegin, int regionWidth, int regionHeight, std::vector<unsigned char>& buffer)
+{
+    readImageRegion(path, oiio::TypeDesc::UCHAR, xBegin, yBegin, regionWidth, regionHeight, buffer);
+}
+
+void readImageRegion(const std::string& path, int xBegin, int yBegin, int regionWidth, int regionHeight, std::vector<float>& buffer)
+{
+    readImageRegion(path, oiio::TypeDesc::FLOAT, xBegin, yBegin, regionWidth, regionHeight, buffer);
+}
+
 template<typename T>
 void writeImage(const std::string& path,
                 oiio::TypeDesc typeDesc,
@@ -356,7 +471,8 @@ void writeImage(const std::string& path,
                 const std::vector<T>& buffer,
                 EImageQuality imageQuality,
                 OutputFileColorSpace colorspace,
-                const oiio::ParamValueList& metadata)
+                const oiio::ParamValueList& metadata,
+                int tileSize = 0)
 {
     const fs::path bPath = fs::path(path);
     const std::string extension = bPath.extension().string();
@@ -387,12 +503,19 @@ void writeImage(const std::string& path,
     imageSpec.attribute("CompressionQuality", 100);             // if possible, best compression quality
     imageSpec.attribute("compression", isEXR ? "piz" : "none"); // if possible, set compression (piz for EXR, none for the other)
 
+    if(isEXR && tileSize > 0)
+    {
+      // tiles can be read independently, zip is lossless and cheaper to decode than piz for small blocks
+      imageSpec.tile_width = tileSize;
+      imageSpec.tile_height = tileSize;
+      imageSpec.attribute("compression", "zip");
+    }
+
     const oiio::ImageBuf imgBuf = oiio::ImageBuf(imageSpec, const_cast<T*>(buffer.data())); // original image buffer
-    const oiio::ImageBuf* outBuf = &imgBuf;  // buffer to write
 
     oiio::ImageBuf colorspaceBuf;  // buffer for image colorspace modification
-    imageAlgo::colorconvert(colorspaceBuf, *outBuf, colorspace.from, colorspace.to);
-    outBuf = &colorspaceBuf;
+    imageAlgo::colorconvert(colorspaceBuf, imgBuf, colorspace.from, colorspace.to);
+    oiio::ImageBuf* outBuf = &colorspaceBuf;  // buffer to write
 
     oiio::ImageBuf formatBuf; // buffer for image format modification
     if(imageQuality == EImageQuality::OPTIMIZED && isEXR)
@@ -401,6 +524,10 @@ void writeImage(const std::string& path,
       outBuf = &formatBuf;
     }
 
+    // the tiles of the spec are ignored by ImageBuf::write, which writes scanlines unless asked otherwise
+    if(isEXR && tileSize > 0)
+      outBuf->set_write_tiles(tileSize, tileSize);
+
     // write image
     if(!outBuf->write(tmpPath))
       throw std::runtime_error("Can't write output image file '" + path + "'.");
@@ -439,5 +566,34 @@ void writeImage(const std::string &path, Image &image, EImageQuality imageQualit
     writeImage(path, oiio::TypeDesc::FLOAT, image.width(), image.height(), 3, image.data(), imageQuality, colorspace, metadata);
 }
 
+template<typename T>
+void writeMap(const std::string& path,
+              oiio::TypeDesc typeDesc,
+              int width,
+              int height,
+              const std::vector<T>& buffer,
+              EImageQuality imageQuality,
+              EMapStorage mapStorage,
+              const oiio::ParamValueList& metadata)
+{
+    // 64x64 tiles: a 4 Mpx map has ~1000 tiles, small enough to read only the needed ones
+    const int tileSize = (mapStorage == EMapStorage::SCANLINE) ? 0 : 64;
+
+    if(mapStorage == EMapStorage::TILED_HALF)
+      imageQuality = EImageQuality::OPTIMIZED;
+
+    writeImage(path, typeDesc, width, height, 1, buffer, imageQuality, OutputFileColorSpace(EImageColorSpace::NO_CONVERSION), metadata, tileSize);
+}
+
+void writeMap(const std::string& path, int width, int height, const std::vector<unsigned char>& buffer, EImageQuality imageQuality, EMapStorage mapStorage, const oiio::ParamValueList& metadata)
+{
+    writeMap(path, oiio::TypeDesc::UCHAR, width, height, buffer, imageQuality, mapStorage, metadata);
+}
+
+void writeMap(const std::string& path, int width, int height, const std::vector<float>& buffer, EImageQuality imageQuality, EMapStorage mapStorage, const oiio::ParamValueList& metadata)
+{
+    writeMap(path, oiio::TypeDesc::FLOAT, width, height, buffer, imageQuality, mapStorage, metadata);
+}
+
 } // namespace imageIO
 } // namespace aliceVision
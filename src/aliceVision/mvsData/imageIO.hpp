@@ -75,6 +75,16 @@ enum class EImageQuality
   LOSSLESS
 };
 
+/**
+ * @brief Available storages of the single channel maps (depth, similarity) in EXR files
+ */
+enum class EMapStorage
+{
+  SCANLINE,   //< scanlines with piz compression, the maps are read as a whole
+  TILED,      //< tiles with zip compression, which can be read by regions
+  TILED_HALF  //< tiles with zip compression, the depth maps are also stored as half floats
+};
+
 std::string EImageColorSpace_enumToString(const EImageColorSpace colorSpace);
 EImageColorSpace EImageColorSpace_stringToEnum(const std::string& colorspace);
 
@@ -114,6 +124,42 @@ std::ostream& operator<<(std::ostream& os, EImageQuality imageQuality);
  */
 std::istream& operator>>(std::istream& in, EImageQuality& imageQuality);
 
+/**
+ * @brief get informations about each map storage
+ * @return String
+ */
+std::string EMapStorage_informations();
+
+/**
+ * @brief returns the EMapStorage enum from a string.
+ * @param[in] mapStorage the input string.
+ * @return the associated EMapStorage enum.
+ */
+EMapStorage EMapStorage_stringToEnum(const std::string& mapStorage);
+
+/**
+ * @brief converts an EMapStorage enum to a string.
+ * @param[in] mapStorage the EMapStorage enum to convert.
+ * @return the string associated to the EMapStorage enum.
+ */
+std::string EMapStorage_enumToString(const EMapStorage mapStorage);
+
+/**
+ * @brief write an EMapStorage enum into a stream by converting it to a string.
+ * @param[in] os the stream where to write the mapStorage.
+ * @param[in] mapStorage the EMapStorage enum to write.
+ * @return the modified stream.
+ */
+std::ostream& operator<<(std::ostream& os, EMapStorage mapStorage);
+
+/**
+ * @brief read a EMapStorage enum from a stream.
+ * @param[in] in the stream from which the enum is read.
+ * @param[out] mapStorage the EMapStorage enum read from the stream.
+ * @return the modified stream without the read enum.
+ */
+std::istream& operator>>(std::istream& in, EMapStorage& mapStorage);
+
 /**
  * @brief convert a metadata string map into an oiio::ParamValueList
  * @param[in] metadataMap string map
@@ -195,6 +241,19 @@ void readImage(const std::string& path, int& width, int& height, std::vector<flo
 void readImage(const std::string& path, int& width, int& height, std::vector<Color>& buffer, EImageColorSpace toColorSpace);
 void readImage(const std::string& path, Image& image, EImageColorSpace toColorSpace);
 
+/**
+ * @brief read a region of the first channel of an image, without color conversion
+ *        only the tiles (or the scanlines) covering the region are read from the file
+ * @param[in] path The given path to the image
+ * @param[in] xBegin The first column of the region
+ * @param[in] yBegin The first row of the region
+ * @param[in] regionWidth The region width, the region must be inside the image
+ * @param[in] regionHeight The region height, the region must be inside the image
+ * @param[out] buffer The output region buffer
+ */
+void readImageRegion(const std::string& path, int xBegin, int yBegin, int regionWidth, int regionHeight, std::vector<unsigned char>& buffer);
+void readImageRegion(const std::string& path, int xBegin, int yBegin, int regionWidth, int regionHeight, std::vector<float>& buffer);
+
 /**
  * @brief write an image with a given path and buffer
  * @param[in] path The given path to the image
@@ -209,5 +268,17 @@ void writeImage(const std::string& path, int width, int height, const std::vecto
 void writeImage(const std::string& path, int width, int height, const std::vector<Color>& buffer, EImageQuality imageQuality, OutputFileColorSpace& colorspace, const oiio::ParamValueList& metadata = oiio::ParamValueList());
 void writeImage(const std::string& path, Image& image, EImageQuality imageQuality, OutputFileColorSpace& colorspace, const oiio::ParamValueList& metadata = oiio::ParamValueList());
 
+/**
+ * @brief write a single channel map (depth, similarity) with a given path and buffer, without color conversion
+ * @param[in] path The given path to the map
+ * @param[in] width The input map width
+ * @param[in] height The input map height
+ * @param[in] buffer The input map buffer
+ * @param[in] imageQuality The map quality, overriden by the half float storage
+ * @param[in] mapStorage The map storage, only used for EXR files
+ */
+void writeMap(const std::string& path, int width, int height, const std::vector<unsigned char>& buffer, EImageQuality imageQuality, EMapStorage mapStorage, const oiio::ParamValueList& metadata = oiio::ParamValueList());
+void writeMap(const std::string& path, int width, int height, const std::vector<float>& buffer, EImageQuality imageQuality, EMapStorage mapStorage, const oiio::ParamValueList& metadata = oiio::ParamValueList());
+
 } // namespace imageIO
 } // namespace aliceVision
@@ -0,0 +1,76 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2020 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include <aliceVision/mvsData/imageIO.hpp>
+
+#include <OpenImageIO/imageio.h>
+
+#include <boost/filesystem.hpp>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#define BOOST_TEST_MODULE mvsDataImageIO
+
+#include <boost/test/unit_test.hpp>
+
+using namespace aliceVision;
+using namespace aliceVision::imageIO;
+
+namespace fs = boost::filesystem;
+
+namespace {
+
+/// Write a map with values depending on the pixel position, read back the given region and compare them
+void checkMapRegion(EMapStorage mapStorage, int expectedTileSize)
+{
+    const int width = 150;
+    const int height = 100;
+    std::vector<float> map(width * height);
+    for(int y = 0; y < height; ++y)
+        for(int x = 0; x < width; ++x)
+            map[y * width + x] = static_cast<float>(y * width + x);
+
+    const std::string path = (fs::temp_directory_path() / fs::unique_path("%%%%%%%%_map.exr")).string();
+    writeMap(path, width, height, map, EImageQuality::LOSSLESS, mapStorage);
+
+    {
+        std::unique_ptr<oiio::ImageInput> in(oiio::ImageInput::open(path));
+        BOOST_REQUIRE(in);
+        BOOST_CHECK_EQUAL(in->spec().width, width);
+        BOOST_CHECK_EQUAL(in->spec().height, height);
+        BOOST_CHECK_EQUAL(in->spec().tile_width, expectedTileSize);
+        BOOST_CHECK_EQUAL(in->spec().tile_height, expectedTileSize);
+        in->close();
+    }
+
+    // a region across several tiles, and the last tiles which are partial
+    const int regions[][4] = {{50, 30, 40, 60}, {100, 70, 50, 30}, {0, 0, width, height}};
+    for(const auto& region : regions)
+    {
+        std::vector<float> buffer;
+        readImageRegion(path, region[0], region[1], region[2], region[3], buffer);
+        BOOST_REQUIRE_EQUAL(buffer.size(), std::size_t(region[2] * region[3]));
+        for(int y = 0; y < region[3]; ++y)
+            for(int x = 0; x < region[2]; ++x)
+                BOOST_CHECK_EQUAL(buffer[y * region[2] + x], map[(region[1] + y) * width + region[0] + x]);
+    }
+
+    fs::remove(path);
+}
+
+} // namespace
+
+BOOST_AUTO_TEST_CASE(imageIO_writeMap_tiled)
+{
+    checkMapRegion(EMapStorage::TILED, 64);
+}
+
+BOOST_AUTO_TEST_CASE(imageIO_writeMap_scanline)
+{
+    checkMapRegion(EMapStorage::SCANLINE, 0);
+}
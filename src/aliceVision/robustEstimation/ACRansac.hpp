@@ -18,6 +18,7 @@
 #include <iterator>
 #include <limits>
 #include <numeric>
+#include <random>
 #include <vector>
 
 /**
@@ -130,6 +131,211 @@ inline ErrorIndex bestNFA(int startIndex, //number of point required for estimat
 }
 
 
+/**
+ * @brief Options of the ACRANSAC acceleration
+ */
+struct ACRansacOptions
+{
+  /**
+   * Reject the clearly bad models before computing all their residuals,
+   * with a sequential probability ratio test (SPRT, Wald / Chum and Matas).
+   * Once a meaningful model is found, the residuals of the next models are evaluated
+   * in a random order against its threshold and the evaluation stops when the ratio
+   * of the likelihoods of being a bad and a good model exceeds the SPRT decision threshold.
+   * A good model can be rejected with a low probability, so the result can differ
+   * from the exhaustive evaluation.
+   */
+  bool earlyRejection = false;
+  /// Initial probability of a data point to be consistent with a bad model (SPRT delta),
+  /// re-estimated on the rejected models
+  double sprtDelta = 0.05;
+  /// Cost of the estimation of the models of a sample, in number of residual evaluations (SPRT t_M)
+  double sprtModelCost = 200.0;
+  /**
+   * Number of samples drawn together and whose models are evaluated in parallel.
+   * The results are merged in the drawing order. With more than one hypothesis,
+   * the focused sampling on the best inliers starts at the next batch.
+   */
+  std::size_t nbParallelHypotheses = 1;
+  /// Seed of the generator of the samples and of the SPRT evaluation order,
+  /// when the caller does not give its own generator ( -1 for a random seed )
+  int randomSeed = -1;
+};
+
+/**
+ * @brief Sequential probability ratio test state used to reject the models early
+ */
+class ACRansacSPRT
+{
+public:
+  explicit ACRansacSPRT(const ACRansacOptions& options)
+    : _delta(options.sprtDelta)
+    , _modelCost(options.sprtModelCost)
+  {}
+
+  /// The test is used only once a meaningful model gives the consistency threshold and the inlier ratio
+  bool isActive() const { return _active; }
+
+  double getThreshold() const { return _threshold; }
+
+  /**
+   * @brief Update the test with a new best model
+   * @param[in] threshold The squared error threshold of the model
+   * @param[in] inlierRatio The ratio of inliers of the model (SPRT epsilon)
+   */
+  void setBestModel(double threshold, double inlierRatio)
+  {
+    _threshold = threshold;
+    _epsilon = inlierRatio;
+    update();
+  }
+
+  /**
+   * @brief Re-estimate delta with the residuals tested on a rejected model
+   * @param[in] nbTested The number of tested residuals
+   * @param[in] nbConsistent The number of residuals under the threshold
+   */
+  void addRejectedModel(std::size_t nbTested, std::size_t nbConsistent)
+  {
+    _nbRejectedTested += nbTested;
+    _nbRejectedConsistent += nbConsistent;
+
+    const double delta = std::max(static_cast<double>(_nbRejectedConsistent) / _nbRejectedTested, 1e-4);
+    if(std::abs(delta - _delta) > 0.1 * _delta)
+    {
+      _delta = delta;
+      update();
+    }
+  }
+
+  /**
+   * @brief Evaluate the likelihood ratio on a residual
+   * @param[in] error The squared error of a data point
+   * @param[in,out] lambda The likelihood ratio
+   * @return true if the model must be rejected
+   */
+  bool test(double error, double& lambda) const
+  {
+    lambda *= (error <= _threshold) ? _consistentRatio : _inconsistentRatio;
+    return lambda > _decisionThreshold;
+  }
+
+private:
+  void update()
+  {
+    _active = (_epsilon > _delta) && (_epsilon < 1.0);
+    if(!_active)
+      return;
+
+    _consistentRatio = _delta / _epsilon;
+    _inconsistentRatio = (1.0 - _delta) / (1.0 - _epsilon);
+
+    // decision threshold A: solution of A = t_M * C + 1 + log(A)
+    const double C = (1.0 - _delta) * std::log((1.0 - _delta) / (1.0 - _epsilon)) + _delta * std::log(_delta / _epsilon);
+    const double K = _modelCost * C + 1.0;
+    _decisionThreshold = K;
+    for(int i = 0; i < 10; ++i)
+      _decisionThreshold = K + std::log(_decisionThreshold);
+  }
+
+  double _delta;
+  double _modelCost;
+  double _epsilon = 0.0;
+  double _threshold = 0.0;
+  double _consistentRatio = 1.0;
+  double _inconsistentRatio = 1.0;
+  double _decisionThreshold = std::numeric_limits<double>::infinity();
+  std::size_t _nbRejectedTested = 0;
+  std::size_t _nbRejectedConsistent = 0;
+  bool _active = false;
+};
+
+/**
+ * @brief Evaluation of a model by ACRANSAC
+ */
+struct ACRansacEvaluation
+{
+  /// Rejected by the SPRT before the computation of all the residuals
+  bool rejected = false;
+  /// Number of residuals tested by the SPRT and number of them under the SPRT threshold
+  std::size_t nbTested = 0;
+  std::size_t nbConsistent = 0;
+  /// Number of residuals under the precision upper bound
+  std::size_t nbInliers = 0;
+  /// Best NFA and its number of inliers
+  ErrorIndex best;
+  /// Residuals under the precision upper bound, sorted
+  std::vector<ErrorIndex> sortedResiduals;
+};
+
+/**
+ * @brief Compute the residuals of a model and its best NFA.
+ *        Only the residuals under the precision upper bound are sorted:
+ *        the NFA of the larger residuals is never evaluated.
+ */
+template<typename Kernel>
+void evaluateACRansacModel(const Kernel& kernel,
+                           const typename Kernel::ModelT& model,
+                           double maxThreshold,
+                           double loge0,
+                           const std::vector<float>& logc_n,
+                           const std::vector<float>& logc_k,
+                           const ACRansacSPRT* sprt,
+                           const std::vector<std::size_t>& sprtOrder,
+                           std::vector<double>& residuals,
+                           ACRansacEvaluation& evaluation)
+{
+  const std::size_t sizeSample = kernel.getMinimumNbRequiredSamples();
+  const std::size_t nData = kernel.nbSamples();
+
+  evaluation.rejected = false;
+  evaluation.nbTested = 0;
+  evaluation.nbConsistent = 0;
+  evaluation.best = ErrorIndex(std::numeric_limits<double>::infinity(), sizeSample);
+  evaluation.sortedResiduals.clear();
+  residuals.resize(nData);
+
+  if(sprt != nullptr)
+  {
+    double lambda = 1.0;
+    for(const std::size_t i : sprtOrder)
+    {
+      const double error = kernel.error(i, model);
+      residuals[i] = error;
+      ++evaluation.nbTested;
+      if(error <= sprt->getThreshold())
+        ++evaluation.nbConsistent;
+      if(sprt->test(error, lambda))
+      {
+        evaluation.rejected = true;
+        return;
+      }
+    }
+  }
+  else
+  {
+    kernel.errors(model, residuals);
+  }
+
+  for(std::size_t i = 0; i < nData; ++i)
+  {
+    if(residuals[i] <= maxThreshold)
+      evaluation.sortedResiduals.emplace_back(residuals[i], i);
+  }
+  evaluation.nbInliers = evaluation.sortedResiduals.size();
+  std::sort(evaluation.sortedResiduals.begin(), evaluation.sortedResiduals.end());
+
+  // Most meaningful discrimination inliers/outliers
+  evaluation.best = bestNFA(sizeSample,
+                            kernel.logalpha0(),
+                            evaluation.sortedResiduals,
+                            loge0,
+                            maxThreshold,
+                            logc_n,
+                            logc_k,
+                            kernel.multError());
+}
+
 /**
  * @brief ACRANSAC routine (ErrorThreshold, NFA)
  *
@@ -138,16 +344,22 @@ inline ErrorIndex bestNFA(int startIndex, //number of point required for estimat
  * @param[in] nIter maximum number of consecutive iterations
  * @param[out] model returned model if found
  * @param[in] precision upper bound of the precision (squared error)
+ * @param[in] options early rejection and parallel evaluation of the hypotheses
+ * @param[in,out] randomNumberGenerator generator of the samples and of the SPRT evaluation order
  *
  * @return (errorMax, minNFA)
  */
 template<typename Kernel>
 std::pair<double, double> ACRANSAC(const Kernel& kernel,
                                    std::vector<size_t>& vec_inliers,
-                                   std::size_t nIter = 1024,
-                                   typename Kernel::ModelT* model = nullptr,
-                                   double precision = std::numeric_limits<double>::infinity())
+                                   std::size_t nIter,
+                                   typename Kernel::ModelT* model,
+                                   double precision,
+                                   const ACRansacOptions& options,
+                                   std::mt19937& randomNumberGenerator)
 {
+  using ModelT = typename Kernel::ModelT;
+
   vec_inliers.clear();
 
   const std::size_t sizeSample = kernel.getMinimumNbRequiredSamples();
@@ -159,9 +371,6 @@ std::pair<double, double> ACRANSAC(const Kernel& kernel,
     std::numeric_limits<double>::infinity() :
     precision * kernel.normalizer2()(0,0) * kernel.normalizer2()(0,0);
 
-  std::vector<ErrorIndex> vec_residuals(nData); // [residual,index]
-  std::vector<double> vec_residuals_(nData);
-
   // Possible sampling indices [0,..,nData] (will change in the optimization phase)
   std::vector<size_t> vec_index(nData);
   std::iota(vec_index.begin(), vec_index.end(), 0);
@@ -171,6 +380,26 @@ std::pair<double, double> ACRANSAC(const Kernel& kernel,
   std::vector<float> vec_logc_n, vec_logc_k;
   makelogcombi(sizeSample, nData, vec_logc_k, vec_logc_n);
 
+  // Early rejection: the residuals are tested in a random order
+  ACRansacSPRT sprt(options);
+  std::vector<std::size_t> sprtOrder;
+  if(options.earlyRejection)
+  {
+    sprtOrder = vec_index;
+    std::shuffle(sprtOrder.begin(), sprtOrder.end(), randomNumberGenerator);
+  }
+
+  // Hypotheses evaluated together: one sample and its models per hypothesis
+  struct Hypothesis
+  {
+    std::vector<std::size_t> sample;
+    std::vector<ModelT> models;
+    std::vector<ACRansacEvaluation> evaluations;
+    std::vector<double> residuals;
+  };
+  const std::size_t nbHypotheses = std::max(options.nbParallelHypotheses, std::size_t(1));
+  std::vector<Hypothesis> hypotheses(nbHypotheses);
+
   // Output parameters
   double minNFA = std::numeric_limits<double>::infinity();
   double errorMax = std::numeric_limits<double>::infinity();
@@ -180,100 +409,119 @@ std::pair<double, double> ACRANSAC(const Kernel& kernel,
   nIter -= nIterReserve;
 
   bool bACRansacMode = (precision == std::numeric_limits<double>::infinity());
+  bool stop = false;
 
   // Main estimation loop.
-  for(std::size_t iter = 0; iter < nIter; ++iter)
+  for(std::size_t iterBegin = 0; iterBegin < nIter && !stop; iterBegin += nbHypotheses)
   {
-    std::vector<std::size_t> vec_sample(sizeSample); // Sample indices
-    if (bACRansacMode)
-      uniformSample(sizeSample, vec_index, vec_sample); // Get random sample
-    else
-      uniformSample(sizeSample, nData, vec_sample); // Get random sample
-
-    std::vector<typename Kernel::ModelT> vec_models; // Up to max_models solutions
-    kernel.fit(vec_sample, vec_models);
-
-    // Evaluate models
-    bool better = false;
-    for (std::size_t k = 0; k < vec_models.size(); ++k)
+    const std::size_t nbBatchHypotheses = std::min(nbHypotheses, nIter - iterBegin);
+
+    // Draw the samples in sequence
+    for(std::size_t h = 0; h < nbBatchHypotheses; ++h)
     {
-      // Residuals computation and ordering
-      kernel.errors(vec_models[k], vec_residuals_);
+      std::vector<std::size_t>& vec_sample = hypotheses[h].sample; // Sample indices
+      if (bACRansacMode)
+        uniformSample(sizeSample, vec_index, vec_sample, randomNumberGenerator); // Get random sample
+      else
+        uniformSample(sizeSample, nData, vec_sample, randomNumberGenerator); // Get random sample
+    }
+
+    // Estimate and evaluate the models of the hypotheses
+    const ACRansacSPRT* sprtPtr = (options.earlyRejection && sprt.isActive()) ? &sprt : nullptr;
 
-      if (!bACRansacMode)
+    #pragma omp parallel for schedule(dynamic) if(nbBatchHypotheses > 1)
+    for(int h = 0; h < static_cast<int>(nbBatchHypotheses); ++h)
+    {
+      Hypothesis& hypothesis = hypotheses[h];
+      hypothesis.models.clear(); // Up to max_models solutions
+      kernel.fit(hypothesis.sample, hypothesis.models);
+
+      hypothesis.evaluations.resize(hypothesis.models.size());
+      for(std::size_t k = 0; k < hypothesis.models.size(); ++k)
+        evaluateACRansacModel(kernel, hypothesis.models[k], maxThreshold, loge0, vec_logc_n, vec_logc_k,
+                              sprtPtr, sprtOrder, hypothesis.residuals, hypothesis.evaluations[k]);
+    }
+
+    // Merge the evaluations in the drawing order
+    for(std::size_t h = 0; h < nbBatchHypotheses; ++h)
+    {
+      const std::size_t iter = iterBegin + h;
+      if(iter >= nIter)
+        break;
+
+      const Hypothesis& hypothesis = hypotheses[h];
+
+      // Evaluate models
+      bool better = false;
+      for (std::size_t k = 0; k < hypothesis.models.size(); ++k)
       {
-        unsigned int nInlier = 0;
-        for (std::size_t i = 0; i < nData; ++i)
+        const ACRansacEvaluation& evaluation = hypothesis.evaluations[k];
+
+        if(evaluation.rejected)
         {
-          if (vec_residuals_[i] <= maxThreshold)
-            ++nInlier;
+          sprt.addRejectedModel(evaluation.nbTested, evaluation.nbConsistent);
+          continue;
         }
-        if (nInlier > 2.5 * sizeSample) // does the model is meaningful
-          bACRansacMode = true;
-      }
-      if (bACRansacMode)
-      {
-        for (size_t i = 0; i < nData; ++i)
+
+        if (!bACRansacMode)
         {
-          const double error = vec_residuals_[i];
-          vec_residuals[i] = ErrorIndex(error, i);
+          if (evaluation.nbInliers > 2.5 * sizeSample) // does the model is meaningful
+            bACRansacMode = true;
         }
-        std::sort(vec_residuals.begin(), vec_residuals.end());
-
-        // Most meaningful discrimination inliers/outliers
-        const ErrorIndex best = bestNFA(
-          sizeSample,
-          kernel.logalpha0(),
-          vec_residuals,
-          loge0,
-          maxThreshold,
-          vec_logc_n,
-          vec_logc_k,
-          kernel.multError());
-
-        if (best.first < minNFA /*&& vec_residuals[best.second-1].first < errorMax*/)
+        if (bACRansacMode)
         {
-          // A better model was found
-          better = true;
-          minNFA = best.first;
-          vec_inliers.resize(best.second);
-          for (size_t i=0; i<best.second; ++i)
-            vec_inliers[i] = vec_residuals[i].second;
-          errorMax = vec_residuals[best.second-1].first; // Error threshold
-          if(model) *model = vec_models[k];
-
-          ALICEVISION_LOG_TRACE("  nfa=" << minNFA
-            << " inliers=" << best.second << "/" << nData
-            << " precisionNormalized=" << errorMax
-            << " precision=" << kernel.unormalizeError(errorMax)
-            << " (iter=" << iter
-            << ",sample=" << vec_sample
-            << ")");
-        }
-      } //if(bACRansacMode)
-    } //for(size_t k...
-    
-    // Early exit test -> no meaningful model found after nIterReserve*2 iterations
-    if (!bACRansacMode && iter > nIterReserve*2)
-      break;
-
-    // ACRANSAC optimization: draw samples among best set of inliers so far
-    if (bACRansacMode && ((better && minNFA<0) || (iter+1==nIter && nIterReserve)))
-    {
-      if (vec_inliers.empty())
+          const ErrorIndex& best = evaluation.best;
+
+          if (best.first < minNFA /*&& vec_residuals[best.second-1].first < errorMax*/)
+          {
+            // A better model was found
+            better = true;
+            minNFA = best.first;
+            vec_inliers.resize(best.second);
+            for (size_t i=0; i<best.second; ++i)
+              vec_inliers[i] = evaluation.sortedResiduals[i].second;
+            errorMax = evaluation.sortedResiduals[best.second-1].first; // Error threshold
+            if(model) *model = hypothesis.models[k];
+
+            if(options.earlyRejection && minNFA < 0)
+              sprt.setBestModel(errorMax, static_cast<double>(best.second) / nData);
+
+            ALICEVISION_LOG_TRACE("  nfa=" << minNFA
+              << " inliers=" << best.second << "/" << nData
+              << " precisionNormalized=" << errorMax
+              << " precision=" << kernel.unormalizeError(errorMax)
+              << " (iter=" << iter
+              << ",sample=" << hypothesis.sample
+              << ")");
+          }
+        } //if(bACRansacMode)
+      } //for(size_t k...
+
+      // Early exit test -> no meaningful model found after nIterReserve*2 iterations
+      if (!bACRansacMode && iter > nIterReserve*2)
       {
-        // No model found at all so far
-        ++nIter; // Continue to look for any model, even not meaningful
-        --nIterReserve;
+        stop = true;
+        break;
       }
-      else
+
+      // ACRANSAC optimization: draw samples among best set of inliers so far
+      if (bACRansacMode && ((better && minNFA<0) || (iter+1==nIter && nIterReserve)))
       {
-        // ACRANSAC optimization: draw samples among best set of inliers so far
-        vec_index = vec_inliers;
-        if(nIterReserve)
+        if (vec_inliers.empty())
         {
-          nIter = iter + 1 + nIterReserve;
-          nIterReserve = 0;
+          // No model found at all so far
+          ++nIter; // Continue to look for any model, even not meaningful
+          --nIterReserve;
+        }
+        else
+        {
+          // ACRANSAC optimization: draw samples among best set of inliers so far
+          vec_index = vec_inliers;
+          if(nIterReserve)
+          {
+            nIter = iter + 1 + nIterReserve;
+            nIterReserve = 0;
+          }
         }
       }
     }
@@ -292,5 +540,52 @@ std::pair<double, double> ACRANSAC(const Kernel& kernel,
   return std::make_pair(errorMax, minNFA);
 }
 
+/**
+ * @brief ACRANSAC routine (ErrorThreshold, NFA)
+ *        The samples and the SPRT evaluation order are drawn from a generator seeded with options.randomSeed.
+ *
+ * @param[in] kernel model and metric object
+ * @param[out] vec_inliers points that fit the estimated model
+ * @param[in] nIter maximum number of consecutive iterations
+ * @param[out] model returned model if found
+ * @param[in] precision upper bound of the precision (squared error)
+ * @param[in] options early rejection and parallel evaluation of the hypotheses
+ *
+ * @return (errorMax, minNFA)
+ */
+template<typename Kernel>
+std::pair<double, double> ACRANSAC(const Kernel& kernel,
+                                   std::vector<size_t>& vec_inliers,
+                                   std::size_t nIter,
+                                   typename Kernel::ModelT* model,
+                                   double precision,
+                                   const ACRansacOptions& options)
+{
+  std::mt19937 randomNumberGenerator(options.randomSeed == -1 ? std::random_device()() : options.randomSeed);
+  return ACRANSAC(kernel, vec_inliers, nIter, model, precision, options, randomNumberGenerator);
+}
+
+/**
+ * @brief ACRANSAC routine (ErrorThreshold, NFA)
+ *        Exhaustive and sequential evaluation of the hypotheses.
+ *
+ * @param[in] kernel model and metric object
+ * @param[out] vec_inliers points that fit the estimated model
+ * @param[in] nIter maximum number of consecutive iterations
+ * @param[out] model returned model if found
+ * @param[in] precision upper bound of the precision (squared error)
+ *
+ * @return (errorMax, minNFA)
+ */
+template<typename Kernel>
+std::pair<double, double> ACRANSAC(const Kernel& kernel,
+                                   std::vector<size_t>& vec_inliers,
+                                   std::size_t nIter = 1024,
+                                   typename Kernel::ModelT* model = nullptr,
+                                   double precision = std::numeric_limits<double>::infinity())
+{
+  return ACRANSAC(kernel, vec_inliers, nIter, model, precision, ACRansacOptions());
+}
+
 } // namespace robustEstimation
 } // namespace aliceVision
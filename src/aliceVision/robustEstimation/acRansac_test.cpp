@@ -157,6 +157,67 @@ BOOST_AUTO_TEST_CASE(RansacLineFitter_RealisticCase)
   BOOST_CHECK_SMALL(GTModel(1) - model.getMatrix()[1], 1e-9);
 }
 
+// same as RansacLineFitter_RealisticCase with a larger dataset,
+// the early rejection of the models and the parallel evaluation of the hypotheses
+BOOST_AUTO_TEST_CASE(RansacLineFitter_RealisticCase_EarlyRejectionParallel)
+{
+  const int NbPoints = 1000;
+  const float outlierRatio = .5;
+  Mat2X xy(2, NbPoints);
+
+  Vec2 GTModel; // y = 6.3 x + (-2.0)
+  GTModel << -2.0, 6.3;
+
+  //-- Build the point list according the given model
+  for(Mat::Index i = 0; i < NbPoints; ++i)
+  {
+    xy.col(i) << i, (double) i * GTModel[1] + GTModel[0];
+  }
+
+  //-- Simulate outliers spread in the whole image
+  std::mt19937 gen;
+  std::uniform_real_distribution<> dx(0, NbPoints);
+  std::uniform_real_distribution<> dy(0, 6.3 * NbPoints);
+  const int nbPtToNoise = (int) NbPoints * outlierRatio;
+  for(int i = 0; i < nbPtToNoise; ++i)
+  {
+    xy.col(2 * i) << dx(gen), dy(gen);
+  }
+
+  // The base estimator
+  LineKernel lineKernel(xy, NbPoints, 6.3 * NbPoints);
+
+  ACRansacOptions options;
+  options.earlyRejection = true;
+  options.nbParallelHypotheses = 4;
+
+  std::vector<std::size_t> inliers;
+  robustEstimation::MatrixModel<Vec2> model;
+
+  const std::pair<double, double> ret = ACRANSAC(lineKernel, inliers, 300, &model, std::numeric_limits<double>::infinity(), options);
+
+  BOOST_CHECK(ret.second < 0);
+  BOOST_CHECK(inliers.size() >= std::size_t(NbPoints - nbPtToNoise));
+  BOOST_CHECK_SMALL(GTModel(0) - model.getMatrix()[0], 1e-6);
+  BOOST_CHECK_SMALL(GTModel(1) - model.getMatrix()[1], 1e-9);
+
+  // the samples and the evaluation order only depend on the seed of the generator
+  {
+    std::vector<std::size_t> inliersA, inliersB;
+    robustEstimation::MatrixModel<Vec2> modelA, modelB;
+    std::mt19937 generatorA(42);
+    std::mt19937 generatorB(42);
+
+    const std::pair<double, double> retA = ACRANSAC(lineKernel, inliersA, 300, &modelA, std::numeric_limits<double>::infinity(), options, generatorA);
+    const std::pair<double, double> retB = ACRANSAC(lineKernel, inliersB, 300, &modelB, std::numeric_limits<double>::infinity(), options, generatorB);
+
+    BOOST_CHECK_EQUAL(retA.first, retB.first);
+    BOOST_CHECK_EQUAL(retA.second, retB.second);
+    BOOST_CHECK(inliersA == inliersB);
+    BOOST_CHECK(modelA.getMatrix() == modelB.getMatrix());
+  }
+}
+
 // generate nbPoints along a line and add gaussian noise.
 // move some point in the dataset to create outlier contamined data
 void generateLine(Mat & points, std::size_t nbPoints, int W, int H, float noise, float outlierRatio)
@@ -7,6 +7,7 @@
 
 #include <aliceVision/sfm/BundleAdjustmentCeres.hpp>
 #include <aliceVision/sfm/ResidualErrorFunctor.hpp>
+#include <aliceVision/sfm/ResidualErrorAnalyticFunctor.hpp>
 #include <aliceVision/sfm/ResidualErrorConstraintFunctor.hpp>
 #include <aliceVision/sfm/ResidualErrorRotationPriorFunctor.hpp>
 #include <aliceVision/sfmData/SfMData.hpp>
@@ -18,6 +19,7 @@
 #include <ceres/rotation.h>
 
 #include <fstream>
+#include <limits>
 
 
 
@@ -83,6 +85,60 @@ ceres::CostFunction* createRigCostFunctionFromIntrinsics(const IntrinsicBase* in
   }
 }
 
+/**
+ * @brief Create the appropriate cost function with analytic jacobians according the provided input camera intrinsic model
+ * @param[in] intrinsicPtr The intrinsic pointer
+ * @param[in] observation The corresponding observation
+ * @return cost function
+ */
+ceres::CostFunction* createAnalyticCostFunctionFromIntrinsics(const IntrinsicBase* intrinsicPtr, const sfmData::Observation& observation)
+{
+  switch(intrinsicPtr->getType())
+  {
+    case EINTRINSIC::PINHOLE_CAMERA:
+      return new ResidualErrorAnalyticCostFunction_Pinhole(observation);
+    case EINTRINSIC::PINHOLE_CAMERA_RADIAL1:
+      return new ResidualErrorAnalyticCostFunction_PinholeRadialK1(observation);
+    case EINTRINSIC::PINHOLE_CAMERA_RADIAL3:
+      return new ResidualErrorAnalyticCostFunction_PinholeRadialK3(observation);
+    case EINTRINSIC::PINHOLE_CAMERA_BROWN:
+      return new ResidualErrorAnalyticCostFunction_PinholeBrownT2(observation);
+    case EINTRINSIC::PINHOLE_CAMERA_FISHEYE:
+      return new ResidualErrorAnalyticCostFunction_PinholeFisheye(observation);
+    case EINTRINSIC::PINHOLE_CAMERA_FISHEYE1:
+      return new ResidualErrorAnalyticCostFunction_PinholeFisheye1(observation);
+    default:
+      throw std::logic_error("Cannot create cost function, unrecognized intrinsic type in BA.");
+  }
+}
+
+/**
+ * @brief Create the appropriate cost function with analytic jacobians according the provided input rig camera intrinsic model
+ * @param[in] intrinsicPtr The intrinsic pointer
+ * @param[in] observation The corresponding observation
+ * @return cost function
+ */
+ceres::CostFunction* createAnalyticRigCostFunctionFromIntrinsics(const IntrinsicBase* intrinsicPtr, const sfmData::Observation& observation)
+{
+  switch(intrinsicPtr->getType())
+  {
+    case EINTRINSIC::PINHOLE_CAMERA:
+      return new ResidualErrorRigAnalyticCostFunction_Pinhole(observation);
+    case EINTRINSIC::PINHOLE_CAMERA_RADIAL1:
+      return new ResidualErrorRigAnalyticCostFunction_PinholeRadialK1(observation);
+    case EINTRINSIC::PINHOLE_CAMERA_RADIAL3:
+      return new ResidualErrorRigAnalyticCostFunction_PinholeRadialK3(observation);
+    case EINTRINSIC::PINHOLE_CAMERA_BROWN:
+      return new ResidualErrorRigAnalyticCostFunction_PinholeBrownT2(observation);
+    case EINTRINSIC::PINHOLE_CAMERA_FISHEYE:
+      return new ResidualErrorRigAnalyticCostFunction_PinholeFisheye(observation);
+    case EINTRINSIC::PINHOLE_CAMERA_FISHEYE1:
+      return new ResidualErrorRigAnalyticCostFunction_PinholeFisheye1(observation);
+    default:
+      throw std::logic_error("Cannot create rig cost function, unrecognized intrinsic type in BA.");
+  }
+}
+
 /**
  * @brief Create the appropriate cost functor according the provided input camera intrinsic model
  * @param[in] intrinsicPtr The intrinsic pointer
@@ -266,6 +322,26 @@ void BundleAdjustmentCeres::Statistics::show() const
                         << "\t- final   RMSE: " << RMSEfinal);
 }
 
+/**
+ * @brief Set a pose in a parameter block according to the Ceres format: [Rx, Ry, Rz, tx, ty, tz]
+ * @param[in] pose The pose
+ * @param[out] poseBlock The pose parameter block
+ */
+void setPoseBlock(const geometry::Pose3& pose, std::array<double,6>& poseBlock)
+{
+  const Mat3& R = pose.rotation();
+  const Vec3& t = pose.translation();
+
+  double angleAxis[3];
+  ceres::RotationMatrixToAngleAxis(static_cast<const double *>(R.data()), angleAxis);
+  poseBlock.at(0) = angleAxis[0];
+  poseBlock.at(1) = angleAxis[1];
+  poseBlock.at(2) = angleAxis[2];
+  poseBlock.at(3) = t(0);
+  poseBlock.at(4) = t(1);
+  poseBlock.at(5) = t(2);
+}
+
 void BundleAdjustmentCeres::setSolverOptions(ceres::Solver::Options& solverOptions) const
 {
   solverOptions.preconditioner_type = _ceresOptions.preconditionerType;
@@ -295,17 +371,7 @@ void BundleAdjustmentCeres::addExtrinsicsToProblem(const sfmData::SfMData& sfmDa
 
   const auto addPose = [&](const sfmData::CameraPose& cameraPose, bool isConstant, std::array<double,6>& poseBlock)
   {
-    const Mat3& R = cameraPose.getTransform().rotation();
-    const Vec3& t = cameraPose.getTransform().translation();
-
-    double angleAxis[3];
-    ceres::RotationMatrixToAngleAxis(static_cast<const double *>(R.data()), angleAxis);
-    poseBlock.at(0) = angleAxis[0];
-    poseBlock.at(1) = angleAxis[1];
-    poseBlock.at(2) = angleAxis[2];
-    poseBlock.at(3) = t(0);
-    poseBlock.at(4) = t(1);
-    poseBlock.at(5) = t(2);
+    setPoseBlock(cameraPose.getTransform(), poseBlock);
 
     double* poseBlockPtr = poseBlock.data();
     problem.AddParameterBlock(poseBlockPtr, 6);
@@ -390,13 +456,8 @@ void BundleAdjustmentCeres::addExtrinsicsToProblem(const sfmData::SfMData& sfmDa
   }
 }
 
-void BundleAdjustmentCeres::addIntrinsicsToProblem(const sfmData::SfMData& sfmData, BundleAdjustment::ERefineOptions refineOptions, ceres::Problem& problem)
+std::map<IndexT, std::size_t> BundleAdjustmentCeres::countIntrinsicsUsage(const sfmData::SfMData& sfmData)
 {
-  const bool refineIntrinsicsOpticalCenter = (refineOptions & REFINE_INTRINSICS_OPTICALCENTER_ALWAYS) || (refineOptions & REFINE_INTRINSICS_OPTICALCENTER_IF_ENOUGH_DATA);
-  const bool refineIntrinsicsFocalLength = refineOptions & REFINE_INTRINSICS_FOCAL;
-  const bool refineIntrinsicsDistortion = refineOptions & REFINE_INTRINSICS_DISTORTION;
-  const bool refineIntrinsics = refineIntrinsicsDistortion || refineIntrinsicsFocalLength || refineIntrinsicsOpticalCenter;
-
   std::map<IndexT, std::size_t> intrinsicsUsage;
 
   // count the number of reconstructed views per intrinsic
@@ -410,6 +471,82 @@ void BundleAdjustmentCeres::addIntrinsicsToProblem(const sfmData::SfMData& sfmDa
     if(sfmData.isPoseAndIntrinsicDefined(&view))
       ++intrinsicsUsage.at(view.getIntrinsicId());
   }
+  return intrinsicsUsage;
+}
+
+void BundleAdjustmentCeres::getIntrinsicParameterization(const IntrinsicBase& intrinsic,
+                                                         std::size_t usageCount,
+                                                         ERefineOptions refineOptions,
+                                                         IntrinsicParameterization& parameterization)
+{
+  const bool refineIntrinsicsOpticalCenter = (refineOptions & REFINE_INTRINSICS_OPTICALCENTER_ALWAYS) || (refineOptions & REFINE_INTRINSICS_OPTICALCENTER_IF_ENOUGH_DATA);
+  const bool refineIntrinsicsFocalLength = refineOptions & REFINE_INTRINSICS_FOCAL;
+  const bool refineIntrinsicsDistortion = refineOptions & REFINE_INTRINSICS_DISTORTION;
+  const std::size_t nbParams = intrinsic.getParams().size();
+
+  parameterization.constantParams.clear();
+  parameterization.bounds.clear();
+
+  // refine the focal length
+  if(refineIntrinsicsFocalLength)
+  {
+    if(intrinsic.initialFocalLengthPix() > 0)
+    {
+      // if we have an initial guess, we only authorize a margin around this value.
+      assert(nbParams >= 1);
+      const unsigned int maxFocalError = 0.2 * std::max(intrinsic.w(), intrinsic.h()); // TODO : check if rounding is needed
+      parameterization.bounds.push_back({0, static_cast<double>(intrinsic.initialFocalLengthPix() - maxFocalError),
+                                            static_cast<double>(intrinsic.initialFocalLengthPix() + maxFocalError)});
+    }
+    else // no initial guess
+    {
+      // we don't have an initial guess, but we assume that we use
+      // a converging lens, so the focal length should be positive.
+      parameterization.bounds.push_back({0, 0.0, std::numeric_limits<double>::max()});
+    }
+  }
+  else
+  {
+    // set focal length as constant
+    parameterization.constantParams.push_back(0);
+  }
+
+  const std::size_t minImagesForOpticalCenter = 3;
+
+  // optical center
+  if(refineIntrinsicsOpticalCenter && (usageCount > minImagesForOpticalCenter))
+  {
+    // refine optical center within 10% of the image size.
+    assert(nbParams >= 3);
+
+    const double opticalCenterMinPercent = 0.45;
+    const double opticalCenterMaxPercent = 0.55;
+
+    // add bounds to the principal point
+    parameterization.bounds.push_back({1, opticalCenterMinPercent * intrinsic.w(), opticalCenterMaxPercent * intrinsic.w()});
+    parameterization.bounds.push_back({2, opticalCenterMinPercent * intrinsic.h(), opticalCenterMaxPercent * intrinsic.h()});
+  }
+  else
+  {
+    // don't refine the optical center
+    parameterization.constantParams.push_back(1);
+    parameterization.constantParams.push_back(2);
+  }
+
+  // lens distortion
+  if(!refineIntrinsicsDistortion)
+    for(std::size_t i = 3; i < nbParams; ++i)
+      parameterization.constantParams.push_back(i);
+}
+
+void BundleAdjustmentCeres::addIntrinsicsToProblem(const sfmData::SfMData& sfmData, BundleAdjustment::ERefineOptions refineOptions, ceres::Problem& problem)
+{
+  const bool refineIntrinsicsOpticalCenter = (refineOptions & REFINE_INTRINSICS_OPTICALCENTER_ALWAYS) || (refineOptions & REFINE_INTRINSICS_OPTICALCENTER_IF_ENOUGH_DATA);
+  const bool refineIntrinsicsFocalLength = refineOptions & REFINE_INTRINSICS_FOCAL;
+  const bool refineIntrinsicsDistortion = refineOptions & REFINE_INTRINSICS_DISTORTION;
+  const bool refineIntrinsics = refineIntrinsicsDistortion || refineIntrinsicsFocalLength || refineIntrinsicsOpticalCenter;
+
+  const std::map<IndexT, std::size_t> intrinsicsUsage = countIntrinsicsUsage(sfmData);
 
   for(const auto& intrinsicPair: sfmData.getIntrinsics())
   {
@@ -448,80 +585,75 @@ void BundleAdjustmentCeres::addIntrinsicsToProblem(const sfmData::SfMData& sfmDa
       continue;
     }
 
-    // constant parameters
-    std::vector<int> constantIntrinisc;
+    IntrinsicParameterization parameterization;
+    getIntrinsicParameterization(*intrinsicPtr, usageCount, refineOptions, parameterization);
 
-    // refine the focal length
-    if(refineIntrinsicsFocalLength)
+    for(const IntrinsicParameterization::Bound& bound : parameterization.bounds)
     {
-      if(intrinsicPtr->initialFocalLengthPix() > 0)
-      {
-        // if we have an initial guess, we only authorize a margin around this value.
-        assert(intrinsicBlock.size() >= 1);
-        const unsigned int maxFocalError = 0.2 * std::max(intrinsicPtr->w(), intrinsicPtr->h()); // TODO : check if rounding is needed
-        problem.SetParameterLowerBound(intrinsicBlockPtr, 0, static_cast<double>(intrinsicPtr->initialFocalLengthPix() - maxFocalError));
-        problem.SetParameterUpperBound(intrinsicBlockPtr, 0, static_cast<double>(intrinsicPtr->initialFocalLengthPix() + maxFocalError));
-      }
-      else // no initial guess
-      {
-        // we don't have an initial guess, but we assume that we use
-        // a converging lens, so the focal length should be positive.
-        problem.SetParameterLowerBound(intrinsicBlockPtr, 0, 0.0);
-      }
+      problem.SetParameterLowerBound(intrinsicBlockPtr, bound.index, bound.lower);
+      problem.SetParameterUpperBound(intrinsicBlockPtr, bound.index, bound.upper);
     }
-    else
+
+    // constant parameters
+    if(!parameterization.constantParams.empty())
     {
-      // set focal length as constant
-      constantIntrinisc.push_back(0);
+      ceres::SubsetParameterization* subsetParameterization = new ceres::SubsetParameterization(intrinsicBlock.size(), parameterization.constantParams);
+      problem.SetParameterization(intrinsicBlockPtr, subsetParameterization);
     }
 
-    const std::size_t minImagesForOpticalCenter = 3;
-
-    // optical center
-    if(refineIntrinsicsOpticalCenter && (usageCount > minImagesForOpticalCenter))
-    {
-      // refine optical center within 10% of the image size.
-      assert(intrinsicBlock.size() >= 3);
+    _statistics.addState(EParameter::INTRINSIC, EParameterState::REFINED);
+  }
+}
 
-      const double opticalCenterMinPercent = 0.45;
-      const double opticalCenterMaxPercent = 0.55;
+ceres::ResidualBlockId BundleAdjustmentCeres::addObservationToProblem(const sfmData::SfMData& sfmData,
+                                                                      const sfmData::View& view,
+                                                                      const sfmData::Observation& observation,
+                                                                      double* landmarkBlockPtr,
+                                                                      ceres::Problem& problem)
+{
+  // set a LossFunction to be less penalized by false measurements.
+  // note: set it to NULL if you don't want use a lossFunction.
+  ceres::LossFunction* lossFunction = _ceresOptions.lossFunction.get();
 
-      // add bounds to the principal point
-      problem.SetParameterLowerBound(intrinsicBlockPtr, 1, opticalCenterMinPercent * intrinsicPtr->w());
-      problem.SetParameterUpperBound(intrinsicBlockPtr, 1, opticalCenterMaxPercent * intrinsicPtr->w());
-      problem.SetParameterLowerBound(intrinsicBlockPtr, 2, opticalCenterMinPercent * intrinsicPtr->h());
-      problem.SetParameterUpperBound(intrinsicBlockPtr, 2, opticalCenterMaxPercent * intrinsicPtr->h());
-    }
-    else
-    {
-      // don't refine the optical center
-      constantIntrinisc.push_back(1);
-      constantIntrinisc.push_back(2);
-    }
+  // each residual block takes a point and a camera as input and outputs a 2
+  // dimensional residual. Internally, the cost function stores the observed
+  // image location and compares the reprojection against the observation.
 
-    // lens distortion
-    if(!refineIntrinsicsDistortion)
-      for(std::size_t i = 3; i < intrinsicBlock.size(); ++i)
-        constantIntrinisc.push_back(i);
+  assert(getPoseState(view.getPoseId()) != EParameterState::IGNORED);
+  assert(getIntrinsicState(view.getIntrinsicId()) != EParameterState::IGNORED);
 
-    if(!constantIntrinisc.empty())
-    {
-      ceres::SubsetParameterization* subsetParameterization = new ceres::SubsetParameterization(intrinsicBlock.size(), constantIntrinisc);
-      problem.SetParameterization(intrinsicBlockPtr, subsetParameterization);
-    }
+  // needed parameters to create a residual block (K, pose)
+  double* poseBlockPtr = _posesBlocks.at(view.getPoseId()).data();
+  double* intrinsicBlockPtr = _intrinsicsBlocks.at(view.getIntrinsicId()).data();
+  const IntrinsicBase* intrinsicPtr = sfmData.getIntrinsicPtr(view.getIntrinsicId());
 
-    _statistics.addState(EParameter::INTRINSIC, EParameterState::REFINED);
+  if(view.isPartOfRig() && !view.isPoseIndependant())
+  {
+    ceres::CostFunction* costFunction = _ceresOptions.useAnalyticJacobians ? createAnalyticRigCostFunctionFromIntrinsics(intrinsicPtr, observation)
+                                                                           : createRigCostFunctionFromIntrinsics(intrinsicPtr, observation);
+
+    return problem.AddResidualBlock(costFunction,
+        lossFunction,
+        intrinsicBlockPtr,
+        poseBlockPtr,
+        _rigBlocks.at(view.getRigId()).at(view.getSubPoseId()).data(), // subpose of the cameras rig
+        landmarkBlockPtr); // do we need to copy 3D point to avoid false motion, if failure ?
   }
+
+  ceres::CostFunction* costFunction = _ceresOptions.useAnalyticJacobians ? createAnalyticCostFunctionFromIntrinsics(intrinsicPtr, observation)
+                                                                         : createCostFunctionFromIntrinsics(intrinsicPtr, observation);
+
+  return problem.AddResidualBlock(costFunction,
+      lossFunction,
+      intrinsicBlockPtr,
+      poseBlockPtr,
+      landmarkBlockPtr); //do we need to copy 3D point to avoid false motion, if failure ?
 }
 
 void BundleAdjustmentCeres::addLandmarksToProblem(const sfmData::SfMData& sfmData, ERefineOptions refineOptions, ceres::Problem& problem)
 {
   const bool refineStructure = refineOptions & REFINE_STRUCTURE;
 
-  // set a LossFunction to be less penalized by false measurements.
-  // note: set it to NULL if you don't want use a lossFunction.
-  ceres::LossFunction* lossFunction = _ceresOptions.lossFunction.get();
-
   // build the residual blocks corresponding to the track observations
   for(const auto& landmarkPair: sfmData.getLandmarks())
   {
@@ -551,46 +683,15 @@ void BundleAdjustmentCeres::addLandmarksToProblem(const sfmData::SfMData& sfmDat
       const sfmData::View& view = sfmData.getView(observationPair.first);
       const sfmData::Observation& observation = observationPair.second;
 
-      // each residual block takes a point and a camera as input and outputs a 2
-      // dimensional residual. Internally, the cost function stores the observed
-      // image location and compares the reprojection against the observation.
-
-      assert(getPoseState(view.getPoseId()) != EParameterState::IGNORED);
-      assert(getIntrinsicState(view.getIntrinsicId()) != EParameterState::IGNORED);
-
-      // needed parameters to create a residual block (K, pose)
-      double* poseBlockPtr = _posesBlocks.at(view.getPoseId()).data();
-      double* intrinsicBlockPtr = _intrinsicsBlocks.at(view.getIntrinsicId()).data();
-
       // apply a specific parameter ordering:
       if(_ceresOptions.useParametersOrdering)
       {
         _ceresOptions.linearSolverOrdering.AddElementToGroup(landmarkBlockPtr, 0);
-        _ceresOptions.linearSolverOrdering.AddElementToGroup(poseBlockPtr, 1);
-        _ceresOptions.linearSolverOrdering.AddElementToGroup(intrinsicBlockPtr, 2);
+        _ceresOptions.linearSolverOrdering.AddElementToGroup(_posesBlocks.at(view.getPoseId()).data(), 1);
+        _ceresOptions.linearSolverOrdering.AddElementToGroup(_intrinsicsBlocks.at(view.getIntrinsicId()).data(), 2);
       }
 
-      if(view.isPartOfRig() && !view.isPoseIndependant())
-      {
-        ceres::CostFunction* costFunction = createRigCostFunctionFromIntrinsics(sfmData.getIntrinsicPtr(view.getIntrinsicId()), observation);
-
-        problem.AddResidualBlock(costFunction,
-            lossFunction,
-            intrinsicBlockPtr,
-            poseBlockPtr,
-            _rigBlocks.at(view.getRigId()).at(view.getSubPoseId()).data(), // subpose of the cameras rig
-            landmarkBlockPtr); // do we need to copy 3D point to avoid false motion, if failure ?
-      }
-      else
-      {
-        ceres::CostFunction* costFunction = createCostFunctionFromIntrinsics(sfmData.getIntrinsicPtr(view.getIntrinsicId()), observation);
-
-        problem.AddResidualBlock(costFunction,
-            lossFunction,
-            intrinsicBlockPtr,
-            poseBlockPtr,
-            landmarkBlockPtr); //do we need to copy 3D point to avoid false motion, if failure ?
-      }
+      addObservationToProblem(sfmData, view, observation, landmarkBlockPtr, problem);
 
       if(!refineStructure || getLandmarkState(landmarkId) == EParameterState::CONSTANT)
       {
@@ -631,7 +732,7 @@ void BundleAdjustmentCeres::addConstraints2DToProblem(const sfmData::SfMData& sf
     assert(intrinsicBlockPtr_1 == intrinsicBlockPtr_2);
 
     ceres::CostFunction* costFunction = createConstraintsCostFunctionFromIntrinsics(sfmData.getIntrinsicPtr(view_1.getIntrinsicId()), constraint.ObservationFirst.x, constraint.ObservationSecond.x);
-    problem.AddResidualBlock(costFunction, lossFunction, intrinsicBlockPtr_1, poseBlockPtr_1, poseBlockPtr_2);
+    _otherResidualBlocks.push_back(problem.AddResidualBlock(costFunction, lossFunction, intrinsicBlockPtr_1, poseBlockPtr_1, poseBlockPtr_2));
   }
 }
 
@@ -653,7 +754,7 @@ void BundleAdjustmentCeres::addRotationPriorsToProblem(const sfmData::SfMData& s
 
 
     ceres::CostFunction* costFunction = new ceres::AutoDiffCostFunction<ResidualErrorRotationPriorFunctor, 3, 6, 6>(new ResidualErrorRotationPriorFunctor(prior._second_R_first));
-    problem.AddResidualBlock(costFunction, lossFunction, poseBlockPtr_1, poseBlockPtr_2);
+    _otherResidualBlocks.push_back(problem.AddResidualBlock(costFunction, lossFunction, poseBlockPtr_1, poseBlockPtr_2));
   }
 }
 
@@ -684,6 +785,382 @@ void BundleAdjustmentCeres::createProblem(const sfmData::SfMData& sfmData,
   addRotationPriorsToProblem(sfmData, refineOptions, problem);
 }
 
+void BundleAdjustmentCeres::updatePersistentProblem(const sfmData::SfMData& sfmData, ERefineOptions refineOptions)
+{
+  // ensure we are not using incompatible options
+  // REFINEINTRINSICS_OPTICALCENTER_ALWAYS and REFINEINTRINSICS_OPTICALCENTER_IF_ENOUGH_DATA cannot be used at the same time
+  assert(!((refineOptions & REFINE_INTRINSICS_OPTICALCENTER_ALWAYS) && (refineOptions & REFINE_INTRINSICS_OPTICALCENTER_IF_ENOUGH_DATA)));
+
+  const bool refineTranslation = refineOptions & REFINE_TRANSLATION;
+  const bool refineRotation = refineOptions & REFINE_ROTATION;
+  const bool refineIntrinsics = (refineOptions & REFINE_INTRINSICS_FOCAL) ||
+                                (refineOptions & REFINE_INTRINSICS_DISTORTION) ||
+                                (refineOptions & REFINE_INTRINSICS_OPTICALCENTER_ALWAYS) ||
+                                (refineOptions & REFINE_INTRINSICS_OPTICALCENTER_IF_ENOUGH_DATA);
+  const bool refineStructure = refineOptions & REFINE_STRUCTURE;
+
+  const std::map<IndexT, std::size_t> intrinsicsUsage = countIntrinsicsUsage(sfmData);
+
+  // the local parameterization of a parameter block cannot be replaced,
+  // so the problem is created from scratch if the parameterization of a block changes
+  if(_problem != nullptr)
+  {
+    bool isCompatible = (refineOptions == _problemRefineOptions) &&
+                        (_ceresOptions.lossFunction == _problemLossFunction) &&
+                        (_ceresOptions.useAnalyticJacobians == _problemUseAnalyticJacobians);
+
+    for(auto it = _intrinsicsConstantParams.begin(); isCompatible && it != _intrinsicsConstantParams.end(); ++it)
+    {
+      const auto intrinsicIt = sfmData.getIntrinsics().find(it->first);
+      const auto usageIt = intrinsicsUsage.find(it->first);
+
+      // removed intrinsics are handled below
+      if(intrinsicIt == sfmData.getIntrinsics().end() || usageIt == intrinsicsUsage.end())
+        continue;
+
+      IntrinsicParameterization parameterization;
+      getIntrinsicParameterization(*intrinsicIt->second, usageIt->second, refineOptions, parameterization);
+      isCompatible = (parameterization.constantParams == it->second);
+    }
+
+    if(!isCompatible)
+    {
+      ALICEVISION_LOG_DEBUG("Bundle adjustment: the persistent problem is created from scratch.");
+      resetProblem();
+    }
+  }
+
+  if(_problem == nullptr)
+  {
+    ceres::Problem::Options problemOptions;
+    problemOptions.loss_function_ownership = ceres::DO_NOT_TAKE_OWNERSHIP;
+    problemOptions.enable_fast_removal = true;
+    _problem.reset(new ceres::Problem(problemOptions));
+    _problemRefineOptions = refineOptions;
+    _problemLossFunction = _ceresOptions.lossFunction;
+    _problemUseAnalyticJacobians = _ceresOptions.useAnalyticJacobians;
+  }
+
+  ceres::Problem& problem = *_problem;
+
+  _statistics = Statistics();
+  _allParametersBlocks.clear();
+
+  // 2D constraints and rotation priors are few, they are always created again
+  for(ceres::ResidualBlockId residualBlockId : _otherResidualBlocks)
+    problem.RemoveResidualBlock(residualBlockId);
+  _otherResidualBlocks.clear();
+
+  // poses and rig sub-poses: the subset parameterization only depends on the refine options
+  std::vector<int> constantExtrinsic;
+  if(!refineRotation)
+    constantExtrinsic.insert(constantExtrinsic.end(), {0, 1, 2});
+  if(!refineTranslation)
+    constantExtrinsic.insert(constantExtrinsic.end(), {3, 4, 5});
+
+  const auto updatePose = [&](const sfmData::CameraPose& cameraPose, bool isConstant, bool isNew, std::array<double,6>& poseBlock)
+  {
+    setPoseBlock(cameraPose.getTransform(), poseBlock);
+
+    double* poseBlockPtr = poseBlock.data();
+
+    if(isNew)
+    {
+      problem.AddParameterBlock(poseBlockPtr, 6);
+      if(!constantExtrinsic.empty() && constantExtrinsic.size() < 6)
+        problem.SetParameterization(poseBlockPtr, new ceres::SubsetParameterization(6, constantExtrinsic));
+    }
+
+    _allParametersBlocks.push_back(poseBlockPtr);
+
+    if(cameraPose.isLocked() || isConstant || constantExtrinsic.size() == 6)
+    {
+      _statistics.addState(EParameter::POSE, EParameterState::CONSTANT);
+      problem.SetParameterBlockConstant(poseBlockPtr);
+    }
+    else
+    {
+      _statistics.addState(EParameter::POSE, EParameterState::REFINED);
+      problem.SetParameterBlockVariable(poseBlockPtr);
+    }
+  };
+
+  for(const auto& posePair : sfmData.getPoses())
+  {
+    const IndexT poseId = posePair.first;
+
+    if(getPoseState(poseId) == EParameterState::IGNORED)
+    {
+      _statistics.addState(EParameter::POSE, EParameterState::IGNORED);
+      continue;
+    }
+
+    auto blockIt = _posesBlocks.find(poseId);
+    const bool isNew = (blockIt == _posesBlocks.end());
+    if(isNew)
+      blockIt = _posesBlocks.emplace(poseId, std::array<double,6>()).first;
+
+    updatePose(posePair.second, getPoseState(poseId) == EParameterState::CONSTANT, isNew, blockIt->second);
+  }
+
+  for(const auto& rigPair : sfmData.getRigs())
+  {
+    const sfmData::Rig& rig = rigPair.second;
+    HashMap<IndexT, std::array<double,6>>& subPosesBlocks = _rigBlocks[rigPair.first];
+
+    for(std::size_t subPoseId = 0 ; subPoseId < rig.getNbSubPoses(); ++subPoseId)
+    {
+      const sfmData::RigSubPose& rigSubPose = rig.getSubPose(subPoseId);
+
+      if(rigSubPose.status == sfmData::ERigSubPoseStatus::UNINITIALIZED)
+        continue;
+
+      auto blockIt = subPosesBlocks.find(subPoseId);
+      const bool isNew = (blockIt == subPosesBlocks.end());
+      if(isNew)
+        blockIt = subPosesBlocks.emplace(subPoseId, std::array<double,6>()).first;
+
+      updatePose(sfmData::CameraPose(rigSubPose.pose), rigSubPose.status == sfmData::ERigSubPoseStatus::CONSTANT, isNew, blockIt->second);
+    }
+  }
+
+  // intrinsics
+  for(const auto& intrinsicPair: sfmData.getIntrinsics())
+  {
+    const IndexT intrinsicId = intrinsicPair.first;
+    const auto& intrinsicPtr = intrinsicPair.second;
+    const auto usageIt = intrinsicsUsage.find(intrinsicId);
+
+    if(usageIt == intrinsicsUsage.end())
+      continue;
+
+    if(usageIt->second <= 0 || getIntrinsicState(intrinsicId) == EParameterState::IGNORED)
+    {
+      _statistics.addState(EParameter::INTRINSIC, EParameterState::IGNORED);
+      continue;
+    }
+
+    assert(isValid(intrinsicPtr->getType()));
+
+    IntrinsicParameterization parameterization;
+    getIntrinsicParameterization(*intrinsicPtr, usageIt->second, refineOptions, parameterization);
+
+    auto blockIt = _intrinsicsBlocks.find(intrinsicId);
+    const bool isNew = (blockIt == _intrinsicsBlocks.end());
+    if(isNew)
+      blockIt = _intrinsicsBlocks.emplace(intrinsicId, intrinsicPtr->getParams()).first;
+    else
+      blockIt->second = intrinsicPtr->getParams(); // same size, the block memory is kept
+
+    std::vector<double>& intrinsicBlock = blockIt->second;
+    double* intrinsicBlockPtr = intrinsicBlock.data();
+    const bool isFullyConstant = (parameterization.constantParams.size() == intrinsicBlock.size());
+
+    if(isNew)
+    {
+      problem.AddParameterBlock(intrinsicBlockPtr, intrinsicBlock.size());
+      if(!parameterization.constantParams.empty() && !isFullyConstant)
+        problem.SetParameterization(intrinsicBlockPtr, new ceres::SubsetParameterization(intrinsicBlock.size(), parameterization.constantParams));
+      _intrinsicsConstantParams[intrinsicId] = parameterization.constantParams;
+    }
+
+    _allParametersBlocks.push_back(intrinsicBlockPtr);
+
+    if(intrinsicPtr->isLocked() || !refineIntrinsics || isFullyConstant || getIntrinsicState(intrinsicId) == EParameterState::CONSTANT)
+    {
+      // bounds of a previous refinement are removed, a constant block must not be out of its bounds
+      for(const IntrinsicParameterization::Bound& bound : parameterization.bounds)
+      {
+        problem.SetParameterLowerBound(intrinsicBlockPtr, bound.index, -std::numeric_limits<double>::max());
+        problem.SetParameterUpperBound(intrinsicBlockPtr, bound.index, std::numeric_limits<double>::max());
+      }
+      _statistics.addState(EParameter::INTRINSIC, EParameterState::CONSTANT);
+      problem.SetParameterBlockConstant(intrinsicBlockPtr);
+    }
+    else
+    {
+      for(const IntrinsicParameterization::Bound& bound : parameterization.bounds)
+      {
+        problem.SetParameterLowerBound(intrinsicBlockPtr, bound.index, bound.lower);
+        problem.SetParameterUpperBound(intrinsicBlockPtr, bound.index, bound.upper);
+      }
+      _statistics.addState(EParameter::INTRINSIC, EParameterState::REFINED);
+      problem.SetParameterBlockVariable(intrinsicBlockPtr);
+    }
+  }
+
+  // landmarks: only the residual blocks of the new or removed observations are updated
+  for(const auto& landmarkPair: sfmData.getLandmarks())
+  {
+    const IndexT landmarkId = landmarkPair.first;
+    const sfmData::Landmark& landmark = landmarkPair.second;
+
+    if(getLandmarkState(landmarkId) == EParameterState::IGNORED)
+    {
+      _statistics.addState(EParameter::LANDMARK, EParameterState::IGNORED);
+      continue;
+    }
+
+    auto blockIt = _landmarksBlocks.find(landmarkId);
+    const bool isNew = (blockIt == _landmarksBlocks.end());
+    if(isNew)
+      blockIt = _landmarksBlocks.emplace(landmarkId, std::array<double,3>()).first;
+
+    std::array<double,3>& landmarkBlock = blockIt->second;
+    for(std::size_t i = 0; i < 3; ++i)
+      landmarkBlock.at(i) = landmark.X(Eigen::Index(i));
+
+    double* landmarkBlockPtr = landmarkBlock.data();
+
+    if(isNew)
+      problem.AddParameterBlock(landmarkBlockPtr, 3);
+
+    _allParametersBlocks.push_back(landmarkBlockPtr);
+
+    // merge the observations (sorted by view id in the flat_map) with the existing residual blocks
+    std::vector<ObservationResidualBlock>& residualBlocks = _landmarksResidualBlocks[landmarkId];
+    std::vector<ObservationResidualBlock> updatedResidualBlocks;
+    updatedResidualBlocks.reserve(landmark.observations.size());
+    auto residualIt = residualBlocks.begin();
+
+    for(const auto& observationPair: landmark.observations)
+    {
+      const IndexT viewId = observationPair.first;
+      const sfmData::Observation& observation = observationPair.second;
+      const sfmData::View& view = sfmData.getView(viewId);
+      const bool isRig = view.isPartOfRig() && !view.isPoseIndependant();
+
+      // removed observations
+      while(residualIt != residualBlocks.end() && residualIt->viewId < viewId)
+      {
+        problem.RemoveResidualBlock(residualIt->residualBlockId);
+        ++residualIt;
+      }
+
+      if(residualIt != residualBlocks.end() && residualIt->viewId == viewId)
+      {
+        const bool isSame = (residualIt->featureId == observation.id_feat) && (residualIt->isRig == isRig);
+        if(isSame)
+          updatedResidualBlocks.push_back(*residualIt);
+        else
+          problem.RemoveResidualBlock(residualIt->residualBlockId);
+        ++residualIt;
+        if(isSame)
+          continue;
+      }
+
+      updatedResidualBlocks.push_back({viewId, observation.id_feat, isRig,
+                                       addObservationToProblem(sfmData, view, observation, landmarkBlockPtr, problem)});
+    }
+
+    for(; residualIt != residualBlocks.end(); ++residualIt)
+      problem.RemoveResidualBlock(residualIt->residualBlockId);
+
+    residualBlocks.swap(updatedResidualBlocks);
+
+    const bool isConstant = (!refineStructure || getLandmarkState(landmarkId) == EParameterState::CONSTANT);
+    if(isConstant)
+      problem.SetParameterBlockConstant(landmarkBlockPtr);
+    else
+      problem.SetParameterBlockVariable(landmarkBlockPtr);
+
+    // one state per observation, as in addLandmarksToProblem
+    for(std::size_t i = 0; i < residualBlocks.size(); ++i)
+      _statistics.addState(EParameter::LANDMARK, isConstant ? EParameterState::CONSTANT : EParameterState::REFINED);
+  }
+
+  // remove the landmarks that are not in the scene anymore or ignored by the local strategy
+  for(auto blockIt = _landmarksBlocks.begin(); blockIt != _landmarksBlocks.end();)
+  {
+    const IndexT landmarkId = blockIt->first;
+    if(sfmData.getLandmarks().count(landmarkId) && getLandmarkState(landmarkId) != EParameterState::IGNORED)
+    {
+      ++blockIt;
+      continue;
+    }
+    // also removes the residual blocks of the landmark
+    problem.RemoveParameterBlock(blockIt->second.data());
+    _landmarksResidualBlocks.erase(landmarkId);
+    blockIt = _landmarksBlocks.erase(blockIt);
+  }
+
+  // remove the poses, sub-poses and intrinsics that are not used anymore,
+  // their residual blocks have been removed with their observations
+  for(auto blockIt = _posesBlocks.begin(); blockIt != _posesBlocks.end();)
+  {
+    const IndexT poseId = blockIt->first;
+    if(sfmData.getPoses().count(poseId) && getPoseState(poseId) != EParameterState::IGNORED)
+    {
+      ++blockIt;
+      continue;
+    }
+    problem.RemoveParameterBlock(blockIt->second.data());
+    blockIt = _posesBlocks.erase(blockIt);
+  }
+
+  for(auto rigBlocksIt = _rigBlocks.begin(); rigBlocksIt != _rigBlocks.end();)
+  {
+    const auto rigIt = sfmData.getRigs().find(rigBlocksIt->first);
+    HashMap<IndexT, std::array<double,6>>& subPosesBlocks = rigBlocksIt->second;
+    for(auto blockIt = subPosesBlocks.begin(); blockIt != subPosesBlocks.end();)
+    {
+      if(rigIt != sfmData.getRigs().end() &&
+         blockIt->first < rigIt->second.getNbSubPoses() &&
+         rigIt->second.getSubPose(blockIt->first).status != sfmData::ERigSubPoseStatus::UNINITIALIZED)
+      {
+        ++blockIt;
+        continue;
+      }
+      problem.RemoveParameterBlock(blockIt->second.data());
+      blockIt = subPosesBlocks.erase(blockIt);
+    }
+
+    if(rigIt == sfmData.getRigs().end())
+      rigBlocksIt = _rigBlocks.erase(rigBlocksIt);
+    else
+      ++rigBlocksIt;
+  }
+
+  for(auto blockIt = _intrinsicsBlocks.begin(); blockIt != _intrinsicsBlocks.end();)
+  {
+    const IndexT intrinsicId = blockIt->first;
+    const auto usageIt = intrinsicsUsage.find(intrinsicId);
+    if(sfmData.getIntrinsics().count(intrinsicId) &&
+       usageIt != intrinsicsUsage.end() && usageIt->second > 0 &&
+       getIntrinsicState(intrinsicId) != EParameterState::IGNORED)
+    {
+      ++blockIt;
+      continue;
+    }
+    problem.RemoveParameterBlock(blockIt->second.data());
+    _intrinsicsConstantParams.erase(intrinsicId);
+    blockIt = _intrinsicsBlocks.erase(blockIt);
+  }
+
+  // add 2D constraints to the Ceres problem
+  addConstraints2DToProblem(sfmData, refineOptions, problem);
+
+  // add rotation priors to the Ceres problem
+  addRotationPriorsToProblem(sfmData, refineOptions, problem);
+
+  // the parameter ordering contains all the parameter blocks of the problem
+  if(_ceresOptions.useParametersOrdering)
+  {
+    ceres::ParameterBlockOrdering& ordering = _ceresOptions.linearSolverOrdering;
+    ordering.Clear();
+
+    for(auto& landmarkBlockPair : _landmarksBlocks)
+      ordering.AddElementToGroup(landmarkBlockPair.second.data(), 0);
+    for(auto& poseBlockPair : _posesBlocks)
+      ordering.AddElementToGroup(poseBlockPair.second.data(), 1);
+    for(auto& rigBlocksPair : _rigBlocks)
+      for(auto& subPoseBlockPair : rigBlocksPair.second)
+        ordering.AddElementToGroup(subPoseBlockPair.second.data(), 1);
+    for(auto& intrinsicBlockPair : _intrinsicsBlocks)
+      ordering.AddElementToGroup(intrinsicBlockPair.second.data(), 2);
+  }
+}
+
 void BundleAdjustmentCeres::updateFromSolution(sfmData::SfMData& sfmData, ERefineOptions refineOptions) const
 {
   const bool refinePoses = (refineOptions & REFINE_ROTATION) || (refineOptions & REFINE_TRANSLATION);
@@ -773,8 +1250,19 @@ void BundleAdjustmentCeres::createJacobian(const sfmData::SfMData& sfmData,
   // create problem
   ceres::Problem::Options problemOptions;
   problemOptions.loss_function_ownership = ceres::DO_NOT_TAKE_OWNERSHIP;
-  ceres::Problem problem(problemOptions);
-  createProblem(sfmData, refineOptions, problem);
+  std::unique_ptr<ceres::Problem> localProblem;
+
+  if(_ceresOptions.usePersistentProblem)
+  {
+    updatePersistentProblem(sfmData, refineOptions);
+  }
+  else
+  {
+    localProblem.reset(new ceres::Problem(problemOptions));
+    createProblem(sfmData, refineOptions, *localProblem);
+  }
+
+  ceres::Problem& problem = _ceresOptions.usePersistentProblem ? *_problem : *localProblem;
 
   // configure Jacobian engine
   double cost = 0.0;
@@ -789,11 +1277,22 @@ void BundleAdjustmentCeres::createJacobian(const sfmData::SfMData& sfmData,
 
 bool BundleAdjustmentCeres::adjust(sfmData::SfMData& sfmData, ERefineOptions refineOptions)
 {
-  // create problem
+  // create problem or update the persistent one
   ceres::Problem::Options problemOptions;
   problemOptions.loss_function_ownership = ceres::DO_NOT_TAKE_OWNERSHIP;
-  ceres::Problem problem(problemOptions);
-  createProblem(sfmData, refineOptions, problem);
+  std::unique_ptr<ceres::Problem> localProblem;
+
+  if(_ceresOptions.usePersistentProblem)
+  {
+    updatePersistentProblem(sfmData, refineOptions);
+  }
+  else
+  {
+    localProblem.reset(new ceres::Problem(problemOptions));
+    createProblem(sfmData, refineOptions, *localProblem);
+  }
+
+  ceres::Problem& problem = _ceresOptions.usePersistentProblem ? *_problem : *localProblem;
 
   // configure a Bundle Adjustment engine and run it
   // make Ceres automatically detect the bundle structure.
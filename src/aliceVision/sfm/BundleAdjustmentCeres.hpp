@@ -15,13 +15,21 @@
 
 #include <ceres/ceres.h>
 
+#include <map>
 #include <memory>
+#include <vector>
 
 
 namespace aliceVision {
 
+namespace camera {
+struct IntrinsicBase;
+} // namespace camera
+
 namespace sfmData {
 class SfMData;
+class View;
+struct Observation;
 } // namespace sfmData
 
 namespace sfm {
@@ -53,6 +61,10 @@ public:
     std::shared_ptr<ceres::LossFunction> lossFunction;
     unsigned int nbThreads;
     bool useParametersOrdering = true;
+    /// use the cost functions with analytic jacobians instead of the automatic differentiation
+    bool useAnalyticJacobians = false;
+    /// keep the Ceres problem between adjustments and only update the blocks that changed in the scene
+    bool usePersistentProblem = false;
     bool summary = false;
     bool verbose = true;
   };
@@ -120,6 +132,26 @@ public:
     : _ceresOptions(options)
   {}
 
+  /**
+   * @brief Set the Ceres options used by the next adjustments
+   * @note The persistent problem is created from scratch if the loss function changes,
+   *       so the same loss function should be kept between adjustments.
+   * @param[in] options The user Ceres options
+   */
+  inline void setCeresOptions(const CeresOptions& options)
+  {
+    _ceresOptions = options;
+  }
+
+  /**
+   * @brief Get the Ceres options
+   * @return the user Ceres options
+   */
+  inline const CeresOptions& getCeresOptions() const
+  {
+    return _ceresOptions;
+  }
+
   /**
    * @brief Create a jacobian CRSMatrix
    * @param[in] sfmData The input SfMData contains all the information about the reconstruction
@@ -175,6 +207,12 @@ private:
   {
     _statistics = Statistics();
 
+    // the persistent problem references the blocks
+    _problem.reset();
+    _landmarksResidualBlocks.clear();
+    _intrinsicsConstantParams.clear();
+    _otherResidualBlocks.clear();
+
     _allParametersBlocks.clear();
     _posesBlocks.clear();
     _intrinsicsBlocks.clear();
@@ -188,6 +226,69 @@ private:
    */
   void setSolverOptions(ceres::Solver::Options& solverOptions) const;
 
+  /**
+   * @brief Constant parameters and bounds of an intrinsic parameter block
+   */
+  struct IntrinsicParameterization
+  {
+    struct Bound
+    {
+      int index;
+      double lower;
+      double upper;
+    };
+
+    /// indexes of the constant parameters
+    std::vector<int> constantParams;
+    /// bounds of the refined parameters
+    std::vector<Bound> bounds;
+  };
+
+  /**
+   * @brief Residual block of an observation in the persistent problem
+   */
+  struct ObservationResidualBlock
+  {
+    IndexT viewId;
+    IndexT featureId;
+    bool isRig;
+    ceres::ResidualBlockId residualBlockId;
+  };
+
+  /**
+   * @brief Count the number of reconstructed views per intrinsic
+   * @param[in] sfmData The input SfMData contains all the information about the reconstruction
+   * @return the number of reconstructed views of each intrinsic referenced by a view
+   */
+  static std::map<IndexT, std::size_t> countIntrinsicsUsage(const sfmData::SfMData& sfmData);
+
+  /**
+   * @brief Get the constant parameters and the bounds of an intrinsic parameter block
+   * @param[in] intrinsic The camera intrinsic
+   * @param[in] usageCount The number of reconstructed views using this intrinsic
+   * @param[in] refineOptions The chosen refine flag
+   * @param[out] parameterization The constant parameters and bounds
+   */
+  static void getIntrinsicParameterization(const camera::IntrinsicBase& intrinsic,
+                                           std::size_t usageCount,
+                                           ERefineOptions refineOptions,
+                                           IntrinsicParameterization& parameterization);
+
+  /**
+   * @brief Create the residual block of an observation
+   * @param[in] sfmData The input SfMData contains all the information about the reconstruction
+   * @param[in] view The view of the observation
+   * @param[in] observation The observation of the landmark
+   * @param[in] landmarkBlockPtr The landmark parameter block
+   * @param[out] problem The Ceres bundle adjustement problem
+   * @return the residual block id
+   */
+  ceres::ResidualBlockId addObservationToProblem(const sfmData::SfMData& sfmData,
+                                                 const sfmData::View& view,
+                                                 const sfmData::Observation& observation,
+                                                 double* landmarkBlockPtr,
+                                                 ceres::Problem& problem);
+
   /**
    * @brief Create a parameter block for each extrinsics according to the Ceres format: [Rx, Ry, Rz, tx, ty, tz]
    * @param[in] sfmData The input SfMData contains all the information about the reconstruction, notably the poses and sub-poses
@@ -238,6 +339,18 @@ private:
    */
   void createProblem(const sfmData::SfMData& sfmData, ERefineOptions refineOptions, ceres::Problem& problem);
 
+  /**
+   * @brief Create or update the persistent Ceres problem:
+   *  - parameter blocks values are updated from the SfMData,
+   *  - parameter blocks and residual blocks are only added or removed for the poses, intrinsics,
+   *    landmarks and observations that changed in the SfMData or in the local strategy states.
+   * The problem is created from scratch if the refine options, the loss function, the cost functions type
+   * or the parameterization of an intrinsic change.
+   * @param[in] sfmData The input SfMData contains all the information about the reconstruction
+   * @param[in] refineOptions The chosen refine flag
+   */
+  void updatePersistentProblem(const sfmData::SfMData& sfmData, ERefineOptions refineOptions);
+
   /**
    * @brief Update The given SfMData with the solver solution
    * @param[in,out] sfmData The input SfMData contains all the information about the reconstruction, notably the poses and sub-poses
@@ -306,6 +419,23 @@ private:
   /// block: ceres angleAxis(3) + translation(3)
   HashMap<IndexT, HashMap<IndexT, std::array<double,6>>> _rigBlocks;
 
+  // persistent problem data
+
+  /// Ceres problem kept between adjustments
+  std::unique_ptr<ceres::Problem> _problem;
+  /// refine options of the persistent problem
+  ERefineOptions _problemRefineOptions = REFINE_NONE;
+  /// loss function used by the residual blocks of the persistent problem
+  std::shared_ptr<ceres::LossFunction> _problemLossFunction;
+  /// cost functions type of the persistent problem
+  bool _problemUseAnalyticJacobians = false;
+  /// residual blocks of each landmark, sorted by view id
+  HashMap<IndexT, std::vector<ObservationResidualBlock>> _landmarksResidualBlocks;
+  /// constant parameters of each intrinsic block (its local parameterization)
+  HashMap<IndexT, std::vector<int>> _intrinsicsConstantParams;
+  /// residual blocks of the 2D constraints and rotation priors
+  std::vector<ceres::ResidualBlockId> _otherResidualBlocks;
+
 };
 
 } // namespace sfm
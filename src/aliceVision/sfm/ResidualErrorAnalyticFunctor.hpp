@@ -0,0 +1,483 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2020 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#pragma once
+
+#include <aliceVision/numeric/numeric.hpp>
+#include <aliceVision/sfmData/SfMData.hpp>
+
+#include <ceres/ceres.h>
+
+#include <cmath>
+#include <limits>
+
+// Ceres cost functions with analytic jacobians for each AliceVision camera model.
+// They compute the same residuals as the functors of ResidualErrorFunctor.hpp
+// without the jet arithmetic of the automatic differentiation.
+
+namespace aliceVision {
+namespace sfm {
+
+namespace analytic {
+
+using Mat2 = Eigen::Matrix<double, 2, 2>;
+
+/**
+ * @brief Return the skew symmetric matrix [v]x such that [v]x * u = v x u
+ */
+inline Mat3 skew(const Vec3& v)
+{
+  Mat3 m;
+  m <<  0.0, -v(2),  v(1),
+       v(2),   0.0, -v(0),
+      -v(1),  v(0),   0.0;
+  return m;
+}
+
+/**
+ * @brief Rotate a point with an angle-axis rotation (same computation as ceres::AngleAxisRotatePoint).
+ * @param[in] angleAxis The angle-axis rotation
+ * @param[in] pt The point to rotate
+ * @param[out] rotation The rotation matrix
+ * @param[out] rotatedPt The rotated point
+ * @param[out] jacobian The derivative of the rotated point with respect to the angle-axis, or nullptr
+ */
+inline void angleAxisRotatePoint(const double* angleAxis, const Vec3& pt, Mat3& rotation, Vec3& rotatedPt, Mat3* jacobian)
+{
+  const Vec3 w(angleAxis[0], angleAxis[1], angleAxis[2]);
+  const double theta2 = w.squaredNorm();
+
+  if(theta2 > std::numeric_limits<double>::epsilon())
+  {
+    // Rodrigues formula
+    const double theta = std::sqrt(theta2);
+    const double cosTheta = std::cos(theta);
+    const double sinTheta = std::sin(theta);
+    const Mat3 W = skew(w);
+    const Mat3 W2 = W * W;
+    const double a = sinTheta / theta;
+    const double b = (1.0 - cosTheta) / theta2;
+
+    rotation = Mat3::Identity() + a * W + b * W2;
+    rotatedPt = rotation * pt;
+
+    if(jacobian)
+    {
+      // d(R(w).X)/dw = -R(w).[X]x.Jr(w) with the right jacobian of SO(3):
+      // Jr(w) = I - (1 - cos(theta)) / theta^2 [w]x + (theta - sin(theta)) / theta^3 [w]x^2
+      const double c = (theta - sinTheta) / (theta2 * theta);
+      const Mat3 rightJacobian = Mat3::Identity() - b * W + c * W2;
+      *jacobian = -rotation * skew(pt) * rightJacobian;
+    }
+  }
+  else
+  {
+    // near zero, the first order approximation R = I + [w]x is used like in ceres
+    rotation = Mat3::Identity() + skew(w);
+    rotatedPt = pt + w.cross(pt);
+
+    if(jacobian)
+      *jacobian = -skew(pt);
+  }
+}
+
+/**
+ * @brief No distortion (pinhole camera model).
+ */
+struct Distortion_None
+{
+  enum { NB_PARAMS = 0 };
+
+  static void apply(const double* /*disto*/, const Vec2& pt, Vec2& ptDist, Mat2& jacobianPt, Eigen::Matrix<double, 2, NB_PARAMS>& /*jacobianDisto*/)
+  {
+    ptDist = pt;
+    jacobianPt.setIdentity();
+  }
+};
+
+/**
+ * @brief Radial distortion with one parameter: x_d = x_u (1 + k1 r^2)
+ */
+struct Distortion_RadialK1
+{
+  enum { NB_PARAMS = 1 };
+
+  static void apply(const double* disto, const Vec2& pt, Vec2& ptDist, Mat2& jacobianPt, Eigen::Matrix<double, 2, NB_PARAMS>& jacobianDisto)
+  {
+    const double k1 = disto[0];
+    const double r2 = pt.squaredNorm();
+    const double rCoeff = 1.0 + k1 * r2;
+
+    ptDist = pt * rCoeff;
+    // d(rCoeff)/d(r2) = k1 and d(r2)/d(pt) = 2 pt
+    jacobianPt = rCoeff * Mat2::Identity() + (2.0 * k1) * pt * pt.transpose();
+    jacobianDisto.col(0) = pt * r2;
+  }
+};
+
+/**
+ * @brief Radial distortion with three parameters: x_d = x_u (1 + k1 r^2 + k2 r^4 + k3 r^6)
+ */
+struct Distortion_RadialK3
+{
+  enum { NB_PARAMS = 3 };
+
+  static void apply(const double* disto, const Vec2& pt, Vec2& ptDist, Mat2& jacobianPt, Eigen::Matrix<double, 2, NB_PARAMS>& jacobianDisto)
+  {
+    const double k1 = disto[0];
+    const double k2 = disto[1];
+    const double k3 = disto[2];
+    const double r2 = pt.squaredNorm();
+    const double r4 = r2 * r2;
+    const double r6 = r4 * r2;
+    const double rCoeff = 1.0 + k1 * r2 + k2 * r4 + k3 * r6;
+    const double dCoeff_dr2 = k1 + 2.0 * k2 * r2 + 3.0 * k3 * r4;
+
+    ptDist = pt * rCoeff;
+    jacobianPt = rCoeff * Mat2::Identity() + (2.0 * dCoeff_dr2) * pt * pt.transpose();
+    jacobianDisto.col(0) = pt * r2;
+    jacobianDisto.col(1) = pt * r4;
+    jacobianDisto.col(2) = pt * r6;
+  }
+};
+
+/**
+ * @brief Brown distortion: radial (k1, k2, k3) and tangential (t1, t2) distortion
+ */
+struct Distortion_BrownT2
+{
+  enum { NB_PARAMS = 5 };
+
+  static void apply(const double* disto, const Vec2& pt, Vec2& ptDist, Mat2& jacobianPt, Eigen::Matrix<double, 2, NB_PARAMS>& jacobianDisto)
+  {
+    const double k1 = disto[0];
+    const double k2 = disto[1];
+    const double k3 = disto[2];
+    const double t1 = disto[3];
+    const double t2 = disto[4];
+    const double x = pt(0);
+    const double y = pt(1);
+    const double r2 = pt.squaredNorm();
+    const double r4 = r2 * r2;
+    const double r6 = r4 * r2;
+    const double rCoeff = 1.0 + k1 * r2 + k2 * r4 + k3 * r6;
+    const double dCoeff_dr2 = k1 + 2.0 * k2 * r2 + 3.0 * k3 * r4;
+    const double tx = t2 * (r2 + 2.0 * x * x) + 2.0 * t1 * x * y;
+    const double ty = t1 * (r2 + 2.0 * y * y) + 2.0 * t2 * x * y;
+
+    ptDist(0) = x * rCoeff + tx;
+    ptDist(1) = y * rCoeff + ty;
+
+    jacobianPt = rCoeff * Mat2::Identity() + (2.0 * dCoeff_dr2) * pt * pt.transpose();
+    jacobianPt(0, 0) += 6.0 * t2 * x + 2.0 * t1 * y;
+    jacobianPt(0, 1) += 2.0 * t2 * y + 2.0 * t1 * x;
+    jacobianPt(1, 0) += 2.0 * t1 * x + 2.0 * t2 * y;
+    jacobianPt(1, 1) += 6.0 * t1 * y + 2.0 * t2 * x;
+
+    jacobianDisto.col(0) = pt * r2;
+    jacobianDisto.col(1) = pt * r4;
+    jacobianDisto.col(2) = pt * r6;
+    jacobianDisto(0, 3) = 2.0 * x * y;
+    jacobianDisto(1, 3) = r2 + 2.0 * y * y;
+    jacobianDisto(0, 4) = r2 + 2.0 * x * x;
+    jacobianDisto(1, 4) = 2.0 * x * y;
+  }
+};
+
+/**
+ * @brief Fisheye distortion: x_d = x_u theta_d / r
+ *        with theta = atan(r) and theta_d = theta (1 + k1 theta^2 + k2 theta^4 + k3 theta^6 + k4 theta^8)
+ */
+struct Distortion_Fisheye
+{
+  enum { NB_PARAMS = 4 };
+
+  static void apply(const double* disto, const Vec2& pt, Vec2& ptDist, Mat2& jacobianPt, Eigen::Matrix<double, 2, NB_PARAMS>& jacobianDisto)
+  {
+    const double k1 = disto[0];
+    const double k2 = disto[1];
+    const double k3 = disto[2];
+    const double k4 = disto[3];
+    const double r2 = pt.squaredNorm();
+    const double r = std::sqrt(r2);
+
+    if(r <= 1e-8)
+    {
+      // same threshold as the autodiff functor, the distortion is the identity
+      ptDist = pt;
+      jacobianPt.setIdentity();
+      jacobianDisto.setZero();
+      return;
+    }
+
+    const double theta = std::atan(r);
+    const double theta2 = theta * theta;
+    const double theta3 = theta2 * theta;
+    const double theta5 = theta3 * theta2;
+    const double theta7 = theta5 * theta2;
+    const double theta9 = theta7 * theta2;
+    const double thetaDist = theta + k1 * theta3 + k2 * theta5 + k3 * theta7 + k4 * theta9;
+    const double dThetaDist_dTheta = 1.0 + theta2 * (3.0 * k1 + theta2 * (5.0 * k2 + theta2 * (7.0 * k3 + theta2 * 9.0 * k4)));
+    const double dTheta_dr = 1.0 / (1.0 + r2);
+    const double invR = 1.0 / r;
+    const double cDist = thetaDist * invR;
+    // d(cDist)/dr, and d(r)/d(pt) = pt / r
+    const double dCDist_dr = (dThetaDist_dTheta * dTheta_dr - cDist) * invR;
+
+    ptDist = pt * cDist;
+    jacobianPt = cDist * Mat2::Identity() + (dCDist_dr * invR) * pt * pt.transpose();
+    jacobianDisto.col(0) = pt * (theta3 * invR);
+    jacobianDisto.col(1) = pt * (theta5 * invR);
+    jacobianDisto.col(2) = pt * (theta7 * invR);
+    jacobianDisto.col(3) = pt * (theta9 * invR);
+  }
+};
+
+/**
+ * @brief Fisheye distortion with one parameter (FOV model): x_d = x_u atan(2 r tan(k1 / 2)) / (k1 r)
+ */
+struct Distortion_Fisheye1
+{
+  enum { NB_PARAMS = 1 };
+
+  static void apply(const double* disto, const Vec2& pt, Vec2& ptDist, Mat2& jacobianPt, Eigen::Matrix<double, 2, NB_PARAMS>& jacobianDisto)
+  {
+    const double k1 = disto[0];
+    const double r2 = pt.squaredNorm();
+    const double r = std::sqrt(r2);
+    const double tanHalfK1 = std::tan(0.5 * k1);
+    const double a = 2.0 * tanHalfK1;
+    const double u = a * r;
+    const double atanU = std::atan(u);
+    const double dAtanU_du = 1.0 / (1.0 + u * u);
+    const double rCoeff = atanU / (k1 * r);
+    // d(rCoeff)/dr, and d(r)/d(pt) = pt / r
+    const double dCoeff_dr = (a * r * dAtanU_du - atanU) / (k1 * r2);
+    // d(a)/d(k1) = 1 / cos(k1 / 2)^2
+    const double dA_dk1 = 1.0 + tanHalfK1 * tanHalfK1;
+    const double dCoeff_dk1 = (k1 * r * dA_dk1 * dAtanU_du - atanU) / (k1 * k1 * r);
+
+    ptDist = pt * rCoeff;
+    jacobianPt = rCoeff * Mat2::Identity() + (dCoeff_dr / r) * pt * pt.transpose();
+    jacobianDisto.col(0) = pt * dCoeff_dk1;
+  }
+};
+
+/**
+ * @brief Apply the projection, the distortion, the focal length and the principal point to a point
+ *        in the camera frame and compute the residual and its derivatives.
+ * @param[in] cam_K The intrinsic data block [focal, principal point x, principal point y, distortion...]
+ * @param[in] ptCam The point in the camera frame
+ * @param[in] observation The observed 2D point
+ * @param[in] invScale The inverse of the observation scale
+ * @param[out] residuals The 2 residuals
+ * @param[out] jacobianPtCam The derivative of the residuals with respect to the point in the camera frame, or nullptr
+ * @param[out] jacobianIntrinsics The derivative of the residuals with respect to the intrinsic data block
+ *             (row-major 2 x (3 + number of distortion parameters)), or nullptr
+ */
+template <typename Distortion>
+inline void applyIntrinsicParameters(const double* cam_K,
+                                     const Vec3& ptCam,
+                                     const Vec2& observation,
+                                     double invScale,
+                                     double* residuals,
+                                     Mat23* jacobianPtCam,
+                                     double* jacobianIntrinsics)
+{
+  const double focal = cam_K[0];
+  const double invZ = 1.0 / ptCam(2);
+
+  // transform the point from homogeneous to euclidean (undistorted point)
+  const Vec2 ptUndist(ptCam(0) * invZ, ptCam(1) * invZ);
+
+  Vec2 ptDist;
+  Mat2 jacobianDist_Undist;
+  Eigen::Matrix<double, 2, Distortion::NB_PARAMS> jacobianDist_Disto;
+  Distortion::apply(cam_K + 3, ptUndist, ptDist, jacobianDist_Undist, jacobianDist_Disto);
+
+  residuals[0] = (cam_K[1] + focal * ptDist(0) - observation(0)) * invScale;
+  residuals[1] = (cam_K[2] + focal * ptDist(1) - observation(1)) * invScale;
+
+  if(jacobianPtCam)
+  {
+    Mat23 jacobianUndist_PtCam;
+    jacobianUndist_PtCam << invZ, 0.0, -ptUndist(0) * invZ,
+                            0.0, invZ, -ptUndist(1) * invZ;
+    *jacobianPtCam = (focal * invScale) * jacobianDist_Undist * jacobianUndist_PtCam;
+  }
+
+  if(jacobianIntrinsics)
+  {
+    Eigen::Map<Eigen::Matrix<double, 2, 3 + Distortion::NB_PARAMS, Eigen::RowMajor>> J(jacobianIntrinsics);
+    J.col(0) = ptDist * invScale;
+    J.col(1) << invScale, 0.0;
+    J.col(2) << 0.0, invScale;
+    J.template rightCols<Distortion::NB_PARAMS>() = (focal * invScale) * jacobianDist_Disto;
+  }
+}
+
+/**
+ * @brief Copy the derivatives with respect to a pose [rX,rY,rZ,tx,ty,tz] in a row-major 2x6 jacobian block
+ */
+inline void setPoseJacobian(const Mat23& jacobianPtCam, const Mat3& jacobianPtCam_R, const Mat3& jacobianPtCam_t, double* jacobianPose)
+{
+  Eigen::Map<Eigen::Matrix<double, 2, 6, Eigen::RowMajor>> J(jacobianPose);
+  J.leftCols<3>() = jacobianPtCam * jacobianPtCam_R;
+  J.rightCols<3>() = jacobianPtCam * jacobianPtCam_t;
+}
+
+} // namespace analytic
+
+/**
+ * @brief Ceres cost function with analytic jacobians for a camera model K[R|t] and a 3D point.
+ *
+ *  Data parameter blocks are the following <2,K,6,3>
+ *  - 2 => dimension of the residuals,
+ *  - K => the intrinsic data block [focal, principal point x, principal point y, distortion...],
+ *  - 6 => the camera extrinsic data block (camera orientation and position) [R;t],
+ *         - rotation(angle axis), and translation [rX,rY,rZ,tx,ty,tz].
+ *  - 3 => a 3D point data block.
+ *
+ * @see ResidualErrorFunctor_Pinhole for the equivalent automatic differentiation functor
+ */
+template <typename Distortion>
+class ResidualErrorAnalyticCostFunction : public ceres::SizedCostFunction<2, 3 + Distortion::NB_PARAMS, 6, 3>
+{
+public:
+  explicit ResidualErrorAnalyticCostFunction(const sfmData::Observation& obs)
+    : _observation(obs.x)
+    , _invScale(1.0 / (obs.scale > 0.0 ? obs.scale : 1.0))
+  {}
+
+  bool Evaluate(double const* const* parameters, double* residuals, double** jacobians) const override
+  {
+    const double* cam_K = parameters[0];
+    const double* cam_Rt = parameters[1];
+    const Vec3 pos_3dpoint(parameters[2][0], parameters[2][1], parameters[2][2]);
+
+    const bool computeJacobians = (jacobians != nullptr);
+    const bool computePoseJacobian = computeJacobians && (jacobians[1] != nullptr);
+
+    // apply external parameters (pose)
+    Mat3 R;
+    Vec3 pos_proj;
+    Mat3 jacobianPtCam_R;
+    analytic::angleAxisRotatePoint(cam_Rt, pos_3dpoint, R, pos_proj, computePoseJacobian ? &jacobianPtCam_R : nullptr);
+    pos_proj += Vec3(cam_Rt[3], cam_Rt[4], cam_Rt[5]);
+
+    // apply intrinsic parameters
+    Mat23 jacobianPtCam;
+    analytic::applyIntrinsicParameters<Distortion>(cam_K, pos_proj, _observation, _invScale, residuals,
+                                                   computeJacobians ? &jacobianPtCam : nullptr,
+                                                   computeJacobians ? jacobians[0] : nullptr);
+    if(!computeJacobians)
+      return true;
+
+    if(computePoseJacobian)
+      analytic::setPoseJacobian(jacobianPtCam, jacobianPtCam_R, Mat3::Identity(), jacobians[1]);
+
+    if(jacobians[2])
+    {
+      Eigen::Map<Eigen::Matrix<double, 2, 3, Eigen::RowMajor>> jacobianPoint(jacobians[2]);
+      jacobianPoint = jacobianPtCam * R;
+    }
+
+    return true;
+  }
+
+private:
+  const Vec2 _observation;
+  const double _invScale;
+};
+
+/**
+ * @brief Ceres cost function with analytic jacobians for a camera model K[R|t] in a rig and a 3D point.
+ *
+ *  Data parameter blocks are the following <2,K,6,6,3>
+ *  - 2 => dimension of the residuals,
+ *  - K => the intrinsic data block [focal, principal point x, principal point y, distortion...],
+ *  - 6 => the rig extrinsic data block (rig orientation and position) [R;t],
+ *  - 6 => the camera sub-pose data block in the rig [R;t],
+ *  - 3 => a 3D point data block.
+ */
+template <typename Distortion>
+class ResidualErrorRigAnalyticCostFunction : public ceres::SizedCostFunction<2, 3 + Distortion::NB_PARAMS, 6, 6, 3>
+{
+public:
+  explicit ResidualErrorRigAnalyticCostFunction(const sfmData::Observation& obs)
+    : _observation(obs.x)
+    , _invScale(1.0 / (obs.scale > 0.0 ? obs.scale : 1.0))
+  {}
+
+  bool Evaluate(double const* const* parameters, double* residuals, double** jacobians) const override
+  {
+    const double* cam_K = parameters[0];
+    const double* cam_Rt = parameters[1];
+    const double* subpose_Rt = parameters[2];
+    const Vec3 pos_3dpoint(parameters[3][0], parameters[3][1], parameters[3][2]);
+
+    const bool computeJacobians = (jacobians != nullptr);
+    const bool computePoseJacobian = computeJacobians && (jacobians[1] != nullptr);
+    const bool computeSubposeJacobian = computeJacobians && (jacobians[2] != nullptr);
+
+    // apply the rig pose
+    Mat3 R;
+    Vec3 pos_rig;
+    Mat3 jacobianPtRig_R;
+    analytic::angleAxisRotatePoint(cam_Rt, pos_3dpoint, R, pos_rig, computePoseJacobian ? &jacobianPtRig_R : nullptr);
+    pos_rig += Vec3(cam_Rt[3], cam_Rt[4], cam_Rt[5]);
+
+    // apply the sub-pose of the camera in the rig
+    Mat3 subposeR;
+    Vec3 pos_proj;
+    Mat3 jacobianPtCam_subposeR;
+    analytic::angleAxisRotatePoint(subpose_Rt, pos_rig, subposeR, pos_proj, computeSubposeJacobian ? &jacobianPtCam_subposeR : nullptr);
+    pos_proj += Vec3(subpose_Rt[3], subpose_Rt[4], subpose_Rt[5]);
+
+    // apply intrinsic parameters
+    Mat23 jacobianPtCam;
+    analytic::applyIntrinsicParameters<Distortion>(cam_K, pos_proj, _observation, _invScale, residuals,
+                                                   computeJacobians ? &jacobianPtCam : nullptr,
+                                                   computeJacobians ? jacobians[0] : nullptr);
+    if(!computeJacobians)
+      return true;
+
+    if(computePoseJacobian)
+      analytic::setPoseJacobian(jacobianPtCam, subposeR * jacobianPtRig_R, subposeR, jacobians[1]);
+
+    if(computeSubposeJacobian)
+      analytic::setPoseJacobian(jacobianPtCam, jacobianPtCam_subposeR, Mat3::Identity(), jacobians[2]);
+
+    if(jacobians[3])
+    {
+      Eigen::Map<Eigen::Matrix<double, 2, 3, Eigen::RowMajor>> jacobianPoint(jacobians[3]);
+      jacobianPoint = jacobianPtCam * (subposeR * R);
+    }
+
+    return true;
+  }
+
+private:
+  const Vec2 _observation;
+  const double _invScale;
+};
+
+using ResidualErrorAnalyticCostFunction_Pinhole = ResidualErrorAnalyticCostFunction<analytic::Distortion_None>;
+using ResidualErrorAnalyticCostFunction_PinholeRadialK1 = ResidualErrorAnalyticCostFunction<analytic::Distortion_RadialK1>;
+using ResidualErrorAnalyticCostFunction_PinholeRadialK3 = ResidualErrorAnalyticCostFunction<analytic::Distortion_RadialK3>;
+using ResidualErrorAnalyticCostFunction_PinholeBrownT2 = ResidualErrorAnalyticCostFunction<analytic::Distortion_BrownT2>;
+using ResidualErrorAnalyticCostFunction_PinholeFisheye = ResidualErrorAnalyticCostFunction<analytic::Distortion_Fisheye>;
+using ResidualErrorAnalyticCostFunction_PinholeFisheye1 = ResidualErrorAnalyticCostFunction<analytic::Distortion_Fisheye1>;
+
+using ResidualErrorRigAnalyticCostFunction_Pinhole = ResidualErrorRigAnalyticCostFunction<analytic::Distortion_None>;
+using ResidualErrorRigAnalyticCostFunction_PinholeRadialK1 = ResidualErrorRigAnalyticCostFunction<analytic::Distortion_RadialK1>;
+using ResidualErrorRigAnalyticCostFunction_PinholeRadialK3 = ResidualErrorRigAnalyticCostFunction<analytic::Distortion_RadialK3>;
+using ResidualErrorRigAnalyticCostFunction_PinholeBrownT2 = ResidualErrorRigAnalyticCostFunction<analytic::Distortion_BrownT2>;
+using ResidualErrorRigAnalyticCostFunction_PinholeFisheye = ResidualErrorRigAnalyticCostFunction<analytic::Distortion_Fisheye>;
+using ResidualErrorRigAnalyticCostFunction_PinholeFisheye1 = ResidualErrorRigAnalyticCostFunction<analytic::Distortion_Fisheye1>;
+
+} // namespace sfm
+} // namespace aliceVision
@@ -163,7 +163,7 @@ struct ResidualErrorFunctor_Pinhole
     return true;
   }
 
-  const sfmData::Observation& _obs; // The 2D observation
+  const sfmData::Observation _obs; // The 2D observation (copy)
 };
 
 /**
@@ -317,7 +317,7 @@ struct ResidualErrorFunctor_PinholeRadialK1
     return true;
   }
 
-  const sfmData::Observation& _obs; // The 2D observation
+  const sfmData::Observation _obs; // The 2D observation (copy)
 };
 
 /**
@@ -470,7 +470,7 @@ struct ResidualErrorFunctor_PinholeRadialK3
     return true;
   }
 
-  const sfmData::Observation& _obs; // The 2D observation
+  const sfmData::Observation _obs; // The 2D observation (copy)
 };
 
 /**
@@ -636,7 +636,7 @@ struct ResidualErrorFunctor_PinholeBrownT2
     return true;
   }
 
-  const sfmData::Observation& _obs; // The 2D observation
+  const sfmData::Observation _obs; // The 2D observation (copy)
 };
 
 
@@ -804,7 +804,7 @@ struct ResidualErrorFunctor_PinholeFisheye
     return true;
   }
 
-  const sfmData::Observation& _obs; // The 2D observation
+  const sfmData::Observation _obs; // The 2D observation (copy)
 };
 
 /**
@@ -958,7 +958,7 @@ struct ResidualErrorFunctor_PinholeFisheye1
     return true;
   }
 
-  const sfmData::Observation& _obs; // The 2D observation
+  const sfmData::Observation _obs; // The 2D observation (copy)
 };
 
 
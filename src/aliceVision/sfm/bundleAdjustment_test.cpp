@@ -242,6 +242,41 @@ BOOST_AUTO_TEST_CASE(LOCAL_BUNDLE_ADJUSTMENT_EffectiveMinimization_Pinhole_Camer
   BOOST_CHECK(dResidual_before > dResidual_after);
 }
 
+BOOST_AUTO_TEST_CASE(BUNDLE_ADJUSTMENT_PersistentProblem_Pinhole)
+{
+  const int nviews = 6;
+  const int npoints = 32;
+  const NViewDatasetConfigurator config;
+  const NViewDataSet d = NRealisticCamerasRing(nviews, npoints, config);
+
+  SfMData sfmData = getInputScene(d, config, EINTRINSIC::PINHOLE_CAMERA_RADIAL3);
+
+  BundleAdjustmentCeres::CeresOptions options;
+  options.usePersistentProblem = true;
+  BundleAdjustmentCeres persistentBA(options);
+  BOOST_CHECK( persistentBA.adjust(sfmData) );
+
+  // modify the scene between two adjustments as done by the outliers removal:
+  // remove a landmark and an observation, and move the structure
+  sfmData.structure.erase(0);
+  sfmData.structure.at(1).observations.erase(0);
+  for(auto& landmarkPair : sfmData.structure)
+    landmarkPair.second.X += Vec3(0.01, -0.02, 0.01);
+
+  SfMData sfmDataFromScratch = sfmData;
+
+  BOOST_CHECK( persistentBA.adjust(sfmData) );
+  BOOST_CHECK_EQUAL( persistentBA.getStatistics().nbResidualBlocks, static_cast<std::size_t>(2 * ((npoints - 1) * nviews - 1)) ); // 2 residuals per observation
+
+  BundleAdjustmentCeres fromScratchBA;
+  BOOST_CHECK( fromScratchBA.adjust(sfmDataFromScratch) );
+
+  // the updated problem gives the same solution as a problem created from scratch
+  BOOST_CHECK_SMALL( RMSE(sfmData) - RMSE(sfmDataFromScratch), 1e-6 );
+  for(const auto& landmarkPair : sfmData.structure)
+    BOOST_CHECK_SMALL( (landmarkPair.second.X - sfmDataFromScratch.structure.at(landmarkPair.first).X).norm(), 1e-4 );
+}
+
 /// Compute the Root Mean Square Error of the residuals
 double RMSE(const SfMData & sfm_data)
 {
@@ -54,7 +54,7 @@ bool SfMLocalizer::Localize(const Pair& imageSize,
 
     // robust estimation of the Projection matrix and its precision
     robustEstimation::Mat34Model model;
-    const std::pair<double,double> ACRansacOut = robustEstimation::ACRANSAC(kernel, resectionData.vec_inliers, resectionData.max_iteration, &model, precision);
+    const std::pair<double,double> ACRansacOut = robustEstimation::ACRANSAC(kernel, resectionData.vec_inliers, resectionData.max_iteration, &model, precision, resectionData.acRansacOptions);
     P = model.getMatrix();
     // update the upper bound precision of the model found by AC-RANSAC
     resectionData.error_max = ACRansacOut.first;
@@ -89,7 +89,7 @@ bool SfMLocalizer::Localize(const Pair& imageSize,
 
         // robust estimation of the Projection matrix and its precision
         robustEstimation::Mat34Model model;
-        const std::pair<double, double> ACRansacOut = robustEstimation::ACRANSAC(kernel, resectionData.vec_inliers, resectionData.max_iteration, &model, precision);
+        const std::pair<double, double> ACRansacOut = robustEstimation::ACRANSAC(kernel, resectionData.vec_inliers, resectionData.max_iteration, &model, precision, resectionData.acRansacOptions);
 
         P = model.getMatrix();
 
@@ -127,7 +127,8 @@ bool loadRegionsPerView(feature::RegionsPerView& regionsPerView,
             const SfMData& sfmData,
             const std::vector<std::string>& folders,
             const std::vector<feature::EImageDescriberType>& imageDescriberTypes,
-            const std::set<IndexT>& viewIdFilter)
+            const std::set<IndexT>& viewIdFilter,
+            bool onlyFeatures)
 {
   std::vector<std::string> featuresFolders = sfmData.getFeaturesFolders(); // add sfm features folders
   featuresFolders.insert(featuresFolders.end(), folders.begin(), folders.end()); // add user features folders
@@ -151,7 +152,8 @@ bool loadRegionsPerView(feature::RegionsPerView& regionsPerView,
      {
        if(viewIdFilter.empty() || viewIdFilter.find(iter->second.get()->getViewId()) != viewIdFilter.end())
        {
-         std::unique_ptr<feature::Regions> regionsPtr = loadRegions(featuresFolders, iter->second.get()->getViewId(), *(imageDescribers.at(i)));
+         std::unique_ptr<feature::Regions> regionsPtr = onlyFeatures ? loadFeatures(featuresFolders, iter->second.get()->getViewId(), *(imageDescribers.at(i)))
+                                                                     : loadRegions(featuresFolders, iter->second.get()->getViewId(), *(imageDescribers.at(i)));
          if(regionsPtr)
          {
 #pragma omp critical
@@ -171,6 +173,28 @@ bool loadRegionsPerView(feature::RegionsPerView& regionsPerView,
  return !invalid;
 }
 
+std::unique_ptr<feature::RegionsProvider> createRegionsProvider(const SfMData& sfmData,
+                                                                const std::vector<std::string>& folders,
+                                                                const std::vector<feature::EImageDescriberType>& imageDescriberTypes,
+                                                                std::size_t maxMemorySize)
+{
+  std::vector<std::string> featuresFolders = sfmData.getFeaturesFolders(); // add sfm features folders
+  featuresFolders.insert(featuresFolders.end(), folders.begin(), folders.end()); // add user features folders
+
+  // shared by all the copies of the loader
+  std::shared_ptr<std::map<feature::EImageDescriberType, std::unique_ptr<feature::ImageDescriber>>> imageDescribers =
+      std::make_shared<std::map<feature::EImageDescriberType, std::unique_ptr<feature::ImageDescriber>>>();
+
+  for(const feature::EImageDescriberType imageDescriberType : imageDescriberTypes)
+    (*imageDescribers)[imageDescriberType] = createImageDescriber(imageDescriberType);
+
+  const feature::RegionsProvider::RegionsLoader loader = [featuresFolders, imageDescribers](IndexT viewId, feature::EImageDescriberType descType)
+  {
+    return loadRegions(featuresFolders, viewId, *(imageDescribers->at(descType)));
+  };
+
+  return std::unique_ptr<feature::RegionsProvider>(new feature::RegionsProvider(loader, maxMemorySize));
+}
 
 bool loadFeaturesPerView(feature::FeaturesPerView& featuresPerView,
                       const SfMData& sfmData,
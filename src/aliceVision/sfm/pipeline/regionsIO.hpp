@@ -12,6 +12,7 @@
 #include <aliceVision/feature/ImageDescriber.hpp>
 #include <aliceVision/feature/imageDescriberCommon.hpp>
 #include <aliceVision/feature/RegionsPerView.hpp>
+#include <aliceVision/feature/RegionsProvider.hpp>
 #include <aliceVision/feature/FeaturesPerView.hpp>
 
 #include <memory>
@@ -44,13 +45,29 @@ std::unique_ptr<feature::Regions> loadFeatures(const std::vector<std::string>& f
  * @param[in] folders The feature Folders
  * @param[in] imageDescriberTypes The imageDescriber types
  * @param[in] filter To load Regions only for a sub-set of the views contained in the sfmData
+ * @param[in] onlyFeatures To load only the features (descriptors are left empty)
  * @return true if the regions are correctlty loaded
  */
 bool loadRegionsPerView(feature::RegionsPerView& regionsPerView,
                         const sfmData::SfMData& sfmData,
                         const std::vector<std::string>& folders,
                         const std::vector<feature::EImageDescriberType>& imageDescriberTypes,
-                        const std::set<IndexT>& filter = std::set<IndexT>());
+                        const std::set<IndexT>& filter = std::set<IndexT>(),
+                        bool onlyFeatures = false);
+
+/**
+ * @brief Create a RegionsProvider that loads the Regions (Features & Descriptors)
+ *        of the views of the provided SfMData container on demand.
+ * @param[in] sfmData The provided SfMData container
+ * @param[in] folders The feature Folders
+ * @param[in] imageDescriberTypes The imageDescriber types
+ * @param[in] maxMemorySize The memory budget of the provider (in bytes), 0 means unbounded
+ * @return the regions provider
+ */
+std::unique_ptr<feature::RegionsProvider> createRegionsProvider(const sfmData::SfMData& sfmData,
+                                                                const std::vector<std::string>& folders,
+                                                                const std::vector<feature::EImageDescriberType>& imageDescriberTypes,
+                                                                std::size_t maxMemorySize);
 
 /**
  * @brief Load Features for each view of the provided SfMData container.
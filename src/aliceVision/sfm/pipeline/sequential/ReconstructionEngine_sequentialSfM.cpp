@@ -27,7 +27,7 @@
 #include <aliceVision/system/Timer.hpp>
 #include <aliceVision/system/cpu.hpp>
 #include <aliceVision/system/MemoryInfo.hpp>
-#include <aliceVision/track/TracksBuilder.hpp>
+#include <aliceVision/track/UnionFindTracksBuilder.hpp>
 #include <aliceVision/track/tracksUtils.hpp>
 
 #include <dependencies/htmlDoc/htmlDoc.hpp>
@@ -212,10 +212,12 @@ void ReconstructionEngine_sequentialSfM::initializePyramidScoring()
   if(_pyramidWeights.size() != _params.pyramidDepth)
   {
     _pyramidWeights.resize(_params.pyramidDepth);
+    _pyramidNbCells = 0;
     std::size_t maxWeight = 0;
     for(std::size_t level = 0; level < _params.pyramidDepth; ++level)
     {
       std::size_t nbCells = Square(std::pow(_params.pyramidBase, level+1));
+      _pyramidNbCells += nbCells;
       // We use a different weighting strategy than [Schonberger 2016].
       // They use w = 2^l with l={1...L} (even if there is a typo in the text where they say to use w=2^{2*l}.
       // We prefer to give more importance to the first levels of the pyramid, so:
@@ -230,7 +232,7 @@ void ReconstructionEngine_sequentialSfM::initializePyramidScoring()
 std::size_t ReconstructionEngine_sequentialSfM::fuseMatchesIntoTracks()
 {
   // compute tracks from matches
-  track::TracksBuilder tracksBuilder;
+  track::UnionFindTracksBuilder tracksBuilder;
 
   {
     // list of features matches for each couple of images
@@ -258,6 +260,11 @@ std::size_t ReconstructionEngine_sequentialSfM::fuseMatchesIntoTracks()
     computeTracksPyramidPerView(
             _map_tracksPerView, _map_tracks, _sfmData.views, *_featuresPerView, _params.pyramidBase, _params.pyramidDepth, _map_featsPyramidPerView);
 
+    // no landmark is taken into account in the views scoring yet
+    _viewsScoring.clear();
+    _changedTrackIds.clear();
+    _isTrackScored.assign(_map_tracks.empty() ? 0 : _map_tracks.rbegin()->first + 1, 0);
+
     // display stats
     {
       std::set<size_t> imagesId;
@@ -366,6 +373,7 @@ void ReconstructionEngine_sequentialSfM::remapLandmarkIdsToTrackIds()
       {
         // re-insert the landmark with the new id
         _sfmData.getLandmarks().emplace(trackId, landmarks.find(it->second)->second);
+        _changedTrackIds.push_back(trackId);
         break; //one landmark per track
       }
     }
@@ -508,8 +516,13 @@ double ReconstructionEngine_sequentialSfM::incrementalReconstruction()
 {
   auto chrono_start = std::chrono::steady_clock::now();
 
+  // each view has its own result slot, the scene is only read during the parallel resection
+  std::vector<ResectionData> resectionDataPerView(bestViewIds.size());
+  std::vector<std::vector<std::pair<IndexT, Observation>>> observationsPerView(bestViewIds.size());
+  std::vector<char> hasResectedPerView(bestViewIds.size(), 0);
+
   // add images to the 3D reconstruction
-#pragma omp parallel for
+#pragma omp parallel for schedule(dynamic)
   for(int i = 0; i < bestViewIds.size(); ++i)
   {
     const IndexT viewId = bestViewIds.at(i);
@@ -525,10 +538,6 @@ double ReconstructionEngine_sequentialSfM::incrementalReconstruction()
           << "\t- view id: " << viewId << std::endl
           << "\t- rig id: " << view.getRigId() << std::endl
           << "\t- sub-pose id: " << view.getSubPoseId());
-
-#pragma omp critical
-        remainingViewIds.erase(viewId);
-
         continue;
       }
 
@@ -544,33 +553,35 @@ double ReconstructionEngine_sequentialSfM::incrementalReconstruction()
           << "\t- view id: " << viewId << std::endl
           << "\t- rig id: " << view.getRigId() << std::endl
           << "\t- sub-pose id: " << view.getSubPoseId());
-
-#pragma omp critical
-        remainingViewIds.erase(viewId);
-
         continue;
       }
     }
 
-    ResectionData newResectionData;
+    ResectionData& newResectionData = resectionDataPerView[i];
     newResectionData.error_max = _params.localizerEstimatorError;
     newResectionData.max_iteration = _params.localizerEstimatorMaxIterations;
-    const bool hasResected = computeResection(viewId, newResectionData);
+    if(computeResection(viewId, newResectionData))
+    {
+      getResectionObservations(viewId, newResectionData, observationsPerView[i]);
+      hasResectedPerView[i] = 1;
+    }
+  }
 
-#pragma omp critical
+  // update the scene in the order of the best views, so the result does not depend on the threads scheduling
+  for(std::size_t i = 0; i < bestViewIds.size(); ++i)
+  {
+    const IndexT viewId = bestViewIds.at(i);
+    if(hasResectedPerView[i])
     {
-      if(hasResected)
-      {
-        updateScene(viewId, newResectionData);
-        ALICEVISION_LOG_DEBUG("Resection of image " << i << " ( view id: " << viewId << " ) succeed.");
-        _sfmData.getViews().at(viewId)->setResectionId(resectionId);
-      }
-      else
-      {
-        ALICEVISION_LOG_DEBUG("Resection of image " << i << " ( view id: " << viewId << " ) was not possible.");
-      }
-      remainingViewIds.erase(viewId);
+      updateScene(viewId, resectionDataPerView[i], observationsPerView[i]);
+      ALICEVISION_LOG_DEBUG("Resection of image " << i << " ( view id: " << viewId << " ) succeed.");
+      _sfmData.getViews().at(viewId)->setResectionId(resectionId);
     }
+    else
+    {
+      ALICEVISION_LOG_DEBUG("Resection of image " << i << " ( view id: " << viewId << " ) was not possible.");
+    }
+    remainingViewIds.erase(viewId);
   }
 
   ALICEVISION_LOG_DEBUG("Resection of " << bestViewIds.size() << " new images took " << std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - chrono_start).count() << " msec.");
@@ -611,6 +622,8 @@ bool ReconstructionEngine_sequentialSfM::bundleAdjustment(std::set<IndexT>& newR
   auto chronoStart = std::chrono::steady_clock::now();
 
   BundleAdjustmentCeres::CeresOptions options;
+  options.useAnalyticJacobians = _params.useAnalyticJacobians;
+  options.usePersistentProblem = _params.usePersistentBundleAdjustmentProblem;
   BundleAdjustment::ERefineOptions refineOptions = BundleAdjustment::REFINE_ROTATION | BundleAdjustment::REFINE_TRANSLATION | BundleAdjustment::REFINE_STRUCTURE;
 
   if(!isInitialPair && !_params.lockAllIntrinsics)
@@ -664,11 +677,30 @@ bool ReconstructionEngine_sequentialSfM::bundleAdjustment(std::set<IndexT>& newR
     }
   }
 
-  BundleAdjustmentCeres BA(options);
+  std::unique_ptr<BundleAdjustmentCeres> localBA;
+
+  if(_params.usePersistentBundleAdjustmentProblem)
+  {
+    if(_persistentBundleAdjustment == nullptr)
+    {
+      _persistentBundleAdjustment.reset(new BundleAdjustmentCeres(options));
+    }
+    else
+    {
+      // keep the same loss function instance, otherwise the problem is created from scratch
+      options.lossFunction = _persistentBundleAdjustment->getCeresOptions().lossFunction;
+      _persistentBundleAdjustment->setCeresOptions(options);
+    }
+  }
+  else
+  {
+    localBA.reset(new BundleAdjustmentCeres(options));
+  }
+
+  BundleAdjustmentCeres& BA = _params.usePersistentBundleAdjustmentProblem ? *_persistentBundleAdjustment : *localBA;
 
   // give the local strategy graph is local strategy is enable
-  if(enableLocalStrategy)
-    BA.useLocalStrategyGraph(_localStrategyGraph);
+  BA.useLocalStrategyGraph(enableLocalStrategy ? _localStrategyGraph : nullptr);
 
   // perform BA until all point are under the given precision
   do
@@ -696,7 +728,9 @@ bool ReconstructionEngine_sequentialSfM::bundleAdjustment(std::set<IndexT>& newR
     nbOutliers = removeOutliers();
 
     std::set<IndexT> removedViewsIdIteration;
-    eraseUnstablePosesAndObservations(this->_sfmData, _params.minPointsPerPose, _params.minTrackLength, &removedViewsIdIteration);
+    std::set<IndexT> removedLandmarksIdIteration;
+    eraseUnstablePosesAndObservations(this->_sfmData, _params.minPointsPerPose, _params.minTrackLength, &removedViewsIdIteration, &removedLandmarksIdIteration);
+    _changedTrackIds.insert(_changedTrackIds.end(), removedLandmarksIdIteration.begin(), removedLandmarksIdIteration.end());
 
     for(IndexT v : removedViewsIdIteration)
       newReconstructedViews.erase(v);
@@ -728,6 +762,8 @@ void ReconstructionEngine_sequentialSfM::exportStatistics(double reconstructionT
     << "\t- # poses: " << _sfmData.getPoses().size() << std::endl
     << "\t- # landmarks: " << _sfmData.getLandmarks().size() << std::endl
     << "\t- elapsed time: " << reconstructionTime << std::endl
+    << "\t- next best view selection time: " << _nextBestViewTime
+    << " (views scoring update: " << _viewsScoringUpdateTime << ", # updated tracks: " << _viewsScoringNbUpdatedTracks << ")" << std::endl
     << "\t- residual RMSE: " <<  residual);
 
   std::map<feature::EImageDescriberType, int> descTypeUsage = _sfmData.getLandmarkDescTypesUsages();
@@ -829,6 +865,9 @@ void ReconstructionEngine_sequentialSfM::exportStatistics(double reconstructionT
       _jsonLogTree.add("sfm.observationsHistogram." + std::to_string(i), obsHistogram[i]);
 
     _jsonLogTree.put("sfm.time", reconstructionTime);                        // process time
+    _jsonLogTree.put("sfm.nextBestView.time", _nextBestViewTime);             // next best view selection time
+    _jsonLogTree.put("sfm.nextBestView.scoringUpdateTime", _viewsScoringUpdateTime);
+    _jsonLogTree.put("sfm.nextBestView.nbUpdatedTracks", _viewsScoringNbUpdatedTracks);
     _jsonLogTree.put("hardware.cpu.freq", system::cpu_clock_by_os());        // cpu frequency
     _jsonLogTree.put("hardware.cpu.cores", system::get_total_cpus());        // cpu cores
     _jsonLogTree.put("hardware.ram.size", system::getMemoryInfo().totalRam); // ram size
@@ -854,27 +893,20 @@ void ReconstructionEngine_sequentialSfM::calibrateRigs(std::set<IndexT>& updated
 
 bool ReconstructionEngine_sequentialSfM::findConnectedViews(
   std::vector<ViewConnectionScore>& out_connectedViews,
-  const std::set<IndexT>& remainingViewIds) const
+  const std::set<IndexT>& remainingViewIds)
 {
   out_connectedViews.clear();
 
   if (remainingViewIds.empty() || _sfmData.getLandmarks().empty())
     return false;
 
-  // Collect tracksIds
-  std::set<size_t> reconstructed_trackId;
-  std::transform(_sfmData.getLandmarks().begin(), _sfmData.getLandmarks().end(),
-                 std::inserter(reconstructed_trackId, reconstructed_trackId.begin()),
-                 stl::RetrieveKey());
+  // only the views observing the landmarks added or removed since the last call are updated
+  updateViewsScoring();
 
   const std::set<IndexT> reconstructedIntrinsics = _sfmData.getReconstructedIntrinsics();
 
-#pragma omp parallel for
-  for(int i = 0; i < remainingViewIds.size(); ++i)
+  for(const IndexT viewId : remainingViewIds)
   {
-    std::set<IndexT>::const_iterator iter = remainingViewIds.cbegin();
-    std::advance(iter, i);
-    const IndexT viewId = *iter;
     const IndexT intrinsicId = _sfmData.getViews().at(viewId)->getIntrinsicId();
     const bool isIntrinsicsReconstructed = reconstructedIntrinsics.count(intrinsicId);
 
@@ -909,21 +941,16 @@ bool ReconstructionEngine_sequentialSfM::findConnectedViews(
       }
     }
 
-    // Count the common possible putative point
-    //  with the already 3D reconstructed trackId
-    std::vector<std::size_t> vec_trackIdForResection;
-    vec_trackIdForResection.reserve(set_tracksIds.size());
-    std::set_intersection(set_tracksIds.begin(), set_tracksIds.end(),
-                          reconstructed_trackId.begin(),
-                          reconstructed_trackId.end(),
-                          std::back_inserter(vec_trackIdForResection));
-    // Compute an image score based on the number of matches to the 3D scene
-    // and the repartition of these features in the image.
-    std::size_t score = computeCandidateImageScore(viewId, vec_trackIdForResection);
-#pragma omp critical
+    // Number of common possible putative points with the already 3D reconstructed trackIds
+    // and image score based on the repartition of these features in the image.
+    const auto scoringIt = _viewsScoring.find(viewId);
+    if(scoringIt == _viewsScoring.end())
     {
-      out_connectedViews.emplace_back(viewId, vec_trackIdForResection.size(), score, isIntrinsicsReconstructed);
+      out_connectedViews.emplace_back(viewId, 0, 0, isIntrinsicsReconstructed);
+      continue;
     }
+    const ViewScoring& viewScoring = scoringIt->second;
+    out_connectedViews.emplace_back(viewId, viewScoring.nbReconstructedTracks, computeCandidateImageScore(viewScoring), isIntrinsicsReconstructed);
   }
 
   // Sort by the image score
@@ -936,12 +963,14 @@ bool ReconstructionEngine_sequentialSfM::findConnectedViews(
 
 bool ReconstructionEngine_sequentialSfM::findNextBestViews(
   std::vector<IndexT> & out_selectedViewIds,
-  const std::set<IndexT>& remainingViewIds) const
+  const std::set<IndexT>& remainingViewIds)
 {
   out_selectedViewIds.clear();
   auto chrono_start = std::chrono::steady_clock::now();
   std::vector<ViewConnectionScore> vec_viewsScore;
-  if(!findConnectedViews(vec_viewsScore, remainingViewIds))
+  const bool hasConnectedViews = findConnectedViews(vec_viewsScore, remainingViewIds);
+  _nextBestViewTime += std::chrono::duration<double>(std::chrono::steady_clock::now() - chrono_start).count();
+  if(!hasConnectedViews)
   {
     ALICEVISION_LOG_DEBUG("FindConnectedViews does not find connected new views ");
     return false;
@@ -1141,6 +1170,8 @@ bool ReconstructionEngine_sequentialSfM::makeInitialPair3D(const Pair& currentPa
         // because it can failed after multiple iterations
         // we need to clear poses & rigs & landmarks
         _sfmData.getPoses().clear();
+        for(const auto& landmarkIt : _sfmData.getLandmarks())
+          _changedTrackIds.push_back(landmarkIt.first);
         _sfmData.getLandmarks().clear();
         _sfmData.resetRigs();
 
@@ -1400,6 +1431,92 @@ std::size_t ReconstructionEngine_sequentialSfM::computeCandidateImageScore(Index
 #endif
 }
 
+std::size_t ReconstructionEngine_sequentialSfM::computeCandidateImageScore(const ViewScoring& viewScoring) const
+{
+#ifdef ALICEVISION_NEXTBESTVIEW_WITHOUT_SCORE
+  return viewScoring.nbReconstructedTracks;
+#else
+  std::size_t score = 0;
+  // The number of cells of the pyramid grid represent the score
+  // and ensure a proper repartition of features in images.
+  // Same score as above, with the cells occupancy maintained by updateViewsScoring.
+  for(std::size_t level = 0; level < _params.pyramidDepth; ++level)
+    score += viewScoring.nbOccupiedCellsPerLevel[level] * _pyramidWeights[level];
+  return score;
+#endif
+}
+
+void ReconstructionEngine_sequentialSfM::updateViewsScoring()
+{
+  aliceVision::system::Timer timer;
+  const Landmarks& landmarks = _sfmData.getLandmarks();
+  std::size_t nbAddedTracks = 0;
+  std::size_t nbRemovedTracks = 0;
+
+  // only the tracks whose landmark has been added or removed since the last call are visited
+  for(const std::size_t trackId : _changedTrackIds)
+  {
+    // landmarks without corresponding track are not connected to any remaining view
+    if(trackId >= _isTrackScored.size() || !_map_tracks.count(trackId))
+      continue;
+    const char isReconstructed = landmarks.count(trackId) ? 1 : 0;
+    // the track may have been added then removed, or listed several times
+    if(_isTrackScored[trackId] == isReconstructed)
+      continue;
+    _isTrackScored[trackId] = isReconstructed;
+    updateViewsScoring(trackId, isReconstructed != 0);
+    if(isReconstructed)
+      ++nbAddedTracks;
+    else
+      ++nbRemovedTracks;
+  }
+  _changedTrackIds.clear();
+
+  _viewsScoringUpdateTime += timer.elapsed();
+  _viewsScoringNbUpdatedTracks += nbAddedTracks + nbRemovedTracks;
+
+  ALICEVISION_LOG_DEBUG("Update views scoring: " << nbAddedTracks << " tracks added, " << nbRemovedTracks << " tracks removed"
+                        " in " << timer.elapsedMs() << " msec.");
+}
+
+void ReconstructionEngine_sequentialSfM::updateViewsScoring(std::size_t trackId, bool isAdded)
+{
+  const track::Track& track = _map_tracks.at(trackId);
+  for(const auto& featIt : track.featPerView)
+  {
+    const IndexT viewId = featIt.first;
+    ViewScoring& viewScoring = _viewsScoring[viewId];
+    if(viewScoring.nbTracksPerCell.empty())
+    {
+      viewScoring.nbTracksPerCell.assign(_pyramidNbCells, 0);
+      viewScoring.nbOccupiedCellsPerLevel.assign(_params.pyramidDepth, 0);
+    }
+
+    const auto& featsPyramid = _map_featsPyramidPerView.at(viewId);
+
+    if(isAdded)
+    {
+      ++viewScoring.nbReconstructedTracks;
+      for(std::size_t level = 0; level < _params.pyramidDepth; ++level)
+      {
+        const std::size_t pyramidIndex = featsPyramid.at(trackId * _params.pyramidDepth + level);
+        if(viewScoring.nbTracksPerCell[pyramidIndex]++ == 0)
+          ++viewScoring.nbOccupiedCellsPerLevel[level];
+      }
+    }
+    else
+    {
+      --viewScoring.nbReconstructedTracks;
+      for(std::size_t level = 0; level < _params.pyramidDepth; ++level)
+      {
+        const std::size_t pyramidIndex = featsPyramid.at(trackId * _params.pyramidDepth + level);
+        if(--viewScoring.nbTracksPerCell[pyramidIndex] == 0)
+          --viewScoring.nbOccupiedCellsPerLevel[level];
+      }
+    }
+  }
+}
+
 
 /**
  * @brief Add one image to the 3D reconstruction. To the resectioning of
@@ -1515,6 +1632,20 @@ bool ReconstructionEngine_sequentialSfM::computeResection(const IndexT viewId, R
       throw std::runtime_error("Intrinsic " + std::to_string(view_I->getIntrinsicId()) + " is not a Pinhole camera. This is not supported in the incremental pipeline." );
 
     resectionData.isNewIntrinsic = !pinhole_cam->isValid();
+
+    const std::set<IndexT> reconstructedIntrinsics = _sfmData.getReconstructedIntrinsics();
+    // If we use a camera intrinsic for the first time we need to refine it.
+    const bool intrinsicsFirstUsage = (reconstructedIntrinsics.count(view_I->getIntrinsicId()) == 0);
+    resectionData.isIntrinsicRefined = resectionData.isNewIntrinsic || intrinsicsFirstUsage;
+
+    if(resectionData.isIntrinsicRefined)
+    {
+      // the views of a resection group are localized in parallel,
+      // so the intrinsic is estimated on a copy and updated in the scene by updateScene
+      resectionData.optionalIntrinsic.reset(resectionData.optionalIntrinsic->clone());
+      pinhole_cam = dynamic_cast<camera::Pinhole *>(resectionData.optionalIntrinsic.get());
+    }
+
     // A valid pose has been found (try to refine it):
     // If no valid intrinsic as input:
     //  init a new one from the projection matrix decomposition
@@ -1533,13 +1664,9 @@ bool ReconstructionEngine_sequentialSfM::computeResection(const IndexT viewId, R
       pinhole_cam->setK(focal, principal_point(0), principal_point(1));
     }
 
-    const std::set<IndexT> reconstructedIntrinsics = _sfmData.getReconstructedIntrinsics();
-    // If we use a camera intrinsic for the first time we need to refine it.
-    const bool intrinsicsFirstUsage = (reconstructedIntrinsics.count(view_I->getIntrinsicId()) == 0);
-
     if(!sfm::SfMLocalizer::RefinePose(
       resectionData.optionalIntrinsic.get(), resectionData.pose,
-      resectionData, true, resectionData.isNewIntrinsic || intrinsicsFirstUsage))
+      resectionData, true, resectionData.isIntrinsicRefined))
     {
       ALICEVISION_LOG_INFO("Resection of view " << viewId << " failed during pose refinement.");
       return false;
@@ -1548,18 +1675,14 @@ bool ReconstructionEngine_sequentialSfM::computeResection(const IndexT viewId, R
   return true;
 }
 
-void ReconstructionEngine_sequentialSfM::updateScene(const IndexT viewIndex, const ResectionData& resectionData)
-{ 
-  // A. Update the global scene with the new found camera pose, intrinsic (if not defined)
-
-  // update the view pose or rig pose/sub-pose
-  _map_ACThreshold.insert(std::make_pair(viewIndex, resectionData.error_max));
-
-  const View& view = *_sfmData.views.at(viewIndex);
-  _sfmData.setPose(view, CameraPose(resectionData.pose));
+void ReconstructionEngine_sequentialSfM::getResectionObservations(const IndexT viewIndex,
+                                                                  const ResectionData& resectionData,
+                                                                  std::vector<std::pair<IndexT, Observation>>& observations) const
+{
+  observations.clear();
+  observations.reserve(resectionData.pt2D.cols());
 
-  // B. Update the observations into the global scene structure
-  // - Add the new 2D observations to the reconstructed tracks
+  // Select the 2D observations that are inliers for the estimated pose
   std::set<std::size_t>::const_iterator iterTrackId = resectionData.tracksId.begin();
   for (std::size_t i = 0; i < resectionData.pt2D.cols(); ++i, ++iterTrackId)
   {
@@ -1569,15 +1692,37 @@ void ReconstructionEngine_sequentialSfM::updateScene(const IndexT viewIndex, con
     if (residual.norm() < resectionData.error_max &&
         resectionData.pose.depth(X) > 0)
     {
-      Landmark& landmark = _sfmData.structure[*iterTrackId];
       const IndexT idFeat = resectionData.featuresId[i].second;
-      const double scale = (_params.featureConstraint == EFeatureConstraint::BASIC) ? 0.0 : _featuresPerView->getFeatures(viewIndex, landmark.descType)[idFeat].scale();
-      // Inlier, add the point to the reconstructed track
-      landmark.observations[viewIndex] = Observation(x, idFeat, scale);
+      const double scale = (_params.featureConstraint == EFeatureConstraint::BASIC) ? 0.0 : _featuresPerView->getFeatures(viewIndex, resectionData.featuresId[i].first)[idFeat].scale();
+      observations.emplace_back(*iterTrackId, Observation(x, idFeat, scale));
     }
   }
 }
 
+void ReconstructionEngine_sequentialSfM::updateScene(const IndexT viewIndex,
+                                                     const ResectionData& resectionData,
+                                                     const std::vector<std::pair<IndexT, Observation>>& observations)
+{
+  // A. Update the global scene with the new found camera pose, intrinsic (if not defined)
+
+  const View& view = *_sfmData.views.at(viewIndex);
+
+  // the intrinsic has been estimated on a copy (see computeResection),
+  // the first localized view using it gives its value to the scene
+  if(resectionData.isIntrinsicRefined && _sfmData.getReconstructedIntrinsics().count(view.getIntrinsicId()) == 0)
+    _sfmData.intrinsics.at(view.getIntrinsicId())->assign(*resectionData.optionalIntrinsic);
+
+  // update the view pose or rig pose/sub-pose
+  _map_ACThreshold.insert(std::make_pair(viewIndex, resectionData.error_max));
+
+  _sfmData.setPose(view, CameraPose(resectionData.pose));
+
+  // B. Update the observations into the global scene structure
+  // - Add the new 2D observations to the reconstructed tracks
+  for(const auto& observation : observations)
+    _sfmData.structure.at(observation.first).observations[viewIndex] = observation.second;
+}
+
 bool ReconstructionEngine_sequentialSfM::checkChieralities(
   const Vec3& pt3D, 
   const std::set<IndexT> & viewsId, 
@@ -1792,6 +1937,7 @@ void ReconstructionEngine_sequentialSfM::triangulate_multiViewsLORANSAC(SfMData&
 #pragma omp critical
       {
         scene.structure[trackId] = landmark;
+        _changedTrackIds.push_back(trackId);
       }      
     }
     else
@@ -1799,7 +1945,10 @@ void ReconstructionEngine_sequentialSfM::triangulate_multiViewsLORANSAC(SfMData&
 #pragma omp critical
       {
         if (scene.structure.find(trackId) != scene.structure.end()) 
+        {
           scene.structure.erase(trackId);
+          _changedTrackIds.push_back(trackId);
+        }
       }
     }
   } // for all shared tracks 
@@ -1951,6 +2100,7 @@ void ReconstructionEngine_sequentialSfM::triangulate_2Views(SfMData& scene, cons
               const double scaleJ = (_params.featureConstraint == EFeatureConstraint::BASIC) ? 0.0 : featJ.scale();
               landmark.observations[I] = Observation(xI, track.featPerView.at(I), scaleI);
               landmark.observations[J] = Observation(xJ, track.featPerView.at(J), scaleJ);
+              _changedTrackIds.push_back(trackId);
               
               ++new_added_track;
             } // critical
@@ -1972,8 +2122,10 @@ void ReconstructionEngine_sequentialSfM::triangulate_2Views(SfMData& scene, cons
 
 std::size_t ReconstructionEngine_sequentialSfM::removeOutliers()
 {
-  const std::size_t nbOutliersResidualErr = RemoveOutliers_PixelResidualError(_sfmData, _params.featureConstraint, _params.maxReprojectionError, 2);
-  const std::size_t nbOutliersAngleErr = RemoveOutliers_AngleError(_sfmData, _params.minAngleForLandmark);
+  std::set<IndexT> removedLandmarksId;
+  const std::size_t nbOutliersResidualErr = RemoveOutliers_PixelResidualError(_sfmData, _params.featureConstraint, _params.maxReprojectionError, 2, &removedLandmarksId);
+  const std::size_t nbOutliersAngleErr = RemoveOutliers_AngleError(_sfmData, _params.minAngleForLandmark, &removedLandmarksId);
+  _changedTrackIds.insert(_changedTrackIds.end(), removedLandmarksId.begin(), removedLandmarksId.end());
 
   ALICEVISION_LOG_INFO("Remove outliers: " << std::endl
                         << "\t- # outliers residual error: " << nbOutliersResidualErr << std::endl
@@ -9,6 +9,7 @@
 
 #include <aliceVision/sfm/pipeline/ReconstructionEngine.hpp>
 #include <aliceVision/sfm/LocalBundleAdjustmentGraph.hpp>
+#include <aliceVision/sfm/BundleAdjustmentCeres.hpp>
 #include <aliceVision/sfm/pipeline/localization/SfMLocalizer.hpp>
 #include <aliceVision/sfm/pipeline/pairwiseMatchesIO.hpp>
 #include <aliceVision/sfmDataIO/sfmDataIO.hpp>
@@ -43,6 +44,10 @@ public:
     int minPointsPerPose = 30;
     bool useLocalBundleAdjustment = false;
     int localBundelAdjustementGraphDistanceLimit = 1;
+    /// use the cost functions with analytic jacobians in the bundle adjustment
+    bool useAnalyticJacobians = false;
+    /// keep the bundle adjustment problem between the iterations and only update its modified blocks
+    bool usePersistentBundleAdjustmentProblem = false;
 
     bool useRigConstraint = true;
 
@@ -197,7 +202,7 @@ public:
    * @return False if there is no view connected.
    */
   bool findConnectedViews(std::vector<ViewConnectionScore>& out_connectedViews,
-                          const std::set<IndexT>& remainingViewIds) const;
+                          const std::set<IndexT>& remainingViewIds);
 
   /**
    * @brief Estimate the best images on which we can compute the resectioning safely.
@@ -209,10 +214,21 @@ public:
    * @return False if there is no possible resection.
    */
   bool findNextBestViews(std::vector<IndexT>& out_selectedViewIds,
-                         const std::set<IndexT>& remainingViewIds) const;
+                         const std::set<IndexT>& remainingViewIds);
 
 private:
 
+  /// Data used to score a view for the next best view choice
+  struct ViewScoring
+  {
+    /// number of tracks of the view with a landmark
+    std::size_t nbReconstructedTracks = 0;
+    /// number of reconstructed tracks in each cell of the pyramid
+    std::vector<unsigned int> nbTracksPerCell;
+    /// number of non-empty cells in each level of the pyramid
+    std::vector<std::size_t> nbOccupiedCellsPerLevel;
+  };
+
   struct ResectionData : ImageLocalizerMatchData
   {
     /// tracks index for resection
@@ -225,6 +241,8 @@ private:
     std::shared_ptr<camera::IntrinsicBase> optionalIntrinsic = nullptr;
     /// the instrinsic already exists in the scene or not.
     bool isNewIntrinsic;
+    /// the intrinsic has been refined, optionalIntrinsic is a copy of the scene intrinsic
+    bool isIntrinsicRefined = false;
   };
 
   /**
@@ -262,6 +280,29 @@ private:
    */
   std::size_t computeCandidateImageScore(IndexT viewId, const std::vector<std::size_t>& trackIds) const;
 
+  /**
+   * @brief Compute the score of a view for its reconstructed tracks (see above),
+   *        from the pyramid cells occupancy maintained incrementally.
+   * @param[in] viewScoring: the reconstructed tracks and pyramid cells occupancy of the view
+   * @return the computed score
+   */
+  std::size_t computeCandidateImageScore(const ViewScoring& viewScoring) const;
+
+  /**
+   * @brief Update the number of reconstructed tracks and the pyramid cells occupancy of each view
+   *        with the landmarks added or removed since the last call.
+   * @note Only the trackIds recorded in _changedTrackIds by the triangulation, the outliers removal
+   *       and the landmarks remapping are visited.
+   */
+  void updateViewsScoring();
+
+  /**
+   * @brief Add or remove a reconstructed track in the scoring of its views.
+   * @param[in] trackId: the track ID
+   * @param[in] isAdded: true if the track has been reconstructed, false if it has been removed
+   */
+  void updateViewsScoring(std::size_t trackId, bool isAdded);
+
   /**
    * @brief Apply the resection on a single view.
    * @param[in] viewIndex: image index to add to the reconstruction.
@@ -273,10 +314,25 @@ private:
   /**
    * @brief Update the global scene with the new found camera pose, intrinsic (if not defined) and 
    * Update its observations into the global scene structure.
+   * The inlier observations are selected by getResectionObservations.
+   * @param[in] viewIndex: image index added to the reconstruction.
+   * @param[in] resectionData: contains the camera pose and all data used during the resection.
+   * @param[in] observations: the new observation of the view for each landmark id.
+   */
+  void updateScene(const IndexT viewIndex,
+                   const ResectionData& resectionData,
+                   const std::vector<std::pair<IndexT, sfmData::Observation>>& observations);
+
+  /**
+   * @brief Select the 2D-3D correspondences of a resection that are inliers for the estimated pose.
+   * @note Does not modify the scene, so it can be called in parallel for several views.
    * @param[in] viewIndex: image index added to the reconstruction.
    * @param[in] resectionData: contains the camera pose and all data used during the resection.
+   * @param[out] observations: the new observation of the view for each landmark id.
    */
-  void updateScene(const IndexT viewIndex, const ResectionData& resectionData);
+  void getResectionObservations(const IndexT viewIndex,
+                                const ResectionData& resectionData,
+                                std::vector<std::pair<IndexT, sfmData::Observation>>& observations) const;
                    
   /**
    * @brief  Triangulate new possible 2D tracks
@@ -352,6 +408,20 @@ private:
   /// internal cache of precomputed values for the weighting of the pyramid levels
   std::vector<int> _pyramidWeights;
   int _pyramidThreshold;
+  /// number of cells of all the pyramid levels
+  std::size_t _pyramidNbCells = 0;
+  /// scoring of each view, updated with the landmarks changes
+  HashMap<IndexT, ViewScoring> _viewsScoring;
+  /// true for each trackId with a landmark taken into account in the views scoring
+  std::vector<char> _isTrackScored;
+  /// trackIds whose landmark has been added or removed since the last views scoring update
+  std::vector<std::size_t> _changedTrackIds;
+  /// time spent in the next best view selection (in seconds)
+  double _nextBestViewTime = 0.0;
+  /// time spent in the views scoring update (in seconds)
+  double _viewsScoringUpdateTime = 0.0;
+  /// number of tracks added or removed from the views scoring
+  std::size_t _viewsScoringNbUpdatedTracks = 0;
 
   // Temporary data
 
@@ -368,6 +438,8 @@ private:
 
   /// Contains all the data used by the Local BA approach
   std::shared_ptr<LocalBundleAdjustmentGraph> _localStrategyGraph;
+  /// Bundle adjustment engine kept between the iterations (if usePersistentBundleAdjustmentProblem)
+  std::unique_ptr<BundleAdjustmentCeres> _persistentBundleAdjustment;
 
   // Log
 
@@ -0,0 +1,168 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2020 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include <aliceVision/sfm/ResidualErrorFunctor.hpp>
+#include <aliceVision/sfm/ResidualErrorAnalyticFunctor.hpp>
+
+#include <ceres/ceres.h>
+
+#include <memory>
+#include <random>
+#include <vector>
+
+#define BOOST_TEST_MODULE residualErrorAnalyticFunctor
+
+#include <boost/test/unit_test.hpp>
+#include <boost/test/tools/floating_point_comparison.hpp>
+
+using namespace aliceVision;
+using namespace aliceVision::sfm;
+
+/**
+ * @brief Evaluate both cost functions with the same parameters and check that
+ *        the residuals and all the jacobians are the same.
+ */
+void checkSameEvaluation(const ceres::CostFunction& autoDiffCost,
+                         const ceres::CostFunction& analyticCost,
+                         const std::vector<std::vector<double>>& parameters)
+{
+  const std::vector<int>& blockSizes = autoDiffCost.parameter_block_sizes();
+  BOOST_REQUIRE(blockSizes == analyticCost.parameter_block_sizes());
+  BOOST_REQUIRE_EQUAL(autoDiffCost.num_residuals(), 2);
+  BOOST_REQUIRE_EQUAL(analyticCost.num_residuals(), 2);
+  BOOST_REQUIRE_EQUAL(blockSizes.size(), parameters.size());
+
+  std::vector<const double*> parametersPtr;
+  for(const auto& block : parameters)
+    parametersPtr.push_back(block.data());
+
+  std::vector<std::vector<double>> autoDiffJacobians, analyticJacobians;
+  std::vector<double*> autoDiffJacobiansPtr, analyticJacobiansPtr;
+  for(const int blockSize : blockSizes)
+  {
+    autoDiffJacobians.emplace_back(2 * blockSize, 0.0);
+    analyticJacobians.emplace_back(2 * blockSize, 0.0);
+  }
+  for(std::size_t i = 0; i < blockSizes.size(); ++i)
+  {
+    autoDiffJacobiansPtr.push_back(autoDiffJacobians[i].data());
+    analyticJacobiansPtr.push_back(analyticJacobians[i].data());
+  }
+
+  double autoDiffResiduals[2];
+  double analyticResiduals[2];
+  BOOST_REQUIRE(autoDiffCost.Evaluate(parametersPtr.data(), autoDiffResiduals, autoDiffJacobiansPtr.data()));
+  BOOST_REQUIRE(analyticCost.Evaluate(parametersPtr.data(), analyticResiduals, analyticJacobiansPtr.data()));
+
+  for(int r = 0; r < 2; ++r)
+    BOOST_CHECK_SMALL(autoDiffResiduals[r] - analyticResiduals[r], 1e-9);
+
+  for(std::size_t i = 0; i < blockSizes.size(); ++i)
+  {
+    for(std::size_t j = 0; j < autoDiffJacobians[i].size(); ++j)
+    {
+      const double tolerance = 1e-8 * std::max(1.0, std::abs(autoDiffJacobians[i][j]));
+      BOOST_CHECK_SMALL(autoDiffJacobians[i][j] - analyticJacobians[i][j], tolerance);
+    }
+  }
+
+  // residuals only
+  double residualsOnly[2];
+  BOOST_REQUIRE(analyticCost.Evaluate(parametersPtr.data(), residualsOnly, nullptr));
+  BOOST_CHECK_EQUAL(residualsOnly[0], analyticResiduals[0]);
+  BOOST_CHECK_EQUAL(residualsOnly[1], analyticResiduals[1]);
+}
+
+/**
+ * @brief Compare the analytic cost functions of a camera model with the automatic differentiation
+ *        on random scenes, with and without rig.
+ */
+template <typename AutoDiffFunctor, typename AnalyticCost, typename RigAnalyticCost, int IntrinsicSize>
+void checkCameraModel(const std::vector<double>& distortion, double maxDistortion)
+{
+  std::mt19937 gen(42);
+  std::uniform_real_distribution<double> distUnit(-1.0, 1.0);
+
+  for(int iteration = 0; iteration < 50; ++iteration)
+  {
+    const double scale = (iteration % 2) ? 0.0 : 2.0 + distUnit(gen);
+    const sfmData::Observation observation(Vec2(1000.0 + 200.0 * distUnit(gen), 750.0 + 200.0 * distUnit(gen)), 0, scale);
+
+    std::vector<double> intrinsic = {1500.0 + 100.0 * distUnit(gen), 1000.0 + 10.0 * distUnit(gen), 750.0 + 10.0 * distUnit(gen)};
+    for(const double d : distortion)
+      intrinsic.push_back(d + maxDistortion * distUnit(gen));
+    BOOST_REQUIRE_EQUAL(intrinsic.size(), IntrinsicSize);
+
+    // the first iterations use null rotations (first order rotation)
+    const double rotationScale = (iteration < 2) ? 0.0 : 0.5;
+    std::vector<double> pose = {rotationScale * distUnit(gen), rotationScale * distUnit(gen), rotationScale * distUnit(gen),
+                                distUnit(gen), distUnit(gen), distUnit(gen)};
+    std::vector<double> subpose = {0.1 * distUnit(gen), 0.1 * distUnit(gen), 0.1 * distUnit(gen),
+                                   0.2 * distUnit(gen), 0.2 * distUnit(gen), 0.2 * distUnit(gen)};
+
+    // a point in front of the camera
+    const double* R = pose.data();
+    Vec3 ptCam(0.5 * distUnit(gen), 0.5 * distUnit(gen), 5.0 + distUnit(gen));
+    Mat3 rotation;
+    Vec3 unused;
+    analytic::angleAxisRotatePoint(R, Vec3::Zero(), rotation, unused, nullptr);
+    const Vec3 pt = rotation.transpose() * (ptCam - Vec3(pose[3], pose[4], pose[5]));
+    std::vector<double> point = {pt(0), pt(1), pt(2)};
+
+    {
+      ceres::AutoDiffCostFunction<AutoDiffFunctor, 2, IntrinsicSize, 6, 3> autoDiffCost(new AutoDiffFunctor(observation));
+      AnalyticCost analyticCost(observation);
+      checkSameEvaluation(autoDiffCost, analyticCost, {intrinsic, pose, point});
+    }
+    {
+      ceres::AutoDiffCostFunction<AutoDiffFunctor, 2, IntrinsicSize, 6, 6, 3> autoDiffCost(new AutoDiffFunctor(observation));
+      RigAnalyticCost analyticCost(observation);
+      checkSameEvaluation(autoDiffCost, analyticCost, {intrinsic, pose, subpose, point});
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE(ResidualErrorAnalyticFunctor_Pinhole)
+{
+  checkCameraModel<ResidualErrorFunctor_Pinhole,
+                   ResidualErrorAnalyticCostFunction_Pinhole,
+                   ResidualErrorRigAnalyticCostFunction_Pinhole, 3>({}, 0.0);
+}
+
+BOOST_AUTO_TEST_CASE(ResidualErrorAnalyticFunctor_PinholeRadialK1)
+{
+  checkCameraModel<ResidualErrorFunctor_PinholeRadialK1,
+                   ResidualErrorAnalyticCostFunction_PinholeRadialK1,
+                   ResidualErrorRigAnalyticCostFunction_PinholeRadialK1, 4>({0.0}, 0.1);
+}
+
+BOOST_AUTO_TEST_CASE(ResidualErrorAnalyticFunctor_PinholeRadialK3)
+{
+  checkCameraModel<ResidualErrorFunctor_PinholeRadialK3,
+                   ResidualErrorAnalyticCostFunction_PinholeRadialK3,
+                   ResidualErrorRigAnalyticCostFunction_PinholeRadialK3, 6>({0.0, 0.0, 0.0}, 0.1);
+}
+
+BOOST_AUTO_TEST_CASE(ResidualErrorAnalyticFunctor_PinholeBrownT2)
+{
+  checkCameraModel<ResidualErrorFunctor_PinholeBrownT2,
+                   ResidualErrorAnalyticCostFunction_PinholeBrownT2,
+                   ResidualErrorRigAnalyticCostFunction_PinholeBrownT2, 8>({0.0, 0.0, 0.0, 0.0, 0.0}, 0.05);
+}
+
+BOOST_AUTO_TEST_CASE(ResidualErrorAnalyticFunctor_PinholeFisheye)
+{
+  checkCameraModel<ResidualErrorFunctor_PinholeFisheye,
+                   ResidualErrorAnalyticCostFunction_PinholeFisheye,
+                   ResidualErrorRigAnalyticCostFunction_PinholeFisheye, 7>({0.0, 0.0, 0.0, 0.0}, 0.1);
+}
+
+BOOST_AUTO_TEST_CASE(ResidualErrorAnalyticFunctor_PinholeFisheye1)
+{
+  checkCameraModel<ResidualErrorFunctor_PinholeFisheye1,
+                   ResidualErrorAnalyticCostFunction_PinholeFisheye1,
+                   ResidualErrorRigAnalyticCostFunction_PinholeFisheye1, 4>({1.0}, 0.2);
+}
@@ -19,7 +19,8 @@ namespace sfm {
 IndexT RemoveOutliers_PixelResidualError(sfmData::SfMData& sfmData,
                                          EFeatureConstraint featureConstraint,
                                          const double dThresholdPixel,
-                                         const unsigned int minTrackLength)
+                                         const unsigned int minTrackLength,
+                                         std::set<IndexT>* outRemovedLandmarksId)
 {
   IndexT outlier_count = 0;
   sfmData::Landmarks::iterator iterTracks = sfmData.structure.begin();
@@ -54,14 +55,18 @@ IndexT RemoveOutliers_PixelResidualError(sfmData::SfMData& sfmData,
     }
 
     if (observations.empty() || observations.size() < minTrackLength)
+    {
+      if(outRemovedLandmarksId != NULL)
+        outRemovedLandmarksId->insert(iterTracks->first);
       iterTracks = sfmData.structure.erase(iterTracks);
+    }
     else
       ++iterTracks;
   }
   return outlier_count;
 }
 
-IndexT RemoveOutliers_AngleError(sfmData::SfMData& sfmData, const double dMinAcceptedAngle)
+IndexT RemoveOutliers_AngleError(sfmData::SfMData& sfmData, const double dMinAcceptedAngle, std::set<IndexT>* outRemovedLandmarksId)
 {
   IndexT removedTrack_count = 0;
   sfmData::Landmarks::iterator iterTracks = sfmData.structure.begin();
@@ -91,6 +96,8 @@ IndexT RemoveOutliers_AngleError(sfmData::SfMData& sfmData, const double dMinAcc
     }
     if (max_angle < dMinAcceptedAngle)
     {
+      if(outRemovedLandmarksId != NULL)
+        outRemovedLandmarksId->insert(iterTracks->first);
       iterTracks = sfmData.structure.erase(iterTracks);
       ++removedTrack_count;
     }
@@ -161,7 +168,7 @@ bool eraseUnstablePoses(sfmData::SfMData& sfmData, const IndexT min_points_per_p
   return removed_elements > 0;
 }
 
-bool eraseObservationsWithMissingPoses(sfmData::SfMData& sfmData, const IndexT min_points_per_landmark)
+bool eraseObservationsWithMissingPoses(sfmData::SfMData& sfmData, const IndexT min_points_per_landmark, std::set<IndexT>* outRemovedLandmarksId)
 {
   IndexT removed_elements = 0;
 
@@ -192,7 +199,11 @@ bool eraseObservationsWithMissingPoses(sfmData::SfMData& sfmData, const IndexT m
     }
 
     if(observations.empty() || observations.size() < min_points_per_landmark)
+    {
+      if(outRemovedLandmarksId != NULL)
+        outRemovedLandmarksId->insert(itLandmarks->first);
       itLandmarks = sfmData.structure.erase(itLandmarks);
+    }
     else
       ++itLandmarks;
   }
@@ -203,7 +214,8 @@ bool eraseObservationsWithMissingPoses(sfmData::SfMData& sfmData, const IndexT m
 bool eraseUnstablePosesAndObservations(sfmData::SfMData& sfmData,
                                        const IndexT min_points_per_pose,
                                        const IndexT min_points_per_landmark,
-                                       std::set<IndexT>* outRemovedViewsId)
+                                       std::set<IndexT>* outRemovedViewsId,
+                                       std::set<IndexT>* outRemovedLandmarksId)
 {
   IndexT removeIteration = 0;
   bool removedContent = false;
@@ -215,7 +227,7 @@ bool eraseUnstablePosesAndObservations(sfmData::SfMData& sfmData,
     if(eraseUnstablePoses(sfmData, min_points_per_pose, outRemovedViewsId))
     {
       removedPoses = true;
-      removedContent = eraseObservationsWithMissingPoses(sfmData, min_points_per_landmark);
+      removedContent = eraseObservationsWithMissingPoses(sfmData, min_points_per_landmark, outRemovedLandmarksId);
       if(removedContent)
         removedObservations = true;
       // Erase some observations can make some Poses index disappear so perform the process in a loop
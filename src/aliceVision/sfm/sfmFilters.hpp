@@ -33,24 +33,27 @@ inline PairSet Pair_filter(const IterablePairs& pairs, const IterableIndex& inde
 
 /// Remove observations with too large reprojection error.
 /// Return the number of removed tracks.
+/// The ids of the removed landmarks are added to outRemovedLandmarksId if provided.
 IndexT RemoveOutliers_PixelResidualError(sfmData::SfMData& sfmData,
                                          EFeatureConstraint featureConstraint,
                                          const double dThresholdPixel,
-                                         const unsigned int minTrackLength = 2);
+                                         const unsigned int minTrackLength = 2,
+                                         std::set<IndexT> *outRemovedLandmarksId = NULL);
 
 // Remove tracks that have a small angle (tracks with tiny angle leads to instable 3D points)
 // Return the number of removed tracks
-IndexT RemoveOutliers_AngleError(sfmData::SfMData& sfmData, const double dMinAcceptedAngle);
+IndexT RemoveOutliers_AngleError(sfmData::SfMData& sfmData, const double dMinAcceptedAngle, std::set<IndexT> *outRemovedLandmarksId = NULL);
 
 bool eraseUnstablePoses(sfmData::SfMData& sfmData, const IndexT min_points_per_pose, std::set<IndexT> *outRemovedViewsId = NULL);
 
-bool eraseObservationsWithMissingPoses(sfmData::SfMData& sfmData, const IndexT min_points_per_landmark);
+bool eraseObservationsWithMissingPoses(sfmData::SfMData& sfmData, const IndexT min_points_per_landmark, std::set<IndexT> *outRemovedLandmarksId = NULL);
 
 /// Remove unstable content from analysis of the sfm_data structure
 bool eraseUnstablePosesAndObservations(sfmData::SfMData& sfmData,
                                        const IndexT min_points_per_pose = 6,
                                        const IndexT min_points_per_landmark = 2, 
-                                       std::set<IndexT> *outRemovedViewsId = NULL);
+                                       std::set<IndexT> *outRemovedViewsId = NULL,
+                                       std::set<IndexT> *outRemovedLandmarksId = NULL);
 
 } // namespace sfm
 } // namespace aliceVision
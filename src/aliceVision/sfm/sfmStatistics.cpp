@@ -16,7 +16,12 @@
 namespace aliceVision {
 namespace sfm {
 
-void computeResidualsHistogram(const sfmData::SfMData& sfmData, BoxStats<double>& out_stats, Histogram<double>* out_histogram, const std::set<IndexT>& specificViews)
+namespace {
+
+// the landmarks traversals are shared by the sfmData::Landmarks and sfmData::LandmarkStore versions
+
+template<typename LandmarksT>
+void computeResidualsHistogram(const sfmData::SfMData& sfmData, const LandmarksT& landmarks, BoxStats<double>& out_stats, Histogram<double>* out_histogram, const std::set<IndexT>& specificViews)
 {
   {
     // Init output params
@@ -26,16 +31,16 @@ void computeResidualsHistogram(const sfmData::SfMData& sfmData, BoxStats<double>
       *out_histogram = Histogram<double>();
     }
   }
-  if (sfmData.getLandmarks().empty())
+  if (landmarks.empty())
     return;
 
   // Collect residuals for each observation
   std::vector<double> vec_residuals;
-  vec_residuals.reserve(sfmData.structure.size());
+  vec_residuals.reserve(landmarks.size());
 
-  for(const auto &track : sfmData.getLandmarks())
+  for(const auto &track : landmarks)
   {
-    const aliceVision::sfmData::Observations & observations = track.second.observations;
+    const auto& observations = track.second.observations;
     for(const auto& obs: observations)
     {
       if(!specificViews.empty())
@@ -67,7 +72,8 @@ void computeResidualsHistogram(const sfmData::SfMData& sfmData, BoxStats<double>
 }
 
 
-void computeObservationsLengthsHistogram(const sfmData::SfMData& sfmData, BoxStats<double>& out_stats, int& overallNbObservations, Histogram<double>* out_histogram, const std::set<IndexT>& specificViews)
+template<typename LandmarksT>
+void computeObservationsLengthsHistogram(const LandmarksT& landmarks, BoxStats<double>& out_stats, int& overallNbObservations, Histogram<double>* out_histogram, const std::set<IndexT>& specificViews)
 {
   {
     // Init output params
@@ -77,16 +83,16 @@ void computeObservationsLengthsHistogram(const sfmData::SfMData& sfmData, BoxSta
       *out_histogram = Histogram<double>();
     }
   }
-  if (sfmData.getLandmarks().empty())
+  if (landmarks.empty())
     return;
 
   // Collect tracks size: number of 2D observations per 3D points
   std::vector<int> nbObservations;
-  nbObservations.reserve(sfmData.getLandmarks().size());
+  nbObservations.reserve(landmarks.size());
 
-  for(const auto& landmark : sfmData.getLandmarks())
+  for(const auto& landmark : landmarks)
   {
-    const aliceVision::sfmData::Observations & observations = landmark.second.observations;
+    const auto& observations = landmark.second.observations;
     if (!specificViews.empty())
     {
         int nbObsSpecificViews = 0;
@@ -121,7 +127,8 @@ void computeObservationsLengthsHistogram(const sfmData::SfMData& sfmData, BoxSta
   }
 }
 
-void computeLandmarksPerViewHistogram(const sfmData::SfMData& sfmData, BoxStats<double>& out_stats, Histogram<double>* out_histogram)
+template<typename LandmarksT>
+void computeLandmarksPerViewHistogram(const LandmarksT& landmarks, BoxStats<double>& out_stats, Histogram<double>* out_histogram)
 {
     {
         // Init output params
@@ -131,21 +138,17 @@ void computeLandmarksPerViewHistogram(const sfmData::SfMData& sfmData, BoxStats<
             *out_histogram = Histogram<double>();
         }
     }
-    if(sfmData.getLandmarks().empty())
+    if(landmarks.empty())
         return;
 
     std::map<IndexT, int> nbLandmarksPerView;
 
-    for(const auto& landmark: sfmData.getLandmarks())
+    for(const auto& landmark: landmarks)
     {
         for(const auto& obsIt: landmark.second.observations)
         {
             const auto& viewId = obsIt.first;
-            auto it = nbLandmarksPerView.find(viewId);
-            if(it != nbLandmarksPerView.end())
-                ++(it->second);
-            else
-                it->second = 1;
+            ++nbLandmarksPerView[viewId];
         }
     }
     if(nbLandmarksPerView.empty())
@@ -166,6 +169,38 @@ void computeLandmarksPerViewHistogram(const sfmData::SfMData& sfmData, BoxStats<
     }
 }
 
+} // namespace
+
+void computeResidualsHistogram(const sfmData::SfMData& sfmData, BoxStats<double>& out_stats, Histogram<double>* out_histogram, const std::set<IndexT>& specificViews)
+{
+  computeResidualsHistogram(sfmData, sfmData.getLandmarks(), out_stats, out_histogram, specificViews);
+}
+
+void computeResidualsHistogram(const sfmData::SfMData& sfmData, const sfmData::LandmarkStore& landmarks, BoxStats<double>& out_stats, Histogram<double>* out_histogram, const std::set<IndexT>& specificViews)
+{
+  computeResidualsHistogram<sfmData::LandmarkStore>(sfmData, landmarks, out_stats, out_histogram, specificViews);
+}
+
+void computeObservationsLengthsHistogram(const sfmData::SfMData& sfmData, BoxStats<double>& out_stats, int& overallNbObservations, Histogram<double>* out_histogram, const std::set<IndexT>& specificViews)
+{
+  computeObservationsLengthsHistogram(sfmData.getLandmarks(), out_stats, overallNbObservations, out_histogram, specificViews);
+}
+
+void computeObservationsLengthsHistogram(const sfmData::LandmarkStore& landmarks, BoxStats<double>& out_stats, int& overallNbObservations, Histogram<double>* out_histogram, const std::set<IndexT>& specificViews)
+{
+  computeObservationsLengthsHistogram<sfmData::LandmarkStore>(landmarks, out_stats, overallNbObservations, out_histogram, specificViews);
+}
+
+void computeLandmarksPerViewHistogram(const sfmData::SfMData& sfmData, BoxStats<double>& out_stats, Histogram<double>* out_histogram)
+{
+  computeLandmarksPerViewHistogram(sfmData.getLandmarks(), out_stats, out_histogram);
+}
+
+void computeLandmarksPerViewHistogram(const sfmData::LandmarkStore& landmarks, BoxStats<double>& out_stats, Histogram<double>* out_histogram)
+{
+  computeLandmarksPerViewHistogram<sfmData::LandmarkStore>(landmarks, out_stats, out_histogram);
+}
+
 
 void computeLandmarksPerView(const sfmData::SfMData& sfmData, std::vector<int>& out_nbLandmarksPerView)
 {
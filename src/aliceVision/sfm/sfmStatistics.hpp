@@ -7,6 +7,7 @@
 #pragma once
 
 #include <aliceVision/sfmData/SfMData.hpp>
+#include <aliceVision/sfmData/LandmarkStore.hpp>
 #include <aliceVision/numeric/numeric.hpp>
 #include <aliceVision/track/Track.hpp>
 #include <aliceVision/track/tracksUtils.hpp>
@@ -27,6 +28,14 @@ namespace sfm {
  */
 void computeResidualsHistogram(const sfmData::SfMData& sfmData, BoxStats<double>& out_stats, Histogram<double>* out_histogram, const std::set<IndexT>& specificViews = std::set<IndexT>());
 
+/**
+ * @brief Compute histogram of residual values between landmarks and features (see above),
+ *        with the landmarks of the scene copied in a LandmarkStore
+ * @param[in] sfmData : scene containing the views, poses and intrinsics
+ * @param[in] landmarks : the landmarks of the scene
+ */
+void computeResidualsHistogram(const sfmData::SfMData& sfmData, const sfmData::LandmarkStore& landmarks, BoxStats<double>& out_stats, Histogram<double>* out_histogram, const std::set<IndexT>& specificViews = std::set<IndexT>());
+
 /**
  * @brief Compute histogram of observations lengths
  * @param[in] sfmData: containing the observations
@@ -36,6 +45,12 @@ void computeResidualsHistogram(const sfmData::SfMData& sfmData, BoxStats<double>
  */
 void computeObservationsLengthsHistogram(const sfmData::SfMData& sfmData, BoxStats<double>& out_stats, int& overallNbObservations, Histogram<double>* observationsLengthHistogram, const std::set<IndexT>& specificViews = std::set<IndexT>());
 
+/**
+ * @brief Compute histogram of observations lengths (see above) from a LandmarkStore
+ * @param[in] landmarks: the landmarks containing the observations
+ */
+void computeObservationsLengthsHistogram(const sfmData::LandmarkStore& landmarks, BoxStats<double>& out_stats, int& overallNbObservations, Histogram<double>* observationsLengthHistogram, const std::set<IndexT>& specificViews = std::set<IndexT>());
+
 /**
  * @brief Compute histogram of the number of landmarks per view
  * @param[in] sfmData: scene containing the views and the landmarks
@@ -44,6 +59,12 @@ void computeObservationsLengthsHistogram(const sfmData::SfMData& sfmData, BoxSta
  */
 void computeLandmarksPerViewHistogram(const sfmData::SfMData& sfmData, BoxStats<double>& out_stats, Histogram<double>* landmarksPerViewHistogram);
 
+/**
+ * @brief Compute histogram of the number of landmarks per view (see above) from a LandmarkStore
+ * @param[in] landmarks: the landmarks containing the observations
+ */
+void computeLandmarksPerViewHistogram(const sfmData::LandmarkStore& landmarks, BoxStats<double>& out_stats, Histogram<double>* landmarksPerViewHistogram);
+
 /**
  * @brief Compute landmarks per view
  * @param[in] sfmData: scene containing the views and the landmarks
@@ -7,13 +7,17 @@
 
 #include "sfmTriangulation.hpp"
 #include <aliceVision/multiview/triangulation/Triangulation.hpp>
-#include <aliceVision/robustEstimation/randSampling.hpp>
 #include <aliceVision/config.hpp>
 
 #include <boost/progress.hpp>
 
-#include <deque>
+#include <algorithm>
 #include <memory>
+#include <numeric>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
 
 namespace aliceVision {
 namespace sfm {
@@ -21,241 +25,385 @@ namespace sfm {
 using namespace aliceVision::geometry;
 using namespace aliceVision::camera;
 
-StructureComputation_basis::StructureComputation_basis(bool verbose)
-  : _bConsoleVerbose(verbose)
-{}
+namespace {
 
-StructureComputation_blind::StructureComputation_blind(bool verbose)
-  : StructureComputation_basis(verbose)
-{}
+/// Maximum number of views triangulated without dynamic allocation
+constexpr std::size_t maxFixedViews = 5;
 
-void StructureComputation_blind::triangulate(sfmData::SfMData& sfmData) const
+/// Number of landmarks processed between two updates of the progress bar
+constexpr std::size_t landmarksBlockSize = 10000;
+
+/// Camera of a view with a defined pose and intrinsic
+struct ViewCamera
+{
+  EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+
+  const IntrinsicBase* intrinsic = nullptr;
+  Pose3 pose;
+  Mat34 P;
+};
+
+/**
+ * @brief Cameras of the views with a defined pose and intrinsic,
+ *        computed once for a triangulation pass instead of once per observation.
+ */
+class ViewCameras
 {
-  std::deque<IndexT> rejectedId;
-  std::unique_ptr<boost::progress_display> my_progress_bar;
-  if (_bConsoleVerbose)
-    my_progress_bar.reset( new boost::progress_display(
-    sfmData.structure.size(),
-    std::cout,
-    "Blind triangulation progress:\n" ));
-  #pragma omp parallel
-  for(sfmData::Landmarks::iterator iterTracks = sfmData.structure.begin();
-    iterTracks != sfmData.structure.end();
-    ++iterTracks)
+public:
+  /// Cameras of all the views of the scene
+  explicit ViewCameras(const sfmData::SfMData& sfmData)
   {
-    #pragma omp single nowait
-    {
-      if (_bConsoleVerbose)
-      {
-        #pragma omp critical
-        ++(*my_progress_bar);
-      }
-      // Triangulate each landmark
-      multiview::Triangulation trianObj;
-      const sfmData::Observations & observations = iterTracks->second.observations;
-      for(const auto& itObs : observations)
-      {
-        const sfmData::View * view = sfmData.views.at(itObs.first).get();
-        if (sfmData.isPoseAndIntrinsicDefined(view))
-        {
-          const IntrinsicBase * cam = sfmData.getIntrinsics().at(view->getIntrinsicId()).get();
-          const Pose3 pose = sfmData.getPose(*view).getTransform();
-          trianObj.add(
-            cam->get_projective_equivalent(pose),
-            cam->get_ud_pixel(itObs.second.x));
-        }
-      }
-      if (trianObj.size() < 2)
-      {
-        #pragma omp critical
-        {
-          rejectedId.push_front(iterTracks->first);
-        }
-      }
-      else
-      {
-        // Compute the 3D point
-        const Vec3 X = trianObj.compute();
-        if (trianObj.minDepth() > 0) // Keep the point only if it have a positive depth
-        {
-          iterTracks->second.X = X;
-        }
-        else
-        {
-          #pragma omp critical
-          {
-            rejectedId.push_front(iterTracks->first);
-          }
-        }
-      }
-    }
+    for(const auto& viewPair : sfmData.getViews())
+      add(sfmData, viewPair.second.get());
+    sort();
   }
-  // Erase the unsuccessful triangulated tracks
-  for (auto& it : rejectedId)
+
+  /// Cameras of the views of the given observations
+  ViewCameras(const sfmData::SfMData& sfmData, const sfmData::Observations& observations)
   {
-    sfmData.structure.erase(it);
+    for(const auto& observationPair : observations)
+      add(sfmData, sfmData.getViews().at(observationPair.first).get());
+    sort();
   }
-}
 
-StructureComputation_robust::StructureComputation_robust(bool verbose)
-  : StructureComputation_basis(verbose)
-{}
+  /**
+   * @brief Get the camera of a view
+   * @param[in] viewId The view id
+   * @return the camera or nullptr if the pose or the intrinsic of the view is not defined
+   */
+  const ViewCamera* find(IndexT viewId) const
+  {
+    const auto it = std::lower_bound(_cameras.begin(), _cameras.end(), viewId,
+                                     [](const std::pair<IndexT, ViewCamera>& camera, IndexT id) { return camera.first < id; });
+    if(it == _cameras.end() || it->first != viewId)
+      return nullptr;
+    return &it->second;
+  }
 
-void StructureComputation_robust::triangulate(sfmData::SfMData& sfmData) const
-{
-  robust_triangulation(sfmData);
-}
+private:
+  void add(const sfmData::SfMData& sfmData, const sfmData::View* view)
+  {
+    if(!sfmData.isPoseAndIntrinsicDefined(view))
+      return;
 
-/// Robust triangulation of track data contained in the structure
-/// All observations must have View with valid Intrinsic and Pose data
-/// Invalid landmark are removed.
-void StructureComputation_robust::robust_triangulation(sfmData::SfMData& sfmData) const
-{
-  std::deque<IndexT> rejectedId;
-  std::unique_ptr<boost::progress_display> my_progress_bar;
-  if(_bConsoleVerbose)
-    my_progress_bar.reset( new boost::progress_display(
-    sfmData.structure.size(),
-    std::cout,
-    "Robust triangulation progress:\n" ));
-  #pragma omp parallel
-  for(sfmData::Landmarks::iterator iterTracks = sfmData.structure.begin();
-    iterTracks != sfmData.structure.end();
-    ++iterTracks)
+    ViewCamera camera;
+    camera.intrinsic = sfmData.getIntrinsics().at(view->getIntrinsicId()).get();
+    camera.pose = sfmData.getPose(*view).getTransform();
+    camera.P = camera.intrinsic->get_projective_equivalent(camera.pose);
+
+    _cameras.emplace_back(view->getViewId(), camera);
+  }
+
+  /// Sort the cameras by view id for the lookups
+  void sort()
   {
-    #pragma omp single nowait
-    {
-      if (_bConsoleVerbose)
-      {
-        #pragma omp critical
-        ++(*my_progress_bar);
-      }
-      Vec3 X;
-      if (robust_triangulation(sfmData, iterTracks->second.observations, X)) {
-        iterTracks->second.X = X;
-      }
-      else {
-        iterTracks->second.X = Vec3::Zero();
-        #pragma omp critical
-        {
-          rejectedId.push_front(iterTracks->first);
-        }
-      }
-    }
+    std::sort(_cameras.begin(), _cameras.end(),
+              [](const std::pair<IndexT, ViewCamera>& a, const std::pair<IndexT, ViewCamera>& b) { return a.first < b.first; });
   }
-  // Erase the unsuccessful triangulated tracks
-  for(auto& it : rejectedId)
+
+  std::vector<std::pair<IndexT, ViewCamera>, Eigen::aligned_allocator<std::pair<IndexT, ViewCamera>>> _cameras;
+};
+
+/// Buffers of a thread, reused between landmarks
+struct TriangulationBuffers
+{
+  std::vector<const ViewCamera*> cameras;
+  std::vector<const Vec2*> points;
+  std::vector<Vec2, Eigen::aligned_allocator<Vec2>> udPoints;
+  std::vector<std::size_t> indexes;
+};
+
+/**
+ * @brief Triangulate a selection of the observations of a landmark
+ * @param[in] cameras The cameras of the observations
+ * @param[in] udPoints The undistorted points of the observations
+ * @param[in] indexes The indexes of the selected observations
+ * @param[in] nbSelected The number of selected observations
+ * @param[out] minDepth The minimum depth of the point in the selected cameras
+ * @return the 3D point
+ */
+template<typename UdPoints>
+Vec3 triangulateSelection(const std::vector<const ViewCamera*>& cameras,
+                          const UdPoints& udPoints,
+                          const std::size_t* indexes,
+                          std::size_t nbSelected,
+                          double& minDepth)
+{
+  if(nbSelected <= maxFixedViews)
   {
-    sfmData.structure.erase(it);
+    multiview::TriangulationFixed<maxFixedViews> trianObj;
+    for(std::size_t i = 0; i < nbSelected; ++i)
+      trianObj.add(cameras[indexes[i]]->P, udPoints[indexes[i]]);
+    const Vec3 X = trianObj.compute();
+    minDepth = trianObj.minDepth();
+    return X;
   }
+
+  multiview::Triangulation trianObj;
+  for(std::size_t i = 0; i < nbSelected; ++i)
+    trianObj.add(cameras[indexes[i]]->P, udPoints[indexes[i]]);
+  const Vec3 X = trianObj.compute();
+  minDepth = trianObj.minDepth();
+  return X;
 }
 
-/// Robustly try to estimate the best 3D point using a ransac Scheme
-/// A point must be seen in at least 3 views
-/// Return true for a successful triangulation
-bool StructureComputation_robust::robust_triangulation(const sfmData::SfMData& sfmData,
-                                                       const sfmData::Observations& observations,
-                                                       Vec3& X,
-                                                       const IndexT min_required_inliers,
-                                                       const IndexT min_sample_index) const
+/**
+ * @brief Robustly estimate the 3D point of a landmark with a ransac scheme
+ * @param[in] cameras The cameras of the views with a defined pose and intrinsic
+ * @param[in] observations The observations of the landmark
+ * @param[out] X The 3D point
+ * @param[in] minRequiredInliers The minimum number of inliers
+ * @param[in] minSampleIndex The size of the samples
+ * @param[in,out] generator The random generator used to draw the samples
+ * @param[in,out] buffers The buffers of the calling thread
+ * @return true for a successful triangulation
+ */
+bool robustTriangulation(const ViewCameras& cameras,
+                         const sfmData::Observations& observations,
+                         Vec3& X,
+                         IndexT minRequiredInliers,
+                         IndexT minSampleIndex,
+                         std::mt19937& generator,
+                         TriangulationBuffers& buffers)
 {
-  if (observations.size() < 3)
-  {
+  if(observations.size() < 3)
     return false;
-  }
 
   const double dThresholdPixel = 4.0; // TODO: make this parameter customizable
 
-  const IndexT nbIter = observations.size(); // TODO: automatic computation of the number of iterations?
+  // gather the camera and the undistorted point of each observation once
+  buffers.cameras.clear();
+  buffers.points.clear();
+  buffers.udPoints.clear();
+  for(const auto& itObs : observations)
+  {
+    const ViewCamera* camera = cameras.find(itObs.first);
+    if(camera == nullptr)
+      return false; // all observations must have a view with a valid intrinsic and pose
+    buffers.cameras.push_back(camera);
+    buffers.points.push_back(&itObs.second.x);
+    buffers.udPoints.push_back(camera->intrinsic->get_ud_pixel(itObs.second.x));
+  }
+
+  const std::size_t nbObservations = observations.size();
+  const std::size_t sampleSize = std::min(std::size_t(minSampleIndex), nbObservations);
+  const std::size_t nbIter = nbObservations; // TODO: automatic computation of the number of iterations?
+
+  buffers.indexes.resize(nbObservations);
+  std::iota(buffers.indexes.begin(), buffers.indexes.end(), 0);
 
   // - Ransac variables
-  Vec3 best_model;
-  std::set<IndexT> best_inlier_set;
-  double best_error = std::numeric_limits<double>::max();
+  std::size_t bestNbInliers = 0;
+  double bestError = std::numeric_limits<double>::max();
 
   // - Ransac loop
-  for(IndexT i = 0; i < nbIter; ++i)
+  for(std::size_t i = 0; i < nbIter; ++i)
   {
-    std::set<IndexT> samples;
-    robustEstimation::uniformSample(std::min(std::size_t(min_sample_index), observations.size()), observations.size(), samples);
+    // draw distinct observations in the first sampleSize indexes (partial Fisher-Yates shuffle)
+    for(std::size_t s = 0; s < sampleSize; ++s)
+    {
+      std::uniform_int_distribution<std::size_t> distribution(s, nbObservations - 1);
+      std::swap(buffers.indexes[s], buffers.indexes[distribution(generator)]);
+    }
 
     // Hypothesis generation.
-    const Vec3 current_model = track_sample_triangulation(sfmData, observations, samples);
-
-    // Test validity of the hypothesis
-    // - chierality (for the samples)
-    // - residual error
+    double minDepth;
+    const Vec3 currentModel = triangulateSelection(buffers.cameras, buffers.udPoints, buffers.indexes.data(), sampleSize, minDepth);
 
     // Chierality (Check the point is in front of the sampled cameras)
     bool bChierality = true;
+    for(std::size_t s = 0; s < sampleSize && bChierality; ++s)
+      bChierality = buffers.cameras[buffers.indexes[s]]->pose.depth(currentModel) > 0;
 
-    for(auto& it : samples)
-    {
-      sfmData::Observations::const_iterator itObs = observations.begin();
-      std::advance(itObs, it);
-      const sfmData::View * view = sfmData.views.at(itObs->first).get();
-      const IntrinsicBase * cam = sfmData.getIntrinsics().at(view->getIntrinsicId()).get();
-      const Pose3 pose = sfmData.getPose(*view).getTransform();
-      const double z = pose.depth(current_model); // TODO: cam->depth(pose(X));
-      bChierality &= z > 0;
-    }
-
-    if (!bChierality)
+    if(!bChierality)
       continue;
 
-    std::set<IndexT> inlier_set;
-    double current_error = 0.0;
-    
+    std::size_t nbInliers = 0;
+    double currentError = 0.0;
+
     // Classification as inlier/outlier according pixel residual errors.
-    for (const auto& itObs : observations)
+    for(std::size_t o = 0; o < nbObservations; ++o)
     {
-      const sfmData::View * view = sfmData.views.at(itObs.first).get();
-      const IntrinsicBase * intrinsic = sfmData.getIntrinsics().at(view->getIntrinsicId()).get();
-      const Pose3 pose = sfmData.getPose(*view).getTransform();
-      const Vec2 residual = intrinsic->residual(pose, current_model, itObs.second.x);
-      const double residual_d = residual.norm();
+      const ViewCamera& camera = *buffers.cameras[o];
+      const double residual = camera.intrinsic->residual(camera.pose, currentModel, *buffers.points[o]).norm();
 
-      if (residual_d < dThresholdPixel)
+      if(residual < dThresholdPixel)
       {
-        inlier_set.insert(itObs.first);
-        current_error += residual_d;
+        ++nbInliers;
+        currentError += residual;
       }
       else
       {
-        current_error += dThresholdPixel;
+        currentError += dThresholdPixel;
       }
     }
+
     // Does the hypothesis is the best one we have seen and have sufficient inliers.
-    if (current_error < best_error && inlier_set.size() >= min_required_inliers)
+    if(currentError < bestError && nbInliers >= minRequiredInliers)
     {
-      X = best_model = current_model;
-      best_inlier_set = inlier_set;
-      best_error = current_error;
+      X = currentModel;
+      bestNbInliers = nbInliers;
+      bestError = currentError;
     }
   }
-  return !best_inlier_set.empty();
+  return bestNbInliers > 0;
 }
 
-
-/// Triangulate a given track from a selection of observations
-Vec3 StructureComputation_robust::track_sample_triangulation(const sfmData::SfMData& sfmData,
-                                                             const sfmData::Observations& observations,
-                                                             const std::set<IndexT>& samples) const
+/**
+ * @brief Process the landmarks in parallel and erase the rejected ones.
+ *        The landmarks are snapshotted in an array and split between the threads,
+ *        each landmark only writes its own position and rejection flag,
+ *        the rejected landmarks are erased at the end in a single pass.
+ * @param[in,out] landmarks The landmarks
+ * @param[in] progressTitle The title of the progress bar
+ * @param[in] verbose Display a progress bar
+ * @param[in] processLandmark function(landmarkId, landmark, buffers) returning false to reject the landmark
+ */
+template<typename ProcessLandmarkFunc>
+void processLandmarks(sfmData::Landmarks& landmarks,
+                      const std::string& progressTitle,
+                      bool verbose,
+                      const ProcessLandmarkFunc& processLandmark)
 {
-  multiview::Triangulation trianObj;
-  for (const IndexT idx : samples)
+  std::vector<sfmData::Landmarks::value_type*> landmarksArray;
+  landmarksArray.reserve(landmarks.size());
+  for(auto& landmarkPair : landmarks)
+    landmarksArray.push_back(&landmarkPair);
+
+  const std::size_t nbLandmarks = landmarksArray.size();
+  std::vector<unsigned char> rejected(nbLandmarks, 0);
+
+  std::unique_ptr<boost::progress_display> progressBar;
+  if(verbose)
+    progressBar.reset(new boost::progress_display(nbLandmarks, std::cout, progressTitle));
+
+  for(std::size_t blockBegin = 0; blockBegin < nbLandmarks; blockBegin += landmarksBlockSize)
+  {
+    const std::size_t blockEnd = std::min(blockBegin + landmarksBlockSize, nbLandmarks);
+
+    #pragma omp parallel
+    {
+      TriangulationBuffers buffers;
+
+      #pragma omp for schedule(dynamic, 64)
+      for(int i = static_cast<int>(blockBegin); i < static_cast<int>(blockEnd); ++i)
+      {
+        sfmData::Landmarks::value_type& landmarkPair = *landmarksArray[i];
+        rejected[i] = processLandmark(landmarkPair.first, landmarkPair.second, buffers) ? 0 : 1;
+      }
+    }
+
+    if(verbose)
+      *progressBar += blockEnd - blockBegin;
+  }
+
+  // Erase the unsuccessful triangulated tracks
+  for(std::size_t i = 0; i < nbLandmarks; ++i)
   {
-    assert(idx < observations.size());
-    sfmData::Observations::const_iterator itObs = observations.begin();
-    std::advance(itObs, idx);
-    const sfmData::View * view = sfmData.views.at(itObs->first).get();
-    const IntrinsicBase * cam = sfmData.getIntrinsics().at(view->getIntrinsicId()).get();
-    const Pose3 pose = sfmData.getPose(*view).getTransform();
-    trianObj.add(
-      cam->get_projective_equivalent(pose),
-      cam->get_ud_pixel(itObs->second.x));
+    if(rejected[i])
+      landmarks.erase(landmarksArray[i]->first);
   }
-  return trianObj.compute();
+}
+
+} // namespace
+
+StructureComputation_basis::StructureComputation_basis(bool verbose)
+  : _bConsoleVerbose(verbose)
+{}
+
+StructureComputation_blind::StructureComputation_blind(bool verbose)
+  : StructureComputation_basis(verbose)
+{}
+
+void StructureComputation_blind::triangulate(sfmData::SfMData& sfmData) const
+{
+  const ViewCameras cameras(sfmData);
+
+  processLandmarks(sfmData.structure, "Blind triangulation progress:\n", _bConsoleVerbose,
+                   [&cameras](IndexT /*landmarkId*/, sfmData::Landmark& landmark, TriangulationBuffers& buffers)
+  {
+    // Triangulate each landmark using all the observations with a defined camera
+    buffers.cameras.clear();
+    buffers.udPoints.clear();
+    for(const auto& itObs : landmark.observations)
+    {
+      const ViewCamera* camera = cameras.find(itObs.first);
+      if(camera != nullptr)
+      {
+        buffers.cameras.push_back(camera);
+        buffers.udPoints.push_back(camera->intrinsic->get_ud_pixel(itObs.second.x));
+      }
+    }
+
+    const std::size_t nbViews = buffers.cameras.size();
+    if(nbViews < 2)
+      return false;
+
+    buffers.indexes.resize(nbViews);
+    std::iota(buffers.indexes.begin(), buffers.indexes.end(), 0);
+
+    // Compute the 3D point
+    double minDepth;
+    const Vec3 X = triangulateSelection(buffers.cameras, buffers.udPoints, buffers.indexes.data(), nbViews, minDepth);
+
+    if(minDepth <= 0) // Keep the point only if it have a positive depth
+      return false;
+
+    landmark.X = X;
+    return true;
+  });
+}
+
+StructureComputation_robust::StructureComputation_robust(bool verbose)
+  : StructureComputation_basis(verbose)
+{}
+
+void StructureComputation_robust::triangulate(sfmData::SfMData& sfmData) const
+{
+  robust_triangulation(sfmData);
+}
+
+/// Robust triangulation of track data contained in the structure
+/// All observations must have View with valid Intrinsic and Pose data
+/// Invalid landmark are removed.
+void StructureComputation_robust::robust_triangulation(sfmData::SfMData& sfmData) const
+{
+  const ViewCameras cameras(sfmData);
+
+  processLandmarks(sfmData.structure, "Robust triangulation progress:\n", _bConsoleVerbose,
+                   [&cameras](IndexT landmarkId, sfmData::Landmark& landmark, TriangulationBuffers& buffers)
+  {
+    // seeded with the landmark id: the result does not depend on the threads scheduling
+    std::mt19937 generator(landmarkId);
+
+    Vec3 X;
+    if(robustTriangulation(cameras, landmark.observations, X, 3, 3, generator, buffers))
+    {
+      landmark.X = X;
+      return true;
+    }
+    landmark.X = Vec3::Zero();
+    return false;
+  });
+}
+
+/// Robustly try to estimate the best 3D point using a ransac Scheme
+/// A point must be seen in at least 3 views
+/// Return true for a successful triangulation
+bool StructureComputation_robust::robust_triangulation(const sfmData::SfMData& sfmData,
+                                                       const sfmData::Observations& observations,
+                                                       Vec3& X,
+                                                       const IndexT min_required_inliers,
+                                                       const IndexT min_sample_index) const
+{
+  if(observations.size() < 3)
+    return false;
+
+  const ViewCameras cameras(sfmData, observations);
+  std::mt19937 generator(std::random_device{}());
+  TriangulationBuffers buffers;
+
+  return robustTriangulation(cameras, observations, X, min_required_inliers, min_sample_index, generator, buffers);
 }
 
 } // namespace sfm
@@ -49,6 +49,8 @@ struct StructureComputation_robust: public StructureComputation_basis
   /// Robust triangulation of track data contained in the structure
   /// All observations must have View with valid Intrinsic and Pose data
   /// Invalid landmark are removed.
+  /// The landmarks are processed in parallel, the random sampling of each landmark
+  /// is seeded with its id so the result does not depend on the number of threads.
   void robust_triangulation(sfmData::SfMData& sfmData) const;
 
   /// Robustly try to estimate the best 3D point using a ransac Scheme
@@ -58,12 +60,6 @@ struct StructureComputation_robust: public StructureComputation_basis
                             Vec3& X,
                             const IndexT min_required_inliers = 3,
                             const IndexT min_sample_index = 3) const;
-
-private:
-  /// Triangulate a given track from a selection of observations
-  Vec3 track_sample_triangulation(const sfmData::SfMData& sfmData,
-                                  const sfmData::Observations& observations,
-                                  const std::set<IndexT>& samples) const;
 };
 
 } // namespace sfm
@@ -73,5 +73,8 @@ struct Landmark
   }
 };
 
+/// Define a collection of landmarks are indexed by their TrackId
+using Landmarks = HashMap<IndexT, Landmark>;
+
 } // namespace sfmData
 } // namespace aliceVision
@@ -0,0 +1,178 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2020 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include "LandmarkStore.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+
+namespace aliceVision {
+namespace sfmData {
+
+constexpr std::size_t LandmarkStore::npos;
+
+LandmarkStore::ObservationsRange::const_iterator LandmarkStore::ObservationsRange::find(IndexT viewId) const
+{
+  // observations are sorted by view id
+  const IndexT* viewIdIt = std::lower_bound(_viewIds, _viewIds + _size, viewId);
+
+  if(viewIdIt == _viewIds + _size || *viewIdIt != viewId)
+    return end();
+
+  return begin() + (viewIdIt - _viewIds);
+}
+
+const Observation& LandmarkStore::ObservationsRange::at(IndexT viewId) const
+{
+  const const_iterator it = find(viewId);
+
+  if(it == end())
+    throw std::out_of_range("The landmark is not observed by the view " + std::to_string(viewId) + ".");
+
+  return (*it).second;
+}
+
+Observations LandmarkStore::ObservationsRange::toObservations() const
+{
+  Observations observations;
+  observations.reserve(_size);
+
+  for(std::size_t i = 0; i < _size; ++i)
+    observations.emplace_hint(observations.end(), _viewIds[i], _observations[i]);
+
+  return observations;
+}
+
+void LandmarkStore::assign(const Landmarks& landmarks)
+{
+  clear();
+
+  std::size_t nbObservations = 0;
+  std::vector<std::pair<IndexT, const Landmark*>> sortedLandmarks;
+  sortedLandmarks.reserve(landmarks.size());
+
+  for(const auto& landmarkPair : landmarks)
+  {
+    sortedLandmarks.emplace_back(landmarkPair.first, &landmarkPair.second);
+    nbObservations += landmarkPair.second.observations.size();
+  }
+
+  std::sort(sortedLandmarks.begin(), sortedLandmarks.end(),
+            [](const std::pair<IndexT, const Landmark*>& a, const std::pair<IndexT, const Landmark*>& b) { return a.first < b.first; });
+
+  reserve(sortedLandmarks.size(), nbObservations);
+
+  for(const auto& landmarkPair : sortedLandmarks)
+    add(landmarkPair.first, *landmarkPair.second);
+}
+
+void LandmarkStore::toLandmarks(Landmarks& landmarks) const
+{
+  landmarks.clear();
+
+  for(std::size_t i = 0; i < size(); ++i)
+    landmarks.emplace(_ids[i], landmark(i).toLandmark());
+}
+
+void LandmarkStore::add(IndexT landmarkId, const Landmark& landmark)
+{
+  if(!_ids.empty() && landmarkId <= _ids.back())
+    throw std::invalid_argument("LandmarkStore: landmarks must be added by increasing id (landmark " + std::to_string(landmarkId) + ").");
+
+  _ids.push_back(landmarkId);
+  _positions.push_back(landmark.X);
+  _colors.push_back(landmark.rgb);
+  _descTypes.push_back(landmark.descType);
+
+  // sfmData::Observations are sorted by view id
+  for(const auto& observationPair : landmark.observations)
+  {
+    _observationViewIds.push_back(observationPair.first);
+    _observations.push_back(observationPair.second);
+  }
+
+  _observationOffsets.push_back(_observationViewIds.size());
+}
+
+void LandmarkStore::reserve(std::size_t nbLandmarks, std::size_t nbObservations)
+{
+  _ids.reserve(nbLandmarks);
+  _positions.reserve(nbLandmarks);
+  _colors.reserve(nbLandmarks);
+  _descTypes.reserve(nbLandmarks);
+  _observationOffsets.reserve(nbLandmarks + 1);
+  _observationViewIds.reserve(nbObservations);
+  _observations.reserve(nbObservations);
+}
+
+void LandmarkStore::clear()
+{
+  _ids.clear();
+  _positions.clear();
+  _colors.clear();
+  _descTypes.clear();
+  _observationOffsets.assign(1, 0);
+  _observationViewIds.clear();
+  _observations.clear();
+}
+
+std::size_t LandmarkStore::find(IndexT landmarkId) const
+{
+  // landmarks are sorted by id
+  const auto it = std::lower_bound(_ids.begin(), _ids.end(), landmarkId);
+
+  if(it == _ids.end() || *it != landmarkId)
+    return npos;
+
+  return static_cast<std::size_t>(it - _ids.begin());
+}
+
+LandmarkStore::LandmarkRef LandmarkStore::at(IndexT landmarkId) const
+{
+  const std::size_t index = find(landmarkId);
+
+  if(index == npos)
+    throw std::out_of_range("The landmark " + std::to_string(landmarkId) + " is not in the store.");
+
+  return landmark(index);
+}
+
+std::size_t LandmarkStore::getMemorySize() const
+{
+  return _ids.capacity() * sizeof(IndexT) +
+         _positions.capacity() * sizeof(Vec3) +
+         _colors.capacity() * sizeof(image::RGBColor) +
+         _descTypes.capacity() * sizeof(feature::EImageDescriberType) +
+         _observationOffsets.capacity() * sizeof(std::size_t) +
+         _observationViewIds.capacity() * sizeof(IndexT) +
+         _observations.capacity() * sizeof(Observation);
+}
+
+std::size_t estimateMemorySize(const Landmarks& landmarks)
+{
+  // each map element is a node allocation (value, links or next pointer and the allocator overhead),
+  // each flat_map of observations is a separate allocation
+  const std::size_t nodeOverhead = 4 * sizeof(void*);
+  const std::size_t allocationOverhead = 2 * sizeof(void*);
+  std::size_t size = landmarks.size() * (sizeof(Landmarks::value_type) + nodeOverhead);
+
+#ifdef ALICEVISION_UNORDERED_MAP
+  size += landmarks.bucket_count() * sizeof(void*);
+#endif
+
+  for(const auto& landmarkPair : landmarks)
+  {
+    const Observations& observations = landmarkPair.second.observations;
+    if(observations.capacity() > 0)
+      size += observations.capacity() * sizeof(Observations::value_type) + allocationOverhead;
+  }
+
+  return size;
+}
+
+} // namespace sfmData
+} // namespace aliceVision
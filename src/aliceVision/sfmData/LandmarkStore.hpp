@@ -0,0 +1,292 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2020 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#pragma once
+
+#include <aliceVision/sfmData/Landmark.hpp>
+#include <aliceVision/types.hpp>
+
+#include <Eigen/StdVector>
+
+#include <cstddef>
+#include <iterator>
+#include <limits>
+#include <utility>
+#include <vector>
+
+namespace aliceVision {
+namespace sfmData {
+
+/**
+ * @brief Contiguous landmarks container (structure of arrays).
+ *
+ * Positions, colors and describer types are stored in one array per attribute,
+ * observations of all the landmarks are stored in compressed rows (CSR):
+ * the observations of the landmark i are in [offsets[i], offsets[i+1]), sorted by view id.
+ * Landmarks are sorted by id.
+ *
+ * It only uses a few allocations whatever the number of landmarks
+ * and the traversals read memory sequentially.
+ * The iterators give (landmarkId, LandmarkRef) pairs, with the same members as Landmarks elements
+ * ( first, second.X, second.rgb, second.descType, second.observations ),
+ * so generic traversals of sfmData::Landmarks can be used on a LandmarkStore.
+ */
+class LandmarkStore
+{
+public:
+  using ObservationsVector = std::vector<Observation, Eigen::aligned_allocator<Observation>>;
+
+  /// Invalid landmark index
+  static constexpr std::size_t npos = std::numeric_limits<std::size_t>::max();
+
+  /**
+   * @brief Observations of a landmark in the store, as (viewId, Observation) pairs
+   */
+  class ObservationsRange
+  {
+  public:
+    struct value_type
+    {
+      IndexT first;
+      const Observation& second;
+    };
+
+    class const_iterator
+    {
+    public:
+      using iterator_category = std::random_access_iterator_tag;
+      using value_type = ObservationsRange::value_type;
+      using difference_type = std::ptrdiff_t;
+      using pointer = void;
+      using reference = value_type;
+
+      const_iterator(const IndexT* viewId, const Observation* observation)
+        : _viewId(viewId)
+        , _observation(observation)
+      {}
+
+      value_type operator*() const { return {*_viewId, *_observation}; }
+      const_iterator& operator++() { ++_viewId; ++_observation; return *this; }
+      const_iterator operator++(int) { const_iterator it = *this; ++(*this); return it; }
+      const_iterator& operator+=(difference_type n) { _viewId += n; _observation += n; return *this; }
+      const_iterator operator+(difference_type n) const { const_iterator it = *this; return it += n; }
+      difference_type operator-(const const_iterator& other) const { return _viewId - other._viewId; }
+      value_type operator[](difference_type n) const { return *(*this + n); }
+      bool operator==(const const_iterator& other) const { return _viewId == other._viewId; }
+      bool operator!=(const const_iterator& other) const { return _viewId != other._viewId; }
+      bool operator<(const const_iterator& other) const { return _viewId < other._viewId; }
+
+    private:
+      const IndexT* _viewId;
+      const Observation* _observation;
+    };
+
+    ObservationsRange(const IndexT* viewIds, const Observation* observations, std::size_t size)
+      : _viewIds(viewIds)
+      , _observations(observations)
+      , _size(size)
+    {}
+
+    std::size_t size() const { return _size; }
+    bool empty() const { return _size == 0; }
+    const_iterator begin() const { return const_iterator(_viewIds, _observations); }
+    const_iterator end() const { return const_iterator(_viewIds + _size, _observations + _size); }
+
+    /// Find the observation of the given view ( end() if not found )
+    const_iterator find(IndexT viewId) const;
+
+    /// Return 1 if the landmark is observed by the given view, 0 otherwise
+    std::size_t count(IndexT viewId) const { return (find(viewId) != end()) ? 1 : 0; }
+
+    /**
+     * @brief Get the observation of the given view
+     * @throw std::out_of_range if the landmark is not observed by the view
+     */
+    const Observation& at(IndexT viewId) const;
+
+    /// Copy the observations in a sfmData::Observations map
+    Observations toObservations() const;
+
+  private:
+    const IndexT* _viewIds;
+    const Observation* _observations;
+    std::size_t _size;
+  };
+
+  /**
+   * @brief Read-only view on a landmark in the store, with the members of sfmData::Landmark
+   */
+  struct LandmarkRef
+  {
+    const Vec3& X;
+    feature::EImageDescriberType descType;
+    ObservationsRange observations;
+    const image::RGBColor& rgb;
+
+    /// Copy the landmark in a sfmData::Landmark
+    Landmark toLandmark() const
+    {
+      return Landmark(X, descType, observations.toObservations(), rgb);
+    }
+  };
+
+  /**
+   * @brief Iterator on (landmarkId, LandmarkRef) pairs
+   */
+  class const_iterator
+  {
+  public:
+    using iterator_category = std::random_access_iterator_tag;
+    using value_type = std::pair<IndexT, LandmarkRef>;
+    using difference_type = std::ptrdiff_t;
+    using pointer = void;
+    using reference = value_type;
+
+    const_iterator(const LandmarkStore& store, std::size_t index)
+      : _store(&store)
+      , _index(index)
+    {}
+
+    value_type operator*() const { return {_store->getIds()[_index], _store->landmark(_index)}; }
+    const_iterator& operator++() { ++_index; return *this; }
+    const_iterator operator++(int) { const_iterator it = *this; ++_index; return it; }
+    const_iterator& operator+=(difference_type n) { _index += n; return *this; }
+    const_iterator operator+(difference_type n) const { const_iterator it = *this; return it += n; }
+    difference_type operator-(const const_iterator& other) const { return static_cast<difference_type>(_index) - static_cast<difference_type>(other._index); }
+    value_type operator[](difference_type n) const { return *(*this + n); }
+    bool operator==(const const_iterator& other) const { return _index == other._index; }
+    bool operator!=(const const_iterator& other) const { return _index != other._index; }
+    bool operator<(const const_iterator& other) const { return _index < other._index; }
+
+    /// Index of the landmark in the store arrays
+    std::size_t index() const { return _index; }
+
+  private:
+    const LandmarkStore* _store;
+    std::size_t _index;
+  };
+
+  LandmarkStore() = default;
+
+  /**
+   * @brief Build a store from landmarks
+   * @param[in] landmarks The input landmarks
+   */
+  explicit LandmarkStore(const Landmarks& landmarks)
+  {
+    assign(landmarks);
+  }
+
+  /**
+   * @brief Replace the content of the store by the given landmarks
+   * @param[in] landmarks The input landmarks
+   */
+  void assign(const Landmarks& landmarks);
+
+  /**
+   * @brief Copy the content of the store in a Landmarks map
+   * @param[out] landmarks The output landmarks ( previous content is removed )
+   */
+  void toLandmarks(Landmarks& landmarks) const;
+
+  /**
+   * @brief Append a landmark at the end of the store
+   * @param[in] landmarkId The landmark id, greater than the ids already in the store
+   * @param[in] landmark The landmark
+   * @throw std::invalid_argument if the landmark id is not greater than the last id of the store
+   */
+  void add(IndexT landmarkId, const Landmark& landmark);
+
+  /**
+   * @brief Reserve memory
+   * @param[in] nbLandmarks The number of landmarks
+   * @param[in] nbObservations The total number of observations
+   */
+  void reserve(std::size_t nbLandmarks, std::size_t nbObservations);
+
+  /// Remove all the landmarks
+  void clear();
+
+  std::size_t size() const { return _ids.size(); }
+  bool empty() const { return _ids.empty(); }
+
+  /// Total number of observations
+  std::size_t getNbObservations() const { return _observationViewIds.size(); }
+
+  const_iterator begin() const { return const_iterator(*this, 0); }
+  const_iterator end() const { return const_iterator(*this, size()); }
+
+  /**
+   * @brief Find a landmark
+   * @param[in] landmarkId The landmark id
+   * @return the index of the landmark in the store arrays, or npos
+   */
+  std::size_t find(IndexT landmarkId) const;
+
+  /// Return 1 if the store contains the landmark, 0 otherwise
+  std::size_t count(IndexT landmarkId) const { return (find(landmarkId) != npos) ? 1 : 0; }
+
+  /**
+   * @brief Get a landmark from its id
+   * @throw std::out_of_range if the landmark is not in the store
+   */
+  LandmarkRef at(IndexT landmarkId) const;
+
+  /**
+   * @brief Get a landmark from its index in the store arrays
+   * @param[in] index The landmark index
+   */
+  LandmarkRef landmark(std::size_t index) const
+  {
+    return {_positions[index], _descTypes[index], observations(index), _colors[index]};
+  }
+
+  /**
+   * @brief Get the observations of a landmark from its index in the store arrays
+   * @param[in] index The landmark index
+   */
+  ObservationsRange observations(std::size_t index) const
+  {
+    const std::size_t begin = _observationOffsets[index];
+    return ObservationsRange(_observationViewIds.data() + begin, _observations.data() + begin, _observationOffsets[index + 1] - begin);
+  }
+
+  // contiguous arrays, the landmark attributes can be modified in place
+
+  const std::vector<IndexT>& getIds() const { return _ids; }
+  const std::vector<Vec3>& getPositions() const { return _positions; }
+  std::vector<Vec3>& getPositions() { return _positions; }
+  const std::vector<image::RGBColor>& getColors() const { return _colors; }
+  std::vector<image::RGBColor>& getColors() { return _colors; }
+  const std::vector<feature::EImageDescriberType>& getDescTypes() const { return _descTypes; }
+  std::vector<feature::EImageDescriberType>& getDescTypes() { return _descTypes; }
+  /// Observations offsets of the landmarks ( size() + 1 elements )
+  const std::vector<std::size_t>& getObservationOffsets() const { return _observationOffsets; }
+  const std::vector<IndexT>& getObservationViewIds() const { return _observationViewIds; }
+  const ObservationsVector& getObservations() const { return _observations; }
+  ObservationsVector& getObservations() { return _observations; }
+
+  /// Memory used by the store arrays in bytes
+  std::size_t getMemorySize() const;
+
+private:
+  std::vector<IndexT> _ids;
+  std::vector<Vec3> _positions;
+  std::vector<image::RGBColor> _colors;
+  std::vector<feature::EImageDescriberType> _descTypes;
+  std::vector<std::size_t> _observationOffsets = {0};
+  std::vector<IndexT> _observationViewIds;
+  ObservationsVector _observations;
+};
+
+/**
+ * @brief Estimate the memory used by a Landmarks map in bytes ( nodes and observations allocations )
+ * @param[in] landmarks The landmarks
+ */
+std::size_t estimateMemorySize(const Landmarks& landmarks);
+
+} // namespace sfmData
+} // namespace aliceVision
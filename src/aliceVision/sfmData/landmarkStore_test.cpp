@@ -0,0 +1,157 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2020 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include <aliceVision/sfmData/LandmarkStore.hpp>
+
+#include <stdexcept>
+
+#define BOOST_TEST_MODULE landmarkStore
+
+#include <boost/test/unit_test.hpp>
+
+using namespace aliceVision;
+using namespace aliceVision::sfmData;
+
+namespace {
+
+Landmarks createLandmarks(IndexT nbLandmarks)
+{
+  Landmarks landmarks;
+
+  // landmarks are not inserted in id order
+  for(IndexT i = 0; i < nbLandmarks; ++i)
+  {
+    const IndexT landmarkId = (i * 7) % nbLandmarks * 3;
+    Landmark& landmark = landmarks[landmarkId];
+    landmark.X = Vec3(landmarkId, 0.5 * landmarkId, -1.0);
+    landmark.rgb = image::RGBColor(landmarkId % 256, 0, 255);
+    landmark.descType = feature::EImageDescriberType::SIFT;
+
+    // landmarks with 0 to 4 observations
+    for(IndexT viewId = 0; viewId < landmarkId % 5; ++viewId)
+      landmark.observations[10 - 2 * viewId] = Observation(Vec2(viewId, landmarkId), landmarkId + viewId, 1.0);
+  }
+
+  return landmarks;
+}
+
+/// Generic traversal, compiled for Landmarks and LandmarkStore
+template<typename LandmarksT>
+double sumObservations(const LandmarksT& landmarks, std::size_t& nbObservations)
+{
+  double sum = 0.0;
+  nbObservations = 0;
+
+  for(const auto& landmarkPair : landmarks)
+  {
+    for(const auto& observationPair : landmarkPair.second.observations)
+    {
+      sum += landmarkPair.first + observationPair.first + landmarkPair.second.X(0) * observationPair.second.x(0);
+      ++nbObservations;
+    }
+  }
+
+  return sum;
+}
+
+} // namespace
+
+BOOST_AUTO_TEST_CASE(LandmarkStore_RoundTrip)
+{
+  const Landmarks landmarks = createLandmarks(1000);
+  const LandmarkStore store(landmarks);
+
+  BOOST_CHECK_EQUAL(store.size(), landmarks.size());
+
+  std::size_t nbObservations = 0;
+  for(const auto& landmarkPair : landmarks)
+    nbObservations += landmarkPair.second.observations.size();
+
+  BOOST_CHECK_EQUAL(store.getNbObservations(), nbObservations);
+  BOOST_CHECK_EQUAL(store.getObservationOffsets().size(), store.size() + 1);
+  BOOST_CHECK_EQUAL(store.getObservationOffsets().back(), nbObservations);
+
+  Landmarks landmarksOut;
+  store.toLandmarks(landmarksOut);
+  BOOST_CHECK(landmarksOut == landmarks);
+}
+
+BOOST_AUTO_TEST_CASE(LandmarkStore_Access)
+{
+  const Landmarks landmarks = createLandmarks(100);
+  const LandmarkStore store(landmarks);
+
+  // sorted by id
+  for(std::size_t i = 1; i < store.size(); ++i)
+    BOOST_CHECK(store.getIds()[i - 1] < store.getIds()[i]);
+
+  for(const auto& landmarkPair : landmarks)
+  {
+    const Landmark& landmark = landmarkPair.second;
+    const LandmarkStore::LandmarkRef landmarkRef = store.at(landmarkPair.first);
+
+    BOOST_CHECK_EQUAL(store.count(landmarkPair.first), 1);
+    BOOST_CHECK_EQUAL(landmarkRef.X, landmark.X);
+    BOOST_CHECK(landmarkRef.descType == landmark.descType);
+    BOOST_CHECK(landmarkRef.toLandmark() == landmark);
+    BOOST_CHECK_EQUAL(landmarkRef.observations.size(), landmark.observations.size());
+
+    for(const auto& observationPair : landmark.observations)
+    {
+      BOOST_CHECK_EQUAL(landmarkRef.observations.count(observationPair.first), 1);
+      BOOST_CHECK(landmarkRef.observations.at(observationPair.first) == observationPair.second);
+    }
+
+    BOOST_CHECK_EQUAL(landmarkRef.observations.count(1), 0);
+    BOOST_CHECK_THROW(landmarkRef.observations.at(1), std::out_of_range);
+  }
+
+  BOOST_CHECK_EQUAL(store.find(1), LandmarkStore::npos);
+  BOOST_CHECK_THROW(store.at(1), std::out_of_range);
+
+  // modification in place
+  LandmarkStore storeCopy = store;
+  const std::size_t index = storeCopy.find(30);
+  BOOST_REQUIRE(index != LandmarkStore::npos);
+  storeCopy.getPositions()[index] = Vec3(1.0, 2.0, 3.0);
+  BOOST_CHECK_EQUAL(storeCopy.at(30).X, Vec3(1.0, 2.0, 3.0));
+  BOOST_CHECK_EQUAL(store.at(30).X, landmarks.at(30).X);
+}
+
+BOOST_AUTO_TEST_CASE(LandmarkStore_GenericTraversal)
+{
+  const Landmarks landmarks = createLandmarks(1000);
+  const LandmarkStore store(landmarks);
+
+  std::size_t nbObservations = 0;
+  std::size_t nbObservationsStore = 0;
+  const double sum = sumObservations(landmarks, nbObservations);
+  const double sumStore = sumObservations(store, nbObservationsStore);
+
+  BOOST_CHECK_EQUAL(nbObservations, nbObservationsStore);
+  BOOST_CHECK_CLOSE(sum, sumStore, 1e-9);
+}
+
+BOOST_AUTO_TEST_CASE(LandmarkStore_Add)
+{
+  LandmarkStore store;
+  BOOST_CHECK(store.empty());
+
+  Landmark landmark(Vec3(1.0, 2.0, 3.0), feature::EImageDescriberType::SIFT);
+  landmark.observations[4] = Observation(Vec2(1.0, 1.0), 0, 1.0);
+
+  store.add(5, landmark);
+  store.add(8, Landmark(Vec3::Zero()));
+
+  BOOST_CHECK_EQUAL(store.size(), 2);
+  BOOST_CHECK_EQUAL(store.getNbObservations(), 1);
+  BOOST_CHECK(store.at(8).observations.empty());
+  BOOST_CHECK_THROW(store.add(6, landmark), std::invalid_argument);
+
+  store.clear();
+  BOOST_CHECK(store.empty());
+  BOOST_CHECK_EQUAL(store.getObservationOffsets().size(), 1);
+}
@@ -0,0 +1,1082 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2020 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include "binaryIO.hpp"
+#include <aliceVision/config.hpp>
+#include <aliceVision/camera/camera.hpp>
+#include <aliceVision/system/Logger.hpp>
+
+#include <boost/filesystem.hpp>
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+
+#if ALICEVISION_IS_DEFINED(ALICEVISION_HAVE_ZLIB)
+#include <zlib.h>
+#endif
+
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <map>
+#include <stdexcept>
+#include <vector>
+
+namespace fs = boost::filesystem;
+namespace bip = boost::interprocess;
+
+namespace aliceVision {
+namespace sfmDataIO {
+
+namespace {
+
+/**
+ * Binary SfMData file layout:
+ *  - FileHeader
+ *  - SectionEntry table of contents ( FileHeader::nbSections entries )
+ *  - sections data, each section starts on an 8 bytes boundary
+ *
+ * All the values are written in the native byte order,
+ * the byte order mark of the header is used to reject files written with another byte order.
+ */
+
+const char fileMagic[8] = {'A', 'V', 'S', 'F', 'M', 'B', 'I', 'N'};
+const std::uint32_t fileVersion = 1;
+const std::uint32_t byteOrderMark = 0x01020304;
+/// maximal compression ratio of the deflate format
+const std::uint64_t maxDeflateRatio = 1032;
+
+enum class ESection : std::uint32_t
+{
+  FOLDERS = 1,
+  VIEWS = 2,
+  INTRINSICS = 3,
+  POSES = 4,
+  RIGS = 5,
+  STRUCTURE = 6,
+  STRUCTURE_OBSERVATIONS = 7,
+  STRUCTURE_FEATURES = 8,
+  CONTROL_POINTS = 9,
+  CONTROL_POINTS_OBSERVATIONS = 10,
+  CONTROL_POINTS_FEATURES = 11
+};
+
+enum class ECompression : std::uint32_t
+{
+  NONE = 0,
+  ZLIB = 1
+};
+
+struct FileHeader
+{
+  char magic[8];
+  std::uint32_t version;
+  std::uint32_t byteOrderMark;
+  std::uint32_t nbSections;
+  std::uint32_t reserved;
+};
+
+struct SectionEntry
+{
+  std::uint32_t type;
+  std::uint32_t compression;
+  /// offset of the section data from the beginning of the file
+  std::uint64_t offset;
+  /// size of the section data in the file
+  std::uint64_t storedSize;
+  /// size of the section data once decompressed
+  std::uint64_t size;
+};
+
+/**
+ * Landmark record of the structure and control points sections.
+ * The section starts with the number of landmarks ( uint64 ), followed by the records.
+ * The observations of the landmarks are stored in the same order in the observations section
+ * ( number of observations ( uint64 ), followed by the view ids ( uint32 ) )
+ * and in the features section ( number of observations ( uint64 ), followed by the FeatureRecords ).
+ */
+struct LandmarkRecord
+{
+  std::uint32_t landmarkId;
+  std::uint8_t descType;
+  std::uint8_t rgb[3];
+  double X[3];
+  std::uint32_t nbObservations;
+  std::uint32_t padding;
+};
+
+struct FeatureRecord
+{
+  std::uint32_t featureId;
+  std::uint32_t padding;
+  double x[2];
+  double scale;
+};
+
+static_assert(sizeof(FileHeader) == 24, "unexpected binary SfMData header size");
+static_assert(sizeof(SectionEntry) == 32, "unexpected binary SfMData section entry size");
+static_assert(sizeof(LandmarkRecord) == 40, "unexpected binary SfMData landmark record size");
+static_assert(sizeof(FeatureRecord) == 32, "unexpected binary SfMData feature record size");
+
+/**
+ * @brief Section data, filled in memory before being written to the file
+ */
+class SectionBuffer
+{
+public:
+  void write(const void* data, std::size_t size)
+  {
+    const char* bytes = static_cast<const char*>(data);
+    _data.insert(_data.end(), bytes, bytes + size);
+  }
+
+  template<typename T>
+  void write(const T& value)
+  {
+    write(&value, sizeof(T));
+  }
+
+  void writeString(const std::string& str)
+  {
+    write(static_cast<std::uint32_t>(str.size()));
+    write(str.data(), str.size());
+  }
+
+  void writeMat(const Mat3& rotation, const Vec3& center)
+  {
+    write(rotation.data(), 9 * sizeof(double));
+    write(center.data(), 3 * sizeof(double));
+  }
+
+  /// Reserve space for the given number of bytes and return a pointer to it
+  char* append(std::size_t size)
+  {
+    const std::size_t offset = _data.size();
+    _data.resize(offset + size);
+    return _data.data() + offset;
+  }
+
+  const std::vector<char>& data() const { return _data; }
+
+private:
+  std::vector<char> _data;
+};
+
+/**
+ * @brief Sequential reader of a section data, with bounds checking
+ */
+class SectionReader
+{
+public:
+  SectionReader(const char* begin, const char* end)
+    : _current(begin)
+    , _end(end)
+  {}
+
+  /// Return a pointer to the next size bytes and move after them
+  const char* readInPlace(std::size_t size)
+  {
+    if(size > static_cast<std::size_t>(_end - _current))
+      throw std::runtime_error("truncated section");
+
+    const char* data = _current;
+    _current += size;
+    return data;
+  }
+
+  void read(void* data, std::size_t size)
+  {
+    std::memcpy(data, readInPlace(size), size);
+  }
+
+  template<typename T>
+  T read()
+  {
+    T value;
+    read(&value, sizeof(T));
+    return value;
+  }
+
+  std::string readString()
+  {
+    const std::uint32_t size = read<std::uint32_t>();
+    const char* data = readInPlace(size);
+    return std::string(data, size);
+  }
+
+  void readMat(Mat3& rotation, Vec3& center)
+  {
+    read(rotation.data(), 9 * sizeof(double));
+    read(center.data(), 3 * sizeof(double));
+  }
+
+  /// Read an array count and check that the remaining data can hold it
+  /// ( elementSize is the minimal size of an element in the section )
+  template<typename CountT = std::uint64_t>
+  CountT readCount(std::size_t elementSize)
+  {
+    const CountT count = read<CountT>();
+    if(static_cast<std::uint64_t>(count) > static_cast<std::uint64_t>(_end - _current) / std::max<std::size_t>(elementSize, 1))
+      throw std::runtime_error("invalid number of elements");
+    return count;
+  }
+
+private:
+  const char* _current;
+  const char* const _end;
+};
+
+#if ALICEVISION_IS_DEFINED(ALICEVISION_HAVE_ZLIB)
+/**
+ * @brief Compress a buffer with zlib
+ * @param[in] input The input data
+ * @param[out] output The compressed data
+ */
+void compressBuffer(const std::vector<char>& input, std::vector<char>& output)
+{
+  z_stream stream;
+  std::memset(&stream, 0, sizeof(stream));
+
+  if(deflateInit(&stream, Z_DEFAULT_COMPRESSION) != Z_OK)
+    throw std::runtime_error("cannot initialize zlib compression");
+
+  // zlib sizes are 32 bits, large buffers are given by chunks
+  const std::size_t maxChunkSize = std::numeric_limits<uInt>::max();
+  const std::size_t outputChunkSize = 1 << 20;
+  std::size_t inputOffset = 0;
+  int status = Z_OK;
+
+  output.clear();
+
+  while(status != Z_STREAM_END)
+  {
+    if(stream.avail_in == 0 && inputOffset < input.size())
+    {
+      const std::size_t chunkSize = std::min(maxChunkSize, input.size() - inputOffset);
+      stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(input.data() + inputOffset));
+      stream.avail_in = static_cast<uInt>(chunkSize);
+      inputOffset += chunkSize;
+    }
+
+    const std::size_t outputOffset = output.size();
+    output.resize(outputOffset + outputChunkSize);
+    stream.next_out = reinterpret_cast<Bytef*>(output.data() + outputOffset);
+    stream.avail_out = static_cast<uInt>(outputChunkSize);
+
+    status = deflate(&stream, (inputOffset == input.size()) ? Z_FINISH : Z_NO_FLUSH);
+    output.resize(output.size() - stream.avail_out);
+
+    if(status != Z_OK && status != Z_STREAM_END && status != Z_BUF_ERROR)
+    {
+      deflateEnd(&stream);
+      throw std::runtime_error("zlib compression failed");
+    }
+  }
+
+  deflateEnd(&stream);
+}
+
+/**
+ * @brief Decompress a zlib buffer
+ * @param[in] input The compressed data
+ * @param[in] inputSize The compressed data size
+ * @param[out] output The decompressed data, resized to its known size before the call
+ */
+void decompressBuffer(const char* input, std::size_t inputSize, std::vector<char>& output)
+{
+  z_stream stream;
+  std::memset(&stream, 0, sizeof(stream));
+
+  if(inflateInit(&stream) != Z_OK)
+    throw std::runtime_error("cannot initialize zlib decompression");
+
+  const std::size_t maxChunkSize = std::numeric_limits<uInt>::max();
+  std::size_t inputOffset = 0;
+  std::size_t outputOffset = 0;
+  int status = Z_OK;
+
+  while(status != Z_STREAM_END)
+  {
+    if(stream.avail_in == 0 && inputOffset < inputSize)
+    {
+      const std::size_t chunkSize = std::min(maxChunkSize, inputSize - inputOffset);
+      stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(input + inputOffset));
+      stream.avail_in = static_cast<uInt>(chunkSize);
+      inputOffset += chunkSize;
+    }
+
+    const std::size_t chunkSize = std::min(maxChunkSize, output.size() - outputOffset);
+    stream.next_out = reinterpret_cast<Bytef*>(output.data() + outputOffset);
+    stream.avail_out = static_cast<uInt>(chunkSize);
+
+    status = inflate(&stream, Z_NO_FLUSH);
+    outputOffset += chunkSize - stream.avail_out;
+
+    if(status != Z_OK && status != Z_STREAM_END)
+    {
+      inflateEnd(&stream);
+      throw std::runtime_error("zlib decompression failed");
+    }
+  }
+
+  inflateEnd(&stream);
+
+  if(outputOffset != output.size())
+    throw std::runtime_error("unexpected decompressed section size");
+}
+#endif
+
+/**
+ * @brief Write a section at the end of the file and add its entry in the table of contents
+ * @param[in,out] stream The output file stream
+ * @param[in] type The section type
+ * @param[in] buffer The section data
+ * @param[in] compress Compress the section data
+ * @param[in,out] toc The table of contents
+ */
+void writeSection(std::ofstream& stream, ESection type, const SectionBuffer& buffer, bool compress, std::vector<SectionEntry>& toc)
+{
+  // align the section on 8 bytes
+  const std::uint64_t position = static_cast<std::uint64_t>(stream.tellp());
+  const std::uint64_t offset = (position + 7) / 8 * 8;
+  const char padding[8] = {0};
+  stream.write(padding, offset - position);
+
+  SectionEntry entry;
+  entry.type = static_cast<std::uint32_t>(type);
+  entry.compression = static_cast<std::uint32_t>(ECompression::NONE);
+  entry.offset = offset;
+  entry.size = buffer.data().size();
+  entry.storedSize = entry.size;
+
+#if ALICEVISION_IS_DEFINED(ALICEVISION_HAVE_ZLIB)
+  if(compress)
+  {
+    std::vector<char> compressed;
+    compressBuffer(buffer.data(), compressed);
+    entry.compression = static_cast<std::uint32_t>(ECompression::ZLIB);
+    entry.storedSize = compressed.size();
+    stream.write(compressed.data(), compressed.size());
+    toc.push_back(entry);
+    return;
+  }
+#else
+  (void)compress;
+#endif
+
+  stream.write(buffer.data().data(), buffer.data().size());
+  toc.push_back(entry);
+}
+
+void writeFolders(const sfmData::SfMData& sfmData, SectionBuffer& buffer)
+{
+  for(const auto* folders : {&sfmData.getRelativeFeaturesFolders(), &sfmData.getRelativeMatchesFolders()})
+  {
+    buffer.write(static_cast<std::uint32_t>(folders->size()));
+    for(const std::string& folder : *folders)
+      buffer.writeString(folder);
+  }
+}
+
+void writeViews(const sfmData::Views& views, SectionBuffer& buffer)
+{
+  buffer.write(static_cast<std::uint64_t>(views.size()));
+
+  for(const auto& viewPair : views)
+  {
+    const sfmData::View& view = *viewPair.second;
+
+    buffer.write<std::uint32_t>(view.getViewId());
+    buffer.write<std::uint32_t>(view.getPoseId());
+    buffer.write<std::uint32_t>(view.isPartOfRig() ? view.getRigId() : UndefinedIndexT);
+    buffer.write<std::uint32_t>(view.isPartOfRig() ? view.getSubPoseId() : UndefinedIndexT);
+    buffer.write<std::uint32_t>(view.getFrameId());
+    buffer.write<std::uint32_t>(view.getIntrinsicId());
+    buffer.write<std::uint32_t>(view.getResectionId());
+    buffer.write<std::uint8_t>(view.isPoseIndependant());
+    buffer.write<std::uint64_t>(view.getWidth());
+    buffer.write<std::uint64_t>(view.getHeight());
+    buffer.writeString(view.getImagePath());
+
+    buffer.write(static_cast<std::uint32_t>(view.getMetadata().size()));
+    for(const auto& metadataPair : view.getMetadata())
+    {
+      buffer.writeString(metadataPair.first);
+      buffer.writeString(metadataPair.second);
+    }
+  }
+}
+
+void writeIntrinsics(const sfmData::Intrinsics& intrinsics, SectionBuffer& buffer)
+{
+  buffer.write(static_cast<std::uint64_t>(intrinsics.size()));
+
+  for(const auto& intrinsicPair : intrinsics)
+  {
+    const camera::IntrinsicBase& intrinsic = *intrinsicPair.second;
+    const camera::EINTRINSIC intrinsicType = intrinsic.getType();
+
+    // readIntrinsics only supports the Pinhole camera models, refuse to write a file that can't be read back
+    if(!camera::isPinhole(intrinsicType))
+      throw std::out_of_range("Only Pinhole camera model supported (intrinsic " + std::to_string(intrinsicPair.first) + ")");
+
+    buffer.write<std::uint32_t>(intrinsicPair.first);
+    buffer.write<std::uint32_t>(intrinsic.w());
+    buffer.write<std::uint32_t>(intrinsic.h());
+    buffer.writeString(intrinsic.serialNumber());
+    buffer.writeString(camera::EINTRINSIC_enumToString(intrinsicType));
+    buffer.writeString(camera::EIntrinsicInitMode_enumToString(intrinsic.getInitializationMode()));
+    buffer.write<double>(intrinsic.initialFocalLengthPix());
+    buffer.write<std::uint8_t>(intrinsic.isLocked());
+
+    const camera::Pinhole& pinholeIntrinsic = dynamic_cast<const camera::Pinhole&>(intrinsic);
+    const Vec2 principalPoint = pinholeIntrinsic.getPrincipalPoint();
+    const std::vector<double>& distortionParams = pinholeIntrinsic.getDistortionParams();
+
+    buffer.write<double>(pinholeIntrinsic.getFocalLengthPix());
+    buffer.write(principalPoint.data(), 2 * sizeof(double));
+    buffer.write(static_cast<std::uint32_t>(distortionParams.size()));
+    buffer.write(distortionParams.data(), distortionParams.size() * sizeof(double));
+  }
+}
+
+void writePoses(const sfmData::Poses& poses, SectionBuffer& buffer)
+{
+  buffer.write(static_cast<std::uint64_t>(poses.size()));
+
+  for(const auto& posePair : poses)
+  {
+    const geometry::Pose3& transform = posePair.second.getTransform();
+
+    buffer.write<std::uint32_t>(posePair.first);
+    buffer.writeMat(transform.rotation(), transform.center());
+    buffer.write<std::uint8_t>(posePair.second.isLocked());
+  }
+}
+
+void writeRigs(const sfmData::Rigs& rigs, SectionBuffer& buffer)
+{
+  buffer.write(static_cast<std::uint64_t>(rigs.size()));
+
+  for(const auto& rigPair : rigs)
+  {
+    buffer.write<std::uint32_t>(rigPair.first);
+    buffer.write(static_cast<std::uint32_t>(rigPair.second.getSubPoses().size()));
+
+    for(const sfmData::RigSubPose& subPose : rigPair.second.getSubPoses())
+    {
+      buffer.write(static_cast<std::uint8_t>(subPose.status));
+      buffer.writeMat(subPose.pose.rotation(), subPose.pose.center());
+    }
+  }
+}
+
+/**
+ * @brief Write the landmarks sections: landmark records, observations view ids and features records
+ * @param[in,out] stream The output file stream
+ * @param[in] landmarks The landmarks
+ * @param[in] sections The landmarks, observations and features section types
+ * @param[in] saveObservations Save the observations view ids
+ * @param[in] saveFeatures Save the observations features
+ * @param[in] compress Compress the sections
+ * @param[in,out] toc The table of contents
+ */
+void writeLandmarks(std::ofstream& stream, const sfmData::Landmarks& landmarks, const ESection (&sections)[3],
+                    bool saveObservations, bool saveFeatures, bool compress, std::vector<SectionEntry>& toc)
+{
+  std::uint64_t nbObservations = 0;
+
+  // landmark records
+  {
+    SectionBuffer buffer;
+    buffer.write(static_cast<std::uint64_t>(landmarks.size()));
+    char* records = buffer.append(landmarks.size() * sizeof(LandmarkRecord));
+
+    for(const auto& landmarkPair : landmarks)
+    {
+      const sfmData::Landmark& landmark = landmarkPair.second;
+      LandmarkRecord record;
+
+      record.landmarkId = landmarkPair.first;
+      record.descType = static_cast<std::uint8_t>(landmark.descType);
+      for(int i = 0; i < 3; ++i)
+      {
+        record.rgb[i] = landmark.rgb(i);
+        record.X[i] = landmark.X(i);
+      }
+      record.nbObservations = saveObservations ? static_cast<std::uint32_t>(landmark.observations.size()) : 0;
+      record.padding = 0;
+
+      std::memcpy(records, &record, sizeof(LandmarkRecord));
+      records += sizeof(LandmarkRecord);
+      nbObservations += record.nbObservations;
+    }
+
+    writeSection(stream, sections[0], buffer, compress, toc);
+  }
+
+  if(!saveObservations)
+    return;
+
+  // observations view ids
+  {
+    SectionBuffer buffer;
+    buffer.write(nbObservations);
+    char* viewIds = buffer.append(nbObservations * sizeof(std::uint32_t));
+
+    for(const auto& landmarkPair : landmarks)
+    {
+      for(const auto& observationPair : landmarkPair.second.observations)
+      {
+        const std::uint32_t viewId = observationPair.first;
+        std::memcpy(viewIds, &viewId, sizeof(std::uint32_t));
+        viewIds += sizeof(std::uint32_t);
+      }
+    }
+
+    writeSection(stream, sections[1], buffer, compress, toc);
+  }
+
+  if(!saveFeatures)
+    return;
+
+  // observations features
+  {
+    SectionBuffer buffer;
+    buffer.write(nbObservations);
+    char* features = buffer.append(nbObservations * sizeof(FeatureRecord));
+
+    for(const auto& landmarkPair : landmarks)
+    {
+      for(const auto& observationPair : landmarkPair.second.observations)
+      {
+        const sfmData::Observation& observation = observationPair.second;
+        FeatureRecord record;
+
+        record.featureId = observation.id_feat;
+        record.padding = 0;
+        record.x[0] = observation.x(0);
+        record.x[1] = observation.x(1);
+        record.scale = observation.scale;
+
+        std::memcpy(features, &record, sizeof(FeatureRecord));
+        features += sizeof(FeatureRecord);
+      }
+    }
+
+    writeSection(stream, sections[2], buffer, compress, toc);
+  }
+}
+
+/**
+ * @brief Memory-mapped binary SfMData file, giving access to the sections of the table of contents
+ */
+class MappedFile
+{
+public:
+  explicit MappedFile(const std::string& filename)
+    : _mapping(filename.c_str(), bip::read_only)
+    , _region(_mapping, bip::read_only)
+  {
+    const char* data = static_cast<const char*>(_region.get_address());
+    const std::size_t size = _region.get_size();
+    SectionReader reader(data, data + size);
+    FileHeader header;
+
+    reader.read(&header, sizeof(FileHeader));
+
+    if(std::memcmp(header.magic, fileMagic, sizeof(fileMagic)) != 0)
+      throw std::runtime_error("not a binary SfMData file");
+
+    if(header.byteOrderMark != byteOrderMark)
+      throw std::runtime_error("the file has been written with another byte order");
+
+    if(header.version > fileVersion)
+      throw std::runtime_error("unsupported file version " + std::to_string(header.version));
+
+    for(std::uint32_t i = 0; i < header.nbSections; ++i)
+    {
+      SectionEntry entry;
+      reader.read(&entry, sizeof(SectionEntry));
+
+      if(entry.offset > size || entry.storedSize > size - entry.offset)
+        throw std::runtime_error("invalid section table");
+
+      // the decompressed size is allocated before decompression, it is bounded by the deflate maximal ratio
+      if((entry.compression == static_cast<std::uint32_t>(ECompression::NONE) && entry.size != entry.storedSize) ||
+         (entry.compression == static_cast<std::uint32_t>(ECompression::ZLIB) && entry.size / maxDeflateRatio > entry.storedSize))
+        throw std::runtime_error("invalid section size");
+
+      // unknown sections (from a later version) are ignored
+      _toc.emplace(static_cast<ESection>(entry.type), entry);
+    }
+  }
+
+  bool hasSection(ESection type) const
+  {
+    return _toc.count(type) != 0;
+  }
+
+  /**
+   * @brief Get a reader of the given section.
+   *        Uncompressed sections are read in place in the mapped file,
+   *        compressed sections are decompressed in the given buffer.
+   * @param[in] type The section type
+   * @param[out] buffer The buffer of the decompressed section
+   * @return the section reader
+   */
+  SectionReader section(ESection type, std::vector<char>& buffer) const
+  {
+    const SectionEntry& entry = _toc.at(type);
+    const char* data = static_cast<const char*>(_region.get_address()) + entry.offset;
+
+    switch(static_cast<ECompression>(entry.compression))
+    {
+      case ECompression::NONE:
+        return SectionReader(data, data + entry.storedSize);
+
+      case ECompression::ZLIB:
+      {
+#if ALICEVISION_IS_DEFINED(ALICEVISION_HAVE_ZLIB)
+        buffer.resize(entry.size);
+        decompressBuffer(data, entry.storedSize, buffer);
+        return SectionReader(buffer.data(), buffer.data() + buffer.size());
+#else
+        (void)buffer;
+        throw std::runtime_error("compressed sections are not supported, AliceVision is built without zlib");
+#endif
+      }
+    }
+
+    throw std::runtime_error("unknown section compression " + std::to_string(entry.compression));
+  }
+
+private:
+  bip::file_mapping _mapping;
+  bip::mapped_region _region;
+  std::map<ESection, SectionEntry> _toc;
+};
+
+void readFolders(SectionReader& reader, sfmData::SfMData& sfmData)
+{
+  for(int i = 0; i < 2; ++i)
+  {
+    // each folder is stored with at least its size
+    std::vector<std::string> folders(reader.readCount<std::uint32_t>(sizeof(std::uint32_t)));
+
+    for(std::string& folder : folders)
+      folder = reader.readString();
+
+    if(i == 0)
+      sfmData.addFeaturesFolders(folders);
+    else
+      sfmData.addMatchesFolders(folders);
+  }
+}
+
+void readViews(SectionReader& reader, sfmData::Views& views)
+{
+  const std::uint64_t nbViews = reader.readCount(1);
+
+  for(std::uint64_t i = 0; i < nbViews; ++i)
+  {
+    auto view = std::make_shared<sfmData::View>();
+
+    view->setViewId(reader.read<std::uint32_t>());
+    view->setPoseId(reader.read<std::uint32_t>());
+
+    const IndexT rigId = reader.read<std::uint32_t>();
+    const IndexT subPoseId = reader.read<std::uint32_t>();
+    if(rigId != UndefinedIndexT)
+      view->setRigAndSubPoseId(rigId, subPoseId);
+
+    view->setFrameId(reader.read<std::uint32_t>());
+    view->setIntrinsicId(reader.read<std::uint32_t>());
+    view->setResectionId(reader.read<std::uint32_t>());
+    view->setIndependantPose(reader.read<std::uint8_t>() != 0);
+    view->setWidth(reader.read<std::uint64_t>());
+    view->setHeight(reader.read<std::uint64_t>());
+    view->setImagePath(reader.readString());
+
+    const std::uint32_t nbMetadata = reader.readCount<std::uint32_t>(2 * sizeof(std::uint32_t));
+    for(std::uint32_t m = 0; m < nbMetadata; ++m)
+    {
+      const std::string key = reader.readString();
+      view->addMetadata(key, reader.readString());
+    }
+
+    views.emplace(view->getViewId(), view);
+  }
+}
+
+void readIntrinsics(SectionReader& reader, sfmData::Intrinsics& intrinsics)
+{
+  const std::uint64_t nbIntrinsics = reader.readCount(1);
+
+  for(std::uint64_t i = 0; i < nbIntrinsics; ++i)
+  {
+    const IndexT intrinsicId = reader.read<std::uint32_t>();
+    const unsigned int width = reader.read<std::uint32_t>();
+    const unsigned int height = reader.read<std::uint32_t>();
+    const std::string serialNumber = reader.readString();
+    const camera::EINTRINSIC intrinsicType = camera::EINTRINSIC_stringToEnum(reader.readString());
+    const camera::EIntrinsicInitMode initializationMode = camera::EIntrinsicInitMode_stringToEnum(reader.readString());
+    const double initialFocalLengthPix = reader.read<double>();
+    const bool locked = reader.read<std::uint8_t>() != 0;
+
+    // check if the camera is a Pinhole model
+    if(!camera::isPinhole(intrinsicType))
+      throw std::out_of_range("Only Pinhole camera model supported");
+
+    const double pxFocalLength = reader.read<double>();
+    Vec2 principalPoint;
+    reader.read(principalPoint.data(), 2 * sizeof(double));
+
+    std::shared_ptr<camera::Pinhole> pinholeIntrinsic = camera::createPinholeIntrinsic(intrinsicType, width, height, pxFocalLength, principalPoint(0), principalPoint(1));
+    pinholeIntrinsic->setInitialFocalLengthPix(initialFocalLengthPix);
+    pinholeIntrinsic->setSerialNumber(serialNumber);
+    pinholeIntrinsic->setInitializationMode(initializationMode);
+
+    std::vector<double> distortionParams(reader.readCount<std::uint32_t>(sizeof(double)));
+    reader.read(distortionParams.data(), distortionParams.size() * sizeof(double));
+
+    // ensure that we have the right number of params
+    distortionParams.resize(pinholeIntrinsic->getDistortionParams().size(), 0.0);
+    pinholeIntrinsic->setDistortionParams(distortionParams);
+
+    if(locked)
+      pinholeIntrinsic->lock();
+    else
+      pinholeIntrinsic->unlock();
+
+    intrinsics.emplace(intrinsicId, pinholeIntrinsic);
+  }
+}
+
+void readPoses(SectionReader& reader, sfmData::Poses& poses)
+{
+  const std::uint64_t nbPoses = reader.readCount(1);
+
+  for(std::uint64_t i = 0; i < nbPoses; ++i)
+  {
+    const IndexT poseId = reader.read<std::uint32_t>();
+    geometry::Pose3 transform;
+
+    reader.readMat(transform.rotation(), transform.center());
+
+    poses.emplace(poseId, sfmData::CameraPose(transform, reader.read<std::uint8_t>() != 0));
+  }
+}
+
+void readRigs(SectionReader& reader, sfmData::Rigs& rigs)
+{
+  const std::uint64_t nbRigs = reader.readCount(1);
+
+  for(std::uint64_t i = 0; i < nbRigs; ++i)
+  {
+    const IndexT rigId = reader.read<std::uint32_t>();
+    const std::uint32_t nbSubPoses = reader.readCount<std::uint32_t>(sizeof(std::uint8_t) + 12 * sizeof(double));
+    sfmData::Rig rig(nbSubPoses);
+
+    for(std::uint32_t subPoseId = 0; subPoseId < nbSubPoses; ++subPoseId)
+    {
+      sfmData::RigSubPose subPose;
+
+      subPose.status = static_cast<sfmData::ERigSubPoseStatus>(reader.read<std::uint8_t>());
+      reader.readMat(subPose.pose.rotation(), subPose.pose.center());
+
+      rig.setSubPose(subPoseId, subPose);
+    }
+
+    rigs.emplace(rigId, rig);
+  }
+}
+
+/**
+ * @brief Read the landmarks sections
+ * @param[in] file The mapped file
+ * @param[in] sections The landmarks, observations and features section types
+ * @param[out] landmarks The output landmarks
+ * @param[in] loadObservations Load the observations view ids
+ * @param[in] loadFeatures Load the observations features
+ */
+void readLandmarks(const MappedFile& file, const ESection (&sections)[3], sfmData::Landmarks& landmarks, bool loadObservations, bool loadFeatures)
+{
+  if(!file.hasSection(sections[0]))
+    return;
+
+  std::vector<char> landmarksBuffer;
+  std::vector<char> observationsBuffer;
+  std::vector<char> featuresBuffer;
+
+  SectionReader landmarksReader = file.section(sections[0], landmarksBuffer);
+  const std::uint64_t nbLandmarks = landmarksReader.readCount(sizeof(LandmarkRecord));
+  const char* records = landmarksReader.readInPlace(nbLandmarks * sizeof(LandmarkRecord));
+
+  loadObservations = loadObservations && file.hasSection(sections[1]);
+  loadFeatures = loadObservations && loadFeatures && file.hasSection(sections[2]);
+
+  const char* viewIds = nullptr;
+  const char* features = nullptr;
+  std::uint64_t nbObservations = 0;
+
+  if(loadObservations)
+  {
+    SectionReader observationsReader = file.section(sections[1], observationsBuffer);
+    nbObservations = observationsReader.readCount(sizeof(std::uint32_t));
+    viewIds = observationsReader.readInPlace(nbObservations * sizeof(std::uint32_t));
+  }
+
+  if(loadFeatures)
+  {
+    SectionReader featuresReader = file.section(sections[2], featuresBuffer);
+    if(featuresReader.readCount(sizeof(FeatureRecord)) != nbObservations)
+      throw std::runtime_error("the numbers of observations and features differ");
+    features = featuresReader.readInPlace(nbObservations * sizeof(FeatureRecord));
+  }
+
+  std::uint64_t observationIndex = 0;
+
+  for(std::uint64_t i = 0; i < nbLandmarks; ++i)
+  {
+    LandmarkRecord record;
+    std::memcpy(&record, records + i * sizeof(LandmarkRecord), sizeof(LandmarkRecord));
+
+    sfmData::Landmark landmark;
+    landmark.descType = static_cast<feature::EImageDescriberType>(record.descType);
+    for(int c = 0; c < 3; ++c)
+    {
+      landmark.rgb(c) = record.rgb[c];
+      landmark.X(c) = record.X[c];
+    }
+
+    if(loadObservations)
+    {
+      if(record.nbObservations > nbObservations - observationIndex)
+        throw std::runtime_error("invalid number of observations");
+
+      landmark.observations.reserve(record.nbObservations);
+
+      // observations are written sorted by view id
+      for(std::uint32_t o = 0; o < record.nbObservations; ++o, ++observationIndex)
+      {
+        std::uint32_t viewId;
+        std::memcpy(&viewId, viewIds + observationIndex * sizeof(std::uint32_t), sizeof(std::uint32_t));
+
+        sfmData::Observation observation;
+
+        if(loadFeatures)
+        {
+          FeatureRecord feature;
+          std::memcpy(&feature, features + observationIndex * sizeof(FeatureRecord), sizeof(FeatureRecord));
+
+          observation.id_feat = feature.featureId;
+          observation.x = Vec2(feature.x[0], feature.x[1]);
+          observation.scale = feature.scale;
+        }
+
+        landmark.observations.emplace_hint(landmark.observations.end(), viewId, observation);
+      }
+    }
+
+    landmarks.emplace(record.landmarkId, std::move(landmark));
+  }
+}
+
+const ESection structureSections[3] = {ESection::STRUCTURE, ESection::STRUCTURE_OBSERVATIONS, ESection::STRUCTURE_FEATURES};
+const ESection controlPointsSections[3] = {ESection::CONTROL_POINTS, ESection::CONTROL_POINTS_OBSERVATIONS, ESection::CONTROL_POINTS_FEATURES};
+
+} // namespace
+
+bool saveBinary(const sfmData::SfMData& sfmData, const std::string& filename, ESfMData partFlag, bool compress)
+{
+  // save flags
+  const bool saveViews = (partFlag & VIEWS) == VIEWS;
+  const bool saveIntrinsics = (partFlag & INTRINSICS) == INTRINSICS;
+  const bool saveExtrinsics = (partFlag & EXTRINSICS) == EXTRINSICS;
+  const bool saveStructure = (partFlag & STRUCTURE) == STRUCTURE;
+  const bool saveControlPoints = (partFlag & CONTROL_POINTS) == CONTROL_POINTS;
+  const bool saveFeatures = (partFlag & OBSERVATIONS_WITH_FEATURES) == OBSERVATIONS_WITH_FEATURES;
+  const bool saveObservations = saveFeatures || ((partFlag & OBSERVATIONS) == OBSERVATIONS);
+
+#if !ALICEVISION_IS_DEFINED(ALICEVISION_HAVE_ZLIB)
+  if(compress)
+  {
+    ALICEVISION_LOG_WARNING("AliceVision is built without zlib, the binary SfMData file '" << filename << "' is not compressed.");
+    compress = false;
+  }
+#endif
+
+  std::ofstream stream(filename, std::ios::binary);
+
+  if(!stream.is_open())
+  {
+    ALICEVISION_LOG_ERROR("Cannot open the SfMData file: '" << filename << "'.");
+    return false;
+  }
+
+  // the number of sections is known before writing them
+  std::uint32_t nbSections = 1;
+  nbSections += (saveViews && !sfmData.getViews().empty());
+  nbSections += (saveIntrinsics && !sfmData.getIntrinsics().empty());
+  nbSections += (saveExtrinsics && !sfmData.getPoses().empty());
+  nbSections += (saveExtrinsics && !sfmData.getRigs().empty());
+  if(saveStructure && !sfmData.getLandmarks().empty())
+    nbSections += 1 + saveObservations + saveFeatures;
+  if(saveControlPoints && !sfmData.getControlPoints().empty())
+    nbSections += 3;
+
+  FileHeader header;
+  std::memcpy(header.magic, fileMagic, sizeof(fileMagic));
+  header.version = fileVersion;
+  header.byteOrderMark = byteOrderMark;
+  header.nbSections = nbSections;
+  header.reserved = 0;
+
+  std::vector<SectionEntry> toc;
+  toc.reserve(nbSections);
+
+  try
+  {
+    // header and space for the table of contents, written once the sections are known
+    stream.write(reinterpret_cast<const char*>(&header), sizeof(FileHeader));
+    const std::vector<SectionEntry> emptyToc(nbSections, SectionEntry());
+    stream.write(reinterpret_cast<const char*>(emptyToc.data()), nbSections * sizeof(SectionEntry));
+
+    {
+      SectionBuffer buffer;
+      writeFolders(sfmData, buffer);
+      writeSection(stream, ESection::FOLDERS, buffer, compress, toc);
+    }
+
+    if(saveViews && !sfmData.getViews().empty())
+    {
+      SectionBuffer buffer;
+      writeViews(sfmData.getViews(), buffer);
+      writeSection(stream, ESection::VIEWS, buffer, compress, toc);
+    }
+
+    if(saveIntrinsics && !sfmData.getIntrinsics().empty())
+    {
+      SectionBuffer buffer;
+      writeIntrinsics(sfmData.getIntrinsics(), buffer);
+      writeSection(stream, ESection::INTRINSICS, buffer, compress, toc);
+    }
+
+    if(saveExtrinsics && !sfmData.getPoses().empty())
+    {
+      SectionBuffer buffer;
+      writePoses(sfmData.getPoses(), buffer);
+      writeSection(stream, ESection::POSES, buffer, compress, toc);
+    }
+
+    if(saveExtrinsics && !sfmData.getRigs().empty())
+    {
+      SectionBuffer buffer;
+      writeRigs(sfmData.getRigs(), buffer);
+      writeSection(stream, ESection::RIGS, buffer, compress, toc);
+    }
+
+    if(saveStructure && !sfmData.getLandmarks().empty())
+      writeLandmarks(stream, sfmData.getLandmarks(), structureSections, saveObservations, saveFeatures, compress, toc);
+
+    if(saveControlPoints && !sfmData.getControlPoints().empty())
+      writeLandmarks(stream, sfmData.getControlPoints(), controlPointsSections, true, true, compress, toc);
+
+    assert(toc.size() == nbSections);
+
+    stream.seekp(sizeof(FileHeader));
+    stream.write(reinterpret_cast<const char*>(toc.data()), toc.size() * sizeof(SectionEntry));
+  }
+  catch(const std::exception& e)
+  {
+    ALICEVISION_LOG_ERROR("Failed to write the SfMData file: '" << filename << "': " << e.what());
+    return false;
+  }
+
+  stream.close();
+
+  if(!stream)
+  {
+    ALICEVISION_LOG_ERROR("Failed to write the SfMData file: '" << filename << "'.");
+    return false;
+  }
+
+  return true;
+}
+
+bool loadBinary(sfmData::SfMData& sfmData, const std::string& filename, ESfMData partFlag)
+{
+  // load flags
+  const bool loadViews = (partFlag & VIEWS) == VIEWS;
+  const bool loadIntrinsics = (partFlag & INTRINSICS) == INTRINSICS;
+  const bool loadExtrinsics = (partFlag & EXTRINSICS) == EXTRINSICS;
+  const bool loadStructure = (partFlag & STRUCTURE) == STRUCTURE;
+  const bool loadControlPoints = (partFlag & CONTROL_POINTS) == CONTROL_POINTS;
+  const bool loadFeatures = (partFlag & OBSERVATIONS_WITH_FEATURES) == OBSERVATIONS_WITH_FEATURES;
+  const bool loadObservations = loadFeatures || ((partFlag & OBSERVATIONS) == OBSERVATIONS);
+
+  if(!fs::is_regular_file(filename) || fs::file_size(filename) < sizeof(FileHeader))
+  {
+    ALICEVISION_LOG_ERROR("Cannot open the SfMData file: '" << filename << "'.");
+    return false;
+  }
+
+  try
+  {
+    const MappedFile file(filename);
+    std::vector<char> buffer;
+
+    // only the requested sections are read
+    if(file.hasSection(ESection::FOLDERS))
+    {
+      SectionReader reader = file.section(ESection::FOLDERS, buffer);
+      readFolders(reader, sfmData);
+    }
+
+    if(loadIntrinsics && file.hasSection(ESection::INTRINSICS))
+    {
+      SectionReader reader = file.section(ESection::INTRINSICS, buffer);
+      readIntrinsics(reader, sfmData.getIntrinsics());
+    }
+
+    if(loadViews && file.hasSection(ESection::VIEWS))
+    {
+      SectionReader reader = file.section(ESection::VIEWS, buffer);
+      readViews(reader, sfmData.getViews());
+    }
+
+    if(loadExtrinsics && file.hasSection(ESection::POSES))
+    {
+      SectionReader reader = file.section(ESection::POSES, buffer);
+      readPoses(reader, sfmData.getPoses());
+    }
+
+    if(loadExtrinsics && file.hasSection(ESection::RIGS))
+    {
+      SectionReader reader = file.section(ESection::RIGS, buffer);
+      readRigs(reader, sfmData.getRigs());
+    }
+
+    if(loadStructure)
+      readLandmarks(file, structureSections, sfmData.getLandmarks(), loadObservations, loadFeatures);
+
+    if(loadControlPoints)
+      readLandmarks(file, controlPointsSections, sfmData.getControlPoints(), true, true);
+  }
+  catch(const std::exception& e)
+  {
+    ALICEVISION_LOG_ERROR("Failed to read the SfMData file: '" << filename << "': " << e.what());
+    return false;
+  }
+
+  return true;
+}
+
+} // namespace sfmDataIO
+} // namespace aliceVision
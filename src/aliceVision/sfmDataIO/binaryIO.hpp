@@ -0,0 +1,45 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2020 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#pragma once
+
+#include <aliceVision/sfmDataIO/sfmDataIO.hpp>
+
+#include <string>
+
+namespace aliceVision {
+namespace sfmDataIO {
+
+/**
+ * @brief Save an SfMData in a binary file (.sfmb, or .sfmbz for the compressed sections).
+ *
+ * The file starts with a table of contents giving the offset and size of each section
+ * (folders, views, intrinsics, poses, rigs, landmarks, observations, features, control points),
+ * so a partial load only reads the requested sections.
+ * Landmarks, observations and features are stored in fixed-size records,
+ * read directly from the memory-mapped file when the sections are not compressed.
+ * It contains the same parts of the SfMData as the JSON format.
+ *
+ * @param[in] sfmData The input SfMData
+ * @param[in] filename The filename
+ * @param[in] partFlag The ESfMData save flag
+ * @param[in] compress Compress the sections with zlib (if available), the sections cannot be memory-mapped anymore
+ * @return true if completed
+ */
+bool saveBinary(const sfmData::SfMData& sfmData, const std::string& filename, ESfMData partFlag, bool compress = false);
+
+/**
+ * @brief Load a binary SfMData file (.sfmb or .sfmbz).
+ *        Only the sections requested by the partFlag are read.
+ * @param[out] sfmData The output SfMData
+ * @param[in] filename The filename
+ * @param[in] partFlag The ESfMData load flag
+ * @return true if completed
+ */
+bool loadBinary(sfmData::SfMData& sfmData, const std::string& filename, ESfMData partFlag);
+
+} // namespace sfmDataIO
+} // namespace aliceVision
@@ -6,12 +6,18 @@
 
 #include "jsonIO.hpp"
 #include <aliceVision/camera/camera.hpp>
+#include <aliceVision/sfmDataIO/jsonStream.hpp>
 #include <aliceVision/sfmDataIO/viewIO.hpp>
+#include <aliceVision/system/Logger.hpp>
+#include <aliceVision/alicevision_omp.hpp>
 
-#include <boost/property_tree/json_parser.hpp>
-
+#include <algorithm>
+#include <fstream>
 #include <memory>
 #include <cassert>
+#include <exception>
+#include <sstream>
+#include <vector>
 
 namespace aliceVision {
 namespace sfmDataIO {
@@ -279,6 +285,268 @@ void loadLandmark(IndexT& landmarkId, sfmData::Landmark& landmark, bpt::ptree& l
 }
 
 
+namespace {
+
+/// Number of landmarks formatted by each task when saving the structure
+const std::size_t landmarksChunkSize = 1000;
+
+/**
+ * @brief Write a property tree element created by one of the save functions (saveView, saveIntrinsic, ...)
+ * @param[in,out] writer The JSON writer
+ * @param[in] parentTree The tree containing the element
+ */
+void writeTreeElement(JsonWriter& writer, const bpt::ptree& parentTree)
+{
+  for(const auto& element : parentTree)
+    writer.tree(element.first, element.second);
+}
+
+/**
+ * @brief Write a Landmark with the same schema as saveLandmark
+ * @param[in,out] writer The JSON writer
+ * @param[in] landmarkId The landmark Id
+ * @param[in] landmark The landmark
+ * @param[in] saveObservations Save landmark observations
+ * @param[in] saveFeatures Save landmark observations features
+ */
+void writeLandmark(JsonWriter& writer, IndexT landmarkId, const sfmData::Landmark& landmark, bool saveObservations, bool saveFeatures)
+{
+  writer.beginObject();
+  writer.value("landmarkId", landmarkId);
+  writer.value("descType", feature::EImageDescriberType_enumToString(landmark.descType));
+
+  writer.beginArray("color");
+  for(int i = 0; i < 3; ++i)
+    writer.value("", static_cast<unsigned int>(landmark.rgb(i)));
+  writer.endArray();
+
+  writer.beginArray("X");
+  for(int i = 0; i < 3; ++i)
+    writer.value("", landmark.X(i));
+  writer.endArray();
+
+  // observations
+  if(saveObservations)
+  {
+    if(landmark.observations.empty())
+    {
+      writer.value("observations", ""); // same as an empty property tree
+    }
+    else
+    {
+      writer.beginArray("observations");
+      for(const auto& obsPair : landmark.observations)
+      {
+        const sfmData::Observation& observation = obsPair.second;
+
+        writer.beginObject();
+        writer.value("observationId", obsPair.first);
+
+        // features
+        if(saveFeatures)
+        {
+          writer.value("featureId", observation.id_feat);
+          writer.beginArray("x");
+          writer.value("", observation.x(0));
+          writer.value("", observation.x(1));
+          writer.endArray();
+          writer.value("scale", observation.scale);
+        }
+        writer.endObject();
+      }
+      writer.endArray();
+    }
+  }
+
+  writer.endObject();
+}
+
+/**
+ * @brief Write Landmarks in a JSON array.
+ *        Landmarks are formatted in parallel by chunks, and written in the order of the container.
+ * @param[in,out] writer The JSON writer
+ * @param[in] name The array name
+ * @param[in] landmarks The landmarks
+ * @param[in] saveObservations Save landmark observations
+ * @param[in] saveFeatures Save landmark observations features
+ */
+void writeLandmarks(JsonWriter& writer, const std::string& name, const sfmData::Landmarks& landmarks, bool saveObservations, bool saveFeatures)
+{
+  std::vector<const sfmData::Landmarks::value_type*> landmarksPtr;
+  landmarksPtr.reserve(landmarks.size());
+  for(const auto& landmarkPair : landmarks)
+    landmarksPtr.push_back(&landmarkPair);
+
+  writer.beginArray(name);
+
+  // chunks are formatted by batches to bound the memory used by the formatted text
+  const std::size_t nbChunks = (landmarksPtr.size() + landmarksChunkSize - 1) / landmarksChunkSize;
+  const std::size_t nbChunksPerBatch = 4 * static_cast<std::size_t>(omp_get_max_threads());
+  const std::size_t depth = writer.depth();
+  std::vector<std::string> formattedChunks(std::min(nbChunks, nbChunksPerBatch));
+
+  for(std::size_t batchBegin = 0; batchBegin < nbChunks; batchBegin += nbChunksPerBatch)
+  {
+    const std::size_t batchEnd = std::min(nbChunks, batchBegin + nbChunksPerBatch);
+
+    std::exception_ptr formattingError = nullptr;
+
+    #pragma omp parallel for schedule(dynamic)
+    for(int c = static_cast<int>(batchBegin); c < static_cast<int>(batchEnd); ++c)
+    {
+      // exceptions cannot leave the parallel region, the first one is thrown after
+      try
+      {
+        std::ostringstream chunkStream;
+        JsonWriter chunkWriter(chunkStream, depth);
+
+        const std::size_t end = std::min(landmarksPtr.size(), (c + 1) * landmarksChunkSize);
+        for(std::size_t l = c * landmarksChunkSize; l < end; ++l)
+          writeLandmark(chunkWriter, landmarksPtr[l]->first, landmarksPtr[l]->second, saveObservations, saveFeatures);
+
+        formattedChunks.at(c - batchBegin) = chunkStream.str();
+      }
+      catch(...)
+      {
+        #pragma omp critical
+        if(formattingError == nullptr)
+          formattingError = std::current_exception();
+      }
+    }
+
+    if(formattingError != nullptr)
+      std::rethrow_exception(formattingError);
+
+    for(std::size_t c = batchBegin; c < batchEnd; ++c)
+    {
+      const std::size_t nbLandmarks = std::min(landmarksPtr.size(), (c + 1) * landmarksChunkSize) - c * landmarksChunkSize;
+      writer.appendElements(formattedChunks.at(c - batchBegin), nbLandmarks);
+    }
+  }
+
+  writer.endArray();
+}
+
+/**
+ * @brief Read a Landmark written with the saveLandmark schema
+ * @param[in,out] reader The JSON reader
+ * @param[out] landmarkId The output Landmark Id
+ * @param[out] landmark The output Landmmark
+ * @param[in] loadObservations Load landmark observations
+ * @param[in] loadFeatures Load landmark observations features
+ */
+void readLandmark(JsonReader& reader, IndexT& landmarkId, sfmData::Landmark& landmark, bool loadObservations, bool loadFeatures)
+{
+  bool hasLandmarkId = false;
+  std::string key;
+
+  if(!reader.beginObject())
+    reader.error("invalid landmark");
+
+  while(reader.nextKey(key))
+  {
+    if(key == "landmarkId")
+    {
+      landmarkId = static_cast<IndexT>(reader.readUnsigned());
+      hasLandmarkId = true;
+    }
+    else if(key == "descType")
+    {
+      landmark.descType = feature::EImageDescriberType_stringToEnum(reader.readString());
+    }
+    else if(key == "color")
+    {
+      double color[3];
+      reader.readDoubleArray(color, 3);
+      for(int i = 0; i < 3; ++i)
+        landmark.rgb(i) = static_cast<unsigned char>(color[i]);
+    }
+    else if(key == "X")
+    {
+      reader.readDoubleArray(landmark.X.data(), 3);
+    }
+    else if(key == "observations" && loadObservations)
+    {
+      if(!reader.beginArray())
+        continue;
+
+      while(reader.nextElement())
+      {
+        IndexT observationId = UndefinedIndexT;
+        sfmData::Observation observation;
+
+        if(!reader.beginObject())
+          reader.error("invalid observation");
+
+        while(reader.nextKey(key))
+        {
+          if(key == "observationId")
+            observationId = static_cast<IndexT>(reader.readUnsigned());
+          else if(key == "featureId" && loadFeatures)
+            observation.id_feat = static_cast<IndexT>(reader.readUnsigned());
+          else if(key == "x" && loadFeatures)
+            reader.readDoubleArray(observation.x.data(), 2);
+          else if(key == "scale" && loadFeatures)
+            observation.scale = reader.readDouble();
+          else
+            reader.skipValue();
+        }
+
+        if(observationId == UndefinedIndexT)
+          reader.error("observation without observationId");
+
+        landmark.observations.emplace(observationId, observation);
+      }
+    }
+    else
+    {
+      reader.skipValue();
+    }
+  }
+
+  if(!hasLandmarkId)
+    reader.error("landmark without landmarkId");
+}
+
+/**
+ * @brief Read an array of Landmarks
+ * @param[in,out] reader The JSON reader
+ * @param[out] landmarks The output landmarks
+ * @param[in] loadObservations Load landmark observations
+ * @param[in] loadFeatures Load landmark observations features
+ */
+void readLandmarks(JsonReader& reader, sfmData::Landmarks& landmarks, bool loadObservations, bool loadFeatures)
+{
+  if(!reader.beginArray())
+    return;
+
+  while(reader.nextElement())
+  {
+    IndexT landmarkId;
+    sfmData::Landmark landmark;
+
+    readLandmark(reader, landmarkId, landmark, loadObservations, loadFeatures);
+
+    landmarks.emplace(landmarkId, std::move(landmark));
+  }
+}
+
+/**
+ * @brief Read an array of strings
+ * @param[in,out] reader The JSON reader
+ * @param[out] strings The output strings
+ */
+void readStringArray(JsonReader& reader, std::vector<std::string>& strings)
+{
+  if(!reader.beginArray())
+    return;
+
+  while(reader.nextElement())
+    strings.push_back(reader.readString());
+}
+
+} // namespace
+
 bool saveJSON(const sfmData::SfMData& sfmData, const std::string& filename, ESfMData partFlag)
 {
   const Vec3 version = {1, 0, 0};
@@ -292,62 +560,71 @@ bool saveJSON(const sfmData::SfMData& sfmData, const std::string& filename, ESfM
   const bool saveFeatures = (partFlag & OBSERVATIONS_WITH_FEATURES) == OBSERVATIONS_WITH_FEATURES;
   const bool saveObservations = saveFeatures || ((partFlag & OBSERVATIONS) == OBSERVATIONS);
 
+  std::ofstream stream(filename);
+
+  if(!stream.is_open())
+  {
+    ALICEVISION_LOG_ERROR("Cannot open the SfMData file: '" << filename << "'.");
+    return false;
+  }
+
+  // the file is written as it goes, only small elements (views, intrinsics, poses, rigs)
+  // are created as property trees to reuse the same serialization functions
+  JsonWriter writer(stream);
 
-  // main tree
-  bpt::ptree fileTree;
+  writer.beginObject();
 
   // file version
-  saveMatrix("version", version, fileTree);
+  writer.beginArray("version");
+  for(int i = 0; i < version.size(); ++i)
+    writer.value("", version(i));
+  writer.endArray();
 
   // folders
   if(!sfmData.getRelativeFeaturesFolders().empty())
   {
-    bpt::ptree featureFoldersTree;
-
+    writer.beginArray("featuresFolders");
     for(const std::string& featuresFolder : sfmData.getRelativeFeaturesFolders())
-    {
-      bpt::ptree featureFolderTree;
-      featureFolderTree.put("", featuresFolder);
-      featureFoldersTree.push_back(std::make_pair("", featureFolderTree));
-    }
-
-    fileTree.add_child("featuresFolders", featureFoldersTree);
+      writer.value("", featuresFolder);
+    writer.endArray();
   }
 
   if(!sfmData.getRelativeMatchesFolders().empty())
   {
-    bpt::ptree matchingFoldersTree;
-
+    writer.beginArray("matchesFolders");
     for(const std::string& matchesFolder : sfmData.getRelativeMatchesFolders())
-    {
-      bpt::ptree matchingFolderTree;
-      matchingFolderTree.put("", matchesFolder);
-      matchingFoldersTree.push_back(std::make_pair("", matchingFolderTree));
-    }
-
-    fileTree.add_child("matchesFolders", matchingFoldersTree);
+      writer.value("", matchesFolder);
+    writer.endArray();
   }
 
   // views
   if(saveViews && !sfmData.getViews().empty())
   {
-    bpt::ptree viewsTree;
+    writer.beginArray("views");
 
     for(const auto& viewPair : sfmData.getViews())
+    {
+      bpt::ptree viewsTree;
       saveView("", *(viewPair.second), viewsTree);
+      writeTreeElement(writer, viewsTree);
+    }
 
-    fileTree.add_child("views", viewsTree);
+    writer.endArray();
   }
 
   // intrinsics
   if(saveIntrinsics && !sfmData.getIntrinsics().empty())
   {
-    bpt::ptree intrinsicsTree;
+    writer.beginArray("intrinsics");
 
     for(const auto& intrinsicPair : sfmData.getIntrinsics())
+    {
+      bpt::ptree intrinsicsTree;
       saveIntrinsic("", intrinsicPair.first, intrinsicPair.second, intrinsicsTree);
+      writeTreeElement(writer, intrinsicsTree);
+    }
 
-    fileTree.add_child("intrinsics", intrinsicsTree);
+    writer.endArray();
   }
 
   //extrinsics
@@ -356,7 +633,7 @@ bool saveJSON(const sfmData::SfMData& sfmData, const std::string& filename, ESfM
     // poses
     if(!sfmData.getPoses().empty())
     {
-      bpt::ptree posesTree;
+      writer.beginArray("poses");
 
       for(const auto& posePair : sfmData.getPoses())
       {
@@ -364,49 +641,45 @@ bool saveJSON(const sfmData::SfMData& sfmData, const std::string& filename, ESfM
 
         poseTree.put("poseId", posePair.first);
         saveCameraPose("pose", posePair.second, poseTree);
-        posesTree.push_back(std::make_pair("", poseTree));
+        writer.tree("", poseTree);
       }
 
-      fileTree.add_child("poses", posesTree);
+      writer.endArray();
     }
 
     // rigs
     if(!sfmData.getRigs().empty())
     {
-      bpt::ptree rigsTree;
+      writer.beginArray("rigs");
 
       for(const auto& rigPair : sfmData.getRigs())
+      {
+        bpt::ptree rigsTree;
         saveRig("", rigPair.first, rigPair.second, rigsTree);
+        writeTreeElement(writer, rigsTree);
+      }
 
-      fileTree.add_child("rigs", rigsTree);
+      writer.endArray();
     }
   }
 
   // structure
   if(saveStructure && !sfmData.getLandmarks().empty())
-  {
-    bpt::ptree structureTree;
-
-    for(const auto& structurePair : sfmData.getLandmarks())
-      saveLandmark("", structurePair.first, structurePair.second, structureTree, saveObservations, saveFeatures);
-
-    fileTree.add_child("structure", structureTree);
-  }
+    writeLandmarks(writer, "structure", sfmData.getLandmarks(), saveObservations, saveFeatures);
 
   // control points
   if(saveControlPoints && !sfmData.getControlPoints().empty())
-  {
-    bpt::ptree controlPointTree;
+    writeLandmarks(writer, "controlPoints", sfmData.getControlPoints(), true, true);
 
-    for(const auto& controlPointPair : sfmData.getControlPoints())
-      saveLandmark("", controlPointPair.first, controlPointPair.second, controlPointTree);
-
-    fileTree.add_child("controlPoints", controlPointTree);
-  }
+  writer.endObject();
 
-  // write the json file with the tree
+  stream.close();
 
-  bpt::write_json(filename, fileTree);
+  if(!stream)
+  {
+    ALICEVISION_LOG_ERROR("Failed to write the SfMData file: '" << filename << "'.");
+    return false;
+  }
 
   return true;
 }
@@ -425,165 +698,173 @@ bool loadJSON(sfmData::SfMData& sfmData, const std::string& filename, ESfMData p
   const bool loadFeatures = (partFlag & OBSERVATIONS_WITH_FEATURES) == OBSERVATIONS_WITH_FEATURES;
   const bool loadObservations = loadFeatures || ((partFlag & OBSERVATIONS) == OBSERVATIONS);
 
-  // main tree
-  bpt::ptree fileTree;
-
-  // read the json file and initialize the tree
-  bpt::read_json(filename, fileTree);
-
-  // version
-  loadMatrix("version", version, fileTree);
-
-  // folders
-  if(fileTree.count("featuresFolders"))
-    for(bpt::ptree::value_type& featureFolderNode : fileTree.get_child("featuresFolders"))
-      sfmData.addFeaturesFolder(featureFolderNode.second.get_value<std::string>());
-
-  if(fileTree.count("matchesFolders"))
-    for(bpt::ptree::value_type& matchingFolderNode : fileTree.get_child("matchesFolders"))
-      sfmData.addMatchesFolder(matchingFolderNode.second.get_value<std::string>());
-
-  // intrinsics
-  if(loadIntrinsics && fileTree.count("intrinsics"))
+  // read the whole json file, the document is parsed sequentially without building a tree
+  std::string fileContent;
   {
-    sfmData::Intrinsics& intrinsics = sfmData.getIntrinsics();
+    std::ifstream stream(filename, std::ios::binary);
 
-    for(bpt::ptree::value_type &intrinsicNode : fileTree.get_child("intrinsics"))
+    if(!stream.is_open())
     {
-      IndexT intrinsicId;
-      std::shared_ptr<camera::IntrinsicBase> intrinsic;
+      ALICEVISION_LOG_ERROR("Cannot open the SfMData file: '" << filename << "'.");
+      return false;
+    }
 
-      loadIntrinsic(intrinsicId, intrinsic, intrinsicNode.second);
+    stream.seekg(0, std::ios::end);
+    fileContent.resize(static_cast<std::size_t>(stream.tellg()));
+    stream.seekg(0, std::ios::beg);
+    stream.read(&fileContent[0], fileContent.size());
 
-      intrinsics.emplace(intrinsicId, intrinsic);
+    if(!stream)
+    {
+      ALICEVISION_LOG_ERROR("Failed to read the SfMData file: '" << filename << "'.");
+      return false;
     }
   }
 
-  // views
-  if(loadViews && fileTree.count("views"))
-  {
-    sfmData::Views& views = sfmData.getViews();
+  JsonReader reader(fileContent.c_str(), fileContent.c_str() + fileContent.size());
+  std::vector<sfmData::View> views;
+  std::string key;
 
-    if(incompleteViews)
+  if(!reader.beginObject())
+    reader.error("invalid SfMData file");
+
+  while(reader.nextKey(key))
+  {
+    if(key == "version")
     {
-      // store incomplete views in a vector
-      std::vector<sfmData::View> incompleteViews(fileTree.get_child("views").size());
+      reader.readDoubleArray(version.data(), 3);
+    }
+    else if(key == "featuresFolders" || key == "matchesFolders")
+    {
+      // folders
+      std::vector<std::string> folders;
+      readStringArray(reader, folders);
 
-      int viewIndex = 0;
-      for(bpt::ptree::value_type &viewNode : fileTree.get_child("views"))
+      for(const std::string& folder : folders)
       {
-        loadView(incompleteViews.at(viewIndex), viewNode.second);
-        ++viewIndex;
+        if(key == "featuresFolders")
+          sfmData.addFeaturesFolder(folder);
+        else
+          sfmData.addMatchesFolder(folder);
       }
+    }
+    else if(key == "intrinsics" && loadIntrinsics)
+    {
+      sfmData::Intrinsics& intrinsics = sfmData.getIntrinsics();
 
-      // update incomplete views
-      #pragma omp parallel for
-      for(int i = 0; i < incompleteViews.size(); ++i)
+      if(reader.beginArray())
       {
-        sfmData::View& v = incompleteViews.at(i);
-        // if we have the intrinsics and the view has an valid associated intrinsics
-        // update the width and height field of View (they are mirrored)
-        if (loadIntrinsics && v.getIntrinsicId() != UndefinedIndexT)
+        while(reader.nextElement())
         {
-          const auto intrinsics = sfmData.getIntrinsicPtr(v.getIntrinsicId());
+          IndexT intrinsicId;
+          std::shared_ptr<camera::IntrinsicBase> intrinsic;
+          bpt::ptree intrinsicTree = reader.readTree();
 
-          if(intrinsics == nullptr)
-          {
-            throw std::logic_error("View " + std::to_string(v.getViewId())
-                                   + " has a intrinsics id " +std::to_string(v.getIntrinsicId())
-                                   + " that cannot be found or the intrinsics are not correctly "
-                                     "loaded from the json file.");
-          }
+          loadIntrinsic(intrinsicId, intrinsic, intrinsicTree);
 
-          v.setWidth(intrinsics->w());
-          v.setHeight(intrinsics->h());
+          intrinsics.emplace(intrinsicId, intrinsic);
         }
-        updateIncompleteView(incompleteViews.at(i));
-        updateIncompleteView(incompleteViews.at(i), viewIdMethod, viewIdRegex);
       }
-
-      // copy complete views in the SfMData views map
-      for(const sfmData::View& view : incompleteViews)
-        views.emplace(view.getViewId(), std::make_shared<sfmData::View>(view));
     }
-    else
+    else if(key == "views" && loadViews)
     {
-      // store directly in the SfMData views map
-      for(bpt::ptree::value_type &viewNode : fileTree.get_child("views"))
+      // views are stored in the SfMData at the end, they may need the intrinsics
+      if(reader.beginArray())
       {
-        sfmData::View view;
-        loadView(view, viewNode.second);
-        views.emplace(view.getViewId(), std::make_shared<sfmData::View>(view));
+        while(reader.nextElement())
+        {
+          bpt::ptree viewTree = reader.readTree();
+          views.emplace_back();
+          loadView(views.back(), viewTree);
+        }
       }
     }
-  }
-
-  // extrinsics
-  if(loadExtrinsics)
-  {
-    // poses
-    if(fileTree.count("poses"))
+    else if(key == "poses" && loadExtrinsics)
     {
       sfmData::Poses& poses = sfmData.getPoses();
 
-      for(bpt::ptree::value_type &poseNode : fileTree.get_child("poses"))
+      if(reader.beginArray())
       {
-        bpt::ptree& poseTree = poseNode.second;
-        sfmData::CameraPose pose;
+        while(reader.nextElement())
+        {
+          bpt::ptree poseTree = reader.readTree();
+          sfmData::CameraPose pose;
 
-        loadCameraPose("pose", pose, poseTree);
+          loadCameraPose("pose", pose, poseTree);
 
-        poses.emplace(poseTree.get<IndexT>("poseId"), pose);
+          poses.emplace(poseTree.get<IndexT>("poseId"), pose);
+        }
       }
     }
-
-    // rigs
-    if(fileTree.count("rigs"))
+    else if(key == "rigs" && loadExtrinsics)
     {
       sfmData::Rigs& rigs = sfmData.getRigs();
 
-      for(bpt::ptree::value_type &rigNode : fileTree.get_child("rigs"))
+      if(reader.beginArray())
       {
-        IndexT rigId;
-        sfmData::Rig rig;
+        while(reader.nextElement())
+        {
+          IndexT rigId;
+          sfmData::Rig rig;
+          bpt::ptree rigTree = reader.readTree();
 
-        loadRig(rigId, rig, rigNode.second);
+          loadRig(rigId, rig, rigTree);
 
-        rigs.emplace(rigId, rig);
+          rigs.emplace(rigId, rig);
+        }
       }
     }
-  }
-
-  // structure
-  if(loadStructure && fileTree.count("structure"))
-  {
-    sfmData::Landmarks& structure = sfmData.getLandmarks();
-
-    for(bpt::ptree::value_type &landmarkNode : fileTree.get_child("structure"))
+    else if(key == "structure" && loadStructure)
     {
-      IndexT landmarkId;
-      sfmData::Landmark landmark;
-
-      loadLandmark(landmarkId, landmark, landmarkNode.second, loadObservations, loadFeatures);
-
-      structure.emplace(landmarkId, landmark);
+      readLandmarks(reader, sfmData.getLandmarks(), loadObservations, loadFeatures);
+    }
+    else if(key == "controlPoints" && loadControlPoints)
+    {
+      readLandmarks(reader, sfmData.getControlPoints(), true, true);
+    }
+    else
+    {
+      // not loaded part
+      reader.skipValue();
     }
   }
 
-  // control points
-  if(loadControlPoints && fileTree.count("controlPoints"))
+  // views
+  if(loadViews && !views.empty())
   {
-    sfmData::Landmarks& controlPoints = sfmData.getControlPoints();
-
-    for(bpt::ptree::value_type &landmarkNode : fileTree.get_child("controlPoints"))
+    if(incompleteViews)
     {
-      IndexT landmarkId;
-      sfmData::Landmark landmark;
+      // update incomplete views
+      #pragma omp parallel for
+      for(int i = 0; i < views.size(); ++i)
+      {
+        sfmData::View& v = views.at(i);
+        // if we have the intrinsics and the view has an valid associated intrinsics
+        // update the width and height field of View (they are mirrored)
+        if (loadIntrinsics && v.getIntrinsicId() != UndefinedIndexT)
+        {
+          const auto intrinsics = sfmData.getIntrinsicPtr(v.getIntrinsicId());
 
-      loadLandmark(landmarkId, landmark, landmarkNode.second);
+          if(intrinsics == nullptr)
+          {
+            throw std::logic_error("View " + std::to_string(v.getViewId())
+                                   + " has a intrinsics id " +std::to_string(v.getIntrinsicId())
+                                   + " that cannot be found or the intrinsics are not correctly "
+                                     "loaded from the json file.");
+          }
 
-      controlPoints.emplace(landmarkId, landmark);
+          v.setWidth(intrinsics->w());
+          v.setHeight(intrinsics->h());
+        }
+        updateIncompleteView(views.at(i));
+        updateIncompleteView(views.at(i), viewIdMethod, viewIdRegex);
+      }
     }
+
+    // copy views in the SfMData views map
+    sfmData::Views& sfmViews = sfmData.getViews();
+    for(const sfmData::View& view : views)
+      sfmViews.emplace(view.getViewId(), std::make_shared<sfmData::View>(view));
   }
 
   return true;
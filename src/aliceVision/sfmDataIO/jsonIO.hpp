@@ -205,7 +205,8 @@ void saveLandmark(const std::string& name, IndexT landmarkId, const sfmData::Lan
 void loadLandmark(IndexT& landmarkId, sfmData::Landmark& landmark, bpt::ptree& landmarkTree, bool loadObservations = true, bool loadFeatures = true);
 
 /**
- * @brief Save an SfMData in a JSON file with a boost property tree.
+ * @brief Save an SfMData in a JSON file.
+ *        The file is written as a stream, the landmarks are formatted in parallel.
  * @param[in] sfmData The input SfMData
  * @param[in] filename The filename
  * @param[in] partFlag The ESfMData save flag
@@ -215,6 +216,7 @@ bool saveJSON(const sfmData::SfMData& sfmData, const std::string& filename, ESfM
 
 /**
  * @brief Load a JSON SfMData file.
+ *        The file is parsed as a stream, the landmarks are read without building a property tree.
  * @param[out] sfmData The output SfMData
  * @param[in] filename The filename
  * @param[in] partFlag The ESfMData load flag
@@ -0,0 +1,567 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2020 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include "jsonStream.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <stdexcept>
+
+namespace aliceVision {
+namespace sfmDataIO {
+
+namespace {
+
+/**
+ * @brief Write a string with the same escape sequences as boost::property_tree::write_json
+ * @param[in,out] stream The output stream
+ * @param[in] str The string to escape
+ */
+void writeEscaped(std::ostream& stream, const std::string& str)
+{
+  const char* hexDigits = "0123456789ABCDEF";
+  const char* begin = str.data();
+  const char* end = begin + str.size();
+  const char* chunkBegin = begin;
+
+  for(const char* c = begin; c != end; ++c)
+  {
+    const unsigned char uc = static_cast<unsigned char>(*c);
+
+    // characters written as is
+    if(uc == 0x20 || uc == 0x21 || (uc >= 0x23 && uc <= 0x2E) || (uc >= 0x30 && uc <= 0x5B) || uc >= 0x5D)
+      continue;
+
+    stream.write(chunkBegin, c - chunkBegin);
+    chunkBegin = c + 1;
+
+    switch(*c)
+    {
+      case '\b': stream << "\\b"; break;
+      case '\f': stream << "\\f"; break;
+      case '\n': stream << "\\n"; break;
+      case '\r': stream << "\\r"; break;
+      case '\t': stream << "\\t"; break;
+      case '/':  stream << "\\/"; break;
+      case '"':  stream << "\\\""; break;
+      case '\\': stream << "\\\\"; break;
+      default:
+        stream << "\\u00" << hexDigits[uc / 16] << hexDigits[uc % 16];
+    }
+  }
+  stream.write(chunkBegin, end - chunkBegin);
+}
+
+/**
+ * @brief Append a unicode code point to a string in UTF-8
+ * @param[in] codePoint The unicode code point
+ * @param[in,out] str The output string
+ */
+void appendUtf8(unsigned long codePoint, std::string& str)
+{
+  if(codePoint < 0x80)
+  {
+    str += static_cast<char>(codePoint);
+  }
+  else if(codePoint < 0x800)
+  {
+    str += static_cast<char>(0xC0 | (codePoint >> 6));
+    str += static_cast<char>(0x80 | (codePoint & 0x3F));
+  }
+  else if(codePoint < 0x10000)
+  {
+    str += static_cast<char>(0xE0 | (codePoint >> 12));
+    str += static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F));
+    str += static_cast<char>(0x80 | (codePoint & 0x3F));
+  }
+  else
+  {
+    str += static_cast<char>(0xF0 | (codePoint >> 18));
+    str += static_cast<char>(0x80 | ((codePoint >> 12) & 0x3F));
+    str += static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F));
+    str += static_cast<char>(0x80 | (codePoint & 0x3F));
+  }
+}
+
+} // namespace
+
+JsonWriter::JsonWriter(std::ostream& stream)
+  : _stream(stream)
+{}
+
+JsonWriter::JsonWriter(std::ostream& stream, std::size_t depth)
+  : _stream(stream)
+  , _levels(depth, Level{true, 0})
+{}
+
+void JsonWriter::beginElement(const std::string& key)
+{
+  if(_levels.empty())
+    return; // root
+
+  Level& level = _levels.back();
+
+  if(level.nbElements > 0)
+    _stream.put(',');
+  ++level.nbElements;
+
+  _stream.put('\n');
+  for(std::size_t i = 0; i < _levels.size(); ++i)
+    _stream.write("    ", 4);
+
+  if(!level.isArray)
+  {
+    _stream.put('"');
+    writeEscaped(_stream, key);
+    _stream.write("\": ", 3);
+  }
+}
+
+void JsonWriter::endContainer(char closingChar)
+{
+  if(_levels.empty())
+    throw std::logic_error("JsonWriter: no container to close.");
+
+  const std::size_t nbElements = _levels.back().nbElements;
+  _levels.pop_back();
+
+  if(nbElements > 0)
+  {
+    _stream.put('\n');
+    for(std::size_t i = 0; i < _levels.size(); ++i)
+      _stream.write("    ", 4);
+  }
+  _stream.put(closingChar);
+
+  if(_levels.empty())
+    _stream.put('\n'); // end of the document
+}
+
+void JsonWriter::beginObject(const std::string& key)
+{
+  beginElement(key);
+  _stream.put('{');
+  _levels.push_back(Level{false, 0});
+}
+
+void JsonWriter::endObject()
+{
+  endContainer('}');
+}
+
+void JsonWriter::beginArray(const std::string& key)
+{
+  beginElement(key);
+  _stream.put('[');
+  _levels.push_back(Level{true, 0});
+}
+
+void JsonWriter::endArray()
+{
+  endContainer(']');
+}
+
+void JsonWriter::value(const std::string& key, const std::string& value)
+{
+  beginElement(key);
+  _stream.put('"');
+  writeEscaped(_stream, value);
+  _stream.put('"');
+}
+
+void JsonWriter::value(const std::string& key, double value)
+{
+  // same precision as boost::property_tree (max_digits10)
+  char buffer[32];
+  const int size = std::snprintf(buffer, sizeof(buffer), "%.17g", value);
+  beginElement(key);
+  _stream.put('"');
+  _stream.write(buffer, size);
+  _stream.put('"');
+}
+
+void JsonWriter::value(const std::string& key, long long value)
+{
+  char buffer[32];
+  const int size = std::snprintf(buffer, sizeof(buffer), "%lld", value);
+  beginElement(key);
+  _stream.put('"');
+  _stream.write(buffer, size);
+  _stream.put('"');
+}
+
+void JsonWriter::value(const std::string& key, unsigned long long value)
+{
+  char buffer[32];
+  const int size = std::snprintf(buffer, sizeof(buffer), "%llu", value);
+  beginElement(key);
+  _stream.put('"');
+  _stream.write(buffer, size);
+  _stream.put('"');
+}
+
+void JsonWriter::tree(const std::string& key, const bpt::ptree& tree)
+{
+  if(tree.empty())
+  {
+    value(key, tree.data());
+  }
+  else if(tree.count("") == tree.size())
+  {
+    beginArray(key);
+    for(const auto& child : tree)
+      this->tree("", child.second);
+    endArray();
+  }
+  else
+  {
+    beginObject(key);
+    for(const auto& child : tree)
+      this->tree(child.first, child.second);
+    endObject();
+  }
+}
+
+void JsonWriter::appendElements(const std::string& elements, std::size_t nbElements)
+{
+  if(_levels.empty() || !_levels.back().isArray)
+    throw std::logic_error("JsonWriter: elements can only be appended to an array.");
+
+  if(nbElements == 0)
+    return;
+
+  Level& level = _levels.back();
+  if(level.nbElements > 0)
+    _stream.put(',');
+  level.nbElements += nbElements;
+  _stream.write(elements.data(), elements.size());
+}
+
+JsonReader::JsonReader(const char* begin, const char* end)
+  : _begin(begin)
+  , _end(end)
+  , _current(begin)
+{}
+
+void JsonReader::error(const std::string& message) const
+{
+  const std::size_t line = 1 + std::count(_begin, _current, '\n');
+  throw std::runtime_error("JSON parse error (line " + std::to_string(line) + "): " + message);
+}
+
+char JsonReader::peek()
+{
+  while(_current != _end && (*_current == ' ' || *_current == '\n' || *_current == '\r' || *_current == '\t'))
+    ++_current;
+  return (_current == _end) ? 0 : *_current;
+}
+
+void JsonReader::expect(char c)
+{
+  if(peek() != c)
+    error(std::string("expected '") + c + "'");
+  ++_current;
+}
+
+bool JsonReader::beginObject()
+{
+  if(peek() == '"')
+  {
+    if(!readString().empty())
+      error("expected an object");
+    return false;
+  }
+  expect('{');
+  _hasElements.push_back(false);
+  return true;
+}
+
+bool JsonReader::nextKey(std::string& key)
+{
+  if(peek() == '}')
+  {
+    ++_current;
+    _hasElements.pop_back();
+    return false;
+  }
+  if(_hasElements.back())
+    expect(',');
+  _hasElements.back() = true;
+
+  if(peek() != '"')
+    error("expected a key");
+  key = readString();
+  expect(':');
+  return true;
+}
+
+bool JsonReader::beginArray()
+{
+  if(peek() == '"')
+  {
+    if(!readString().empty())
+      error("expected an array");
+    return false;
+  }
+  expect('[');
+  _hasElements.push_back(false);
+  return true;
+}
+
+bool JsonReader::nextElement()
+{
+  if(peek() == ']')
+  {
+    ++_current;
+    _hasElements.pop_back();
+    return false;
+  }
+  if(_hasElements.back())
+    expect(',');
+  _hasElements.back() = true;
+  return true;
+}
+
+std::string JsonReader::readString()
+{
+  if(peek() != '"')
+    return readLiteral();
+
+  ++_current;
+  std::string str;
+
+  while(true)
+  {
+    // copy the characters until the next quote or escape sequence
+    const char* chunkEnd = _current;
+    while(chunkEnd != _end && *chunkEnd != '"' && *chunkEnd != '\\')
+      ++chunkEnd;
+    str.append(_current, chunkEnd);
+    _current = chunkEnd;
+
+    if(_current == _end)
+      error("unterminated string");
+
+    if(*_current == '"')
+    {
+      ++_current;
+      return str;
+    }
+
+    // escape sequence
+    ++_current;
+    if(_current == _end)
+      error("unterminated string");
+
+    switch(*_current++)
+    {
+      case '"':  str += '"'; break;
+      case '\\': str += '\\'; break;
+      case '/':  str += '/'; break;
+      case 'b':  str += '\b'; break;
+      case 'f':  str += '\f'; break;
+      case 'n':  str += '\n'; break;
+      case 'r':  str += '\r'; break;
+      case 't':  str += '\t'; break;
+      case 'u':
+      {
+        const auto readCodeUnit = [this]()
+        {
+          if(_end - _current < 4)
+            error("invalid unicode escape sequence");
+          char hex[5] = {_current[0], _current[1], _current[2], _current[3], 0};
+          char* hexEnd;
+          const unsigned long codeUnit = std::strtoul(hex, &hexEnd, 16);
+          if(hexEnd != hex + 4)
+            error("invalid unicode escape sequence");
+          _current += 4;
+          return codeUnit;
+        };
+
+        unsigned long codePoint = readCodeUnit();
+
+        // surrogate pair
+        if(codePoint >= 0xD800 && codePoint < 0xDC00 && _end - _current >= 2 && _current[0] == '\\' && _current[1] == 'u')
+        {
+          _current += 2;
+          const unsigned long low = readCodeUnit();
+          codePoint = 0x10000 + ((codePoint - 0xD800) << 10) + (low - 0xDC00);
+        }
+        appendUtf8(codePoint, str);
+        break;
+      }
+      default:
+        error("invalid escape sequence");
+    }
+  }
+}
+
+std::string JsonReader::readLiteral()
+{
+  const char first = peek();
+  const char* literalEnd = _current;
+  while(literalEnd != _end && (std::isalnum(static_cast<unsigned char>(*literalEnd)) ||
+                               *literalEnd == '-' || *literalEnd == '+' || *literalEnd == '.'))
+    ++literalEnd;
+
+  if(literalEnd == _current)
+    error(first ? std::string("unexpected character '") + first + "'" : std::string("unexpected end of document"));
+
+  std::string literal(_current, literalEnd);
+  _current = literalEnd;
+  return literal;
+}
+
+const char* JsonReader::numberBegin(bool& isQuoted)
+{
+  isQuoted = (peek() == '"');
+  if(isQuoted)
+    ++_current;
+  return _current;
+}
+
+void JsonReader::numberEnd(const char* end, bool isQuoted)
+{
+  if(end == _current)
+    error("expected a number");
+  _current = end;
+  if(isQuoted)
+    expect('"');
+}
+
+double JsonReader::readDouble()
+{
+  bool isQuoted;
+  const char* begin = numberBegin(isQuoted);
+  char* end;
+  // the document is terminated by a null character or a quote, strtod cannot read after the end
+  const double value = std::strtod(begin, &end);
+  numberEnd(end, isQuoted);
+  return value;
+}
+
+unsigned long long JsonReader::readUnsigned()
+{
+  bool isQuoted;
+  const char* begin = numberBegin(isQuoted);
+  if(*begin == '-')
+    error("expected an unsigned integer");
+  char* end;
+  const unsigned long long value = std::strtoull(begin, &end, 10);
+  numberEnd(end, isQuoted);
+  return value;
+}
+
+bool JsonReader::readBool()
+{
+  const std::string str = readString();
+  if(str == "1" || str == "true")
+    return true;
+  if(str == "0" || str == "false")
+    return false;
+  error("expected a boolean");
+}
+
+void JsonReader::readDoubleArray(double* values, std::size_t size)
+{
+  std::size_t i = 0;
+  if(beginArray())
+  {
+    while(nextElement())
+    {
+      if(i >= size)
+        error("too many values in the array");
+      values[i++] = readDouble();
+    }
+  }
+  if(i != size)
+    error("not enough values in the array");
+}
+
+bpt::ptree JsonReader::readTree()
+{
+  bpt::ptree tree;
+  std::string key;
+
+  switch(peek())
+  {
+    case '{':
+      beginObject();
+      while(nextKey(key))
+        tree.push_back(std::make_pair(key, readTree()));
+      break;
+    case '[':
+      beginArray();
+      while(nextElement())
+        tree.push_back(std::make_pair(std::string(), readTree()));
+      break;
+    default:
+      tree.data() = readString();
+  }
+  return tree;
+}
+
+void JsonReader::skipValue()
+{
+  const char first = peek();
+
+  if(first != '{' && first != '[')
+  {
+    if(first == '"')
+    {
+      // skip the string without decoding it
+      ++_current;
+      while(_current != _end && *_current != '"')
+      {
+        // skip the escaped character, if any
+        if(*_current == '\\' && ++_current == _end)
+          break;
+        ++_current;
+      }
+      if(_current == _end)
+        error("unterminated string");
+      ++_current;
+    }
+    else
+    {
+      readLiteral();
+    }
+    return;
+  }
+
+  // skip the container, the syntax is only checked for the strings and the brackets
+  std::vector<char> closingChars;
+  while(true)
+  {
+    const char c = peek();
+    if(c == 0)
+      error("unexpected end of document");
+    if(c == '"')
+    {
+      skipValue();
+      continue;
+    }
+    ++_current;
+    if(c == '{' || c == '[')
+    {
+      closingChars.push_back(c == '{' ? '}' : ']');
+    }
+    else if(c == '}' || c == ']')
+    {
+      if(closingChars.empty() || closingChars.back() != c)
+        error(std::string("unexpected '") + c + "'");
+      closingChars.pop_back();
+      if(closingChars.empty())
+        return;
+    }
+  }
+}
+
+} // namespace sfmDataIO
+} // namespace aliceVision
@@ -0,0 +1,219 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2020 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#pragma once
+
+#include <boost/property_tree/ptree.hpp>
+
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace aliceVision {
+namespace sfmDataIO {
+
+namespace bpt = boost::property_tree;
+
+/**
+ * @brief Streaming JSON writer.
+ *
+ * The output has the same layout as boost::property_tree::write_json
+ * (4 spaces indentation, all the values are written as strings),
+ * without building the whole document in memory.
+ *
+ * Usage:
+ * @code{.cpp}
+ *  JsonWriter writer(stream);
+ *  writer.beginObject();
+ *  writer.beginArray("values");
+ *  writer.value("", 1.0);
+ *  writer.endArray();
+ *  writer.endObject();
+ * @endcode
+ */
+class JsonWriter
+{
+public:
+  /**
+   * @brief JsonWriter constructor
+   * @param[in] stream The output stream
+   */
+  explicit JsonWriter(std::ostream& stream);
+
+  /**
+   * @brief Create a writer of array elements at the given depth,
+   *        to format elements in a separate stream and append them with appendElements.
+   * @param[in] stream The output stream
+   * @param[in] depth The depth of the array in the document
+   */
+  JsonWriter(std::ostream& stream, std::size_t depth);
+
+  /// Begin an object ( key is ignored in arrays )
+  void beginObject(const std::string& key = "");
+
+  /// End the current object
+  void endObject();
+
+  /// Begin an array ( key is ignored in arrays )
+  void beginArray(const std::string& key = "");
+
+  /// End the current array
+  void endArray();
+
+  /// Write a string value ( key is ignored in arrays )
+  void value(const std::string& key, const std::string& value);
+
+  /// Write a string value ( key is ignored in arrays )
+  void value(const std::string& key, const char* value) { this->value(key, std::string(value)); }
+
+  /// Write a floating point value, formatted as a string
+  void value(const std::string& key, double value);
+
+  /// Write an integer value, formatted as a string
+  void value(const std::string& key, long long value);
+
+  /// Write an unsigned integer value, formatted as a string
+  void value(const std::string& key, unsigned long long value);
+
+  /// Write an integer value, formatted as a string
+  void value(const std::string& key, int value) { this->value(key, static_cast<long long>(value)); }
+
+  /// Write an unsigned integer value, formatted as a string
+  void value(const std::string& key, unsigned int value) { this->value(key, static_cast<unsigned long long>(value)); }
+
+  /// Write an unsigned integer value, formatted as a string
+  void value(const std::string& key, unsigned long value) { this->value(key, static_cast<unsigned long long>(value)); }
+
+  /**
+   * @brief Write a boost property tree as boost::property_tree::write_json does
+   * @param[in] key The node name ( ignored in arrays )
+   * @param[in] tree The property tree
+   */
+  void tree(const std::string& key, const bpt::ptree& tree);
+
+  /**
+   * @brief Append array elements formatted by a writer created with the depth of the current array
+   * @param[in] elements The formatted elements
+   * @param[in] nbElements The number of elements
+   */
+  void appendElements(const std::string& elements, std::size_t nbElements);
+
+  /// Return the current depth in the document
+  std::size_t depth() const { return _levels.size(); }
+
+private:
+  /// Write the separator, the indentation and the key of a new element
+  void beginElement(const std::string& key);
+
+  /// Write the indentation and the closing character of a container
+  void endContainer(char closingChar);
+
+  struct Level
+  {
+    bool isArray;
+    std::size_t nbElements;
+  };
+
+  std::ostream& _stream;
+  std::vector<Level> _levels;
+};
+
+/**
+ * @brief Streaming (pull) JSON reader over an in-memory buffer.
+ *
+ * The document is read sequentially, without building a tree.
+ * Values written as strings or as JSON numbers/booleans are both accepted,
+ * and an empty string is accepted as an empty container (boost::property_tree::write_json output).
+ * Syntax errors throw a std::runtime_error with the position in the document.
+ */
+class JsonReader
+{
+public:
+  /**
+   * @brief JsonReader constructor
+   * @param[in] begin The first character of the document
+   * @param[in] end The end of the document, it must point to a null character (e.g. std::string::c_str())
+   */
+  JsonReader(const char* begin, const char* end);
+
+  /**
+   * @brief Begin to read an object
+   * @return false if the value is an empty string ( nothing to read )
+   */
+  bool beginObject();
+
+  /**
+   * @brief Read the key of the next member of the current object
+   * @param[out] key The key
+   * @return false at the end of the object
+   */
+  bool nextKey(std::string& key);
+
+  /**
+   * @brief Begin to read an array
+   * @return false if the value is an empty string ( nothing to read )
+   */
+  bool beginArray();
+
+  /**
+   * @brief Move to the next element of the current array
+   * @return false at the end of the array
+   */
+  bool nextElement();
+
+  /// Read a string ( or the text of a number, boolean or null )
+  std::string readString();
+
+  /// Read a floating point value
+  double readDouble();
+
+  /// Read an unsigned integer value
+  unsigned long long readUnsigned();
+
+  /// Read a boolean value ( true/false or 1/0 )
+  bool readBool();
+
+  /**
+   * @brief Read an array of floating point values
+   * @param[out] values The output values
+   * @param[in] size The expected number of values
+   */
+  void readDoubleArray(double* values, std::size_t size);
+
+  /// Read the current value in a boost property tree, as boost::property_tree::read_json does
+  bpt::ptree readTree();
+
+  /// Skip the current value
+  void skipValue();
+
+  /// Throw a std::runtime_error with the current position in the document
+  [[noreturn]] void error(const std::string& message) const;
+
+private:
+  /// Skip the white spaces and return the next character ( 0 at the end of the document )
+  char peek();
+
+  /// Consume the expected character
+  void expect(char c);
+
+  /// Read the text of a value that is not a string ( number, true, false, null )
+  std::string readLiteral();
+
+  /// Read a number written as a string or as a JSON number, without a copy
+  const char* numberBegin(bool& isQuoted);
+
+  /// Check the end of a number and consume its closing quote
+  void numberEnd(const char* end, bool isQuoted);
+
+  const char* const _begin;
+  const char* const _end;
+  const char* _current;
+  /// for each open container, true if an element has already been read
+  std::vector<bool> _hasElements;
+};
+
+} // namespace sfmDataIO
+} // namespace aliceVision
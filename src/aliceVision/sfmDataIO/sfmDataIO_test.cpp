@@ -8,9 +8,15 @@
 #include <aliceVision/system/Timer.hpp>
 #include <aliceVision/sfmData/SfMData.hpp>
 #include <aliceVision/sfmDataIO/sfmDataIO.hpp>
+#include <aliceVision/sfmDataIO/jsonIO.hpp>
+#include <aliceVision/sfmDataIO/binaryIO.hpp>
 
 #include <boost/filesystem.hpp>
+#include <boost/property_tree/json_parser.hpp>
 
+#include <cstdint>
+#include <fstream>
+#include <limits>
 #include <sstream>
 
 #define BOOST_TEST_MODULE sfmDataIO
@@ -77,7 +83,7 @@ sfmData::SfMData createTestScene(std::size_t viewsCount = 2, std::size_t observa
 
 BOOST_AUTO_TEST_CASE(SfMData_IO_SAVE_LOAD_JSON) {
 
-  const std::vector<std::string> ext_Type = {"sfm","json"};
+  const std::vector<std::string> ext_Type = {"sfm","json","sfmb","sfmbz"};
 
   for(int i = 0; i < ext_Type.size(); ++i)
   {
@@ -178,6 +184,295 @@ BOOST_AUTO_TEST_CASE(SfMData_IO_SAVE_LOAD_JSON) {
   }
 }
 
+BOOST_AUTO_TEST_CASE(SfMData_IO_JSON_SameAsPropertyTree) {
+
+  const std::string filename = "SAVE_STREAM.sfm";
+  const std::string propertyTreeFilename = "SAVE_PROPERTY_TREE.sfm";
+
+  sfmData::SfMData sfmData = createTestScene(4, 3, false);
+  sfmData.getViews().at(0)->addMetadata("Make", "\"Quoted\" / back\\slash \t tab \xc3\xa9");
+  sfmData.structure[1].X = Vec3(0.1, -2.5e-12, 1e20);
+  sfmData.structure[1].descType = feature::EImageDescriberType::SIFT;
+  sfmData.control_points[0] = sfmData.structure[0];
+
+  BOOST_CHECK( Save(sfmData, filename, ALL) );
+
+  // same document created with a boost property tree
+  {
+    bpt::ptree fileTree;
+    saveMatrix("version", Vec3(1, 0, 0), fileTree);
+
+    bpt::ptree viewsTree;
+    for(const auto& viewPair : sfmData.getViews())
+      saveView("", *(viewPair.second), viewsTree);
+    fileTree.add_child("views", viewsTree);
+
+    bpt::ptree intrinsicsTree;
+    for(const auto& intrinsicPair : sfmData.getIntrinsics())
+      saveIntrinsic("", intrinsicPair.first, intrinsicPair.second, intrinsicsTree);
+    fileTree.add_child("intrinsics", intrinsicsTree);
+
+    bpt::ptree posesTree;
+    for(const auto& posePair : sfmData.getPoses())
+    {
+      bpt::ptree poseTree;
+      poseTree.put("poseId", posePair.first);
+      saveCameraPose("pose", posePair.second, poseTree);
+      posesTree.push_back(std::make_pair("", poseTree));
+    }
+    fileTree.add_child("poses", posesTree);
+
+    bpt::ptree structureTree;
+    for(const auto& landmarkPair : sfmData.getLandmarks())
+      saveLandmark("", landmarkPair.first, landmarkPair.second, structureTree);
+    fileTree.add_child("structure", structureTree);
+
+    bpt::ptree controlPointsTree;
+    for(const auto& landmarkPair : sfmData.getControlPoints())
+      saveLandmark("", landmarkPair.first, landmarkPair.second, controlPointsTree);
+    fileTree.add_child("controlPoints", controlPointsTree);
+
+    bpt::write_json(propertyTreeFilename, fileTree);
+  }
+
+  const auto readFile = [](const std::string& path)
+  {
+    std::ifstream stream(path);
+    return std::string(std::istreambuf_iterator<char>(stream), std::istreambuf_iterator<char>());
+  };
+
+  BOOST_CHECK( readFile(filename) == readFile(propertyTreeFilename) );
+
+  // files written with a boost property tree are loaded
+  sfmData::SfMData sfmDataLoad;
+  BOOST_CHECK( Load(sfmDataLoad, propertyTreeFilename, ALL) );
+  BOOST_CHECK_EQUAL( sfmDataLoad.getViews().at(0)->getMetadata().at("Make"), sfmData.getViews().at(0)->getMetadata().at("Make") );
+  BOOST_CHECK( sfmDataLoad.getLandmarks() == sfmData.getLandmarks() );
+  BOOST_CHECK( sfmDataLoad.getControlPoints() == sfmData.getControlPoints() );
+}
+
+BOOST_AUTO_TEST_CASE(SfMData_IO_JSON_Observations) {
+
+  const std::string filename = "SAVE_LOAD_OBSERVATIONS.sfm";
+
+  // more landmarks than a formatting chunk
+  sfmData::SfMData sfmData = createTestScene(3, 3, true);
+  for(IndexT landmarkId = 1; landmarkId < 2500; ++landmarkId)
+  {
+    sfmData::Landmark& landmark = sfmData.structure[landmarkId];
+    landmark.X = Vec3(landmarkId, 0.5 * landmarkId, 1.0 / landmarkId);
+    landmark.rgb = image::RGBColor(landmarkId % 256, 0, 255);
+    landmark.descType = feature::EImageDescriberType::SIFT;
+    for(IndexT viewId = 0; viewId < 3; ++viewId)
+      landmark.observations[viewId] = sfmData::Observation(Vec2(0.1 * landmarkId, viewId), landmarkId + viewId, 1.5);
+  }
+
+  BOOST_CHECK( Save(sfmData, filename, ALL) );
+
+  // observations with features
+  {
+    sfmData::SfMData sfmDataLoad;
+    BOOST_CHECK( Load(sfmDataLoad, filename, ALL) );
+    BOOST_CHECK_EQUAL( sfmDataLoad.structure.size(), sfmData.structure.size() );
+    BOOST_CHECK( sfmDataLoad.getLandmarks() == sfmData.getLandmarks() );
+    BOOST_CHECK_EQUAL( sfmDataLoad.structure.at(42).observations.at(2).scale, 1.5 );
+  }
+
+  // observations without features
+  {
+    sfmData::SfMData sfmDataLoad;
+    BOOST_CHECK( Load(sfmDataLoad, filename, ESfMData(STRUCTURE | OBSERVATIONS)) );
+    BOOST_CHECK_EQUAL( sfmDataLoad.structure.size(), sfmData.structure.size() );
+    BOOST_CHECK_EQUAL( sfmDataLoad.structure.at(42).observations.size(), 3 );
+    BOOST_CHECK_EQUAL( sfmDataLoad.structure.at(42).observations.at(2).id_feat, UndefinedIndexT );
+    BOOST_CHECK_EQUAL( sfmDataLoad.structure.at(42).X, sfmData.structure.at(42).X );
+  }
+
+  // structure without observations
+  {
+    sfmData::SfMData sfmDataLoad;
+    BOOST_CHECK( Load(sfmDataLoad, filename, STRUCTURE) );
+    BOOST_CHECK_EQUAL( sfmDataLoad.structure.size(), sfmData.structure.size() );
+    BOOST_CHECK( sfmDataLoad.structure.at(42).observations.empty() );
+  }
+}
+
+BOOST_AUTO_TEST_CASE(SfMData_IO_Binary) {
+
+  const std::string filename = "SAVE_LOAD_BINARY.sfmb";
+
+  sfmData::SfMData sfmData = createTestScene(4, 3, false);
+  sfmData.addFeaturesFolder("features");
+  sfmData.addMatchesFolders({"matches0", "matches1"});
+  sfmData.getViews().at(0)->addMetadata("Make", "Camera");
+  sfmData.getViews().at(0)->addMetadata("Exif:FocalLength", "35");
+  sfmData.getViews().at(1)->setResectionId(2);
+  sfmData.intrinsics[2] = std::make_shared<PinholeRadialK3>(4000, 3000, 3500.0, 2000.0, 1500.0, 0.01, -0.001, 0.0001);
+  sfmData.intrinsics[2]->lock();
+  sfmData.getPoses().at(1).lock();
+
+  // rig with 2 sub-poses, observed by the 2 last views
+  {
+    sfmData::Rig rig(2);
+    sfmData::RigSubPose subPose;
+    subPose.status = sfmData::ERigSubPoseStatus::CONSTANT;
+    subPose.pose = Pose3(RotationAroundY(0.5), Vec3(1, 2, 3));
+    rig.setSubPose(1, subPose);
+    sfmData.getRigs().emplace(0, rig);
+
+    for(IndexT viewId = 2; viewId < 4; ++viewId)
+    {
+      sfmData::View& view = *sfmData.getViews().at(viewId);
+      view.setRigAndSubPoseId(0, viewId - 2);
+      view.setFrameId(7);
+      view.setIndependantPose(false);
+    }
+  }
+
+  for(IndexT landmarkId = 1; landmarkId < 100; ++landmarkId)
+  {
+    sfmData::Landmark& landmark = sfmData.structure[landmarkId];
+    landmark.X = Vec3(landmarkId, 0.5 * landmarkId, 1.0 / landmarkId);
+    landmark.rgb = image::RGBColor(landmarkId % 256, 0, 255);
+    landmark.descType = feature::EImageDescriberType::SIFT;
+    for(IndexT viewId = 0; viewId < 3; ++viewId)
+      landmark.observations[viewId] = sfmData::Observation(Vec2(0.1 * landmarkId, viewId), landmarkId + viewId, 1.5);
+  }
+  sfmData.control_points[0] = sfmData.structure[42];
+
+  BOOST_CHECK( Save(sfmData, filename, ALL) );
+
+  // complete round trip
+  {
+    sfmData::SfMData sfmDataLoad;
+    BOOST_CHECK( Load(sfmDataLoad, filename, ALL) );
+    BOOST_CHECK( sfmDataLoad == sfmData );
+    BOOST_CHECK( sfmDataLoad.getRelativeFeaturesFolders() == sfmData.getRelativeFeaturesFolders() );
+    BOOST_CHECK( sfmDataLoad.getRelativeMatchesFolders() == sfmData.getRelativeMatchesFolders() );
+    BOOST_CHECK_EQUAL( sfmDataLoad.getViews().at(0)->getMetadata().at("Make"), "Camera" );
+    BOOST_CHECK( sfmDataLoad.getIntrinsics().at(2)->isLocked() );
+    BOOST_CHECK( sfmDataLoad.getPoses().at(1).isLocked() );
+  }
+
+  // same content as the JSON file
+  {
+    const std::string jsonFilename = "SAVE_LOAD_BINARY.sfm";
+    BOOST_CHECK( Save(sfmData, jsonFilename, ALL) );
+    sfmData::SfMData sfmDataJson;
+    sfmData::SfMData sfmDataBinary;
+    BOOST_CHECK( Load(sfmDataJson, jsonFilename, ALL) );
+    BOOST_CHECK( Load(sfmDataBinary, filename, ALL) );
+    // the JSON loader does not restore the pose lock
+    sfmDataBinary.getPoses().at(1).unlock();
+    BOOST_CHECK( sfmDataJson == sfmDataBinary );
+  }
+
+  // only the requested sections
+  {
+    sfmData::SfMData sfmDataLoad;
+    BOOST_CHECK( Load(sfmDataLoad, filename, ESfMData(STRUCTURE | OBSERVATIONS)) );
+    BOOST_CHECK( sfmDataLoad.getViews().empty() );
+    BOOST_CHECK( sfmDataLoad.getPoses().empty() );
+    BOOST_CHECK( sfmDataLoad.getRigs().empty() );
+    BOOST_CHECK( sfmDataLoad.getControlPoints().empty() );
+    BOOST_CHECK_EQUAL( sfmDataLoad.structure.size(), sfmData.structure.size() );
+    BOOST_CHECK_EQUAL( sfmDataLoad.structure.at(42).observations.size(), 3 );
+    BOOST_CHECK_EQUAL( sfmDataLoad.structure.at(42).observations.at(2).id_feat, UndefinedIndexT );
+    BOOST_CHECK_EQUAL( sfmDataLoad.structure.at(42).X, sfmData.structure.at(42).X );
+  }
+
+  {
+    sfmData::SfMData sfmDataLoad;
+    BOOST_CHECK( Load(sfmDataLoad, filename, ESfMData(EXTRINSICS | CONTROL_POINTS)) );
+    BOOST_CHECK( sfmDataLoad.getLandmarks().empty() );
+    BOOST_CHECK( sfmDataLoad.getRigs() == sfmData.getRigs() );
+    BOOST_CHECK( sfmDataLoad.getPoses() == sfmData.getPoses() );
+    BOOST_CHECK( sfmDataLoad.getControlPoints() == sfmData.getControlPoints() );
+  }
+
+  // structure saved without observations
+  {
+    const std::string structureFilename = "SAVE_LOAD_BINARY_STRUCTURE.sfmb";
+    BOOST_CHECK( Save(sfmData, structureFilename, ESfMData(VIEWS | STRUCTURE)) );
+    sfmData::SfMData sfmDataLoad;
+    BOOST_CHECK( Load(sfmDataLoad, structureFilename, ESfMData(VIEWS | STRUCTURE | OBSERVATIONS)) );
+    BOOST_CHECK_EQUAL( sfmDataLoad.getViews().size(), sfmData.getViews().size() );
+    BOOST_CHECK( sfmDataLoad.getIntrinsics().empty() );
+    BOOST_CHECK_EQUAL( sfmDataLoad.structure.size(), sfmData.structure.size() );
+    BOOST_CHECK( sfmDataLoad.structure.at(42).observations.empty() );
+  }
+
+  // compressed sections
+  {
+    const std::string compressedFilename = "SAVE_LOAD_BINARY_COMPRESSED.sfmbz";
+    BOOST_CHECK( Save(sfmData, compressedFilename, ALL) );
+    sfmData::SfMData sfmDataLoad;
+    BOOST_CHECK( Load(sfmDataLoad, compressedFilename, ALL) );
+    BOOST_CHECK( sfmDataLoad == sfmData );
+  }
+
+  // not a binary SfMData file
+  {
+    sfmData::SfMData sfmDataLoad;
+    std::ofstream("INVALID.sfmb") << "not a binary SfMData file";
+    BOOST_CHECK( !Load(sfmDataLoad, "INVALID.sfmb", ALL) );
+  }
+}
+
+/// Overwrite a value in a binary file
+template <typename T>
+void writeAt(const std::string& filename, std::streamoff offset, const T& value)
+{
+  std::fstream stream(filename, std::ios::binary | std::ios::in | std::ios::out);
+  stream.seekp(offset);
+  stream.write(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+/// Read an uint64 value in a binary file
+std::uint64_t readAt(const std::string& filename, std::streamoff offset)
+{
+  std::uint64_t value = 0;
+  std::ifstream stream(filename, std::ios::binary);
+  stream.seekg(offset);
+  stream.read(reinterpret_cast<char*>(&value), sizeof(value));
+  return value;
+}
+
+BOOST_AUTO_TEST_CASE(SfMData_IO_Binary_Corrupted) {
+
+  const sfmData::SfMData sfmData = createTestScene(4, 3, false);
+
+  // the first entry of the section table (after the 24 bytes header) is the folders section:
+  // type ( uint32 ), compression ( uint32 ), offset ( uint64 ), stored size ( uint64 ), size ( uint64 )
+
+  // number of folders larger than the section
+  {
+    const std::string filename = "CORRUPTED_COUNT.sfmb";
+    BOOST_CHECK( Save(sfmData, filename, ALL) );
+    writeAt(filename, readAt(filename, 32), std::numeric_limits<std::uint32_t>::max());
+    sfmData::SfMData sfmDataLoad;
+    BOOST_CHECK( !Load(sfmDataLoad, filename, ALL) );
+  }
+
+  // decompressed size larger than the deflate format allows
+  {
+    const std::string filename = "CORRUPTED_SIZE.sfmbz";
+    BOOST_CHECK( Save(sfmData, filename, ALL) );
+    writeAt(filename, 48, std::numeric_limits<std::uint64_t>::max());
+    sfmData::SfMData sfmDataLoad;
+    BOOST_CHECK( !Load(sfmDataLoad, filename, ALL) );
+  }
+
+  // uncompressed section with a different decompressed size
+  {
+    const std::string filename = "CORRUPTED_SIZE.sfmb";
+    BOOST_CHECK( Save(sfmData, filename, ALL) );
+    writeAt(filename, 48, readAt(filename, 40) + 1);
+    sfmData::SfMData sfmDataLoad;
+    BOOST_CHECK( !Load(sfmDataLoad, filename, ALL) );
+  }
+}
+
 /*
 BOOST_AUTO_TEST_CASE(SfMData_IO_BigFile) {
   const int nbViews = 1000;
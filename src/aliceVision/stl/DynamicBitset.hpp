@@ -75,6 +75,7 @@ namespace stl
     }
 
     const BlockType * data() const { return &vec_bits[0]; }
+    BlockType * data() { return &vec_bits[0]; }
 
   private:
     inline size_t calc_num_blocks(size_t num_bits)
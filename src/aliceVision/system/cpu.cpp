@@ -164,3 +164,164 @@ int get_total_cpus(void)
 
 #endif /* GET_TOTAL_CPUS_DEFINED */
 
+
+
+/* get_cache_size() system specific code: uses OS routines to determine the data cache sizes */
+#ifdef __WINDOWS__
+#include <windows.h>
+#include <vector>
+namespace aliceVision {
+namespace system {
+
+long get_cache_size(int level)
+{
+	DWORD size = 0;
+	GetLogicalProcessorInformation(NULL, &size);
+	if (size == 0) return -1;
+
+	std::vector<SYSTEM_LOGICAL_PROCESSOR_INFORMATION> infos(size / sizeof(SYSTEM_LOGICAL_PROCESSOR_INFORMATION));
+	if (!GetLogicalProcessorInformation(infos.data(), &size)) return -1;
+
+	for (const SYSTEM_LOGICAL_PROCESSOR_INFORMATION& info : infos) {
+		if (info.Relationship == RelationCache && info.Cache.Level == level &&
+		    (info.Cache.Type == CacheData || info.Cache.Type == CacheUnified))
+			return (long)info.Cache.Size;
+	}
+	return -1;
+}
+}}
+#define GET_CACHE_SIZE_DEFINED
+#endif
+
+#ifdef __APPLE__
+#include <sys/types.h>
+#include <sys/sysctl.h>
+namespace aliceVision {
+namespace system {
+
+long get_cache_size(int level)
+{
+	const char* name = (level == 1) ? "hw.l1dcachesize" : (level == 2) ? "hw.l2cachesize" : (level == 3) ? "hw.l3cachesize" : NULL;
+	if (!name) return -1;
+	long long result = 0;
+	size_t size = sizeof(result);
+	if (sysctlbyname(name, &result, &size, NULL, 0) || result <= 0)
+		return -1;
+	return (long)result;
+}
+}}
+#define GET_CACHE_SIZE_DEFINED
+#endif
+
+#if defined(_SC_LEVEL1_DCACHE_SIZE) && !defined(GET_CACHE_SIZE_DEFINED)
+namespace aliceVision {
+namespace system {
+
+long get_cache_size(int level)
+{
+	long result = -1;
+	switch (level) {
+		case 1: result = sysconf(_SC_LEVEL1_DCACHE_SIZE); break;
+		case 2: result = sysconf(_SC_LEVEL2_CACHE_SIZE); break;
+		case 3: result = sysconf(_SC_LEVEL3_CACHE_SIZE); break;
+		default: break;
+	}
+	return (result > 0) ? result : -1;
+}
+}}
+#define GET_CACHE_SIZE_DEFINED
+#endif
+
+#ifndef GET_CACHE_SIZE_DEFINED
+namespace aliceVision {
+namespace system {
+
+long get_cache_size(int level)
+{
+	return -1;
+}
+}}
+
+#endif /* GET_CACHE_SIZE_DEFINED */
+
+
+/* get_cpu_features() x86 specific code: uses cpuid and xgetbv to check the CPU and OS support */
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+#ifdef _MSC_VER
+#include <intrin.h>
+#include <immintrin.h>
+#else
+#include <cpuid.h>
+#endif
+namespace aliceVision {
+namespace system {
+
+static void cpuid(unsigned int leaf, unsigned int subleaf, unsigned int regs[4])
+{
+#ifdef _MSC_VER
+	int r[4];
+	__cpuidex(r, (int)leaf, (int)subleaf);
+	for (int i = 0; i < 4; ++i) regs[i] = (unsigned int)r[i];
+#else
+	__cpuid_count(leaf, subleaf, regs[0], regs[1], regs[2], regs[3]);
+#endif
+}
+
+static unsigned long long xgetbv0()
+{
+#ifdef _MSC_VER
+	return _xgetbv(0);
+#else
+	unsigned int eax, edx;
+	__asm__ volatile("xgetbv" : "=a"(eax), "=d"(edx) : "c"(0));
+	return ((unsigned long long)edx << 32) | eax;
+#endif
+}
+
+static CpuFeatures detect_cpu_features()
+{
+	CpuFeatures features;
+	unsigned int regs[4] = {0, 0, 0, 0};
+
+	cpuid(0, 0, regs);
+	const unsigned int maxLeaf = regs[0];
+	if (maxLeaf < 1) return features;
+
+	cpuid(1, 0, regs);
+	features.popcnt = (regs[2] & (1u << 23)) != 0;
+	const bool osxsave = (regs[2] & (1u << 27)) != 0;
+	const bool fma = (regs[2] & (1u << 12)) != 0;
+	if (!osxsave || maxLeaf < 7) return features;
+
+	// the OS must save the AVX (YMM) and AVX-512 (opmask, ZMM) states on context switch
+	const unsigned long long xcr0 = xgetbv0();
+	const bool osAvx = (xcr0 & 0x6) == 0x6;
+	const bool osAvx512 = (xcr0 & 0xe6) == 0xe6;
+
+	cpuid(7, 0, regs);
+	features.avx2 = osAvx && (regs[1] & (1u << 5)) != 0;
+	features.fma = osAvx && fma;
+	features.avx512f = osAvx512 && (regs[1] & (1u << 16)) != 0;
+	features.avx512bw = features.avx512f && (regs[1] & (1u << 30)) != 0;
+	features.avx512vnni = features.avx512f && (regs[2] & (1u << 11)) != 0;
+	features.avx512vpopcntdq = features.avx512f && (regs[2] & (1u << 14)) != 0;
+	return features;
+}
+
+const CpuFeatures& get_cpu_features()
+{
+	static const CpuFeatures features = detect_cpu_features();
+	return features;
+}
+}}
+#else
+namespace aliceVision {
+namespace system {
+
+const CpuFeatures& get_cpu_features()
+{
+	static const CpuFeatures features;
+	return features;
+}
+}}
+#endif /* x86 */
@@ -22,6 +22,33 @@ int cpu_clock_by_os();
  */
 int get_total_cpus();
 
+/**
+ * @brief Returns the size (in bytes) of the given CPU data cache level, as reported by the OS.
+ * @param[in] level The cache level (1, 2 or 3)
+ * @return the cache size or -1 if not available.
+ */
+long get_cache_size(int level);
+
+/**
+ * @brief Instruction set extensions supported by both the CPU and the OS.
+ */
+struct CpuFeatures
+{
+  bool popcnt = false;
+  bool avx2 = false;
+  bool fma = false;
+  bool avx512f = false;
+  bool avx512bw = false;
+  bool avx512vnni = false;
+  bool avx512vpopcntdq = false;
+};
+
+/**
+ * @brief Returns the instruction set extensions available at runtime.
+ *        Detection is performed once with cpuid/xgetbv, all flags are false on non-x86 platforms.
+ */
+const CpuFeatures& get_cpu_features();
+
 }
 }
 
@@ -0,0 +1,28 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2020 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include "CompactTracks.hpp"
+
+namespace aliceVision {
+namespace track {
+
+void CompactTracks::exportToSTL(TracksMap& tracks) const
+{
+  tracks.clear();
+  tracks.reserve(nbTracks());
+
+  for(std::size_t trackId = 0; trackId < nbTracks(); ++trackId)
+  {
+    Track& outTrack = tracks[trackId];
+    outTrack.descType = descTypes[trackId];
+    outTrack.featPerView.reserve(trackLength(trackId));
+    for(std::size_t o = trackOffsets[trackId]; o < trackOffsets[trackId + 1]; ++o)
+      outTrack.featPerView[viewIds[o]] = featIndices[o];
+  }
+}
+
+} // namespace track
+} // namespace aliceVision
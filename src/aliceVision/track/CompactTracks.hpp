@@ -0,0 +1,60 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2020 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#pragma once
+
+#include <aliceVision/types.hpp>
+#include <aliceVision/track/Track.hpp>
+
+#include <cstdint>
+#include <vector>
+
+namespace aliceVision {
+namespace track {
+
+/**
+ * @brief Tracks stored in flat arrays (CSR layout).
+ *
+ * The observations of the track i are in [trackOffsets[i], trackOffsets[i+1])
+ * of viewIds/featIndices, sorted by view id.
+ */
+struct CompactTracks
+{
+  /// Start of the observations of each track, size is nbTracks + 1
+  std::vector<std::size_t> trackOffsets = {0};
+  /// Describer type of each track
+  std::vector<feature::EImageDescriberType> descTypes;
+  /// View id of each observation
+  std::vector<IndexT> viewIds;
+  /// Feature index of each observation
+  std::vector<IndexT> featIndices;
+
+  std::size_t nbTracks() const { return descTypes.size(); }
+
+  std::size_t nbObservations() const { return viewIds.size(); }
+
+  std::size_t trackLength(std::size_t trackId) const
+  {
+    return trackOffsets[trackId + 1] - trackOffsets[trackId];
+  }
+
+  void clear()
+  {
+    trackOffsets.assign(1, 0);
+    descTypes.clear();
+    viewIds.clear();
+    featIndices.clear();
+  }
+
+  /**
+   * @brief Convert to the TracksMap structure, track ids are the indices in the compact tracks.
+   * @param[out] tracks the output tracks
+   */
+  void exportToSTL(TracksMap& tracks) const;
+};
+
+} // namespace track
+} // namespace aliceVision
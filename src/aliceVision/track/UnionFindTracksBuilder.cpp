@@ -0,0 +1,278 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2020 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include "UnionFindTracksBuilder.hpp"
+
+#include <atomic>
+#include <limits>
+#include <map>
+#include <stdexcept>
+#include <string>
+
+namespace aliceVision {
+namespace track {
+
+namespace {
+
+using NodeId = uint32_t;
+
+/// Maximum number of nodes, the largest NodeId is reserved to mark the features without track
+constexpr std::size_t MAX_NB_NODES = std::numeric_limits<NodeId>::max();
+
+/// Matches of an image pair for one describer type, with the dense id offsets of both views
+struct MatchesBlock
+{
+  IndexT I;
+  IndexT J;
+  feature::EImageDescriberType descType;
+  const IndMatches* matches;
+  IndexT maxI = 0;
+  IndexT maxJ = 0;
+  NodeId offsetI = 0;
+  NodeId offsetJ = 0;
+};
+
+/// Range of dense ids of the features of a view for one describer type
+struct FeaturesRange
+{
+  IndexT viewId;
+  feature::EImageDescriberType descType;
+  NodeId offset;
+  NodeId size;
+};
+
+/**
+ * @brief Lock-free union-find where each parent has a smaller id than its child,
+ *        so the root of each set is its smallest id.
+ */
+class ConcurrentUnionFind
+{
+public:
+  explicit ConcurrentUnionFind(std::size_t size)
+  {
+    // the node ids would wrap
+    if(size > MAX_NB_NODES)
+      throw std::length_error("Too many nodes in the union-find: " + std::to_string(size));
+    _parent = std::vector<std::atomic<NodeId>>(size);
+    for(std::size_t i = 0; i < size; ++i)
+      _parent[i].store(static_cast<NodeId>(i), std::memory_order_relaxed);
+  }
+
+  NodeId find(NodeId x)
+  {
+    while(true)
+    {
+      NodeId p = _parent[x].load(std::memory_order_relaxed);
+      if(p == x)
+        return x;
+      const NodeId gp = _parent[p].load(std::memory_order_relaxed);
+      // path halving, the parent can only decrease
+      if(p != gp)
+        _parent[x].compare_exchange_weak(p, gp, std::memory_order_relaxed);
+      x = gp;
+    }
+  }
+
+  void join(NodeId a, NodeId b)
+  {
+    while(true)
+    {
+      a = find(a);
+      b = find(b);
+      if(a == b)
+        return;
+      if(a < b)
+        std::swap(a, b);
+      // link the largest root under the smallest one, retry if the root has changed meanwhile
+      NodeId expected = a;
+      if(_parent[a].compare_exchange_strong(expected, b, std::memory_order_relaxed))
+        return;
+    }
+  }
+
+  std::size_t size() const { return _parent.size(); }
+
+private:
+  std::vector<std::atomic<NodeId>> _parent;
+};
+
+} // namespace
+
+void UnionFindTracksBuilder::build(const PairwiseMatches& pairwiseMatches, bool multithreaded)
+{
+  _tracks.clear();
+
+  std::vector<MatchesBlock> blocks;
+  for(const auto& matchesPerDescIt : pairwiseMatches)
+  {
+    for(const auto& matchesIt : matchesPerDescIt.second)
+    {
+      if(matchesIt.second.empty())
+        continue;
+      MatchesBlock block;
+      block.I = matchesPerDescIt.first.first;
+      block.J = matchesPerDescIt.first.second;
+      block.descType = matchesIt.first;
+      block.matches = &matchesIt.second;
+      blocks.push_back(block);
+    }
+  }
+
+  // largest feature index referenced in each view
+  #pragma omp parallel for schedule(dynamic) if(multithreaded)
+  for(int b = 0; b < static_cast<int>(blocks.size()); ++b)
+  {
+    MatchesBlock& block = blocks[b];
+    for(const IndMatch& m : *block.matches)
+    {
+      block.maxI = std::max(block.maxI, m._i);
+      block.maxJ = std::max(block.maxJ, m._j);
+    }
+  }
+
+  // dense ids ordered by (viewId, descType, featIndex)
+  using ViewDescKey = std::pair<IndexT, feature::EImageDescriberType>;
+  std::map<ViewDescKey, IndexT> maxFeatPerView;
+  for(const MatchesBlock& block : blocks)
+  {
+    IndexT& maxI = maxFeatPerView[ViewDescKey(block.I, block.descType)];
+    maxI = std::max(maxI, block.maxI);
+    IndexT& maxJ = maxFeatPerView[ViewDescKey(block.J, block.descType)];
+    maxJ = std::max(maxJ, block.maxJ);
+  }
+
+  std::vector<FeaturesRange> ranges;
+  ranges.reserve(maxFeatPerView.size());
+  std::map<ViewDescKey, NodeId> offsetPerView;
+  std::size_t nbNodes = 0;
+  for(const auto& it : maxFeatPerView)
+  {
+    const std::size_t rangeSize = static_cast<std::size_t>(it.second) + 1;
+    // the dense ids are 32 bits: refuse the matches which would make them wrap
+    if(nbNodes + rangeSize > MAX_NB_NODES)
+      throw std::length_error("Too many features to build the tracks: more than " + std::to_string(MAX_NB_NODES) +
+                              " features are referenced by the matches (view " + std::to_string(it.first.first) + ").");
+    ranges.push_back({it.first.first, it.first.second, static_cast<NodeId>(nbNodes), static_cast<NodeId>(rangeSize)});
+    offsetPerView[it.first] = static_cast<NodeId>(nbNodes);
+    nbNodes += rangeSize;
+  }
+  maxFeatPerView.clear();
+
+  for(MatchesBlock& block : blocks)
+  {
+    block.offsetI = offsetPerView.at(ViewDescKey(block.I, block.descType));
+    block.offsetJ = offsetPerView.at(ViewDescKey(block.J, block.descType));
+  }
+  offsetPerView.clear();
+
+  // make the union according to the pair matches
+  ConcurrentUnionFind unionFind(nbNodes);
+
+  #pragma omp parallel for schedule(dynamic) if(multithreaded)
+  for(int b = 0; b < static_cast<int>(blocks.size()); ++b)
+  {
+    const MatchesBlock& block = blocks[b];
+    for(const IndMatch& m : *block.matches)
+      unionFind.join(block.offsetI + m._i, block.offsetJ + m._j);
+  }
+
+  // root and size of the set of each node
+  std::vector<NodeId> roots(nbNodes);
+
+  #pragma omp parallel for if(multithreaded)
+  for(int64_t n = 0; n < static_cast<int64_t>(nbNodes); ++n)
+    roots[n] = unionFind.find(static_cast<NodeId>(n));
+
+  std::vector<NodeId> counts(nbNodes, 0);
+  for(std::size_t n = 0; n < nbNodes; ++n)
+    ++counts[roots[n]];
+
+  // features that are not referenced by any match are alone in their set.
+  // Tracks are sorted by their smallest node, counts[root] becomes the track id.
+  const NodeId noTrack = std::numeric_limits<NodeId>::max();
+  std::size_t nbTracks = 0;
+  for(std::size_t n = 0; n < nbNodes; ++n)
+  {
+    if(roots[n] != n)
+      continue;
+    const NodeId count = counts[n];
+    if(count < 2)
+    {
+      counts[n] = noTrack;
+      continue;
+    }
+    _tracks.trackOffsets.push_back(_tracks.trackOffsets.back() + count);
+    counts[n] = static_cast<NodeId>(nbTracks++);
+  }
+
+  _tracks.descTypes.resize(nbTracks);
+  _tracks.viewIds.resize(_tracks.trackOffsets.back());
+  _tracks.featIndices.resize(_tracks.trackOffsets.back());
+
+  // fill the observations in node order, so they are sorted by view id in each track
+  std::vector<std::size_t> cursors(_tracks.trackOffsets.begin(), _tracks.trackOffsets.end() - 1);
+  for(const FeaturesRange& range : ranges)
+  {
+    for(NodeId f = 0; f < range.size; ++f)
+    {
+      const NodeId trackId = counts[roots[range.offset + f]];
+      if(trackId == noTrack)
+        continue;
+      const std::size_t o = cursors[trackId]++;
+      _tracks.descTypes[trackId] = range.descType;
+      _tracks.viewIds[o] = range.viewId;
+      _tracks.featIndices[o] = f;
+    }
+  }
+}
+
+void UnionFindTracksBuilder::filter(bool clearForks, std::size_t minTrackLength)
+{
+  // remove bad tracks:
+  // - track that are too short,
+  // - track with id conflicts (many times the same image index)
+  if(!clearForks && minTrackLength == 0)
+    return;
+
+  CompactTracks& t = _tracks;
+  std::size_t nbKeptTracks = 0;
+  std::size_t nbKeptObservations = 0;
+
+  for(std::size_t trackId = 0; trackId < t.nbTracks(); ++trackId)
+  {
+    const std::size_t begin = t.trackOffsets[trackId];
+    const std::size_t end = t.trackOffsets[trackId + 1];
+
+    // observations are sorted by view id
+    std::size_t nbViews = 0;
+    for(std::size_t o = begin; o < end; ++o)
+    {
+      if(o == begin || t.viewIds[o] != t.viewIds[o - 1])
+        ++nbViews;
+    }
+
+    if((clearForks && nbViews != end - begin) || nbViews < minTrackLength)
+      continue;
+
+    // compact in place, the write position is never after the read position
+    t.descTypes[nbKeptTracks] = t.descTypes[trackId];
+    for(std::size_t o = begin; o < end; ++o, ++nbKeptObservations)
+    {
+      t.viewIds[nbKeptObservations] = t.viewIds[o];
+      t.featIndices[nbKeptObservations] = t.featIndices[o];
+    }
+    ++nbKeptTracks;
+    t.trackOffsets[nbKeptTracks] = nbKeptObservations;
+  }
+
+  t.descTypes.resize(nbKeptTracks);
+  t.trackOffsets.resize(nbKeptTracks + 1);
+  t.viewIds.resize(nbKeptObservations);
+  t.featIndices.resize(nbKeptObservations);
+}
+
+} // namespace track
+} // namespace aliceVision
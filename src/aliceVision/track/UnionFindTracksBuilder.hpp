@@ -0,0 +1,66 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2020 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#pragma once
+
+#include <aliceVision/track/CompactTracks.hpp>
+
+namespace aliceVision {
+namespace track {
+
+/**
+ * @brief Create Tracks from a set of Matches across Views with a parallel union-find.
+ *
+ * Same interface and same tracks as TracksBuilder, with a lower memory footprint:
+ * - each (view, describer type, feature index) referenced by the matches gets a dense id,
+ *   using an offset per (view, describer type) instead of a map,
+ * - the matches are merged with a lock-free union-find over these dense ids,
+ *   where each root is the smallest id of its set (so the result does not depend on the thread scheduling),
+ * - tracks are stored in flat arrays (CompactTracks).
+ *
+ * Usage:
+ * @code{.cpp}
+ *  UnionFindTracksBuilder tracksBuilder;
+ *  tracksBuilder.build(matches);
+ *  tracksBuilder.filter(true, 2);
+ *  tracksBuilder.exportToSTL(tracks); // or use getTracks() directly
+ * @endcode
+ */
+class UnionFindTracksBuilder
+{
+public:
+  /**
+   * @brief Build tracks for a given series of pairWise matches
+   * @param[in] pairwiseMatches PairWise matches
+   * @param[in] multithreaded Is multithreaded
+   */
+  void build(const PairwiseMatches& pairwiseMatches, bool multithreaded = true);
+
+  /**
+   * @brief Remove bad tracks (too short or track with ids collision)
+   * @param[in] clearForks: remove tracks with multiple observation in a single image
+   * @param[in] minTrackLength: minimal number of observations to keep the track
+   */
+  void filter(bool clearForks = true, std::size_t minTrackLength = 2);
+
+  /**
+   * @brief Export tracks as a map (each entry is a sequence of imageId and keypointId):
+   *        {TrackIndex => {(imageIndex, keypointId), ... ,(imageIndex, keypointId)}
+   */
+  void exportToSTL(TracksMap& allTracks) const { _tracks.exportToSTL(allTracks); }
+
+  /// Return the number of tracks
+  std::size_t nbTracks() const { return _tracks.nbTracks(); }
+
+  /// Return the tracks in flat arrays
+  const CompactTracks& getTracks() const { return _tracks; }
+
+private:
+  CompactTracks _tracks;
+};
+
+} // namespace track
+} // namespace aliceVision
@@ -6,9 +6,12 @@
 // You can obtain one at https://mozilla.org/MPL/2.0/.
 
 #include "aliceVision/track/TracksBuilder.hpp"
+#include "aliceVision/track/UnionFindTracksBuilder.hpp"
 #include "aliceVision/track/tracksUtils.hpp"
 #include "aliceVision/matching/IndMatch.hpp"
 
+#include <random>
+#include <set>
 #include <vector>
 #include <utility>
 
@@ -17,6 +20,7 @@
 #include <boost/test/unit_test.hpp>
 #include <boost/test/tools/floating_point_comparison.hpp>
 
+using namespace aliceVision;
 using namespace aliceVision::feature;
 using namespace aliceVision::track;
 using namespace aliceVision::matching;
@@ -86,6 +90,119 @@ BOOST_AUTO_TEST_CASE(Track_Simple) {
   }
 }
 
+BOOST_AUTO_TEST_CASE(Track_UnionFind_Simple)
+{
+  //A    B    C
+  //0 -> 0 -> 0
+  //1 -> 1 -> 6
+  //2 -> 3
+  PairwiseMatches map_pairwisematches;
+  map_pairwisematches[std::make_pair(0, 1)][EImageDescriberType::UNKNOWN] = {IndMatch(0,0), IndMatch(1,1), IndMatch(2,3)};
+  map_pairwisematches[std::make_pair(1, 2)][EImageDescriberType::UNKNOWN] = {IndMatch(0,0), IndMatch(1,6)};
+
+  UnionFindTracksBuilder trackBuilder;
+  trackBuilder.build(map_pairwisematches);
+  BOOST_CHECK_EQUAL(3, trackBuilder.nbTracks());
+
+  const CompactTracks& tracks = trackBuilder.getTracks();
+  BOOST_CHECK_EQUAL(8, tracks.nbObservations());
+  BOOST_CHECK_EQUAL(3, tracks.trackLength(0));
+  BOOST_CHECK_EQUAL(3, tracks.trackLength(1));
+  BOOST_CHECK_EQUAL(2, tracks.trackLength(2));
+
+  TracksMap map_tracks;
+  trackBuilder.exportToSTL(map_tracks);
+
+  const std::pair<std::size_t,std::size_t> GT_Tracks[] =
+  {
+    std::make_pair(0,0), std::make_pair(1,0), std::make_pair(2,0),
+    std::make_pair(0,1), std::make_pair(1,1), std::make_pair(2,6),
+    std::make_pair(0,2), std::make_pair(1,3)
+  };
+
+  BOOST_CHECK_EQUAL(3, map_tracks.size());
+  std::size_t cpt = 0;
+  for(const auto& trackIt : map_tracks)
+  {
+    BOOST_CHECK(trackIt.second.descType == EImageDescriberType::UNKNOWN);
+    for(const auto& featIt : trackIt.second.featPerView)
+    {
+      BOOST_CHECK(GT_Tracks[cpt] == std::make_pair(featIt.first, featIt.second));
+      ++cpt;
+    }
+  }
+
+  trackBuilder.filter(true, 3);
+  BOOST_CHECK_EQUAL(2, trackBuilder.nbTracks());
+}
+
+BOOST_AUTO_TEST_CASE(Track_UnionFind_TooManyFeatures)
+{
+  // the feature ids of the views would not fit in the 32 bits node ids
+  PairwiseMatches map_pairwisematches;
+  map_pairwisematches[std::make_pair(0, 1)][EImageDescriberType::UNKNOWN] = {IndMatch(0, 4000000000u)};
+  map_pairwisematches[std::make_pair(1, 2)][EImageDescriberType::UNKNOWN] = {IndMatch(0, 400000000u)};
+
+  UnionFindTracksBuilder trackBuilder;
+  BOOST_CHECK_THROW(trackBuilder.build(map_pairwisematches), std::length_error);
+}
+
+BOOST_AUTO_TEST_CASE(Track_UnionFind_SameAsTracksBuilder)
+{
+  std::mt19937 generator(42);
+  std::uniform_int_distribution<IndexT> featDistribution(0, 300);
+
+  // random matches between 10 views with 2 describer types
+  PairwiseMatches map_pairwisematches;
+  for(IndexT I = 0; I < 10; ++I)
+  {
+    for(IndexT J = I + 1; J < 10; ++J)
+    {
+      for(EImageDescriberType descType : {EImageDescriberType::SIFT, EImageDescriberType::AKAZE})
+      {
+        IndMatches& matches = map_pairwisematches[std::make_pair(I, J)][descType];
+        for(int m = 0; m < 50; ++m)
+          matches.emplace_back(featDistribution(generator), featDistribution(generator));
+      }
+    }
+  }
+
+  // tracks as sets of observations, to compare them independently of their ids
+  using TrackObservations = std::set<std::pair<EImageDescriberType, std::pair<std::size_t, std::size_t>>>;
+  const auto toSet = [](const TracksMap& tracks)
+  {
+    std::set<TrackObservations> result;
+    for(const auto& trackIt : tracks)
+    {
+      TrackObservations observations;
+      for(const auto& featIt : trackIt.second.featPerView)
+        observations.insert(std::make_pair(trackIt.second.descType, std::make_pair(featIt.first, featIt.second)));
+      result.insert(observations);
+    }
+    return result;
+  };
+
+  for(bool clearForks : {false, true})
+  {
+    TracksBuilder trackBuilder;
+    trackBuilder.build(map_pairwisematches);
+    trackBuilder.filter(clearForks, 3);
+    TracksMap map_tracks;
+    trackBuilder.exportToSTL(map_tracks);
+
+    UnionFindTracksBuilder unionFindTrackBuilder;
+    unionFindTrackBuilder.build(map_pairwisematches);
+    unionFindTrackBuilder.filter(clearForks, 3);
+    TracksMap map_unionFindTracks;
+    unionFindTrackBuilder.exportToSTL(map_unionFindTracks);
+
+    BOOST_CHECK_EQUAL(trackBuilder.nbTracks(), unionFindTrackBuilder.nbTracks());
+    // TracksMap keeps a single observation per view, so tracks with forks can only be compared without them
+    if(clearForks)
+      BOOST_CHECK(toSet(map_tracks) == toSet(map_unionFindTracks));
+  }
+}
+
 BOOST_AUTO_TEST_CASE(Track_filter_3viewAtLeast) {
 
   //
@@ -5,9 +5,8 @@
 // You can obtain one at https://mozilla.org/MPL/2.0/.
 
 #include "Database.hpp"
-#include <boost/accumulators/accumulators.hpp>
-#include <boost/accumulators/statistics/tail.hpp>
 #include <boost/progress.hpp>
+#include <algorithm>
 #include <cmath>
 #include <fstream>
 #include <stdexcept>
@@ -26,6 +25,85 @@ std::ostream& operator<<(std::ostream& os, const SparseHistogram &dv)
 	return os;
 }
 
+namespace {
+
+/// Scoring of the documents, see sparseDistance
+enum class EScoring
+{
+  CLASSIC,
+  COMMON_POINTS,
+  STRONG_COMMON_POINTS,
+  WEIGHTED_STRONG_COMMON_POINTS,
+  INVERSED_WEIGHTED_COMMON_POINTS
+};
+
+EScoring getScoring(const std::string& distanceMethod)
+{
+  if(distanceMethod == "classic")
+    return EScoring::CLASSIC;
+  if(distanceMethod == "commonPoints")
+    return EScoring::COMMON_POINTS;
+  if(distanceMethod == "strongCommonPoints")
+    return EScoring::STRONG_COMMON_POINTS;
+  if(distanceMethod == "weightedStrongCommonPoints")
+    return EScoring::WEIGHTED_STRONG_COMMON_POINTS;
+  if(distanceMethod == "inversedWeightedCommonPoints")
+    return EScoring::INVERSED_WEIGHTED_COMMON_POINTS;
+  throw std::invalid_argument("distance method "+ distanceMethod +" unknown!");
+}
+
+/// Order the matches by score, then by document ID
+inline bool isBetterMatch(const DocMatch& a, const DocMatch& b)
+{
+  return a.score < b.score || (a.score == b.score && a.id < b.id);
+}
+
+/**
+ * @brief Keep the N best matches in a bounded heap, the worst kept match on top.
+ */
+class BestMatches
+{
+public:
+  explicit BestMatches(std::size_t N)
+    : _N(N)
+  {
+    _heap.reserve(N);
+  }
+
+  bool isFull() const { return _heap.size() == _N; }
+
+  const DocMatch& worst() const { return _heap.front(); }
+
+  void add(const DocMatch& match)
+  {
+    if(_heap.size() < _N)
+    {
+      _heap.push_back(match);
+      std::push_heap(_heap.begin(), _heap.end(), isBetterMatch);
+    }
+    else if(_N > 0 && isBetterMatch(match, _heap.front()))
+    {
+      std::pop_heap(_heap.begin(), _heap.end(), isBetterMatch);
+      _heap.back() = match;
+      std::push_heap(_heap.begin(), _heap.end(), isBetterMatch);
+    }
+  }
+
+  /// Extract the matches in best-to-worst order
+  void extract(std::vector<DocMatch>& matches)
+  {
+    std::sort_heap(_heap.begin(), _heap.end(), isBetterMatch);
+    matches.swap(_heap);
+    _heap.clear();
+  }
+
+private:
+  std::size_t _N;
+  std::vector<DocMatch> _heap;
+};
+
+} // namespace
+
 Database::Database(uint32_t num_words)
 : word_files_(num_words),
 word_weights_( num_words, 1.0f ) { }
@@ -35,18 +113,24 @@ DocId Database::insert(DocId doc_id, const SparseHistogram& document)
   // Ensure that the new document to insert is not already there.
   assert(database_.find(doc_id) == database_.end());
 
+  const uint32_t doc_index = static_cast<uint32_t>(doc_ids_.size());
+  uint32_t nb_words = 0;
+
   // For each word, retrieve its inverted file and increment the count for doc_id.
   for(SparseHistogram::const_iterator it = document.begin(), end = document.end(); it != end; ++it)
   {
     Word word = it->first;
     InvertedFile& file = word_files_[word];
-    if(file.empty() || file.back().id != doc_id)
-      file.push_back(WordFrequency(doc_id, it->second.size()));
+    if(file.empty() || file.back().index != doc_index)
+      file.push_back(WordFrequency(doc_index, it->second.size()));
     else
       file.back().count += it->second.size();
+    nb_words += it->second.size();
   }
 
   database_[doc_id] = document;
+  doc_ids_.push_back(doc_id);
+  doc_nb_words_.push_back(nb_words);
 
   return doc_id;
 }
@@ -69,17 +153,31 @@ void Database::sanityCheck(std::size_t N, std::map<std::size_t, DocMatches>& mat
   matches.clear();
   // since we already know the size of the vectors, in order to parallelize the 
   // query allocate the whole memory
+  std::vector<SparseHistogramPerImage::const_iterator> documents;
+  documents.reserve(database_.size());
+  for(SparseHistogramPerImage::const_iterator it = database_.begin(); it != database_.end(); ++it)
+    documents.push_back(it);
+
+  std::vector<DocMatches> documentsMatches(documents.size());
   boost::progress_display display(database_.size());
-  
-  //#pragma omp parallel for default(none) shared(database_)
-  for(const auto &doc : database_)
+
+  #pragma omp parallel
   {
-    std::vector<DocMatch> m;
-    find(doc.second, N, m);
-    //		matches.emplace_back( m );
-    matches[doc.first] = m;
-    ++display;
+    // one accumulator per thread, reused by all its queries
+    ScoreAccumulator accumulator;
+
+    #pragma omp for schedule(dynamic)
+    for(int i = 0; i < static_cast<int>(documents.size()); ++i)
+    {
+      find(documents[i]->second, N, documentsMatches[i], "strongCommonPoints", accumulator);
+
+      #pragma omp critical
+      ++display;
+    }
   }
+
+  for(std::size_t i = 0; i < documents.size(); ++i)
+    matches[documents[i]->first] = std::move(documentsMatches[i]);
 }
 
 /**
@@ -110,23 +208,106 @@ void Database::find(const std::vector<Word>& document, std::size_t N, std::vecto
  */
 void Database::find( const SparseHistogram& query, std::size_t N, std::vector<DocMatch>& matches, const std::string &distanceMethod) const
 {
-  // Accumulate the best N matches
-  using bestN_tag = boost::accumulators::tag::tail<boost::accumulators::left>;
-  boost::accumulators::accumulator_set<DocMatch, boost::accumulators::features<bestN_tag> > acc(bestN_tag::cache_size = N);
+  ScoreAccumulator accumulator;
+  find(query, N, matches, distanceMethod, accumulator);
+}
+
+void Database::find(const SparseHistogram& query, std::size_t N, std::vector<DocMatch>& matches, const std::string &distanceMethod, ScoreAccumulator& accumulator) const
+{
+  const EScoring scoring = getScoring(distanceMethod);
+  const std::size_t nbDocuments = doc_ids_.size();
+
+  matches.clear();
+  if(N == 0 || nbDocuments == 0)
+    return;
+
+  // the accumulator is reset after each query, only the visited documents are not zero
+  accumulator.scores.resize(nbDocuments, 0.0f);
+  accumulator.isVisited.resize(nbDocuments, 0);
+  accumulator.visited.clear();
+  std::vector<float>& scores = accumulator.scores;
+  std::vector<char>& isVisited = accumulator.isVisited;
+
+  // accumulate the score of the words shared with the query, through their inverted files
+  float queryNbWords = 0.0f;
+  for(const auto& wordIt : query)
+  {
+    const Word word = wordIt.first;
+    const std::size_t queryCount = wordIt.second.size();
+    queryNbWords += queryCount;
+
+    if(word < 0 || static_cast<std::size_t>(word) >= word_files_.size())
+      continue;
+
+    const float weight = (static_cast<std::size_t>(word) < word_weights_.size()) ? word_weights_[word] : 1.0f;
+
+    for(const WordFrequency& frequency : word_files_[word])
+    {
+      const std::size_t minCount = std::min<std::size_t>(queryCount, frequency.count);
+      float& score = scores[frequency.index];
+
+      switch(scoring)
+      {
+        case EScoring::CLASSIC:
+        case EScoring::COMMON_POINTS:
+          score += minCount;
+          break;
+        case EScoring::STRONG_COMMON_POINTS:
+          if(queryCount == 1 && frequency.count == 1)
+            score += 1;
+          break;
+        case EScoring::WEIGHTED_STRONG_COMMON_POINTS:
+          if(queryCount == 1 && frequency.count == 1)
+            score += weight;
+          break;
+        case EScoring::INVERSED_WEIGHTED_COMMON_POINTS:
+          score += (1.f / minCount) * weight;
+          break;
+      }
+
+      if(!isVisited[frequency.index])
+      {
+        isVisited[frequency.index] = 1;
+        accumulator.visited.push_back(frequency.index);
+      }
+    }
+  }
+
+  BestMatches bestN(std::min(N, nbDocuments));
+
+  if(scoring == EScoring::CLASSIC)
+  {
+    // L1 distance of the histograms: |q - d| = q + d - 2 min(q, d) for each word,
+    // the documents that do not share any word with the query are at the distance Nq + Nd
+    for(std::size_t i = 0; i < nbDocuments; ++i)
+      bestN.add(DocMatch(doc_ids_[i], queryNbWords + doc_nb_words_[i] - 2.0f * scores[i]));
+  }
+  else
+  {
+    for(const uint32_t index : accumulator.visited)
+      bestN.add(DocMatch(doc_ids_[index], -scores[index]));
+
+    // the documents that do not share any word with the query have a score of 0,
+    // they are only needed to complete the N matches or to break ties
+    if(!bestN.isFull() || bestN.worst().score >= 0.0f)
+    {
+      for(std::size_t i = 0; i < nbDocuments; ++i)
+      {
+        if(!isVisited[i])
+          bestN.add(DocMatch(doc_ids_[i], -0.0f));
+      }
+    }
+  }
 
-  /// @todo Try only computing distances against documents sharing at least one word
-  for(const auto& document: database_)
+  // reset the scores of the visited documents for the next query
+  for(const uint32_t index : accumulator.visited)
   {
-    // for each document/image in the database compute the distance between the 
-    // histograms of the query image and the others
-    const float distance = sparseDistance(query, document.second, distanceMethod, word_weights_);
-    acc(DocMatch(document.first, distance));
+    scores[index] = 0.0f;
+    isVisited[index] = 0;
   }
 
   // extract the best N
-  boost::accumulators::extractor<bestN_tag> bestN;
-  matches.resize(std::min(N, database_.size()));
-  std::copy(bestN(acc).begin(), bestN(acc).end(), matches.begin());
+  bestN.extract(matches);
 }
 
 /**
@@ -77,7 +77,7 @@ public:
 
   /**
    * @brief Perform a sanity check of the database by querying each document
-   * of the database and finding its top N matches
+   * of the database and finding its top N matches (documents are queried in parallel)
    * 
    * @param[in] N The number of matches to return.
    * @param[out] matches IDs and scores for the top N matching database documents.
@@ -97,6 +97,11 @@ public:
     /**
    * @brief Find the top N matches in the database for the query document.
    *
+   * The scores are accumulated with the inverted files of the query words,
+   * so only the documents sharing at least one word with the query are visited.
+   * The result is the same as computing sparseDistance with all the documents,
+   * matches with the same score are sorted by document ID.
+   *
    * @param[in] query The query document, a normalized set of quantized words.
    * @param[int] N        The number of matches to return.
    * @param[in] distanceMethod distance method (norm L1, etc.)
@@ -136,19 +141,28 @@ private:
 
   struct WordFrequency
   {
-    DocId id;
+    /// index of the document in doc_ids_
+    uint32_t index;
     uint32_t count;
 
     WordFrequency() = default;
-    WordFrequency(DocId _id, uint32_t _count)
-      : id(_id)
+    WordFrequency(uint32_t _index, uint32_t _count)
+      : index(_index)
       , count(_count)
     {}
   };
 
-  // Stored in increasing order by DocId
+  // Stored in increasing order by document index
   typedef std::vector<WordFrequency> InvertedFile;
 
+  /// Scores of the documents sharing words with a query, reused from one query to the next
+  struct ScoreAccumulator
+  {
+    std::vector<float> scores;
+    std::vector<char> isVisited;
+    std::vector<uint32_t> visited;
+  };
+
   /// @todo Use sorted vector?
   // typedef std::vector< std::pair<Word, float> > DocumentVector;
   
@@ -157,6 +171,10 @@ private:
   std::vector<InvertedFile> word_files_;
   std::vector<float> word_weights_;
   SparseHistogramPerImage database_; // Precomputed for inserted documents
+  std::vector<DocId> doc_ids_; // Documents in insertion order
+  std::vector<uint32_t> doc_nb_words_; // Number of (possibly repeated) words per document
+
+  void find(const SparseHistogram& query, std::size_t N, std::vector<DocMatch>& matches, const std::string &distanceMethod, ScoreAccumulator& accumulator) const;
 
   /**
    * Normalize a document vector representing the histogram of visual words for a given image
@@ -38,7 +38,10 @@ float sparseDistance(const SparseHistogram& v1, const SparseHistogram& v2, const
       }
       else
       {
-        const auto val = std::minmax(i1->second.size(), i2->second.size());
+        // std::minmax returns references, do not call it on temporaries
+        const std::size_t size1 = i1->second.size();
+        const std::size_t size2 = i2->second.size();
+        const auto val = std::minmax(size1, size2);
         distance += static_cast<float>(val.second - val.first);
         ++i1;
         ++i2;
@@ -165,6 +168,8 @@ float sparseDistance(const SparseHistogram& v1, const SparseHistogram& v2, const
         N1 += i1->second.size()*word_weights[i1->first];
          ++i1;
       }
+      else
+      {
         if( ( fabs(i1->second.size() - 1.f) < epsilon ) && ( fabs(i2->second.size() - 1.f) < epsilon) )
         {
           score += word_weights[i1->first];
@@ -173,6 +178,7 @@ float sparseDistance(const SparseHistogram& v1, const SparseHistogram& v2, const
         }
         ++i1;
         ++i2;
+      }
     }
 
     while(i1 != i1e)
@@ -6,8 +6,12 @@
 
 #include <aliceVision/voctree/Database.hpp>
 
+#include <algorithm>
+#include <cmath>
 #include <iostream>
 #include <fstream>
+#include <random>
+#include <stdexcept>
 #include <vector>
 
 #define BOOST_TEST_MODULE vocabularyTree
@@ -58,3 +62,121 @@ BOOST_AUTO_TEST_CASE(database)
     BOOST_CHECK_SMALL(static_cast<double>(match[0].score), 0.001);
   }
 }
+
+BOOST_AUTO_TEST_CASE(database_invertedFile)
+{
+  const int nbDocuments = 200;
+  const int nbWords = 500;
+  const int nbWordsPerDocument = 40;
+
+  std::mt19937 generator(42);
+  std::uniform_int_distribution<Word> wordDistribution(0, nbWords - 1);
+
+  // documents with repeated words, a few documents without any word in common with the others
+  SparseHistogramPerImage documents;
+  for(int i = 0; i < nbDocuments; ++i)
+  {
+    vector<Word> document;
+    if(i % 50 == 0)
+      document = {nbWords + i, nbWords + i + 1};
+    else
+      for(int j = 0; j < nbWordsPerDocument; ++j)
+        document.push_back(wordDistribution(generator));
+    // non contiguous document ids
+    computeSparseHistogram(document, documents[3 * i + 1]);
+  }
+
+  Database db(nbWords + 2 * nbDocuments);
+  for(const auto& document : documents)
+    db.insert(document.first, document.second);
+  db.computeTfIdfWeights();
+
+  // same weights as computeTfIdfWeights
+  vector<std::size_t> nbDocumentsPerWord(nbWords + 2 * nbDocuments, 0);
+  for(const auto& document : documents)
+    for(const auto& word : document.second)
+      ++nbDocumentsPerWord[word.first];
+  vector<float> weights(nbDocumentsPerWord.size(), 1.0f);
+  for(std::size_t w = 0; w < weights.size(); ++w)
+    if(nbDocumentsPerWord[w] != 0)
+      weights[w] = std::log(static_cast<float>(documents.size()) / nbDocumentsPerWord[w]);
+
+  for(const std::string distanceMethod : {"classic", "commonPoints", "strongCommonPoints", "weightedStrongCommonPoints", "inversedWeightedCommonPoints"})
+  {
+    for(const std::size_t N : {1, 10, 190, 250})
+    {
+      for(int q = 0; q < nbDocuments; q += 7)
+      {
+        const SparseHistogram& query = documents.at(3 * q + 1);
+
+        // exhaustive search
+        vector<DocMatch> expected;
+        for(const auto& document : documents)
+          expected.emplace_back(document.first, sparseDistance(query, document.second, distanceMethod, weights));
+        std::sort(expected.begin(), expected.end(), [](const DocMatch& a, const DocMatch& b)
+        {
+          return a.score < b.score || (a.score == b.score && a.id < b.id);
+        });
+        expected.resize(std::min(N, expected.size()));
+
+        vector<DocMatch> matches;
+        db.find(query, N, matches, distanceMethod);
+
+        BOOST_REQUIRE_EQUAL(expected.size(), matches.size());
+        for(std::size_t i = 0; i < matches.size(); ++i)
+        {
+          BOOST_CHECK_EQUAL(expected[i].id, matches[i].id);
+          BOOST_CHECK_SMALL(static_cast<double>(expected[i].score - matches[i].score), 1e-4);
+        }
+      }
+    }
+  }
+
+  vector<DocMatch> invalidMatches;
+  BOOST_CHECK_THROW(db.find(documents.begin()->second, 1, invalidMatches, "unknown"), std::invalid_argument);
+
+  // the parallel sanity check gives the same results as the queries
+  std::map<std::size_t, DocMatches> allMatches;
+  db.sanityCheck(5, allMatches);
+  BOOST_CHECK_EQUAL(documents.size(), allMatches.size());
+  for(const auto& document : documents)
+  {
+    vector<DocMatch> matches;
+    db.find(document.second, 5, matches);
+    BOOST_CHECK(matches == allMatches.at(document.first));
+  }
+}
+
+BOOST_AUTO_TEST_CASE(database_noMatches)
+{
+  const SparseHistogram query = {{0, {0}}, {1, {1, 2}}};
+
+  for(const std::string distanceMethod : {"classic", "commonPoints", "strongCommonPoints", "weightedStrongCommonPoints", "inversedWeightedCommonPoints"})
+  {
+    // empty database
+    {
+      Database db(10);
+      vector<DocMatch> matches(1);
+      db.find(query, 5, matches, distanceMethod);
+      BOOST_CHECK(matches.empty());
+    }
+
+    // no match requested
+    {
+      Database db(10);
+      SparseHistogram document;
+      computeSparseHistogram(vector<Word>{0, 1, 2}, document);
+      db.insert(0, document);
+      db.computeTfIdfWeights();
+
+      vector<DocMatch> matches(1);
+      db.find(query, 0, matches, distanceMethod);
+      BOOST_CHECK(matches.empty());
+
+      // the scores of the previous query do not remain in the database
+      db.find(document, 1, matches, distanceMethod);
+      BOOST_REQUIRE_EQUAL(1, matches.size());
+      BOOST_CHECK_EQUAL(0, matches[0].id);
+    }
+  }
+}
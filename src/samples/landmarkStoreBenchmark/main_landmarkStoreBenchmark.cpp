@@ -0,0 +1,152 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2020 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include <aliceVision/sfmData/Landmark.hpp>
+#include <aliceVision/sfmData/LandmarkStore.hpp>
+#include <aliceVision/system/Logger.hpp>
+#include <aliceVision/system/Timer.hpp>
+
+#include <boost/program_options.hpp>
+
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+
+// These constants define the current software version.
+// They must be updated when the command line is changed.
+#define ALICEVISION_SOFTWARE_VERSION_MAJOR 1
+#define ALICEVISION_SOFTWARE_VERSION_MINOR 0
+
+using namespace aliceVision;
+
+namespace po = boost::program_options;
+
+/**
+ * @brief Generate landmarks observed by consecutive views
+ */
+void generateLandmarks(std::size_t nbViews, std::size_t nbLandmarks, std::size_t nbObservationsPerLandmark, sfmData::Landmarks& landmarks)
+{
+  std::mt19937 gen(42);
+  std::uniform_real_distribution<double> dist(-10.0, 10.0);
+  std::uniform_int_distribution<std::size_t> distView(0, nbViews - 1);
+
+  for(IndexT landmarkId = 0; landmarkId < nbLandmarks; ++landmarkId)
+  {
+    sfmData::Landmark& landmark = landmarks[landmarkId];
+    landmark.X = Vec3(dist(gen), dist(gen), dist(gen));
+    landmark.descType = feature::EImageDescriberType::SIFT;
+
+    const std::size_t firstView = distView(gen);
+    for(std::size_t o = 0; o < nbObservationsPerLandmark; ++o)
+    {
+      const IndexT viewId = static_cast<IndexT>((firstView + o) % nbViews);
+      landmark.observations[viewId] = sfmData::Observation(Vec2(dist(gen), dist(gen)), landmarkId, 1.0);
+    }
+  }
+}
+
+/**
+ * @brief Traversal of all the observations, as done to compute residuals statistics,
+ *        with the same code for sfmData::Landmarks and sfmData::LandmarkStore
+ */
+template<typename LandmarksT>
+double traverse(const LandmarksT& landmarks, double scale)
+{
+  double sum = 0.0;
+
+  for(const auto& landmarkPair : landmarks)
+  {
+    const Vec3& X = landmarkPair.second.X;
+
+    for(const auto& observationPair : landmarkPair.second.observations)
+      sum += (scale * X.head<2>() / X(2) - observationPair.second.x).squaredNorm();
+  }
+
+  return sum;
+}
+
+int main(int argc, char** argv)
+{
+  std::size_t nbViews = 1000;
+  std::size_t nbLandmarks = 1000000;
+  std::size_t nbObservationsPerLandmark = 4;
+  int nbTraversals = 10;
+
+  po::options_description allParams("Benchmark of the landmarks memory and traversal time with sfmData::Landmarks and sfmData::LandmarkStore.\n"
+                                    "AliceVision Sample landmarkStoreBenchmark");
+  allParams.add_options()
+    ("help,h", "Print this message.")
+    ("nbViews", po::value<std::size_t>(&nbViews)->default_value(nbViews),
+      "Number of views.")
+    ("nbLandmarks", po::value<std::size_t>(&nbLandmarks)->default_value(nbLandmarks),
+      "Number of landmarks.")
+    ("nbObservationsPerLandmark", po::value<std::size_t>(&nbObservationsPerLandmark)->default_value(nbObservationsPerLandmark),
+      "Number of observations of each landmark.")
+    ("nbTraversals", po::value<int>(&nbTraversals)->default_value(nbTraversals),
+      "Number of traversals of all the observations.");
+
+  po::variables_map vm;
+  try
+  {
+    po::store(po::parse_command_line(argc, argv, allParams), vm);
+
+    if(vm.count("help"))
+    {
+      ALICEVISION_COUT(allParams);
+      return EXIT_SUCCESS;
+    }
+    po::notify(vm);
+  }
+  catch(boost::program_options::error& e)
+  {
+    ALICEVISION_CERR("ERROR: " << e.what());
+    ALICEVISION_COUT("Usage:\n\n" << allParams);
+    return EXIT_FAILURE;
+  }
+
+  if(nbViews == 0 || nbObservationsPerLandmark > nbViews)
+  {
+    ALICEVISION_CERR("ERROR: the number of observations per landmark must be lower than the number of views.");
+    return EXIT_FAILURE;
+  }
+
+  sfmData::Landmarks landmarks;
+  generateLandmarks(nbViews, nbLandmarks, nbObservationsPerLandmark, landmarks);
+  std::cout << nbLandmarks << " landmarks, " << nbLandmarks * nbObservationsPerLandmark << " observations" << std::endl;
+
+  system::Timer timer;
+  const sfmData::LandmarkStore store(landmarks);
+  std::cout << "LandmarkStore creation: " << timer.elapsed() << " s" << std::endl;
+
+  const auto printResult = [&](const std::string& name, std::size_t memorySize, double time, double sum)
+  {
+    std::cout << std::setw(16) << name
+              << "   memory: " << memorySize / (1024 * 1024) << " MB"
+              << std::fixed << std::setprecision(3)
+              << "   traversal: " << time / nbTraversals << " s"
+              << "   (checksum: " << sum << ")" << std::endl;
+  };
+
+  {
+    timer.reset();
+    double sum = 0.0;
+    for(int i = 0; i < nbTraversals; ++i)
+      sum += traverse(landmarks, 1.0 + i);
+    printResult("Landmarks", sfmData::estimateMemorySize(landmarks), timer.elapsed(), sum);
+  }
+
+  {
+    timer.reset();
+    double sum = 0.0;
+    for(int i = 0; i < nbTraversals; ++i)
+      sum += traverse(store, 1.0 + i);
+    printResult("LandmarkStore", store.getMemorySize(), timer.elapsed(), sum);
+  }
+
+  return EXIT_SUCCESS;
+}
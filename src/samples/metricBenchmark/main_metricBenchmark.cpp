@@ -0,0 +1,143 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2020 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include <aliceVision/matching/metricKernels.hpp>
+#include <aliceVision/system/cpu.hpp>
+#include <aliceVision/system/Logger.hpp>
+#include <aliceVision/system/Timer.hpp>
+
+#include <boost/program_options.hpp>
+
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+// These constants define the current software version.
+// They must be updated when the command line is changed.
+#define ALICEVISION_SOFTWARE_VERSION_MAJOR 1
+#define ALICEVISION_SOFTWARE_VERSION_MINOR 0
+
+using namespace aliceVision;
+using namespace aliceVision::matching::kernels;
+
+namespace po = boost::program_options;
+
+/**
+ * @brief Compute the distances between all the query and database descriptors
+ *        and print the throughput of the given kernel.
+ */
+template<typename T, typename KernelT>
+void benchmarkKernel(const std::string& name,
+                     EMetricKernel kernelType,
+                     KernelT kernel,
+                     const std::vector<T>& queries,
+                     const std::vector<T>& database,
+                     std::size_t dimension)
+{
+  if(kernel == nullptr)
+  {
+    std::cout << std::setw(10) << name << std::setw(8) << kernelType << "   not supported" << std::endl;
+    return;
+  }
+
+  const std::size_t nbQueries = queries.size() / dimension;
+  const std::size_t nbDatabase = database.size() / dimension;
+
+  // accumulate the results to prevent the compiler from removing the computation
+  double checksum = 0.0;
+  system::Timer timer;
+  for(std::size_t i = 0; i < nbQueries; ++i)
+  {
+    const T* query = &queries[i * dimension];
+    for(std::size_t j = 0; j < nbDatabase; ++j)
+      checksum += kernel(query, &database[j * dimension], dimension);
+  }
+  const double elapsed = timer.elapsed();
+  const double nbDistances = double(nbQueries) * double(nbDatabase);
+
+  std::cout << std::setw(10) << name << std::setw(8) << kernelType
+            << std::setw(12) << std::fixed << std::setprecision(1) << (nbDistances / elapsed) * 1e-6 << " Mdist/s"
+            << std::setw(10) << std::setprecision(3) << elapsed << " s"
+            << "   (checksum: " << std::setprecision(0) << checksum << ")" << std::endl;
+}
+
+int main(int argc, char** argv)
+{
+  std::size_t nbQueries = 1000;
+  std::size_t nbDatabase = 10000;
+  std::size_t dimension = 128;
+  std::size_t hammingSize = 32;
+
+  po::options_description allParams("Microbenchmark of the descriptor distance kernels (scalar, AVX2, AVX-512).\n"
+                                    "AliceVision Sample metricBenchmark");
+  allParams.add_options()
+    ("help,h", "Print this message.")
+    ("nbQueries", po::value<std::size_t>(&nbQueries)->default_value(nbQueries),
+      "Number of query descriptors.")
+    ("nbDatabase", po::value<std::size_t>(&nbDatabase)->default_value(nbDatabase),
+      "Number of database descriptors.")
+    ("dimension", po::value<std::size_t>(&dimension)->default_value(dimension),
+      "Dimension of the L2 descriptors (128 for SIFT).")
+    ("hammingSize", po::value<std::size_t>(&hammingSize)->default_value(hammingSize),
+      "Size in bytes of the binary descriptors (32 for ORB).");
+
+  po::variables_map vm;
+  try
+  {
+    po::store(po::parse_command_line(argc, argv, allParams), vm);
+
+    if(vm.count("help"))
+    {
+      ALICEVISION_COUT(allParams);
+      return EXIT_SUCCESS;
+    }
+    po::notify(vm);
+  }
+  catch(boost::program_options::error& e)
+  {
+    ALICEVISION_CERR("ERROR: " << e.what());
+    ALICEVISION_COUT("Usage:\n\n" << allParams);
+    return EXIT_FAILURE;
+  }
+
+  const system::CpuFeatures& cpu = system::get_cpu_features();
+  std::cout << "CPU features: "
+            << "popcnt " << cpu.popcnt << ", avx2 " << cpu.avx2 << ", fma " << cpu.fma
+            << ", avx512f " << cpu.avx512f << ", avx512bw " << cpu.avx512bw
+            << ", avx512vnni " << cpu.avx512vnni << ", avx512vpopcntdq " << cpu.avx512vpopcntdq << std::endl;
+
+  std::mt19937 gen(42);
+  std::uniform_int_distribution<int> distByte(0, 255);
+  std::uniform_real_distribution<float> distFloat(0.f, 1.f);
+
+  std::vector<unsigned char> queriesUint8(nbQueries * dimension), databaseUint8(nbDatabase * dimension);
+  std::vector<float> queriesFloat(nbQueries * dimension), databaseFloat(nbDatabase * dimension);
+  std::vector<unsigned char> queriesBinary(nbQueries * hammingSize), databaseBinary(nbDatabase * hammingSize);
+
+  for(auto& v : queriesUint8) v = static_cast<unsigned char>(distByte(gen));
+  for(auto& v : databaseUint8) v = static_cast<unsigned char>(distByte(gen));
+  for(auto& v : queriesFloat) v = distFloat(gen);
+  for(auto& v : databaseFloat) v = distFloat(gen);
+  for(auto& v : queriesBinary) v = static_cast<unsigned char>(distByte(gen));
+  for(auto& v : databaseBinary) v = static_cast<unsigned char>(distByte(gen));
+
+  std::cout << nbQueries << " x " << nbDatabase << " distances, dimension " << dimension
+            << ", hamming size " << hammingSize << " bytes" << std::endl;
+
+  for(EMetricKernel kernel : {EMetricKernel::SCALAR, EMetricKernel::AVX2, EMetricKernel::AVX512})
+    benchmarkKernel("l2 uint8", kernel, getL2Uint8Kernel(kernel), queriesUint8, databaseUint8, dimension);
+
+  for(EMetricKernel kernel : {EMetricKernel::SCALAR, EMetricKernel::AVX2, EMetricKernel::AVX512})
+    benchmarkKernel("l2 float", kernel, getL2FloatKernel(kernel), queriesFloat, databaseFloat, dimension);
+
+  for(EMetricKernel kernel : {EMetricKernel::SCALAR, EMetricKernel::AVX2, EMetricKernel::AVX512})
+    benchmarkKernel("hamming", kernel, getHammingKernel(kernel), queriesBinary, databaseBinary, hammingSize);
+
+  return EXIT_SUCCESS;
+}
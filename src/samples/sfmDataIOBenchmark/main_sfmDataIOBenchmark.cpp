@@ -0,0 +1,227 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2020 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include <aliceVision/camera/camera.hpp>
+#include <aliceVision/sfmData/SfMData.hpp>
+#include <aliceVision/sfmDataIO/sfmDataIO.hpp>
+#include <aliceVision/sfmDataIO/jsonIO.hpp>
+#include <aliceVision/system/Logger.hpp>
+#include <aliceVision/system/Timer.hpp>
+
+#include <boost/filesystem.hpp>
+#include <boost/program_options.hpp>
+#include <boost/property_tree/json_parser.hpp>
+
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+// These constants define the current software version.
+// They must be updated when the command line is changed.
+#define ALICEVISION_SOFTWARE_VERSION_MAJOR 1
+#define ALICEVISION_SOFTWARE_VERSION_MINOR 0
+
+using namespace aliceVision;
+using namespace aliceVision::sfmDataIO;
+
+namespace po = boost::program_options;
+namespace fs = boost::filesystem;
+
+/**
+ * @brief Generate a synthetic scene: views with their poses and a shared intrinsic,
+ *        and landmarks observed by consecutive views.
+ */
+void generateScene(std::size_t nbViews, std::size_t nbLandmarks, std::size_t nbObservationsPerLandmark, sfmData::SfMData& sfmData)
+{
+  std::mt19937 gen(42);
+  std::uniform_real_distribution<double> dist(-10.0, 10.0);
+  std::uniform_int_distribution<std::size_t> distView(0, nbViews - 1);
+
+  sfmData.intrinsics[0] = std::make_shared<camera::PinholeRadialK3>(4000, 3000, 3500.0, 2000.0, 1500.0, 0.01, -0.001, 0.0001);
+
+  for(IndexT viewId = 0; viewId < nbViews; ++viewId)
+  {
+    const std::string path = "dataset/image_" + std::to_string(viewId) + ".jpg";
+    auto view = std::make_shared<sfmData::View>(path, viewId, 0, viewId, 4000, 3000);
+    view->addMetadata("Make", "Camera");
+    view->addMetadata("Model", "Model");
+    sfmData.views[viewId] = view;
+    sfmData.setPose(*view, sfmData::CameraPose(geometry::Pose3(Mat3::Identity(), Vec3(dist(gen), dist(gen), dist(gen)))));
+  }
+
+  for(IndexT landmarkId = 0; landmarkId < nbLandmarks; ++landmarkId)
+  {
+    sfmData::Landmark& landmark = sfmData.structure[landmarkId];
+    landmark.X = Vec3(dist(gen), dist(gen), dist(gen));
+    landmark.descType = feature::EImageDescriberType::SIFT;
+    landmark.rgb = image::RGBColor(landmarkId % 256, 128, 255 - landmarkId % 256);
+
+    const std::size_t firstView = distView(gen);
+    for(std::size_t o = 0; o < nbObservationsPerLandmark; ++o)
+    {
+      const IndexT viewId = static_cast<IndexT>((firstView + o) % nbViews);
+      landmark.observations[viewId] = sfmData::Observation(Vec2(4000.0 * (dist(gen) + 10.0) / 20.0, 3000.0 * (dist(gen) + 10.0) / 20.0), landmarkId, 1.0);
+    }
+  }
+}
+
+/**
+ * @brief Save a scene with a boost property tree containing the whole document (previous implementation)
+ */
+void savePropertyTree(const sfmData::SfMData& sfmData, const std::string& filename)
+{
+  bpt::ptree fileTree;
+  saveMatrix("version", Vec3(1, 0, 0), fileTree);
+
+  bpt::ptree viewsTree;
+  for(const auto& viewPair : sfmData.getViews())
+    saveView("", *(viewPair.second), viewsTree);
+  fileTree.add_child("views", viewsTree);
+
+  bpt::ptree intrinsicsTree;
+  for(const auto& intrinsicPair : sfmData.getIntrinsics())
+    saveIntrinsic("", intrinsicPair.first, intrinsicPair.second, intrinsicsTree);
+  fileTree.add_child("intrinsics", intrinsicsTree);
+
+  bpt::ptree posesTree;
+  for(const auto& posePair : sfmData.getPoses())
+  {
+    bpt::ptree poseTree;
+    poseTree.put("poseId", posePair.first);
+    saveCameraPose("pose", posePair.second, poseTree);
+    posesTree.push_back(std::make_pair("", poseTree));
+  }
+  fileTree.add_child("poses", posesTree);
+
+  bpt::ptree structureTree;
+  for(const auto& landmarkPair : sfmData.getLandmarks())
+    saveLandmark("", landmarkPair.first, landmarkPair.second, structureTree);
+  fileTree.add_child("structure", structureTree);
+
+  bpt::write_json(filename, fileTree);
+}
+
+/**
+ * @brief Load the structure of a scene with a boost property tree containing the whole document (previous implementation)
+ */
+void loadPropertyTree(sfmData::SfMData& sfmData, const std::string& filename)
+{
+  bpt::ptree fileTree;
+  bpt::read_json(filename, fileTree);
+
+  for(bpt::ptree::value_type& landmarkNode : fileTree.get_child("structure"))
+  {
+    IndexT landmarkId;
+    sfmData::Landmark landmark;
+    loadLandmark(landmarkId, landmark, landmarkNode.second);
+    sfmData.structure.emplace(landmarkId, landmark);
+  }
+}
+
+int main(int argc, char** argv)
+{
+  std::size_t nbViews = 1000;
+  std::size_t nbLandmarks = 1000000;
+  std::size_t nbObservationsPerLandmark = 4;
+  std::string outputFolder = fs::temp_directory_path().string();
+  bool compareWithPropertyTree = true;
+
+  po::options_description allParams("Benchmark of the SfMData JSON and binary serializations on a synthetic scene.\n"
+                                    "AliceVision Sample sfmDataIOBenchmark");
+  allParams.add_options()
+    ("help,h", "Print this message.")
+    ("nbViews", po::value<std::size_t>(&nbViews)->default_value(nbViews),
+      "Number of views.")
+    ("nbLandmarks", po::value<std::size_t>(&nbLandmarks)->default_value(nbLandmarks),
+      "Number of landmarks.")
+    ("nbObservationsPerLandmark", po::value<std::size_t>(&nbObservationsPerLandmark)->default_value(nbObservationsPerLandmark),
+      "Number of observations of each landmark.")
+    ("output,o", po::value<std::string>(&outputFolder)->default_value(outputFolder),
+      "Folder for the temporary SfMData files.")
+    ("compareWithPropertyTree", po::value<bool>(&compareWithPropertyTree)->default_value(compareWithPropertyTree),
+      "Also save and load the scene with a boost property tree containing the whole document.");
+
+  po::variables_map vm;
+  try
+  {
+    po::store(po::parse_command_line(argc, argv, allParams), vm);
+
+    if(vm.count("help"))
+    {
+      ALICEVISION_COUT(allParams);
+      return EXIT_SUCCESS;
+    }
+    po::notify(vm);
+  }
+  catch(boost::program_options::error& e)
+  {
+    ALICEVISION_CERR("ERROR: " << e.what());
+    ALICEVISION_COUT("Usage:\n\n" << allParams);
+    return EXIT_FAILURE;
+  }
+
+  if(nbViews == 0 || nbObservationsPerLandmark > nbViews)
+  {
+    ALICEVISION_CERR("ERROR: the number of observations per landmark must be lower than the number of views.");
+    return EXIT_FAILURE;
+  }
+
+  sfmData::SfMData sfmData;
+  generateScene(nbViews, nbLandmarks, nbObservationsPerLandmark, sfmData);
+  std::cout << "Synthetic scene: " << nbViews << " views, " << nbLandmarks << " landmarks, "
+            << nbLandmarks * nbObservationsPerLandmark << " observations" << std::endl;
+
+  const auto printResult = [](const std::string& name, double saveTime, double loadTime, const std::string& filename)
+  {
+    std::cout << std::setw(16) << name
+              << std::fixed << std::setprecision(3)
+              << "   save: " << saveTime << " s"
+              << "   load: " << loadTime << " s"
+              << "   file size: " << fs::file_size(filename) / (1024 * 1024) << " MB"
+              << std::endl;
+  };
+
+  // JSON stream and binary formats, through the generic Save/Load functions
+  for(const auto& format : std::vector<std::pair<std::string, std::string>>{{"stream", ".sfm"}, {"binary", ".sfmb"}, {"binaryCompressed", ".sfmbz"}})
+  {
+    const std::string filename = (fs::path(outputFolder) / ("sfmDataIOBenchmark_" + format.first + format.second)).string();
+
+    system::Timer timer;
+    if(!Save(sfmData, filename, ESfMData::ALL))
+      return EXIT_FAILURE;
+    const double saveTime = timer.elapsed();
+
+    timer.reset();
+    sfmData::SfMData sfmDataLoad;
+    if(!Load(sfmDataLoad, filename, ESfMData::ALL))
+      return EXIT_FAILURE;
+    printResult(format.first, saveTime, timer.elapsed(), filename);
+
+    fs::remove(filename);
+  }
+
+  if(compareWithPropertyTree)
+  {
+    const std::string propertyTreeFilename = (fs::path(outputFolder) / "sfmDataIOBenchmark_propertyTree.sfm").string();
+
+    system::Timer timer;
+    savePropertyTree(sfmData, propertyTreeFilename);
+    const double saveTime = timer.elapsed();
+
+    timer.reset();
+    sfmData::SfMData sfmDataLoad;
+    loadPropertyTree(sfmDataLoad, propertyTreeFilename);
+    printResult("property tree", saveTime, timer.elapsed(), propertyTreeFilename);
+
+    fs::remove(propertyTreeFilename);
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,136 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2020 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include <aliceVision/depthMap/cpu/sgm_aggregation_cpu.hpp>
+#include <aliceVision/system/cpu.hpp>
+#include <aliceVision/system/Logger.hpp>
+#include <aliceVision/system/Timer.hpp>
+
+#include <boost/program_options.hpp>
+
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+// These constants define the current software version.
+// They must be updated when the command line is changed.
+#define ALICEVISION_SOFTWARE_VERSION_MAJOR 1
+#define ALICEVISION_SOFTWARE_VERSION_MINOR 0
+
+using namespace aliceVision;
+using namespace aliceVision::depthMap;
+
+namespace po = boost::program_options;
+
+int main(int argc, char** argv)
+{
+  int width = 1024;
+  int height = 768;
+  int nbDepths = 256;
+  int nbRuns = 3;
+
+  po::options_description allParams("Microbenchmark of the SGM cost aggregation of the CPU depth map backend.\n"
+                                    "AliceVision Sample sgmAggregationBenchmark");
+  allParams.add_options()
+    ("help,h", "Print this message.")
+    ("width", po::value<int>(&width)->default_value(width),
+      "Width of the cost volume.")
+    ("height", po::value<int>(&height)->default_value(height),
+      "Height of the cost volume.")
+    ("nbDepths", po::value<int>(&nbDepths)->default_value(nbDepths),
+      "Number of depths of the cost volume.")
+    ("nbRuns", po::value<int>(&nbRuns)->default_value(nbRuns),
+      "Number of aggregations of each configuration, the best time is reported.");
+
+  po::variables_map vm;
+  try
+  {
+    po::store(po::parse_command_line(argc, argv, allParams), vm);
+
+    if(vm.count("help"))
+    {
+      ALICEVISION_COUT(allParams);
+      return EXIT_SUCCESS;
+    }
+    po::notify(vm);
+  }
+  catch(boost::program_options::error& e)
+  {
+    ALICEVISION_CERR("ERROR: " << e.what());
+    ALICEVISION_COUT("Usage:\n\n" << allParams);
+    return EXIT_FAILURE;
+  }
+
+  const system::CpuFeatures& cpu = system::get_cpu_features();
+  std::cout << "CPU features: avx2 " << cpu.avx2 << ", L2 cache: " << system::get_cache_size(2) / 1024 << " KB"
+            << std::endl;
+
+  const std::size_t nbVoxels = std::size_t(width) * std::size_t(height) * std::size_t(nbDepths);
+  const unsigned char P1 = 10;
+
+  // random costs and P2 in the range of the adaptive P2 of the depth map estimation
+  std::mt19937 gen(42);
+  std::uniform_int_distribution<int> distCost(0, 255);
+  std::uniform_int_distribution<int> distP2(15, 255);
+
+  std::vector<unsigned char> costs(nbVoxels);
+  for(auto& c : costs)
+    c = static_cast<unsigned char>(distCost(gen));
+  std::vector<unsigned char> P2(std::size_t(width) * std::size_t(height) * 8);
+  for(auto& p : P2)
+    p = static_cast<unsigned char>(distP2(gen));
+
+  std::vector<unsigned short> aggregated(nbVoxels);
+
+  std::cout << width << " x " << height << " x " << nbDepths << " volume" << std::endl;
+
+  for(const int nbPaths : {4, 8})
+  {
+    std::vector<unsigned short> reference;
+    for(const ESgmKernel kernel : {ESgmKernel::SCALAR, ESgmKernel::AVX2})
+    {
+      if(!sgm_cpu_isKernelSupported(kernel))
+      {
+        std::cout << std::setw(2) << nbPaths << " paths" << std::setw(8) << kernel << "   not supported" << std::endl;
+        continue;
+      }
+
+      // the P2 of the 4 first paths are the same with 4 or 8 paths
+      std::vector<unsigned char> pathsP2(std::size_t(width) * std::size_t(height) * nbPaths);
+      for(std::size_t i = 0; i < pathsP2.size(); ++i)
+        pathsP2[i] = P2[(i / nbPaths) * 8 + (i % nbPaths)];
+
+      double bestTime = 0.0;
+      for(int run = 0; run < nbRuns; ++run)
+      {
+        system::Timer timer;
+        sgm_cpu_aggregateCosts(costs.data(), pathsP2.data(), width, height, nbDepths, nbPaths, P1,
+                               aggregated.data(), kernel);
+        const double elapsed = timer.elapsed();
+        if(run == 0 || elapsed < bestTime)
+          bestTime = elapsed;
+      }
+
+      // all the kernels must give the same costs
+      bool identical = true;
+      if(reference.empty())
+        reference = aggregated;
+      else
+        identical = (reference == aggregated);
+
+      std::cout << std::setw(2) << nbPaths << " paths" << std::setw(8) << kernel
+                << std::setw(10) << std::fixed << std::setprecision(1)
+                << (double(nbVoxels) * nbPaths / bestTime) * 1e-9 << " Gupdates/s"
+                << std::setw(10) << std::setprecision(3) << bestTime << " s"
+                << (identical ? "" : "   (different from the scalar kernel)") << std::endl;
+    }
+  }
+
+  return EXIT_SUCCESS;
+}
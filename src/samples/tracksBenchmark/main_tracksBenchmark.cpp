@@ -0,0 +1,175 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2020 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include <aliceVision/track/TracksBuilder.hpp>
+#include <aliceVision/track/UnionFindTracksBuilder.hpp>
+#include <aliceVision/system/Logger.hpp>
+#include <aliceVision/system/Timer.hpp>
+
+#include <boost/program_options.hpp>
+
+#include <algorithm>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+// These constants define the current software version.
+// They must be updated when the command line is changed.
+#define ALICEVISION_SOFTWARE_VERSION_MAJOR 1
+#define ALICEVISION_SOFTWARE_VERSION_MINOR 0
+
+using namespace aliceVision;
+using namespace aliceVision::track;
+
+namespace po = boost::program_options;
+
+/**
+ * @brief Generate the matches of a synthetic sequence:
+ *        each point is seen by consecutive views and matched between the views closer than the window,
+ *        with a ratio of random outlier matches that create forks.
+ */
+void generateMatches(std::size_t nbViews,
+                     std::size_t nbPointsPerView,
+                     std::size_t maxTrackLength,
+                     std::size_t window,
+                     double outlierRatio,
+                     PairwiseMatches& pairwiseMatches)
+{
+  std::mt19937 gen(42);
+  std::uniform_int_distribution<std::size_t> distLength(2, std::max<std::size_t>(2, maxTrackLength));
+  std::uniform_real_distribution<double> distOutlier(0.0, 1.0);
+
+  // feature index of each point in each view, points are created until each view has enough features
+  std::vector<IndexT> nbFeatures(nbViews, 0);
+  std::vector<std::vector<std::pair<IndexT, IndexT>>> observationsPerPoint;
+  for(std::size_t firstView = 0; firstView < nbViews; ++firstView)
+  {
+    while(nbFeatures[firstView] < nbPointsPerView)
+    {
+      const std::size_t lastView = std::min(nbViews, firstView + distLength(gen));
+      std::vector<std::pair<IndexT, IndexT>> observations;
+      for(std::size_t v = firstView; v < lastView; ++v)
+        observations.emplace_back(v, nbFeatures[v]++);
+      observationsPerPoint.push_back(std::move(observations));
+    }
+  }
+
+  for(const auto& observations : observationsPerPoint)
+  {
+    for(std::size_t a = 0; a < observations.size(); ++a)
+    {
+      for(std::size_t b = a + 1; b < observations.size() && b <= a + window; ++b)
+      {
+        const IndexT I = observations[a].first;
+        const IndexT J = observations[b].first;
+        IndexT featJ = observations[b].second;
+        if(distOutlier(gen) < outlierRatio)
+          featJ = std::uniform_int_distribution<IndexT>(0, nbFeatures[J] - 1)(gen);
+        pairwiseMatches[std::make_pair(I, J)][feature::EImageDescriberType::SIFT].emplace_back(observations[a].second, featJ);
+      }
+    }
+  }
+}
+
+int main(int argc, char** argv)
+{
+  std::size_t nbViews = 500;
+  std::size_t nbPointsPerView = 5000;
+  std::size_t maxTrackLength = 8;
+  std::size_t window = 5;
+  double outlierRatio = 0.02;
+  bool compareWithLemon = true;
+
+  po::options_description allParams("Benchmark of the tracks building from synthetic matches (TracksBuilder and UnionFindTracksBuilder).\n"
+                                    "AliceVision Sample tracksBenchmark");
+  allParams.add_options()
+    ("help,h", "Print this message.")
+    ("nbViews", po::value<std::size_t>(&nbViews)->default_value(nbViews),
+      "Number of views.")
+    ("nbPointsPerView", po::value<std::size_t>(&nbPointsPerView)->default_value(nbPointsPerView),
+      "Number of features per view.")
+    ("maxTrackLength", po::value<std::size_t>(&maxTrackLength)->default_value(maxTrackLength),
+      "Maximum number of consecutive views observing a point.")
+    ("window", po::value<std::size_t>(&window)->default_value(window),
+      "Views are matched with their next views in this window.")
+    ("outlierRatio", po::value<double>(&outlierRatio)->default_value(outlierRatio),
+      "Ratio of wrong matches.")
+    ("compareWithLemon", po::value<bool>(&compareWithLemon)->default_value(compareWithLemon),
+      "Also run the TracksBuilder based on lemon.");
+
+  po::variables_map vm;
+  try
+  {
+    po::store(po::parse_command_line(argc, argv, allParams), vm);
+
+    if(vm.count("help"))
+    {
+      ALICEVISION_COUT(allParams);
+      return EXIT_SUCCESS;
+    }
+    po::notify(vm);
+  }
+  catch(boost::program_options::error& e)
+  {
+    ALICEVISION_CERR("ERROR: " << e.what());
+    ALICEVISION_COUT("Usage:\n\n" << allParams);
+    return EXIT_FAILURE;
+  }
+
+  PairwiseMatches pairwiseMatches;
+  generateMatches(nbViews, nbPointsPerView, maxTrackLength, window, outlierRatio, pairwiseMatches);
+
+  std::size_t nbMatches = 0;
+  for(const auto& pairIt : pairwiseMatches)
+    for(const auto& descIt : pairIt.second)
+      nbMatches += descIt.second.size();
+  std::cout << "Synthetic matches: " << pairwiseMatches.size() << " pairs, " << nbMatches << " matches" << std::endl;
+
+  const auto printResult = [](const std::string& name, double buildTime, double filterTime, double exportTime,
+                              std::size_t nbTracks)
+  {
+    std::cout << std::setw(24) << name
+              << std::fixed << std::setprecision(3)
+              << "   build: " << buildTime << " s"
+              << "   filter: " << filterTime << " s"
+              << "   export: " << exportTime << " s"
+              << "   tracks: " << nbTracks
+              << std::endl;
+  };
+
+  if(compareWithLemon)
+  {
+    TracksBuilder tracksBuilder;
+    system::Timer timer;
+    tracksBuilder.build(pairwiseMatches);
+    const double buildTime = timer.elapsed();
+    timer.reset();
+    tracksBuilder.filter(true, 2);
+    const double filterTime = timer.elapsed();
+    timer.reset();
+    TracksMap tracks;
+    tracksBuilder.exportToSTL(tracks);
+    printResult("TracksBuilder", buildTime, filterTime, timer.elapsed(), tracks.size());
+  }
+  {
+    UnionFindTracksBuilder tracksBuilder;
+    system::Timer timer;
+    tracksBuilder.build(pairwiseMatches);
+    const double buildTime = timer.elapsed();
+    timer.reset();
+    tracksBuilder.filter(true, 2);
+    const double filterTime = timer.elapsed();
+    timer.reset();
+    TracksMap tracks;
+    tracksBuilder.exportToSTL(tracks);
+    printResult("UnionFindTracksBuilder", buildTime, filterTime, timer.elapsed(), tracks.size());
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,178 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2020 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include <aliceVision/voctree/Database.hpp>
+#include <aliceVision/system/Logger.hpp>
+#include <aliceVision/system/Timer.hpp>
+
+#include <boost/program_options.hpp>
+
+#include <algorithm>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+// These constants define the current software version.
+// They must be updated when the command line is changed.
+#define ALICEVISION_SOFTWARE_VERSION_MAJOR 1
+#define ALICEVISION_SOFTWARE_VERSION_MINOR 0
+
+using namespace aliceVision;
+using namespace aliceVision::voctree;
+
+namespace po = boost::program_options;
+
+/**
+ * @brief Generate a document with a skewed word distribution:
+ *        the first words of the vocabulary are more frequent, as the common visual words.
+ */
+void generateDocument(std::mt19937& gen, std::size_t vocabularySize, std::size_t nbFeatures, SparseHistogram& histogram)
+{
+  std::uniform_real_distribution<double> dist(0.0, 1.0);
+  std::vector<Word> document(nbFeatures);
+  for(Word& word : document)
+  {
+    const double u = dist(gen);
+    word = static_cast<Word>(std::min<double>(vocabularySize - 1, u * u * vocabularySize));
+  }
+  computeSparseHistogram(document, histogram);
+}
+
+/**
+ * @brief Reference search: distance to all the documents of the database.
+ */
+void findExhaustive(const Database& db, const SparseHistogram& query, std::size_t N, const std::string& distanceMethod,
+                    const std::vector<float>& weights, std::vector<DocMatch>& matches)
+{
+  matches.clear();
+  for(const auto& document : db.getSparseHistogramPerImage())
+    matches.emplace_back(document.first, sparseDistance(query, document.second, distanceMethod, weights));
+
+  const auto isBetter = [](const DocMatch& a, const DocMatch& b)
+  {
+    return a.score < b.score || (a.score == b.score && a.id < b.id);
+  };
+  N = std::min(N, matches.size());
+  std::partial_sort(matches.begin(), matches.begin() + N, matches.end(), isBetter);
+  matches.resize(N);
+}
+
+int main(int argc, char** argv)
+{
+  std::vector<std::size_t> nbDocumentsList = {10000, 50000, 100000};
+  std::size_t vocabularySize = 1000000;
+  std::size_t nbFeaturesPerDocument = 200;
+  std::size_t nbQueries = 100;
+  std::size_t nbMatches = 50;
+  std::string distanceMethod = "strongCommonPoints";
+  bool exhaustive = true;
+
+  po::options_description allParams("Benchmark of the queries of a vocabulary tree database with the inverted files and with the exhaustive search.\n"
+                                    "AliceVision Sample voctreeDatabaseBenchmark");
+  allParams.add_options()
+    ("help,h", "Print this message.")
+    ("nbDocuments", po::value<std::vector<std::size_t>>(&nbDocumentsList)->multitoken()->default_value(nbDocumentsList, "10000 50000 100000"),
+      "Number(s) of documents in the database.")
+    ("vocabularySize", po::value<std::size_t>(&vocabularySize)->default_value(vocabularySize),
+      "Number of words of the vocabulary.")
+    ("nbFeaturesPerDocument", po::value<std::size_t>(&nbFeaturesPerDocument)->default_value(nbFeaturesPerDocument),
+      "Number of features (possibly repeated words) of each document.")
+    ("nbQueries", po::value<std::size_t>(&nbQueries)->default_value(nbQueries),
+      "Number of queries.")
+    ("nbMatches", po::value<std::size_t>(&nbMatches)->default_value(nbMatches),
+      "Number of matches of each query.")
+    ("distanceMethod", po::value<std::string>(&distanceMethod)->default_value(distanceMethod),
+      "Distance method: classic, commonPoints, strongCommonPoints, weightedStrongCommonPoints or inversedWeightedCommonPoints.")
+    ("exhaustive", po::value<bool>(&exhaustive)->default_value(exhaustive),
+      "Compare with the exhaustive search.");
+
+  po::variables_map vm;
+  try
+  {
+    po::store(po::parse_command_line(argc, argv, allParams), vm);
+
+    if(vm.count("help"))
+    {
+      ALICEVISION_COUT(allParams);
+      return EXIT_SUCCESS;
+    }
+    po::notify(vm);
+  }
+  catch(boost::program_options::error& e)
+  {
+    ALICEVISION_CERR("ERROR: " << e.what());
+    ALICEVISION_COUT("Usage:\n\n" << allParams);
+    return EXIT_FAILURE;
+  }
+
+  if(vocabularySize == 0 || nbQueries == 0)
+  {
+    ALICEVISION_CERR("ERROR: the vocabulary size and the number of queries must be positive.");
+    return EXIT_FAILURE;
+  }
+
+  for(const std::size_t nbDocuments : nbDocumentsList)
+  {
+    std::mt19937 gen(42);
+    system::Timer timer;
+
+    Database db(vocabularySize);
+    std::vector<SparseHistogram> queries;
+    for(std::size_t i = 0; i < nbDocuments; ++i)
+    {
+      SparseHistogram histogram;
+      generateDocument(gen, vocabularySize, nbFeaturesPerDocument, histogram);
+      // query the first documents of the database
+      if(queries.size() < nbQueries)
+        queries.push_back(histogram);
+      db.insert(static_cast<DocId>(i), histogram);
+    }
+    db.computeTfIdfWeights();
+    std::cout << nbDocuments << " documents, database creation: " << timer.elapsed() << " s" << std::endl;
+
+    std::vector<std::vector<DocMatch>> matches(queries.size());
+    timer.reset();
+    for(std::size_t q = 0; q < queries.size(); ++q)
+      db.find(queries[q], nbMatches, matches[q], distanceMethod);
+    const double invertedFileTime = timer.elapsed() / queries.size();
+
+    std::cout << std::fixed << std::setprecision(6)
+              << "  inverted files: " << invertedFileTime << " s per query" << std::endl;
+
+    if(!exhaustive)
+      continue;
+
+    // same weights as computeTfIdfWeights
+    std::vector<std::size_t> nbDocumentsPerWord(vocabularySize, 0);
+    for(const auto& document : db.getSparseHistogramPerImage())
+      for(const auto& word : document.second)
+        ++nbDocumentsPerWord[word.first];
+    std::vector<float> weights(vocabularySize, 1.0f);
+    for(std::size_t w = 0; w < vocabularySize; ++w)
+      if(nbDocumentsPerWord[w] != 0)
+        weights[w] = std::log(static_cast<float>(nbDocuments) / nbDocumentsPerWord[w]);
+
+    std::size_t nbDifferences = 0;
+    timer.reset();
+    for(std::size_t q = 0; q < queries.size(); ++q)
+    {
+      std::vector<DocMatch> exhaustiveMatches;
+      findExhaustive(db, queries[q], nbMatches, distanceMethod, weights, exhaustiveMatches);
+      if(exhaustiveMatches != matches[q])
+        ++nbDifferences;
+    }
+    const double exhaustiveTime = timer.elapsed() / queries.size();
+
+    std::cout << "  exhaustive:     " << exhaustiveTime << " s per query"
+              << std::setprecision(1) << " (speedup x" << exhaustiveTime / invertedFileTime << ", "
+              << nbDifferences << " different results)" << std::endl;
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,149 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2020 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include <aliceVision/feature/PointFeature.hpp>
+#include <aliceVision/system/Logger.hpp>
+#include <aliceVision/system/cmdline.hpp>
+#include <aliceVision/system/main.hpp>
+
+#include <boost/filesystem.hpp>
+#include <boost/program_options.hpp>
+#include <boost/algorithm/string/case_conv.hpp>
+
+#include <cstdlib>
+
+// These constants define the current software version.
+// They must be updated when the command line is changed.
+#define ALICEVISION_SOFTWARE_VERSION_MAJOR 1
+#define ALICEVISION_SOFTWARE_VERSION_MINOR 0
+
+using namespace aliceVision;
+
+namespace po = boost::program_options;
+namespace fs = boost::filesystem;
+
+int aliceVision_main(int argc, char** argv)
+{
+  // command-line parameters
+
+  std::string verboseLevel = system::EVerboseLevel_enumToString(system::Logger::getDefaultVerboseLevel());
+  std::string inputFolder;
+  std::string outputFolder;
+  feature::EFeatureFileType featureFileType = feature::EFeatureFileType::BINARY;
+  bool copyDescriptors = true;
+
+  po::options_description allParams("This program is used to convert features files (*.feat) between text and binary storage.\n"
+                                    "Text and binary features files can be read transparently by all AliceVision softwares.\n"
+                                    "AliceVision convertFeatures");
+
+  po::options_description requiredParams("Required parameters");
+  requiredParams.add_options()
+    ("input,i", po::value<std::string>(&inputFolder)->required(),
+      "Input folder containing the features files (*.feat, *.desc).")
+    ("output,o", po::value<std::string>(&outputFolder)->required(),
+      "Output folder for the converted features files.");
+
+  po::options_description optionalParams("Optional parameters");
+  optionalParams.add_options()
+    ("featuresFileType", po::value<feature::EFeatureFileType>(&featureFileType)->default_value(featureFileType),
+      "Storage type of the output features files (text, binary).")
+    ("copyDescriptors", po::value<bool>(&copyDescriptors)->default_value(copyDescriptors),
+      "Copy the descriptors files (*.desc) into the output folder.");
+
+  po::options_description logParams("Log parameters");
+  logParams.add_options()
+    ("verboseLevel,v", po::value<std::string>(&verboseLevel)->default_value(verboseLevel),
+      "verbosity level (fatal, error, warning, info, debug, trace).");
+
+  allParams.add(requiredParams).add(optionalParams).add(logParams);
+
+  po::variables_map vm;
+  try
+  {
+    po::store(po::parse_command_line(argc, argv, allParams), vm);
+
+    if(vm.count("help") || (argc == 1))
+    {
+      ALICEVISION_COUT(allParams);
+      return EXIT_SUCCESS;
+    }
+    po::notify(vm);
+  }
+  catch(boost::program_options::required_option& e)
+  {
+    ALICEVISION_CERR("ERROR: " << e.what());
+    ALICEVISION_COUT("Usage:\n\n" << allParams);
+    return EXIT_FAILURE;
+  }
+  catch(boost::program_options::error& e)
+  {
+    ALICEVISION_CERR("ERROR: " << e.what());
+    ALICEVISION_COUT("Usage:\n\n" << allParams);
+    return EXIT_FAILURE;
+  }
+
+  ALICEVISION_COUT("Program called with the following parameters:");
+  ALICEVISION_COUT(vm);
+
+  // set verbose level
+  system::Logger::get()->setLogLevel(verboseLevel);
+
+  if(!(fs::exists(inputFolder) && fs::is_directory(inputFolder)))
+  {
+    ALICEVISION_LOG_ERROR(inputFolder << " does not exists or it is not a folder");
+    return EXIT_FAILURE;
+  }
+
+  if(fs::exists(outputFolder) && fs::equivalent(inputFolder, outputFolder))
+  {
+    ALICEVISION_LOG_ERROR("Input and output folders must be different");
+    return EXIT_FAILURE;
+  }
+
+  // if the folder does not exist create it (recursively)
+  if(!fs::exists(outputFolder))
+    fs::create_directories(outputFolder);
+
+  std::size_t countFeat = 0;
+  std::size_t countDesc = 0;
+
+  for(fs::directory_iterator it(inputFolder); it != fs::directory_iterator(); ++it)
+  {
+    std::string ext = it->path().extension().string();
+    boost::to_lower(ext);
+
+    const fs::path outputPath = fs::path(outputFolder) / it->path().filename();
+
+    if(ext == ".feat")
+    {
+      feature::PointFeatures features;
+
+      try
+      {
+        feature::loadFeatsFromFile(it->path().string(), features);
+        feature::saveFeatsToFile(outputPath.string(), features, featureFileType);
+      }
+      catch(const std::exception& e)
+      {
+        ALICEVISION_LOG_ERROR("Cannot convert features file '" << it->path().string() << "': " << e.what());
+        return EXIT_FAILURE;
+      }
+
+      ALICEVISION_LOG_TRACE(features.size() << " features converted from '" << it->path().filename().string() << "'");
+      ++countFeat;
+    }
+    else if(ext == ".desc" && copyDescriptors)
+    {
+      // descriptors files are already binary, just copy them
+      fs::copy_file(it->path(), outputPath, fs::copy_option::overwrite_if_exists);
+      ++countDesc;
+    }
+  }
+
+  ALICEVISION_LOG_INFO("Converted " << countFeat << " files .feat to " << featureFileType << " and copied " << countDesc << " files .desc");
+
+  return EXIT_SUCCESS;
+}
@@ -8,6 +8,7 @@
 #include <aliceVision/sfmDataIO/sfmDataIO.hpp>
 #include <aliceVision/depthMap/RefineRc.hpp>
 #include <aliceVision/depthMap/SemiGlobalMatchingRc.hpp>
+#include <aliceVision/mvsData/imageIO.hpp>
 #include <aliceVision/mvsData/StaticVector.hpp>
 #include <aliceVision/mvsUtils/common.hpp>
 #include <aliceVision/mvsUtils/MultiViewParams.hpp>
@@ -23,7 +24,7 @@
 // These constants define the current software version.
 // They must be updated when the command line is changed.
 #define ALICEVISION_SOFTWARE_VERSION_MAJOR 2
-#define ALICEVISION_SOFTWARE_VERSION_MINOR 0
+#define ALICEVISION_SOFTWARE_VERSION_MINOR 2
 
 using namespace aliceVision;
 
@@ -72,6 +73,12 @@ int aliceVision_main(int argc, char* argv[])
     // number of GPUs to use (0 means use all GPUs)
     int nbGPUs = 0;
 
+    // plane sweeping implementation
+    depthMap::EDepthMapBackend backend = depthMap::EDepthMapBackend::AUTO;
+
+    // storage of the output depth/sim maps
+    imageIO::EMapStorage mapStorage = imageIO::EMapStorage::SCANLINE;
+
     po::options_description allParams("AliceVision depthMapEstimation\n"
                                       "Estimate depth map for each input image");
 
@@ -125,7 +132,12 @@ int aliceVision_main(int argc, char* argv[])
         ("exportIntermediateResults", po::value<bool>(&exportIntermediateResults)->default_value(exportIntermediateResults),
             "Export intermediate results from the SGM and Refine steps.")
         ("nbGPUs", po::value<int>(&nbGPUs)->default_value(nbGPUs),
-            "Number of GPUs to use (0 means use all GPUs).");
+            "Number of GPUs to use (0 means use all GPUs).")
+        ("backend", po::value<depthMap::EDepthMapBackend>(&backend)->default_value(backend),
+            "Plane sweeping implementation: auto (CUDA if a compatible GPU is available, CPU otherwise), cuda or cpu.")
+        ("mapStorage", po::value<imageIO::EMapStorage>(&mapStorage)->default_value(mapStorage),
+            "Storage of the output depth/sim maps: scanline, tiled (lossless, can be read by regions) "
+            "or tiledHalf (also stores the depths as half floats, 2x smaller).");
 
     po::options_description logParams("Log parameters");
     logParams.add_options()
@@ -171,9 +183,9 @@ int aliceVision_main(int argc, char* argv[])
     ALICEVISION_LOG_INFO(gpu::gpuInformationCUDA());
 
     // check if the gpu suppport CUDA compute capability 2.0
-    if(!gpu::gpuSupportCUDA(2,0))
+    if(backend == depthMap::EDepthMapBackend::CUDA && !gpu::gpuSupportCUDA(2,0))
     {
-      ALICEVISION_LOG_ERROR("This program needs a CUDA-Enabled GPU (with at least compute capability 2.0).");
+      ALICEVISION_LOG_ERROR("The CUDA backend needs a CUDA-Enabled GPU (with at least compute capability 2.0).");
       return EXIT_FAILURE;
     }
 
@@ -220,6 +232,9 @@ int aliceVision_main(int argc, char* argv[])
     // intermediate results
     mp.userParams.put("depthMap.intermediateResults", exportIntermediateResults);
 
+    // output depth/sim maps storage
+    mp.userParams.put("depthMap.mapStorage", imageIO::EMapStorage_enumToString(mapStorage));
+
     std::vector<int> cams;
     cams.reserve(mp.ncams);
     if(rangeSize == -1)
@@ -245,7 +260,7 @@ int aliceVision_main(int argc, char* argv[])
 
     ALICEVISION_LOG_INFO("Create depth maps.");
 
-    depthMap::estimateAndRefineDepthMaps(&mp, cams, nbGPUs);
+    depthMap::estimateAndRefineDepthMaps(&mp, cams, nbGPUs, backend);
 
     ALICEVISION_LOG_INFO("Task done in (s): " + std::to_string(timer.elapsed()));
     return EXIT_SUCCESS;
@@ -7,6 +7,7 @@
 #include <aliceVision/sfmData/SfMData.hpp>
 #include <aliceVision/sfmDataIO/sfmDataIO.hpp>
 #include <aliceVision/fuseCut/Fuser.hpp>
+#include <aliceVision/mvsData/imageIO.hpp>
 #include <aliceVision/mvsData/StaticVector.hpp>
 #include <aliceVision/mvsUtils/common.hpp>
 #include <aliceVision/mvsUtils/MultiViewParams.hpp>
@@ -23,7 +24,7 @@
 // These constants define the current software version.
 // They must be updated when the command line is changed.
 #define ALICEVISION_SOFTWARE_VERSION_MAJOR 2
-#define ALICEVISION_SOFTWARE_VERSION_MINOR 0
+#define ALICEVISION_SOFTWARE_VERSION_MINOR 2
 
 using namespace aliceVision;
 
@@ -52,6 +53,8 @@ int aliceVision_main(int argc, char* argv[])
     int pixSizeBallWithLowSimilarity = 0;
     int nNearestCams = 10;
     bool computeNormalMaps = false;
+    int depthMapsCacheSize = 0;
+    imageIO::EMapStorage mapStorage = imageIO::EMapStorage::SCANLINE;
 
     po::options_description allParams("AliceVision depthMapFiltering\n"
                                       "Filter depth map to remove values that are not consistent with other depth maps");
@@ -86,7 +89,13 @@ int aliceVision_main(int argc, char* argv[])
         ("nNearestCams", po::value<int>(&nNearestCams)->default_value(nNearestCams),
             "Number of nearest cameras.")
         ("computeNormalMaps", po::value<bool>(&computeNormalMaps)->default_value(computeNormalMaps),
-            "Compute normal maps per depth map");
+            "Compute normal maps per depth map")
+        ("depthMapsCacheSize", po::value<int>(&depthMapsCacheSize)->default_value(depthMapsCacheSize),
+            "Maximum size (in MB) of the cache of the depth/sim maps shared by the cameras filtered in parallel, "
+            "0 for half of the free memory.")
+        ("mapStorage", po::value<imageIO::EMapStorage>(&mapStorage)->default_value(mapStorage),
+            "Storage of the output depth/sim maps: scanline, tiled (lossless, can be read by regions) "
+            "or tiledHalf (also stores the depths as half floats, 2x smaller).");
 
     po::options_description logParams("Log parameters");
     logParams.add_options()
@@ -141,6 +150,7 @@ int aliceVision_main(int argc, char* argv[])
 
     mp.setMinViewAngle(minViewAngle);
     mp.setMaxViewAngle(maxViewAngle);
+    mp.userParams.put("depthMap.mapStorage", imageIO::EMapStorage_enumToString(mapStorage));
 
     StaticVector<int> cams;
     cams.reserve(mp.ncams);
@@ -169,7 +179,7 @@ int aliceVision_main(int argc, char* argv[])
     ALICEVISION_LOG_INFO("Filter depth maps.");
 
     {
-        fuseCut::Fuser fs(&mp);
+        fuseCut::Fuser fs(&mp, std::size_t(std::max(depthMapsCacheSize, 0)) * 1024 * 1024);
         fs.filterGroups(cams, pixSizeBall, pixSizeBallWithLowSimilarity, nNearestCams);
         fs.filterDepthMaps(cams, minNumOfConsistentCams, minNumOfConsistentCamsWithLowSimilarity);
     }
@@ -38,7 +38,7 @@
 // These constants define the current software version.
 // They must be updated when the command line is changed.
 #define ALICEVISION_SOFTWARE_VERSION_MAJOR 1
-#define ALICEVISION_SOFTWARE_VERSION_MINOR 0
+#define ALICEVISION_SOFTWARE_VERSION_MINOR 1
 
 using namespace aliceVision;
 
@@ -275,6 +275,7 @@ int aliceVision_main(int argc, char **argv)
   int rangeSize = 1;
   int maxThreads = 0;
   bool forceCpuExtraction = false;
+  feature::EFeatureFileType featureFileType = feature::EFeatureFileType::TEXT;
 
   po::options_description allParams("AliceVision featureExtraction");
 
@@ -294,6 +295,10 @@ int aliceVision_main(int argc, char **argv)
       "Configuration 'ultra' can take long time !")
     ("forceCpuExtraction", po::value<bool>(&forceCpuExtraction)->default_value(forceCpuExtraction),
       "Use only CPU feature extraction methods.")
+    ("featuresFileType", po::value<feature::EFeatureFileType>(&featureFileType)->default_value(featureFileType),
+      "Storage type of the features files (*.feat):\n"
+      "* text: human readable, compatible with older versions\n"
+      "* binary: compact and fast to load")
     ("rangeStart", po::value<int>(&rangeStart)->default_value(rangeStart),
       "Range image index start.")
     ("rangeSize", po::value<int>(&rangeSize)->default_value(rangeSize),
@@ -401,6 +406,7 @@ int aliceVision_main(int argc, char **argv)
       imageDescriber->setConfigurationPreset(describerPreset);
       if(forceCpuExtraction)
         imageDescriber->setUseCuda(false);
+      imageDescriber->setFeatureFileType(featureFileType);
 
       extractor.addImageDescriber(imageDescriber);
     }
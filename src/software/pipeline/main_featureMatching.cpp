@@ -23,6 +23,7 @@
 #include <aliceVision/matchingImageCollection/GeometricFilterMatrix_H_AC.hpp>
 #include <aliceVision/matchingImageCollection/GeometricFilterMatrix_HGrowing.hpp>
 #include <aliceVision/matchingImageCollection/GeometricFilterType.hpp>
+#include <aliceVision/matchingImageCollection/matchingPipeline.hpp>
 #include <aliceVision/matching/pairwiseAdjacencyDisplay.hpp>
 #include <aliceVision/matching/io.hpp>
 #include <aliceVision/system/main.hpp>
@@ -35,14 +36,18 @@
 #include <boost/program_options.hpp>
 #include <boost/filesystem.hpp>
 
+#include <algorithm>
 #include <cstdlib>
 #include <fstream>
 #include <cctype>
+#include <iterator>
+#include <map>
+#include <random>
 
 // These constants define the current software version.
 // They must be updated when the command line is changed.
 #define ALICEVISION_SOFTWARE_VERSION_MAJOR 2
-#define ALICEVISION_SOFTWARE_VERSION_MINOR 0
+#define ALICEVISION_SOFTWARE_VERSION_MINOR 5
 
 using namespace aliceVision;
 using namespace aliceVision::camera;
@@ -111,12 +116,19 @@ int aliceVision_main(int argc, char **argv)
   bool savePutativeMatches = false;
   bool guidedMatching = false;
   int maxIteration = 2048;
+  robustEstimation::ACRansacOptions acRansacOptions;
+  int acRansacParallelHypotheses = 1;
+  int randomSeed = std::mt19937::default_seed;
   bool matchFilePerImage = false;
   size_t numMatchesToKeep = 0;
   bool useGridSort = true;
   bool exportDebugFiles = false;
   bool matchFromKnownCameraPoses = false;
-  const std::string fileExtension = "txt";
+  int regionsMemoryBudget = 0;
+  bool saveHashedRegions = false;
+  std::string fileExtension = "txt";
+  int pipelineChunkSize = 0;
+  int pipelineQueueSize = 2;
 
   po::options_description allParams(
      "Compute corresponding features between a series of views:\n"
@@ -175,12 +187,41 @@ int aliceVision_main(int argc, char **argv)
       "Distance ratio to discard non meaningful matches.")
     ("maxIteration", po::value<int>(&maxIteration)->default_value(maxIteration),
       "Maximum number of iterations allowed in ransac step.")
+    ("acRansacEarlyRejection", po::value<bool>(&acRansacOptions.earlyRejection)->default_value(acRansacOptions.earlyRejection),
+      "ACRansac only: reject the clearly bad models before computing all their residuals (sequential probability ratio test). "
+      "Faster, but a good model can be rejected with a low probability.")
+    ("acRansacSprtDelta", po::value<double>(&acRansacOptions.sprtDelta)->default_value(acRansacOptions.sprtDelta),
+      "ACRansac early rejection: initial probability of a match to be consistent with a bad model.")
+    ("acRansacSprtModelCost", po::value<double>(&acRansacOptions.sprtModelCost)->default_value(acRansacOptions.sprtModelCost),
+      "ACRansac early rejection: cost of the estimation of the models of a sample, in number of residual evaluations.")
+    ("acRansacParallelHypotheses", po::value<int>(&acRansacParallelHypotheses)->default_value(acRansacParallelHypotheses),
+      "ACRansac only: number of samples whose models are evaluated in parallel.")
+    ("randomSeed", po::value<int>(&randomSeed)->default_value(randomSeed),
+      "ACRansac: seed of the random generators. Each image pair uses its own seed derived from this value and "
+      "from its view ids. Set -1 to use a random seed.")
     ("useGridSort", po::value<bool>(&useGridSort)->default_value(useGridSort),
       "Use matching grid sort.")
     ("exportDebugFiles", po::value<bool>(&exportDebugFiles)->default_value(exportDebugFiles),
       "Export debug files (svg, dot).")
     ("maxMatches", po::value<std::size_t>(&numMatchesToKeep)->default_value(numMatchesToKeep),
       "Maximum number pf matches to keep.")
+    ("regionsMemoryBudget", po::value<int>(&regionsMemoryBudget)->default_value(regionsMemoryBudget),
+      "Maximum amount of memory (in MB) used to keep descriptors in memory during the putative matching. "
+      "Descriptors are then loaded on demand and the least recently used ones are released. "
+      "If set to 0, all the descriptors are loaded before the matching.")
+    ("saveHashedRegions", po::value<bool>(&saveHashedRegions)->default_value(saveHashedRegions),
+      "FAST_CASCADE_HASHING_L2 only: save the hashed regions of each view next to its descriptors file (*.chash) "
+      "and reuse them in the next runs, so the hashing is only computed once when the matching is split in chunks (rangeStart/rangeSize).")
+    ("matchesFileType", po::value<std::string>(&fileExtension)->default_value(fileExtension),
+      "Storage type of the output match files: txt (text) or bin (binary, compact and faster to load). "
+      "Both can be read by the next steps of the pipeline.")
+    ("pipelineChunkSize", po::value<int>(&pipelineChunkSize)->default_value(pipelineChunkSize),
+      "Number of image pairs per chunk when the putative matching and the geometric filtering are pipelined. "
+      "The putative matches of the next chunks are computed while the current chunk is filtered and saved, "
+      "so only the putative matches of a few chunks are kept in memory. "
+      "If set to 0, all the putative matches are computed before the geometric filtering.")
+    ("pipelineQueueSize", po::value<int>(&pipelineQueueSize)->default_value(pipelineQueueSize),
+      "Maximum number of chunks of putative matches waiting for the geometric filtering (see pipelineChunkSize).")
     ("rangeStart", po::value<int>(&rangeStart)->default_value(rangeStart),
       "Range image index start.")
     ("rangeSize", po::value<int>(&rangeSize)->default_value(rangeSize),
@@ -218,6 +259,20 @@ int aliceVision_main(int argc, char **argv)
     return EXIT_FAILURE;
   }
 
+  if(acRansacParallelHypotheses < 1)
+  {
+    ALICEVISION_LOG_ERROR("Invalid number of ACRansac parallel hypotheses: " << acRansacParallelHypotheses);
+    return EXIT_FAILURE;
+  }
+  acRansacOptions.nbParallelHypotheses = acRansacParallelHypotheses;
+  acRansacOptions.randomSeed = randomSeed;
+
+  if(fileExtension != "txt" && fileExtension != "bin")
+  {
+    ALICEVISION_LOG_ERROR("Invalid matches file type: " << fileExtension << " (expected txt or bin).");
+    return EXIT_FAILURE;
+  }
+
   const double defaultLoRansacMatchingError = 20.0;
   if(!adjustRobustEstimatorThreshold(geometricEstimator, geometricErrorMax, defaultLoRansacMatchingError))
     return EXIT_FAILURE;
@@ -296,99 +351,61 @@ int aliceVision_main(int argc, char **argv)
     filter.insert(pair.second);
   }
 
-  PairwiseMatches mapPutativesMatches;
-
   // allocate the right Matcher according the Matching requested method
   EMatcherType collectionMatcherType = EMatcherType_stringToEnum(nearestMatchingMethod);
   std::unique_ptr<IImageCollectionMatcher> imageCollectionMatcher = createImageCollectionMatcher(collectionMatcherType, distRatio);
 
   const std::vector<feature::EImageDescriberType> describerTypes = feature::EImageDescriberType_stringToEnums(describerTypesName);
 
-  ALICEVISION_LOG_INFO("There are " << sfmData.getViews().size() << " views and " << pairs.size() << " image pairs.");
-
-  ALICEVISION_LOG_INFO("Load features and descriptors");
-
-  // load the corresponding view regions
-  RegionsPerView regionPerView;
-  if(!sfm::loadRegionsPerView(regionPerView, sfmData, featuresFolders, describerTypes, filter))
+  if(saveHashedRegions)
   {
-    ALICEVISION_LOG_ERROR("Invalid regions in '" + sfmDataFilename + "'");
-    return EXIT_FAILURE;
+    ImageCollectionMatcher_cascadeHashing* cascadeHashingMatcher = dynamic_cast<ImageCollectionMatcher_cascadeHashing*>(imageCollectionMatcher.get());
+    if(cascadeHashingMatcher != nullptr)
+    {
+      // all the chunks share the zero mean descriptor of all the views, computed once before the matching
+      std::set<IndexT> viewIds;
+      for(const auto& viewPair : sfmData.getViews())
+        viewIds.insert(viewPair.first);
+      cascadeHashingMatcher->setHashedRegionsFolders(featuresFolders, viewIds, describerTypes);
+    }
+    else
+      ALICEVISION_LOG_WARNING("Hashed regions can only be saved with the FAST_CASCADE_HASHING_L2 matcher.");
   }
 
-  // perform the matching
-  system::Timer timer;
-  PairSet pairsPoseKnown;
-  PairSet pairsPoseUnknown;
+  ALICEVISION_LOG_INFO("There are " << sfmData.getViews().size() << " views and " << pairs.size() << " image pairs.");
 
-  if(matchFromKnownCameraPoses)
+  // descriptors can be loaded on demand for the putative matching,
+  // only the features are needed by the geometric filtering except for the guided matching
+  // and the matching from known camera poses
+  bool loadRegionsOnDemand = (regionsMemoryBudget > 0);
+  if(loadRegionsOnDemand && !imageCollectionMatcher->supportRegionsProvider())
   {
-      for(const auto& p: pairs)
-      {
-        if(sfmData.isPoseAndIntrinsicDefined(p.first) && sfmData.isPoseAndIntrinsicDefined(p.second))
-        {
-            pairsPoseKnown.insert(p);
-        }
-        else
-        {
-            pairsPoseUnknown.insert(p);
-        }
-      }
-  }
-  else
-  {
-      pairsPoseUnknown = pairs;
+    ALICEVISION_LOG_WARNING("On demand regions loading is not supported by the " << nearestMatchingMethod << " matcher, all the descriptors will be loaded.");
+    loadRegionsOnDemand = false;
   }
-
-  if(!pairsPoseKnown.empty())
+  if(loadRegionsOnDemand && (guidedMatching || matchFromKnownCameraPoses))
   {
-    // compute matches from known camera poses when you have an initialization on the camera poses
-    ALICEVISION_LOG_INFO("Putative matches from known poses: " << pairsPoseKnown.size() << " image pairs.");
-
-    sfm::StructureEstimationFromKnownPoses structureEstimator;
-    structureEstimator.match(sfmData, pairsPoseKnown, regionPerView, knownPosesGeometricErrorMax);
-    mapPutativesMatches = structureEstimator.getPutativesMatches();
+    ALICEVISION_LOG_WARNING("On demand regions loading is not compatible with guided matching or matching from known camera poses, all the descriptors will be loaded.");
+    loadRegionsOnDemand = false;
   }
 
-  if(!pairsPoseUnknown.empty())
+  std::unique_ptr<feature::RegionsProvider> regionsProvider;
+  if(loadRegionsOnDemand)
   {
-      ALICEVISION_LOG_INFO("Putative matches (unknown poses): " << pairsPoseUnknown.size() << " image pairs.");
-      // match feature descriptors between them without geometric notion
-
-      for(const feature::EImageDescriberType descType : describerTypes)
-      {
-        assert(descType != feature::EImageDescriberType::UNINITIALIZED);
-        ALICEVISION_LOG_INFO(EImageDescriberType_enumToString(descType) + " Regions Matching");
-
-        // photometric matching of putative pairs
-        imageCollectionMatcher->Match(regionPerView, pairsPoseUnknown, descType, mapPutativesMatches);
-
-        // TODO: DELI
-        // if(!guided_matching) regionPerView.clearDescriptors()
-      }
-
+    ALICEVISION_LOG_INFO("Load features (descriptors are loaded on demand within " << regionsMemoryBudget << " MB)");
+    regionsProvider = sfm::createRegionsProvider(sfmData, featuresFolders, describerTypes, static_cast<std::size_t>(regionsMemoryBudget) * 1024 * 1024);
   }
-
-  if(mapPutativesMatches.empty())
+  else
   {
-    ALICEVISION_LOG_INFO("No putative feature matches.");
-    // If we only compute a selection of matches, we may have no match.
-    return rangeSize ? EXIT_SUCCESS : EXIT_FAILURE;
+    ALICEVISION_LOG_INFO("Load features and descriptors");
   }
 
-  if(geometricFilterType == EGeometricFilterType::HOMOGRAPHY_GROWING)
+  // load the corresponding view regions
+  RegionsPerView regionPerView;
+  if(!sfm::loadRegionsPerView(regionPerView, sfmData, featuresFolders, describerTypes, filter, loadRegionsOnDemand))
   {
-    // sort putative matches according to their Lowe ratio
-    // This is suggested by [F.Srajer, 2016]: the matches used to be the seeds of the homographies growing are chosen according
-    // to the putative matches order. This modification should improve recall.
-    for(auto& imgPair: mapPutativesMatches)
-    {
-      for(auto& descType: imgPair.second)
-      {
-        IndMatches & matches = descType.second;
-        sortMatches_byDistanceRatio(matches);
-      }
-    }
+    ALICEVISION_LOG_ERROR("Invalid regions in '" + sfmDataFilename + "'");
+    return EXIT_FAILURE;
   }
 
   // when a range is specified, generate a file prefix to reflect the current iteration (rangeStart/rangeSize)
@@ -396,149 +413,206 @@ int aliceVision_main(int argc, char **argv)
   // => without matchFilePerImage: avoids overwriting the unique resulting file
   const std::string filePrefix = rangeSize > 0 ? std::to_string(rangeStart/rangeSize) + "." : "";
 
-  ALICEVISION_LOG_INFO(std::to_string(mapPutativesMatches.size()) << " putative image pair matches");
+  // compute the putative matches of a set of pairs
+  const auto computePutativeMatches = [&](const PairSet& pairsToMatch, PairwiseMatches& putativeMatches)
+  {
+    PairSet pairsPoseKnown;
+    PairSet pairsPoseUnknown;
 
-  for(const auto& imageMatch: mapPutativesMatches)
-    ALICEVISION_LOG_INFO("\t- image pair (" + std::to_string(imageMatch.first.first) << ", " + std::to_string(imageMatch.first.second) + ") contains " + std::to_string(imageMatch.second.getNbAllMatches()) + " putative matches.");
+    if(matchFromKnownCameraPoses)
+    {
+        for(const auto& p: pairsToMatch)
+        {
+          if(sfmData.isPoseAndIntrinsicDefined(p.first) && sfmData.isPoseAndIntrinsicDefined(p.second))
+          {
+              pairsPoseKnown.insert(p);
+          }
+          else
+          {
+              pairsPoseUnknown.insert(p);
+          }
+        }
+    }
+    else
+    {
+        pairsPoseUnknown = pairsToMatch;
+    }
 
-  // export putative matches
-  if(savePutativeMatches)
-    Save(mapPutativesMatches, (fs::path(matchesFolder) / "putativeMatches").string(), fileExtension, matchFilePerImage, filePrefix);
+    if(!pairsPoseKnown.empty())
+    {
+      // compute matches from known camera poses when you have an initialization on the camera poses
+      ALICEVISION_LOG_INFO("Putative matches from known poses: " << pairsPoseKnown.size() << " image pairs.");
 
-  ALICEVISION_LOG_INFO("Task (Regions Matching) done in (s): " + std::to_string(timer.elapsed()));
+      sfm::StructureEstimationFromKnownPoses structureEstimator;
+      structureEstimator.match(sfmData, pairsPoseKnown, regionPerView, knownPosesGeometricErrorMax);
+      putativeMatches = structureEstimator.getPutativesMatches();
+    }
 
-  /*
-  // TODO: DELI
-  if(exportDebugFiles)
-  {
-    //-- export putative matches Adjacency matrix
-    PairwiseMatchingToAdjacencyMatrixSVG(sfmData.getViews().size(),
-      mapPutativesMatches,
-      (fs::path(matchesFolder) / "PutativeAdjacencyMatrix.svg").string());
-    //-- export view pair graph once putative graph matches have been computed
+    if(!pairsPoseUnknown.empty())
     {
-      std::set<IndexT> set_ViewIds;
+        ALICEVISION_LOG_INFO("Putative matches (unknown poses): " << pairsPoseUnknown.size() << " image pairs.");
+        // match feature descriptors between them without geometric notion
 
-      std::transform(sfmData.getViews().begin(), sfmData.getViews().end(),
-        std::inserter(set_ViewIds, set_ViewIds.begin()), stl::RetrieveKey());
+        for(const feature::EImageDescriberType descType : describerTypes)
+        {
+          assert(descType != feature::EImageDescriberType::UNINITIALIZED);
+          ALICEVISION_LOG_INFO(EImageDescriberType_enumToString(descType) + " Regions Matching");
 
-      graph::indexedGraph putativeGraph(set_ViewIds, getPairs(mapPutativesMatches));
+          // photometric matching of putative pairs
+          if(regionsProvider)
+            imageCollectionMatcher->Match(*regionsProvider, pairsPoseUnknown, descType, putativeMatches);
+          else
+            imageCollectionMatcher->Match(regionPerView, pairsPoseUnknown, descType, putativeMatches);
 
-      graph::exportToGraphvizData(
-        (fs::path(matchesFolder) / "putative_matches.dot").string(),
-        putativeGraph.g);
+          // TODO: DELI
+          // if(!guided_matching) regionPerView.clearDescriptors()
+        }
     }
-  }
-  */
+
+    if(geometricFilterType == EGeometricFilterType::HOMOGRAPHY_GROWING)
+    {
+      // sort putative matches according to their Lowe ratio
+      // This is suggested by [F.Srajer, 2016]: the matches used to be the seeds of the homographies growing are chosen according
+      // to the putative matches order. This modification should improve recall.
+      for(auto& imgPair: putativeMatches)
+      {
+        for(auto& descType: imgPair.second)
+        {
+          IndMatches & matches = descType.second;
+          sortMatches_byDistanceRatio(matches);
+        }
+      }
+    }
+  };
+
+  const auto logPutativeMatches = [](const PairwiseMatches& putativeMatches)
+  {
+    ALICEVISION_LOG_INFO(std::to_string(putativeMatches.size()) << " putative image pair matches");
+
+    for(const auto& imageMatch: putativeMatches)
+      ALICEVISION_LOG_INFO("\t- image pair (" + std::to_string(imageMatch.first.first) << ", " + std::to_string(imageMatch.first.second) + ") contains " + std::to_string(imageMatch.second.getNbAllMatches()) + " putative matches.");
 
 #ifdef ALICEVISION_DEBUG_MATCHING
     {
       ALICEVISION_LOG_DEBUG("PUTATIVE");
-      getStatsMap(mapPutativesMatches);
+      getStatsMap(putativeMatches);
     }
 #endif
+  };
 
   // c. Geometric filtering of putative matches
   //    - AContrario Estimation of the desired geometric model
   //    - Use an upper bound for the a contrario estimated threshold
+  //    then grid filtering of the geometric matches
+  const auto filterMatches = [&](const PairwiseMatches& putativeMatches, PairwiseMatches& finalMatches)
+  {
+    matching::PairwiseMatches geometricMatches;
 
-  timer.reset();
+    ALICEVISION_LOG_INFO("Geometric filtering: using " << matchingImageCollection::EGeometricFilterType_enumToString(geometricFilterType));
 
-  matching::PairwiseMatches geometricMatches;
+    switch(geometricFilterType)
+    {
 
-  ALICEVISION_LOG_INFO("Geometric filtering: using " << matchingImageCollection::EGeometricFilterType_enumToString(geometricFilterType));
+      case EGeometricFilterType::NO_FILTERING:
+        geometricMatches = putativeMatches;
+      break;
 
-  switch(geometricFilterType)
-  {
-
-    case EGeometricFilterType::NO_FILTERING:
-      geometricMatches = mapPutativesMatches;
-    break;
+      case EGeometricFilterType::FUNDAMENTAL_MATRIX:
+      {
+        GeometricFilterMatrix_F_AC filter(geometricErrorMax, maxIteration, geometricEstimator);
+        filter.m_acRansacOptions = acRansacOptions;
+        matchingImageCollection::robustModelEstimation(geometricMatches,
+          &sfmData,
+          regionPerView,
+          filter,
+          putativeMatches,
+          guidedMatching);
+      }
+      break;
 
-    case EGeometricFilterType::FUNDAMENTAL_MATRIX:
-    {
-      matchingImageCollection::robustModelEstimation(geometricMatches,
-        &sfmData,
-        regionPerView,
-        GeometricFilterMatrix_F_AC(geometricErrorMax, maxIteration, geometricEstimator),
-        mapPutativesMatches,
-        guidedMatching);
-    }
-    break;
+      case EGeometricFilterType::FUNDAMENTAL_WITH_DISTORTION:
+      {
+        GeometricFilterMatrix_F_AC filter(geometricErrorMax, maxIteration, geometricEstimator, true);
+        filter.m_acRansacOptions = acRansacOptions;
+        matchingImageCollection::robustModelEstimation(geometricMatches,
+          &sfmData,
+          regionPerView,
+          filter,
+          putativeMatches,
+          guidedMatching);
+      }
+      break;
 
-  case EGeometricFilterType::FUNDAMENTAL_WITH_DISTORTION:
-  {
-    matchingImageCollection::robustModelEstimation(geometricMatches,
-      &sfmData,
-      regionPerView,
-      GeometricFilterMatrix_F_AC(geometricErrorMax, maxIteration, geometricEstimator, true),
-      mapPutativesMatches,
-      guidedMatching);
-  }
-  break;
+      case EGeometricFilterType::ESSENTIAL_MATRIX:
+      {
+        GeometricFilterMatrix_E_AC filter(geometricErrorMax, maxIteration);
+        filter.m_acRansacOptions = acRansacOptions;
+        matchingImageCollection::robustModelEstimation(geometricMatches,
+          &sfmData,
+          regionPerView,
+          filter,
+          putativeMatches,
+          guidedMatching);
+
+        // perform an additional check to remove pairs with poor overlap
+        std::vector<PairwiseMatches::key_type> toRemoveVec;
+        for(PairwiseMatches::const_iterator iterMap = geometricMatches.begin();
+          iterMap != geometricMatches.end(); ++iterMap)
+        {
+          const size_t putativePhotometricCount = putativeMatches.find(iterMap->first)->second.getNbAllMatches();
+          const size_t putativeGeometricCount = iterMap->second.getNbAllMatches();
+          const float ratio = putativeGeometricCount / (float)putativePhotometricCount;
+          if (putativeGeometricCount < 50 || ratio < .3f)
+            toRemoveVec.push_back(iterMap->first); // the image pair will be removed
+        }
 
-    case EGeometricFilterType::ESSENTIAL_MATRIX:
-    {
-      matchingImageCollection::robustModelEstimation(geometricMatches,
-        &sfmData,
-        regionPerView,
-        GeometricFilterMatrix_E_AC(geometricErrorMax, maxIteration),
-        mapPutativesMatches,
-        guidedMatching);
+        // remove discarded pairs
+        for(std::vector<PairwiseMatches::key_type>::const_iterator iter = toRemoveVec.begin();
+            iter != toRemoveVec.end(); ++iter)
+          geometricMatches.erase(*iter);
+      }
+      break;
 
-      // perform an additional check to remove pairs with poor overlap
-      std::vector<PairwiseMatches::key_type> toRemoveVec;
-      for(PairwiseMatches::const_iterator iterMap = geometricMatches.begin();
-        iterMap != geometricMatches.end(); ++iterMap)
+      case EGeometricFilterType::HOMOGRAPHY_MATRIX:
       {
-        const size_t putativePhotometricCount = mapPutativesMatches.find(iterMap->first)->second.getNbAllMatches();
-        const size_t putativeGeometricCount = iterMap->second.getNbAllMatches();
-        const float ratio = putativeGeometricCount / (float)putativePhotometricCount;
-        if (putativeGeometricCount < 50 || ratio < .3f)
-          toRemoveVec.push_back(iterMap->first); // the image pair will be removed
+        const bool onlyGuidedMatching = true;
+        GeometricFilterMatrix_H_AC filter(geometricErrorMax, maxIteration);
+        filter.m_acRansacOptions = acRansacOptions;
+        matchingImageCollection::robustModelEstimation(geometricMatches,
+          &sfmData,
+          regionPerView,
+          filter,
+          putativeMatches, guidedMatching,
+          onlyGuidedMatching ? -1.0 : 0.6);
       }
+      break;
 
-      // remove discarded pairs
-      for(std::vector<PairwiseMatches::key_type>::const_iterator iter = toRemoveVec.begin();
-          iter != toRemoveVec.end(); ++iter)
-        geometricMatches.erase(*iter);
+      case EGeometricFilterType::HOMOGRAPHY_GROWING:
+      {
+        matchingImageCollection::robustModelEstimation(geometricMatches,
+          &sfmData,
+          regionPerView,
+          GeometricFilterMatrix_HGrowing(geometricErrorMax, maxIteration),
+          putativeMatches,
+          guidedMatching);
+      }
+      break;
     }
-    break;
 
-    case EGeometricFilterType::HOMOGRAPHY_MATRIX:
-    {
-      const bool onlyGuidedMatching = true;
-      matchingImageCollection::robustModelEstimation(geometricMatches,
-        &sfmData,
-        regionPerView,
-        GeometricFilterMatrix_H_AC(geometricErrorMax, maxIteration),
-        mapPutativesMatches, guidedMatching,
-        onlyGuidedMatching ? -1.0 : 0.6);
-    }
-    break;
+    ALICEVISION_LOG_INFO(std::to_string(geometricMatches.size()) + " geometric image pair matches:");
+    for(const auto& matchGeo: geometricMatches)
+      ALICEVISION_LOG_INFO("\t- image pair (" + std::to_string(matchGeo.first.first) + ", " + std::to_string(matchGeo.first.second) + ") contains " + std::to_string(matchGeo.second.getNbAllMatches()) + " geometric matches.");
 
-    case EGeometricFilterType::HOMOGRAPHY_GROWING:
+#ifdef ALICEVISION_DEBUG_MATCHING
     {
-      matchingImageCollection::robustModelEstimation(geometricMatches,
-        &sfmData,
-        regionPerView,
-        GeometricFilterMatrix_HGrowing(geometricErrorMax, maxIteration),
-        mapPutativesMatches,
-        guidedMatching);
+      ALICEVISION_LOG_DEBUG("GEOMETRIC");
+      getStatsMap(geometricMatches);
     }
-    break;
-  }
-
-  ALICEVISION_LOG_INFO(std::to_string(geometricMatches.size()) + " geometric image pair matches:");
-  for(const auto& matchGeo: geometricMatches)
-    ALICEVISION_LOG_INFO("\t- image pair (" + std::to_string(matchGeo.first.first) + ", " + std::to_string(matchGeo.first.second) + ") contains " + std::to_string(matchGeo.second.getNbAllMatches()) + " geometric matches.");
+#endif
 
-  // grid filtering
-  ALICEVISION_LOG_INFO("Grid filtering");
+    // grid filtering
+    ALICEVISION_LOG_INFO("Grid filtering");
 
-  PairwiseMatches finalMatches;
-  
-  {
     for(const auto& geometricMatch: geometricMatches)
     {
       //Get the image pair and their matches.
@@ -585,12 +659,140 @@ int aliceVision_main(int argc, char **argv)
     ALICEVISION_LOG_INFO("After grid filtering:");
     for(const auto& matchGridFiltering: finalMatches)
       ALICEVISION_LOG_INFO("\t- image pair (" + std::to_string(matchGridFiltering.first.first) + ", " + std::to_string(matchGridFiltering.first.second) + ") contains " + std::to_string(matchGridFiltering.second.getNbAllMatches()) + " geometric matches.");
+  };
+
+  // perform the matching
+  system::Timer timer;
+  // number of geometric matches per image pair, for the debug files
+  std::map<Pair, std::size_t> nbFinalMatchesPerPair;
+
+  if(pipelineChunkSize <= 0)
+  {
+    // b. Compute putative descriptor matches of all the pairs
+    PairwiseMatches mapPutativesMatches;
+    computePutativeMatches(pairs, mapPutativesMatches);
+
+    // descriptors are not needed anymore
+    regionsProvider.reset();
+
+    if(mapPutativesMatches.empty())
+    {
+      ALICEVISION_LOG_INFO("No putative feature matches.");
+      // If we only compute a selection of matches, we may have no match.
+      return rangeSize ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+
+    logPutativeMatches(mapPutativesMatches);
+
+    // export putative matches
+    if(savePutativeMatches)
+      Save(mapPutativesMatches, (fs::path(matchesFolder) / "putativeMatches").string(), fileExtension, matchFilePerImage, filePrefix);
+
+    ALICEVISION_LOG_INFO("Task (Regions Matching) done in (s): " + std::to_string(timer.elapsed()));
+
+    /*
+    // TODO: DELI
+    if(exportDebugFiles)
+    {
+      //-- export putative matches Adjacency matrix
+      PairwiseMatchingToAdjacencyMatrixSVG(sfmData.getViews().size(),
+        mapPutativesMatches,
+        (fs::path(matchesFolder) / "PutativeAdjacencyMatrix.svg").string());
+      //-- export view pair graph once putative graph matches have been computed
+      {
+        std::set<IndexT> set_ViewIds;
+
+        std::transform(sfmData.getViews().begin(), sfmData.getViews().end(),
+          std::inserter(set_ViewIds, set_ViewIds.begin()), stl::RetrieveKey());
+
+        graph::indexedGraph putativeGraph(set_ViewIds, getPairs(mapPutativesMatches));
+
+        graph::exportToGraphvizData(
+          (fs::path(matchesFolder) / "putative_matches.dot").string(),
+          putativeGraph.g);
+      }
+    }
+    */
+
+    // c. Geometric filtering of putative matches
+    timer.reset();
+    PairwiseMatches finalMatches;
+    filterMatches(mapPutativesMatches, finalMatches);
+
+    // export geometric filtered matches
+    ALICEVISION_LOG_INFO("Save geometric matches.");
+    Save(finalMatches, matchesFolder, fileExtension, matchFilePerImage, filePrefix);
+    ALICEVISION_LOG_INFO("Task done in (s): " + std::to_string(timer.elapsed()));
+
+    if(exportDebugFiles)
+    {
+      for(const auto& matchesPerPair : finalMatches)
+        nbFinalMatchesPerPair.emplace_hint(nbFinalMatchesPerPair.end(), matchesPerPair.first, matchesPerPair.second.getNbAllMatches());
+    }
   }
+  else
+  {
+    // b. and c. are pipelined: the putative matching of the next chunks of pairs runs
+    // while the putative matches of the current chunk are filtered and saved
+    const std::vector<PairSet> chunks = splitPairsInChunks(pairs, pipelineChunkSize);
+    ALICEVISION_LOG_INFO("Matching pipeline: " << chunks.size() << " chunks of at most " << pipelineChunkSize << " image pairs.");
+
+    // the pairs are filtered in order, so the matches can be saved chunk by chunk
+    MatchesWriter writer(matchesFolder, fileExtension, matchFilePerImage, filePrefix);
+    std::unique_ptr<MatchesWriter> putativeWriter;
+    if(savePutativeMatches)
+      putativeWriter.reset(new MatchesWriter((fs::path(matchesFolder) / "putativeMatches").string(), fileExtension, matchFilePerImage, filePrefix));
+
+    std::size_t nbPutativePairs = 0;
+    std::size_t nbFinalPairs = 0;
+
+    pipelineMatching(chunks, static_cast<std::size_t>(std::max(1, pipelineQueueSize)),
+      computePutativeMatches,
+      [&](PairwiseMatches&& putativeMatches)
+      {
+        if(putativeMatches.empty())
+          return;
+        nbPutativePairs += putativeMatches.size();
+
+        logPutativeMatches(putativeMatches);
+
+        // export putative matches
+        if(putativeWriter)
+          putativeWriter->write(putativeMatches);
+
+        PairwiseMatches chunkMatches;
+        filterMatches(putativeMatches, chunkMatches);
+        nbFinalPairs += chunkMatches.size();
+
+        // export geometric filtered matches
+        writer.write(chunkMatches);
+
+        // only the number of matches is kept for the statistics
+        if(exportDebugFiles)
+        {
+          for(const auto& matchesPerPair : chunkMatches)
+            nbFinalMatchesPerPair.emplace_hint(nbFinalMatchesPerPair.end(), matchesPerPair.first, matchesPerPair.second.getNbAllMatches());
+        }
+      });
+
+    // descriptors are not needed anymore
+    regionsProvider.reset();
 
-  // export geometric filtered matches
-  ALICEVISION_LOG_INFO("Save geometric matches.");
-  Save(finalMatches, matchesFolder, fileExtension, matchFilePerImage, filePrefix);
-  ALICEVISION_LOG_INFO("Task done in (s): " + std::to_string(timer.elapsed()));
+    ALICEVISION_LOG_INFO("Save geometric matches.");
+    if(putativeWriter)
+      putativeWriter->close();
+    writer.close();
+
+    if(nbPutativePairs == 0)
+    {
+      ALICEVISION_LOG_INFO("No putative feature matches.");
+      // If we only compute a selection of matches, we may have no match.
+      return rangeSize ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+
+    ALICEVISION_LOG_INFO(nbPutativePairs << " putative image pair matches, " << nbFinalPairs << " geometric image pair matches.");
+    ALICEVISION_LOG_INFO("Task done in (s): " + std::to_string(timer.elapsed()));
+  }
 
   // d. Export some statistics
   if(exportDebugFiles)
@@ -598,7 +800,7 @@ int aliceVision_main(int argc, char **argv)
     // export Adjacency matrix
     ALICEVISION_LOG_INFO("Export Adjacency Matrix of the pairwise's geometric matches");
     PairwiseMatchingToAdjacencyMatrixSVG(sfmData.getViews().size(),
-      finalMatches,(fs::path(matchesFolder) / "GeometricAdjacencyMatrix.svg").string());
+      nbFinalMatchesPerPair,(fs::path(matchesFolder) / "GeometricAdjacencyMatrix.svg").string());
 
     /*
     // export view pair graph once geometric filter have been done
@@ -614,12 +816,5 @@ int aliceVision_main(int argc, char **argv)
     */
   }
 
-#ifdef ALICEVISION_DEBUG_MATCHING
-  {
-    ALICEVISION_LOG_DEBUG("GEOMETRIC");
-    getStatsMap(geometricMatches);
-  }
-#endif
-
   return EXIT_SUCCESS;
 }
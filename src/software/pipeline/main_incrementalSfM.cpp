@@ -27,7 +27,7 @@
 // These constants define the current software version.
 // They must be updated when the command line is changed.
 #define ALICEVISION_SOFTWARE_VERSION_MAJOR 2
-#define ALICEVISION_SOFTWARE_VERSION_MINOR 1
+#define ALICEVISION_SOFTWARE_VERSION_MINOR 3
 
 using namespace aliceVision;
 
@@ -153,6 +153,12 @@ int aliceVision_main(int argc, char **argv)
       "It reduces the reconstruction time, especially for big datasets (500+ images).")
     ("localBAGraphDistance", po::value<int>(&sfmParams.localBundelAdjustementGraphDistanceLimit)->default_value(sfmParams.localBundelAdjustementGraphDistanceLimit),
       "Graph-distance limit setting the Active region in the Local Bundle Adjustment strategy.")
+    ("useAnalyticJacobians", po::value<bool>(&sfmParams.useAnalyticJacobians)->default_value(sfmParams.useAnalyticJacobians),
+      "Use cost functions with analytic jacobians instead of automatic differentiation in the Bundle Adjustment.\n"
+      "It gives the same results and reduces the Bundle Adjustment time.")
+    ("usePersistentBAProblem", po::value<bool>(&sfmParams.usePersistentBundleAdjustmentProblem)->default_value(sfmParams.usePersistentBundleAdjustmentProblem),
+      "Keep the Bundle Adjustment problem between the iterations and only add/remove the blocks of the new views, "
+      "new landmarks and removed outliers, instead of building it from scratch at each iteration.")
     ("localizerEstimator", po::value<robustEstimation::ERobustEstimator>(&sfmParams.localizerEstimator)->default_value(sfmParams.localizerEstimator),
       "Estimator type used to localize cameras (acransac (default), ransac, lsmeds, loransac, maxconsensus)")
     ("localizerEstimatorError", po::value<double>(&sfmParams.localizerEstimatorError)->default_value(0.0),
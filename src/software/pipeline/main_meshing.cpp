@@ -28,7 +28,7 @@
 // These constants define the current software version.
 // They must be updated when the command line is changed.
 #define ALICEVISION_SOFTWARE_VERSION_MAJOR 4
-#define ALICEVISION_SOFTWARE_VERSION_MINOR 0
+#define ALICEVISION_SOFTWARE_VERSION_MINOR 1
 
 using namespace aliceVision;
 
@@ -177,6 +177,10 @@ int aliceVision_main(int argc, char* argv[])
         ("minStep", po::value<int>(&fuseParams.minStep)->default_value(fuseParams.minStep),
             "The step used to load depth values from depth maps is computed from maxInputPts. Here we define the minimal value for this step, "
             "so on small datasets we will not spend too much time at the beginning loading all depth values.")
+        ("maxInputPointsInMemory", po::value<std::size_t>(&fuseParams.maxInputPointsInMemory)->default_value(fuseParams.maxInputPointsInMemory),
+            "Max input points kept in memory: the depth maps are loaded and merged by chunks of cameras below this limit "
+            "(0 to deduce it from the free memory). Each chunk can load half of this limit, so it is exceeded when the points "
+            "kept from the previous chunks fill more than the other half.")
         ("simFactor", po::value<float>(&fuseParams.simFactor)->default_value(fuseParams.simFactor),
             "simFactor")
         ("angleFactor", po::value<float>(&fuseParams.angleFactor)->default_value(fuseParams.angleFactor),